@@ -198,9 +198,15 @@ namespace app {
 						render_.draw_text(vtx::spos(LCD_X - LCD_Y, 0), "image decode error.");
 						render_.swap_color();
 					} else {
-						auto n = std::max(ifo.width, ifo.height);
-						scaling_.set_scale(LCD_Y, n);
+						// JPEG は、サムネイル、縮小デコードで、デコーダーが枠に収める
+						if(img_in_.set_target(LCD_Y, LCD_Y)) {
+							scaling_.set_scale();
+						} else {
+							auto n = std::max(ifo.width, ifo.height);
+							scaling_.set_scale(LCD_Y, n);
+						}
 						img_in_.load(fin);
+						img_in_.set_target();
 					}
 					fin.seek(utils::file_io::SEEK::SET, pos);
 				}
@@ -0,0 +1,444 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	FLAC エンコーダー（ホスト、ベンチマークの素材作成用） @n
+			FIXED（0 ～ 4 次）、LPC（8 次）、CONSTANT、VERBATIM の各サブフレームと、@n
+			４種類のステレオ相関（独立、left/side、side/right、mid/side）から、@n
+			最も小さいものを選ぶ（デコーダーの全ての経路を通す為）。@n
+			LPC の係数は、倍精度で求めて量子化する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <string>
+
+namespace bench {
+
+	class flac_enc {
+
+		static const uint32_t LPC_ORDER = 8;
+
+		std::vector<uint8_t>	out_;
+		uint64_t	acc_;
+		uint32_t	abits_;
+
+		void put_(uint32_t v, uint32_t n)
+		{
+			for(int32_t i = n - 1; i >= 0; --i) {
+				acc_ = (acc_ << 1) | ((v >> i) & 1);
+				++abits_;
+				if(abits_ == 8) {
+					out_.push_back(acc_ & 0xff);
+					abits_ = 0;
+					acc_ = 0;
+				}
+			}
+		}
+
+		void sput_(int32_t v, uint32_t n) { put_(static_cast<uint32_t>(v) & ((n < 32) ? ((1u << n) - 1) : 0xffffffff), n); }
+
+		void align_() { while(abits_ != 0) put_(0, 1); }
+
+		void le32_(uint32_t v) { for(int i = 0; i < 4; ++i) put_((v >> (i * 8)) & 0xff, 8); }
+
+		static uint8_t crc8_(const uint8_t* p, uint32_t n)
+		{
+			uint8_t crc = 0;
+			for(uint32_t i = 0; i < n; ++i) {
+				crc ^= p[i];
+				for(int j = 0; j < 8; ++j) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+			}
+			return crc;
+		}
+
+		static uint16_t crc16_(const uint8_t* p, uint32_t n)
+		{
+			uint16_t crc = 0;
+			for(uint32_t i = 0; i < n; ++i) {
+				crc ^= static_cast<uint16_t>(p[i]) << 8;
+				for(int j = 0; j < 8; ++j) crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : (crc << 1);
+			}
+			return crc;
+		}
+
+		// Rice 符号のビット数（パーティション次数と、パラメーターを選ぶ）
+		static uint64_t rice_bits_(const int32_t* res, uint32_t num, uint32_t order,
+			uint32_t& porder, std::vector<uint32_t>& param)
+		{
+			uint64_t best = ~0ULL;
+			for(uint32_t po = 0; po <= 6; ++po) {
+				uint32_t psize = num >> po;
+				if((psize << po) != num || psize < order) break;
+				std::vector<uint32_t> pr;
+				uint64_t total = 0;
+				uint32_t i = order;
+				for(uint32_t p = 0; p < (1u << po); ++p) {
+					uint32_t cnt = p == 0 ? psize - order : psize;
+					uint64_t sum = 0;
+					for(uint32_t j = 0; j < cnt; ++j) {
+						int32_t v = res[i + j];
+						sum += static_cast<uint32_t>(v << 1) ^ static_cast<uint32_t>(v >> 31);
+					}
+					uint32_t bk = 0;
+					uint64_t bb = ~0ULL;
+					for(uint32_t k = 0; k < 31; ++k) {
+						uint64_t b = (sum >> k) + cnt * (k + 1);
+						if(b < bb) { bb = b; bk = k; }
+					}
+					pr.push_back(bk);
+					total += bb + 5;
+					i += cnt;
+				}
+				if(total < best) { best = total; porder = po; param = pr; }
+			}
+			return best + 6;
+		}
+
+		struct sub_t {
+			uint32_t	type;	// 0: CONSTANT, 1: VERBATIM, 8..12: FIXED, 32+: LPC
+			uint32_t	order;
+			uint32_t	wasted;
+			uint32_t	prec;
+			int32_t		shift;
+			int32_t		coef[32];
+			std::vector<int32_t>	res;
+			uint32_t	porder;
+			std::vector<uint32_t>	param;
+			uint64_t	bits;
+		};
+
+		static void fixed_res_(const int32_t* s, uint32_t num, uint32_t order, std::vector<int32_t>& res)
+		{
+			res.assign(num, 0);
+			for(uint32_t i = order; i < num; ++i) {
+				int32_t p = 0;
+				switch(order) {
+				case 1: p = s[i - 1]; break;
+				case 2: p = 2 * s[i - 1] - s[i - 2]; break;
+				case 3: p = 3 * (s[i - 1] - s[i - 2]) + s[i - 3]; break;
+				case 4: p = 4 * (s[i - 1] + s[i - 3]) - 6 * s[i - 2] - s[i - 4]; break;
+				default: break;
+				}
+				res[i] = s[i] - p;
+			}
+		}
+
+		static bool lpc_coef_(const int32_t* s, uint32_t num, uint32_t order, uint32_t prec,
+			int32_t* qc, int32_t& shift)
+		{
+			std::vector<double> r(order + 1, 0.0);
+			for(uint32_t l = 0; l <= order; ++l) {
+				double sum = 0.0;
+				for(uint32_t i = l; i < num; ++i) {
+					// ハン窓の代わりに、そのまま
+					sum += static_cast<double>(s[i]) * s[i - l];
+				}
+				r[l] = sum;
+			}
+			if(r[0] == 0.0) return false;
+			r[0] *= 1.0 + 1e-9;
+			std::vector<double> a(order + 1, 0.0), tmp(order + 1, 0.0);
+			double err = r[0];
+			for(uint32_t i = 1; i <= order; ++i) {
+				double k = r[i];
+				for(uint32_t j = 1; j < i; ++j) k -= a[j] * r[i - j];
+				k /= err;
+				tmp = a;
+				a[i] = k;
+				for(uint32_t j = 1; j < i; ++j) a[j] = tmp[j] - k * tmp[i - j];
+				err *= (1.0 - k * k);
+				if(err <= 0.0) return false;
+			}
+			double cmax = 0.0;
+			for(uint32_t j = 1; j <= order; ++j) cmax = std::max(cmax, std::fabs(a[j]));
+			if(cmax == 0.0) return false;
+			int32_t lg = static_cast<int32_t>(std::floor(std::log2(cmax))) + 1;
+			shift = static_cast<int32_t>(prec) - 1 - lg;
+			if(shift > 15) shift = 15;
+			if(shift < 0) return false;
+			const int32_t qmax = (1 << (prec - 1)) - 1;
+			double e = 0.0;
+			for(uint32_t j = 0; j < order; ++j) {
+				e += a[j + 1] * (1 << shift);
+				int32_t q = static_cast<int32_t>(std::lround(e));
+				if(q > qmax) q = qmax;
+				else if(q < -qmax - 1) q = -qmax - 1;
+				qc[j] = q;
+				e -= q;
+			}
+			return true;
+		}
+
+		void best_sub_(const int32_t* src, uint32_t num, uint32_t bps, sub_t& best)
+		{
+			// 無駄なビット
+			uint32_t orv = 0;
+			for(uint32_t i = 0; i < num; ++i) orv |= static_cast<uint32_t>(src[i]);
+			uint32_t wasted = 0;
+			if(orv != 0) {
+				while(((orv >> wasted) & 1) == 0) ++wasted;
+			}
+			std::vector<int32_t> sv(src, src + num);
+			if(wasted > 0) {
+				for(auto& v : sv) v >>= wasted;
+				bps -= wasted;
+			}
+			const int32_t* s = sv.data();
+
+			bool same = true;
+			for(uint32_t i = 1; i < num; ++i) if(s[i] != s[0]) { same = false; break; }
+			best.wasted = wasted;
+			if(same) {
+				best.type = 0;
+				best.order = 0;
+				best.res.assign(1, s[0]);
+				best.bits = bps;
+				return;
+			}
+			best.type = 1;
+			best.order = 0;
+			best.res = sv;
+			best.bits = static_cast<uint64_t>(bps) * num;
+
+			for(uint32_t order = 0; order <= 4 && order < num; ++order) {
+				sub_t t;
+				fixed_res_(s, num, order, t.res);
+				uint64_t b = rice_bits_(t.res.data(), num, order, t.porder, t.param) + order * bps;
+				if(b < best.bits) {
+					best.type = 8 + order;
+					best.order = order;
+					best.bits = b;
+					best.res = t.res;
+					best.porder = t.porder;
+					best.param = t.param;
+				}
+			}
+
+			// 16 ビットでは、積和が 32 ビットに収まる精度にする
+			uint32_t prec = bps <= 17 ? 12 : 14;
+			if(num > LPC_ORDER) {
+				sub_t t;
+				if(lpc_coef_(s, num, LPC_ORDER, prec, t.coef, t.shift)) {
+					t.res.assign(num, 0);
+					bool ok = true;
+					for(uint32_t i = LPC_ORDER; i < num; ++i) {
+						int64_t sum = 0;
+						for(uint32_t j = 0; j < LPC_ORDER; ++j) sum += static_cast<int64_t>(t.coef[j]) * s[i - 1 - j];
+						int64_t r = s[i] - (sum >> t.shift);
+						if(r > 0x3fffffff || r < -0x3fffffff) { ok = false; break; }
+						t.res[i] = r;
+					}
+					if(ok) {
+						uint64_t b = rice_bits_(t.res.data(), num, LPC_ORDER, t.porder, t.param)
+							+ LPC_ORDER * (bps + prec) + 9;
+						if(b < best.bits) {
+							best.type = 32 + LPC_ORDER - 1;
+							best.order = LPC_ORDER;
+							best.prec = prec;
+							best.shift = t.shift;
+							std::memcpy(best.coef, t.coef, sizeof(t.coef));
+							best.bits = b;
+							best.res = t.res;
+							best.porder = t.porder;
+							best.param = t.param;
+						}
+					}
+				}
+			}
+			best.res.swap(best.res);
+			// 予測の初期値は元のサンプル
+			for(uint32_t i = 0; i < best.order; ++i) best.res[i] = s[i];
+			if(best.type == 1) best.res = sv;
+		}
+
+		void put_sub_(const sub_t& sb, uint32_t num, uint32_t bps)
+		{
+			put_(0, 1);
+			put_(sb.type, 6);
+			if(sb.wasted > 0) {
+				put_(1, 1);
+				for(uint32_t i = 1; i < sb.wasted; ++i) put_(0, 1);
+				put_(1, 1);
+			} else {
+				put_(0, 1);
+			}
+			bps -= sb.wasted;
+			if(sb.type == 0) {
+				sput_(sb.res[0], bps);
+				return;
+			}
+			if(sb.type == 1) {
+				for(uint32_t i = 0; i < num; ++i) sput_(sb.res[i], bps);
+				return;
+			}
+			for(uint32_t i = 0; i < sb.order; ++i) sput_(sb.res[i], bps);
+			if(sb.type >= 32) {
+				put_(sb.prec - 1, 4);
+				sput_(sb.shift, 5);
+				for(uint32_t i = 0; i < sb.order; ++i) sput_(sb.coef[i], sb.prec);
+			}
+			bool rice2 = false;
+			for(auto k : sb.param) if(k >= 15) rice2 = true;
+			put_(rice2 ? 1 : 0, 2);
+			put_(sb.porder, 4);
+			uint32_t psize = num >> sb.porder;
+			uint32_t i = sb.order;
+			for(uint32_t p = 0; p < (1u << sb.porder); ++p) {
+				uint32_t cnt = p == 0 ? psize - sb.order : psize;
+				uint32_t k = sb.param[p];
+				put_(k, rice2 ? 5 : 4);
+				for(uint32_t j = 0; j < cnt; ++j) {
+					int32_t v = sb.res[i + j];
+					uint32_t u = static_cast<uint32_t>(v << 1) ^ static_cast<uint32_t>(v >> 31);
+					uint32_t q = u >> k;
+					for(uint32_t n = 0; n < q; ++n) put_(0, 1);
+					put_(1, 1);
+					if(k > 0) put_(u & ((1u << k) - 1), k);
+				}
+				i += cnt;
+			}
+		}
+
+	public:
+		flac_enc() : out_(), acc_(0), abits_(0) { }
+
+		const std::vector<uint8_t>& get() const { return out_; }
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	エンコード
+			@param[in]	l, r	サンプル（ch == 1 の場合 r は無視）
+			@param[in]	num		サンプル数
+			@param[in]	ch		チャネル数
+			@param[in]	bps		ビット数
+			@param[in]	rate	サンプリング周波数
+			@param[in]	block	ブロック・サイズ
+		*/
+		//-------------------------------------------------------------//
+		void encode(const int32_t* l, const int32_t* r, uint32_t num, uint32_t ch, uint32_t bps,
+			uint32_t rate, uint32_t block)
+		{
+			out_.clear();
+			acc_ = 0;
+			abits_ = 0;
+			put_(0x664c6143, 32);  // "fLaC"
+			// STREAMINFO
+			put_(0, 1);
+			put_(0, 7);
+			put_(34, 24);
+			put_(block, 16);
+			put_(block, 16);
+			put_(0, 24);
+			put_(0, 24);
+			put_(rate, 20);
+			put_(ch - 1, 3);
+			put_(bps - 1, 5);
+			put_(0, 4);
+			put_(num, 32);
+			for(int i = 0; i < 16; ++i) put_(0, 8);
+			// VORBIS_COMMENT
+			{
+				static const char* vendor = "bench";
+				static const char* cmt[] = { "TITLE=Bench Tone", "ARTIST=RX", "ALBUM=FLAC", "TRACKNUMBER=1" };
+				uint32_t len = 4 + std::strlen(vendor) + 4;
+				for(auto c : cmt) len += 4 + std::strlen(c);
+				put_(0, 1);
+				put_(4, 7);
+				put_(len, 24);
+				le32_(std::strlen(vendor));
+				for(const char* p = vendor; *p != 0; ++p) put_(*p, 8);
+				le32_(4);
+				for(auto c : cmt) {
+					le32_(std::strlen(c));
+					for(const char* p = c; *p != 0; ++p) put_(*p, 8);
+				}
+			}
+			// PADDING（最後）
+			put_(1, 1);
+			put_(1, 7);
+			put_(64, 24);
+			for(int i = 0; i < 64; ++i) put_(0, 8);
+
+			std::vector<int32_t> side(block), mid(block);
+			uint32_t frame = 0;
+			for(uint32_t pos = 0; pos < num; pos += block, ++frame) {
+				uint32_t n = std::min(block, num - pos);
+				const int32_t* fl = l + pos;
+				const int32_t* fr = r + pos;
+
+				// チャネル割り当て：0(1), 1(2) 独立、8: L/S, 9: S/R, 10: M/S
+				uint32_t assign = ch - 1;
+				sub_t sub[2];
+				if(ch == 2) {
+					for(uint32_t i = 0; i < n; ++i) {
+						side[i] = fl[i] - fr[i];
+						mid[i] = (fl[i] + fr[i]) >> 1;
+					}
+					sub_t sl, sr, ss, sm;
+					best_sub_(fl, n, bps, sl);
+					best_sub_(fr, n, bps, sr);
+					best_sub_(side.data(), n, bps + 1, ss);
+					best_sub_(mid.data(), n, bps, sm);
+					uint64_t b[4] = { sl.bits + sr.bits, sl.bits + ss.bits, ss.bits + sr.bits, sm.bits + ss.bits };
+					uint32_t k = 0;
+					for(uint32_t i = 1; i < 4; ++i) if(b[i] < b[k]) k = i;
+					switch(k) {
+					case 0: assign = 1;  sub[0] = sl; sub[1] = sr; break;
+					case 1: assign = 8;  sub[0] = sl; sub[1] = ss; break;
+					case 2: assign = 9;  sub[0] = ss; sub[1] = sr; break;
+					default: assign = 10; sub[0] = sm; sub[1] = ss; break;
+					}
+				} else {
+					best_sub_(fl, n, bps, sub[0]);
+				}
+
+				uint32_t hpos = out_.size();
+				put_(0x3ffe, 14);
+				put_(0, 1);
+				put_(0, 1);  // 固定ブロック・サイズ
+				uint32_t bs = 7;
+				if(n == 4096) bs = 12;
+				else if(n == 1152) bs = 3;
+				put_(bs, 4);
+				uint32_t sr = 0;  // STREAMINFO
+				if(rate == 44100) sr = 9;
+				else if(rate == 48000) sr = 10;
+				else if(rate == 96000) sr = 11;
+				put_(sr, 4);
+				put_(assign, 4);
+				uint32_t ss = 0;
+				if(bps == 16) ss = 4;
+				else if(bps == 24) ss = 6;
+				put_(ss, 3);
+				put_(0, 1);
+				// UTF-8 フレーム番号
+				if(frame < 0x80) {
+					put_(frame, 8);
+				} else if(frame < 0x800) {
+					put_(0xc0 | (frame >> 6), 8);
+					put_(0x80 | (frame & 0x3f), 8);
+				} else {
+					put_(0xe0 | (frame >> 12), 8);
+					put_(0x80 | ((frame >> 6) & 0x3f), 8);
+					put_(0x80 | (frame & 0x3f), 8);
+				}
+				if(bs == 7) put_(n - 1, 16);
+				put_(crc8_(&out_[hpos], out_.size() - hpos), 8);
+
+				for(uint32_t c = 0; c < ch; ++c) {
+					uint32_t b = bps;
+					if((assign == 8 && c == 1) || (assign == 9 && c == 0) || (assign == 10 && c == 1)) ++b;
+					put_sub_(sub[c], n, b);
+				}
+				align_();
+				put_(crc16_(&out_[hpos], out_.size() - hpos), 16);
+			}
+		}
+	};
+}
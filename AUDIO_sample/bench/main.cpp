@@ -0,0 +1,683 @@
+//=====================================================================//
+/*!	@file
+	@brief	AUDIO ベンチマーク（ホスト用） @n
+			sound::pcm_conv の各変換（u8, s16, s24, s32, f32）の速度と、@n
+			48KHz ステレオ１秒分の処理時間を、従来の１サンプル毎の変換、@n
+			FIFO 格納と比べる。@n
+			sound_mixer で、4, 8 ボイスを合成した場合の、出力ブロック（64 フレーム）@n
+			あたりのサイクル数を表示する。@n
+			sound::flac_dec は、bench::flac_enc で作成したストリームを復号して、@n
+			元のサンプルと一致する事を検査し、実時間に対する速度を表示する。@n
+			引数に .flac ファイルを与えると、そのファイルの復号速度を計る。@n
+			libmad がある場合（make MAD=1）は、.mp3 ファイルの復号速度も計る。@n
+			変換結果は、参照実装（double）と比較して検査する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "common/format.hpp"
+#include "common/fixed_fifo.hpp"
+#include "sound/sound_out.hpp"
+#include "sound/pcm_conv.hpp"
+#include "sound/pcm_cache.hpp"
+#include "sound/sound_mixer.hpp"
+// sound/tag.hpp から、common/time.h（struct tm を定義）が含まれるのを避ける
+#include <ctime>
+#define _TIME_H_
+extern "C" {
+	const char* get_wday(uint8_t idx);
+	const char* get_mon(uint8_t idx);
+};
+#include "sound/flac_dec.hpp"
+#include "flac_enc.hpp"
+#include <vector>
+#include <string>
+#ifdef USE_MAD
+#include <mad.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t RATE = 48000;
+	static const uint32_t CHUNK = 256;
+	static const uint32_t LOOP = 20;
+
+	typedef sound::wave_t<int16_t> WAVE;
+	typedef utils::fixed_fifo<WAVE, 2048> FIFO;
+
+	uint8_t		src_[RATE * 2 * 4];
+	WAVE		dst_[RATE];
+	FIFO		fifo_;
+	int32_t		sum_;
+
+	uint32_t	rand_ = 12345;
+
+	uint32_t rand32_()
+	{
+		rand_ = rand_ * 1103515245 + 12345;
+		return (rand_ >> 16) | (rand_ << 16);
+	}
+
+	void store32_(uint8_t* p, uint32_t v)
+	{
+		p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+	}
+
+	void make_src_(sound::pcm_conv::FORMAT fmt, uint32_t num)
+	{
+		auto bytes = sound::pcm_conv::get_bytes(fmt);
+		uint8_t* p = src_;
+		for(uint32_t i = 0; i < num; ++i) {
+			if(fmt == sound::pcm_conv::FORMAT::F32) {
+				// 範囲外（クリップ）も少し含める
+				float f = (static_cast<int32_t>(rand32_()) / 2147483648.0f) * 1.1f;
+				uint32_t u;
+				std::memcpy(&u, &f, 4);
+				store32_(p, u);
+			} else {
+				auto v = rand32_();
+				for(uint32_t j = 0; j < bytes; ++j) p[j] = v >> (j * 8);
+			}
+			p += bytes;
+		}
+	}
+
+	// 参照実装
+	int16_t ref_(sound::pcm_conv::FORMAT fmt, const uint8_t* p)
+	{
+		double v = 0.0;
+		switch(fmt) {
+		case sound::pcm_conv::FORMAT::U8:
+			return static_cast<int16_t>((static_cast<uint16_t>(p[0] ^ 0x80) << 8) | ((p[0] & 0x7f) << 1));
+		case sound::pcm_conv::FORMAT::S16:
+			return static_cast<int16_t>(p[0] | (p[1] << 8));
+		case sound::pcm_conv::FORMAT::S24:
+			v = static_cast<double>(static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (p[2] << 24)))
+				/ 65536.0;
+			break;
+		case sound::pcm_conv::FORMAT::S32:
+			v = static_cast<double>(static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16)
+				| (static_cast<uint32_t>(p[3]) << 24))) / 65536.0;
+			break;
+		case sound::pcm_conv::FORMAT::F32:
+			{
+				uint32_t u = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+				float f;
+				std::memcpy(&f, &u, 4);
+				v = static_cast<double>(f) * 32768.0;
+			}
+			break;
+		default:
+			return 0;
+		}
+		v = std::floor(v + 0.5);
+		if(v > 32767.0) v = 32767.0;
+		else if(v < -32768.0) v = -32768.0;
+		return static_cast<int16_t>(v);
+	}
+
+	const char* name_(sound::pcm_conv::FORMAT fmt)
+	{
+		switch(fmt) {
+		case sound::pcm_conv::FORMAT::U8:  return "u8 ";
+		case sound::pcm_conv::FORMAT::S16: return "s16";
+		case sound::pcm_conv::FORMAT::S24: return "s24";
+		case sound::pcm_conv::FORMAT::S32: return "s32";
+		case sound::pcm_conv::FORMAT::F32: return "f32";
+		default:
+			break;
+		}
+		return "?";
+	}
+
+	// 変換結果の検査（dither では ±1 LSB まで許容）
+	uint32_t check_(sound::pcm_conv::FORMAT fmt, uint32_t ch, bool dither)
+	{
+		const uint32_t frames = RATE;
+		make_src_(fmt, frames * ch);
+		sound::pcm_conv conv;
+		conv.enable_dither(dither);
+		for(uint32_t i = 0; i < frames; i += CHUNK) {
+			auto bytes = sound::pcm_conv::get_bytes(fmt) * ch;
+			conv.convert(fmt, src_ + i * bytes, ch, std::min(CHUNK, frames - i), dst_ + i);
+		}
+		auto bytes = sound::pcm_conv::get_bytes(fmt);
+		const uint8_t* p = src_;
+		uint32_t err = 0;
+		for(uint32_t i = 0; i < frames; ++i) {
+			int32_t l = ref_(fmt, p);
+			int32_t r = ch > 1 ? ref_(fmt, p + bytes) : l;
+			int32_t dl = dst_[i].l_ch - l;
+			int32_t dr = dst_[i].r_ch - r;
+			int32_t lim = dither ? 1 : 0;
+			if(dl < -lim || dl > lim || dr < -lim || dr > lim) {
+				if(err < 4) {
+					utils::format("  %s ch:%d frame %d: %d, %d (ref %d, %d)\n")
+						% name_(fmt) % ch % i % dst_[i].l_ch % dst_[i].r_ch % l % r;
+				}
+				++err;
+			}
+			if(ch == 1 && dst_[i].l_ch != dst_[i].r_ch) ++err;
+			p += bytes * ch;
+		}
+		return err;
+	}
+
+	// 出力側（割り込み）の代わり、書き込み側の時間だけを計る為、まとめて捨てる
+	void consume_()
+	{
+		sum_ += fifo_.get_at().l_ch + fifo_.length();
+		fifo_.clear();
+	}
+
+	// 従来の wav_in::decode と同じ、１サンプル毎の流量制御、変換、格納（16 ビット）
+	void legacy_(const uint8_t* src, uint32_t frames)
+	{
+		const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
+		for(uint32_t i = 0; i < frames; ++i) {
+			while((fifo_.size() - fifo_.length()) < 64) {
+				consume_();
+			}
+			WAVE t;
+			t.l_ch = p[0];
+			t.r_ch = p[1];
+			p += 2;
+			fifo_.put(t);
+		}
+	}
+
+	// チャンク毎の流量制御、ブロック変換、まとめて格納
+	void block_(sound::pcm_conv& conv, sound::pcm_conv::FORMAT fmt, const uint8_t* src, uint32_t frames)
+	{
+		const uint32_t unit = sound::pcm_conv::get_bytes(fmt) * 2;
+		WAVE tmp[CHUNK];
+		for(uint32_t i = 0; i < frames; i += CHUNK) {
+			auto n = std::min(CHUNK, frames - i);
+			conv.convert(fmt, src, 2, n, tmp);
+			while((fifo_.size() - fifo_.length()) < (n + 64)) {
+				consume_();
+			}
+			fifo_.put(tmp, n);
+			src += unit * n;
+		}
+	}
+
+
+	typedef sound::sound_out<int16_t, 2048, 1024> SOUND_OUT;
+	typedef sound::sound_mixer<int16_t, 8, 1024> MIXER;
+	typedef sound::pcm_cache<int16_t, 32768, 4> CACHE;
+
+	SOUND_OUT	sound_out_(0);
+	MIXER		mixer_;
+	CACHE		cache_;
+
+	uint64_t cycle_()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(bench_usec() * 1000.0);  // ns で代用
+#endif
+	}
+
+	void fill_fifo_(MIXER::FIFO& fifo, int32_t& phase)
+	{
+		while((fifo.size() - fifo.length()) > 2) {
+			phase += 1000;
+			WAVE t;
+			t.l_ch = t.r_ch = (phase & 0xffff) - 0x8000;
+			fifo.put(t);
+		}
+	}
+
+	void fill_main_(int32_t& phase)
+	{
+		auto& fifo = sound_out_.at_fifo();
+		while((fifo.size() - fifo.length()) > 2) {
+			phase += 700;
+			WAVE t;
+			t.l_ch = t.r_ch = ((phase & 0xffff) - 0x8000) / 2;
+			fifo.put(t);
+		}
+	}
+
+	// ミキサーの検査
+	uint32_t check_mixer_()
+	{
+		uint32_t err = 0;
+		WAVE src[256];
+		for(uint32_t i = 0; i < 256; ++i) {
+			src[i].l_ch = static_cast<int16_t>(rand32_());
+			src[i].r_ch = static_cast<int16_t>(rand32_());
+		}
+		MIXER mixer;
+		WAVE dst[256];
+
+		// 同じレート、ゲイン 1.0、中央：そのまま
+		for(uint32_t i = 0; i < 256; ++i) dst[i].set(0);
+		mixer.play(0, src, 256, 48'000);
+		mixer.mix(dst, 256);
+		for(uint32_t i = 0; i < 256; ++i) {
+			if(dst[i].l_ch != src[i].l_ch || dst[i].r_ch != src[i].r_ch) ++err;
+		}
+		if(mixer.get_source(0) != MIXER::SOURCE::NONE) ++err;  // 終端で停止
+
+		// 飽和
+		WAVE full[64];
+		for(uint32_t i = 0; i < 64; ++i) {
+			full[i].l_ch = 30000;
+			full[i].r_ch = -30000;
+			dst[i] = full[i];
+		}
+		mixer.play(1, full, 64, 48'000);
+		mixer.mix(dst, 64);
+		for(uint32_t i = 0; i < 64; ++i) {
+			if(dst[i].l_ch != 32767 || dst[i].r_ch != -32768) ++err;
+		}
+
+		// パン（左端）、ゲイン 0.5
+		mixer.set_pan(2, -MIXER::PAN_RANGE);
+		mixer.set_gain(2, MIXER::GAIN_ONE / 2);
+		for(uint32_t i = 0; i < 64; ++i) dst[i].set(0);
+		mixer.play(2, full, 64, 48'000);
+		mixer.mix(dst, 64);
+		for(uint32_t i = 0; i < 64; ++i) {
+			if(dst[i].l_ch != 15000 || dst[i].r_ch != 0) ++err;
+		}
+		mixer.set_pan(2, 0);
+		mixer.set_gain(2, MIXER::GAIN_ONE);
+
+		// 24KHz -> 48KHz：元の値と、中点（線形補間）が交互
+		for(uint32_t i = 0; i < 256; ++i) dst[i].set(0);
+		mixer.play(3, src, 128, 24'000);
+		mixer.mix(dst, 256);
+		for(uint32_t i = 0; i < 254; ++i) {
+			uint32_t j = i / 2;
+			int32_t ref = src[j].l_ch;
+			if(i & 1) {
+				ref = src[j].l_ch + (((static_cast<int32_t>(src[j + 1].l_ch) - src[j].l_ch) * 0x4000) >> 15);
+			}
+			if(dst[i].l_ch != ref) ++err;
+		}
+
+		// FIFO ボイス、sound_out::service からの合成
+		SOUND_OUT so(0);
+		so.set_mixer(mixer);
+		mixer.play(4);
+		for(uint32_t i = 0; i < 100; ++i) {
+			WAVE t;
+			t.l_ch = t.r_ch = 100;
+			so.at_fifo().put(t);
+			t.l_ch = t.r_ch = i;
+			mixer.at_fifo(4).put(t);
+		}
+		so.service(100);
+		for(uint32_t i = 0; i < 100; ++i) {
+			if(so.get_wave(i)->l_ch != static_cast<int32_t>(100 + i)) ++err;
+		}
+		return err;
+	}
+
+	// voices 個のボイス（FIFO, PCM、レートは様々）を合成して、service(64) のサイクル数を計る
+	double bench_mixer_(uint32_t voices)
+	{
+		static const uint32_t rates[4] = { 48'000, 44'100, 22'050, 32'000 };
+		sound_out_.reset_mixer();
+		if(voices > 0) sound_out_.set_mixer(mixer_);
+		int32_t phase[MIXER::size() + 1] = { 0 };
+		for(uint32_t i = 0; i < MIXER::size(); ++i) {
+			mixer_.stop(i);
+			if(i >= voices) continue;
+			mixer_.set_gain(i, MIXER::GAIN_ONE / 4);
+			mixer_.set_pan(i, (i & 1) ? 128 : -128);
+			if(i & 1) {
+				mixer_.set_rate(i, rates[i & 3]);
+				mixer_.play(i);
+			} else {
+				mixer_.play(i, cache_, (i / 2) & 1, true);
+			}
+		}
+		uint64_t sum = 0;
+		const uint32_t blocks = RATE * LOOP / 64;
+		for(uint32_t n = 0; n < blocks; ++n) {
+			fill_main_(phase[MIXER::size()]);
+			for(uint32_t i = 1; i < voices; i += 2) {
+				fill_fifo_(mixer_.at_fifo(i), phase[i]);
+			}
+			auto c0 = cycle_();
+			sound_out_.service(64);
+			sum += cycle_() - c0;
+		}
+		sum_ += sound_out_.get_wave(0)->l_ch;
+		return static_cast<double>(sum) / blocks;
+	}
+
+
+	// FLAC の素材（和音と雑音、無音ブロック、下位ビットが０のブロックを含む）
+	void make_flac_(bench::flac_enc& enc, uint32_t bps, uint32_t rate, uint32_t sec,
+		std::vector<int32_t>& l, std::vector<int32_t>& r)
+	{
+		static const uint32_t BLOCK = 4096;
+		uint32_t num = rate * sec + 1000;  // 最後は半端なブロック
+		l.resize(num);
+		r.resize(num);
+		const double amp = static_cast<double>(1 << (bps - 1)) * 0.3;
+		const int32_t noise = 1 << (bps - 12);
+		for(uint32_t i = 0; i < num; ++i) {
+			double t = static_cast<double>(i) / rate;
+			double env = 0.6 + 0.4 * std::sin(t * 1.3);
+			double a = std::sin(t * 2.0 * M_PI * 440.0) + 0.5 * std::sin(t * 2.0 * M_PI * 660.0)
+				+ 0.25 * std::sin(t * 2.0 * M_PI * 1234.5);
+			double b = std::sin(t * 2.0 * M_PI * 440.0 + 0.3) + 0.4 * std::sin(t * 2.0 * M_PI * 220.0);
+			int32_t n = static_cast<int32_t>(rand32_() % (noise * 2 + 1)) - noise;
+			l[i] = static_cast<int32_t>(a * amp * env) + n;
+			r[i] = static_cast<int32_t>(b * amp * env) - n / 2;
+			uint32_t blk = i / BLOCK;
+			if(blk == 3) {  // 無音（CONSTANT）
+				l[i] = 0;
+				r[i] = 0;
+			} else if(blk == 5) {  // 下位ビットが０（wasted bits）
+				l[i] &= ~3;
+				r[i] &= ~7;
+			} else if(blk == 7) {  // 雑音のみ（VERBATIM）
+				l[i] = static_cast<int32_t>(rand32_()) >> (33 - bps);
+				r[i] = static_cast<int32_t>(rand32_()) >> (33 - bps);
+			}
+		}
+		enc.encode(l.data(), r.data(), num, 2, bps, rate, BLOCK);
+	}
+
+
+	struct mem_read_t {
+		const uint8_t*	src_;
+		uint32_t		len_;
+		uint32_t		pos_;
+
+		uint32_t operator() (void* dst, uint32_t len)
+		{
+			if(len > (len_ - pos_)) len = len_ - pos_;
+			if(dst != nullptr) std::memcpy(dst, src_ + pos_, len);
+			pos_ += len;
+			return len;
+		}
+	};
+
+
+	sound::flac_dec	flac_dec_;
+
+
+	// 復号して、元のサンプルと比較
+	uint32_t check_flac_(const std::vector<uint8_t>& s, const std::vector<int32_t>& l,
+		const std::vector<int32_t>& r, uint32_t bps, uint32_t rate)
+	{
+		uint32_t errs = 0;
+		mem_read_t mr { s.data(), static_cast<uint32_t>(s.size()), 0 };
+		flac_dec_.start(mr);
+		sound::tag_t tag;
+		if(!flac_dec_.read_meta(tag)) return 1;
+		const auto& fi = flac_dec_.get_info();
+		if(fi.rate != rate || fi.bits != bps || fi.channel != 2 || fi.samples != l.size()) ++errs;
+		if(strcmp(tag.get_title().c_str(), "Bench Tone") != 0) ++errs;
+		if(strcmp(tag.get_artist().c_str(), "RX") != 0) ++errs;
+		uint32_t pos = 0;
+		while(1) {
+			auto n = flac_dec_.decode_frame();
+			if(n == 0) break;
+			if(n < 0 || (pos + n) > l.size()) {
+				++errs;
+				break;
+			}
+			const int32_t* dl = flac_dec_.get_sample(0);
+			const int32_t* dr = flac_dec_.get_sample(1);
+			for(int32_t i = 0; i < n; ++i) {
+				if(dl[i] != l[pos + i] || dr[i] != r[pos + i]) {
+					++errs;
+					break;
+				}
+			}
+			pos += n;
+		}
+		if(pos != l.size()) ++errs;
+		return errs;
+	}
+
+
+	// 復号時間（us）、サンプル数を返す
+	double bench_flac_(const uint8_t* src, uint32_t len, uint32_t& samples)
+	{
+		auto t0 = bench_usec();
+		mem_read_t mr { src, len, 0 };
+		flac_dec_.start(mr);
+		sound::tag_t tag;
+		samples = 0;
+		if(!flac_dec_.read_meta(tag)) return 0.0;
+		while(1) {
+			auto n = flac_dec_.decode_frame();
+			if(n == 0) break;
+			if(n < 0) continue;
+			sum_ += flac_dec_.get_sample(0)[0];
+			samples += n;
+		}
+		return bench_usec() - t0;
+	}
+
+
+	bool load_(const char* fname, std::vector<uint8_t>& dst)
+	{
+		FILE* fp = fopen(fname, "rb");
+		if(fp == nullptr) return false;
+		fseek(fp, 0, SEEK_END);
+		dst.resize(ftell(fp));
+		fseek(fp, 0, SEEK_SET);
+		auto n = fread(dst.data(), 1, dst.size(), fp);
+		fclose(fp);
+		return n == dst.size();
+	}
+
+#ifdef USE_MAD
+	// libmad で復号（合成まで）、復号時間（us）、サンプル数、レートを返す
+	double bench_mp3_(const std::vector<uint8_t>& src, uint32_t& samples, uint32_t& rate)
+	{
+		mad_stream stream;
+		mad_frame frame;
+		mad_synth synth;
+		mad_stream_init(&stream);
+		mad_frame_init(&frame);
+		mad_synth_init(&synth);
+		auto t0 = bench_usec();
+		mad_stream_buffer(&stream, src.data(), src.size());
+		samples = 0;
+		rate = 0;
+		while(1) {
+			if(mad_frame_decode(&frame, &stream) != 0) {
+				if(MAD_RECOVERABLE(stream.error)) continue;
+				break;
+			}
+			mad_synth_frame(&synth, &frame);
+			sum_ += synth.pcm.samples[0][0];
+			samples += synth.pcm.length;
+			rate = synth.pcm.samplerate;
+		}
+		auto t = bench_usec() - t0;
+		mad_synth_finish(&synth);
+		mad_frame_finish(&frame);
+		mad_stream_finish(&stream);
+		return t;
+	}
+#endif
+}
+
+
+int main(int argc, char* argv[])
+{
+	static const sound::pcm_conv::FORMAT fmts[] = {
+		sound::pcm_conv::FORMAT::U8,
+		sound::pcm_conv::FORMAT::S16,
+		sound::pcm_conv::FORMAT::S24,
+		sound::pcm_conv::FORMAT::S32,
+		sound::pcm_conv::FORMAT::F32,
+	};
+
+	utils::format("PCM conversion check\n");
+	uint32_t errs = 0;
+	for(auto fmt : fmts) {
+		for(uint32_t ch = 1; ch <= 2; ++ch) {
+			for(uint32_t d = 0; d < 2; ++d) {
+				if(d != 0 && (fmt == sound::pcm_conv::FORMAT::U8 || fmt == sound::pcm_conv::FORMAT::S16)) {
+					continue;
+				}
+				auto e = check_(fmt, ch, d != 0);
+				utils::format("  %s %s%s: %s\n") % name_(fmt) % (ch == 1 ? "mono  " : "stereo")
+					% (d != 0 ? " dither" : "       ") % (e == 0 ? "OK" : "NG");
+				errs += e;
+			}
+		}
+	}
+
+	utils::format("\nKernel throughput (stereo, %d frames / chunk)\n") % CHUNK;
+	for(auto fmt : fmts) {
+		for(uint32_t d = 0; d < 2; ++d) {
+			make_src_(fmt, RATE * 2);
+			sound::pcm_conv conv;
+			conv.enable_dither(d != 0);
+			auto unit = sound::pcm_conv::get_bytes(fmt) * 2;
+			auto t0 = bench_usec();
+			for(uint32_t n = 0; n < LOOP; ++n) {
+				for(uint32_t i = 0; i < RATE; i += CHUNK) {
+					conv.convert(fmt, src_ + i * unit, 2, std::min(CHUNK, RATE - i), dst_ + i);
+				}
+				sum_ += dst_[n].l_ch;
+			}
+			auto t = bench_usec() - t0;
+			utils::format("  %s%s: %6.1f Msamples/s\n") % name_(fmt)
+				% (d != 0 ? " dither" : "       ")
+				% static_cast<float>(static_cast<double>(RATE * 2 * LOOP) / t);
+		}
+	}
+
+	utils::format("\nCPU time / 1 second of 48KHz stereo (convert + FIFO)\n");
+	{
+		make_src_(sound::pcm_conv::FORMAT::S16, RATE * 2);
+		auto t0 = bench_usec();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			legacy_(src_, RATE);
+		}
+		auto t = (bench_usec() - t0) / LOOP;
+		consume_();
+		utils::format("  s16 legacy (per sample): %7.1f us\n") % static_cast<float>(t);
+	}
+	for(auto fmt : fmts) {
+		make_src_(fmt, RATE * 2);
+		sound::pcm_conv conv;
+		auto t0 = bench_usec();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			block_(conv, fmt, src_, RATE);
+		}
+		auto t = (bench_usec() - t0) / LOOP;
+		consume_();
+		utils::format("  %s block:               %7.1f us\n") % name_(fmt) % static_cast<float>(t);
+	}
+
+	utils::format("\nMixer check: ");
+	{
+		auto e = check_mixer_();
+		utils::format("%s\n") % (e == 0 ? "OK" : "NG");
+		errs += e;
+	}
+
+	{
+		WAVE tmp[16384];
+		for(uint32_t i = 0; i < 16384; ++i) {
+			tmp[i].l_ch = static_cast<int16_t>(i * 40);
+			tmp[i].r_ch = -tmp[i].l_ch;
+		}
+		cache_.add(tmp, 16384, 22'050);
+		make_src_(sound::pcm_conv::FORMAT::S24, 8192 * 2);
+		sound::pcm_conv conv;
+		cache_.add(conv, sound::pcm_conv::FORMAT::S24, src_, 2, 8192, 48'000);
+	}
+	utils::format("\nMixer (sound_out::service(64), 48KHz stereo)\n");
+	for(uint32_t v : { 0, 4, 8 }) {
+		auto c = bench_mixer_(v);
+		utils::format("  %d voices: %7.0f cycles / block (%5.1f / frame)\n")
+			% v % static_cast<float>(c) % static_cast<float>(c / 64.0);
+	}
+
+	utils::format("\nFLAC check\n");
+	{
+		static const struct { uint32_t bps; uint32_t rate; } fmt[] = {
+			{ 16, 44'100 }, { 24, 96'000 }
+		};
+		for(const auto& f : fmt) {
+			bench::flac_enc enc;
+			std::vector<int32_t> l, r;
+			make_flac_(enc, f.bps, f.rate, 10, l, r);
+			auto e = check_flac_(enc.get(), l, r, f.bps, f.rate);
+			utils::format("  %d bits, %d Hz: %s (%d bytes, %4.1f %%)\n") % f.bps % f.rate
+				% (e == 0 ? "OK" : "NG") % enc.get().size()
+				% static_cast<float>(100.0 * enc.get().size() / (l.size() * 2 * f.bps / 8));
+			errs += e;
+
+			uint32_t samples = 0;
+			double t = 0.0;
+			for(uint32_t n = 0; n < 4; ++n) {
+				t += bench_flac_(enc.get().data(), enc.get().size(), samples);
+			}
+			t /= 4;
+			double sec = static_cast<double>(samples) / f.rate;
+			utils::format("    decode: %7.1f ms / %4.1f s (x%5.0f realtime)\n")
+				% static_cast<float>(t / 1000.0) % static_cast<float>(sec)
+				% static_cast<float>(sec * 1e6 / t);
+		}
+	}
+
+	for(int i = 1; i < argc; ++i) {
+		std::vector<uint8_t> src;
+		if(!load_(argv[i], src)) {
+			utils::format("Can't open: '%s'\n") % argv[i];
+			continue;
+		}
+		const char* ext = strrchr(argv[i], '.');
+		if(ext != nullptr && strcasecmp(ext, ".flac") == 0) {
+			uint32_t samples = 0;
+			auto t = bench_flac_(src.data(), src.size(), samples);
+			auto rate = flac_dec_.get_info().rate;
+			if(rate == 0) continue;
+			double sec = static_cast<double>(samples) / rate;
+			utils::format("  %s: %7.1f ms / %5.1f s (x%5.0f realtime)\n") % argv[i]
+				% static_cast<float>(t / 1000.0) % static_cast<float>(sec)
+				% static_cast<float>(sec * 1e6 / t);
+		} else if(ext != nullptr && strcasecmp(ext, ".mp3") == 0) {
+#ifdef USE_MAD
+			uint32_t samples = 0;
+			uint32_t rate = 0;
+			auto t = bench_mp3_(src, samples, rate);
+			if(rate == 0) continue;
+			double sec = static_cast<double>(samples) / rate;
+			utils::format("  %s: %7.1f ms / %5.1f s (x%5.0f realtime, libmad)\n") % argv[i]
+				% static_cast<float>(t / 1000.0) % static_cast<float>(sec)
+				% static_cast<float>(sec * 1e6 / t);
+#else
+			utils::format("  %s: MP3 needs 'make MAD=1' (libmad)\n") % argv[i];
+#endif
+		}
+	}
+
+	utils::format("\n(sum: %d)\n") % sum_;
+	if(errs != 0) {
+		utils::format("Check fail: %d\n") % errs;
+		return 1;
+	}
+	return 0;
+}
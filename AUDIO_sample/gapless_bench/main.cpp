@@ -0,0 +1,468 @@
+//=====================================================================//
+/*!	@file
+	@brief	曲間ベンチマーク（ホスト用） @n
+			RAM ディスク上に FAT16 イメージを作成して、WAV、FLAC の曲（と、@n
+			曲では無いファイル）を置き、sound::codec_mgr で続けて再生する。@n
+			出力（割り込み）は、1ms のタイマー・シグナルで sound_out::service を呼ぶ。@n
+			SD カードの読み出し時間、GUI のタグ（アルバム・アート）描画時間を模擬し、@n
+			従来の再生と、曲間を詰めた再生（先読み）で、曲間の途切れ（FIFO が空になった時間）と、@n
+			CPU 負荷（100ms 毎の最大）、最長の連続処理時間を比べる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <signal.h>
+#include <sys/time.h>
+#include "ff14/source/ff.h"
+#include "ff14/source/diskio.h"
+
+extern "C" {
+	uint16_t sci_length();
+	char sci_getch();
+	void set_sample_rate(uint32_t freq);
+};
+
+#include "sound/codec_mgr.hpp"
+#include "AUDIO_sample/bench/flac_enc.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t SECTOR_SIZE = 512;
+	static const uint32_t SECTORS = 65536;			///< 32M バイト
+	static const uint32_t CLUSTER = 8;				///< 4K バイト
+	static const uint32_t FAT_SIZE = 32;			///< FAT16 の１面のセクター数
+	static const uint32_t ROOT_ENTS = 512;
+
+	static const uint32_t SECTOR_US = 250;			///< SD カード（SPI 20MHz）の１セクター読み出し時間（想定）
+	static const uint32_t SEEK_US = 1000;			///< 連続しない読み出しの追加時間（想定）
+	static const uint32_t TICK_MS = 10;				///< codec_task の周期（vTaskDelay）
+	static const uint32_t OUT_RATE = 48'000;
+	static const uint32_t TRACK_MS = 1500;			///< １曲の長さ
+
+	std::vector<uint8_t> disk_;
+	uint32_t	last_sector_ = 0;
+	bool		disk_wait_ = false;
+
+	void wait_us_(double us)
+	{
+		auto t = bench_usec() + us;
+		while(bench_usec() < t) ;
+	}
+
+	void put16_(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+	void put32_(uint8_t* p, uint32_t v) { put16_(p, v); put16_(p + 2, v >> 16); }
+
+
+	// FatFs の f_mkfs は無効（FF_USE_MKFS = 0）なので、SFD の FAT16 を直接作る
+	void format_()
+	{
+		disk_.assign(SECTORS * SECTOR_SIZE, 0);
+		uint8_t* bs = &disk_[0];
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(&bs[3], "MSDOS5.0", 8);
+		put16_(&bs[11], SECTOR_SIZE);
+		bs[13] = CLUSTER;
+		put16_(&bs[14], 1);				// reserved
+		bs[16] = 2;						// FATs
+		put16_(&bs[17], ROOT_ENTS);
+		put16_(&bs[19], 0);				// TotSec16
+		bs[21] = 0xF8;
+		put16_(&bs[22], FAT_SIZE);
+		put16_(&bs[24], 63);
+		put16_(&bs[26], 255);
+		put32_(&bs[28], 0);
+		put32_(&bs[32], SECTORS);
+		bs[36] = 0x80;
+		bs[38] = 0x29;
+		put32_(&bs[39], 0x12345678);
+		memcpy(&bs[43], "NO NAME    ", 11);
+		memcpy(&bs[54], "FAT16   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t* fat = &disk_[(1 + i * FAT_SIZE) * SECTOR_SIZE];
+			put16_(&fat[0], 0xFFF8);
+			put16_(&fat[2], 0xFFFF);
+		}
+	}
+
+
+	bool write_file_(const char* name, const void* src, uint32_t len)
+	{
+		FIL fp;
+		if(f_open(&fp, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+			printf("Can't create: '%s'\n", name);
+			return false;
+		}
+		UINT bw;
+		f_write(&fp, src, len, &bw);
+		f_close(&fp);
+		return bw == len;
+	}
+
+
+	// 曲の素材（曲をまたいで位相が続く和音）
+	uint32_t	phase_ = 0;
+
+	void make_tone_(uint32_t rate, uint32_t num, std::vector<int32_t>& l, std::vector<int32_t>& r)
+	{
+		l.resize(num);
+		r.resize(num);
+		for(uint32_t i = 0; i < num; ++i) {
+			double t = static_cast<double>(phase_ + i) / rate;
+			l[i] = static_cast<int32_t>(8000.0 * std::sin(t * 2.0 * M_PI * 440.0));
+			r[i] = static_cast<int32_t>(8000.0 * std::sin(t * 2.0 * M_PI * 660.0));
+		}
+		phase_ += num;
+	}
+
+
+	bool make_wav_(const char* name, uint32_t rate)
+	{
+		std::vector<int32_t> l, r;
+		uint32_t num = rate * TRACK_MS / 1000;
+		make_tone_(rate, num, l, r);
+		std::vector<uint8_t> f(44 + num * 4);
+		uint8_t* p = f.data();
+		memcpy(p, "RIFF", 4); put32_(p + 4, f.size() - 8);
+		memcpy(p + 8, "WAVEfmt ", 8); put32_(p + 16, 16);
+		put16_(p + 20, 1); put16_(p + 22, 2); put32_(p + 24, rate);
+		put32_(p + 28, rate * 4); put16_(p + 32, 4); put16_(p + 34, 16);
+		memcpy(p + 36, "data", 4); put32_(p + 40, num * 4);
+		for(uint32_t i = 0; i < num; ++i) {
+			put16_(p + 44 + i * 4, l[i]);
+			put16_(p + 46 + i * 4, r[i]);
+		}
+		return write_file_(name, f.data(), f.size());
+	}
+
+
+	bool make_flac_(const char* name, uint32_t rate)
+	{
+		std::vector<int32_t> l, r;
+		uint32_t num = rate * TRACK_MS / 1000;
+		make_tone_(rate, num, l, r);
+		bench::flac_enc enc;
+		enc.encode(l.data(), r.data(), num, 2, 16, rate, 4096);
+		return write_file_(name, enc.get().data(), enc.get().size());
+	}
+
+
+	//-----------------------------------------------------------------//
+	// 出力（割り込み）側
+	//-----------------------------------------------------------------//
+	typedef sound::sound_out<int16_t, 8192, 1024> SOUND_BASE;
+
+	// FIFO の参照（デコーダーが FIFO を調べた時刻から、処理時間を求める）
+	class fifo_ref {
+		SOUND_BASE::FIFO&	fifo_;
+	public:
+		fifo_ref(SOUND_BASE::FIFO& fifo) : fifo_(fifo) { }
+		uint32_t size() const { return fifo_.size(); }
+		uint32_t length() const;
+		void put(const SOUND_BASE::WAVE& v) { fifo_.put(v); }
+		void put(const SOUND_BASE::WAVE* src, uint32_t num) { fifo_.put(src, num); }
+	};
+
+	class sound_out_t {
+		SOUND_BASE	base_;
+		fifo_ref	ref_;
+	public:
+		typedef SOUND_BASE::WAVE WAVE;
+		sound_out_t() : base_(0), ref_(base_.at_fifo()) { }
+		void mute() { base_.mute(); }
+		fifo_ref& at_fifo() { return ref_; }
+		SOUND_BASE& at_base() { return base_; }
+	};
+
+	sound_out_t	sound_out_;
+
+	volatile uint32_t	in_rate_ = OUT_RATE;
+	volatile bool		active_ = false;
+	volatile bool		done_ = false;
+	volatile double		starve_us_ = 0.0;
+	volatile double		gap_us_ = 0.0;
+	volatile double		gap_max_us_ = 0.0;
+	volatile uint32_t	wrong_ = 0;		///< 前の曲の残りを、次の曲のレートで出したフレーム数
+	volatile uint64_t	pulled_ = 0;
+	double		tick_t_ = 0.0;
+	double		tick_frac_ = 0.0;
+
+	void tick_(int)
+	{
+		auto t = bench_usec();
+		double f = (t - tick_t_) * OUT_RATE / 1e6 + tick_frac_;
+		tick_t_ = t;
+		uint32_t n = static_cast<uint32_t>(f);
+		tick_frac_ = f - n;
+		if(n == 0) return;
+
+		auto& fifo = sound_out_.at_base().at_fifo();
+		uint32_t len = fifo.length();
+		if(len > 0) active_ = true;
+		double need = static_cast<double>(n) * in_rate_ / OUT_RATE;
+		if(active_ && !done_ && len < need) {  // 途切れ
+			double us = (need - len) * 1e6 / in_rate_;
+			starve_us_ += us;
+			gap_us_ += us;
+			if(gap_us_ > gap_max_us_) gap_max_us_ = gap_us_;
+		} else {
+			gap_us_ = 0.0;
+		}
+		sound_out_.at_base().service(n);
+		pulled_ += len - fifo.length();
+	}
+
+
+	//-----------------------------------------------------------------//
+	// CPU 負荷（FIFO を調べる間隔が短い＝空き待ち、長い＝処理中）
+	//-----------------------------------------------------------------//
+	static const uint32_t WINDOW_US = 100'000;
+	static const double SPIN_US = 20.0;
+
+	double		org_t_ = 0.0;
+	double		poll_t_ = 0.0;
+	double		busy_max_ = 0.0;
+	std::vector<double>	window_;
+
+	void busy_(double t0, double t1)
+	{
+		if((t1 - t0) > busy_max_) busy_max_ = t1 - t0;
+		t0 -= org_t_;
+		t1 -= org_t_;
+		while(t0 < t1) {
+			uint32_t w = static_cast<uint32_t>(t0 / WINDOW_US);
+			double e = std::min(t1, static_cast<double>(w + 1) * WINDOW_US);
+			if(w >= window_.size()) window_.resize(w + 1, 0.0);
+			window_[w] += e - t0;
+			t0 = e;
+		}
+	}
+
+	void poll_(bool idle = false)
+	{
+		auto t = bench_usec();
+		if(!idle && (t - poll_t_) > SPIN_US) {
+			busy_(poll_t_, t);
+		}
+		poll_t_ = t;
+	}
+
+	uint32_t fifo_ref::length() const
+	{
+		poll_();
+		return fifo_.length();
+	}
+
+
+	//-----------------------------------------------------------------//
+	// タグ表示（GUI のアルバム・アート描画を模擬）
+	//-----------------------------------------------------------------//
+	struct list_ctrl {
+		uint32_t	render_ms_;
+		uint32_t	start_;
+		uint32_t	close_;
+		uint32_t	tag_;
+
+		list_ctrl() : render_ms_(0), start_(0), close_(0), tag_(0) { }
+
+		void start(const char* fn) { ++start_; }
+
+		void close() { ++close_; }
+
+		sound::af_play::CTRL ctrl() { return sound::af_play::CTRL::NONE; }
+
+		void tag(utils::file_io& fin, const sound::tag_t& t)
+		{
+			++tag_;
+			// 画像の読み込みと、描画（audio_gui::render_tag と同じく、ファイル位置は戻す）
+			auto pos = fin.tell();
+			fin.seek(utils::file_io::SEEK::SET, 0);
+			uint8_t tmp[SECTOR_SIZE];
+			for(uint32_t i = 0; i < 8; ++i) fin.read(tmp, sizeof(tmp));
+			fin.seek(utils::file_io::SEEK::SET, pos);
+			wait_us_(render_ms_ * 1000.0);
+		}
+
+		void update(uint32_t t) { }
+	};
+
+	list_ctrl	list_ctrl_;
+
+	typedef sound::codec_mgr<list_ctrl, sound_out_t> CODEC_MGR;
+	CODEC_MGR	codec_mgr_(list_ctrl_, sound_out_);
+
+	static const uint32_t TRACKS = 5;
+	uint64_t	total_frames_ = 0;
+
+
+	void run_(bool gapless, uint32_t render_ms)
+	{
+		codec_mgr_.enable_gapless(gapless);
+		list_ctrl_ = list_ctrl();
+		list_ctrl_.render_ms_ = render_ms;
+		active_ = false;
+		done_ = false;
+		starve_us_ = 0.0;
+		gap_us_ = 0.0;
+		gap_max_us_ = 0.0;
+		wrong_ = 0;
+		pulled_ = 0;
+		window_.clear();
+		busy_max_ = 0.0;
+		disk_wait_ = true;
+
+		org_t_ = bench_usec();
+		poll_t_ = org_t_;
+		codec_mgr_.play("");
+		while(list_ctrl_.close_ < TRACKS) {
+			codec_mgr_.service();
+			poll_();
+			wait_us_(TICK_MS * 1000.0);
+			poll_(true);
+		}
+		done_ = true;
+		auto& fifo = sound_out_.at_base().at_fifo();
+		while(fifo.length() > 0) ;
+		disk_wait_ = false;
+
+		double peak = 0.0;
+		for(auto w : window_) peak = std::max(peak, w);
+		printf("%-8s %4u ms | %7.1f ms %7.1f ms %6u | %5.1f %% %7.1f ms | %u/%u %s\n",
+			gapless ? "gapless" : "legacy", render_ms,
+			starve_us_ / 1000.0, gap_max_us_ / 1000.0, wrong_,
+			100.0 * peak / WINDOW_US, busy_max_ / 1000.0,
+			list_ctrl_.tag_, list_ctrl_.start_,
+			static_cast<uint64_t>(pulled_) == total_frames_ ? "OK" : "NG");
+		sound_out_.mute();
+	}
+}
+
+
+extern "C" {
+
+	uint16_t sci_length() { return 0; }
+	char sci_getch() { return 0; }
+
+	void set_sample_rate(uint32_t freq)
+	{
+		if(freq != in_rate_) {
+			wrong_ += sound_out_.at_base().at_fifo().length();
+		}
+		sound_out_.at_base().set_input_rate(freq);
+		in_rate_ = freq;
+	}
+
+	DSTATUS disk_initialize(BYTE pdrv) { return 0; }
+	DSTATUS disk_status(BYTE pdrv) { return 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(buff, &disk_[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		if(disk_wait_) {
+			wait_us_(count * SECTOR_US + (sector != last_sector_ ? SEEK_US : 0));
+		}
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(&disk_[sector * SECTOR_SIZE], buff, count * SECTOR_SIZE);
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<LBA_t*>(buff) = SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = SECTOR_SIZE;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		}
+		return RES_PARERR;
+	}
+
+	DWORD get_fattime(void)
+	{
+		return (40 << 25) | (1 << 21) | (1 << 16);
+	}
+
+#ifndef USE_MAD
+	// MP3 は使わない（mp3_in のリンク用）
+	void mad_stream_init(struct mad_stream*) { }
+	void mad_stream_finish(struct mad_stream*) { }
+	void mad_stream_buffer(struct mad_stream*, unsigned char const*, unsigned long) { }
+	void mad_header_init(struct mad_header*) { }
+	int mad_header_decode(struct mad_header*, struct mad_stream*) { return -1; }
+	void mad_frame_init(struct mad_frame*) { }
+	void mad_frame_finish(struct mad_frame*) { }
+	int mad_frame_decode(struct mad_frame*, struct mad_stream*) { return -1; }
+	void mad_synth_init(struct mad_synth*) { }
+	void mad_synth_frame(struct mad_synth*, struct mad_frame const*) { }
+#endif
+}
+
+
+int main(int argc, char* argv[])
+{
+	format_();
+	FATFS fs;
+	if(f_mount(&fs, "", 1) != FR_OK) {
+		printf("Mount error\n");
+		return 1;
+	}
+
+	// 曲（44.1KHz）の間に、曲では無いファイルを置き、最後の曲だけ 48KHz
+	bool ok = true;
+	ok &= make_wav_("01 Intro.wav", 44'100);
+	ok &= make_flac_("02 Theme.flac", 44'100);
+	{
+		std::vector<uint8_t> tmp(20'000, 0x55);
+		ok &= write_file_("cover.jpg", tmp.data(), tmp.size());
+		ok &= write_file_("folder.jpg", tmp.data(), tmp.size());
+		ok &= write_file_("album.cue", tmp.data(), 800);
+		ok &= write_file_("rip.log", tmp.data(), 3000);
+		ok &= write_file_("notes.txt", tmp.data(), 100);
+	}
+	ok &= make_wav_("03 Bridge.wav", 44'100);
+	ok &= make_flac_("04 Outro.flac", 44'100);
+	ok &= make_wav_("05 Bonus.wav", 48'000);
+	if(!ok) return 1;
+	total_frames_ = 4 * (44'100 * TRACK_MS / 1000) + 48'000 * TRACK_MS / 1000;
+
+	// 出力（割り込み）
+	tick_t_ = bench_usec();
+	signal(SIGALRM, tick_);
+	struct itimerval it;
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_usec = 1000;
+	it.it_value = it.it_interval;
+	setitimer(ITIMER_REAL, &it, nullptr);
+
+	printf("%u tracks x %u ms, FIFO 8192 frames, SD %u us/sector (+%u us seek), tick %u ms\n\n",
+		TRACKS, TRACK_MS, SECTOR_US, SEEK_US, TICK_MS);
+	printf("mode     render  |     gap    gap max  wrong | CPU peak  max busy | tag/start samples\n");
+	for(uint32_t render : { 20, 150 }) {
+		for(bool gapless : { false, true }) {
+			run_(gapless, render);
+		}
+	}
+	return 0;
+}
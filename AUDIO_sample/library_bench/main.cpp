@@ -0,0 +1,663 @@
+//=====================================================================//
+/*!	@file
+	@brief	ライブラリー索引ベンチマーク（ホスト用） @n
+			RAM ディスク上に FAT16 イメージを作成して、アーティスト／アルバム毎の@n
+			ディレクトリーに、タグ付きの曲（WAV: LIST INFO、MP3: ID3v2.3 と Xing、@n
+			FLAC: VORBIS_COMMENT と PICTURE）を置き、sound::audio_lib で索引を作る。@n
+			曲はヘッダー（タグ）だけで、データは短く切ってある（索引は演奏データを読まない）。@n
+			SD カードの読み書きは、セクター数と、連続しない読み書きの回数から時間を見積もる。@n
+			・全体の走査（索引の作成）@n
+			・索引ファイルの読み込み @n
+			・変更無しの更新、曲の追加、書き換え、削除の後の更新 @n
+			・更新した索引と、作り直した索引の一致 @n
+			・前方一致の検索（二分探索）と、全曲の線形探索の比較
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ff14/source/ff.h"
+#include "ff14/source/diskio.h"
+
+extern "C" {
+	uint16_t sci_length();
+	char sci_getch();
+	void set_sample_rate(uint32_t freq);
+};
+
+#include "sound/audio_lib.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t SECTOR_SIZE = 512;
+	static const uint32_t SECTORS = 65536;			///< 32M バイト
+	static const uint32_t CLUSTER = 8;				///< 4K バイト
+	static const uint32_t FAT_SIZE = 32;			///< FAT16 の１面のセクター数
+	static const uint32_t ROOT_ENTS = 512;
+
+	static const uint32_t SECTOR_US = 250;			///< SD カード（SPI 20MHz）の１セクター読み書き時間（想定）
+	static const uint32_t SEEK_US = 1000;			///< 連続しない読み書きの追加時間（想定）
+
+	static const uint32_t ARTISTS = 40;
+	static const uint32_t ALBUMS = 5;				///< アーティスト毎
+	static const uint32_t TRACKS = 20;				///< アルバム毎
+	static const uint32_t ART_SIZE = 1500;			///< アルバム・アート（MP3, FLAC）
+
+	static const char* IDX = "/audio.idx";
+
+	typedef sound::audio_lib<4096, 512 * 1024, 512, 16 * 1024> AUDIO_LIB;
+	AUDIO_LIB	lib_;
+
+	std::vector<uint8_t> disk_;
+	uint32_t	last_sector_ = 0;
+	uint32_t	rd_sectors_ = 0;
+	uint32_t	wr_sectors_ = 0;
+	uint32_t	seeks_ = 0;
+	uint32_t	fattime_ = (40 << 25) | (1 << 21) | (1 << 16);
+
+	void put16_(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+	void put32_(uint8_t* p, uint32_t v) { put16_(p, v); put16_(p + 2, v >> 16); }
+	void be32_(uint8_t* p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+
+
+	// FatFs の f_mkfs は無効（FF_USE_MKFS = 0）なので、SFD の FAT16 を直接作る
+	void format_()
+	{
+		disk_.assign(SECTORS * SECTOR_SIZE, 0);
+		uint8_t* bs = &disk_[0];
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(&bs[3], "MSDOS5.0", 8);
+		put16_(&bs[11], SECTOR_SIZE);
+		bs[13] = CLUSTER;
+		put16_(&bs[14], 1);				// reserved
+		bs[16] = 2;						// FATs
+		put16_(&bs[17], ROOT_ENTS);
+		put16_(&bs[19], 0);				// TotSec16
+		bs[21] = 0xF8;
+		put16_(&bs[22], FAT_SIZE);
+		put16_(&bs[24], 63);
+		put16_(&bs[26], 255);
+		put32_(&bs[28], 0);
+		put32_(&bs[32], SECTORS);
+		bs[36] = 0x80;
+		bs[38] = 0x29;
+		put32_(&bs[39], 0x12345678);
+		memcpy(&bs[43], "NO NAME    ", 11);
+		memcpy(&bs[54], "FAT16   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t* fat = &disk_[(1 + i * FAT_SIZE) * SECTOR_SIZE];
+			put16_(&fat[0], 0xFFF8);
+			put16_(&fat[2], 0xFFFF);
+		}
+	}
+
+
+	bool write_file_(const char* name, const std::vector<uint8_t>& src)
+	{
+		FIL fp;
+		if(f_open(&fp, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+			printf("Can't create: '%s'\n", name);
+			return false;
+		}
+		UINT bw;
+		f_write(&fp, src.data(), src.size(), &bw);
+		f_close(&fp);
+		return bw == src.size();
+	}
+
+
+	struct song_t {
+		const char*	title;
+		const char*	artist;
+		const char*	album;
+		uint32_t	track;
+		uint32_t	second;
+	};
+
+
+	void add_(std::vector<uint8_t>& f, const void* src, uint32_t len)
+	{
+		auto p = static_cast<const uint8_t*>(src);
+		f.insert(f.end(), p, p + len);
+	}
+
+
+	void add_str_(std::vector<uint8_t>& f, const char* str) { add_(f, str, strlen(str)); }
+
+
+	void add32_(std::vector<uint8_t>& f, uint32_t v, bool be = false)
+	{
+		uint8_t tmp[4];
+		if(be) be32_(tmp, v); else put32_(tmp, v);
+		add_(f, tmp, 4);
+	}
+
+
+	// WAV（LIST INFO、wav_in の対応：INAM タイトル、IPRD アーティスト、IART アルバム）
+	std::vector<uint8_t> make_wav_(const song_t& s)
+	{
+		std::vector<uint8_t> info;
+		add_str_(info, "INFO");
+		char trk[8];
+		snprintf(trk, sizeof(trk), "%u", s.track);
+		const char* key[4] = { "INAM", "IPRD", "IART", "IPRT" };
+		const char* val[4] = { s.title, s.artist, s.album, trk };
+		for(uint32_t i = 0; i < 4; ++i) {
+			uint32_t n = strlen(val[i]) + 1;
+			add_str_(info, key[i]);
+			add32_(info, n);
+			add_(info, val[i], n);
+			if(n & 1) info.push_back(0);
+		}
+		std::vector<uint8_t> f;
+		add_str_(f, "RIFF");
+		add32_(f, 0);
+		add_str_(f, "WAVEfmt ");
+		add32_(f, 16);
+		uint8_t fmt[16];
+		put16_(fmt, 1); put16_(fmt + 2, 2); put32_(fmt + 4, 44'100);
+		put32_(fmt + 8, 44'100 * 4); put16_(fmt + 12, 4); put16_(fmt + 14, 16);
+		add_(f, fmt, sizeof(fmt));
+		add_str_(f, "LIST");
+		add32_(f, info.size());
+		add_(f, info.data(), info.size());
+		add_str_(f, "data");
+		add32_(f, s.second * 44'100 * 4);
+		f.resize(f.size() + 1024, 0);
+		put32_(&f[4], f.size() - 8);
+		return f;
+	}
+
+
+	void id3_text_(std::vector<uint8_t>& f, const char* id, const char* str)
+	{
+		add_str_(f, id);
+		add32_(f, strlen(str) + 1, true);
+		f.push_back(0); f.push_back(0);  // flags
+		f.push_back(0);  // ISO-8859-1
+		add_str_(f, str);
+	}
+
+
+	// MP3（ID3v2.3、Xing ヘッダー付きの MPEG1 Layer III、128Kbps、44.1KHz）
+	std::vector<uint8_t> make_mp3_(const song_t& s)
+	{
+		std::vector<uint8_t> tag;
+		char trk[8];
+		snprintf(trk, sizeof(trk), "%u", s.track);
+		id3_text_(tag, "TIT2", s.title);
+		id3_text_(tag, "TPE1", s.artist);
+		id3_text_(tag, "TALB", s.album);
+		id3_text_(tag, "TRCK", trk);
+		{
+			static const char mime[] = "image/jpeg";
+			add_str_(tag, "APIC");
+			add32_(tag, 1 + sizeof(mime) + 1 + 1 + ART_SIZE, true);
+			tag.push_back(0); tag.push_back(0);
+			tag.push_back(0);
+			add_(tag, mime, sizeof(mime));
+			tag.push_back(3);  // front cover
+			tag.push_back(0);  // description
+			tag.resize(tag.size() + ART_SIZE, 0xaa);
+		}
+		std::vector<uint8_t> f;
+		add_str_(f, "ID3");
+		f.push_back(3); f.push_back(0); f.push_back(0);
+		uint32_t n = tag.size();
+		f.push_back((n >> 21) & 0x7f); f.push_back((n >> 14) & 0x7f);
+		f.push_back((n >> 7) & 0x7f); f.push_back(n & 0x7f);
+		add_(f, tag.data(), tag.size());
+
+		uint32_t top = f.size();
+		f.resize(top + 417, 0);
+		uint8_t* h = &f[top];
+		h[0] = 0xff; h[1] = 0xfb; h[2] = 0x90; h[3] = 0x44;
+		memcpy(h + 4 + 32, "Xing", 4);
+		be32_(h + 4 + 32 + 4, 1);
+		be32_(h + 4 + 32 + 8, s.second * 44'100 / 1152);
+		return f;
+	}
+
+
+	void flac_block_(std::vector<uint8_t>& f, uint32_t type, bool last, uint32_t len)
+	{
+		f.push_back((last ? 0x80 : 0) | type);
+		f.push_back(len >> 16); f.push_back(len >> 8); f.push_back(len);
+	}
+
+
+	// FLAC（STREAMINFO、VORBIS_COMMENT、PICTURE、44.1KHz、16 ビット）
+	std::vector<uint8_t> make_flac_(const song_t& s)
+	{
+		std::vector<uint8_t> f;
+		add_str_(f, "fLaC");
+		flac_block_(f, 0, false, 34);
+		{
+			uint8_t si[34] = { 0 };
+			si[0] = 0x10; si[2] = 0x10;  // 4096
+			uint64_t smp = static_cast<uint64_t>(s.second) * 44'100;
+			uint64_t v = (static_cast<uint64_t>(44'100) << 44) | (1ULL << 41) | (15ULL << 36) | smp;
+			for(uint32_t i = 0; i < 8; ++i) si[10 + i] = v >> (56 - i * 8);
+			add_(f, si, sizeof(si));
+		}
+		{
+			std::vector<uint8_t> vc;
+			static const char vendor[] = "bench";
+			add32_(vc, strlen(vendor));
+			add_str_(vc, vendor);
+			char tmp[256];
+			add32_(vc, 4);
+			const char* key[4] = { "TITLE", "ARTIST", "ALBUM", "TRACKNUMBER" };
+			for(uint32_t i = 0; i < 4; ++i) {
+				if(i == 0) snprintf(tmp, sizeof(tmp), "%s=%s", key[i], s.title);
+				else if(i == 1) snprintf(tmp, sizeof(tmp), "%s=%s", key[i], s.artist);
+				else if(i == 2) snprintf(tmp, sizeof(tmp), "%s=%s", key[i], s.album);
+				else snprintf(tmp, sizeof(tmp), "%s=%u", key[i], s.track);
+				add32_(vc, strlen(tmp));
+				add_str_(vc, tmp);
+			}
+			flac_block_(f, 4, false, vc.size());
+			add_(f, vc.data(), vc.size());
+		}
+		{
+			static const char mime[] = "image/jpeg";
+			std::vector<uint8_t> pic;
+			add32_(pic, 3, true);
+			add32_(pic, strlen(mime), true);
+			add_str_(pic, mime);
+			add32_(pic, 0, true);
+			pic.resize(pic.size() + 16, 0);
+			add32_(pic, ART_SIZE, true);
+			pic.resize(pic.size() + ART_SIZE, 0xaa);
+			flac_block_(f, 6, true, pic.size());
+			add_(f, pic.data(), pic.size());
+		}
+		f.resize(f.size() + 1024, 0);
+		return f;
+	}
+
+
+	static const char* word_[] = {
+		"Blue", "Red", "Silent", "Electric", "Golden", "Midnight", "Paper", "Glass",
+		"River", "Moon", "Echo", "Velvet", "Neon", "Winter", "Summer", "Iron",
+	};
+	static const uint32_t WORDS = sizeof(word_) / sizeof(word_[0]);
+
+	struct name_t {
+		char	artist[32];
+		char	album[32];
+		char	title[48];
+	};
+
+	void names_(uint32_t a, uint32_t b, uint32_t t, name_t& n)
+	{
+		snprintf(n.artist, sizeof(n.artist), "%s %s", word_[a % WORDS], word_[(a / WORDS + a * 3 + 5) % WORDS]);
+		snprintf(n.album, sizeof(n.album), "%s %s %u", word_[(a + b * 7) % WORDS],
+			word_[(b * 5 + a) % WORDS], b + 1);
+		snprintf(n.title, sizeof(n.title), "%s %s No.%u", word_[(a * 11 + b * 3 + t * 5) % WORDS],
+			word_[(a + b + t * 7) % WORDS], a * 100 + b * 20 + t);
+	}
+
+
+	const char* ext_(uint32_t b)
+	{
+		static const char* ext[3] = { "wav", "mp3", "flac" };
+		return ext[b % 3];
+	}
+
+
+	bool make_song_(const char* dir, uint32_t a, uint32_t b, uint32_t t, const char* title = nullptr)
+	{
+		name_t n;
+		names_(a, b, t, n);
+		song_t s;
+		s.title = title != nullptr ? title : n.title;
+		s.artist = n.artist;
+		s.album = n.album;
+		s.track = t + 1;
+		s.second = 150 + (a * 13 + b * 7 + t * 29) % 200;
+		char path[FF_MAX_LFN + 1];
+		if(snprintf(path, sizeof(path), "%s/%02u %s.%s", dir, t + 1, n.title, ext_(b)) >= static_cast<int>(sizeof(path))) {
+			printf("Path too long: '%s'\n", dir);
+			return false;
+		}
+		if(b % 3 == 0) return write_file_(path, make_wav_(s));
+		else if(b % 3 == 1) return write_file_(path, make_mp3_(s));
+		else return write_file_(path, make_flac_(s));
+	}
+
+
+	void album_dir_(uint32_t a, uint32_t b, char* dst, uint32_t len)
+	{
+		name_t n;
+		names_(a, b, 0, n);
+		snprintf(dst, len, "/Music/%02u %s/%s", a, n.artist, n.album);
+	}
+
+
+	bool make_image_()
+	{
+		format_();
+		static FATFS fs;
+		if(f_mount(&fs, "", 1) != FR_OK) {
+			printf("Mount error\n");
+			return false;
+		}
+		bool ok = f_mkdir("/Music") == FR_OK;
+		std::vector<uint8_t> art(20'000, 0x55);
+		for(uint32_t a = 0; a < ARTISTS; ++a) {
+			name_t n;
+			names_(a, 0, 0, n);
+			char tmp[256];
+			snprintf(tmp, sizeof(tmp), "/Music/%02u %s", a, n.artist);
+			ok &= f_mkdir(tmp) == FR_OK;
+			for(uint32_t b = 0; b < ALBUMS; ++b) {
+				album_dir_(a, b, tmp, sizeof(tmp));
+				ok &= f_mkdir(tmp) == FR_OK;
+				for(uint32_t t = 0; t < TRACKS; ++t) {
+					ok &= make_song_(tmp, a, b, t);
+				}
+				char jpg[300];
+				snprintf(jpg, sizeof(jpg), "%s/cover.jpg", tmp);
+				ok &= write_file_(jpg, art);
+			}
+		}
+		return ok;
+	}
+
+
+	//-----------------------------------------------------------------//
+	// 計測
+	//-----------------------------------------------------------------//
+	struct meas_t {
+		double		cpu_us;
+		uint32_t	rd;
+		uint32_t	wr;
+		uint32_t	seek;
+		double sd_ms() const { return ((rd + wr) * SECTOR_US + seek * SEEK_US) / 1000.0; }
+		double total_ms() const { return cpu_us / 1000.0 + sd_ms(); }
+	};
+
+	meas_t		meas_;
+	double		meas_t_;
+
+	void begin_()
+	{
+		rd_sectors_ = 0;
+		wr_sectors_ = 0;
+		seeks_ = 0;
+		meas_t_ = bench_usec();
+	}
+
+	const meas_t& end_()
+	{
+		meas_.cpu_us = bench_usec() - meas_t_;
+		meas_.rd = rd_sectors_;
+		meas_.wr = wr_sectors_;
+		meas_.seek = seeks_;
+		return meas_;
+	}
+
+
+	void print_(const char* title, const meas_t& m)
+	{
+		printf("  %-24s %9.1f ms (CPU %7.1f ms, read %6u, write %5u sectors, %5u seeks)\n",
+			title, m.total_ms(), m.cpu_us / 1000.0, m.rd, m.wr, m.seek);
+	}
+
+
+	// 走査（１回の service の最長時間も求める）
+	bool scan_(const char* title, uint32_t unit)
+	{
+		double step_max = 0.0;
+		begin_();
+		if(!lib_.start("/", IDX)) {
+			printf("Start error\n");
+			return false;
+		}
+		bool ok = true;
+		while(lib_.probe()) {
+			auto t = bench_usec();
+			auto rd = rd_sectors_;
+			auto wr = wr_sectors_;
+			auto sk = seeks_;
+			ok &= lib_.service(unit);
+			double us = (bench_usec() - t) + ((rd_sectors_ - rd) + (wr_sectors_ - wr)) * SECTOR_US
+				+ (seeks_ - sk) * SEEK_US;
+			if(step_max < us) step_max = us;
+		}
+		const auto& m = end_();
+		print_(title, m);
+		const auto& st = lib_.get_stat();
+		printf("  %24s tracks %u, dirs %u (keep %u), parse %u, keep %u, step max %.1f ms%s\n", "",
+			lib_.size(), lib_.get_dir_num(), st.keep_dirs, st.parse, st.keep, step_max / 1000.0,
+			lib_.is_overflow() ? " (overflow)" : "");
+		return ok;
+	}
+
+
+	bool read_all_(const char* name, std::vector<uint8_t>& dst)
+	{
+		FIL fp;
+		if(f_open(&fp, name, FA_READ) != FR_OK) return false;
+		dst.resize(f_size(&fp));
+		UINT br;
+		f_read(&fp, dst.data(), dst.size(), &br);
+		f_close(&fp);
+		return br == dst.size();
+	}
+
+
+	uint32_t rand_ = 12345;
+	uint32_t rand_next_()
+	{
+		rand_ = rand_ * 1103515245 + 12345;
+		return rand_ >> 8;
+	}
+
+
+	// 全曲の線形探索（索引の整列表を使わない場合）
+	uint32_t linear_(AUDIO_LIB::KEY key, const char* text)
+	{
+		uint32_t n = 0;
+		uint32_t len = strlen(text);
+		for(uint32_t i = 0; i < lib_.size(); ++i) {
+			const auto& t = lib_.get(i);
+			const char* s = key == AUDIO_LIB::KEY::ARTIST ? t.get_artist()
+				: (key == AUDIO_LIB::KEY::ALBUM ? t.get_album() : t.get_title());
+			if(strncasecmp(s, text, len) == 0) ++n;
+		}
+		return n;
+	}
+}
+
+
+extern "C" {
+
+	uint16_t sci_length() { return 0; }
+	char sci_getch() { return 0; }
+
+	void set_sample_rate(uint32_t freq) { }
+
+	DSTATUS disk_initialize(BYTE pdrv) { return 0; }
+	DSTATUS disk_status(BYTE pdrv) { return 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(buff, &disk_[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		rd_sectors_ += count;
+		if(sector != last_sector_) ++seeks_;
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(&disk_[sector * SECTOR_SIZE], buff, count * SECTOR_SIZE);
+		wr_sectors_ += count;
+		if(sector != last_sector_) ++seeks_;
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<LBA_t*>(buff) = SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = SECTOR_SIZE;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		}
+		return RES_PARERR;
+	}
+
+	DWORD get_fattime(void)
+	{
+		return fattime_;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(!make_image_()) {
+		printf("Image error\n");
+		return 1;
+	}
+	printf("Audio library index: %u tracks (%u artists x %u albums x %u tracks), WAV/MP3/FLAC\n",
+		ARTISTS * ALBUMS * TRACKS, ARTISTS, ALBUMS, TRACKS);
+	printf("  SD model: %u us/sector, %u us/seek\n\n", SECTOR_US, SEEK_US);
+
+	bool ok = true;
+	ok &= scan_("build (no index)", 1);
+	{
+		FILINFO fi;
+		if(f_stat(IDX, &fi) == FR_OK) {
+			printf("  %24s index file %u bytes (%.1f bytes/track)\n", "",
+				static_cast<uint32_t>(fi.fsize), static_cast<double>(fi.fsize) / lib_.size());
+		}
+	}
+
+	begin_();
+	ok &= lib_.load(IDX);
+	print_("load", end_());
+
+	ok &= scan_("update (no change)", 1);
+
+	// 曲の追加、書き換え（タイトルとサイズが変わる）、削除
+	{
+		fattime_ = (40 << 25) | (2 << 21) | (1 << 16);
+		char dir[256];
+		album_dir_(3, 1, dir, sizeof(dir));
+		ok &= make_song_(dir, 3, 1, TRACKS, "Brand New Song");
+		album_dir_(17, 2, dir, sizeof(dir));
+		ok &= make_song_(dir, 17, 2, 4, "Retagged Song");
+		album_dir_(29, 0, dir, sizeof(dir));
+		name_t n;
+		names_(29, 0, 7, n);
+		char path[FF_MAX_LFN + 1];
+		ok &= snprintf(path, sizeof(path), "%s/%02u %s.%s", dir, 8, n.title, ext_(0)) < static_cast<int>(sizeof(path));
+		ok &= f_unlink(path) == FR_OK;
+	}
+	ok &= scan_("update (+1, ~1, -1 track)", 1);
+	{
+		uint32_t pos;
+		bool f = lib_.size() == ARTISTS * ALBUMS * TRACKS
+			&& lib_.find(AUDIO_LIB::KEY::TITLE, "brand new", pos) == 1
+			&& lib_.find(AUDIO_LIB::KEY::TITLE, "Retagged", pos) == 1;
+		printf("  %24s new/retagged/removed track: %s\n", "", f ? "OK" : "NG");
+		ok &= f;
+	}
+
+	// 更新した索引と、作り直した索引が一致するか
+	{
+		std::vector<uint8_t> upd, full;
+		ok &= read_all_(IDX, upd);
+		ok &= f_unlink(IDX) == FR_OK;
+		ok &= scan_("rebuild (no index)", 1);
+		ok &= read_all_(IDX, full);
+		bool f = upd == full;
+		printf("  %24s updated index == rebuilt index: %s\n", "", f ? "OK" : "NG");
+		ok &= f;
+	}
+
+	// 検索
+	{
+		printf("\nLookup (host CPU, %u tracks)\n", lib_.size());
+		static const AUDIO_LIB::KEY keys[3] = {
+			AUDIO_LIB::KEY::ARTIST, AUDIO_LIB::KEY::ALBUM, AUDIO_LIB::KEY::TITLE };
+		static const char* key_name[3] = { "artist", "album", "title" };
+		static const uint32_t LOOP = 20'000;
+		for(uint32_t k = 0; k < 3; ++k) {
+			uint32_t hit = 0;
+			uint32_t miss = 0;
+			auto t = bench_usec();
+			for(uint32_t i = 0; i < LOOP; ++i) {
+				char tmp[16];
+				snprintf(tmp, sizeof(tmp), "%.*s", 2 + rand_next_() % 4, word_[rand_next_() % WORDS]);
+				uint32_t pos;
+				auto n = lib_.find(keys[k], tmp, pos);
+				if(n > 0) ++hit; else ++miss;
+				if(n > 0 && i < 3) {
+					ok &= n == linear_(keys[k], tmp);
+				}
+			}
+			double bin = (bench_usec() - t) / LOOP;
+			t = bench_usec();
+			uint32_t sum = 0;
+			for(uint32_t i = 0; i < LOOP / 100; ++i) {
+				char tmp[16];
+				snprintf(tmp, sizeof(tmp), "%.*s", 2 + rand_next_() % 4, word_[rand_next_() % WORDS]);
+				sum += linear_(keys[k], tmp);
+			}
+			double lin = (bench_usec() - t) / (LOOP / 100);
+			printf("  %-7s prefix: binary %6.2f us, linear %8.2f us (x%.0f) hit %u/%u (%u)\n",
+				key_name[k], bin, lin, lin / bin, hit, hit + miss, sum);
+		}
+		// 整列順の一覧と、パス
+		auto t = bench_usec();
+		uint32_t n = 0;
+		char path[FF_MAX_LFN + 1];
+		for(uint32_t i = 0; i < lib_.size(); ++i) {
+			auto idx = lib_.get_order(AUDIO_LIB::KEY::ARTIST, i);
+			if(lib_.get_path(idx, path, sizeof(path))) ++n;
+		}
+		printf("  list by artist with path: %.2f us/track (%u)\n", (bench_usec() - t) / lib_.size(), n);
+		// WAV, MP3, FLAC のアルバムの先頭の曲
+		for(uint32_t i = 0; i < 3; ++i) {
+			const auto& tr = lib_.get(i * TRACKS);
+			static const char* codec[4] = { "-", "WAV", "MP3", "FLAC" };
+			printf("  %-4s '%s' / '%s' / %u. '%s' %u:%02u %u Hz, art %u bytes at %u (%s)\n",
+				codec[static_cast<uint32_t>(tr.codec_)], tr.get_artist(), tr.get_album(), tr.track_,
+				tr.get_title(), tr.second_ / 60, tr.second_ % 60, tr.rate_, tr.art_len_, tr.art_ofs_,
+				tr.art_ext_);
+		}
+		{
+			uint32_t pos;
+			auto m = lib_.find(AUDIO_LIB::KEY::ARTIST, "blue", pos);
+			if(m > 0) {
+				lib_.get_path(lib_.get_order(AUDIO_LIB::KEY::ARTIST, pos), path, sizeof(path));
+				printf("  find artist 'blue': %u tracks, first: %s\n", m, path);
+			}
+		}
+	}
+
+	printf("\n%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
@@ -1,11 +1,13 @@
 //=====================================================================//
 /*! @file
     @brief  RX64M/RX65N/RX72N Audio サンプル @n
-			SD-CARD にある MP3、WAV 形式のサファイルを再生する。@n
+			SD-CARD にある MP3、WAV、FLAC 形式のサファイルを再生する。@n
 			オーディオ出力として、マイコン内蔵 D/A 又は、SSIE を選択できる。@n
 			※ D/A を使う場合「#define USE_DAC」@n
 			※ SSIE を使う場合「#define USE_SSIE」(RX72N) @n
-			※ GLCDC を使う場合「#define USE_GLCDC」(RX65N/RX72N)
+			※ GLCDC を使う場合「#define USE_GLCDC」(RX65N/RX72N) @n
+			SD カードがマウントされると、曲の索引（/audio.idx）を読み込み、@n
+			メイン・タスクの合間に、変わったディレクトリーだけ更新する（sound::audio_lib）。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -30,6 +32,7 @@
 #include "sound/sound_out.hpp"
 #include "sound/dac_stream.hpp"
 #include "sound/codec_mgr.hpp"
+#include "sound/audio_lib.hpp"
 
 #if defined(SIG_RX65N) || defined(SIG_RX72N)
 #include "audio_gui.hpp"
@@ -227,6 +230,51 @@ namespace {
 	typedef sound::codec_mgr<list_ctrl, SOUND_OUT> CODEC_MGR;
 	CODEC_MGR	codec_mgr_(list_ctrl_, sound_out_);
 
+	// 曲の索引（１曲、平均 100 バイト程度）
+	static const char* LIB_INDEX = "/audio.idx";
+#if defined(SIG_RX72N)
+	typedef sound::audio_lib<2048, 192 * 1024, 256, 8 * 1024> AUDIO_LIB;
+#else
+	typedef sound::audio_lib<1024, 96 * 1024, 128, 4 * 1024> AUDIO_LIB;
+#endif
+	AUDIO_LIB	lib_;
+	bool		lib_mount_ = false;
+
+	void lib_service_()
+	{
+		auto mount = sdc_.get_mount();
+		if(mount && !lib_mount_) {
+			lib_.load(LIB_INDEX);
+			lib_.start("/", LIB_INDEX);
+		} else if(!mount && lib_mount_) {
+			lib_.stop();
+		}
+		lib_mount_ = mount;
+		if(lib_.probe()) {
+			lib_.service(1);
+			if(!lib_.probe()) {
+				const auto& st = lib_.get_stat();
+				utils::format("Library: %u tracks, %u dirs (parse: %u)%s\n")
+					% lib_.size() % lib_.get_dir_num() % st.parse
+					% (lib_.is_overflow() ? " overflow" : "");
+			}
+		}
+	}
+
+
+	void lib_find_(AUDIO_LIB::KEY key, const char* text)
+	{
+		uint32_t pos;
+		auto n = lib_.find(key, text, pos);
+		for(uint32_t i = 0; i < n; ++i) {
+			const auto& t = lib_.get(lib_.get_order(key, pos + i));
+			utils::format("%s / %s / %2u %s (%u:%02u)\n")
+				% t.get_artist() % t.get_album() % static_cast<uint32_t>(t.track_)
+				% t.get_title() % (t.second_ / 60) % (t.second_ % 60);
+		}
+		utils::format("%u tracks\n") % n;
+	}
+
 #ifdef USE_DAC
 	typedef sound::dac_stream<device::R12DA, device::TPU0, device::DMAC0, SOUND_OUT> DAC_STREAM;
 	DAC_STREAM	dac_stream_(sound_out_);
@@ -288,9 +336,29 @@ namespace {
 			} else {
 				codec_mgr_.play("");
 			}
+		} else if(cmd_.cmp_word(0, "lib")) {  // lib [rescan]
+			if(cmdn >= 2 && cmd_.cmp_word(1, "rescan")) {
+				lib_.start("/", LIB_INDEX);
+			} else if(lib_.probe()) {
+				utils::format("Library: scanning...\n");
+			} else {
+				utils::format("Library: %u tracks, %u dirs\n") % lib_.size() % lib_.get_dir_num();
+			}
+		} else if(cmd_.cmp_word(0, "find") && cmdn >= 3) {  // find artist|album|title text
+			char tmp[64];
+			cmd_.get_word(2, tmp, sizeof(tmp));
+			if(cmd_.cmp_word(1, "artist")) {
+				lib_find_(AUDIO_LIB::KEY::ARTIST, tmp);
+			} else if(cmd_.cmp_word(1, "album")) {
+				lib_find_(AUDIO_LIB::KEY::ALBUM, tmp);
+			} else {
+				lib_find_(AUDIO_LIB::KEY::TITLE, tmp);
+			}
 		} else if(cmd_.cmp_word(0, "help") || cmd_.cmp_word(0, "?")) {
 			shell_.help();
 			utils::format("    play file-name\n");
+			utils::format("    lib [rescan]\n");
+			utils::format("    find artist|album|title text\n");
 		} else {
 			utils::format("Command error: '%s'\n") % cmd_.get_command();
 		}
@@ -498,6 +566,7 @@ extern "C" {
 			if(codec_mgr_.get_state() != sound::af_play::STATE::PLAY) {
 				cmd_service_();
 			}
+			lib_service_();
 			update_led_();
 		}
 	}
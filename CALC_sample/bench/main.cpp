@@ -0,0 +1,432 @@
+//=====================================================================//
+/*!	@file
+	@brief	CALC (mpfr) ベンチマーク（ホスト用） @n
+			CALC_sample の関数セットを、basic_arith で 50 桁、250 桁で評価し、@n
+			１式あたりの時間と、gmp/mpfr のメモリー確保回数を表示する。@n
+			limb プール有り、無しで、結果の文字列が同じか検査する。@n
+			「a * b + c」の式テンプレート（mpfr_fma）と、複合代入の比較も行う。@n
+			basic_arith の analize（毎回解析）と、compile/run（バイトコード）の@n
+			評価速度を、float、double、mpfr::value で比べる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <gmp.h>
+#include "common/format.hpp"
+#include "common/mpfr.hpp"
+#include "common/basic_arith.hpp"
+#include "CALC_sample/calc_symbol.hpp"
+#include "CALC_sample/calc_func.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t LOOP = 200;
+	static const uint32_t HORNER_NUM = 16;
+	static const uint32_t ANS_NUM = 40;
+
+	uint32_t	alloc_num_;
+
+	void* alloc_(size_t n)
+	{
+		++alloc_num_;
+		return malloc(n);
+	}
+
+	void* realloc_(void* p, size_t o, size_t n)
+	{
+		++alloc_num_;
+		return realloc(p, n);
+	}
+
+	void free_(void* p, size_t n)
+	{
+		free(p);
+	}
+
+
+	static const char* expr_[] = {
+		"1+2*3-4/5",
+		"(1.5+2.25)*(3.125-0.5)^2",
+		"sin(30)+cos(60)*tan(45)",
+		"asin(0.5)+acos(0.5)-atan(1)",
+		"sqrt(2)*sqrt(3)+log(1000)-ln(2.5)",
+		"exp10(3)/pi+eu*log2",
+		"((((1.1*x+2.2)*x+3.3)*x+4.4)*x+5.5)",
+	};
+	static const uint32_t EXPR_NUM = sizeof(expr_) / sizeof(expr_[0]);
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  float、double を mpfr::value と同じ形で使うラッパー
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T>
+	class fval {
+		T	v_;
+
+	public:
+		fval() noexcept : v_(0) { }
+		explicit fval(int v) noexcept : v_(v) { }
+		explicit fval(double v) noexcept : v_(v) { }
+		explicit fval(const char* s) noexcept : v_(strtod(s, nullptr)) { }
+
+		// mpfr_const_euler と同じ（オイラー定数）
+		static fval get_pi() noexcept { return fval(3.14159265358979323846); }
+		static fval get_log2() noexcept { return fval(0.69314718055994530942); }
+		static fval get_euler() noexcept { return fval(0.57721566490153286061); }
+
+		void assign(const char* s) noexcept { v_ = strtod(s, nullptr); }
+		void pow(const fval& n) noexcept { v_ = std::pow(v_, n.v_); }
+
+		bool operator == (int v) const noexcept { return v_ == v; }
+		bool operator != (int v) const noexcept { return v_ != v; }
+
+		fval operator - () const noexcept { fval t; t.v_ = -v_; return t; }
+		fval& operator += (const fval& th) noexcept { v_ += th.v_; return *this; }
+		fval& operator -= (const fval& th) noexcept { v_ -= th.v_; return *this; }
+		fval& operator *= (const fval& th) noexcept { v_ *= th.v_; return *this; }
+		fval& operator /= (const fval& th) noexcept { v_ /= th.v_; return *this; }
+		fval operator + (const fval& th) const noexcept { return fval(*this) += th; }
+		fval operator - (const fval& th) const noexcept { return fval(*this) -= th; }
+		fval operator * (const fval& th) const noexcept { return fval(*this) *= th; }
+		fval operator / (const fval& th) const noexcept { return fval(*this) /= th; }
+
+		void operator() (int upn, char* out, uint32_t len) const noexcept
+		{
+			snprintf(out, len, "%.*f", upn, static_cast<double>(v_));
+		}
+
+		static fval func_(T v) noexcept { fval t; t.v_ = v; return t; }
+		static fval sin(const fval& in) noexcept { return func_(std::sin(in.v_)); }
+		static fval cos(const fval& in) noexcept { return func_(std::cos(in.v_)); }
+		static fval tan(const fval& in) noexcept { return func_(std::tan(in.v_)); }
+		static fval asin(const fval& in) noexcept { return func_(std::asin(in.v_)); }
+		static fval acos(const fval& in) noexcept { return func_(std::acos(in.v_)); }
+		static fval atan(const fval& in) noexcept { return func_(std::atan(in.v_)); }
+		static fval sqrt(const fval& in) noexcept { return func_(std::sqrt(in.v_)); }
+		static fval log10(const fval& in) noexcept { return func_(std::log10(in.v_)); }
+		static fval log(const fval& in) noexcept { return func_(std::log(in.v_)); }
+		static fval exp10(const fval& in) noexcept { return func_(std::pow(static_cast<T>(10), in.v_)); }
+	};
+
+
+	template <class NVAL>
+	struct calc_t {
+		typedef utils::calc_symbol<NVAL> SYMBOL;
+		typedef utils::calc_func<NVAL> FUNC;
+		typedef utils::basic_arith<NVAL, SYMBOL, FUNC> ARITH;
+
+		SYMBOL	symbol_;
+		FUNC	func_;
+		ARITH	arith_;
+
+		calc_t() noexcept : symbol_(), func_(), arith_(symbol_, func_) { }
+
+
+		// 関数名、シンボル名を、電卓のコードに置き換える
+		void encode(const char* src, char* dst, uint32_t len) const noexcept
+		{
+			static const struct {
+				const char*	name;
+				uint8_t		code;
+			} tbl[] = {
+				{ "asin",  static_cast<uint8_t>(FUNC::NAME::ASIN) },
+				{ "acos",  static_cast<uint8_t>(FUNC::NAME::ACOS) },
+				{ "atan",  static_cast<uint8_t>(FUNC::NAME::ATAN) },
+				{ "sin",   static_cast<uint8_t>(FUNC::NAME::SIN) },
+				{ "cos",   static_cast<uint8_t>(FUNC::NAME::COS) },
+				{ "tan",   static_cast<uint8_t>(FUNC::NAME::TAN) },
+				{ "sqrt",  static_cast<uint8_t>(FUNC::NAME::SQRT) },
+				{ "log2",  static_cast<uint8_t>(SYMBOL::NAME::LOG2) },
+				{ "log",   static_cast<uint8_t>(FUNC::NAME::LOG) },
+				{ "ln",    static_cast<uint8_t>(FUNC::NAME::LN) },
+				{ "exp10", static_cast<uint8_t>(FUNC::NAME::EXP10) },
+				{ "pi",    static_cast<uint8_t>(SYMBOL::NAME::PI) },
+				{ "eu",    static_cast<uint8_t>(SYMBOL::NAME::EULER) },
+				{ "x",     static_cast<uint8_t>(SYMBOL::NAME::V0) },
+			};
+			while(*src != 0 && len > 1) {
+				bool match = false;
+				for(const auto& t : tbl) {
+					auto l = strlen(t.name);
+					if(strncmp(src, t.name, l) == 0) {
+						*dst++ = static_cast<char>(t.code);
+						src += l;
+						match = true;
+						break;
+					}
+				}
+				if(!match) *dst++ = *src++;
+				--len;
+			}
+			*dst = 0;
+		}
+	};
+
+
+	struct result_t {
+		double		usec_;		///< １回あたりの時間
+		double		alloc_;		///< １回あたりの確保回数
+		uint32_t	expr_alloc_[EXPR_NUM];	///< 式毎の確保回数
+		char		ans_[EXPR_NUM][ANS_NUM + 8];
+	};
+
+
+	template <class NVAL>
+	void run_arith_(result_t& res)
+	{
+		calc_t<NVAL> c;
+		c.symbol_.set_value(calc_t<NVAL>::SYMBOL::NAME::V0, NVAL("1.2345"));
+
+		char code[EXPR_NUM][128];
+		for(uint32_t i = 0; i < EXPR_NUM; ++i) {
+			c.encode(expr_[i], code[i], sizeof(code[i]));
+		}
+
+		alloc_num_ = 0;
+		auto t = bench_usec();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			for(uint32_t i = 0; i < EXPR_NUM; ++i) {
+				c.arith_.analize(code[i]);
+			}
+		}
+		res.usec_ = (bench_usec() - t) / (LOOP * EXPR_NUM);
+		res.alloc_ = static_cast<double>(alloc_num_) / (LOOP * EXPR_NUM);
+
+		for(uint32_t i = 0; i < EXPR_NUM; ++i) {
+			alloc_num_ = 0;
+			auto f = c.arith_.analize(code[i]);
+			res.expr_alloc_[i] = alloc_num_;
+			if(f) {
+				c.arith_()(ANS_NUM, res.ans_[i], sizeof(res.ans_[i]));
+			} else {
+				strcpy(res.ans_[i], "error");
+			}
+		}
+	}
+
+
+	// 多項式（ホーナー法）：acc = acc * x + c
+	template <class NVAL>
+	void run_horner_(result_t& expr, result_t& comp)
+	{
+		NVAL k[HORNER_NUM];
+		for(uint32_t i = 0; i < HORNER_NUM; ++i) {
+			k[i] = NVAL(static_cast<int>(i * 7 + 3)) / NVAL(static_cast<int>(i + 11));
+		}
+		NVAL x("0.98765");
+
+		alloc_num_ = 0;
+		auto t = bench_usec();
+		NVAL acc;
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			acc = 0L;
+			for(uint32_t i = 0; i < HORNER_NUM; ++i) {
+				acc = acc * x + k[i];
+			}
+		}
+		expr.usec_ = (bench_usec() - t) / LOOP;
+		expr.alloc_ = static_cast<double>(alloc_num_) / LOOP;
+		acc(ANS_NUM, expr.ans_[0], sizeof(expr.ans_[0]));
+
+		alloc_num_ = 0;
+		t = bench_usec();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			acc = 0L;
+			for(uint32_t i = 0; i < HORNER_NUM; ++i) {
+				acc *= x;
+				acc += k[i];
+			}
+		}
+		comp.usec_ = (bench_usec() - t) / LOOP;
+		comp.alloc_ = static_cast<double>(alloc_num_) / LOOP;
+		acc(ANS_NUM, comp.ans_[0], sizeof(comp.ans_[0]));
+	}
+
+
+	// 式テンプレートの各形と、複合代入で求めた値を比べる（ANS_NUM 桁）
+	template <class NVAL>
+	bool check_expr_()
+	{
+		NVAL a("1.25");
+		NVAL b("-3.5");
+		NVAL c("0.75");
+		NVAL d("2.125");
+		a /= NVAL(7);
+		c /= NVAL(3);
+
+		NVAL ref[7];
+		ref[0] = a; ref[0] *= b; ref[0] += c;
+		ref[1] = a; ref[1] *= b; ref[1] -= c;
+		ref[2] = c; { NVAL t(a); t *= b; ref[2] -= t; }
+		ref[3] = a; ref[3] *= b; { NVAL t(c); t *= d; ref[3] += t; }
+		ref[4] = a; ref[4] *= b; { NVAL t(c); t *= d; ref[4] -= t; }
+		ref[5] = a; ref[5] *= b; ref[5] += c; ref[5] *= d;
+		ref[6] = a; ref[6] *= a;
+
+		NVAL out[7];
+		out[0] = a * b + c;
+		out[1] = a * b - c;
+		out[2] = c - a * b;
+		out[3] = a * b + c * d;
+		out[4] = a * b - c * d;
+		out[5] = (a * b + c) * d;
+		out[6] = a * a;
+
+		bool ok = true;
+		for(uint32_t i = 0; i < 7; ++i) {
+			char r[ANS_NUM + 8];
+			char o[ANS_NUM + 8];
+			ref[i](ANS_NUM, r, sizeof(r));
+			out[i](ANS_NUM, o, sizeof(o));
+			if(strcmp(r, o) != 0) {
+				printf("  expression %u differs: %s / %s\n", i, r, o);
+				ok = false;
+			}
+		}
+		return ok;
+	}
+
+
+	static const char* formula_[] = {
+		"x*x*x-2*x+1",
+		"(1+2*3)*x^2-4/5*x+ln(2)",
+		"sin(x)*cos(x)+sqrt(x*x+1)",
+		"exp10(x/10)-log(x+1)",
+	};
+	static const uint32_t FORMULA_NUM = sizeof(formula_) / sizeof(formula_[0]);
+	static const uint32_t BIND_NUM = 500;
+
+
+	// analize（毎回解析）と compile/run（バイトコード）で、x を変えて評価する
+	template <class NVAL>
+	bool run_vm_(const char* name)
+	{
+		typedef calc_t<NVAL> CALC;
+		CALC c;
+		typename CALC::ARITH::program prog;
+		const auto V0 = CALC::SYMBOL::NAME::V0;
+
+		bool ok = true;
+		for(uint32_t i = 0; i < FORMULA_NUM; ++i) {
+			char code[128];
+			c.encode(formula_[i], code, sizeof(code));
+
+			auto t = bench_usec();
+			for(uint32_t n = 0; n < BIND_NUM; ++n) {
+				c.symbol_.set_value(V0, NVAL(0.5 + n * 0.01));
+				c.arith_.analize(code);
+			}
+			auto ta = bench_usec() - t;
+
+			t = bench_usec();
+			c.arith_.compile(code, prog);
+			for(uint32_t n = 0; n < BIND_NUM; ++n) {
+				c.symbol_.set_value(V0, NVAL(0.5 + n * 0.01));
+				c.arith_.run(prog);
+			}
+			auto tr = bench_usec() - t;
+
+			printf("  %-8s %-26s code %2u: analize %7.3f, run %7.3f Meval/s (x%.1f)\n",
+				name, formula_[i], prog.size(),
+				BIND_NUM / ta, BIND_NUM / tr, ta / tr);
+
+			// 結果の比較
+			for(uint32_t n = 0; n < BIND_NUM; n += 25) {
+				char a[ANS_NUM + 8];
+				char r[ANS_NUM + 8];
+				c.symbol_.set_value(V0, NVAL(0.5 + n * 0.01));
+				c.arith_.analize(code);
+				c.arith_()(ANS_NUM, a, sizeof(a));
+				c.arith_.run(prog);
+				c.arith_()(ANS_NUM, r, sizeof(r));
+				if(strcmp(a, r) != 0) {
+					printf("    x = %u: %s / %s\n", n, a, r);
+					ok = false;
+				}
+			}
+		}
+
+		// エラーの扱いが同じか
+		static const char* err[] = { "1/(x-x)", "2//(x-x)", "\xF0(x)", "1+", "(1" };
+		for(auto e : err) {
+			char code[32];
+			c.encode(e, code, sizeof(code));
+			auto fa = c.arith_.analize(code);
+			auto ea = c.arith_.get_error()();
+			auto fr = c.arith_.compile(code, prog) && c.arith_.run(prog);
+			auto er = c.arith_.get_error()();
+			if(fa != fr || ea != er) {
+				printf("    error differs: '%s' %04X / %04X\n", e, ea, er);
+				ok = false;
+			}
+		}
+		return ok;
+	}
+
+
+	void print_(const char* name, uint32_t digits, const result_t& r)
+	{
+		printf("%-24s %3u digits: %8.2f us, %6.2f alloc\n", name, digits, r.usec_, r.alloc_);
+	}
+
+
+	template <uint32_t BITS>
+	bool run_(uint32_t digits)
+	{
+		static result_t pool;
+		static result_t none;
+		run_arith_<mpfr::value<BITS, 0> >(none);
+		print_("basic_arith (no pool)", digits, none);
+		run_arith_<mpfr::value<BITS> >(pool);
+		print_("basic_arith (pool)", digits, pool);
+
+		bool ok = true;
+		for(uint32_t i = 0; i < EXPR_NUM; ++i) {
+			printf("  %-38s alloc %2u -> %2u\n", expr_[i], none.expr_alloc_[i], pool.expr_alloc_[i]);
+			if(strcmp(none.ans_[i], pool.ans_[i]) != 0) {
+				printf("  '%s' differs: %s / %s\n", expr_[i], none.ans_[i], pool.ans_[i]);
+				ok = false;
+			}
+		}
+
+		static result_t expr;
+		static result_t comp;
+		run_horner_<mpfr::value<BITS> >(expr, comp);
+		print_("horner acc = acc * x + k", digits, expr);
+		print_("horner acc *= x, += k", digits, comp);
+		printf("  %s\n  %s\n", expr.ans_[0], comp.ans_[0]);
+		if(!check_expr_<mpfr::value<BITS> >()) ok = false;
+		if(mpfr::limb_pool<BITS, 32>::get_miss() != 0) {
+			printf("  limb pool miss: %u\n", mpfr::limb_pool<BITS, 32>::get_miss());
+		}
+		return ok;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	mp_set_memory_functions(alloc_, realloc_, free_);
+
+	// 桁数から、ビット数へ（log2(10) = 3.32）
+	bool ok = run_<168>(50);
+	ok = run_<832>(250) && ok;
+
+	printf("basic_arith analize / compile + run (%u bindings)\n", BIND_NUM);
+	ok = run_vm_<fval<float> >("float") && ok;
+	ok = run_vm_<fval<double> >("double") && ok;
+	ok = run_vm_<mpfr::value<168> >("mpfr 50") && ok;
+	ok = run_vm_<mpfr::value<832> >("mpfr 250") && ok;
+
+	printf("%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
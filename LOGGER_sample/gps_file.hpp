@@ -1,15 +1,21 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	ＧＰＳファイル操作
+	@brief	ＧＰＳファイル操作 @n
+			測位情報を、トラック形式（gps_track.hpp）で記録する。@n
+			start、add、lap、stop は UI 側から呼び、RAM 上のブロックに符号化する。@n
+			service はファイル・タスクから呼び、埋まったブロックを SD カードに書く。@n
+			SD カードの書き込みが遅れても、UI 側（ラップタイマー）は待たされない。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2019 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2019, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
 #include "common/format.hpp"
 #include "common/file_io.hpp"
+#include "common/nmea_dec.hpp"
+#include "gps_track.hpp"
 
 namespace utils {
 
@@ -19,16 +25,57 @@ namespace utils {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class gps_file {
+	public:
+		typedef track_writer<1024, 500> WRITER;
 
+	private:
 		enum class MODE : uint8_t {
 			NONE,	///< 何もしない
 			OPEN,	///< ファイルオープン
 			WRITE,	///< 書き込み
 			CLOSE,	///< クローズ
 		};
-		MODE			mode_;
+		volatile MODE	mode_;
 
+		WRITER			writer_;
 		utils::file_io	file_;
+		char			name_[32];
+
+		volatile bool	open_req_;
+		volatile bool	close_req_;
+		volatile bool	name_ok_;
+		bool			active_;
+
+		uint64_t		sync_ms_;
+		uint32_t		sync_tick_;
+		bool			sync_;
+
+		uint32_t		error_;
+
+		void make_file_name_(time_t t, char* out, uint32_t len)
+		{
+			struct tm *m = localtime(&t);
+			utils::sformat("%04d%s%02d%02d%02d.trk", out, len)
+				% static_cast<uint32_t>(m->tm_year + 1900)
+				% get_mon(m->tm_mon)
+				% static_cast<uint32_t>(m->tm_mday)
+				% static_cast<uint32_t>(m->tm_hour)
+				% static_cast<uint32_t>(m->tm_min)
+			;
+		}
+
+
+		void write_blocks_() noexcept
+		{
+			const uint8_t* p;
+			while((p = writer_.get_block()) != nullptr) {
+				if(file_.write(p, gps_track::BLOCK_SIZE) != gps_track::BLOCK_SIZE) {
+					++error_;
+				}
+				file_.flush();
+				writer_.release_block();
+			}
+		}
 
 	public:
 		//-------------------------------------------------------------//
@@ -37,38 +84,188 @@ namespace utils {
 		*/
 		//-------------------------------------------------------------//
 		gps_file() :
-			mode_(MODE::NONE), file_()
+			mode_(MODE::NONE), writer_(), file_(), name_{ 0 },
+			open_req_(false), close_req_(false), name_ok_(false), active_(false),
+			sync_ms_(0), sync_tick_(0), sync_(false), error_(0)
 		{ }
 
 
 		//-------------------------------------------------------------//
 		/*!
-			@brief	サービス
+			@brief	記録の開始（UI 側） @n
+					ファイル名は、最初の有効な測位時刻から作る。
+			@return 前の記録を書き終えていない場合「false」
+		*/
+		//-------------------------------------------------------------//
+		bool start() noexcept
+		{
+			if(busy()) return false;
+
+			writer_.reset();
+			error_ = 0;
+			name_ok_ = false;
+			active_ = true;
+			open_req_ = true;
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	測位情報を追加（UI 側）
+			@param[in]	fix		測位情報
+			@param[in]	tick	受信した時のラップタイマー（ms）
+		*/
+		//-------------------------------------------------------------//
+		void add(const nmea_parse::fix_t& fix, uint32_t tick) noexcept
+		{
+			if(fix.time == 0) return;
+
+			sync_ms_ = gps_track::to_msec(fix.time, fix.msec);
+			sync_tick_ = tick;
+			sync_ = true;
+
+			if(!active_ || !fix.valid || fix.quality == 0) return;
+
+			if(!name_ok_) {
+				make_file_name_(fix.time, name_, sizeof(name_));
+				name_ok_ = true;
+			}
+
+			gps_track::point_t pt;
+			pt.time = fix.time;
+			pt.msec = fix.msec;
+			pt.lat = fix.lat;
+			pt.lon = fix.lon;
+			pt.alt = fix.alt;
+			pt.speed = fix.speed;
+			writer_.add(pt);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ラップを追加（UI 側） @n
+					直前の測位時刻と、その時のラップタイマーから、ラップの時刻を求める。
+			@param[in]	tick	ラップのラップタイマー（ms）
+		*/
+		//-------------------------------------------------------------//
+		void lap(uint32_t tick) noexcept
+		{
+			if(!active_ || !sync_) return;
+
+			writer_.lap(sync_ms_ + static_cast<int32_t>(tick - sync_tick_));
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	記録の終了（UI 側） @n
+					残りのブロックと索引は、ファイル側で書く。
+		*/
+		//-------------------------------------------------------------//
+		void stop() noexcept
+		{
+			if(!active_) return;
+
+			active_ = false;
+			writer_.finish();
+			close_req_ = true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ファイル側の処理中か
+			@return 処理中なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool busy() const noexcept
+		{
+			return open_req_ || close_req_ || mode_ != MODE::NONE;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	サービス（ファイル・タスク）
 		*/
 		//-------------------------------------------------------------//
-		void service()
+		void service() noexcept
 		{
 			switch(mode_) {
 			case MODE::NONE:
+				// ファイルを開けなかった（SD カードが無い等）、又は、有効な測位が無いまま終了
+				if(close_req_ && (!open_req_ || !name_ok_)) {
+					open_req_ = false;
+					close_req_ = false;
+					break;
+				}
+				if(open_req_ && name_ok_) {
+					mode_ = MODE::OPEN;
+				}
 				break;
 			case MODE::OPEN:
-				if(n > 0) {
-					if(!file_.is_open()) {
-						auto t = nmea.get_gmtime();
-						char tmp[32];
-						make_file_name_(t, tmp, sizeof(tmp));
-						file_.open(tmp, "wb");
-					} else {
-						gps_mode_ = GPS_MODE::WRITE;
-						gps_fifo_.clear();
-					}
+				if(file_.open(name_, "wb")) {
+					mode_ = MODE::WRITE;
+				} else {
+					utils::format("GPS file can't open: '%s'\n") % name_;
+					++error_;
+					open_req_ = false;
+					close_req_ = false;
+					mode_ = MODE::NONE;
 				}
 				break;
 			case MODE::WRITE:
+				write_blocks_();
+				if(close_req_) {
+					mode_ = MODE::CLOSE;
+				}
 				break;
 			case MODE::CLOSE:
+				write_blocks_();
+				for(uint32_t i = 0; i < writer_.get_index_block_num(); ++i) {
+					auto p = writer_.make_index_block(i);
+					if(file_.write(p, gps_track::BLOCK_SIZE) != gps_track::BLOCK_SIZE) {
+						++error_;
+					}
+				}
+				file_.close();
+				if(writer_.get_block_num() == 0) {
+					utils::file_io::remove(name_);
+				}
+				open_req_ = false;
+				close_req_ = false;
+				mode_ = MODE::NONE;
 				break;
 			}
 		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ファイル名を取得
+			@return ファイル名
+		*/
+		//-------------------------------------------------------------//
+		const char* get_name() const noexcept { return name_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	WRITER の参照
+			@return WRITER
+		*/
+		//-------------------------------------------------------------//
+		const WRITER& get_writer() const noexcept { return writer_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	書き込みエラーの数を取得
+			@return エラーの数
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_error() const noexcept { return error_; }
 	};
 }
@@ -0,0 +1,813 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ＧＰＳトラック・ファイル（形式、書き込み、読み出し） @n
+			測位点（時刻、緯度、経度、高度、速度）を、固定小数点の差分にして、@n
+			可変長整数（varint）で、4K バイトのブロックに詰める。@n
+			・ブロックのヘッダーは、最初の測位点（絶対値）と時刻を持ち、単独で復号出来る。@n
+			・二つ目以降の測位点は、時間差（ms）、緯度、経度は二階差分（前の差分を予測値 @n
+			  とした誤差）、高度、速度は一階差分を、zigzag 符号化して、varint で書く。@n
+			・時間差が０のレコードはラップで、直前の測位点からの時間差（ms）が続く。@n
+			・ファイルの最後に、ブロックの開始時刻と、ラップ時刻の索引ブロックを置く。@n
+			  索引が無い場合（書き込み中の電源断など）は、ブロックを走査して作り直す。@n
+			・ファイルの大きさは、常にブロックの整数倍（余りは０で埋める）@n
+			ブロック・ヘッダー（40 バイト、リトルエンディアン）@n
+			  0: "GTRK"、4: 版、5: フラグ（０）、6: 測位点数、8: データ長、10: データの和 @n
+			  12: ブロック番号、16: 時刻（秒）、20: 時刻（ms）、22: ０ @n
+			  24: 緯度（1e-7 度）、28: 経度（1e-7 度）、32: 高度（cm）、36: 速度（0.01 km/h）@n
+			索引ブロック・ヘッダー（16 バイト）@n
+			  0: "GIDX"、4: 版、5: 種類（0: ブロック、1: ラップ）、6: 項目数、8: 項目の和 @n
+			  10: ０、12: データ・ブロック数 @n
+			  項目（8 バイト）: 時刻（秒）、時刻（ms）、０
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include "common/time.h"
+#include "common/file_io.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ＧＰＳトラック基本クラス（形式の定義）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class gps_track {
+	public:
+		static const uint32_t BLOCK_SIZE = 4096;					///< ブロックの大きさ
+		static const uint32_t HEAD_SIZE = 40;						///< ブロック・ヘッダーの大きさ
+		static const uint32_t DATA_SIZE = BLOCK_SIZE - HEAD_SIZE;	///< ブロックのデータ領域
+		static const uint32_t IDX_HEAD_SIZE = 16;					///< 索引ブロック・ヘッダーの大きさ
+		static const uint32_t IDX_NUM = (BLOCK_SIZE - IDX_HEAD_SIZE) / 8;	///< 索引ブロックの項目数
+		static const uint8_t VERSION = 1;
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  測位点
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct point_t {
+			time_t		time;		///< 測位時刻（GMT、1970 年からの秒）
+			uint16_t	msec;		///< 測位時刻のミリ秒
+			int32_t		lat;		///< 緯度（1e-7 度）
+			int32_t		lon;		///< 経度（1e-7 度）
+			int32_t		alt;		///< 海抜高度（cm）
+			uint32_t	speed;		///< 対地速度（0.01 km/h）
+
+			point_t() noexcept : time(0), msec(0), lat(0), lon(0), alt(0), speed(0) { }
+		};
+
+	protected:
+		static const uint32_t POINT_MAX = 5 * 5;	///< 測位点レコードの最大長
+		static const uint32_t EVENT_MAX = 1 + 5;	///< ラップ・レコードの最大長
+
+		static void put16_(uint8_t* p, uint32_t v) noexcept { p[0] = v; p[1] = v >> 8; }
+		static void put32_(uint8_t* p, uint32_t v) noexcept { put16_(p, v); put16_(p + 2, v >> 16); }
+		static uint32_t get16_(const uint8_t* p) noexcept { return p[0] | (p[1] << 8); }
+		static uint32_t get32_(const uint8_t* p) noexcept { return get16_(p) | (get16_(p + 2) << 16); }
+
+		static uint32_t zigzag_(uint32_t v) noexcept
+		{
+			return (v << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(v) >> 31);
+		}
+
+		static uint32_t unzigzag_(uint32_t v) noexcept { return (v >> 1) ^ (0 - (v & 1)); }
+
+		static uint8_t* put_var_(uint8_t* p, uint32_t v) noexcept
+		{
+			while(v >= 0x80) {
+				*p++ = v | 0x80;
+				v >>= 7;
+			}
+			*p++ = v;
+			return p;
+		}
+
+		static const uint8_t* get_var_(const uint8_t* p, const uint8_t* end, uint32_t& v) noexcept
+		{
+			v = 0;
+			for(uint32_t sh = 0; sh < 35; sh += 7) {
+				if(p >= end) return nullptr;
+				auto c = *p++;
+				v |= static_cast<uint32_t>(c & 0x7f) << sh;
+				if((c & 0x80) == 0) return p;
+			}
+			return nullptr;
+		}
+
+		static uint16_t sum_(const uint8_t* p, uint32_t len) noexcept
+		{
+			uint16_t sum = 0;
+			while(len > 0) {
+				sum += *p++;
+				--len;
+			}
+			return sum;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  時刻をミリ秒に変換
+			@param[in]	t	時刻（秒）
+			@param[in]	ms	ミリ秒
+			@return 1970 年からのミリ秒
+		*/
+		//-----------------------------------------------------------------//
+		static uint64_t to_msec(time_t t, uint16_t ms) noexcept
+		{
+			return static_cast<uint64_t>(static_cast<uint32_t>(t)) * 1000 + ms;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  測位点の時刻をミリ秒で取得
+			@param[in]	pt	測位点
+			@return 1970 年からのミリ秒
+		*/
+		//-----------------------------------------------------------------//
+		static uint64_t to_msec(const point_t& pt) noexcept { return to_msec(pt.time, pt.msec); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ＧＰＳトラック書き込みクラス @n
+				add、lap は、UI 側（ラップタイマー）から呼び、RAM 上で符号化するだけ。@n
+				埋まったブロックは、ファイル側（別タスク）が get_block で取り出して書き、@n
+				release_block で返す。@n
+				ブロック・バッファは二つで、両方とも書き込み待ちの場合は、測位点を捨てる。
+		@param[in]	BMAX	最大ブロック数（ブロック索引の大きさ）
+		@param[in]	LMAX	最大ラップ数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t BMAX, uint32_t LMAX>
+	class track_writer : public gps_track {
+
+		uint8_t		buff_[2][BLOCK_SIZE];
+		volatile bool	full_[2];
+		uint8_t		put_;
+		uint8_t		get_;
+
+		bool		open_;
+		uint16_t	num_;
+		uint16_t	used_;
+		uint16_t	dsum_;
+
+		uint64_t	pms_;
+		uint32_t	plat_;
+		uint32_t	plon_;
+		uint32_t	palt_;
+		uint32_t	pspd_;
+		uint32_t	dlat_;
+		uint32_t	dlon_;
+
+		uint64_t	idx_[BMAX];
+		uint32_t	seq_;
+		uint64_t	lap_[LMAX];
+		uint32_t	lap_num_;
+
+		uint32_t	point_num_;
+		uint32_t	drop_;
+
+		bool begin_block_(const point_t& pt, uint64_t ms) noexcept
+		{
+			if(full_[put_]) return false;
+			if(seq_ >= BMAX) return false;
+
+			auto p = buff_[put_];
+			memcpy(p, "GTRK", 4);
+			p[4] = VERSION;
+			p[5] = 0;
+			put32_(&p[12], seq_);
+			put32_(&p[16], static_cast<uint32_t>(pt.time));
+			put16_(&p[20], pt.msec);
+			put16_(&p[22], 0);
+			put32_(&p[24], pt.lat);
+			put32_(&p[28], pt.lon);
+			put32_(&p[32], pt.alt);
+			put32_(&p[36], pt.speed);
+
+			idx_[seq_] = ms;
+			open_ = true;
+			num_ = 1;
+			used_ = 0;
+			dsum_ = 0;
+			pms_ = ms;
+			plat_ = pt.lat;
+			plon_ = pt.lon;
+			palt_ = pt.alt;
+			pspd_ = pt.speed;
+			dlat_ = 0;
+			dlon_ = 0;
+			++point_num_;
+			return true;
+		}
+
+
+		void close_block_() noexcept
+		{
+			auto p = buff_[put_];
+			put16_(&p[6], num_);
+			put16_(&p[8], used_);
+			put16_(&p[10], dsum_);
+			memset(&p[HEAD_SIZE + used_], 0, DATA_SIZE - used_);
+			std::atomic_signal_fence(std::memory_order_release);
+			full_[put_] = true;
+			put_ ^= 1;
+			open_ = false;
+			++seq_;
+		}
+
+
+		void add_sum_(const uint8_t* org, const uint8_t* end) noexcept
+		{
+			while(org < end) {
+				dsum_ += *org++;
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		track_writer() noexcept { reset(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リセット（ファイル側が動いていない時に呼ぶ）
+		*/
+		//-----------------------------------------------------------------//
+		void reset() noexcept
+		{
+			full_[0] = false;
+			full_[1] = false;
+			put_ = 0;
+			get_ = 0;
+			open_ = false;
+			num_ = 0;
+			used_ = 0;
+			dsum_ = 0;
+			pms_ = 0;
+			seq_ = 0;
+			lap_num_ = 0;
+			point_num_ = 0;
+			drop_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  測位点を追加 @n
+					時刻が進まない測位点は捨てる。
+			@param[in]	pt	測位点
+			@return 追加出来たら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool add(const point_t& pt) noexcept
+		{
+			auto ms = to_msec(pt);
+			if(ms <= pms_) return false;
+
+			if(open_) {
+				if((used_ + POINT_MAX) > DATA_SIZE || num_ >= 0xffff || (ms - pms_) > 0xffffffff) {
+					close_block_();
+				}
+			}
+			if(!open_) {
+				if(!begin_block_(pt, ms)) {
+					++drop_;
+					return false;
+				}
+				return true;
+			}
+
+			auto org = &buff_[put_][HEAD_SIZE + used_];
+			auto p = put_var_(org, ms - pms_);
+			uint32_t d = static_cast<uint32_t>(pt.lat) - plat_;
+			p = put_var_(p, zigzag_(d - dlat_));
+			dlat_ = d;
+			d = static_cast<uint32_t>(pt.lon) - plon_;
+			p = put_var_(p, zigzag_(d - dlon_));
+			dlon_ = d;
+			p = put_var_(p, zigzag_(static_cast<uint32_t>(pt.alt) - palt_));
+			p = put_var_(p, zigzag_(pt.speed - pspd_));
+			add_sum_(org, p);
+			used_ += p - org;
+			++num_;
+
+			pms_ = ms;
+			plat_ = pt.lat;
+			plon_ = pt.lon;
+			palt_ = pt.alt;
+			pspd_ = pt.speed;
+			++point_num_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ラップを追加 @n
+					索引に加え、ブロックが開いていれば、ラップ・レコードも書く。
+			@param[in]	ms	ラップの時刻（1970 年からのミリ秒）
+		*/
+		//-----------------------------------------------------------------//
+		void lap(uint64_t ms) noexcept
+		{
+			if(lap_num_ < LMAX) {
+				lap_[lap_num_] = ms;
+				++lap_num_;
+			}
+			if(!open_ || (used_ + EVENT_MAX) > DATA_SIZE) return;
+			int64_t d = static_cast<int64_t>(ms - pms_);
+			if(d < INT32_MIN || d > INT32_MAX) return;
+
+			auto org = &buff_[put_][HEAD_SIZE + used_];
+			auto p = put_var_(org, 0);
+			p = put_var_(p, zigzag_(static_cast<uint32_t>(d)));
+			add_sum_(org, p);
+			used_ += p - org;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  書きかけのブロックを閉じる（記録の終了）
+		*/
+		//-----------------------------------------------------------------//
+		void finish() noexcept
+		{
+			if(open_) {
+				close_block_();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  書き込み待ちのブロックを取得（ファイル側）
+			@return ブロック（無い場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		const uint8_t* get_block() const noexcept
+		{
+			if(!full_[get_]) return nullptr;
+			std::atomic_signal_fence(std::memory_order_acquire);
+			return buff_[get_];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  書き込んだブロックを返す（ファイル側）
+		*/
+		//-----------------------------------------------------------------//
+		void release_block() noexcept
+		{
+			std::atomic_signal_fence(std::memory_order_release);
+			full_[get_] = false;
+			get_ ^= 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  索引ブロックの数を取得
+			@return 索引ブロックの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_index_block_num() const noexcept
+		{
+			return (seq_ + IDX_NUM - 1) / IDX_NUM + (lap_num_ + IDX_NUM - 1) / IDX_NUM;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  索引ブロックを作成（ファイル側） @n
+					finish の後、全てのブロックを書いてから呼ぶ（バッファを再利用する）
+			@param[in]	n	索引ブロックの番号
+			@return 索引ブロック
+		*/
+		//-----------------------------------------------------------------//
+		const uint8_t* make_index_block(uint32_t n) noexcept
+		{
+			uint32_t bn = (seq_ + IDX_NUM - 1) / IDX_NUM;
+			uint8_t kind = 0;
+			const uint64_t* src = idx_;
+			uint32_t num = seq_;
+			if(n >= bn) {
+				n -= bn;
+				kind = 1;
+				src = lap_;
+				num = lap_num_;
+			}
+			src += n * IDX_NUM;
+			num -= n * IDX_NUM;
+			if(num > IDX_NUM) num = IDX_NUM;
+
+			auto p = buff_[0];
+			memset(p, 0, BLOCK_SIZE);
+			memcpy(p, "GIDX", 4);
+			p[4] = VERSION;
+			p[5] = kind;
+			put16_(&p[6], num);
+			put32_(&p[12], seq_);
+			auto q = &p[IDX_HEAD_SIZE];
+			for(uint32_t i = 0; i < num; ++i) {
+				put32_(q, src[i] / 1000);
+				put16_(q + 4, src[i] % 1000);
+				q += 8;
+			}
+			put16_(&p[8], sum_(&p[IDX_HEAD_SIZE], num * 8));
+			return p;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  データ・ブロック数を取得
+			@return データ・ブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_block_num() const noexcept { return seq_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ラップ数を取得
+			@return ラップ数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_lap_num() const noexcept { return lap_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  記録した測位点の数を取得
+			@return 測位点の数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_point_num() const noexcept { return point_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  捨てた測位点の数を取得（書き込みが間に合わない、ブロック数の超過）
+			@return 捨てた測位点の数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_drop() const noexcept { return drop_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ＧＰＳトラック読み出しクラス
+		@param[in]	BMAX	最大ブロック数（ブロック索引の大きさ）
+		@param[in]	LMAX	最大ラップ数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t BMAX, uint32_t LMAX>
+	class track_reader : public gps_track {
+
+		utils::file_io	file_;
+		uint8_t		buff_[BLOCK_SIZE];
+
+		uint64_t	idx_[BMAX];
+		uint32_t	blocks_;
+		uint64_t	lap_[LMAX];
+		uint32_t	lap_num_;
+		bool		indexed_;
+		bool		scan_;
+
+		uint32_t	blk_;
+		const uint8_t*	ptr_;
+		const uint8_t*	end_;
+		bool		head_;
+		bool		pend_;
+		point_t		pt_;
+		uint32_t	dlat_;
+		uint32_t	dlon_;
+
+		bool read_block_(uint32_t n) noexcept
+		{
+			if(!file_.seek(utils::file_io::SEEK::SET, n * BLOCK_SIZE)) return false;
+			return file_.read(buff_, BLOCK_SIZE) == BLOCK_SIZE;
+		}
+
+
+		bool load_block_(uint32_t n) noexcept
+		{
+			blk_ = n;
+			head_ = false;
+			ptr_ = end_ = buff_;
+			if(!read_block_(n)) return false;
+			if(memcmp(buff_, "GTRK", 4) != 0 || buff_[4] != VERSION) return false;
+			auto used = get16_(&buff_[8]);
+			if(used > DATA_SIZE || get32_(&buff_[12]) != n) return false;
+			if(sum_(&buff_[HEAD_SIZE], used) != get16_(&buff_[10])) return false;
+
+			pt_.time = get32_(&buff_[16]);
+			pt_.msec = get16_(&buff_[20]);
+			pt_.lat = get32_(&buff_[24]);
+			pt_.lon = get32_(&buff_[28]);
+			pt_.alt = get32_(&buff_[32]);
+			pt_.speed = get32_(&buff_[36]);
+			dlat_ = 0;
+			dlon_ = 0;
+			ptr_ = &buff_[HEAD_SIZE];
+			end_ = ptr_ + used;
+			head_ = true;
+			return true;
+		}
+
+
+		// 読み込んだブロックの次の測位点
+		bool next_(point_t& pt) noexcept
+		{
+			if(head_) {
+				head_ = false;
+				pt = pt_;
+				return true;
+			}
+			while(ptr_ < end_) {
+				uint32_t v[5];
+				auto p = get_var_(ptr_, end_, v[0]);
+				if(p == nullptr) break;
+				if(v[0] == 0) {  // ラップ
+					p = get_var_(p, end_, v[1]);
+					if(p == nullptr) break;
+					ptr_ = p;
+					if(scan_ && lap_num_ < LMAX) {
+						lap_[lap_num_] = to_msec(pt_) + static_cast<int32_t>(unzigzag_(v[1]));
+						++lap_num_;
+					}
+					continue;
+				}
+				for(uint32_t i = 1; i < 5; ++i) {
+					if(p != nullptr) p = get_var_(p, end_, v[i]);
+				}
+				if(p == nullptr) break;
+				ptr_ = p;
+
+				auto ms = to_msec(pt_) + v[0];
+				pt_.time = ms / 1000;
+				pt_.msec = ms % 1000;
+				dlat_ += unzigzag_(v[1]);
+				pt_.lat = static_cast<uint32_t>(pt_.lat) + dlat_;
+				dlon_ += unzigzag_(v[2]);
+				pt_.lon = static_cast<uint32_t>(pt_.lon) + dlon_;
+				pt_.alt = static_cast<uint32_t>(pt_.alt) + unzigzag_(v[3]);
+				pt_.speed += unzigzag_(v[4]);
+				pt = pt_;
+				return true;
+			}
+			ptr_ = end_;
+			return false;
+		}
+
+
+		bool check_index_() const noexcept
+		{
+			if(memcmp(buff_, "GIDX", 4) != 0 || buff_[4] != VERSION || buff_[5] > 1) return false;
+			auto num = get16_(&buff_[6]);
+			if(num > IDX_NUM) return false;
+			return sum_(&buff_[IDX_HEAD_SIZE], num * 8) == get16_(&buff_[8]);
+		}
+
+
+		// ファイル末尾の索引ブロックを読む
+		bool load_index_(uint32_t n) noexcept
+		{
+			if(n == 0 || !read_block_(n - 1) || !check_index_()) return false;
+			auto data = get32_(&buff_[12]);
+			if(data >= n || data > BMAX) return false;
+			blocks_ = 0;
+			lap_num_ = 0;
+			for(uint32_t b = data; b < n; ++b) {
+				if(!read_block_(b) || !check_index_() || get32_(&buff_[12]) != data) return false;
+				auto num = get16_(&buff_[6]);
+				auto q = &buff_[IDX_HEAD_SIZE];
+				for(uint32_t i = 0; i < num; ++i) {
+					auto ms = to_msec(get32_(q), get16_(q + 4));
+					if(buff_[5] == 0) {
+						if(blocks_ < BMAX) {
+							idx_[blocks_] = ms;
+							++blocks_;
+						}
+					} else if(lap_num_ < LMAX) {
+						lap_[lap_num_] = ms;
+						++lap_num_;
+					}
+					q += 8;
+				}
+			}
+			return blocks_ == data;
+		}
+
+
+		// ブロックを走査して、索引を作り直す
+		void scan_blocks_(uint32_t n) noexcept
+		{
+			blocks_ = 0;
+			lap_num_ = 0;
+			scan_ = true;
+			for(uint32_t b = 0; b < n && b < BMAX; ++b) {
+				if(!load_block_(b)) break;
+				idx_[b] = to_msec(pt_);
+				++blocks_;
+				point_t pt;
+				while(next_(pt)) ;
+			}
+			scan_ = false;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		track_reader() noexcept : file_(), blocks_(0), lap_num_(0), indexed_(false), scan_(false),
+			blk_(0), ptr_(nullptr), end_(nullptr), head_(false), pend_(false), pt_(),
+			dlat_(0), dlon_(0)
+		{ }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  トラック・ファイルを開く @n
+					索引が無い、又は壊れている場合は、ブロックを走査して作り直す。
+			@param[in]	path	ファイル名
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const char* path) noexcept
+		{
+			close();
+			if(!file_.open(path, "rb")) return false;
+
+			uint32_t n = file_.get_file_size() / BLOCK_SIZE;
+			indexed_ = load_index_(n);
+			if(!indexed_) {
+				scan_blocks_(n);
+			}
+			return rewind();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ファイルを閉じる
+		*/
+		//-----------------------------------------------------------------//
+		void close() noexcept
+		{
+			file_.close();
+			blocks_ = 0;
+			lap_num_ = 0;
+			indexed_ = false;
+			pend_ = false;
+			head_ = false;
+			ptr_ = end_ = buff_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  先頭に戻す
+			@return 測位点が有れば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool rewind() noexcept
+		{
+			pend_ = false;
+			if(blocks_ == 0) return false;
+			return load_block_(0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  次の測位点を取得（ブロックを跨いで読む）
+			@param[out]	pt	測位点
+			@return 終わりなら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get(point_t& pt) noexcept
+		{
+			if(pend_) {
+				pend_ = false;
+				pt = pt_;
+				return true;
+			}
+			while(!next_(pt)) {
+				if((blk_ + 1) >= blocks_ || !load_block_(blk_ + 1)) return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  時刻でシーク @n
+					ブロック索引を二分探索して、ブロックを一つ読み、その中を進める。@n
+					次の get で、指定時刻以降の最初の測位点を返す。
+			@param[in]	ms	時刻（1970 年からのミリ秒）
+			@return 指定時刻以降の測位点が無ければ「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool seek(uint64_t ms) noexcept
+		{
+			pend_ = false;
+			if(blocks_ == 0) return false;
+
+			uint32_t lo = 0;
+			uint32_t hi = blocks_;
+			while((hi - lo) > 1) {
+				auto mid = (lo + hi) / 2;
+				if(idx_[mid] <= ms) lo = mid;
+				else hi = mid;
+			}
+			if(!load_block_(lo)) return false;
+
+			point_t pt;
+			while(get(pt)) {
+				if(to_msec(pt) >= ms) {
+					pt_ = pt;
+					pend_ = true;
+					return true;
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  索引がファイルに有ったか
+			@return 索引が有った場合「true」（走査で作り直した場合「false」）
+		*/
+		//-----------------------------------------------------------------//
+		bool is_indexed() const noexcept { return indexed_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  データ・ブロック数を取得
+			@return データ・ブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_block_num() const noexcept { return blocks_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロックの開始時刻を取得
+			@param[in]	n	ブロック番号
+			@return 時刻（1970 年からのミリ秒）
+		*/
+		//-----------------------------------------------------------------//
+		uint64_t get_block_time(uint32_t n) const noexcept
+		{
+			if(n >= blocks_) return 0;
+			return idx_[n];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ラップ数を取得
+			@return ラップ数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_lap_num() const noexcept { return lap_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ラップ時刻を取得
+			@param[in]	n	ラップ番号
+			@return 時刻（1970 年からのミリ秒）
+		*/
+		//-----------------------------------------------------------------//
+		uint64_t get_lap(uint32_t n) const noexcept
+		{
+			if(n >= lap_num_) return 0;
+			return lap_[n];
+		}
+	};
+}
@@ -33,22 +33,13 @@ namespace app {
 		uint32_t	lap_best_t_;
 		uint32_t	lap_best_n_;
 
+		uint32_t	lap_log_;
+		bool		log_req_;
+
 		typedef scenes_base::RENDER RENDER;
 		typedef RENDER::glc_type GLC;
 		typedef graphics::def_color DEF_COLOR;
 
-		void make_file_name_(time_t t, char* out, uint32_t len)
-		{
-			struct tm *m = localtime(&t);
-			utils::sformat("%04d%s%02d%02d%02d", out, len)
-				% static_cast<uint32_t>(m->tm_year + 1900)
-				% get_mon(m->tm_mon)
-				% static_cast<uint32_t>(m->tm_mday)
-				% static_cast<uint32_t>(m->tm_hour)
-				% static_cast<uint32_t>(m->tm_min)
-			;
-		}
-
 	public:
 		//-------------------------------------------------------------//
 		/*!
@@ -58,7 +49,7 @@ namespace app {
 		laptime() :
 			button_(vtx::srect(480-100-2, 272-30-10-2, 100, 30), "Exit"),
 			slider_(vtx::srect(0, LAP_LIST_Y + LAP_FONT_HEIGHT, 0, LAP_LIST_NUM * LAP_FONT_HEIGHT), 0.0f),
-			lap_best_t_(0), lap_best_n_(0)
+			lap_best_t_(0), lap_best_n_(0), lap_log_(0), log_req_(false)
 		{ }
 
 
@@ -82,6 +73,10 @@ namespace app {
 			auto& watch = at_scenes_base().at_cmt().at_task();
 			watch.reset();
 
+			// GPS トラックの記録（前の記録を書き終えてから）
+			lap_log_ = 0;
+			log_req_ = true;
+
 			auto& render = at_scenes_base().at_render();
 			render.clear(DEF_COLOR::Black);
 			render.set_fore_color(DEF_COLOR::White);
@@ -168,9 +163,15 @@ namespace app {
 				res.draw_short_lap(vtx::spos(LAP_LIST_X, LAP_LIST_Y + LAP_FONT_HEIGHT * LAP_LIST_NUM - i * LAP_FONT_HEIGHT), pos - i - ofs, t);
 			}
 
-			// GPS 書き込みサービス
-//			auto& nmea = at_scenes_base().at_nmea();
-//			auto n = nmea.get_satellite_num();
+			// GPS トラックの記録、ラップを加える
+			auto& gps = at_scenes_base().at_gps_file();
+			if(log_req_ && gps.start()) {
+				log_req_ = false;
+			}
+			while(!log_req_ && lap_log_ < pos) {
+				gps.lap(watch.get_lap(lap_log_) * 10);
+				++lap_log_;
+			}
 
 			render.set_fore_color(DEF_COLOR::Black);
 			render.line_v(480-1, 0, 272);
@@ -185,6 +186,7 @@ namespace app {
 		void exit() override {
 			button_.enable(false);
 			slider_.enable(false);
+			at_scenes_base().at_gps_file().stop();
 		}
 	};
 }
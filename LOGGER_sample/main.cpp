@@ -243,6 +243,16 @@ extern "C" {
     }
 
 
+	// GPS トラックの書き込み（SD カードへの書き込みで、UI を待たせない）
+	void file_task_(void* param)
+	{
+		while(1) {
+			scenes_.at_base().at_gps_file().service();
+			vTaskDelay(10 / portTICK_PERIOD_MS);
+		}
+	}
+
+
 	void main_task_(void* param)
 	{
 
@@ -303,5 +313,12 @@ int main(int argc, char** argv)
         xTaskCreate(main_task_, "Main", stack_size, param, prio, nullptr);
     }
 
+    {  // メインと同じ優先度（タイムスライスで、書き込み中も UI は動く）
+        uint32_t stack_size = 4096;
+        void* param = nullptr;
+        uint32_t prio = 1;
+        xTaskCreate(file_task_, "File", stack_size, param, prio, nullptr);
+    }
+
     vTaskStartScheduler();
 }
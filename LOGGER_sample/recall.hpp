@@ -10,6 +10,7 @@
 //=====================================================================//
 #include "common/format.hpp"
 #include "scenes_base.hpp"
+#include "gps_track.hpp"
 
 namespace app {
 
@@ -23,7 +24,67 @@ namespace app {
 		typedef scenes_base::RENDER RENDER;
 		typedef graphics::def_color DEF_COLOR;
 
+		static const int16_t LIST_Y = 60;
+		static const uint32_t LIST_NUM = (272 - LIST_Y) / 16;
+
+		typedef utils::track_reader<1024, 500> READER;
+
 		gui::button		button_;
+		READER			reader_;
+		bool			load_;
+
+		// ラップ毎のラップタイムと最高速度の一覧
+		void list_laps_() noexcept
+		{
+			auto& render = at_scenes_base().at_render();
+			render.set_fore_color(DEF_COLOR::White);
+			render.set_back_color(DEF_COLOR::Black);
+
+			char tmp[64];
+			auto path = at_scenes_base().get_filer_path();
+			if(!reader_.open(path)) {
+				utils::sformat("Not track file: '%s'", tmp, sizeof(tmp)) % path;
+				render.draw_text(vtx::spos(0, LIST_Y), tmp);
+				return;
+			}
+
+			auto n = reader_.get_lap_num();
+			utils::sformat("%s: %u laps", tmp, sizeof(tmp)) % path % n;
+			render.draw_text(vtx::spos(120, 20 + 8), tmp);
+
+			uint64_t org = reader_.get_block_time(0);
+			uint32_t best = 0;
+			for(uint32_t i = 0; i < n; ++i) {
+				auto t = reader_.get_lap(i);
+				if(best == 0 || (t - org) < best) best = static_cast<uint32_t>(t - org);
+				org = t;
+			}
+
+			// 最初のラップは、記録の開始（最初の測位）から
+			org = reader_.get_block_time(0);
+			for(uint32_t i = 0; i < n && i < LIST_NUM; ++i) {
+				auto end = reader_.get_lap(i);
+				uint32_t top = 0;
+				if(reader_.seek(org)) {
+					READER::point_t pt;
+					while(reader_.get(pt) && READER::to_msec(pt) < end) {
+						if(top < pt.speed) top = pt.speed;
+					}
+				}
+				uint32_t t = static_cast<uint32_t>(end - org);
+				utils::sformat("%3u  %u:%02u.%02u  %3u.%u km/h", tmp, sizeof(tmp))
+					% (i + 1) % (t / 60000) % (t / 1000 % 60) % (t / 10 % 100)
+					% (top / 100) % (top / 10 % 10);
+				if(t == best) {
+					render.set_fore_color(DEF_COLOR::Green);
+				} else {
+					render.set_fore_color(DEF_COLOR::White);
+				}
+				render.draw_text(vtx::spos(0, LIST_Y + i * 16), tmp);
+				org = end;
+			}
+			reader_.close();
+		}
 
 	public:
 		//-------------------------------------------------------------//
@@ -32,7 +93,7 @@ namespace app {
 		*/
 		//-------------------------------------------------------------//
 		recall() noexcept :
-			button_(vtx::srect( 30, 20, 80, 30), "OK") {
+			button_(vtx::srect( 30, 20, 80, 30), "OK"), reader_(), load_(false) {
 		}
 
 
@@ -52,7 +113,7 @@ namespace app {
 
 			at_scenes_base().at_render().clear(DEF_COLOR::Black);
 			at_scenes_base().enable_filer();
-			at_scenes_base().get_filer_state();
+			load_ = false;
 		}
 
 
@@ -64,8 +125,20 @@ namespace app {
 		void service() override
 		{
 			auto f = at_scenes_base().get_filer_state();
-			if(!f) {
-				change_scene(scene_id::root_menu);
+			if(f) return;
+
+			// 選択したトラック・ファイルのラップを表示（OK で戻る）
+			if(!load_) {
+				load_ = true;
+				auto path = at_scenes_base().get_filer_path();
+				if(path[0] == 0) {
+					change_scene(scene_id::root_menu);
+					return;
+				}
+				at_scenes_base().at_render().clear(DEF_COLOR::Black);
+				list_laps_();
+				// 画面を消したので、OK ボタンを描き直す
+				button_.invalidate();
 			}
 		}
 
@@ -38,6 +38,7 @@
 #include "common/nmea_dec.hpp"
 
 #include "resource.hpp"
+#include "gps_file.hpp"
 
 namespace app {
 
@@ -225,7 +226,10 @@ namespace app {
 		GPS_S		gps_s_;
 		NMEA		nmea_;
 
+		utils::gps_file	gps_file_;
+
 		bool		enable_filer_;
+		char		filer_path_[256];
 
 	public:
 		//-------------------------------------------------------------//
@@ -244,8 +248,8 @@ namespace app {
 			filer_(render_),
 			resource_(render_),
 			plot_(render_), img_in_(plot_),
-			gps_s_(), nmea_(gps_s_),
-			enable_filer_(false)
+			gps_s_(), nmea_(gps_s_), gps_file_(),
+			enable_filer_(false), filer_path_{ 0 }
 			{ }
 
 
@@ -323,7 +327,11 @@ namespace app {
 		//-------------------------------------------------------------//
 		void update() noexcept
 		{
-			nmea_.service();
+			if(nmea_.service()) {
+				NMEA::fix_t fix;
+				nmea_.get_fix(fix);
+				gps_file_.add(fix, cmt_.at_task().get() * 10);
+			}
 //			nmea_.list_all();
 
 			// ファイラー機能更新
@@ -356,6 +364,7 @@ namespace app {
 					render_.sync_frame();
 
 					utils::format("%s\n") % path;
+					strncpy(filer_path_, path, sizeof(filer_path_) - 1);
 
 					enable_filer_ = false;
 				}
@@ -465,13 +474,26 @@ namespace app {
 		NMEA& at_nmea() noexcept { return nmea_; }
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	GPS ファイルの参照
+			@return GPS ファイル
+		*/
+		//-------------------------------------------------------------//
+		utils::gps_file& at_gps_file() noexcept { return gps_file_; }
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ファイラーの許可
 			@param[in]	ena		不許可の場合「false」
 		*/
 		//-------------------------------------------------------------//
-		void enable_filer(bool ena = true) noexcept { enable_filer_ = ena; }
+		void enable_filer(bool ena = true) noexcept
+		{
+			if(ena) filer_path_[0] = 0;
+			enable_filer_ = ena;
+		}
 
 
 		//-------------------------------------------------------------//
@@ -481,6 +503,15 @@ namespace app {
 		*/
 		//-------------------------------------------------------------//
 		bool get_filer_state() const noexcept { return enable_filer_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ファイラーで選択したファイルのパスを取得
+			@return パス（選択していない場合は空）
+		*/
+		//-------------------------------------------------------------//
+		const char* get_filer_path() const noexcept { return filer_path_; }
 	};
 }
 
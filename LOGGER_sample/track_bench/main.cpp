@@ -0,0 +1,709 @@
+//=====================================================================//
+/*!	@file
+	@brief	ＧＰＳトラック・ベンチマーク（ホスト用） @n
+			サーキットを周回する 10Hz の NMEA（GGA、GSA、RMC、VTG、GSV は 1Hz）を作り、@n
+			nmea_parse で解析した測位情報を、gps_file でトラック形式に記録する。@n
+			RAM ディスク上の FAT16 に書き、SD カードの書き込み時間は、セクター数と、@n
+			連続しない読み書きの回数から見積もる。@n
+			・ファイルの大きさ（NMEA テキストをそのまま書いた場合との比較）@n
+			・UI 側（add、lap）の最大時間と、ファイル側（service）の最大書き込み時間 @n
+			  （途中で、SD カードが 500ms 止まる場合を含む）、捨てた測位点の数 @n
+			・NMEA テキストを UI 側で同期して書いた場合の、最大の待ち時間 @n
+			・読み出した測位点とラップの一致、ラップのシーク（索引）と、先頭からの走査の比較 @n
+			・索引を書く前に止まった（索引を切り取った）ファイルの、索引の作り直し @n
+			・SD カードが無い（ファイルを開けない）時の記録の終了と、次の記録
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "ff14/source/ff.h"
+#include "ff14/source/diskio.h"
+
+#include "LOGGER_sample/gps_file.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t SECTOR_SIZE = 512;
+	static const uint32_t SECTORS = 65536;			///< 32M バイト
+	static const uint32_t CLUSTER = 8;				///< 4K バイト
+	static const uint32_t FAT_SIZE = 32;			///< FAT16 の１面のセクター数
+	static const uint32_t ROOT_ENTS = 512;
+
+	static const uint32_t SECTOR_US = 250;			///< SD カード（SPI 20MHz）の１セクター読み書き時間（想定）
+	static const uint32_t SEEK_US = 1000;			///< 連続しない読み書きの追加時間（想定）
+	static const uint32_t STALL_US = 500'000;		///< SD カードが止まる時間（内部処理、想定）
+
+	static const uint32_t SESSION = 30 * 60;		///< 記録時間（秒）
+	static const uint32_t RATE = 10;				///< 測位レート（Hz）
+	static const uint32_t TICK_MS = 10;				///< ラップタイマー、ファイル・タスクの周期
+	static const double LAP_LEN = 2400.0;			///< 周回の長さ（m）
+	static const uint32_t STALL_SEC = 900;			///< SD カードが止まる時刻（秒）
+
+	static const time_t BASE_TIME = 1'600'000'000;	///< 2020-09-13 12:26:40 GMT
+
+	typedef utils::nmea_parse::fix_t fix_t;
+	typedef utils::gps_track::point_t point_t;
+	typedef utils::track_reader<1024, 500> READER;
+
+	std::vector<uint8_t> disk_;
+	uint32_t	last_sector_ = 0;
+	uint32_t	rd_sectors_ = 0;
+	uint32_t	wr_sectors_ = 0;
+	uint32_t	seeks_ = 0;
+	uint32_t	fattime_ = (40 << 25) | (9 << 21) | (13 << 16);
+	bool		no_card_ = false;
+
+	uint32_t	error_ = 0;
+
+	void put16_(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+	void put32_(uint8_t* p, uint32_t v) { put16_(p, v); put16_(p + 2, v >> 16); }
+
+
+	// FatFs の f_mkfs は無効（FF_USE_MKFS = 0）なので、SFD の FAT16 を直接作る
+	void format_()
+	{
+		disk_.assign(SECTORS * SECTOR_SIZE, 0);
+		uint8_t* bs = &disk_[0];
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(&bs[3], "MSDOS5.0", 8);
+		put16_(&bs[11], SECTOR_SIZE);
+		bs[13] = CLUSTER;
+		put16_(&bs[14], 1);				// reserved
+		bs[16] = 2;						// FATs
+		put16_(&bs[17], ROOT_ENTS);
+		put16_(&bs[19], 0);				// TotSec16
+		bs[21] = 0xF8;
+		put16_(&bs[22], FAT_SIZE);
+		put16_(&bs[24], 63);
+		put16_(&bs[26], 255);
+		put32_(&bs[28], 0);
+		put32_(&bs[32], SECTORS);
+		bs[36] = 0x80;
+		bs[38] = 0x29;
+		put32_(&bs[39], 0x12345678);
+		memcpy(&bs[43], "NO NAME    ", 11);
+		memcpy(&bs[54], "FAT16   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t* fat = &disk_[(1 + i * FAT_SIZE) * SECTOR_SIZE];
+			put16_(&fat[0], 0xFFF8);
+			put16_(&fat[2], 0xFFFF);
+		}
+	}
+
+
+	struct disk_t {
+		uint32_t	rd;
+		uint32_t	wr;
+		uint32_t	seek;
+		double		t;
+	};
+
+	disk_t begin_()
+	{
+		disk_t d;
+		d.rd = rd_sectors_;
+		d.wr = wr_sectors_;
+		d.seek = seeks_;
+		d.t = bench_usec();
+		return d;
+	}
+
+
+	// CPU 時間（ホスト）と、SD カードの見積もり時間（us）
+	double end_(const disk_t& d, double& cpu)
+	{
+		cpu = bench_usec() - d.t;
+		return static_cast<double>((rd_sectors_ - d.rd) + (wr_sectors_ - d.wr)) * SECTOR_US
+			+ static_cast<double>(seeks_ - d.seek) * SEEK_US;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	NMEA の生成（周回するサーキット、ノイズ、測位の途切れ）
+	*/
+	//-----------------------------------------------------------------//
+	class nmea_gen {
+		uint32_t	rnd_ = 12345;
+		double		dist_ = 0.0;
+
+		double rand_()  // -1.0 ～ 1.0
+		{
+			rnd_ = rnd_ * 1103515245 + 12345;
+			return static_cast<double>((rnd_ >> 8) & 0xffff) / 32768.0 - 1.0;
+		}
+
+		static void add_(std::string& out, const char* body)
+		{
+			uint8_t sum = 0;
+			for(auto p = body + 1; *p != 0; ++p) sum ^= static_cast<uint8_t>(*p);
+			char tmp[16];
+			snprintf(tmp, sizeof(tmp), "*%02X\r\n", sum);
+			out += body;
+			out += tmp;
+		}
+
+		static void deg_(char* out, uint32_t len, double deg, bool lon)
+		{
+			auto a = fabs(deg);
+			auto d = static_cast<uint32_t>(a);
+			auto m = (a - d) * 60.0;
+			snprintf(out, len, lon ? "%03u%08.5f,%c" : "%02u%08.5f,%c", d, m,
+				lon ? (deg < 0.0 ? 'W' : 'E') : (deg < 0.0 ? 'S' : 'N'));
+		}
+
+	public:
+		// 速度（km/h）、周回の中の位置で変わる
+		static double speed(double s)
+		{
+			return 120.0 + 70.0 * cos(2.0 * M_PI * 3.0 * s / LAP_LEN);
+		}
+
+		double get_dist() const { return dist_; }
+
+		// 一エポック分のセンテンス、fix が無効なら測位無し
+		std::string epoch(uint32_t n, bool fix)
+		{
+			double dt = 1.0 / RATE;
+			auto kmh = speed(dist_);
+			dist_ += kmh / 3.6 * dt;
+			double th = 2.0 * M_PI * dist_ / LAP_LEN;
+			double x = 500.0 * cos(th) + rand_() * 0.3;
+			double y = 250.0 * sin(th) + rand_() * 0.3;
+			double lat = 35.3717 + y / 111320.0;
+			double lon = 138.9270 + x / (111320.0 * cos(35.3717 * M_PI / 180.0));
+			double alt = 550.0 + 5.0 * sin(th) + rand_() * 0.5;
+			double course = fmod(th * 180.0 / M_PI + 90.0, 360.0);
+			kmh += rand_() * 0.2;
+
+			time_t t = BASE_TIME + n / RATE;
+			uint32_t cs = (n % RATE) * (100 / RATE);
+			uint32_t sod = t % 86400;
+			char hms[16];
+			snprintf(hms, sizeof(hms), "%02u%02u%02u.%02u", sod / 3600, sod / 60 % 60, sod % 60, cs);
+			uint32_t day = t / 86400;
+			// 1970 年からの日数を日付に
+			uint32_t z = day + 719468;
+			uint32_t era = z / 146097;
+			uint32_t doe = z - era * 146097;
+			uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+			uint32_t mp = (5 * doy + 2) / 153;
+			uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+			uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+			uint32_t yy = (yoe + era * 400 + (m <= 2)) % 100;
+
+			char la[24];
+			char lo[24];
+			deg_(la, sizeof(la), lat, false);
+			deg_(lo, sizeof(lo), lon, true);
+
+			std::string out;
+			char tmp[160];
+			if(fix) {
+				snprintf(tmp, sizeof(tmp), "$GPGGA,%s,%s,%s,1,12,0.80,%.1f,M,39.5,M,,", hms, la, lo, alt);
+			} else {
+				snprintf(tmp, sizeof(tmp), "$GPGGA,%s,,,,,0,00,99.99,,,,,,", hms);
+			}
+			add_(out, tmp);
+			if(fix) {
+				add_(out, "$GPGSA,A,3,02,05,06,09,12,13,15,17,19,24,25,29,1.40,0.80,1.15");
+			} else {
+				add_(out, "$GPGSA,A,1,,,,,,,,,,,,,99.99,99.99,99.99");
+			}
+			if((n % RATE) == 0) {
+				add_(out, "$GPGSV,3,1,12,02,45,310,44,05,62,045,46,06,12,110,38,09,33,271,42");
+				add_(out, "$GPGSV,3,2,12,12,08,200,35,13,71,180,47,15,25,050,40,17,40,300,43");
+				add_(out, "$GPGSV,3,3,12,19,55,120,45,24,18,080,39,25,30,230,41,29,10,330,36");
+			}
+			if(fix) {
+				snprintf(tmp, sizeof(tmp), "$GPRMC,%s,A,%s,%s,%.2f,%.2f,%02u%02u%02u,,,A",
+					hms, la, lo, kmh / 1.852, course, d, m, yy);
+			} else {
+				snprintf(tmp, sizeof(tmp), "$GPRMC,%s,V,,,,,,,%02u%02u%02u,,,N", hms, d, m, yy);
+			}
+			add_(out, tmp);
+			if(fix) {
+				snprintf(tmp, sizeof(tmp), "$GPVTG,%.2f,T,,M,%.2f,N,%.2f,K,A", course, kmh / 1.852, kmh);
+			} else {
+				snprintf(tmp, sizeof(tmp), "$GPVTG,,T,,M,,N,,K,N");
+			}
+			add_(out, tmp);
+			return out;
+		}
+	};
+
+
+	bool same_(const point_t& a, const fix_t& b)
+	{
+		return a.time == b.time && a.msec == b.msec && a.lat == b.lat && a.lon == b.lon
+			&& a.alt == b.alt && a.speed == b.speed;
+	}
+
+
+	// 測位の途切れ（トンネル等）
+	bool has_fix_(uint32_t sec)
+	{
+		if(sec < 2) return false;
+		if(sec >= 600 && sec < 603) return false;
+		if(sec >= 1200 && sec < 1205) return false;
+		return true;
+	}
+
+
+	struct result_t {
+		std::vector<fix_t>		fix;		///< 記録する（有効な）測位情報
+		std::vector<uint64_t>	lap;		///< ラップ時刻（ms）
+		uint32_t	nmea_bytes = 0;
+		double		add_max = 0.0;			///< UI 側の最大 CPU 時間（us）
+		double		add_sum = 0.0;
+		uint32_t	add_num = 0;
+		double		svc_max = 0.0;			///< ファイル側の最大書き込み時間（us、見積もり、止まった時を除く）
+		double		svc_stall = 0.0;		///< ファイル側の SD カードが止まった時の書き込み時間
+		double		svc_cpu = 0.0;			///< ファイル側の最大 CPU 時間（us）
+		uint32_t	svc_num = 0;			///< 書き込みのあった service
+		double		close_t = 0.0;			///< 終了（索引）の書き込み時間（us、見積もり）
+		double		sync_max = 0.0;			///< NMEA を同期して書いた場合の最大の待ち時間（us、見積もり、止まった時を除く）
+		double		sync_stall_t = 0.0;		///< 同期して書いた場合の SD カードが止まった時の待ち時間
+		double		sync_cpu = 0.0;
+		uint32_t	sync_stall = 0;			///< 同期して書いた場合、止まったエポック数
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	記録（10ms 単位で UI 側とファイル側を進める）@n
+				ファイル側は、見積もった書き込み時間の間、次の service を呼ばない。
+	*/
+	//-----------------------------------------------------------------//
+	bool record_(utils::gps_file& gf, result_t& res)
+	{
+		utils::nmea_parse nmea;
+		nmea_gen gen;
+
+		if(!gf.start()) {
+			printf("start fail\n");
+			return false;
+		}
+
+		uint64_t file_free = 0;  // ファイル・タスクが次に動ける時刻（us）
+		bool stall = false;
+		uint32_t lap_n = 0;
+		uint32_t epochs = SESSION * RATE;
+		uint32_t ticks = SESSION * 1000 / TICK_MS;
+		for(uint32_t tk = 0; tk < ticks; ++tk) {
+			uint64_t now = static_cast<uint64_t>(tk) * TICK_MS * 1000;
+			uint32_t tick = tk * TICK_MS;  // ラップタイマー（ms）
+
+			// UI 側：エポック毎の NMEA、ラップ（周回の長さを越えた時）
+			if((tick % (1000 / RATE)) == 0) {
+				uint32_t n = tick / (1000 / RATE);
+				if(n >= epochs) break;
+				auto s = gen.epoch(n, has_fix_(n / RATE));
+				res.nmea_bytes += s.size();
+				for(auto ch : s) {
+					if(!nmea.put(ch)) continue;
+					fix_t fix;
+					nmea.get_fix(fix);
+					auto t = bench_usec();
+					gf.add(fix, tick);
+					t = bench_usec() - t;
+					if(res.add_max < t) res.add_max = t;
+					res.add_sum += t;
+					++res.add_num;
+					if(fix.valid && fix.quality != 0) {
+						res.fix.push_back(fix);
+					}
+				}
+			}
+			uint32_t lap = static_cast<uint32_t>(gen.get_dist() / LAP_LEN);
+			if(lap > lap_n) {
+				lap_n = lap;
+				auto t = bench_usec();
+				gf.lap(tick);
+				t = bench_usec() - t;
+				if(res.add_max < t) res.add_max = t;
+				res.lap.push_back(utils::gps_track::to_msec(BASE_TIME, 0) + tick);
+			}
+
+			// ファイル側
+			if(now >= file_free) {
+				auto d = begin_();
+				gf.service();
+				double cpu;
+				auto us = end_(d, cpu);
+				if(us > 0.0) {
+					us += cpu;
+					if(!stall && tick >= STALL_SEC * 1000) {
+						stall = true;
+						us += STALL_US;
+						res.svc_stall = us;
+					} else if(res.svc_max < us) {
+						res.svc_max = us;
+					}
+					if(res.svc_cpu < cpu) res.svc_cpu = cpu;
+					++res.svc_num;
+					file_free = now + static_cast<uint64_t>(us);
+				}
+			}
+		}
+
+		gf.stop();
+		auto d = begin_();
+		while(gf.busy()) {
+			gf.service();
+		}
+		double cpu;
+		res.close_t = end_(d, cpu) + cpu;
+		return true;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	NMEA テキストを、UI 側で同期して書いた場合（一秒毎に f_sync）
+	*/
+	//-----------------------------------------------------------------//
+	bool record_nmea_(const char* name, result_t& res)
+	{
+		utils::file_io fio;
+		if(!fio.open(name, "wb")) return false;
+		nmea_gen gen;
+		bool stall = false;
+		for(uint32_t n = 0; n < SESSION * RATE; ++n) {
+			auto s = gen.epoch(n, has_fix_(n / RATE));
+			auto d = begin_();
+			fio.write(s.data(), s.size());
+			if((n % RATE) == (RATE - 1)) {
+				fio.flush();
+			}
+			double cpu;
+			auto us = end_(d, cpu) + cpu;
+			if(us > cpu && !stall && n >= STALL_SEC * RATE) {
+				stall = true;
+				us += STALL_US;
+				res.sync_stall_t = us;
+			} else if(res.sync_max < us) {
+				res.sync_max = us;
+			}
+			if(res.sync_cpu < cpu) res.sync_cpu = cpu;
+			if(us > (1e6 / RATE)) ++res.sync_stall;
+		}
+		fio.close();
+		return true;
+	}
+
+
+	// 全測位点とラップの一致
+	bool verify_(READER& rd, const result_t& res, const char* title)
+	{
+		bool ok = true;
+		if(!rd.rewind()) {
+			printf("  %s: rewind fail\n", title);
+			return false;
+		}
+		uint32_t n = 0;
+		point_t pt;
+		while(rd.get(pt)) {
+			if(n >= res.fix.size() || !same_(pt, res.fix[n])) {
+				if(ok) printf("  %s: point %u mismatch\n", title, n);
+				ok = false;
+			}
+			++n;
+		}
+		if(n != res.fix.size()) {
+			printf("  %s: points %u / %u\n", title, n, static_cast<uint32_t>(res.fix.size()));
+			ok = false;
+		}
+		if(rd.get_lap_num() != res.lap.size()) {
+			printf("  %s: laps %u / %u\n", title, rd.get_lap_num(), static_cast<uint32_t>(res.lap.size()));
+			ok = false;
+		} else {
+			for(uint32_t i = 0; i < res.lap.size(); ++i) {
+				if(rd.get_lap(i) != res.lap[i]) {
+					printf("  %s: lap %u time mismatch\n", title, i);
+					ok = false;
+					break;
+				}
+			}
+		}
+		return ok;
+	}
+
+
+	// ラップ毎のシーク（索引）と、先頭からの走査
+	bool seek_(READER& rd, const result_t& res, double& idx_max, double& idx_avg, double& lin_avg)
+	{
+		bool ok = true;
+		idx_max = 0.0;
+		idx_avg = 0.0;
+		lin_avg = 0.0;
+		for(uint32_t i = 0; i < res.lap.size(); ++i) {
+			auto ms = res.lap[i];
+			uint32_t ref = 0;
+			while(ref < res.fix.size() && utils::gps_track::to_msec(res.fix[ref].time, res.fix[ref].msec) < ms) {
+				++ref;
+			}
+
+			auto d = begin_();
+			bool f = rd.seek(ms);
+			point_t pt;
+			f = f && rd.get(pt);
+			double cpu;
+			auto us = end_(d, cpu) + cpu;
+			if(!f || ref >= res.fix.size() || !same_(pt, res.fix[ref])) {
+				printf("  lap %u seek fail\n", i);
+				ok = false;
+			}
+			if(idx_max < us) idx_max = us;
+			idx_avg += us;
+
+			d = begin_();
+			rd.rewind();
+			while(rd.get(pt)) {
+				if(utils::gps_track::to_msec(pt) >= ms) break;
+			}
+			lin_avg += end_(d, cpu) + cpu;
+		}
+		if(!res.lap.empty()) {
+			idx_avg /= res.lap.size();
+			lin_avg /= res.lap.size();
+		}
+		return ok;
+	}
+
+
+	// 短い記録（エポック n から、全て測位有り）、記録した測位点の数を返す
+	uint32_t short_record_(utils::gps_file& gf, uint32_t n, uint32_t epochs)
+	{
+		utils::nmea_parse nmea;
+		nmea_gen gen;
+		uint32_t num = 0;
+		for(uint32_t i = 0; i < epochs; ++i) {
+			auto s = gen.epoch(n + i, true);
+			for(auto ch : s) {
+				if(!nmea.put(ch)) continue;
+				fix_t fix;
+				nmea.get_fix(fix);
+				gf.add(fix, i * (1000 / RATE));
+				if(fix.valid && fix.quality != 0) ++num;
+			}
+			gf.service();
+		}
+		gf.stop();
+		for(uint32_t i = 0; i < 100 && gf.busy(); ++i) {
+			gf.service();
+		}
+		return num;
+	}
+
+
+	// SD カードが無くても、記録は終わり（busy が解除され）、カードを入れた後に記録出来る事
+	bool no_card_test_()
+	{
+		static utils::gps_file gf;
+		static READER rd;
+		uint32_t n = (SESSION + 3600) * RATE;  // 一時間後（別のファイル名）
+		bool ok = true;
+
+		no_card_ = true;
+		if(!gf.start()) {
+			printf("  no card: start fail\n");
+			ok = false;
+		}
+		short_record_(gf, n, 10 * RATE);
+		if(gf.busy() || gf.get_error() == 0) {
+			printf("  no card: busy %d, error %u\n", gf.busy(), gf.get_error());
+			ok = false;
+		}
+		no_card_ = false;
+
+		if(!gf.start()) {
+			printf("  card inserted: start fail (busy)\n");
+			return false;
+		}
+		auto num = short_record_(gf, n, 10 * RATE);
+		if(gf.busy() || gf.get_error() != 0) {
+			printf("  card inserted: busy %d, error %u\n", gf.busy(), gf.get_error());
+			ok = false;
+		}
+		uint32_t m = 0;
+		if(rd.open(gf.get_name())) {
+			point_t pt;
+			while(rd.get(pt)) ++m;
+			rd.close();
+		}
+		if(num == 0 || m != num) {
+			printf("  card inserted: points %u / %u\n", m, num);
+			ok = false;
+		}
+		return ok;
+	}
+
+
+	// 索引を切り取って、書き込み中に止まったファイルを作る
+	bool cut_index_(const char* name, uint32_t blocks)
+	{
+		FIL fp;
+		if(f_open(&fp, name, FA_WRITE | FA_OPEN_EXISTING) != FR_OK) return false;
+		bool ok = f_lseek(&fp, blocks * utils::gps_track::BLOCK_SIZE) == FR_OK && f_truncate(&fp) == FR_OK;
+		f_close(&fp);
+		return ok;
+	}
+}
+
+
+extern "C" {
+
+	DSTATUS disk_initialize(BYTE pdrv) { return no_card_ ? STA_NOINIT | STA_NODISK : 0; }
+	DSTATUS disk_status(BYTE pdrv) { return no_card_ ? STA_NOINIT | STA_NODISK : 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(buff, &disk_[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		rd_sectors_ += count;
+		if(sector != last_sector_) ++seeks_;
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(&disk_[sector * SECTOR_SIZE], buff, count * SECTOR_SIZE);
+		wr_sectors_ += count;
+		if(sector != last_sector_) ++seeks_;
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<LBA_t*>(buff) = SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = SECTOR_SIZE;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		}
+		return RES_PARERR;
+	}
+
+	DWORD get_fattime(void)
+	{
+		return fattime_;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	format_();
+	static FATFS fs;
+	if(f_mount(&fs, "", 1) != FR_OK) {
+		printf("Mount error\n");
+		return 1;
+	}
+
+	printf("GPS track: %u s, %u Hz, lap %.0f m, SD model: %u us/sector, %u us/seek, %u ms stall at %u s\n\n",
+		SESSION, RATE, LAP_LEN, SECTOR_US, SEEK_US, STALL_US / 1000, STALL_SEC);
+
+	static utils::gps_file gf;
+	result_t res;
+	if(!record_(gf, res)) return 1;
+	const auto& wr = gf.get_writer();
+	if(gf.get_error() != 0) {
+		printf("  write error: %u\n", gf.get_error());
+		++error_;
+	}
+	if(wr.get_drop() != 0 || wr.get_point_num() != res.fix.size()) {
+		printf("  drop: %u, points %u / %u\n", wr.get_drop(), wr.get_point_num(),
+			static_cast<uint32_t>(res.fix.size()));
+		++error_;
+	}
+
+	if(!record_nmea_("/track.nmea", res)) {
+		printf("  NMEA write fail\n");
+		++error_;
+	}
+	auto trk = utils::file_io::get_file_size(gf.get_name());
+	auto txt = utils::file_io::get_file_size("/track.nmea");
+	if(txt != res.nmea_bytes) {
+		printf("  NMEA file size %u / %u\n", txt, res.nmea_bytes);
+		++error_;
+	}
+
+	uint32_t data = wr.get_block_num() * utils::gps_track::BLOCK_SIZE;
+	printf("  file '%s': %u points, %u laps, %u blocks + %u index blocks\n", gf.get_name(),
+		wr.get_point_num(), wr.get_lap_num(), wr.get_block_num(), wr.get_index_block_num());
+	printf("  %-28s %10s %12s\n", "size", "bytes", "bytes/point");
+	printf("  %-28s %10u %12.1f\n", "NMEA text (GGA/GSA/RMC/VTG)", txt, static_cast<double>(txt) / res.fix.size());
+	printf("  %-28s %10u %12.1f  (1/%.0f)\n", "track (with index)", trk, static_cast<double>(trk) / res.fix.size(),
+		static_cast<double>(txt) / trk);
+	printf("  %-28s %10u %12.1f\n\n", "track data blocks", data, static_cast<double>(data) / res.fix.size());
+
+	printf("  %-40s %10s %10s %10s\n", "latency (us)", "max", "CPU max", "SD stall");
+	printf("  %-40s %10.2f %10.2f %10s  (avg %.2f, %u dropped)\n", "UI: gps_file add/lap (RAM only)",
+		res.add_max, res.add_max, "-", res.add_sum / res.add_num, wr.get_drop());
+	printf("  %-40s %10.0f %10.1f %10.0f  (%u writes)\n", "file task: service (4K block + f_sync)",
+		res.svc_max, res.svc_cpu, res.svc_stall, res.svc_num);
+	printf("  %-40s %10.0f\n", "file task: stop (last block + index)", res.close_t);
+	printf("  %-40s %10.0f %10.1f %10.0f  (%u epochs > %u ms)\n\n", "UI: NMEA text, synchronous write",
+		res.sync_max, res.sync_cpu, res.sync_stall_t, res.sync_stall, 1000 / RATE);
+
+	static READER rd;
+	if(!rd.open(gf.get_name()) || !rd.is_indexed()) {
+		printf("  open (index) fail\n");
+		++error_;
+	}
+	if(!verify_(rd, res, "indexed")) ++error_;
+
+	double imax, iavg, lavg;
+	if(!seek_(rd, res, imax, iavg, lavg)) ++error_;
+	printf("  lap seek (us)      avg %8.0f, max %8.0f  (index)\n", iavg, imax);
+	printf("                     avg %8.0f               (scan from start)\n", lavg);
+	rd.close();
+
+	// 索引を書く前に止まった場合
+	auto d = begin_();
+	if(!cut_index_(gf.get_name(), wr.get_block_num())) {
+		printf("  truncate fail\n");
+		++error_;
+	}
+	double cpu;
+	end_(d, cpu);
+	d = begin_();
+	bool f = rd.open(gf.get_name());
+	auto us = end_(d, cpu) + cpu;
+	if(!f || rd.is_indexed() || rd.get_block_num() != wr.get_block_num()) {
+		printf("  open (no index) fail\n");
+		++error_;
+	}
+	if(!verify_(rd, res, "rebuilt")) ++error_;
+	printf("  open without index (scan %u blocks): %.0f us\n\n", rd.get_block_num(), us);
+	rd.close();
+
+	bool f_nc = no_card_test_();
+	printf("  no SD card: open fails, recording ends, next recording after insert: %s\n\n", f_nc ? "OK" : "NG");
+	if(!f_nc) ++error_;
+
+	printf("  %u error(s)\n", error_);
+	return error_ != 0 ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+//=====================================================================//
+/*!	@file
+	@brief	NES APU ベンチマーク（ホスト用） @n
+			代表的なチャネル設定で APU を駆動し、１フレーム当たりの処理時間と、@n
+			出力スペクトルのエイリアス成分（高調波以外のエネルギー）を計測する。@n
+			公開 API（apu_create/apu_write/apu_process）だけを使うので、@n
+			APU の実装を入れ替えても、同じ条件で比較出来る。@n
+			Usage: nes_apu_bench [-r rate] [-n frames] [-w prefix]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <complex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "nes_apu.h"
+
+// DMC が参照する CPU 側の関数（ベンチマークでは固定パターンを返す）
+extern "C" {
+
+	uint8_t nes6502_getbyte(uint32_t address)
+	{
+		return (address * 0x9D) ^ (address >> 3);
+	}
+
+	void nes6502_burn(int cycles)
+	{
+	}
+}
+
+namespace {
+
+	static const uint32_t fft_len_ = 8192;
+	static constexpr double apu_clock_ = APU_BASEFREQ;
+
+	struct reg_t {
+		uint16_t	adr;
+		uint8_t		val;
+	};
+
+	struct case_t {
+		const char*	name;
+		reg_t		regs[16];
+		double		f0;		///< 基本周波数（０ならスペクトル計測しない）
+	};
+
+	// 矩形波の周波数（１６ステップ×（周期＋１））
+	constexpr double rect_freq_(uint32_t t) { return apu_clock_ / (16.0 * (t + 1)); }
+	// 三角波の周波数（３２ステップ×（周期＋１））
+	constexpr double tri_freq_(uint32_t t) { return apu_clock_ / (32.0 * (t + 1)); }
+
+	static const case_t cases_[] = {
+		{ "pulse 50% t=0x0fd", { { 0x4015, 0x01 }, { 0x4000, 0xBF }, { 0x4001, 0x00 },
+			{ 0x4002, 0xFD }, { 0x4003, 0x00 }, { 0 } }, rect_freq_(0x0FD) },
+		{ "pulse 50% t=0x03f", { { 0x4015, 0x01 }, { 0x4000, 0xBF }, { 0x4001, 0x00 },
+			{ 0x4002, 0x3F }, { 0x4003, 0x00 }, { 0 } }, rect_freq_(0x03F) },
+		{ "pulse 25% t=0x025", { { 0x4015, 0x01 }, { 0x4000, 0x7F }, { 0x4001, 0x00 },
+			{ 0x4002, 0x25 }, { 0x4003, 0x00 }, { 0 } }, rect_freq_(0x025) },
+		{ "pulse 12% t=0x010", { { 0x4015, 0x01 }, { 0x4000, 0x3F }, { 0x4001, 0x00 },
+			{ 0x4002, 0x10 }, { 0x4003, 0x00 }, { 0 } }, rect_freq_(0x010) },
+		{ "triangle t=0x040", { { 0x4015, 0x04 }, { 0x4008, 0xFF },
+			{ 0x400A, 0x40 }, { 0x400B, 0x00 }, { 0 } }, tri_freq_(0x040) },
+		{ "triangle t=0x010", { { 0x4015, 0x04 }, { 0x4008, 0xFF },
+			{ 0x400A, 0x10 }, { 0x400B, 0x00 }, { 0 } }, tri_freq_(0x010) },
+		{ "noise p=4", { { 0x4015, 0x08 }, { 0x400C, 0x3F },
+			{ 0x400E, 0x04 }, { 0x400F, 0x00 }, { 0 } }, 0.0 },
+		{ "dmc loop", { { 0x4015, 0x00 }, { 0x4010, 0x4F }, { 0x4011, 0x40 },
+			{ 0x4012, 0x00 }, { 0x4013, 0xFF }, { 0x4015, 0x10 }, { 0 } }, 0.0 },
+		{ "all channels", { { 0x4015, 0x1F },
+			{ 0x4000, 0xBF }, { 0x4002, 0xFD }, { 0x4003, 0x00 },
+			{ 0x4004, 0x7F }, { 0x4006, 0x52 }, { 0x4007, 0x00 },
+			{ 0x4008, 0xFF }, { 0x400A, 0x40 }, { 0x400B, 0x00 },
+			{ 0x400C, 0x3A }, { 0x400E, 0x08 }, { 0x400F, 0x00 },
+			{ 0x4010, 0x4F }, { 0x4013, 0xFF }, { 0x4015, 0x1F } }, 0.0 },
+	};
+
+	volatile int16_t sink_;
+
+	void fft_(std::vector<std::complex<double>>& a)
+	{
+		uint32_t n = a.size();
+		for(uint32_t i = 1, j = 0; i < n; ++i) {
+			uint32_t bit = n >> 1;
+			for(; j & bit; bit >>= 1) j ^= bit;
+			j ^= bit;
+			if(i < j) std::swap(a[i], a[j]);
+		}
+		for(uint32_t len = 2; len <= n; len <<= 1) {
+			double ang = -2.0 * M_PI / len;
+			std::complex<double> wl(cos(ang), sin(ang));
+			for(uint32_t i = 0; i < n; i += len) {
+				std::complex<double> w(1.0, 0.0);
+				for(uint32_t k = 0; k < len / 2; ++k) {
+					auto u = a[i + k];
+					auto v = a[i + k + len / 2] * w;
+					a[i + k] = u + v;
+					a[i + k + len / 2] = u - v;
+					w *= wl;
+				}
+			}
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  エイリアス成分の計測 @n
+				高調波（と DC）の近傍以外のエネルギーを、高調波のエネルギーとの比で返す。
+		@param[in]	wav		波形
+		@param[in]	rate	サンプル・レート
+		@param[in]	f0		基本周波数
+		@param[out]	spur	最大スプリアス（基本波比 dB）
+		@return エイリアス／信号（dB）
+	*/
+	//-----------------------------------------------------------------//
+	double alias_ratio_(const std::vector<int16_t>& wav, uint32_t rate, double f0, double& spur)
+	{
+		std::vector<std::complex<double>> a(fft_len_);
+		for(uint32_t i = 0; i < fft_len_; ++i) {
+			// Blackman-Harris
+			double x = 2.0 * M_PI * i / (fft_len_ - 1);
+			double w = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+			a[i] = std::complex<double>(wav[i] * w, 0.0);
+		}
+		fft_(a);
+
+		const uint32_t half = fft_len_ / 2;
+		const int guard = 4;
+		std::vector<bool> harm(half, false);
+		for(int i = 0; i <= guard; ++i) harm[i] = true;
+		for(double f = f0; f < rate / 2.0; f += f0) {
+			int c = static_cast<int>(f * fft_len_ / rate + 0.5);
+			for(int i = c - guard; i <= c + guard; ++i) {
+				if(i >= 0 && i < static_cast<int>(half)) harm[i] = true;
+			}
+		}
+		int c0 = static_cast<int>(f0 * fft_len_ / rate + 0.5);
+		double fund = 0.0;
+		for(int i = c0 - guard; i <= c0 + guard; ++i) fund += std::norm(a[i]);
+
+		double sig = 0.0;
+		double ali = 0.0;
+		double peak = 0.0;
+		// 隣接ビンの和で、スプリアスのピークを求める（窓のメインローブ分）
+		for(uint32_t i = 0; i < half; ++i) {
+			double p = std::norm(a[i]);
+			if(harm[i]) {
+				if(i > static_cast<uint32_t>(guard)) sig += p;
+			} else {
+				ali += p;
+				double q = p;
+				for(int k = 1; k <= guard; ++k) {
+					if(i >= static_cast<uint32_t>(k) && !harm[i - k]) q += std::norm(a[i - k]);
+					if(i + k < half && !harm[i + k]) q += std::norm(a[i + k]);
+				}
+				if(q > peak) peak = q;
+			}
+		}
+		spur = 10.0 * log10((peak + 1e-30) / (fund + 1e-30));
+		return 10.0 * log10((ali + 1e-30) / (sig + 1e-30));
+	}
+
+
+	void write_wav_(const char* file, const std::vector<int16_t>& wav, uint32_t rate)
+	{
+		FILE* fp = fopen(file, "wb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't open: '%s'\n", file);
+			return;
+		}
+		uint32_t len = wav.size() * 2;
+		uint8_t hdr[44];
+		memcpy(&hdr[0], "RIFF", 4);
+		uint32_t v = len + 36; memcpy(&hdr[4], &v, 4);
+		memcpy(&hdr[8], "WAVEfmt ", 8);
+		v = 16; memcpy(&hdr[16], &v, 4);
+		uint16_t s = 1; memcpy(&hdr[20], &s, 2);
+		s = 1; memcpy(&hdr[22], &s, 2);
+		memcpy(&hdr[24], &rate, 4);
+		v = rate * 2; memcpy(&hdr[28], &v, 4);
+		s = 2; memcpy(&hdr[32], &s, 2);
+		s = 16; memcpy(&hdr[34], &s, 2);
+		memcpy(&hdr[36], "data", 4);
+		memcpy(&hdr[40], &len, 4);
+		fwrite(hdr, 1, sizeof(hdr), fp);
+		fwrite(&wav[0], 2, wav.size(), fp);
+		fclose(fp);
+	}
+
+
+	uint64_t tick_()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t rate = 48000;
+	uint32_t frames = 3000;
+	const char* prefix = nullptr;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "-r") == 0 && (i + 1) < argc) {
+			rate = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(argv[i], "-n") == 0 && (i + 1) < argc) {
+			frames = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(argv[i], "-w") == 0 && (i + 1) < argc) {
+			prefix = argv[++i];
+		} else {
+			fprintf(stderr, "Usage: %s [-r rate] [-n frames] [-w prefix]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(rate < 8000 || frames == 0) {
+		fprintf(stderr, "Usage: %s [-r rate] [-n frames] [-w prefix]\n", argv[0]);
+		return 1;
+	}
+
+	const uint32_t len = rate / 60;
+	std::vector<int16_t> buf(len);
+	printf("Sample rate: %u, %u samples/frame, %u frames\n", rate, len, frames);
+	printf("  %-20s %10s %12s %12s %12s\n", "case", "us/frame", "cycles/frame", "alias[dB]", "spur[dBc]");
+
+	uint32_t no = 0;
+	for(const auto& c : cases_) {
+		apu_create(0, rate, 60, 16);
+		apu_setfilter(APU_FILTER_NONE);
+		for(const auto& r : c.regs) {
+			if(r.adr == 0) break;
+			apu_write(r.adr, r.val);
+		}
+
+		// 立ち上がりを捨ててから、スペクトル用の波形を取る
+		for(uint32_t i = 0; i < 30; ++i) apu_process(&buf[0], len);
+		std::vector<int16_t> wav;
+		while(wav.size() < fft_len_) {
+			apu_process(&buf[0], len);
+			wav.insert(wav.end(), buf.begin(), buf.end());
+		}
+
+		auto t0 = std::chrono::steady_clock::now();
+		uint64_t c0 = tick_();
+		for(uint32_t i = 0; i < frames; ++i) {
+			apu_process(&buf[0], len);
+			sink_ = buf[i % len];
+		}
+		uint64_t c1 = tick_();
+		auto t1 = std::chrono::steady_clock::now();
+		double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / frames;
+		double cyc = static_cast<double>(c1 - c0) / frames;
+
+		if(c.f0 > 0.0) {
+			double spur;
+			double ali = alias_ratio_(wav, rate, c.f0, spur);
+			printf("  %-20s %10.2f %12.0f %12.1f %12.1f\n", c.name, us, cyc, ali, spur);
+		} else {
+			printf("  %-20s %10.2f %12.0f %12s %12s\n", c.name, us, cyc, "-", "-");
+		}
+
+		if(prefix != nullptr) {
+			char file[256];
+			snprintf(file, sizeof(file), "%s%02u.wav", prefix, no);
+			write_wav_(file, wav, rate);
+		}
+		++no;
+		apu_destroy();
+	}
+}
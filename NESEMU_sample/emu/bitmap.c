@@ -31,7 +31,8 @@
 
 void bmp_clear(const bitmap_t *bitmap, uint8_t color)
 {
-	memset(bitmap->data, color, bitmap->pitch * bitmap->height);
+	int overdraw = (bitmap->pitch - bitmap->width) / 2;
+	memset(bitmap->data - overdraw, color, bitmap->pitch * bitmap->height);
 }
 
 static bitmap_t *_make_bitmap(uint8_t *data_addr, int width, int height, int pitch, int overdraw)
@@ -49,7 +50,8 @@ static bitmap_t *_make_bitmap(uint8_t *data_addr, int width, int height, int pit
 
 	bitmap->height = height;
 	bitmap->width = width;
-	bitmap->data = data_addr;
+	/* line data starts after the left overdraw area (the PPU draws from -7 for fine X scroll) */
+	bitmap->data = data_addr + overdraw;
 	bitmap->pitch = pitch + (overdraw * 2);
 
 	return bitmap;
@@ -66,6 +68,8 @@ bitmap_t *bmp_create(int width, int height, int overdraw)
 	if(NULL == addr) {
 		return NULL;
 	}
+	/* the first frame after reset does not draw every line */
+	memset(addr, 0, (pitch * height) + 3);
 
 	return _make_bitmap(addr, width, height, width, overdraw);
 }
@@ -74,7 +78,7 @@ bitmap_t *bmp_create(int width, int height, int overdraw)
 void bmp_destroy(bitmap_t *bitmap)
 {
 	if(bitmap != NULL) {
-		free(bitmap->data);
+		free(bitmap->data - (bitmap->pitch - bitmap->width) / 2);
 		free(bitmap);
 	}
 }
@@ -33,6 +33,7 @@
 #include "nes_ppu.h"
 #include "nes_rom.h"
 #include "nes_mmc.h"
+#include "nes_prof.h"
 
 #define  NES_CLOCK_DIVIDER    12
 // #define  NES_MASTER_CLOCK     21477272.727272727272
@@ -272,7 +273,9 @@ static void nes_renderframe(bool draw_flag)
 
 		if(241 == nes_.scanline) {
 			/* 7-9 cycle delay between when VINT flag goes up and NMI is taken */
+			NES_PROF_BEGIN(NES_PROF_CPU);
 			elapsed_cycles = nes6502_execute(7);
+			NES_PROF_END(NES_PROF_CPU);
 			nes_.scanline_cycles -= elapsed_cycles;
 			nes_checkfiq(elapsed_cycles);
 
@@ -289,7 +292,9 @@ static void nes_renderframe(bool draw_flag)
 		}
 
 		nes_.scanline_cycles += (float) NES_SCANLINE_CYCLES;
+		NES_PROF_BEGIN(NES_PROF_CPU);
 		elapsed_cycles = nes6502_execute((int) nes_.scanline_cycles);
+		NES_PROF_END(NES_PROF_CPU);
 		nes_.scanline_cycles -= (float) elapsed_cycles;
 		nes_checkfiq(elapsed_cycles);
 
@@ -24,6 +24,7 @@
 */
 
 #include <math.h>
+#include <string.h>
 
 #include "bitmap.h"
 #include "nes_pal.h"
@@ -63,13 +64,34 @@ rgb_t shady_palette[] =
 /* our global palette */
 rgb_t nes_palette[64];
 
+/* palette in use for display (nes_palette or a game specific one) */
+static rgb_t cur_palette[64];
+static int cur_is_nes = 1;
+
+/* palette change notification */
+static pal_changefunc_t pal_changefunc = NULL;
+static void *pal_changectx = NULL;
 
 static float hue = 334.0f;
 static float tint = 0.4f;
 
 const rgb_t* get_palette()
 {
-	return &nes_palette[0];
+	return &cur_palette[0];
+}
+
+void pal_setchangefunc(pal_changefunc_t func, void *ctx)
+{
+   pal_changefunc = func;
+   pal_changectx = ctx;
+}
+
+void pal_setcurrent(const rgb_t *pal)
+{
+   cur_is_nes = (pal == nes_palette);
+   memcpy(cur_palette, pal, sizeof(cur_palette));
+   if (NULL != pal_changefunc)
+      pal_changefunc(pal_changectx, cur_palette);
 }
 
 void pal_dechue(void)
@@ -170,6 +192,9 @@ void pal_generate(void)
          nes_palette[(x << 4) + z].b = b;
       }
    }   
+
+   if (cur_is_nes)
+      pal_setcurrent(nes_palette);
 }
 
 /*
@@ -32,8 +32,14 @@ extern rgb_t shady_palette[];
 extern "C" {
 #endif /* __cplusplus */
 
+/* called with the new palette each time the display palette changes */
+typedef void (*pal_changefunc_t)(void *ctx, const rgb_t *pal);
+
 extern void pal_generate(void);
 
+extern void pal_setchangefunc(pal_changefunc_t func, void *ctx);
+extern void pal_setcurrent(const rgb_t *pal);
+
 /* TODO: these are temporary hacks */
 extern void pal_dechue(void);
 extern void pal_inchue(void);
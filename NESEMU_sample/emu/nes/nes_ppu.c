@@ -33,6 +33,7 @@
 #include "nes_mmc.h"
 #include "nesinput.h"
 #include "nes_pal.h"
+#include "nes_prof.h"
 
 /* PPU access */
 #define  PPU_MEM(x)           ppu.page[(x) >> 10][(x)]
@@ -50,6 +51,29 @@
 /* the NES PPU */
 static ppu_t ppu;
 
+/* Decoded CHR tile cache for the 512 tiles of $0000-$1FFF.
+** Each row holds 8 pixels of 2 bits, leftmost pixel in the high bits,
+** both normal and horizontally flipped.  Tiles are decoded on first use,
+** and invalidated per 1KB bank on ppu_setpage() and on CHR writes.
+*/
+typedef struct chrtile_s
+{
+   uint16 row[8];
+   uint16 flip[8];
+} chrtile_t;
+
+#define  CHR_TILES            512
+
+static chrtile_t chr_cache[CHR_TILES];
+static uint8 chr_valid[CHR_TILES];
+
+/* Two pixels (4 bits of a cached row) to two colors, in memory order,
+** for the 4 background and 4 sprite palettes (sprite colors have SP_PIXEL
+** set); rebuilt when the palette changes
+*/
+static uint16 col_pair[8][16];
+static bool col_pair_dirty = true;
+
 void ppu_displaysprites(bool display)
 {
    ppu.drawsprites = display;
@@ -131,8 +155,46 @@ int ppu_create(void)
 }
 
 
+/* forget the decoded tiles of a 1KB bank */
+static void chr_invalidatebank(int page_num)
+{
+   if (page_num < 8)
+      memset(&chr_valid[page_num << 6], 0, 64);
+}
+
+/* forget the decoded tiles of every bank that maps a written CHR address */
+static void chr_invalidateaddr(uint32 address)
+{
+   const uint8 *mem = &PPU_MEM(address);
+   int i;
+
+   for (i = 0; i < 8; i++)
+   {
+      const uint8 *base = ppu.page[i] + (i << 10);
+
+      if (NULL != ppu.page[i] && mem >= base && mem < base + 0x400)
+         chr_valid[(i << 6) + ((mem - base) >> 4)] = 0;
+   }
+}
+
+/* decoded tiles and colors have to be rebuilt (e.g. after a state load) */
+void ppu_invalidate(void)
+{
+   memset(chr_valid, 0, sizeof(chr_valid));
+   col_pair_dirty = true;
+}
+
 void ppu_setpage(int size, int page_num, uint8 *location)
 {
+   int i;
+
+   /* mappers often write the same banks again, keep the cache then */
+   for (i = page_num; i < page_num + size; i++)
+   {
+      if (ppu.page[i] != location)
+         chr_invalidatebank(i);
+   }
+
    /* deliberately fall through */
    switch (size)
    {
@@ -203,6 +265,9 @@ void ppu_reset(int reset_type)
 
    ppu.latch = 0;
    ppu.vram_accessible = true;
+
+   /* CHR-RAM may have been trashed */
+   ppu_invalidate();
 }
 
 /* we render a scanline of graphics first so we know exactly
@@ -462,6 +527,8 @@ void ppu_write(uint32 address, uint8 value)
 //            log_printf("VRAM write to $%04X, scanline %d\n", 
 //                       ppu.vaddr, nes_getcontext()->scanline);
             PPU_MEM(ppu.vaddr) = 0xFF; /* corrupt */
+            if (ppu.vaddr < 0x2000)
+               chr_invalidateaddr(ppu.vaddr);
          }
          else 
          {
@@ -471,10 +538,14 @@ void ppu_write(uint32 address, uint8 value)
                ppu.vaddr -= 0x1000;
 
             PPU_MEM(addr) = value;
+            if (addr < 0x2000)
+               chr_invalidateaddr(addr);
          }
       }
       else
       {
+         col_pair_dirty = true;
+
          if (0 == (ppu.vaddr & 0x0F))
          {
             int i;
@@ -527,6 +598,7 @@ void ppu_setpal(rgb_t *pal)
 {
 	/// ppu_buildpalette(pal);
 	/// vid_setpalette(src_ppu->curpal);
+   pal_setcurrent(pal);
 }
 
 void ppu_setdefaultpal(void)
@@ -561,102 +633,148 @@ INLINE void draw_bgtile(uint8 *surface, uint8 pat1, uint8 pat2,
    *surface = colors[pattern & 3];
 }
 
-INLINE int draw_oamtile(uint8 *surface, uint8 attrib, uint8 pat1, 
-                        uint8 pat2, const uint8 *col_tbl, bool check_strike)
+/* spread the 8 bits of a pattern byte to the even bits of a word */
+INLINE uint16 chr_spread(uint8 value)
 {
-   int strike_pixel = -1;
-   uint32 color = ((pat2 & 0xAA) << 8) | ((pat2 & 0x55) << 1)
-                  | ((pat1 & 0xAA) << 7) | (pat1 & 0x55);
+   uint32 x = value;
 
-   /* sprite is not 100% transparent */
-   if (color)
+   x = (x | (x << 4)) & 0x0F0F;
+   x = (x | (x << 2)) & 0x3333;
+   x = (x | (x << 1)) & 0x5555;
+   return (uint16) x;
+}
+
+INLINE uint8 chr_reverse(uint8 value)
+{
+   value = (value >> 4) | (value << 4);
+   value = ((value & 0xCC) >> 2) | ((value & 0x33) << 2);
+   value = ((value & 0xAA) >> 1) | ((value & 0x55) << 1);
+   return value;
+}
+
+static void chr_decode(uint32 index)
+{
+   const uint8 *data = &PPU_MEM(index << 4);
+   chrtile_t *tile = &chr_cache[index];
+   int y;
+
+   for (y = 0; y < 8; y++)
    {
-      uint8 colors[8];
+      uint8 pat1 = data[y];
+      uint8 pat2 = data[y + 8];
 
-      /* swap pixels around if our tile is flipped */
-      if (0 == (attrib & OAMF_HFLIP))
+      tile->row[y] = chr_spread(pat1) | (chr_spread(pat2) << 1);
+      tile->flip[y] = chr_spread(chr_reverse(pat1)) | (chr_spread(chr_reverse(pat2)) << 1);
+   }
+
+   chr_valid[index] = 1;
+}
+
+/* decoded tile at the specified pattern table address */
+INLINE const chrtile_t *chr_gettile(uint32 address)
+{
+   uint32 index = (address >> 4) & (CHR_TILES - 1);
+
+   if (0 == chr_valid[index])
+      chr_decode(index);
+
+   return &chr_cache[index];
+}
+
+static void col_buildpair(void)
+{
+   int pal, i;
+
+   for (pal = 0; pal < 8; pal++)
+   {
+      const uint8 *colors = ppu.palette + (pal << 2);
+      uint8 flag = (pal < 4) ? 0 : SP_PIXEL;
+
+      for (i = 0; i < 16; i++)
       {
-         colors[0] = (color >> 14) & 3;
-         colors[1] = (color >> 6) & 3;
-         colors[2] = (color >> 12) & 3;
-         colors[3] = (color >> 4) & 3;
-         colors[4] = (color >> 10) & 3;
-         colors[5] = (color >> 2) & 3;
-         colors[6] = (color >> 8) & 3;
-         colors[7] = color & 3;
+         uint8 a = flag | colors[i >> 2];
+         uint8 b = flag | colors[i & 3];
+#ifdef HOST_LITTLE_ENDIAN
+         col_pair[pal][i] = a | (b << 8);
+#else
+         col_pair[pal][i] = (a << 8) | b;
+#endif
       }
-      else
+   }
+
+   col_pair_dirty = false;
+}
+
+/* write a cached row as a group of 8 pixels */
+INLINE void draw_row(uint8 *surface, uint32 row, const uint16 *pair)
+{
+   uint32 lo, hi;
+
+#ifdef HOST_LITTLE_ENDIAN
+   lo = pair[(row >> 12) & 15] | ((uint32) pair[(row >> 8) & 15] << 16);
+   hi = pair[(row >> 4) & 15] | ((uint32) pair[row & 15] << 16);
+#else
+   lo = ((uint32) pair[(row >> 12) & 15] << 16) | pair[(row >> 8) & 15];
+   hi = ((uint32) pair[(row >> 4) & 15] << 16) | pair[row & 15];
+#endif
+   memcpy(surface, &lo, 4);
+   memcpy(surface + 4, &hi, 4);
+}
+
+INLINE int draw_oamrow(uint8 *surface, uint8 attrib, uint32 row,
+                       const uint8 *col_tbl, const uint16 *pair, bool check_strike)
+{
+   int strike_pixel = -1;
+   uint32 solid, lo, hi;
+   int i;
+
+   /* sprite is 100% transparent */
+   if (0 == row)
+      return -1;
+
+   /* one bit per solid pixel, leftmost pixel in bit 7 */
+   solid = (row | (row >> 1)) & 0x5555;
+   solid = (solid | (solid >> 1)) & 0x3333;
+   solid = (solid | (solid >> 2)) & 0x0F0F;
+   solid = (solid | (solid >> 4)) & 0x00FF;
+
+   /* check for solid sprite pixel overlapping solid bg pixel */
+   if (check_strike)
+   {
+      for (i = 0; i < 8; i++)
       {
-         colors[7] = (color >> 14) & 3;
-         colors[6] = (color >> 6) & 3;
-         colors[5] = (color >> 12) & 3;
-         colors[4] = (color >> 4) & 3;
-         colors[3] = (color >> 10) & 3;
-         colors[2] = (color >> 2) & 3;
-         colors[1] = (color >> 8) & 3;
-         colors[0] = color & 3;
+         if ((solid & (0x80 >> i)) && BG_SOLID(surface[i]))
+         {
+            strike_pixel = i;
+            break;
+         }
       }
+   }
 
-      /* check for solid sprite pixel overlapping solid bg pixel */
-      if (check_strike)
+   /* solid sprite in front, with no other sprite under it */
+   if (0xFF == solid && 0 == (attrib & OAMF_BEHIND))
+   {
+      memcpy(&lo, surface, 4);
+      memcpy(&hi, surface + 4, 4);
+      if (0 == ((lo | hi) & (SP_PIXEL * 0x01010101)))
       {
-         if (colors[0] && BG_SOLID(surface[0]))
-            strike_pixel = 0;
-         else if (colors[1] && BG_SOLID(surface[1]))
-            strike_pixel = 1;
-         else if (colors[2] && BG_SOLID(surface[2]))
-            strike_pixel = 2;
-         else if (colors[3] && BG_SOLID(surface[3]))
-            strike_pixel = 3;
-         else if (colors[4] && BG_SOLID(surface[4]))
-            strike_pixel = 4;
-         else if (colors[5] && BG_SOLID(surface[5]))
-            strike_pixel = 5;
-         else if (colors[6] && BG_SOLID(surface[6]))
-            strike_pixel = 6;
-         else if (colors[7] && BG_SOLID(surface[7]))
-            strike_pixel = 7;
+         draw_row(surface, row, pair);
+         return strike_pixel;
       }
+   }
+
+   /* draw the character */
+   for (i = 0; i < 8; i++, row <<= 2)
+   {
+      uint8 color = (row >> 14) & 3;
+
+      if (0 == color)
+         continue;
 
-      /* draw the character */
       if (attrib & OAMF_BEHIND)
-      {
-         if (colors[0])
-            surface[0] = SP_PIXEL | (BG_CLEAR(surface[0]) ? col_tbl[colors[0]] : surface[0]);
-         if (colors[1])
-            surface[1] = SP_PIXEL | (BG_CLEAR(surface[1]) ? col_tbl[colors[1]] : surface[1]);
-         if (colors[2])
-            surface[2] = SP_PIXEL | (BG_CLEAR(surface[2]) ? col_tbl[colors[2]] : surface[2]);
-         if (colors[3])
-            surface[3] = SP_PIXEL | (BG_CLEAR(surface[3]) ? col_tbl[colors[3]] : surface[3]);
-         if (colors[4])
-            surface[4] = SP_PIXEL | (BG_CLEAR(surface[4]) ? col_tbl[colors[4]] : surface[4]);
-         if (colors[5])
-            surface[5] = SP_PIXEL | (BG_CLEAR(surface[5]) ? col_tbl[colors[5]] : surface[5]);
-         if (colors[6])
-            surface[6] = SP_PIXEL | (BG_CLEAR(surface[6]) ? col_tbl[colors[6]] : surface[6]);
-         if (colors[7])
-            surface[7] = SP_PIXEL | (BG_CLEAR(surface[7]) ? col_tbl[colors[7]] : surface[7]);
-      }
-      else
-      {
-         if (colors[0] && SP_CLEAR(surface[0]))
-            surface[0] = SP_PIXEL | col_tbl[colors[0]];
-         if (colors[1] && SP_CLEAR(surface[1]))
-            surface[1] = SP_PIXEL | col_tbl[colors[1]];
-         if (colors[2] && SP_CLEAR(surface[2]))
-            surface[2] = SP_PIXEL | col_tbl[colors[2]];
-         if (colors[3] && SP_CLEAR(surface[3]))
-            surface[3] = SP_PIXEL | col_tbl[colors[3]];
-         if (colors[4] && SP_CLEAR(surface[4]))
-            surface[4] = SP_PIXEL | col_tbl[colors[4]];
-         if (colors[5] && SP_CLEAR(surface[5]))
-            surface[5] = SP_PIXEL | col_tbl[colors[5]];
-         if (colors[6] && SP_CLEAR(surface[6]))
-            surface[6] = SP_PIXEL | col_tbl[colors[6]];
-         if (colors[7] && SP_CLEAR(surface[7]))
-            surface[7] = SP_PIXEL | col_tbl[colors[7]];
-      }
+         surface[i] = SP_PIXEL | (BG_CLEAR(surface[i]) ? col_tbl[color] : surface[i]);
+      else if (SP_CLEAR(surface[i]))
+         surface[i] = SP_PIXEL | col_tbl[color];
    }
 
    return strike_pixel;
@@ -664,8 +782,9 @@ INLINE int draw_oamtile(uint8 *surface, uint8 attrib, uint8 pat1,
 
 static void ppu_renderbg(uint8 *vidbuf)
 {
-   uint8 *bmp_ptr, *data_ptr, *tile_ptr, *attrib_ptr;
-   uint32 refresh_vaddr, bg_offset, attrib_base;
+   uint8 *bmp_ptr, *tile_ptr, *attrib_ptr;
+   const chrtile_t *tile;
+   uint32 refresh_vaddr, y_offset, attrib_base;
    int tile_count;
    uint8 tile_index, x_tile, y_tile;
    uint8 col_high, attrib, attrib_shift;
@@ -681,7 +800,10 @@ static void ppu_renderbg(uint8 *vidbuf)
    refresh_vaddr = 0x2000 + (ppu.vaddr & 0x0FE0); /* mask out x tile */
    x_tile = ppu.vaddr & 0x1F;
    y_tile = (ppu.vaddr >> 5) & 0x1F; /* to simplify calculations */
-   bg_offset = ((ppu.vaddr >> 12) & 7) + ppu.bg_base; /* offset in y tile */
+   y_offset = (ppu.vaddr >> 12) & 7; /* offset in y tile */
+
+   if (col_pair_dirty)
+      col_buildpair();
 
    /* calculate initial values */
    tile_ptr = &PPU_MEM(refresh_vaddr + x_tile); /* pointer to tile index */
@@ -697,13 +819,13 @@ static void ppu_renderbg(uint8 *vidbuf)
    {
       /* Tile number from nametable */
       tile_index = *tile_ptr++;
-      data_ptr = &PPU_MEM(bg_offset + (tile_index << 4));
+      tile = chr_gettile(ppu.bg_base + (tile_index << 4));
 
       /* Handle $FD/$FE tile VROM switching (PunchOut) */
       if (ppu.latchfunc)
          ppu.latchfunc(ppu.bg_base, tile_index);
 
-      draw_bgtile(bmp_ptr, data_ptr[0], data_ptr[8], ppu.palette + col_high);
+      draw_row(bmp_ptr, tile->row[y_offset], col_pair[col_high >> 2]);
       bmp_ptr += 8;
 
       x_tile++;
@@ -780,10 +902,14 @@ static void ppu_renderoam(uint8 *vidbuf, int scanline)
 
    sprite_ptr = (obj_t *) ppu.oam;
 
+   if (col_pair_dirty)
+      col_buildpair();
+
    for (sprite_num = 0; sprite_num < 64; sprite_num++, sprite_ptr++)
    {
-      uint8 *data_ptr, *bmp_ptr;
-      uint32 vram_adr;
+      const chrtile_t *tile;
+      uint8 *bmp_ptr;
+      uint32 vram_adr, row;
       int y_offset;
       uint8 tile_index, attrib, col_high;
       uint8 sprite_y, sprite_x;
@@ -816,9 +942,6 @@ static void ppu_renderoam(uint8 *vidbuf, int scanline)
       else
          vram_adr = vram_offset + (tile_index << 4);
 
-      /* Get the address of the tile */
-      data_ptr = &PPU_MEM(vram_adr);
-
       /* Calculate offset (line within the sprite) */
       y_offset = scanline - sprite_y;
       if (y_offset > 7)
@@ -832,18 +955,22 @@ static void ppu_renderoam(uint8 *vidbuf, int scanline)
          else
             y_offset -= 7;
 
-         data_ptr -= y_offset;
+         y_offset = -y_offset;
       }
+
+      /* Get the tile (the second one of 8x16 sprites is 16 bytes after) */
+      tile = chr_gettile(vram_adr + (y_offset & 0x10));
+      if (attrib & OAMF_HFLIP)
+         row = tile->flip[y_offset & 7];
       else
-      {
-         data_ptr += y_offset;
-      }
+         row = tile->row[y_offset & 7];
 
       /* if we're on sprite 0 and sprite 0 strike flag isn't set,
       ** check for a strike 
       */
       check_strike = (0 == sprite_num) && (false == ppu.strikeflag);
-      strike_pixel = draw_oamtile(bmp_ptr, attrib, data_ptr[0], data_ptr[8], ppu.palette + 16 + col_high, check_strike);
+      strike_pixel = draw_oamrow(bmp_ptr, attrib, row, ppu.palette + 16 + col_high,
+                                 col_pair[4 + (col_high >> 2)], check_strike);
       if (strike_pixel >= 0)
          ppu_setstrike(strike_pixel);
 
@@ -996,12 +1123,17 @@ static void ppu_renderscanline(bitmap_t *bmp, int scanline, bool draw_flag)
       }
    }
 
-   if (draw_flag)
+   if (draw_flag) {
+	   NES_PROF_BEGIN(NES_PROF_PPU_BG);
 	   ppu_renderbg(buf);
+	   NES_PROF_END(NES_PROF_PPU_BG);
+   }
 
    /* TODO: fetch obj data 1 scanline before */
    if (true == ppu.drawsprites && true == draw_flag) {
+	   NES_PROF_BEGIN(NES_PROF_PPU_OAM);
 	   ppu_renderoam(buf, scanline);
+	   NES_PROF_END(NES_PROF_PPU_OAM);
    } else {
       ppu_fakeoam(scanline);
    }
@@ -0,0 +1,44 @@
+#pragma once
+/*
+** nes_prof.h
+**
+** Optional per-frame profiling hooks for the NES core.
+**
+** When NES_PROFILE is defined, the core calls nes_prof_begin()/nes_prof_end()
+** around the 6502 execution and the PPU background/sprite scanline renderers
+** (the host brackets apu_process() itself with NES_PROF_APU), and the host has
+** to provide both functions (see NESEMU_sample/headless).  Otherwise the hooks
+** compile to nothing.
+*/
+
+enum
+{
+   NES_PROF_CPU = 0,
+   NES_PROF_PPU_BG,
+   NES_PROF_PPU_OAM,
+   NES_PROF_APU,
+   NES_PROF_NUM
+};
+
+#ifdef NES_PROFILE
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+extern void nes_prof_begin(int id);
+extern void nes_prof_end(int id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#define  NES_PROF_BEGIN(id)   nes_prof_begin(id)
+#define  NES_PROF_END(id)     nes_prof_end(id)
+
+#else /* !NES_PROFILE */
+
+#define  NES_PROF_BEGIN(id)
+#define  NES_PROF_END(id)
+
+#endif /* !NES_PROFILE */
@@ -0,0 +1,431 @@
+/*
+** nessnap.c
+**
+** In-memory snapshot ring for instant rewind.
+**
+** Ring record: [u32 header][payload][u32 trailer], 4-byte aligned.  Header
+** and trailer both hold the payload length (bits 0-23) and the number of
+** snapshots since the keyframe (bits 24-31, 0 = keyframe); the trailer lets
+** rewind walk backwards from the newest record.
+**
+** Payload: the snapshot (XOR the last keyframe for deltas) run-length coded
+**   0x00-0x3F          1-64 zero bytes
+**   0x40-0x7F, n       1-16384 zero bytes ((c & 0x3F) << 8 | n) + 1
+**   0x80-0xFF, ...     1-128 literal bytes follow
+*/
+#include <string.h>
+
+#include "nes_std.h"
+#include "log.h"
+#include "nesstate.h"
+#include "nessnap.h"
+
+#define  SNAP_ALIGN(x)     (((x) + 3) & ~3)
+#define  SNAP_LEN(h)       ((h) & 0xFFFFFF)
+#define  SNAP_SEQ(h)       ((h) >> 24)
+#define  SNAP_RECORD(len)  (SNAP_ALIGN(len) + 8)
+
+static uint8 *snap_mem = NULL;
+static uint32 snap_memsize = 0;
+static int snap_interval = 30;
+
+/* current and last keyframe images (nesstate_t + VRAM/SRAM) */
+static uint8 *snap_cur, *snap_key;
+static uint32 snap_raw;
+
+static uint8 *ring;
+static uint32 ring_size;
+static uint32 ring_head, ring_tail, ring_wrap;
+static bool ring_wrapped;
+static int ring_count, ring_keys;
+static int since_key;
+static uint32 last_key, last_delta;
+
+static snap_info_t snap_stat;
+
+INLINE uint32 ring_getword(uint32 offset)
+{
+   return *(uint32 *) (ring + offset);
+}
+
+INLINE void ring_setword(uint32 offset, uint32 data)
+{
+   *(uint32 *) (ring + offset) = data;
+}
+
+/* run-length code src (XOR ref, if any) into dst, returns coded length,
+** or 0 if it does not fit in max bytes
+*/
+static uint32 snap_encode(uint8 *dst, uint32 max, const uint8 *src,
+                          const uint8 *ref, uint32 len)
+{
+   uint8 *out = dst;
+   uint8 *end = dst + max;
+   uint32 i = 0, j, run;
+
+#define  SNAP_BYTE(n)   (ref ? (src[n] ^ ref[n]) : src[n])
+
+   while (i < len)
+   {
+      if (0 == SNAP_BYTE(i))
+      {
+         run = 1;
+         while (i + run < len && run < 0x4000 && 0 == SNAP_BYTE(i + run))
+            run++;
+
+         if (out + 2 > end)
+            return 0;
+
+         if (run <= 0x40)
+         {
+            *out++ = run - 1;
+         }
+         else
+         {
+            *out++ = 0x40 | ((run - 1) >> 8);
+            *out++ = (run - 1) & 0xFF;
+         }
+         i += run;
+      }
+      else
+      {
+         /* a single zero byte is cheaper inside a literal */
+         j = i + 1;
+         while (j < len && j - i < 0x80)
+         {
+            if (0 == SNAP_BYTE(j) && (j + 1 >= len || 0 == SNAP_BYTE(j + 1)))
+               break;
+            j++;
+         }
+
+         if (out + 1 + (j - i) > end)
+            return 0;
+
+         *out++ = 0x80 | (j - i - 1);
+         for (; i < j; i++)
+            *out++ = SNAP_BYTE(i);
+      }
+   }
+
+#undef SNAP_BYTE
+
+   return out - dst;
+}
+
+/* decode into dst; in XOR mode zero runs are skipped and literals XORed */
+static void snap_decode(uint8 *dst, const uint8 *src, uint32 len, bool xor_mode)
+{
+   const uint8 *end = src + len;
+   uint32 run;
+   uint8 code;
+
+   while (src < end)
+   {
+      code = *src++;
+      if (code & 0x80)
+      {
+         run = (code & 0x7F) + 1;
+         if (xor_mode)
+         {
+            while (run--)
+               *dst++ ^= *src++;
+         }
+         else
+         {
+            memcpy(dst, src, run);
+            dst += run;
+            src += run;
+         }
+      }
+      else
+      {
+         if (code & 0x40)
+            run = (((code & 0x3F) << 8) | *src++) + 1;
+         else
+            run = code + 1;
+
+         if (false == xor_mode)
+            memset(dst, 0, run);
+         dst += run;
+      }
+   }
+}
+
+/* worst case ring bytes of one record */
+static uint32 snap_maxrecord(void)
+{
+   return SNAP_RECORD(snap_raw + snap_raw / 64 + 16);
+}
+
+/* offset of the record before the one at offset (ring_head = newest) */
+static uint32 ring_prev(uint32 offset)
+{
+   if (0 == offset && ring_wrapped)
+      offset = ring_wrap;
+
+   return offset - SNAP_RECORD(SNAP_LEN(ring_getword(offset - 4)));
+}
+
+static void ring_evict(void)
+{
+   uint32 header;
+
+   ASSERT(ring_count > 0);
+
+   header = ring_getword(ring_tail);
+   if (0 == SNAP_SEQ(header))
+      ring_keys--;
+
+   ring_tail += SNAP_RECORD(SNAP_LEN(header));
+   ring_count--;
+
+   if (ring_wrapped && ring_tail >= ring_wrap)
+   {
+      ring_tail = 0;
+      ring_wrapped = false;
+   }
+
+   if (0 == ring_count)
+   {
+      ring_head = ring_tail = 0;
+      ring_wrapped = false;
+   }
+}
+
+/* make need bytes of contiguous room at ring_head */
+static void ring_reserve(uint32 need)
+{
+   for (;;)
+   {
+      if (0 == ring_count)
+      {
+         ring_head = ring_tail = 0;
+         ring_wrapped = false;
+         break;
+      }
+
+      if (false == ring_wrapped)
+      {
+         if (ring_size - ring_head >= need)
+            break;
+
+         if (ring_tail >= need)
+         {
+            ring_wrap = ring_head;
+            ring_head = 0;
+            ring_wrapped = true;
+            continue;
+         }
+      }
+      else if (ring_tail - ring_head >= need)
+      {
+         break;
+      }
+
+      ring_evict();
+
+      /* deltas are useless without their keyframe */
+      while (ring_count && 0 != SNAP_SEQ(ring_getword(ring_tail)))
+         ring_evict();
+   }
+}
+
+/* carve the caller's memory for the loaded cart */
+static int snap_setup(void)
+{
+   uint8 *mem;
+   uint32 raw;
+
+   raw = SNAP_ALIGN(sizeof(nesstate_t) + state_extrasize());
+   if (raw == snap_raw && NULL != ring)
+      return 0;
+
+   snap_raw = raw;
+   ring = NULL;
+
+   mem = (uint8 *) SNAP_ALIGN((uintptr_t) snap_mem);
+   if (NULL == snap_mem
+       || snap_memsize < (uint32) (mem - snap_mem) + raw * 2 + snap_maxrecord())
+   {
+      log_printf("snap: %u bytes ring is too small\n", snap_memsize);
+      return -1;
+   }
+
+   snap_cur = mem;
+   snap_key = mem + raw;
+   ring = mem + raw * 2;
+   ring_size = (snap_memsize - (uint32) (ring - snap_mem)) & ~3;
+
+   snap_reset();
+   return 0;
+}
+
+/* give the snapshot ring its memory (NULL disables it) */
+int snap_init(void *mem, uint32 size, int key_interval)
+{
+   snap_mem = (uint8 *) mem;
+   snap_memsize = size;
+   if (key_interval > 0)
+      snap_interval = key_interval > 255 ? 255 : key_interval;
+
+   /* carved on the next push, when the cart is known */
+   ring = NULL;
+   snap_raw = 0;
+   snap_reset();
+   return 0;
+}
+
+/* drop all snapshots (call after a reset, a state load or a new cart) */
+void snap_reset(void)
+{
+   ring_head = ring_tail = ring_wrap = 0;
+   ring_wrapped = false;
+   ring_count = ring_keys = 0;
+   since_key = 0;
+   last_key = last_delta = 0;
+
+   memset(&snap_stat, 0, sizeof(snap_stat));
+}
+
+/* snapshot the machine, call once per frame */
+int snap_push(void)
+{
+   uint32 len, need, header;
+   uint8 *tmp;
+   bool key;
+
+   if (NULL == snap_mem || snap_setup())
+      return -1;
+
+   state_capture((nesstate_t *) snap_cur, snap_cur + sizeof(nesstate_t));
+
+   /* reserve twice the size of the last record of the same kind, and the
+   ** worst case only if that was not enough
+   */
+   key = (0 == ring_count || since_key >= snap_interval);
+   need = key ? last_key : last_delta;
+   need = need ? SNAP_RECORD(need * 2 + 64) : snap_maxrecord();
+   if (need > snap_maxrecord())
+      need = snap_maxrecord();
+
+   for (;;)
+   {
+      ring_reserve(need);
+
+      key = (0 == ring_count || since_key >= snap_interval);
+      len = snap_encode(ring + ring_head + 4, need - 8, snap_cur,
+                        key ? NULL : snap_key, snap_raw);
+      if (len)
+         break;
+
+      ASSERT(need < snap_maxrecord());
+      need = snap_maxrecord();
+   }
+
+   if (key)
+   {
+      since_key = 0;
+      last_key = len;
+   }
+   else
+   {
+      last_delta = len;
+   }
+
+   header = len | (since_key << 24);
+   ring_setword(ring_head, header);
+   ring_setword(ring_head + SNAP_RECORD(len) - 4, header);
+   ring_head += SNAP_RECORD(len);
+   ring_count++;
+   since_key++;
+
+   snap_stat.last_bytes = SNAP_RECORD(len);
+   if (key)
+   {
+      /* the capture becomes the reference for the following deltas */
+      tmp = snap_key;
+      snap_key = snap_cur;
+      snap_cur = tmp;
+
+      ring_keys++;
+      snap_stat.key_count++;
+      snap_stat.key_bytes += SNAP_RECORD(len);
+   }
+   else
+   {
+      snap_stat.delta_count++;
+      snap_stat.delta_bytes += SNAP_RECORD(len);
+   }
+
+   return 0;
+}
+
+/* go back to the count-th newest snapshot (0 = newest), newer ones are dropped */
+int snap_rewind(int count)
+{
+   uint32 offset, header;
+   int seq;
+
+   if (NULL == ring || count < 0 || count >= ring_count)
+      return -1;
+
+   /* drop the newer records */
+   while (count--)
+   {
+      offset = ring_prev(ring_head);
+      if (0 == SNAP_SEQ(ring_getword(offset)))
+         ring_keys--;
+
+      if (0 == ring_head && ring_wrapped)
+         ring_wrapped = false;
+      ring_head = offset;
+      ring_count--;
+   }
+
+   /* walk back to the keyframe of the target */
+   offset = ring_prev(ring_head);
+   header = ring_getword(offset);
+   seq = SNAP_SEQ(header);
+   while (SNAP_SEQ(ring_getword(offset)))
+      offset = ring_prev(offset);
+
+   snap_decode(snap_key, ring + offset + 4, SNAP_LEN(ring_getword(offset)), false);
+
+   if (seq)
+   {
+      offset = ring_prev(ring_head);
+      memcpy(snap_cur, snap_key, snap_raw);
+      snap_decode(snap_cur, ring + offset + 4, SNAP_LEN(header), true);
+      state_restore((nesstate_t *) snap_cur, snap_cur + sizeof(nesstate_t));
+   }
+   else
+   {
+      state_restore((nesstate_t *) snap_key, snap_key + sizeof(nesstate_t));
+   }
+
+   since_key = seq + 1;
+   return 0;
+}
+
+int snap_count(void)
+{
+   return ring_count;
+}
+
+void snap_getinfo(snap_info_t *info)
+{
+   ASSERT(info);
+
+   *info = snap_stat;
+   info->count = ring_count;
+   info->keys = ring_keys;
+   info->ring_size = ring ? ring_size : 0;
+   info->raw_size = snap_raw;
+
+   if (0 == ring_count)
+      info->used = 0;
+   else if (ring_wrapped)
+      info->used = ring_wrap - ring_tail + ring_head;
+   else
+      info->used = ring_head - ring_tail;
+}
@@ -0,0 +1,42 @@
+#pragma once
+/*
+** nessnap.h
+**
+** In-memory snapshot ring for instant rewind.
+**
+** Every snap_push() captures the machine with state_capture() and stores it
+** in a caller supplied ring buffer.  Every key_interval-th snapshot is a
+** keyframe, the others are stored as the XOR against the last keyframe, and
+** all of them are run-length coded, so a delta costs only the bytes that
+** changed.  When the ring is full, the oldest snapshots are dropped (deltas
+** whose keyframe is gone are dropped with it).
+*/
+#include "nes_std.h"
+
+typedef struct snap_info_s
+{
+   int count;           /* snapshots in the ring */
+   int keys;            /* keyframes in the ring */
+   uint32 used;         /* ring bytes in use */
+   uint32 ring_size;    /* ring bytes available */
+   uint32 raw_size;     /* bytes of one uncompressed snapshot */
+   uint32 last_bytes;   /* stored bytes of the newest snapshot */
+   /* totals since snap_reset() */
+   uint32 key_count, key_bytes;
+   uint32 delta_count, delta_bytes;
+} snap_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+extern int snap_init(void *mem, uint32 size, int key_interval);
+extern void snap_reset(void);
+extern int snap_push(void);
+extern int snap_rewind(int count);
+extern int snap_count(void);
+extern void snap_getinfo(snap_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -48,43 +48,43 @@ void state_setslot(int slot)
 	}
 }
 
-static int save_baseblock(nes_t *state, SNSS_FILE *snssFile)
+static int save_baseblock(nes_t *state, SnssBaseBlock *block)
 {
    int i;
 
    ASSERT(state);
 
-   snssFile->baseBlock.regA = state->cpu->a_reg;
-   snssFile->baseBlock.regX = state->cpu->x_reg;
-   snssFile->baseBlock.regY = state->cpu->y_reg;
-   snssFile->baseBlock.regFlags = state->cpu->p_reg;
-   snssFile->baseBlock.regStack = state->cpu->s_reg;
-   snssFile->baseBlock.regPc = state->cpu->pc_reg;
+   block->regA = state->cpu->a_reg;
+   block->regX = state->cpu->x_reg;
+   block->regY = state->cpu->y_reg;
+   block->regFlags = state->cpu->p_reg;
+   block->regStack = state->cpu->s_reg;
+   block->regPc = state->cpu->pc_reg;
 
-   snssFile->baseBlock.reg2000 = state->ppu->ctrl0;
-   snssFile->baseBlock.reg2001 = state->ppu->ctrl1;
+   block->reg2000 = state->ppu->ctrl0;
+   block->reg2001 = state->ppu->ctrl1;
 
-   memcpy(snssFile->baseBlock.cpuRam, state->cpu->mem_page[0], 0x800);
-   memcpy(snssFile->baseBlock.spriteRam, state->ppu->oam, 0x100);
-   memcpy(snssFile->baseBlock.ppuRam, state->ppu->nametab, 0x1000);
+   memcpy(block->cpuRam, state->cpu->mem_page[0], 0x800);
+   memcpy(block->spriteRam, state->ppu->oam, 0x100);
+   memcpy(block->ppuRam, state->ppu->nametab, 0x1000);
 
    /* Mask off priority color bits */
    for (i = 0; i < 32; i++)
-      snssFile->baseBlock.palette[i] = state->ppu->palette[i] & 0x3F;
+      block->palette[i] = state->ppu->palette[i] & 0x3F;
 
-   snssFile->baseBlock.mirrorState[0] = (state->ppu->page[8] + 0x2000 - state->ppu->nametab) / 0x400;
-   snssFile->baseBlock.mirrorState[1] = (state->ppu->page[9] + 0x2400 - state->ppu->nametab) / 0x400;
-   snssFile->baseBlock.mirrorState[2] = (state->ppu->page[10] + 0x2800 - state->ppu->nametab) / 0x400;
-   snssFile->baseBlock.mirrorState[3] = (state->ppu->page[11] + 0x2C00 - state->ppu->nametab) / 0x400;
+   block->mirrorState[0] = (state->ppu->page[8] + 0x2000 - state->ppu->nametab) / 0x400;
+   block->mirrorState[1] = (state->ppu->page[9] + 0x2400 - state->ppu->nametab) / 0x400;
+   block->mirrorState[2] = (state->ppu->page[10] + 0x2800 - state->ppu->nametab) / 0x400;
+   block->mirrorState[3] = (state->ppu->page[11] + 0x2C00 - state->ppu->nametab) / 0x400;
 
-   snssFile->baseBlock.vramAddress = state->ppu->vaddr;
-   snssFile->baseBlock.spriteRamAddress = state->ppu->oam_addr;
-   snssFile->baseBlock.tileXOffset = state->ppu->tile_xofs;
+   block->vramAddress = state->ppu->vaddr;
+   block->spriteRamAddress = state->ppu->oam_addr;
+   block->tileXOffset = state->ppu->tile_xofs;
 
    return 0;
 }
 
-static bool save_vramblock(nes_t *state, SNSS_FILE *snssFile)
+static int save_vramblock(nes_t *state, SnssVramBlock *block)
 {
    ASSERT(state);
 
@@ -97,33 +97,34 @@ static bool save_vramblock(nes_t *state, SNSS_FILE *snssFile)
       return -1;
    }
 
-   snssFile->vramBlock.vramSize = VRAM_8K * state->rominfo->vram_banks;
+   block->vramSize = VRAM_8K * state->rominfo->vram_banks;
 
-   memcpy(snssFile->vramBlock.vram, state->rominfo->vram, snssFile->vramBlock.vramSize);
+   memcpy(block->vram, state->rominfo->vram, block->vramSize);
    return 0;
 }
 
-static int save_sramblock(nes_t *state, SNSS_FILE *snssFile)
+/* Check to see if any SRAM was written to */
+static bool sram_written(nes_t *state)
 {
    int i;
-   bool written = false;
    int sram_length;
 
-   ASSERT(state);
-
    sram_length = state->rominfo->sram_banks * SRAM_1K;
 
-   /* Check to see if any SRAM was written to */
    for (i = 0; i < sram_length; i++)
    {
       if (state->rominfo->sram[i])
-      {
-         written = true;
-         break;
-      }
+         return true;
    }
 
-   if (false == written)
+   return false;
+}
+
+static int save_sramblock(nes_t *state, SnssSramBlock *block)
+{
+   ASSERT(state);
+
+   if (NULL == state->rominfo->sram || 0 == state->rominfo->sram_banks)
       return -1;
 
    if (state->rominfo->sram_banks > 8)
@@ -132,52 +133,52 @@ static int save_sramblock(nes_t *state, SNSS_FILE *snssFile)
       return -1;
    }
 
-   snssFile->sramBlock.sramSize = SRAM_1K * state->rominfo->sram_banks;
+   block->sramSize = SRAM_1K * state->rominfo->sram_banks;
 
    /* TODO: this should not always be true!! */
-   snssFile->sramBlock.sramEnabled = true;
+   block->sramEnabled = true;
 
-   memcpy(snssFile->sramBlock.sram, state->rominfo->sram, snssFile->sramBlock.sramSize);
+   memcpy(block->sram, state->rominfo->sram, block->sramSize);
 
    return 0;
 }
 
-static int save_soundblock(nes_t *state, SNSS_FILE *snssFile)
+static int save_soundblock(nes_t *state, SnssSoundBlock *block)
 {
    ASSERT(state);
 
 ///   apu_getcontext(state->apu);
 
    /* rect 0 */
-   snssFile->soundBlock.soundRegisters[0x00] = state->apu->rectangle[0].regs[0];
-   snssFile->soundBlock.soundRegisters[0x01] = state->apu->rectangle[0].regs[1];
-   snssFile->soundBlock.soundRegisters[0x02] = state->apu->rectangle[0].regs[2];
-   snssFile->soundBlock.soundRegisters[0x03] = state->apu->rectangle[0].regs[3];
+   block->soundRegisters[0x00] = state->apu->rectangle[0].regs[0];
+   block->soundRegisters[0x01] = state->apu->rectangle[0].regs[1];
+   block->soundRegisters[0x02] = state->apu->rectangle[0].regs[2];
+   block->soundRegisters[0x03] = state->apu->rectangle[0].regs[3];
    /* rect 1 */
-   snssFile->soundBlock.soundRegisters[0x04] = state->apu->rectangle[1].regs[0];
-   snssFile->soundBlock.soundRegisters[0x05] = state->apu->rectangle[1].regs[1];
-   snssFile->soundBlock.soundRegisters[0x06] = state->apu->rectangle[1].regs[2];
-   snssFile->soundBlock.soundRegisters[0x07] = state->apu->rectangle[1].regs[3];
+   block->soundRegisters[0x04] = state->apu->rectangle[1].regs[0];
+   block->soundRegisters[0x05] = state->apu->rectangle[1].regs[1];
+   block->soundRegisters[0x06] = state->apu->rectangle[1].regs[2];
+   block->soundRegisters[0x07] = state->apu->rectangle[1].regs[3];
    /* triangle */
-   snssFile->soundBlock.soundRegisters[0x08] = state->apu->triangle.regs[0];
-   snssFile->soundBlock.soundRegisters[0x0A] = state->apu->triangle.regs[1];
-   snssFile->soundBlock.soundRegisters[0x0B] = state->apu->triangle.regs[2];
+   block->soundRegisters[0x08] = state->apu->triangle.regs[0];
+   block->soundRegisters[0x0A] = state->apu->triangle.regs[1];
+   block->soundRegisters[0x0B] = state->apu->triangle.regs[2];
    /* noise */
-   snssFile->soundBlock.soundRegisters[0X0C] = state->apu->noise.regs[0];
-   snssFile->soundBlock.soundRegisters[0X0E] = state->apu->noise.regs[1];
-   snssFile->soundBlock.soundRegisters[0x0F] = state->apu->noise.regs[2];
+   block->soundRegisters[0X0C] = state->apu->noise.regs[0];
+   block->soundRegisters[0X0E] = state->apu->noise.regs[1];
+   block->soundRegisters[0x0F] = state->apu->noise.regs[2];
    /* dmc */
-   snssFile->soundBlock.soundRegisters[0x10] = state->apu->dmc.regs[0];
-   snssFile->soundBlock.soundRegisters[0x11] = state->apu->dmc.regs[1];
-   snssFile->soundBlock.soundRegisters[0x12] = state->apu->dmc.regs[2];
-   snssFile->soundBlock.soundRegisters[0x13] = state->apu->dmc.regs[3];
+   block->soundRegisters[0x10] = state->apu->dmc.regs[0];
+   block->soundRegisters[0x11] = state->apu->dmc.regs[1];
+   block->soundRegisters[0x12] = state->apu->dmc.regs[2];
+   block->soundRegisters[0x13] = state->apu->dmc.regs[3];
    /* control */
-   snssFile->soundBlock.soundRegisters[0x15] = state->apu->enable_reg;
+   block->soundRegisters[0x15] = state->apu->enable_reg;
 
    return 0;
 }
 
-static int save_mapperblock(nes_t *state, SNSS_FILE *snssFile)
+static int save_mapperblock(nes_t *state, SnssMapperBlock *block)
 {
 	int i;
 	ASSERT(state);
@@ -189,46 +190,46 @@ static int save_mapperblock(nes_t *state, SNSS_FILE *snssFile)
 
    /* TODO: snss spec should be updated, using 4kB ROM pages.. */
    for (i = 0; i < 4; i++)
-      snssFile->mapperBlock.prgPages[i] = (state->cpu->mem_page[(i + 4) * 2] - state->rominfo->rom) >> 13;
+      block->prgPages[i] = (state->cpu->mem_page[(i + 4) * 2] - state->rominfo->rom) >> 13;
 
    if (state->rominfo->vrom_banks)
    {
       for (i = 0; i < 8; i++)
-         snssFile->mapperBlock.chrPages[i] = (ppu_getpage(i) - state->rominfo->vrom + (i * 0x400)) >> 10;
+         block->chrPages[i] = (ppu_getpage(i) - state->rominfo->vrom + (i * 0x400)) >> 10;
    }
    else
    {
       /* bleh! slight hack */
       for (i = 0; i < 8; i++)
-         snssFile->mapperBlock.chrPages[i] = i;
+         block->chrPages[i] = i;
    }
 
    if (state->mmc->intf->get_state)
-      state->mmc->intf->get_state(&snssFile->mapperBlock);
+      state->mmc->intf->get_state(block);
 
    return 0;
 }
 
-static void load_baseblock(nes_t *state, SNSS_FILE *snssFile)
+static void load_baseblock(nes_t *state, const SnssBaseBlock *block)
 {
    int i;
    
    ASSERT(state);
 
-   state->cpu->a_reg = snssFile->baseBlock.regA;
-   state->cpu->x_reg = snssFile->baseBlock.regX;
-   state->cpu->y_reg = snssFile->baseBlock.regY;
-   state->cpu->p_reg = snssFile->baseBlock.regFlags;
-   state->cpu->s_reg = snssFile->baseBlock.regStack;
-   state->cpu->pc_reg = snssFile->baseBlock.regPc;
+   state->cpu->a_reg = block->regA;
+   state->cpu->x_reg = block->regX;
+   state->cpu->y_reg = block->regY;
+   state->cpu->p_reg = block->regFlags;
+   state->cpu->s_reg = block->regStack;
+   state->cpu->pc_reg = block->regPc;
 
-   state->ppu->ctrl0 = snssFile->baseBlock.reg2000;
-   state->ppu->ctrl1 = snssFile->baseBlock.reg2001;
+   state->ppu->ctrl0 = block->reg2000;
+   state->ppu->ctrl1 = block->reg2001;
 
-   memcpy(state->cpu->mem_page[0], snssFile->baseBlock.cpuRam, 0x800);
-   memcpy(state->ppu->oam, snssFile->baseBlock.spriteRam, 0x100);
-   memcpy(state->ppu->nametab, snssFile->baseBlock.ppuRam, 0x1000);
-   memcpy(state->ppu->palette, snssFile->baseBlock.palette, 0x20);
+   memcpy(state->cpu->mem_page[0], block->cpuRam, 0x800);
+   memcpy(state->ppu->oam, block->spriteRam, 0x100);
+   memcpy(state->ppu->nametab, block->ppuRam, 0x1000);
+   memcpy(state->ppu->palette, block->palette, 0x20);
 
    /* TODO: argh, this is to handle nofrendo's filthy sprite priority method */
    for (i = 0; i < 8; i++)
@@ -237,12 +238,12 @@ static void load_baseblock(nes_t *state, SNSS_FILE *snssFile)
    for (i = 0; i < 4; i++)
    {
       state->ppu->page[i + 8] = state->ppu->page[i + 12] =
-         state->ppu->nametab + (snssFile->baseBlock.mirrorState[i] * 0x400) - (0x2000 + (i * 0x400));
+         state->ppu->nametab + (block->mirrorState[i] * 0x400) - (0x2000 + (i * 0x400));
    }
 
-   state->ppu->vaddr = snssFile->baseBlock.vramAddress;
-   state->ppu->oam_addr = snssFile->baseBlock.spriteRamAddress;
-   state->ppu->tile_xofs = snssFile->baseBlock.tileXOffset;
+   state->ppu->vaddr = block->vramAddress;
+   state->ppu->oam_addr = block->spriteRamAddress;
+   state->ppu->tile_xofs = block->tileXOffset;
 
    /* do some extra handling */
    state->ppu->flipflop = 0;
@@ -254,20 +255,20 @@ static void load_baseblock(nes_t *state, SNSS_FILE *snssFile)
    ppu_write(PPU_VADDR, (uint8) (state->ppu->vaddr & 0xFF));
 }
 
-static void load_vramblock(nes_t *state, SNSS_FILE *snssFile)
+static void load_vramblock(nes_t *state, const SnssVramBlock *block)
 {
    ASSERT(state);
 
-   ASSERT(snssFile->vramBlock.vramSize <= VRAM_8K); /* can't handle more than this! */
-   memcpy(state->rominfo->vram, snssFile->vramBlock.vram, snssFile->vramBlock.vramSize);
+   ASSERT(block->vramSize <= VRAM_8K); /* can't handle more than this! */
+   memcpy(state->rominfo->vram, block->vram, block->vramSize);
 }
 
-static void load_sramblock(nes_t *state, SNSS_FILE *snssFile)
+static void load_sramblock(nes_t *state, const SnssSramBlock *block)
 {
    ASSERT(state);
 
-   ASSERT(snssFile->sramBlock.sramSize <= SRAM_8K); /* can't handle more than this! */
-   memcpy(state->rominfo->sram, snssFile->sramBlock.sram, snssFile->sramBlock.sramSize);
+   ASSERT(block->sramSize <= SRAM_8K); /* can't handle more than this! */
+   memcpy(state->rominfo->sram, block->sram, block->sramSize);
 }
 
 static void load_controllerblock(nes_t *state, SNSS_FILE *snssFile)
@@ -276,7 +277,7 @@ static void load_controllerblock(nes_t *state, SNSS_FILE *snssFile)
    UNUSED(snssFile);
 }
 
-static void load_soundblock(nes_t *state, SNSS_FILE *snssFile)
+static void load_soundblock(nes_t *state, const SnssSoundBlock *block)
 {
    int i;
 
@@ -285,24 +286,24 @@ static void load_soundblock(nes_t *state, SNSS_FILE *snssFile)
    for (i = 0; i < 0x15; i++)
    {
       if (i != 0x13) /* do NOT trigger OAM DMA! */
-         apu_write(0x4000 + i, snssFile->soundBlock.soundRegisters[i]);
+         apu_write(0x4000 + i, block->soundRegisters[i]);
    }
 }
 
 /* TODO: magic numbers galore */
-static void load_mapperblock(nes_t *state, SNSS_FILE *snssFile)
+static void load_mapperblock(nes_t *state, SnssMapperBlock *block)
 {
 	int i;
    
 	ASSERT(state);
 
    for (i = 0; i < 4; i++)
-      mmc_bankrom(8, 0x8000 + (i * 0x2000), snssFile->mapperBlock.prgPages[i]);
+      mmc_bankrom(8, 0x8000 + (i * 0x2000), block->prgPages[i]);
 
    if (state->rominfo->vrom_banks)
    {
       for (i = 0; i < 8; i++)
-         mmc_bankvrom(1, i * 0x400, snssFile->mapperBlock.chrPages[i]);
+         mmc_bankvrom(1, i * 0x400, block->chrPages[i]);
    }
    else
    {
@@ -313,9 +314,93 @@ static void load_mapperblock(nes_t *state, SNSS_FILE *snssFile)
    }
 
    if (state->mmc->intf->set_state)
-      state->mmc->intf->set_state(&snssFile->mapperBlock);
+      state->mmc->intf->set_state(block);
+}
+
+/* bytes of CHR-RAM and SRAM following an in-memory image */
+uint32 state_extrasize(void)
+{
+   nes_t *machine;
+   uint32 size = 0;
+
+   machine = nes_getcontext();
+   ASSERT(machine);
+
+   if (machine->rominfo->vram)
+      size += machine->rominfo->vram_banks * VRAM_8K;
+   if (machine->rominfo->sram)
+      size += machine->rominfo->sram_banks * SRAM_1K;
+
+   return size;
+}
+
+/* snapshot the machine into memory, for rewind */
+void state_capture(nesstate_t *image, uint8 *extra)
+{
+   nes_t *machine;
+   uint32 size;
+
+   machine = nes_getcontext();
+   ASSERT(machine);
+   ASSERT(image);
+
+   /* keep unused fields (padding, mapper data) stable for delta coding */
+   memset(image, 0, sizeof(nesstate_t));
+
+   if (0 == save_baseblock(machine, &image->base))
+      image->blocks |= STATE_BASE;
+   image->flipflop = machine->ppu->flipflop;
+   image->vaddr_latch = machine->ppu->vaddr_latch;
+   if (0 == save_soundblock(machine, &image->sound))
+      image->blocks |= STATE_SOUND;
+   if (0 == save_mapperblock(machine, &image->mapper))
+      image->blocks |= STATE_MAPPER;
+
+   if (machine->rominfo->vram)
+   {
+      size = machine->rominfo->vram_banks * VRAM_8K;
+      memcpy(extra, machine->rominfo->vram, size);
+      extra += size;
+   }
+
+   if (machine->rominfo->sram)
+      memcpy(extra, machine->rominfo->sram, machine->rominfo->sram_banks * SRAM_1K);
 }
 
+/* restore a snapshot taken by state_capture() */
+void state_restore(nesstate_t *image, const uint8 *extra)
+{
+   nes_t *machine;
+   uint32 size;
+
+   machine = nes_getcontext();
+   ASSERT(machine);
+   ASSERT(image);
+
+   if (machine->rominfo->vram)
+   {
+      size = machine->rominfo->vram_banks * VRAM_8K;
+      memcpy(machine->rominfo->vram, extra, size);
+      extra += size;
+   }
+
+   if (machine->rominfo->sram)
+      memcpy(machine->rominfo->sram, extra, machine->rominfo->sram_banks * SRAM_1K);
+
+   /* same order as a state file: base, sound, mapper */
+   if (image->blocks & STATE_BASE)
+      load_baseblock(machine, &image->base);
+   if (image->blocks & STATE_SOUND)
+      load_soundblock(machine, &image->sound);
+   if (image->blocks & STATE_MAPPER)
+      load_mapperblock(machine, &image->mapper);
+
+   /* load_baseblock() set the latch from vaddr, put the scroll back */
+   machine->ppu->flipflop = image->flipflop;
+   machine->ppu->vaddr_latch = image->vaddr_latch;
+
+   ppu_invalidate();
+}
 
 int state_save(void)
 {
@@ -341,35 +426,35 @@ int state_save(void)
       goto _error;
 
    /* now get all of our blocks */
-   if (0 == save_baseblock(machine, snssFile))
+   if (0 == save_baseblock(machine, &snssFile->baseBlock))
    {
       status = SNSS_WriteBlock(snssFile, SNSS_BASR);
       if (SNSS_OK != status)
          goto _error;
    }
 
-   if (0 == save_vramblock(machine, snssFile))
+   if (0 == save_vramblock(machine, &snssFile->vramBlock))
    {
       status = SNSS_WriteBlock(snssFile, SNSS_VRAM);
       if (SNSS_OK != status)
          goto _error;
    }
 
-   if (0 == save_sramblock(machine, snssFile))
+   if (sram_written(machine) && 0 == save_sramblock(machine, &snssFile->sramBlock))
    {
       status = SNSS_WriteBlock(snssFile, SNSS_SRAM);
       if (SNSS_OK != status)
          goto _error;
    }
 
-   if (0 == save_soundblock(machine, snssFile))
+   if (0 == save_soundblock(machine, &snssFile->soundBlock))
    {
       status = SNSS_WriteBlock(snssFile, SNSS_SOUN);
       if (SNSS_OK != status)
          goto _error;
    }
 
-   if (0 == save_mapperblock(machine, snssFile))
+   if (0 == save_mapperblock(machine, &snssFile->mapperBlock))
    {
       status = SNSS_WriteBlock(snssFile, SNSS_MPRD);
       if (SNSS_OK != status)
@@ -429,19 +514,19 @@ int state_load(void)
       switch (block_type)
       {
       case SNSS_BASR:
-         load_baseblock(machine, snssFile);
+         load_baseblock(machine, &snssFile->baseBlock);
          break;
 
       case SNSS_VRAM:
-         load_vramblock(machine, snssFile);
+         load_vramblock(machine, &snssFile->vramBlock);
          break;
 
       case SNSS_SRAM:
-         load_sramblock(machine, snssFile);
+         load_sramblock(machine, &snssFile->sramBlock);
          break;
       
       case SNSS_MPRD:
-         load_mapperblock(machine, snssFile);
+         load_mapperblock(machine, &snssFile->mapperBlock);
          break;
       
       case SNSS_CNTR:
@@ -449,7 +534,7 @@ int state_load(void)
          break;
       
       case SNSS_SOUN:
-         load_soundblock(machine, snssFile);
+         load_soundblock(machine, &snssFile->soundBlock);
          break;
       
       case SNSS_UNKNOWN_BLOCK:
@@ -464,6 +549,9 @@ int state_load(void)
    if (SNSS_OK != status)
       goto _error;
 
+   /* CHR-RAM and palette were overwritten behind the PPU's back */
+   ppu_invalidate();
+
 	log_printf("State %d restored\n", state_slot);
 	return 0;
 
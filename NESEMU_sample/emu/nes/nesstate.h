@@ -24,6 +24,26 @@
 ** $Id: nesstate.h,v 1.2 2001/04/27 14:37:11 neil Exp $
 */
 #include "nes.h"
+#include "libsnss.h"
+
+/* blocks present in an in-memory state image */
+#define  STATE_BASE     0x01
+#define  STATE_SOUND    0x02
+#define  STATE_MAPPER   0x04
+
+/* in-memory state image (same blocks as a .ssX file, no file I/O);
+** VRAM and SRAM follow in a separate buffer of state_extrasize() bytes
+*/
+typedef struct nesstate_s
+{
+   uint8 blocks;
+   /* PPU internals a state file loses (scroll latch) */
+   uint8 flipflop;
+   uint16 vaddr_latch;
+   SnssBaseBlock base;
+   SnssSoundBlock sound;
+   SnssMapperBlock mapper;
+} nesstate_t;
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +53,10 @@ extern void state_setslot(int slot);
 extern int state_load();
 extern int state_save();
 
+extern uint32 state_extrasize(void);
+extern void state_capture(nesstate_t *image, uint8 *extra);
+extern void state_restore(nesstate_t *image, const uint8 *extra);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -24,25 +24,51 @@
 */
 
 #include <string.h>
+#include <math.h>
 
 #include "log.h"
 #include "nes_apu.h"
 #include "nes6502.h"
  
 
-#define  APU_OVERSAMPLE
-#define  APU_VOLUME_DECAY(x)  ((x) -= ((x) >> 7))
-
 /* active APU */
 static apu_t apu_;
 
 /* the following seem to be the correct (empirically determined)
 ** relative volumes between the sound channels
 */
-#define  APU_RECTANGLE_OUTPUT(channel) (apu_.rectangle[channel].output_vol)
-#define  APU_TRIANGLE_OUTPUT           (apu_.triangle.output_vol + (apu_.triangle.output_vol >> 2))
-#define  APU_NOISE_OUTPUT              ((apu_.noise.output_vol + apu_.noise.output_vol + apu_.noise.output_vol) >> 2)
-#define  APU_DMC_OUTPUT                ((apu_.dmc.output_vol + apu_.dmc.output_vol + apu_.dmc.output_vol) >> 2)
+#define  APU_RECTANGLE_OUTPUT(out)  (out)
+#define  APU_TRIANGLE_OUTPUT(out)   ((out) + ((out) >> 2))
+#define  APU_NOISE_OUTPUT(out)      (((out) + (out) + (out)) >> 2)
+#define  APU_DMC_OUTPUT(out)        (((out) + (out) + (out)) >> 2)
+
+/* band-limited step synthesis
+** ===========================
+** channels no longer produce a value per output sample.  each one runs
+** its own timer and reports only the time and size of a change in its
+** output level; apu_blipdelta() spreads that step over APU_BLIP_TAPS
+** samples with a windowed sinc picked by the sub-sample phase.  once all
+** channels have run over a block, apu_process() integrates the buffer in
+** a single pass.  times are 12.20 fixed point output samples from the
+** start of the block, so the cost follows the number of waveform edges
+** and not the sample rate.
+*/
+#define  APU_BLIP_FRAC        20
+#define  APU_BLIP_PHASE_BITS  5
+#define  APU_BLIP_PHASES      (1 << APU_BLIP_PHASE_BITS)
+#define  APU_BLIP_KERNEL_BITS 15
+/* kernel cutoff, relative to nyquist */
+#define  APU_BLIP_CUTOFF      0.9
+/* dc blocker: one pole highpass, ~30Hz at 48kHz */
+#define  APU_DCBLOCK_SHIFT    8
+/* extra bits the dc blocker keeps below the output lsb */
+#define  APU_DCBLOCK_BITS     4
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define  APU_MUTED(bit)       (0 == (apu_.mix_enable & (bit)))
 
 
 /* look up table madness */
@@ -50,11 +76,8 @@ static int32 decay_lut[16];
 static int vbl_lut[32];
 static int trilength_lut[128];
 
-/* noise lookups for both modes */
-#ifndef REALTIME_NOISE
-static int8 noise_long_lut[APU_NOISE_32K];
-static int8 noise_short_lut[APU_NOISE_93];
-#endif /* !REALTIME_NOISE */
+/* band-limited impulse, one row per sub-sample phase */
+static int16 blip_kernel[APU_BLIP_PHASES][APU_BLIP_TAPS];
 
 
 /* vblank length table used for rectangles, triangle, noise */
@@ -114,55 +137,57 @@ void apu_setchan(int chan, bool enabled)
       apu_.mix_enable &= ~(1 << chan);
 }
 
+/* add a step of delta at time (12.20 samples) to the buffer */
+INLINE void apu_blipdelta(uint32 time, int32 delta)
+{
+   const int16 *kernel = blip_kernel[(time >> (APU_BLIP_FRAC - APU_BLIP_PHASE_BITS)) & (APU_BLIP_PHASES - 1)];
+   int32 *buf = &apu_.blip_buf[time >> APU_BLIP_FRAC];
+   int i;
+
+   for (i = 0; i < APU_BLIP_TAPS; i++)
+      buf[i] += delta * kernel[i];
+}
+
+/* move a channel's contribution to the mix to value at time */
+INLINE void apu_setlevel(int32 *level, int32 value, uint32 time)
+{
+   if (value != *level)
+   {
+      apu_blipdelta(time, value - *level);
+      *level = value;
+   }
+}
+
 /* emulation of the 15-bit shift register the
 ** NES uses to generate pseudo-random series
 ** for the white noise channel
 */
-#ifdef REALTIME_NOISE
-INLINE int8 shift_register15(uint8 xor_tap)
+INLINE bool shift_register15(noise_t *noise)
 {
-   static int sreg = 0x4000;
    int bit0, tap, bit14;
 
-   bit0 = sreg & 1;
-   tap = (sreg & xor_tap) ? 1 : 0;
+   bit0 = noise->shift_reg & 1;
+   tap = (noise->shift_reg & noise->xor_tap) ? 1 : 0;
    bit14 = (bit0 ^ tap);
-   sreg >>= 1;
-   sreg |= (bit14 << 14);
-   return (bit0 ^ 1);
+   noise->shift_reg >>= 1;
+   noise->shift_reg |= (bit14 << 14);
+   return (bit0 ^ 1) ? true : false;
 }
-#else /* !REALTIME_NOISE */
-static void shift_register15(int8 *buf, int count)
-{
-   static int sreg = 0x4000;
-   int bit0, bit1, bit6, bit14;
 
-   if (count == APU_NOISE_93)
-   {
-      while (count--)
-      {
-         bit0 = sreg & 1;
-         bit6 = (sreg & 0x40) >> 6;
-         bit14 = (bit0 ^ bit6);
-         sreg >>= 1;
-         sreg |= (bit14 << 14);
-         *buf++ = bit0 ^ 1;
-      }
-   }
-   else /* 32K noise */
+/* envelope decay at a rate of (env_delay + 1) / 240 secs */
+INLINE void apu_envelope(int32 *env_phase, int32 env_delay, uint8 *env_vol, bool holdnote)
+{
+   (*env_phase)--;
+   while (*env_phase < 0)
    {
-      while (count--)
-      {
-         bit0 = sreg & 1;
-         bit1 = (sreg & 2) >> 1;
-         bit14 = (bit0 ^ bit1);
-         sreg >>= 1;
-         sreg |= (bit14 << 14);
-         *buf++ = bit0 ^ 1;
-      }
+      *env_phase += env_delay;
+
+      if (holdnote)
+         *env_vol = (*env_vol + 1) & 0x0F;
+      else if (*env_vol < 0x0F)
+         (*env_vol)++;
    }
 }
-#endif /* !REALTIME_NOISE */
 
 /* RECTANGLE WAVE
 ** ==============
@@ -171,172 +196,105 @@ static void shift_register15(int8 *buf, int count)
 ** reg2: 8 bits of freq
 ** reg3: 0-2=high freq, 7-4=vbl length counter
 */
-#ifdef APU_OVERSAMPLE
+INLINE bool apu_rectangle_audible(const rectangle_t *rect)
+{
+   if (false == rect->enabled || 0 == rect->vbl_length)
+      return false;
 
-#define  APU_MAKE_RECTANGLE(ch) \
-static int32 apu_rectangle_##ch(void) \
-{ \
-   int32 output, total; \
-   int num_times; \
-\
-   APU_VOLUME_DECAY(apu_.rectangle[ch].output_vol); \
-\
-   if (false == apu_.rectangle[ch].enabled || 0 == apu_.rectangle[ch].vbl_length) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   /* vbl length counter */ \
-   if (false == apu_.rectangle[ch].holdnote) \
-      apu_.rectangle[ch].vbl_length--; \
-\
-   /* envelope decay at a rate of (env_delay + 1) / 240 secs */ \
-   apu_.rectangle[ch].env_phase -= 4; /* 240/60 */ \
-   while (apu_.rectangle[ch].env_phase < 0) \
-   { \
-      apu_.rectangle[ch].env_phase += apu_.rectangle[ch].env_delay; \
-\
-      if (apu_.rectangle[ch].holdnote) \
-         apu_.rectangle[ch].env_vol = (apu_.rectangle[ch].env_vol + 1) & 0x0F; \
-      else if (apu_.rectangle[ch].env_vol < 0x0F) \
-         apu_.rectangle[ch].env_vol++; \
-   } \
-\
-   /* TODO: find true relation of freq_limit to register values */ \
-   if (apu_.rectangle[ch].freq < 8 \
-       || (false == apu_.rectangle[ch].sweep_inc \
-           && apu_.rectangle[ch].freq > apu_.rectangle[ch].freq_limit)) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   /* frequency sweeping at a rate of (sweep_delay + 1) / 120 secs */ \
-   if (apu_.rectangle[ch].sweep_on && apu_.rectangle[ch].sweep_shifts) \
-   { \
-      apu_.rectangle[ch].sweep_phase -= 2; /* 120/60 */ \
-      while (apu_.rectangle[ch].sweep_phase < 0) \
-      { \
-         apu_.rectangle[ch].sweep_phase += apu_.rectangle[ch].sweep_delay; \
-\
-         if (apu_.rectangle[ch].sweep_inc) /* ramp up */ \
-         { \
-            if (0 == ch) \
-               apu_.rectangle[ch].freq += ~(apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-            else \
-               apu_.rectangle[ch].freq -= (apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-         } \
-         else /* ramp down */ \
-         { \
-            apu_.rectangle[ch].freq += (apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-         } \
-      } \
-   } \
-\
-   apu_.rectangle[ch].accum -= apu_.cycle_rate; \
-   if (apu_.rectangle[ch].accum >= 0) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   if (apu_.rectangle[ch].fixed_envelope) \
-      output = apu_.rectangle[ch].volume << 8; /* fixed volume */ \
-   else \
-      output = (apu_.rectangle[ch].env_vol ^ 0x0F) << 8; \
-\
-   num_times = total = 0; \
-\
-   while (apu_.rectangle[ch].accum < 0) \
-   { \
-      apu_.rectangle[ch].accum += apu_.rectangle[ch].freq + 1; \
-      apu_.rectangle[ch].adder = (apu_.rectangle[ch].adder + 1) & 0x0F; \
-\
-      if (apu_.rectangle[ch].adder < apu_.rectangle[ch].duty_flip) \
-         total += output; \
-      else \
-         total -= output; \
-\
-      num_times++; \
-   } \
-\
-   apu_.rectangle[ch].output_vol = total / num_times; \
-   return APU_RECTANGLE_OUTPUT(ch); \
-} 
-
-#else /* !APU_OVERSAMPLE */
-#define  APU_MAKE_RECTANGLE(ch) \
-static int32 apu_rectangle_##ch(void) \
-{ \
-   int32 output; \
-\
-   APU_VOLUME_DECAY(apu_.rectangle[ch].output_vol); \
-\
-   if (false == apu_.rectangle[ch].enabled || 0 == apu_.rectangle[ch].vbl_length) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   /* vbl length counter */ \
-   if (false == apu_.rectangle[ch].holdnote) \
-      apu_.rectangle[ch].vbl_length--; \
-\
-   /* envelope decay at a rate of (env_delay + 1) / 240 secs */ \
-   apu_.rectangle[ch].env_phase -= 4; /* 240/60 */ \
-   while (apu_.rectangle[ch].env_phase < 0) \
-   { \
-      apu_.rectangle[ch].env_phase += apu_.rectangle[ch].env_delay; \
-\
-      if (apu_.rectangle[ch].holdnote) \
-         apu_.rectangle[ch].env_vol = (apu_.rectangle[ch].env_vol + 1) & 0x0F; \
-      else if (apu_.rectangle[ch].env_vol < 0x0F) \
-         apu_.rectangle[ch].env_vol++; \
-   } \
-\
-   /* TODO: find true relation of freq_limit to register values */ \
-   if (apu_.rectangle[ch].freq < 8 || (false == apu_.rectangle[ch].sweep_inc && apu_.rectangle[ch].freq > apu_.rectangle[ch].freq_limit)) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   /* frequency sweeping at a rate of (sweep_delay + 1) / 120 secs */ \
-   if (apu_.rectangle[ch].sweep_on && apu_.rectangle[ch].sweep_shifts) \
-   { \
-      apu_.rectangle[ch].sweep_phase -= 2; /* 120/60 */ \
-      while (apu_.rectangle[ch].sweep_phase < 0) \
-      { \
-         apu_.rectangle[ch].sweep_phase += apu_.rectangle[ch].sweep_delay; \
-\
-         if (apu_.rectangle[ch].sweep_inc) /* ramp up */ \
-         { \
-            if (0 == ch) \
-               apu_.rectangle[ch].freq += ~(apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-            else \
-               apu_.rectangle[ch].freq -= (apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-         } \
-         else /* ramp down */ \
-         { \
-            apu_.rectangle[ch].freq += (apu_.rectangle[ch].freq >> apu_.rectangle[ch].sweep_shifts); \
-         } \
-      } \
-   } \
-\
-   apu_.rectangle[ch].accum -= apu_.cycle_rate; \
-   if (apu_.rectangle[ch].accum >= 0) \
-      return APU_RECTANGLE_OUTPUT(ch); \
-\
-   while (apu_.rectangle[ch].accum < 0) \
-   { \
-      apu_.rectangle[ch].accum += (apu_.rectangle[ch].freq + 1); \
-      apu_.rectangle[ch].adder = (apu_.rectangle[ch].adder + 1) & 0x0F; \
-   } \
-\
-   if (apu_.rectangle[ch].fixed_envelope) \
-      output = apu_.rectangle[ch].volume << 8; /* fixed volume */ \
-   else \
-      output = (apu_.rectangle[ch].env_vol ^ 0x0F) << 8; \
-\
-   if (0 == apu_.rectangle[ch].adder) \
-      apu_.rectangle[ch].output_vol = output; \
-   else if (apu_.rectangle[ch].adder == apu_.rectangle[ch].duty_flip) \
-      apu_.rectangle[ch].output_vol = -output; \
-\
-   return APU_RECTANGLE_OUTPUT(ch); \
+   /* TODO: find true relation of freq_limit to register values */
+   if (rect->freq < 8 || (false == rect->sweep_inc && rect->freq > rect->freq_limit))
+      return false;
+
+   return true;
 }
 
-#endif /* !APU_OVERSAMPLE */
+/* length counter, envelope and sweep, clocked at 240Hz (half: 120Hz) */
+static void apu_rectangle_clock(int ch, bool half)
+{
+   rectangle_t *rect = &apu_.rectangle[ch];
+
+   if (false == rect->enabled || 0 == rect->vbl_length)
+      return;
+
+   /* vbl length counter */
+   if (half && false == rect->holdnote)
+      rect->vbl_length--;
+
+   apu_envelope(&rect->env_phase, rect->env_delay, &rect->env_vol, rect->holdnote);
 
-/* generate the functions */
-APU_MAKE_RECTANGLE(0)
-APU_MAKE_RECTANGLE(1)
+   if (false == apu_rectangle_audible(rect))
+      return;
+
+   /* frequency sweeping at a rate of (sweep_delay + 1) / 120 secs */
+   if (half && rect->sweep_on && rect->sweep_shifts)
+   {
+      rect->sweep_phase--;
+      while (rect->sweep_phase < 0)
+      {
+         rect->sweep_phase += rect->sweep_delay;
+
+         if (rect->sweep_inc) /* ramp up */
+         {
+            if (0 == ch)
+               rect->freq += ~(rect->freq >> rect->sweep_shifts);
+            else
+               rect->freq -= (rect->freq >> rect->sweep_shifts);
+         }
+         else /* ramp down */
+         {
+            rect->freq += (rect->freq >> rect->sweep_shifts);
+         }
+      }
+   }
+}
+
+/* the output only changes when adder reaches duty_flip or wraps to 0,
+** so step straight from one edge to the next
+*/
+static void apu_rectangle(int ch, uint32 start, uint32 end)
+{
+   rectangle_t *rect = &apu_.rectangle[ch];
+   int32 output;
+   uint32 period, edge;
+   int steps;
+
+   if (false == apu_rectangle_audible(rect))
+   {
+      apu_setlevel(&rect->level, 0, start);
+      rect->timer = end;
+      return;
+   }
+
+   if (APU_MUTED(1 << ch))
+      output = 0;
+   else if (rect->fixed_envelope)
+      output = APU_RECTANGLE_OUTPUT(rect->volume << 8); /* fixed volume */
+   else
+      output = APU_RECTANGLE_OUTPUT((rect->env_vol ^ 0x0F) << 8);
+
+   if (rect->timer < start)
+      rect->timer = start;
+   apu_setlevel(&rect->level, (rect->adder < rect->duty_flip) ? output : -output, start);
+
+   period = (rect->freq + 1) * apu_.clock_step;
+   while (rect->timer < end)
+   {
+      steps = ((rect->adder < rect->duty_flip) ? rect->duty_flip : 0x10) - rect->adder;
+      edge = rect->timer + (steps - 1) * period;
+      if (edge >= end)
+      {
+         /* no edge left in this block, just advance the sequencer */
+         steps = (end - rect->timer + period - 1) / period;
+         rect->adder = (rect->adder + steps) & 0x0F;
+         rect->timer += steps * period;
+         break;
+      }
+
+      rect->adder = (rect->adder + steps) & 0x0F;
+      apu_setlevel(&rect->level, (rect->adder < rect->duty_flip) ? output : -output, edge);
+      rect->timer = edge + period;
+   }
+}
 
 
 /* TRIANGLE WAVE
@@ -345,18 +303,16 @@ APU_MAKE_RECTANGLE(1)
 ** reg2: low 8 bits of frequency
 ** reg3: 7-3=length counter, 2-0=high 3 bits of frequency
 */
-static int32 apu_triangle(void)
+static void apu_triangle_clock(bool half)
 {
-   APU_VOLUME_DECAY(apu_.triangle.output_vol);
-
    if (false == apu_.triangle.enabled || 0 == apu_.triangle.vbl_length)
-      return APU_TRIANGLE_OUTPUT;
+      return;
 
    if (apu_.triangle.counter_started)
    {
       if (apu_.triangle.linear_length > 0)
          apu_.triangle.linear_length--;
-      if (apu_.triangle.vbl_length && false == apu_.triangle.holdnote)
+      if (half && apu_.triangle.vbl_length && false == apu_.triangle.holdnote)
          apu_.triangle.vbl_length--;
    }
    else if (false == apu_.triangle.holdnote && apu_.triangle.write_latency)
@@ -364,23 +320,47 @@ static int32 apu_triangle(void)
       if (--apu_.triangle.write_latency == 0)
          apu_.triangle.counter_started = true;
    }
+}
 
-   if (0 == apu_.triangle.linear_length || apu_.triangle.freq < 4) /* inaudible */
-      return APU_TRIANGLE_OUTPUT;
+/* 15,14..0,0..14,15 step sequence, centered on zero */
+INLINE int32 apu_triangle_level(void)
+{
+   int32 out;
 
-   apu_.triangle.accum -= apu_.cycle_rate; \
-   while (apu_.triangle.accum < 0)
-   {
-      apu_.triangle.accum += apu_.triangle.freq;
-      apu_.triangle.adder = (apu_.triangle.adder + 1) & 0x1F;
+   if (APU_MUTED(0x04))
+      return 0;
 
-      if (apu_.triangle.adder & 0x10)
-         apu_.triangle.output_vol -= (2 << 8);
-      else
-         apu_.triangle.output_vol += (2 << 8);
+   out = apu_.triangle.adder & 0x0F;
+   if (0 == (apu_.triangle.adder & 0x10))
+      out ^= 0x0F;
+
+   return APU_TRIANGLE_OUTPUT((out + out - 15) * 256);
+}
+
+static void apu_triangle(uint32 start, uint32 end)
+{
+   uint32 period;
+
+   /* a silenced triangle holds its last step */
+   apu_setlevel(&apu_.triangle.level, apu_triangle_level(), start);
+
+   if (false == apu_.triangle.enabled || 0 == apu_.triangle.vbl_length
+       || 0 == apu_.triangle.linear_length || apu_.triangle.freq < 4) /* inaudible */
+   {
+      apu_.triangle.timer = end;
+      return;
    }
 
-   return APU_TRIANGLE_OUTPUT;
+   if (apu_.triangle.timer < start)
+      apu_.triangle.timer = start;
+
+   period = apu_.triangle.freq * apu_.clock_step;
+   while (apu_.triangle.timer < end)
+   {
+      apu_.triangle.adder = (apu_.triangle.adder + 1) & 0x1F;
+      apu_setlevel(&apu_.triangle.level, apu_triangle_level(), apu_.triangle.timer);
+      apu_.triangle.timer += period;
+   }
 }
 
 
@@ -390,123 +370,48 @@ static int32 apu_triangle(void)
 ** reg2: 7=small(93 byte) sample,3-0=freq lookup
 ** reg3: 7-4=vbl length counter
 */
-/* TODO: AAAAAAAAAAAAAAAAAAAAAAAA!  #ifdef MADNESS! */
-static int32 apu_noise(void)
+static void apu_noise_clock(bool half)
 {
-   int32 outvol;
-
-#if defined(APU_OVERSAMPLE) && defined(REALTIME_NOISE)
-#else /* !(APU_OVERSAMPLE && REALTIME_NOISE) */
-   int32 noise_bit;
-#endif /* !(APU_OVERSAMPLE && REALTIME_NOISE) */
-#ifdef APU_OVERSAMPLE
-   int num_times;
-   int32 total;
-#endif /* APU_OVERSAMPLE */
-
-   APU_VOLUME_DECAY(apu_.noise.output_vol);
-
    if (false == apu_.noise.enabled || 0 == apu_.noise.vbl_length)
-      return APU_NOISE_OUTPUT;
+      return;
 
    /* vbl length counter */
-   if (false == apu_.noise.holdnote)
+   if (half && false == apu_.noise.holdnote)
       apu_.noise.vbl_length--;
 
-   /* envelope decay at a rate of (env_delay + 1) / 240 secs */
-   apu_.noise.env_phase -= 4; /* 240/60 */
-   while (apu_.noise.env_phase < 0)
-   {
-      apu_.noise.env_phase += apu_.noise.env_delay;
-
-      if (apu_.noise.holdnote)
-         apu_.noise.env_vol = (apu_.noise.env_vol + 1) & 0x0F;
-      else if (apu_.noise.env_vol < 0x0F)
-         apu_.noise.env_vol++;
-   }
-
-   apu_.noise.accum -= apu_.cycle_rate;
-   if (apu_.noise.accum >= 0)
-      return APU_NOISE_OUTPUT;
-   
-#ifdef APU_OVERSAMPLE
-   if (apu_.noise.fixed_envelope)
-      outvol = apu_.noise.volume << 8; /* fixed volume */
-   else
-      outvol = (apu_.noise.env_vol ^ 0x0F) << 8;
+   apu_envelope(&apu_.noise.env_phase, apu_.noise.env_delay, &apu_.noise.env_vol, apu_.noise.holdnote);
+}
 
-   num_times = total = 0;
-#endif /* APU_OVERSAMPLE */
+static void apu_noise(uint32 start, uint32 end)
+{
+   int32 outvol;
+   uint32 period;
 
-   while (apu_.noise.accum < 0)
+   if (false == apu_.noise.enabled || 0 == apu_.noise.vbl_length)
    {
-      apu_.noise.accum += apu_.noise.freq;
-
-#ifdef REALTIME_NOISE
-
-#ifdef APU_OVERSAMPLE
-      if (shift_register15(apu_.noise.xor_tap))
-         total += outvol;
-      else
-         total -= outvol;
-
-      num_times++;
-#else /* !APU_OVERSAMPLE */
-      noise_bit = shift_register15(apu_.noise.xor_tap);
-#endif /* !APU_OVERSAMPLE */
-
-#else /* !REALTIME_NOISE */
-      apu_.noise.cur_pos++;
-
-      if (apu_.noise.short_sample)
-      {
-         if (APU_NOISE_93 == apu_.noise.cur_pos)
-            apu_.noise.cur_pos = 0;
-      }
-      else
-      {
-         if (APU_NOISE_32K == apu_.noise.cur_pos)
-            apu_.noise.cur_pos = 0;
-      }
-
-#ifdef APU_OVERSAMPLE
-      if (apu_.noise.short_sample)
-         noise_bit = noise_short_lut[apu_.noise.cur_pos];
-      else
-         noise_bit = noise_long_lut[apu_.noise.cur_pos];
-
-      if (noise_bit)
-         total += outvol;
-      else
-         total -= outvol;
-
-      num_times++;
-#endif /* APU_OVERSAMPLE */
-#endif /* !REALTIME_NOISE */
+      apu_setlevel(&apu_.noise.level, 0, start);
+      apu_.noise.timer = end;
+      return;
    }
 
-#ifdef APU_OVERSAMPLE
-   apu_.noise.output_vol = total / num_times;
-#else /* !APU_OVERSAMPLE */
-   if (apu_.noise.fixed_envelope)
-      outvol = apu_.noise.volume << 8; /* fixed volume */
+   if (APU_MUTED(0x08))
+      outvol = 0;
+   else if (apu_.noise.fixed_envelope)
+      outvol = APU_NOISE_OUTPUT(apu_.noise.volume << 8); /* fixed volume */
    else
-      outvol = (apu_.noise.env_vol ^ 0x0F) << 8;
+      outvol = APU_NOISE_OUTPUT((apu_.noise.env_vol ^ 0x0F) << 8);
 
-#ifndef REALTIME_NOISE
-   if (apu_.noise.short_sample)
-      noise_bit = noise_short_lut[apu_.noise.cur_pos];
-   else
-      noise_bit = noise_long_lut[apu_.noise.cur_pos];
-#endif /* !REALTIME_NOISE */
-
-   if (noise_bit)
-      apu_.noise.output_vol = outvol;
-   else
-      apu_.noise.output_vol = -outvol;
-#endif /* !APU_OVERSAMPLE */
+   if (apu_.noise.timer < start)
+      apu_.noise.timer = start;
+   apu_setlevel(&apu_.noise.level, apu_.noise.output_bit ? outvol : -outvol, start);
 
-   return APU_NOISE_OUTPUT;
+   period = apu_.noise.freq * apu_.clock_step;
+   while (apu_.noise.timer < end)
+   {
+      apu_.noise.output_bit = shift_register15(&apu_.noise);
+      apu_setlevel(&apu_.noise.level, apu_.noise.output_bit ? outvol : -outvol, apu_.noise.timer);
+      apu_.noise.timer += period;
+   }
 }
 
 
@@ -517,6 +422,14 @@ INLINE void apu_dmcreload(void)
    apu_.dmc.irq_occurred = false;
 }
 
+INLINE int32 apu_dmc_level(void)
+{
+   if (APU_MUTED(0x10))
+      return 0;
+
+   return APU_DMC_OUTPUT(apu_.dmc.regs[1] << 8);
+}
+
 /* DELTA MODULATION CHANNEL
 ** =========================
 ** reg0: 7=irq gen, 6=looping, 3-0=pointer to clock table
@@ -524,82 +437,96 @@ INLINE void apu_dmcreload(void)
 ** reg2: 8 bits of 64-byte aligned address offset : $C000 + (value * 64)
 ** reg3: length, (value * 16) + 1
 */
-static int32 apu_dmc(void)
+static void apu_dmc(uint32 start, uint32 end)
 {
+   uint32 period;
    int delta_bit;
 
-   APU_VOLUME_DECAY(apu_.dmc.output_vol);
+   /* picks up $4011 writes */
+   apu_setlevel(&apu_.dmc.level, apu_dmc_level(), start);
 
    /* only process when channel is alive */
-   if (apu_.dmc.dma_length)
+   if (0 == apu_.dmc.dma_length)
    {
-      apu_.dmc.accum -= apu_.cycle_rate;
-      
-      while (apu_.dmc.accum < 0)
+      apu_.dmc.timer = end;
+      return;
+   }
+
+   if (apu_.dmc.timer < start)
+      apu_.dmc.timer = start;
+
+   period = apu_.dmc.freq * apu_.clock_step;
+   while (apu_.dmc.timer < end)
+   {
+      delta_bit = (apu_.dmc.dma_length & 7) ^ 7;
+
+      if (7 == delta_bit)
       {
-         apu_.dmc.accum += apu_.dmc.freq;
-         
-         delta_bit = (apu_.dmc.dma_length & 7) ^ 7;
-         
-         if (7 == delta_bit)
-         {
-            apu_.dmc.cur_byte = nes6502_getbyte(apu_.dmc.address);
-            
-            /* steal a cycle from CPU*/
-            nes6502_burn(1);
-
-            /* prevent wraparound */
-            if (0xFFFF == apu_.dmc.address)
-               apu_.dmc.address = 0x8000;
-            else
-               apu_.dmc.address++;
-         }
+         apu_.dmc.cur_byte = nes6502_getbyte(apu_.dmc.address);
 
-         if (--apu_.dmc.dma_length == 0)
-         {
-            /* if loop bit set, we're cool to retrigger sample */
-            if (apu_.dmc.looping)
-            {
-               apu_dmcreload();
-            }
-            else
-            {
-               /* check to see if we should generate an irq */
-               if (apu_.dmc.irq_gen)
-               {
-                  apu_.dmc.irq_occurred = true;
-                  if (apu_.irq_callback)
-                     apu_.irq_callback();
-               }
-
-               /* bodge for timestamp queue */
-               apu_.dmc.enabled = false;
-               break;
-            }
-         }
+         /* steal a cycle from CPU*/
+         nes6502_burn(1);
+
+         /* prevent wraparound */
+         if (0xFFFF == apu_.dmc.address)
+            apu_.dmc.address = 0x8000;
+         else
+            apu_.dmc.address++;
+      }
 
-         /* positive delta */
-         if (apu_.dmc.cur_byte & (1 << delta_bit))
+      if (--apu_.dmc.dma_length == 0)
+      {
+         /* if loop bit set, we're cool to retrigger sample */
+         if (apu_.dmc.looping)
          {
-            if (apu_.dmc.regs[1] < 0x7D)
-            {
-               apu_.dmc.regs[1] += 2;
-               apu_.dmc.output_vol += (2 << 8);
-            }
+            apu_dmcreload();
          }
-         /* negative delta */
-         else            
+         else
          {
-            if (apu_.dmc.regs[1] > 1)
+            /* check to see if we should generate an irq */
+            if (apu_.dmc.irq_gen)
             {
-               apu_.dmc.regs[1] -= 2;
-               apu_.dmc.output_vol -= (2 << 8);
+               apu_.dmc.irq_occurred = true;
+               if (apu_.irq_callback)
+                  apu_.irq_callback();
             }
+
+            /* bodge for timestamp queue */
+            apu_.dmc.enabled = false;
+            apu_.dmc.timer = end;
+            break;
          }
       }
+
+      /* positive delta */
+      if (apu_.dmc.cur_byte & (1 << delta_bit))
+      {
+         if (apu_.dmc.regs[1] < 0x7D)
+            apu_.dmc.regs[1] += 2;
+      }
+      /* negative delta */
+      else
+      {
+         if (apu_.dmc.regs[1] > 1)
+            apu_.dmc.regs[1] -= 2;
+      }
+
+      apu_setlevel(&apu_.dmc.level, apu_dmc_level(), apu_.dmc.timer);
+      apu_.dmc.timer += period;
    }
+}
+
+/* frame sequencer, one call per quarter frame (240Hz) */
+static void apu_sequencer(void)
+{
+   bool half = (apu_.seq_step & 1) ? true : false;
+
+   apu_.seq_step = (apu_.seq_step + 1) & 3;
 
-   return APU_DMC_OUTPUT;
+   apu_rectangle_clock(0, half);
+   apu_rectangle_clock(1, half);
+   apu_triangle_clock(half);
+   apu_noise_clock(half);
 }
 
 
@@ -675,11 +602,11 @@ void apu_write(uint32 address, uint8 value)
       ** then to reg 0, and the counter accidentally starts running because 
       ** of the sound queue's timestamp processing.
       **
-      ** set latency to a couple hundred cycles -- should be plenty of time 
-      ** for the 6502 code to do a couple of table dereferences and load up 
-      ** the other triregs
+      ** the counters are clocked at 240Hz now, so the next quarter frame
+      ** is already plenty of time for the 6502 code to do a couple of
+      ** table dereferences and load up the other triregs
       */
-      apu_.triangle.write_latency = (int) (228 / apu_.cycle_rate);
+      apu_.triangle.write_latency = 1;
       apu_.triangle.freq = (((value & 7) << 8) + apu_.triangle.regs[1]) + 1;
       apu_.triangle.vbl_length = vbl_lut[value >> 3];
       apu_.triangle.counter_started = false;
@@ -698,19 +625,7 @@ void apu_write(uint32 address, uint8 value)
    case APU_WRD2:
       apu_.noise.regs[1] = value;
       apu_.noise.freq = noise_freq[value & 0x0F];
-
-#ifdef REALTIME_NOISE
       apu_.noise.xor_tap = (value & 0x80) ? 0x40: 0x02;
-#else /* !REALTIME_NOISE */
-      /* detect transition from long->short sample */
-      if ((value & 0x80) && false == apu_.noise.short_sample)
-      {
-         /* recalculate short noise buffer */
-         shift_register15(noise_short_lut, APU_NOISE_93);
-         apu_.noise.cur_pos = 0;
-      }
-      apu_.noise.short_sample = (value & 0x80) ? true : false;
-#endif /* !REALTIME_NOISE */
       break;
 
    case APU_WRD3:
@@ -737,11 +652,10 @@ void apu_write(uint32 address, uint8 value)
       break;
 
    case APU_WRE1: /* 7-bit DAC */
-      /* add the _delta_ between written value and
-      ** current output level of the volume reg
+      /* the step to the new level goes into the
+      ** mix when the channel runs next
       */
       value &= 0x7F; /* bit 7 ignored */
-      apu_.dmc.output_vol += ((value - apu_.dmc.regs[1]) << 8);
       apu_.dmc.regs[1] = value;
       break;
 
@@ -867,35 +781,69 @@ uint8 apu_read(uint32 address)
       out = -0x8000; \
 }
 
-void apu_process(void *buffer, int num_samples)
+/* run every channel over [start, end) of the current block */
+static void apu_synth(uint32 start, uint32 end)
 {
-   static int32 prev_sample = 0;
+   apu_rectangle(0, start, end);
+   apu_rectangle(1, start, end);
+   apu_triangle(start, end);
+   apu_noise(start, end);
+   apu_dmc(start, end);
+}
 
+void apu_process(void *buffer, int num_samples)
+{
    int16 *buf16;
    uint8 *buf8;
+   int count, i;
+   uint32 start, end, stop;
+
+   if (NULL == buffer)
+      return;
+
+   /* bleh */
+   apu_.buffer = buffer;
 
-   if (NULL != buffer)
+   buf16 = (int16 *) buffer;
+   buf8 = (uint8 *) buffer;
+
+   while (num_samples > 0)
    {
-      /* bleh */
-      apu_.buffer = buffer;
+      count = (num_samples > APU_BLIP_BLOCK) ? APU_BLIP_BLOCK : num_samples;
+      end = (uint32) count << APU_BLIP_FRAC;
+
+      /* channel registers only change at quarter frame boundaries here */
+      start = 0;
+      while (start < end)
+      {
+         stop = (apu_.seq_time < end) ? apu_.seq_time : end;
+         apu_synth(start, stop);
+         if (stop == apu_.seq_time)
+         {
+            apu_sequencer();
+            apu_.seq_time += apu_.seq_period;
+         }
+         start = stop;
+      }
 
-      buf16 = (int16 *) buffer;
-      buf8 = (uint8 *) buffer;
+      /* make everything relative to the next block */
+      apu_.seq_time -= end;
+      apu_.rectangle[0].timer -= end;
+      apu_.rectangle[1].timer -= end;
+      apu_.triangle.timer -= end;
+      apu_.noise.timer -= end;
+      apu_.dmc.timer -= end;
 
-      while (num_samples--)
+      for (i = 0; i < count; i++)
       {
-         int32 next_sample, accum = 0;
-
-         if (apu_.mix_enable & 0x01)
-            accum += apu_rectangle_0();
-         if (apu_.mix_enable & 0x02)
-            accum += apu_rectangle_1();
-         if (apu_.mix_enable & 0x04)
-            accum += apu_triangle();
-         if (apu_.mix_enable & 0x08)
-            accum += apu_noise();
-         if (apu_.mix_enable & 0x10)
-            accum += apu_dmc();
+         int32 next_sample, accum;
+
+         /* integrate, then remove dc */
+         apu_.blip_sum += apu_.blip_buf[i];
+         accum = apu_.blip_sum >> (APU_BLIP_KERNEL_BITS - APU_DCBLOCK_BITS);
+         apu_.blip_dc += (accum - apu_.blip_dc) >> APU_DCBLOCK_SHIFT;
+         accum = (accum - apu_.blip_dc) >> APU_DCBLOCK_BITS;
+
          if (apu_.ext && (apu_.mix_enable & 0x20))
             accum += apu_.ext->process();
 
@@ -906,13 +854,13 @@ void apu_process(void *buffer, int num_samples)
 
             if (APU_FILTER_LOWPASS == apu_.filter_type)
             {
-               accum += prev_sample;
+               accum += apu_.prev_sample;
                accum >>= 1;
             }
             else
-               accum = (accum + accum + accum + prev_sample) >> 2;
+               accum = (accum + accum + accum + apu_.prev_sample) >> 2;
 
-            prev_sample = next_sample;
+            apu_.prev_sample = next_sample;
          }
 
          /* do clipping */
@@ -924,6 +872,12 @@ void apu_process(void *buffer, int num_samples)
          else
             *buf8++ = (accum >> 8) ^ 0x80;
       }
+
+      /* the kernel tails spill into the next block */
+      memmove(apu_.blip_buf, &apu_.blip_buf[count], APU_BLIP_TAPS * sizeof(int32));
+      memset(&apu_.blip_buf[APU_BLIP_TAPS], 0, count * sizeof(int32));
+
+      num_samples -= count;
    }
 }
 
@@ -947,27 +901,61 @@ void apu_reset(void)
       apu_.ext->reset();
 }
 
-void apu_build_luts(int num_samples)
+/* windowed sinc (blackman), one row per sub-sample phase, each
+** row summing to exactly 1 << APU_BLIP_KERNEL_BITS so that the
+** integrated steps settle without drift
+*/
+static void apu_build_kernel(void)
+{
+   int phase, i, peak;
+   int32 total;
+   double x, w, v;
+
+   for (phase = 0; phase < APU_BLIP_PHASES; phase++)
+   {
+      total = 0;
+      peak = 0;
+      for (i = 0; i < APU_BLIP_TAPS; i++)
+      {
+         /* distance from the step, in samples */
+         x = i - (APU_BLIP_TAPS / 2) - (phase + 0.5) / APU_BLIP_PHASES;
+         w = x / (APU_BLIP_TAPS / 2);
+         if (w <= -1.0 || w >= 1.0)
+            v = 0.0;
+         else
+            v = 0.42 + 0.5 * cos(PI * w) + 0.08 * cos(2.0 * PI * w);
+         if (0.0 != x)
+            v *= sin(PI * APU_BLIP_CUTOFF * x) / (PI * x);
+         else
+            v *= APU_BLIP_CUTOFF;
+
+         blip_kernel[phase][i] = (int16) floor(v * (1 << APU_BLIP_KERNEL_BITS) + 0.5);
+         total += blip_kernel[phase][i];
+         if (blip_kernel[phase][i] > blip_kernel[phase][peak])
+            peak = i;
+      }
+      blip_kernel[phase][peak] += (1 << APU_BLIP_KERNEL_BITS) - total;
+   }
+}
+
+/* the frame counters count quarter frames (240Hz) */
+static void apu_build_luts(void)
 {
    int i;
 
    /* lut used for enveloping and frequency sweeps */
    for (i = 0; i < 16; i++)
-      decay_lut[i] = num_samples * (i + 1);
+      decay_lut[i] = i + 1;
 
-   /* used for note length, based on vblanks and size of audio buffer */
+   /* used for note length, counted on half frames */
    for (i = 0; i < 32; i++)
-      vbl_lut[i] = vbl_length[i] * num_samples;
+      vbl_lut[i] = vbl_length[i] * 2;
 
    /* triangle wave channel's linear length table */
    for (i = 0; i < 128; i++)
-      trilength_lut[i] = (int) (0.25 * i * num_samples);
+      trilength_lut[i] = i;
 
-#ifndef REALTIME_NOISE
-   /* generate noise samples */
-   shift_register15(noise_long_lut, APU_NOISE_32K);
-   shift_register15(noise_short_lut, APU_NOISE_93);
-#endif /* !REALTIME_NOISE */
+   apu_build_kernel();
 }
 
 void apu_setparams(double base_freq, int sample_rate, int refresh_rate, int sample_bits)
@@ -982,8 +970,13 @@ void apu_setparams(double base_freq, int sample_rate, int refresh_rate, int samp
       apu_.base_freq = base_freq;
    apu_.cycle_rate = (float) (apu_.base_freq / sample_rate);
 
+   /* output samples per cpu clock, and per quarter frame */
+   apu_.clock_step = (uint32) (sample_rate * (double) (1 << APU_BLIP_FRAC) / apu_.base_freq + 0.5);
+   apu_.seq_period = (uint32) (sample_rate * (double) (1 << APU_BLIP_FRAC) / (refresh_rate * 4));
+   apu_.seq_time = apu_.seq_period;
+
    /* build various lookup tables for apu */
-   apu_build_luts(apu_.num_samples);
+   apu_build_luts();
 
    apu_reset();
 }
@@ -1003,6 +996,8 @@ int apu_create(double base_freq, int sample_rate, int refresh_rate, int sample_b
    apu_.irq_callback = NULL;
    apu_.irqclear_callback = NULL;
 
+   apu_.noise.shift_reg = 0x4000;
+
    apu_setparams(base_freq, sample_rate, refresh_rate, sample_bits);
 
    for (channel = 0; channel < 6; channel++)
@@ -25,9 +25,6 @@
 */
 #include "nes_std.h"
 
-/* define this for realtime generated noise */
-#define  REALTIME_NOISE
-
 #define  APU_WRA0       0x4000
 #define  APU_WRA1       0x4001
 #define  APU_WRA2       0x4002
@@ -49,16 +46,21 @@
 
 #define  APU_SMASK      0x4015
 
-/* length of generated noise */
-#define  APU_NOISE_32K  0x7FFF
-#define  APU_NOISE_93   93
-
 #define  APU_BASEFREQ   1789772.7272727272727272
 
+/* band-limited step buffer: kernel width and the most
+** samples apu_process() synthesizes in one pass
+*/
+#define  APU_BLIP_TAPS  16
+#define  APU_BLIP_BLOCK 1024
+
 
 /* channel structures */
 /* As much data as possible is precalculated,
-** to keep the sample processing as lean as possible
+** to keep the sample processing as lean as possible.
+** timer is the time of the next waveform step and level the
+** amount the channel currently adds to the mix, both kept
+** for the band-limited step buffer (see nes_apu.c)
 */
  
 typedef struct rectangle_s
@@ -67,9 +69,9 @@ typedef struct rectangle_s
 
    bool enabled;
    
-   float accum;
+   uint32_t timer;
    int32_t freq;
-   int32_t output_vol;
+   int32_t level;
    bool fixed_envelope;
    bool holdnote;
    uint8_t volume;
@@ -98,9 +100,9 @@ typedef struct triangle_s
 
    bool enabled;
 
-   float accum;
+   uint32_t timer;
    int32_t freq;
-   int32_t output_vol;
+   int32_t level;
 
    uint8_t adder;
 
@@ -120,9 +122,9 @@ typedef struct noise_s
 
    bool enabled;
 
-   float accum;
+   uint32_t timer;
    int32_t freq;
-   int32_t output_vol;
+   int32_t level;
 
    int32_t env_phase;
    int32_t env_delay;
@@ -134,12 +136,9 @@ typedef struct noise_s
 
    int vbl_length;
 
-#ifdef REALTIME_NOISE
    uint8_t xor_tap;
-#else
-   bool short_sample;
-   int cur_pos;
-#endif /* REALTIME_NOISE */
+   int shift_reg;
+   bool output_bit;
 } noise_t;
 
 typedef struct dmc_s
@@ -149,9 +148,9 @@ typedef struct dmc_s
    /* bodge for timestamp queue */
    bool enabled;
    
-   float accum;
+   uint32_t timer;
    int32_t freq;
-   int32_t output_vol;
+   int32_t level;
 
    uint32_t address;
    uint32_t cached_addr;
@@ -213,6 +212,16 @@ typedef struct apu_s
    double base_freq;
    float cycle_rate;
 
+   /* band-limited step buffer, times in 12.20 fixed point samples */
+   uint32_t clock_step;
+   uint32_t seq_period;
+   uint32_t seq_time;
+   int seq_step;
+   int32_t blip_sum;
+   int32_t blip_dc;
+   int32_t prev_sample;
+   int32_t blip_buf[APU_BLIP_BLOCK + APU_BLIP_TAPS];
+
    int sample_rate;
    int sample_bits;
    int refresh_rate;
@@ -0,0 +1,485 @@
+//=====================================================================//
+/*!	@file
+	@brief	NES エミュレーター・ヘッドレス・ハーネス @n
+			ホスト用、画面・サウンド無しで NES コアを動かし、@n
+			フレーム毎の画像 CRC、オーディオ・ハッシュ、処理時間の内訳 @n
+			（CPU、PPU BG/OAM、APU）を出力する。@n
+			ゴールデン・トレースとの比較で、最適化の回帰を確認できる。@n
+			スナップショット・リング（巻き戻し）のサイズ、時間も計測できる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "emu/log.h"
+#include "emu/nes/nes.h"
+#include "emu/nes/nesinput.h"
+#include "emu/nes/nessnap.h"
+#include "emu/nes/nes_prof.h"
+
+namespace {
+
+	typedef std::chrono::steady_clock CLOCK;
+
+	CLOCK::time_point	prof_t0_[NES_PROF_NUM];
+	double				prof_acc_[NES_PROF_NUM];
+
+	bool	verbose_ = false;
+
+	//  スクリプト入力（指定フレームから、次の指定までパッドの状態を保持）
+	struct input_t {
+		uint32_t	frame;
+		int			pad[2];
+	};
+
+
+	void help_(const char* cmd)
+	{
+		printf("NES emulator headless harness\n");
+		printf("Usage: %s [options] rom.nes\n", cmd);
+		printf("    -n FRAMES   number of frames to run (default: 600)\n");
+		printf("    -i FILE     input script\n");
+		printf("    -o FILE     write trace (frame, video CRC, audio CRC)\n");
+		printf("    -g FILE     compare with golden trace\n");
+		printf("    -p          print frame time profile\n");
+		printf("    -c FILE     write per frame profile (CSV, ms)\n");
+		printf("    -r RATE     audio sample rate (default: 22050)\n");
+		printf("    -s KB       snapshot every frame into a KB bytes ring\n");
+		printf("    -k N        snapshot keyframe interval (default: 30)\n");
+		printf("    -w FRAMES   rewind FRAMES at the end and check the replay (needs -s)\n");
+		printf("    -v          print emulator log\n");
+		printf("Input script: '<frame> <pad1> [<pad2>]' per line, pad is '-' (none),\n");
+		printf("  buttons joined with '+' (A, B, SELECT, START, UP, DOWN, LEFT, RIGHT)\n");
+		printf("  or a hex value (0x..), '#' starts a comment.\n");
+	}
+
+
+	uint32_t crc32_(uint32_t crc, const void* src, size_t len)
+	{
+		static uint32_t table[256];
+		if(table[1] == 0) {
+			for(uint32_t i = 0; i < 256; ++i) {
+				uint32_t c = i;
+				for(int j = 0; j < 8; ++j) {
+					c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+				}
+				table[i] = c;
+			}
+		}
+		const uint8_t* p = static_cast<const uint8_t*>(src);
+		crc = ~crc;
+		while(len > 0) {
+			crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+			--len;
+		}
+		return ~crc;
+	}
+
+
+	bool parse_pad_(const char* text, int& pad)
+	{
+		static const struct {
+			const char*	name;
+			int			bit;
+		} buttons[] = {
+			{ "A",      INP_PAD_A },
+			{ "B",      INP_PAD_B },
+			{ "SELECT", INP_PAD_SELECT },
+			{ "START",  INP_PAD_START },
+			{ "UP",     INP_PAD_UP },
+			{ "DOWN",   INP_PAD_DOWN },
+			{ "LEFT",   INP_PAD_LEFT },
+			{ "RIGHT",  INP_PAD_RIGHT },
+		};
+
+		pad = 0;
+		if(strcmp(text, "-") == 0) return true;
+		if(text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+			char* end;
+			pad = strtol(text, &end, 16);
+			return *end == 0;
+		}
+		const char* p = text;
+		while(*p != 0) {
+			const char* q = strchr(p, '+');
+			size_t len = q != nullptr ? static_cast<size_t>(q - p) : strlen(p);
+			bool ok = false;
+			for(const auto& b : buttons) {
+				if(strlen(b.name) == len && strncasecmp(b.name, p, len) == 0) {
+					pad |= b.bit;
+					ok = true;
+					break;
+				}
+			}
+			if(!ok) return false;
+			p += len;
+			if(*p == '+') ++p;
+		}
+		return true;
+	}
+
+
+	bool load_script_(const char* file, std::vector<input_t>& script)
+	{
+		FILE* fp = fopen(file, "rb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't open input script: '%s'\n", file);
+			return false;
+		}
+		char line[256];
+		uint32_t lno = 0;
+		bool ret = true;
+		while(fgets(line, sizeof(line), fp) != nullptr) {
+			++lno;
+			char* p = strchr(line, '#');
+			if(p != nullptr) *p = 0;
+			char pad[2][64];
+			input_t t;
+			int n = sscanf(line, "%u %63s %63s", &t.frame, pad[0], pad[1]);
+			if(n <= 0) continue;
+			t.pad[0] = 0;
+			t.pad[1] = 0;
+			if(n < 2 || !parse_pad_(pad[0], t.pad[0]) || (n >= 3 && !parse_pad_(pad[1], t.pad[1]))) {
+				fprintf(stderr, "Input script error: '%s' (%u)\n", file, lno);
+				ret = false;
+				break;
+			}
+			if(!script.empty() && script.back().frame > t.frame) {
+				fprintf(stderr, "Input script frames must be in order: '%s' (%u)\n", file, lno);
+				ret = false;
+				break;
+			}
+			script.push_back(t);
+		}
+		fclose(fp);
+		return ret;
+	}
+
+
+	// フレームのパッド状態（巻き戻し後の再実行用）
+	void pad_at_(const std::vector<input_t>& script, uint32_t frame, int pad[2])
+	{
+		pad[0] = 0;
+		pad[1] = 0;
+		for(const auto& t : script) {
+			if(t.frame > frame) break;
+			pad[0] = t.pad[0];
+			pad[1] = t.pad[1];
+		}
+	}
+
+
+	struct trace_t {
+		uint32_t	frame;
+		uint32_t	video;
+		uint32_t	audio;
+	};
+
+
+	bool load_trace_(const char* file, std::vector<trace_t>& trace)
+	{
+		FILE* fp = fopen(file, "rb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't open golden trace: '%s'\n", file);
+			return false;
+		}
+		char line[256];
+		while(fgets(line, sizeof(line), fp) != nullptr) {
+			trace_t t;
+			if(sscanf(line, "%u %x %x", &t.frame, &t.video, &t.audio) == 3) {
+				trace.push_back(t);
+			}
+		}
+		fclose(fp);
+		return true;
+	}
+
+
+	double ms_(CLOCK::duration d)
+	{
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+}
+
+
+extern "C" {
+
+	// NES コアからのログ出力
+	int emu_log(const char* text)
+	{
+		if(verbose_) {
+			fputs(text, stdout);
+		}
+		return 0;
+	}
+
+
+	void nes_prof_begin(int id)
+	{
+		prof_t0_[id] = CLOCK::now();
+	}
+
+
+	void nes_prof_end(int id)
+	{
+		prof_acc_[id] += ms_(CLOCK::now() - prof_t0_[id]);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames = 600;
+	int rate = 22050;
+	bool profile = false;
+	const char* rom = nullptr;
+	const char* script_file = nullptr;
+	const char* trace_file = nullptr;
+	const char* golden_file = nullptr;
+	const char* csv_file = nullptr;
+	uint32_t snap_kb = 0;
+	int snap_key = 30;
+	uint32_t rewind = 0;
+	for(int i = 1; i < argc; ++i) {
+		const char* p = argv[i];
+		if(strcmp(p, "-n") == 0 && (i + 1) < argc) {
+			frames = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(p, "-i") == 0 && (i + 1) < argc) {
+			script_file = argv[++i];
+		} else if(strcmp(p, "-o") == 0 && (i + 1) < argc) {
+			trace_file = argv[++i];
+		} else if(strcmp(p, "-g") == 0 && (i + 1) < argc) {
+			golden_file = argv[++i];
+		} else if(strcmp(p, "-c") == 0 && (i + 1) < argc) {
+			csv_file = argv[++i];
+		} else if(strcmp(p, "-r") == 0 && (i + 1) < argc) {
+			rate = atoi(argv[++i]);
+		} else if(strcmp(p, "-s") == 0 && (i + 1) < argc) {
+			snap_kb = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(p, "-k") == 0 && (i + 1) < argc) {
+			snap_key = atoi(argv[++i]);
+		} else if(strcmp(p, "-w") == 0 && (i + 1) < argc) {
+			rewind = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(p, "-p") == 0) {
+			profile = true;
+		} else if(strcmp(p, "-v") == 0) {
+			verbose_ = true;
+		} else if(p[0] == '-') {
+			help_(argv[0]);
+			return 1;
+		} else {
+			rom = p;
+		}
+	}
+	if(rom == nullptr || rate <= 0 || (rewind > 0 && snap_kb == 0)) {
+		help_(argv[0]);
+		return 1;
+	}
+
+	std::vector<input_t> script;
+	if(script_file != nullptr && !load_script_(script_file, script)) {
+		return 1;
+	}
+	std::vector<trace_t> golden;
+	if(golden_file != nullptr && !load_trace_(golden_file, golden)) {
+		return 1;
+	}
+
+	// RAM の初期化に rand() が使われるので、トレースの再現性の為に固定する
+	srand(0);
+
+	log_init();
+	if(nes_create(rate, 16) != 0) {
+		fprintf(stderr, "Can't create NES\n");
+		return 1;
+	}
+	nesinput_t inp[2];
+	inp[0].type = INP_JOYPAD0;
+	inp[0].data = 0;
+	input_register(&inp[0]);
+	inp[1].type = INP_JOYPAD1;
+	inp[1].data = 0;
+	input_register(&inp[1]);
+
+	if(nes_insert_cart(rom) != 0) {
+		fprintf(stderr, "Can't load ROM: '%s'\n", rom);
+		return 1;
+	}
+
+	FILE* trace_fp = nullptr;
+	if(trace_file != nullptr) {
+		trace_fp = fopen(trace_file, "wb");
+		if(trace_fp == nullptr) {
+			fprintf(stderr, "Can't create trace: '%s'\n", trace_file);
+			return 1;
+		}
+	}
+	FILE* csv_fp = nullptr;
+	if(csv_file != nullptr) {
+		csv_fp = fopen(csv_file, "wb");
+		if(csv_fp == nullptr) {
+			fprintf(stderr, "Can't create profile: '%s'\n", csv_file);
+			return 1;
+		}
+		fprintf(csv_fp, "frame,total,cpu,ppu_bg,ppu_oam,apu,other\n");
+	}
+
+	std::vector<uint8_t> snap_mem(snap_kb * 1024);
+	if(snap_kb > 0) {
+		snap_init(&snap_mem[0], snap_mem.size(), snap_key);
+	}
+	double snap_sum = 0.0;
+	double snap_max = 0.0;
+	std::vector<trace_t> result;
+
+	// nesemu::service と同じ順番で、オーディオ生成とフレームの実行を行う
+	const uint32_t audio_len = (rate / 60) + 1;
+	std::vector<uint16_t> audio(audio_len);
+	const bitmap_t* vid = nes_getcontext()->vidbuf;
+
+	double sum[NES_PROF_NUM] = { 0 };
+	double sum_total = 0.0;
+	double max_total = 0.0;
+	uint32_t errors = 0;
+	uint32_t pos = 0;
+	for(uint32_t frame = 0; frame < frames; ++frame) {
+		while(pos < script.size() && script[pos].frame <= frame) {
+			inp[0].data = script[pos].pad[0];
+			inp[1].data = script[pos].pad[1];
+			++pos;
+		}
+
+		for(int i = 0; i < NES_PROF_NUM; ++i) prof_acc_[i] = 0.0;
+		auto t0 = CLOCK::now();
+		NES_PROF_BEGIN(NES_PROF_APU);
+		apu_process(&audio[0], audio_len);
+		NES_PROF_END(NES_PROF_APU);
+		nes_emulate(1);
+		double total = ms_(CLOCK::now() - t0);
+
+		uint32_t vcrc = 0;
+		for(int y = 0; y < vid->height; ++y) {
+			vcrc = crc32_(vcrc, vid->data + vid->pitch * y, vid->width);
+		}
+		uint32_t acrc = crc32_(0, &audio[0], audio_len * sizeof(uint16_t));
+
+		if(snap_kb > 0) {
+			auto s0 = CLOCK::now();
+			snap_push();
+			double t = ms_(CLOCK::now() - s0);
+			snap_sum += t;
+			if(snap_max < t) snap_max = t;
+			result.push_back({ frame, vcrc, acrc });
+		}
+
+		if(trace_fp != nullptr) {
+			fprintf(trace_fp, "%06u %08X %08X\n", frame, vcrc, acrc);
+		}
+		if(frame < golden.size()) {
+			const auto& g = golden[frame];
+			if(g.frame != frame || g.video != vcrc || g.audio != acrc) {
+				if(errors < 10) {
+					printf("Mismatch frame %u: video %08X/%08X, audio %08X/%08X (result/golden)\n",
+						frame, vcrc, g.video, acrc, g.audio);
+				}
+				++errors;
+			}
+		}
+
+		double other = total;
+		for(int i = 0; i < NES_PROF_NUM; ++i) {
+			sum[i] += prof_acc_[i];
+			other -= prof_acc_[i];
+		}
+		sum_total += total;
+		if(max_total < total) max_total = total;
+		if(csv_fp != nullptr) {
+			fprintf(csv_fp, "%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", frame, total,
+				prof_acc_[NES_PROF_CPU], prof_acc_[NES_PROF_PPU_BG],
+				prof_acc_[NES_PROF_PPU_OAM], prof_acc_[NES_PROF_APU], other);
+		}
+	}
+
+	if(trace_fp != nullptr) fclose(trace_fp);
+	if(csv_fp != nullptr) fclose(csv_fp);
+
+	// ※バッテリー・バックアップ RAM を書き出さないように、カートリッジは取り出さない
+
+	if(profile && frames > 0) {
+		double other = sum_total;
+		for(int i = 0; i < NES_PROF_NUM; ++i) other -= sum[i];
+		printf("Frames: %u, %.4f ms/frame (max %.4f ms)\n", frames, sum_total / frames, max_total);
+		printf("  CPU     : %8.4f ms/frame\n", sum[NES_PROF_CPU] / frames);
+		printf("  PPU BG  : %8.4f ms/frame\n", sum[NES_PROF_PPU_BG] / frames);
+		printf("  PPU OAM : %8.4f ms/frame\n", sum[NES_PROF_PPU_OAM] / frames);
+		printf("  APU     : %8.4f ms/frame\n", sum[NES_PROF_APU] / frames);
+		printf("  Other   : %8.4f ms/frame\n", other / frames);
+	}
+
+	if(snap_kb > 0 && frames > 0) {
+		snap_info_t info;
+		snap_getinfo(&info);
+		printf("Snapshot: %u bytes raw, ring %u/%u bytes, %d snapshots (%d keys)\n",
+			info.raw_size, info.used, info.ring_size, info.count, info.keys);
+		if(info.key_count > 0) {
+			printf("  Key     : %8u bytes/snapshot (%u)\n", info.key_bytes / info.key_count, info.key_count);
+		}
+		if(info.delta_count > 0) {
+			printf("  Delta   : %8u bytes/snapshot (%u)\n", info.delta_bytes / info.delta_count, info.delta_count);
+		}
+		printf("  Capture : %8.2f us/frame (max %.2f us)\n", snap_sum * 1000.0 / frames, snap_max * 1000.0);
+	}
+
+	// 巻き戻して、同じ入力で再実行した結果を、最初の実行と比べる
+	if(rewind > 0) {
+		auto s0 = CLOCK::now();
+		if(rewind >= frames || snap_rewind(rewind) != 0) {
+			printf("Rewind %u frames: not available (%d snapshots)\n", rewind, snap_count());
+			return 1;
+		}
+		double restore = ms_(CLOCK::now() - s0);
+
+		uint32_t video_ok = 0;
+		uint32_t audio_ok = 0;
+		for(uint32_t frame = frames - rewind; frame < frames; ++frame) {
+			int pad[2];
+			pad_at_(script, frame, pad);
+			inp[0].data = pad[0];
+			inp[1].data = pad[1];
+			apu_process(&audio[0], audio_len);
+			nes_emulate(1);
+			uint32_t vcrc = 0;
+			for(int y = 0; y < vid->height; ++y) {
+				vcrc = crc32_(vcrc, vid->data + vid->pitch * y, vid->width);
+			}
+			uint32_t acrc = crc32_(0, &audio[0], audio_len * sizeof(uint16_t));
+			if(result[frame].video == vcrc) ++video_ok;
+			if(result[frame].audio == acrc) ++audio_ok;
+		}
+		printf("Rewind %u frames: restore %.2f us, replay video %u/%u, audio %u/%u match\n",
+			rewind, restore * 1000.0, video_ok, rewind, audio_ok, rewind);
+		if(video_ok != rewind) {
+			return 1;
+		}
+	}
+
+	if(golden_file != nullptr) {
+		if(golden.size() < frames) {
+			printf("Golden trace is shorter than the run: %u/%u frames\n",
+				static_cast<uint32_t>(golden.size()), frames);
+		}
+		if(errors > 0) {
+			printf("Golden trace mismatch: %u frames\n", errors);
+			return 1;
+		}
+		printf("Golden trace OK\n");
+	}
+
+	return 0;
+}
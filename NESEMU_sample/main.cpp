@@ -67,6 +67,9 @@ namespace {
 	typedef sound::sound_out<int16_t, 8192, 1024> SOUND_OUT;
 	static const int16_t ZERO_LEVEL = 0x8000;
 
+	// 巻き戻し用スナップショット・リングのサイズ
+	static const uint32_t REWIND_SIZE = 96 * 1024;
+
 	#define USE_DAC
 
 #elif defined(SIG_RX72N)
@@ -103,6 +106,9 @@ namespace {
 	typedef sound::sound_out<int16_t, 2048, 256> SOUND_OUT;
 	static const int16_t ZERO_LEVEL = 0x0000;
 
+	// 巻き戻し用スナップショット・リングのサイズ
+	static const uint32_t REWIND_SIZE = 256 * 1024;
+
 	#define USE_SSIE
 
 #endif
@@ -194,6 +200,7 @@ namespace {
 	time_t		rtc_time_ = 0;
 
 	NESEMU		nesemu_;
+	uint32_t	rewind_buf_[REWIND_SIZE / sizeof(uint32_t)];
 
 	typedef utils::command<256> CMD;
 	CMD			cmd_;
@@ -260,6 +267,28 @@ namespace {
 			if(!nesemu_.load_state(slot)) {
 				utils::format("Load state error: slot = %d\n") % slot;
 			}
+		} else if(cmd_.cmp_word(0, "rewind")) {
+			int frames = 60;
+			if(cmdn >= 2) {
+				char tmp[32];
+				cmd_.get_word(1, tmp, sizeof(tmp));
+				utils::input("%d", tmp) % frames;
+			}
+			if(!nesemu_.rewind(frames)) {
+				utils::format("Rewind error: %d frames (%d)\n") % frames % nesemu_.get_rewind_frames();
+			}
+		} else if(cmd_.cmp_word(0, "scale")) {
+			if(cmdn >= 2) {
+				if(cmd_.cmp_word(1, "normal")) {
+					nesemu_.set_scale(NESEMU::SCALE::NORMAL);
+				} else if(cmd_.cmp_word(1, "double")) {
+					nesemu_.set_scale(NESEMU::SCALE::DOUBLE);
+				} else if(cmd_.cmp_word(1, "aspect")) {
+					nesemu_.set_scale(NESEMU::SCALE::ASPECT);
+				} else {
+					utils::format("Scale mode error: '%s'\n") % cmd_.get_command();
+				}
+			}
 		} else if(cmd_.cmp_word(0, "info")) {
 			const char* str = nesemu_.get_info();
 			utils::format("%s\n") % str;
@@ -277,6 +306,8 @@ namespace {
 			utils::format("    reset           Reset NES Machine\n");
 			utils::format("    save [slot-no]  Save NES State (slot-no:0 to 9)\n");
 			utils::format("    load [slot-no]  Load NES State (slot-no:0 to 9)\n");
+			utils::format("    rewind [frames] Rewind Emulation (default: 60 frames)\n");
+			utils::format("    scale [mode]    Screen Scale (normal, double, aspect)\n");
 			utils::format("    info            Cartrige Infomations\n");
 			utils::format("    call-151        Goto Monitor\n");
 		} else {
@@ -456,6 +487,7 @@ int main(int argc, char** argv)
 	}
 
 	nesemu_.start();
+	nesemu_.enable_rewind(rewind_buf_, sizeof(rewind_buf_));
 
 	// メニューの設定
 	rootm_.clear();
@@ -0,0 +1,271 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	NES 画面スケーラー（RGB565 フレームバッファ転送）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace emu {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  NES 画面スケーラー・クラス @n
+				８ビット・インデックスのビットマップを、ルックアップ・テーブル @n
+				で RGB565 に変換して、フレームバッファへ転送する。@n
+				出力がフレームバッファに収まらない場合、ソースの中央を切り出す。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct nes_scaler {
+
+		//=================================================================//
+		/*!
+			@brief  スケーリング・モード
+		*/
+		//=================================================================//
+		enum class MODE : uint8_t {
+			NORMAL,		///< 1:1 センタリング
+			DOUBLE,		///< 整数２倍（ピクセル２倍、ライン・ダブリング）
+			ASPECT,		///< 縦は整数倍、横は 8:7 の固定小数点ストレッチ
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief  ソース情報
+		*/
+		//=================================================================//
+		struct source_t {
+			const uint8_t*	data;	///< 先頭ラインのアドレス
+			uint32_t		pitch;	///< ラインのバイト数
+			uint32_t		width;	///< 幅
+			uint32_t		height;	///< 高さ（ライン数）
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief  フレームバッファ情報
+		*/
+		//=================================================================//
+		struct frame_t {
+			uint16_t*		org;	///< 先頭アドレス
+			uint32_t		width;	///< 幅
+			uint32_t		height;	///< 高さ
+			uint32_t		pitch;	///< ラインのピクセル数
+		};
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  パレットから RGB565 のルックアップ・テーブルを作成 @n
+					※NES のピクセルは、上位２ビットが優先順位フラグなので、@n
+					６４色を４回繰り返す。
+			@param[in]	pal		パレット（６４色、r, g, b メンバーを持つ構造体）
+			@param[out]	lut		ルックアップ・テーブル（２５６エントリー）
+		*/
+		//-----------------------------------------------------------------//
+		template <class RGB>
+		static void build_lut(const RGB* pal, uint16_t* lut) noexcept
+		{
+			for(uint32_t i = 0; i < 64; ++i) {
+				uint16_t r = pal[i].r;
+				uint16_t g = pal[i].g;
+				uint16_t b = pal[i].b;
+				// R(5), G(6), B(5)
+				lut[i] = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+				lut[i+128+64] = lut[i+128] = lut[i+64] = lut[i];
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  フレームバッファをクリア
+			@param[in]	frm		フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		static void clear(const frame_t& frm) noexcept
+		{
+			uint16_t* dst = frm.org;
+			for(uint32_t h = 0; h < frm.height; ++h) {
+				memset(dst, 0, frm.width * sizeof(uint16_t));
+				dst += frm.pitch;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  1:1 転送
+			@param[in]	src		ソース
+			@param[in]	lut		ルックアップ・テーブル
+			@param[in]	frm		フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		static void blit_normal(const source_t& src, const uint16_t* lut, const frame_t& frm) noexcept
+		{
+			uint32_t w = src.width < frm.width ? src.width : frm.width;
+			uint32_t h = src.height < frm.height ? src.height : frm.height;
+			const uint8_t* s = src.data + ((src.height - h) / 2) * src.pitch + (src.width - w) / 2;
+			uint16_t* d = frm.org + ((frm.height - h) / 2) * frm.pitch + (frm.width - w) / 2;
+			for(uint32_t y = 0; y < h; ++y) {
+				const uint8_t* sp = s;
+				uint16_t* dp = d;
+				uint32_t n = w >> 3;
+				while(n > 0) {
+					dp[0] = lut[sp[0]]; dp[1] = lut[sp[1]];
+					dp[2] = lut[sp[2]]; dp[3] = lut[sp[3]];
+					dp[4] = lut[sp[4]]; dp[5] = lut[sp[5]];
+					dp[6] = lut[sp[6]]; dp[7] = lut[sp[7]];
+					dp += 8;
+					sp += 8;
+					--n;
+				}
+				for(n = w & 7; n > 0; --n) {
+					*dp++ = lut[*sp++];
+				}
+				s += src.pitch;
+				d += frm.pitch;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  整数２倍転送 @n
+					ピクセルは３２ビットで２ピクセル同時に書き込み、@n
+					２ライン目は、１ライン目のコピーで作成する。
+			@param[in]	src		ソース
+			@param[in]	lut		ルックアップ・テーブル
+			@param[in]	frm		フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		static void blit_double(const source_t& src, const uint16_t* lut, const frame_t& frm) noexcept
+		{
+			uint32_t w = src.width < (frm.width / 2) ? src.width : (frm.width / 2);
+			uint32_t h = src.height < (frm.height / 2) ? src.height : (frm.height / 2);
+			const uint8_t* s = src.data + ((src.height - h) / 2) * src.pitch + (src.width - w) / 2;
+			uint16_t* d = frm.org + ((frm.height - h * 2) / 2) * frm.pitch + ((frm.width - w * 2) / 2);
+			// ３２ビット書き込みが出来ない場合、開始位置を１ピクセルずらす
+			if((reinterpret_cast<uintptr_t>(d) & 3) != 0 && (frm.width - w * 2) > 0) {
+				++d;
+			}
+			bool align = (reinterpret_cast<uintptr_t>(d) & 3) == 0 && (frm.pitch & 1) == 0;
+			for(uint32_t y = 0; y < h; ++y) {
+				const uint8_t* sp = s;
+				if(align) {
+					uint32_t* dp = reinterpret_cast<uint32_t*>(d);
+					uint32_t n = w >> 2;
+					while(n > 0) {
+						uint32_t c;
+						c = lut[sp[0]]; dp[0] = c | (c << 16);
+						c = lut[sp[1]]; dp[1] = c | (c << 16);
+						c = lut[sp[2]]; dp[2] = c | (c << 16);
+						c = lut[sp[3]]; dp[3] = c | (c << 16);
+						dp += 4;
+						sp += 4;
+						--n;
+					}
+					for(n = w & 3; n > 0; --n) {
+						uint32_t c = lut[*sp++];
+						*dp++ = c | (c << 16);
+					}
+				} else {
+					uint16_t* dp = d;
+					for(uint32_t n = 0; n < w; ++n) {
+						uint16_t c = lut[*sp++];
+						dp[0] = c;
+						dp[1] = c;
+						dp += 2;
+					}
+				}
+				memcpy(d + frm.pitch, d, w * 2 * sizeof(uint16_t));
+				s += src.pitch;
+				d += frm.pitch * 2;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  アスペクト補正転送 @n
+					縦はフレームバッファに入る最大の整数倍（ライン・コピー）、@n
+					横は NES のピクセル比 8:7 で、16.16 固定小数点でストレッチする。
+			@param[in]	src		ソース
+			@param[in]	lut		ルックアップ・テーブル
+			@param[in]	frm		フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		static void blit_aspect(const source_t& src, const uint16_t* lut, const frame_t& frm) noexcept
+		{
+			uint32_t sy = frm.height / src.height;
+			if(sy == 0) sy = 1;
+			uint32_t h = src.height < (frm.height / sy) ? src.height : (frm.height / sy);
+			uint32_t w = src.width;
+			uint32_t ow = (w * sy * 8 + 6) / 7;
+			if(ow > frm.width) {
+				w = (frm.width * 7) / (sy * 8);
+				ow = (w * sy * 8) / 7;
+			}
+			if(ow == 0) return;
+
+			const uint8_t* s = src.data + ((src.height - h) / 2) * src.pitch + (src.width - w) / 2;
+			uint16_t* d = frm.org + ((frm.height - h * sy) / 2) * frm.pitch + ((frm.width - ow) / 2);
+			uint32_t step = (w << 16) / ow;
+			for(uint32_t y = 0; y < h; ++y) {
+				uint16_t* dp = d;
+				uint32_t pos = step >> 1;
+				uint32_t n = ow >> 2;
+				while(n > 0) {
+					dp[0] = lut[s[pos >> 16]]; pos += step;
+					dp[1] = lut[s[pos >> 16]]; pos += step;
+					dp[2] = lut[s[pos >> 16]]; pos += step;
+					dp[3] = lut[s[pos >> 16]]; pos += step;
+					dp += 4;
+					--n;
+				}
+				for(n = ow & 3; n > 0; --n) {
+					*dp++ = lut[s[pos >> 16]]; pos += step;
+				}
+				uint16_t* tmp = d;
+				for(uint32_t i = 1; i < sy; ++i) {
+					tmp += frm.pitch;
+					memcpy(tmp, d, ow * sizeof(uint16_t));
+				}
+				s += src.pitch;
+				d += frm.pitch * sy;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  転送
+			@param[in]	mode	スケーリング・モード
+			@param[in]	src		ソース
+			@param[in]	lut		ルックアップ・テーブル
+			@param[in]	frm		フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		static void blit(MODE mode, const source_t& src, const uint16_t* lut, const frame_t& frm) noexcept
+		{
+			switch(mode) {
+			case MODE::NORMAL:
+				blit_normal(src, lut, frm);
+				break;
+			case MODE::DOUBLE:
+				blit_double(src, lut, frm);
+				break;
+			case MODE::ASPECT:
+				blit_aspect(src, lut, frm);
+				break;
+			}
+		}
+	};
+}
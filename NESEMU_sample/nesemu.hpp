@@ -13,8 +13,10 @@
 #include "emu/nes/nes.h"
 #include "emu/nes/nesinput.h"
 #include "emu/nes/nesstate.h"
+#include "emu/nes/nessnap.h"
 #include "emu/nes/nes_pal.h"
 #include "emu/cpu/dis6502.hpp"
+#include "nes_scaler.hpp"
 
 #include "chip/FAMIPAD.hpp"
 
@@ -33,7 +35,10 @@ namespace emu {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <uint32_t AUDIO_SAMPLE_RATE>
 	class nesemu {
+	public:
+		typedef nes_scaler::MODE SCALE;
 
+	private:
 		static const int nes_width_  = 256;
 		static const int nes_height_ = 240;
         static const int sample_rate_ = AUDIO_SAMPLE_RATE;
@@ -50,6 +55,18 @@ namespace emu {
 
 		nesinput_t		inp_[2];
 
+		uint16_t		lut_[256];
+		bool			lut_update_;
+
+		SCALE			scale_;
+		bool			clear_;
+		bool			rewind_;
+
+		static void pal_change_(void* ctx, const rgb_t* pal)
+		{
+			static_cast<nesemu*>(ctx)->lut_update_ = true;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -58,7 +75,8 @@ namespace emu {
 		//-----------------------------------------------------------------//
 		nesemu() noexcept : audio_buf_{ 0 }, nesrom_(false),
 			disa_(nes6502_getbyte, nes6502_putbyte),
-			mon_val_{ 0 }
+			mon_val_{ 0 }, lut_{ 0 }, lut_update_(true),
+			scale_(SCALE::NORMAL), clear_(true), rewind_(false)
 		{ }
 
 
@@ -72,6 +90,7 @@ namespace emu {
 		bool start(bool audio_ena = true)
 		{
 			log_init();
+			pal_setchangefunc(pal_change_, this);
 			nes_create(sample_rate_, sample_bits_);
 
             inp_[0].type = INP_JOYPAD0;
@@ -97,6 +116,7 @@ namespace emu {
 			if(nes_insert_cart(filename) == 0) {
 				nesrom_ = true;
 			}
+			snap_reset();
 			return nesrom_;
 		}
 
@@ -162,15 +182,39 @@ namespace emu {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  スケーリング・モードの設定 @n
+					※次の「service」でフレームバッファ全体がクリアされる
+			@param[in]	scale	スケーリング・モード
+		*/
+		//-----------------------------------------------------------------//
+		void set_scale(SCALE scale) noexcept
+		{
+			scale_ = scale;
+			clear_ = true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  スケーリング・モードの取得
+			@return スケーリング・モード
+		*/
+		//-----------------------------------------------------------------//
+		SCALE get_scale() const noexcept { return scale_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  サービス
 			@param[in]	org		フレームバッファのアドレス
 			@param[in]	xs		フレームバッファのＸ幅
 			@param[in]	ys		フレームバッファのＹ幅
+			@param[in]	pitch	フレームバッファのラインのピクセル数（０なら「xs」）
 		*/
 		//-----------------------------------------------------------------//
-		void service(void* org, uint32_t xs, uint32_t ys)
+		void service(void* org, uint32_t xs, uint32_t ys, uint32_t pitch = 0)
 		{
 			auto nes = nes_getcontext();
 			bitmap_t* v = nes->vidbuf;
@@ -209,38 +253,33 @@ namespace emu {
 				}
 			}
 
-			uint16_t luttmp[256];
-			for(uint32_t i = 0; i < 64; ++i) {
-               	uint16_t r = lut[i].r;  // R
-				uint16_t g = lut[i].g;  // G
-				uint16_t b = lut[i].b;  // B
-				// R(5), G(6), B(5)
-				luttmp[i] = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
-				luttmp[i+128+64] = luttmp[i+128] = luttmp[i+64] = luttmp[i];
+			// パレットが変更された場合のみ、ルックアップ・テーブルを更新
+			if(lut_update_) {
+				lut_update_ = false;
+				nes_scaler::build_lut(lut, lut_);
 			}
-			uint16_t* dst = static_cast<uint16_t*>(org);
-			dst += ((ys - (nes_height_ - 16)) / 2) * xs;
-			const uint8_t* src = v->data;
-			src += v->pitch * 16;
-			for(int h = 0; h < (nes_height_ - 16); ++h) {
-				uint16_t* tmp = dst;
-				tmp += (xs - nes_width_) / 2;
-				for(int w = 0; w < nes_width_ / 16; ++w) {
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-					*tmp++ = luttmp[*src++]; *tmp++ = luttmp[*src++];
-				}
-				src += v->pitch - nes_width_;
-				dst += xs;
+
+			nes_scaler::frame_t frm;
+			frm.org = static_cast<uint16_t*>(org);
+			frm.width = xs;
+			frm.height = ys;
+			frm.pitch = pitch != 0 ? pitch : xs;
+			if(clear_) {
+				clear_ = false;
+				nes_scaler::clear(frm);
 			}
+			nes_scaler::source_t src;
+			src.data = v->data + v->pitch * 16;
+			src.pitch = v->pitch;
+			src.width = nes_width_;
+			src.height = nes_height_ - 16;
+			nes_scaler::blit(scale_, src, lut_, frm);
 			if(nesrom_) {
 				apu_process(audio_buf_, audio_len_);
 				nes_emulate(1);
+				if(rewind_ && !get_pause()) {
+					snap_push();
+				}
 			}
 		}
 
@@ -287,17 +326,61 @@ namespace emu {
 		bool load_state(int no) noexcept {
 			if(!nesrom_) return false;
 			state_setslot(no);
+			snap_reset();
 			return state_load() == 0;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  ハード・リセット
+			@brief  巻き戻しを有効にする @n
+					毎フレームのスナップショットを、リング・バッファに保存する
+			@param[in]	mem		リング・バッファ（４バイト境界）
+			@param[in]	size	リング・バッファのサイズ
+			@param[in]	key		キー・フレームの間隔
+		*/
+		//-----------------------------------------------------------------//
+		void enable_rewind(void* mem, uint32_t size, int key = 30) noexcept {
+			snap_init(mem, size, key);
+			rewind_ = mem != nullptr;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  巻き戻し可能なフレーム数を取得
+			@return 巻き戻し可能なフレーム数
+		*/
+		//-----------------------------------------------------------------//
+		int get_rewind_frames() const noexcept {
+			auto n = snap_count();
+			return n > 0 ? n - 1 : 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  巻き戻し @n
+					※オーディオ（APU 内部カウンター）は完全には戻らない
+			@param[in]	frames	巻き戻すフレーム数
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool rewind(int frames) noexcept {
+			if(!nesrom_ || !rewind_ || frames <= 0) return false;
+			return snap_rewind(frames) == 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ハード・リセット @n
+					※リセット前の状態には巻き戻さない
 		*/
 		//-----------------------------------------------------------------//
 		void reset() noexcept {
 			nes_reset(HARD_RESET);
+			snap_reset();
 		}
 
 
@@ -0,0 +1,114 @@
+//=====================================================================//
+/*!	@file
+	@brief	NES 画面スケーラー・ベンチマーク（ホスト用） @n
+			各スケーラーの１フレーム当たりの処理時間を計測する。@n
+			Usage: nes_scaler_bench [frames] [width height [pitch]]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "nes_scaler.hpp"
+
+namespace {
+
+	struct rgb_t {
+		int r, g, b;
+	};
+
+	typedef emu::nes_scaler::MODE MODE;
+
+	// NES のビットマップ（オーバードロー領域を含む）
+	static const uint32_t src_pitch_  = 256 + 16;
+	static const uint32_t src_height_ = 240;
+
+	volatile uint32_t sink_;
+
+	template <class FUNC>
+	double measure_(uint32_t frames, FUNC func)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		for(uint32_t i = 0; i < frames; ++i) {
+			func(i);
+		}
+		auto t1 = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(t1 - t0).count() / frames;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames = 2000;
+	uint32_t xs = 480;
+	uint32_t ys = 272;
+	uint32_t pitch = 0;
+	if(argc >= 2) frames = strtoul(argv[1], nullptr, 10);
+	if(argc >= 4) {
+		xs = strtoul(argv[2], nullptr, 10);
+		ys = strtoul(argv[3], nullptr, 10);
+	}
+	if(argc >= 5) pitch = strtoul(argv[4], nullptr, 10);
+	if(pitch < xs) pitch = xs;
+	if(frames == 0 || xs == 0 || ys == 0) {
+		fprintf(stderr, "Usage: %s [frames] [width height [pitch]]\n", argv[0]);
+		return 1;
+	}
+
+	rgb_t pal[64];
+	for(uint32_t i = 0; i < 64; ++i) {
+		pal[i].r = (i * 37) & 0xff;
+		pal[i].g = (i * 91) & 0xff;
+		pal[i].b = (i * 13) & 0xff;
+	}
+	std::vector<uint8_t> bmp(src_pitch_ * src_height_);
+	srand(1);
+	for(auto& p : bmp) p = rand();
+	std::vector<uint16_t> fb(pitch * ys);
+
+	emu::nes_scaler::source_t src;
+	src.data = &bmp[src_pitch_ * 16];
+	src.pitch = src_pitch_;
+	src.width = 256;
+	src.height = src_height_ - 16;
+
+	emu::nes_scaler::frame_t frm;
+	frm.org = &fb[0];
+	frm.width = xs;
+	frm.height = ys;
+	frm.pitch = pitch;
+
+	uint16_t lut[256];
+	emu::nes_scaler::build_lut(pal, lut);
+
+	printf("Frame buffer: %u x %u (pitch %u), %u frames\n", xs, ys, pitch, frames);
+
+	// 毎フレーム LUT を作り直す場合（従来の方式）
+	double t = measure_(frames, [&](uint32_t i) {
+		pal[i & 63].r ^= 1;
+		emu::nes_scaler::build_lut(pal, lut);
+		emu::nes_scaler::blit(MODE::NORMAL, src, lut, frm);
+		sink_ = fb[i % fb.size()];
+	});
+	printf("  NORMAL (LUT/frame): %8.4f ms/frame\n", t);
+
+	static const struct {
+		MODE		mode;
+		const char*	name;
+	} modes[] = {
+		{ MODE::NORMAL, "NORMAL" },
+		{ MODE::DOUBLE, "DOUBLE" },
+		{ MODE::ASPECT, "ASPECT" },
+	};
+	for(const auto& m : modes) {
+		t = measure_(frames, [&](uint32_t i) {
+			emu::nes_scaler::blit(m.mode, src, lut, frm);
+			sink_ = fb[i % fb.size()];
+		});
+		printf("  %-18s: %8.4f ms/frame\n", m.name, t);
+	}
+}
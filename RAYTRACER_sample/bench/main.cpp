@@ -0,0 +1,177 @@
+//=====================================================================//
+/*!	@file
+	@brief	レイトレーサー・ベンチマーク（ホスト用） @n
+			従来の「doRaytrace()」と、パケット・レイトレーサー（N = 2, 4, 8）を、@n
+			スレッド数、段階的描画の有無を変えて計測し、レイ／秒を表示する。@n
+			パケット・レイトレーサーの画像は、全ての構成で同じか検査する。@n
+			（従来の方式とは乱数が異なるので、平均の差を表示する）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "common/format.hpp"
+#include "RAYTRACER_sample/raytracer_packet.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const int WIDTH  = 320;
+	static const int HEIGHT = 240;
+
+	uint8_t		legacy_[WIDTH * HEIGHT * 3];
+
+	struct image_t {
+		uint8_t		rgb_[WIDTH * HEIGHT * 3];
+
+		void operator() (int x, int y, int w, int h, int r, int g, int b) noexcept
+		{
+			for(int j = y; j < (y + h); ++j) {
+				for(int i = x; i < (x + w); ++i) {
+					auto p = &rgb_[(j * WIDTH + i) * 3];
+					p[0] = r;
+					p[1] = g;
+					p[2] = b;
+				}
+			}
+		}
+	};
+
+	image_t		image_;
+	image_t		first_;
+
+
+	struct result_t {
+		double		usec_;
+		double		first_;		///< 最初のパスまでの時間
+		uint64_t	segs_;
+	};
+
+
+	template <uint32_t N>
+	result_t run_packet_(int rpp, bool prog, uint32_t threads)
+	{
+		raytracer::packet_tracer<N> pt;
+		pt.setup(rpp, WIDTH, HEIGHT, prog);
+		result_t res = { 0 };
+		auto t = bench_usec();
+		for(uint32_t pass = 0; pass < pt.get_passes(); ++pass) {
+			std::atomic<uint32_t> next(0);
+			std::atomic<uint64_t> segs(0);
+			auto job = [&]() {
+				uint64_t s = 0;
+				uint32_t tile;
+				while((tile = next.fetch_add(1)) < pt.get_tiles()) {
+					s += pt.render_tile(tile, pass, image_);
+				}
+				segs += s;
+			};
+			if(threads <= 1) {
+				job();
+			} else {
+				std::vector<std::thread> th;
+				for(uint32_t i = 0; i < threads; ++i) th.emplace_back(job);
+				for(auto& h : th) h.join();
+			}
+			res.segs_ += segs;
+			if(pass == 0) {
+				res.first_ = bench_usec() - t;
+				if(prog) first_ = image_;
+			}
+		}
+		res.usec_ = bench_usec() - t;
+		return res;
+	}
+
+
+	void print_(const char* name, int rpp, uint32_t threads, const result_t& r)
+	{
+		double rays = static_cast<double>(WIDTH * HEIGHT * rpp);
+		printf("%-22s rpp %d, thread %2u: %8.2f ms, first %7.2f ms, %6.2f Mray/s",
+			name, rpp, threads, r.usec_ / 1000.0, r.first_ / 1000.0, rays / r.usec_);
+		if(r.segs_ > 0) {
+			printf(" (%6.2f Mseg/s)", static_cast<double>(r.segs_) / r.usec_);
+		}
+		printf("\n");
+	}
+
+
+	double diff_(const uint8_t* a, const uint8_t* b) noexcept
+	{
+		uint64_t sum = 0;
+		for(uint32_t i = 0; i < (WIDTH * HEIGHT * 3); ++i) {
+			sum += std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i]));
+		}
+		return static_cast<double>(sum) / (WIDTH * HEIGHT * 3);
+	}
+}
+
+
+extern "C" {
+
+	void draw_pixel(int x, int y, int r, int g, int b)
+	{
+		auto p = &legacy_[(y * WIDTH + x) * 3];
+		p[0] = r;
+		p[1] = g;
+		p[2] = b;
+	}
+
+
+	void draw_text(int x, int y, const char* t)
+	{
+	}
+
+
+	uint32_t millis(void)
+	{
+		return static_cast<uint32_t>(bench_usec() / 1000.0);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t threads = std::thread::hardware_concurrency();
+	if(threads == 0) threads = 1;
+
+	bool ok = true;
+	for(int rpp = 1; rpp <= 4; rpp *= 4) {
+		result_t r = { 0 };
+		auto t = bench_usec();
+		doRaytrace(rpp, WIDTH, HEIGHT);
+		r.usec_ = bench_usec() - t;
+		r.first_ = r.usec_;
+		print_("doRaytrace (legacy)", rpp, 1, r);
+
+		r = run_packet_<4>(rpp, false, 1);
+		print_("packet N=4", rpp, 1, r);
+		std::vector<uint8_t> ref(image_.rgb_, image_.rgb_ + sizeof(image_.rgb_));
+
+		auto check = [&](const char* name, int rpp, uint32_t th, const result_t& r) {
+			print_(name, rpp, th, r);
+			if(std::memcmp(&ref[0], image_.rgb_, ref.size()) != 0) {
+				printf("  image differs from packet N=4\n");
+				ok = false;
+			}
+		};
+		check("packet N=2", rpp, 1, run_packet_<2>(rpp, false, 1));
+		check("packet N=8", rpp, 1, run_packet_<8>(rpp, false, 1));
+		check("packet N=8", rpp, threads, run_packet_<8>(rpp, false, threads));
+		check("packet N=8 progressive", rpp, 1, run_packet_<8>(rpp, true, 1));
+		check("packet N=8 progressive", rpp, threads, run_packet_<8>(rpp, true, threads));
+
+		printf("  legacy / packet mean abs diff: %.3f (0..255), first pass / final: %.3f\n",
+			diff_(legacy_, &ref[0]), diff_(first_.rgb_, &ref[0]));
+	}
+
+	printf("%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
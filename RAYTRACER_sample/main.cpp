@@ -23,6 +23,7 @@
 #include "chip/R61505.hpp"
 
 #include "raytracer.hpp"
+#include "raytracer_packet.hpp"
 
 namespace {
 
@@ -183,6 +184,16 @@ namespace {
 	int			render_width_  = 320;
 	int			render_height_ = 240;
 
+	enum class MODE : uint8_t {
+		LEGACY,		///< 従来の doRaytrace
+		PACKET,		///< パケット・レイトレーサー
+		PROG,		///< パケット・レイトレーサー（段階的描画）
+	};
+	MODE		mode_ = MODE::LEGACY;
+
+	typedef raytracer::packet_tracer<4> PACKET;
+	PACKET		packet_;
+
 	typedef utils::command<256> CMD;
 	CMD 		cmd_;
 
@@ -220,10 +231,22 @@ namespace {
 				render_height_ = LCD_Y;
 				run_ = false;
 				f = true;
+			} else if(cmd_.cmp_word(0, "legacy")) {
+				mode_ = MODE::LEGACY;
+				f = true;
+			} else if(cmd_.cmp_word(0, "packet")) {
+				mode_ = MODE::PACKET;
+				f = true;
+			} else if(cmd_.cmp_word(0, "prog")) {
+				mode_ = MODE::PROG;
+				f = true;
 			} else if(cmd_.cmp_word(0, "help")) {
 				utils::format("    clear     clear screen\n");
 				utils::format("    render    renderring 320x240\n");
 				utils::format("    full      renderring %ux%u\n") % LCD_X % LCD_Y;
+				utils::format("    legacy    select legacy tracer\n");
+				utils::format("    packet    select packet tracer (tile)\n");
+				utils::format("    prog      select packet tracer (progressive)\n");
 				f = true;
 			}
 			if(!f) {
@@ -237,6 +260,41 @@ namespace {
 }
 
 
+namespace {
+
+	struct packet_draw_t {
+		void operator() (int x, int y, int w, int h, int r, int g, int b) noexcept
+		{
+#ifdef USE_GLCDC
+			render_.set_fore_color(graphics::share_color(r, g, b));
+			render_.fill_box(vtx::srect(x, y, w, h));
+#else
+			tft_.fill_box(vtx::srect(x, y, w, h), graphics::share_color::to_565(r, g, b));
+#endif
+		}
+	};
+
+
+	void render_packet_()
+	{
+		packet_.setup(sampling_, render_width_, render_height_, mode_ == MODE::PROG);
+		packet_draw_t draw;
+		auto t = millis();
+		packet_.render(draw);
+		auto tm = millis() - t;
+		if(tm == 0) tm = 1;
+		{
+			char buf[50];
+			utils::sformat("%dms (%d)", buf, sizeof(buf)) % tm % sampling_;
+			draw_text(8, 0, buf);
+		}
+		utils::format("Render time: %dms (%d), %u Kray/s (packet%s)\n")
+			% tm % sampling_ % (packet_.get_rays() / tm)
+			% (mode_ == MODE::PROG ? ", progressive" : "");
+	}
+}
+
+
 extern "C" {
 
 	void draw_pixel(int x, int y, int r, int g, int b)
@@ -381,7 +439,11 @@ int main(int argc, char** argv)
 		command_();
 
 		if(!run_) {
-			doRaytrace(sampling_, render_width_, render_height_);
+			if(mode_ == MODE::LEGACY) {
+				doRaytrace(sampling_, render_width_, render_height_);
+			} else {
+				render_packet_();
+			}
 			run_ = true;
 		}
 
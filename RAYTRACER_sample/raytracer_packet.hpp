@@ -0,0 +1,475 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	パケット・レイトレーサー @n
+			「raytracer.hpp」と同じシーンを、N 本（4、8）のレイをまとめた @n
+			パケット（SoA）でトレースする。@n
+			・カメラの基底は、最初に一度だけ計算する。@n
+			・交差判定は、分岐をレーン毎の選択にして、ホストでは SIMD 化される。@n
+			・画面はタイルに分け、タイル単位で描画する。（ホストではスレッドで分担出来る）@n
+			・粗い順（8x8、4x4、2x2、1x1）にパスを分けると、すぐに全体の画像が出る。@n
+			　（各パスは、前のパスでトレースしていないピクセルだけをトレースする）@n
+			乱数はピクセル毎に初期化するので、N、タイルの順番、スレッド数によらず、@n
+			同じ画像になる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "raytracer.hpp"
+
+namespace raytracer {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	GCC のベクトル型（ホストでは SSE/AVX、RX ではスカラーに展開される）@n
+				※テンプレート引数で大きさを決めると、添え字が使えないので特殊化する
+		@param[in]	N	要素数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N> struct simd_t;
+
+	template <> struct simd_t<2> {
+		typedef float	vfloat __attribute__((vector_size(8)));
+		typedef int32_t	vint   __attribute__((vector_size(8)));
+	};
+
+	template <> struct simd_t<4> {
+		typedef float	vfloat __attribute__((vector_size(16)));
+		typedef int32_t	vint   __attribute__((vector_size(16)));
+	};
+
+	template <> struct simd_t<8> {
+		typedef float	vfloat __attribute__((vector_size(32)));
+		typedef int32_t	vint   __attribute__((vector_size(32)));
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	パケット・レイトレーサー・クラス
+		@param[in]	N	パケットのレイ数（2、4、8）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N>
+	class packet_tracer {
+
+	public:
+		static const int TILE = 16;			///< タイルの大きさ
+		static const int STEP = 8;			///< 最初のパスのブロックの大きさ
+		static const uint32_t PASS_NUM = 4;	///< 段階的なパスの数（8、4、2、1）
+
+	private:
+		// 値が「raytracer.hpp」の SKY、FLOOR と重ならない様に、符号付きで持つ
+		static const int32_t HIT_SKY   = -1;
+		static const int32_t HIT_FLOOR = -2;
+
+		typedef typename simd_t<N>::vfloat vfloat;
+		typedef typename simd_t<N>::vint vint;
+
+		struct lanes_t {
+			vfloat	x;
+			vfloat	y;
+			vfloat	z;
+		};
+
+		// randomByte() と同じ生成器を、ピクセル毎に持つ
+		struct rng_t {
+			uint8_t	a, b, c, x;
+
+			void seed(uint32_t v) noexcept
+			{
+				v ^= v >> 16;
+				v *= 0x7feb352d;
+				v ^= v >> 15;
+				v *= 0x846ca68b;
+				v ^= v >> 16;
+				a = v;
+				b = v >> 8;
+				c = v >> 16;
+				x = v >> 24;
+			}
+
+			uint8_t get() noexcept
+			{
+				++x;
+				a = (a ^ c ^ x);
+				b = (b + a);
+				c = ((c + (b >> 1)) ^ a);
+				return c;
+			}
+
+			float rf() noexcept { return static_cast<float>(static_cast<char>(get())) / 256.0f; }
+		};
+
+		int		dw_;
+		int		dh_;
+		int		rpp_;
+		bool	progressive_;
+		int		tiles_x_;
+		int		tiles_y_;
+
+		float	pixel_;
+		vec3	dir_;
+		vec3	right_;
+		vec3	up_;
+		vec3	camera_;
+
+		static vfloat sqrt_(vfloat v) noexcept
+		{
+			for(uint32_t i = 0; i < N; ++i) {
+				v[i] = sqrtf_(v[i]);
+			}
+			return v;
+		}
+
+
+		static vfloat dot_(const lanes_t& a, const lanes_t& b) noexcept
+		{
+			return a.x * b.x + a.y * b.y + a.z * b.z;
+		}
+
+
+		static void normalize_(lanes_t& v) noexcept
+		{
+			vfloat l = 1.0f / sqrt_(dot_(v, v));
+			v.x *= l;
+			v.y *= l;
+			v.z *= l;
+		}
+
+
+		// trace() のパケット版（球の法線は正規化する）@n
+		// 空の距離を無限大にして、マテリアル番号も float で持ち、分岐は全て選択にする
+		static void trace_(const lanes_t& o, const lanes_t& d, vfloat& dist, lanes_t& n, vint& id) noexcept
+		{
+			const vfloat zero = { };
+			const vfloat far = zero + 1e30f;
+			vfloat t = -o.z / d.z;
+			vint f = t > 0.01f;
+			vfloat fid = f ? zero + static_cast<float>(HIT_FLOOR) : zero + static_cast<float>(HIT_SKY);
+			vfloat fd = f ? t : far;
+			n.x = zero;
+			n.y = zero;
+			n.z = zero + 1.0f;
+			for(uint32_t s = 0; s < NUM_SPHERES; ++s) {
+				const float* sp = spheres + (s * 5);
+				vfloat ox = o.x - sp[0];
+				vfloat oy = o.y - sp[1];
+				vfloat oz = o.z - sp[2];
+				vfloat b = d.x * ox + d.y * oy + d.z * oz;
+				vfloat c = (ox * ox + oy * oy + oz * oz) - sp[3] * sp[3];
+				vfloat e = b * b - c;
+				vint pos = e > 0.0f;
+				vfloat q = sqrt_(pos ? e : zero);
+				vfloat ts = pos ? (-b - q) : zero - 1.0f;
+				vint h = (ts > 0.01f) & (ts < fd);
+				fd  = h ? ts : fd;
+				fid = h ? zero + sp[4] : fid;
+				n.x = h ? ox + d.x * ts : n.x;
+				n.y = h ? oy + d.y * ts : n.y;
+				n.z = h ? oz + d.z * ts : n.z;
+			}
+			id = __builtin_convertvector(fid, vint);
+			dist = (id == HIT_SKY) ? zero : fd;
+			// 床、空の法線 (0, 0, 1) は、正規化しても変わらない
+			normalize_(n);
+		}
+
+
+		// シャドウ・レイ（何かに当たるか？だけを調べる）
+		static vint occluded_(const lanes_t& o, const lanes_t& d) noexcept
+		{
+			const vfloat zero = { };
+			vint hit = (-o.z / d.z) > 0.01f;
+			for(uint32_t s = 0; s < NUM_SPHERES; ++s) {
+				const float* sp = spheres + (s * 5);
+				vfloat ox = o.x - sp[0];
+				vfloat oy = o.y - sp[1];
+				vfloat oz = o.z - sp[2];
+				vfloat b = d.x * ox + d.y * oy + d.z * oz;
+				vfloat c = (ox * ox + oy * oy + oz * oz) - sp[3] * sp[3];
+				vfloat e = b * b - c;
+				vint pos = e > 0.0f;
+				vfloat q = sqrt_(pos ? e : zero);
+				hit |= pos & ((-b - q) > 0.01f);
+			}
+			return hit;
+		}
+
+
+		// sample() のパケット版、反射率を返し、o、d を反射レイにする @n
+		// 乱数は、反射が終わったレーン（act が 0）では進めない（N によらず同じ画像にする為）
+		static void sample_(lanes_t& o, lanes_t& d, lanes_t& col, vfloat& refl, rng_t* rng, const vfloat& act) noexcept
+		{
+			const vfloat zero = { };
+			vfloat dist;
+			vint id;
+			lanes_t n;
+			trace_(o, d, dist, n, id);
+
+			lanes_t half;
+			{
+				vfloat s = dot_(n, d) * -2.0f;
+				half.x = d.x + n.x * s;
+				half.y = d.y + n.y * s;
+				half.z = d.z + n.z * s;
+			}
+			normalize_(half);
+
+			vfloat sky = 1.0f - d.z;
+			sky *= sky;
+			sky *= sky;
+			o.x += d.x * dist;
+			o.y += d.y * dist;
+			o.z += d.z * dist;
+
+			// ライトへのベクトル（ソフト・シャドウの揺らぎは、レーン毎の乱数）
+			lanes_t l;
+			for(uint32_t i = 0; i < N; ++i) {
+				float sx = 0.0f;
+				float sy = 0.0f;
+				if(act[i] > 0.0f) {
+					sx = rng[i].rf() * shadowRegion;
+					sy = rng[i].rf() * shadowRegion;
+				}
+				l.x[i] = 9.0f + sx;
+				l.y[i] = 6.0f + sy;
+			}
+			l.x -= o.x;
+			l.y -= o.y;
+			l.z = 16.0f - o.z;
+			normalize_(l);
+
+			vfloat lam = dot_(l, n);
+			// 全レーンが空、又は裏向きなら、シャドウ・レイは要らない
+			vint need = (act > 0.0f) & (id != HIT_SKY) & (lam >= 0.0f);
+			bool any = false;
+			for(uint32_t i = 0; i < N; ++i) any |= need[i] != 0;
+			vint shade = lam < 0.0f;
+			if(any) shade |= occluded_(o, l);
+			lam = shade ? zero : lam;
+
+			vfloat spec = dot_(l, half);
+			for(uint32_t i = 0; i < 5; ++i) spec *= spec;
+			spec = (lam > 0.0f) ? spec : lam;
+
+			for(uint32_t i = 0; i < N; ++i) {
+				if(id[i] == HIT_SKY) {
+					col.x[i] = 0.1f + 0.7f * sky[i];
+					col.y[i] = 0.0f + 0.2f * sky[i];
+					col.z[i] = 0.3f + 0.5f * sky[i];
+					refl[i] = 0.0f;
+				} else if(id[i] == HIT_FLOOR) {
+					float dk = (lam[i] * 0.2f) + 0.1f;
+					float lt = dk * 3.0f;
+					const float t = 1.0f / 5.0f;
+					bool dark = (((int)(ceilf_(o.x[i] * t) + ceilf_(o.y[i] * t))) & 1);
+					col.x[i] = lt;
+					col.y[i] = dark ? dk : lt;
+					col.z[i] = dark ? dk : lt;
+					refl[i] = 0.0f;
+				} else {
+					const float* mat = materials + (id[i] * 4);
+					float a = lam[i] * lam[i] + ambient;
+					col.x[i] = mat[0] * a + spec[i];
+					col.y[i] = mat[1] * a + spec[i];
+					col.z[i] = mat[2] * a + spec[i];
+					refl[i] = mat[3];
+					d.x[i] = half.x[i];
+					d.y[i] = half.y[i];
+					d.z[i] = half.z[i];
+				}
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		packet_tracer() noexcept : dw_(0), dh_(0), rpp_(1), progressive_(false),
+			tiles_x_(0), tiles_y_(0), pixel_(0.0f),
+			dir_(), right_(), up_(), camera_(cameraX, cameraY, cameraZ)
+		{ }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	設定（カメラの基底を計算）
+			@param[in]	rpp		ピクセル毎のレイ数
+			@param[in]	dw		横幅
+			@param[in]	dh		高さ
+			@param[in]	progressive	段階的に描画する場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		void setup(int rpp, int dw, int dh, bool progressive) noexcept
+		{
+			dw_ = dw;
+			dh_ = dh;
+			rpp_ = rpp;
+			progressive_ = progressive;
+			tiles_x_ = (dw + TILE - 1) / TILE;
+			tiles_y_ = (dh + TILE - 1) / TILE;
+
+			pixel_ = fov / float(dh / 2);
+			const vec3 target = vec3(targetX, targetY, targetZ);
+			dir_ = !(target - camera_);
+			right_ = !(dir_ ^ vec3(0.0f, 0.0f, 1.0f));
+			up_ = !(right_ ^ dir_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイルの数を取得
+			@return タイルの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_tiles() const noexcept { return tiles_x_ * tiles_y_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パスの数を取得
+			@return パスの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_passes() const noexcept { return progressive_ ? PASS_NUM : 1; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プライマリー・レイの数を取得
+			@return プライマリー・レイの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_rays() const noexcept { return dw_ * dh_ * rpp_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイルの描画 @n
+					別のタイルなら、別のスレッドから同時に呼べる
+			@param[in]	tile	タイル番号
+			@param[in]	pass	パス番号
+			@param[in]	draw	描画ファンクタ（x, y, w, h, r, g, b）
+			@return トレースした線分の数（プライマリー、シャドウ、反射）
+		*/
+		//-----------------------------------------------------------------//
+		template <class DRAW>
+		uint32_t render_tile(uint32_t tile, uint32_t pass, DRAW& draw) const noexcept
+		{
+			const int tx = (tile % tiles_x_) * TILE;
+			const int ty = (tile / tiles_x_) * TILE;
+			const int step = progressive_ ? (STEP >> pass) : 1;
+			const int prev = (progressive_ && pass > 0) ? step * 2 : 0;
+
+			// このパスでトレースするピクセル
+			int16_t px[TILE * TILE];
+			int16_t py[TILE * TILE];
+			uint32_t num = 0;
+			for(int y = ty; y < (ty + TILE) && y < dh_; y += step) {
+				for(int x = tx; x < (tx + TILE) && x < dw_; x += step) {
+					if(prev > 0 && (x % prev) == 0 && (y % prev) == 0) continue;
+					px[num] = x;
+					py[num] = y;
+					++num;
+				}
+			}
+
+			const int dw2 = dw_ / 2;
+			const int dh2 = dh_ / 2;
+			uint32_t segs = 0;
+			for(uint32_t top = 0; top < num; top += N) {
+				uint32_t act = (num - top) < N ? (num - top) : N;
+				rng_t rng[N];
+				int16_t lx[N];
+				int16_t ly[N];
+				for(uint32_t i = 0; i < N; ++i) {
+					// 足りないレーンは、最後のピクセルを繰り返す（描画しない）
+					auto j = top + (i < act ? i : act - 1);
+					lx[i] = px[j];
+					ly[i] = py[j];
+					rng[i].seed(static_cast<uint32_t>(ly[i]) * 65536 + lx[i]);
+				}
+
+				const vfloat zero = { };
+				lanes_t acc = { zero, zero, zero };
+				for(int p = 0; p < rpp_; ++p) {
+					lanes_t o = { zero + camera_.x, zero + camera_.y, zero + camera_.z };
+					lanes_t d;
+					for(uint32_t i = 0; i < N; ++i) {
+						auto xpos = static_cast<float>(lx[i] - dw2);
+						auto ypos = static_cast<float>(dh2 - ly[i]);
+						if(rpp_ > 1) { xpos += rng[i].rf(); ypos += rng[i].rf(); }
+						d.x[i] = xpos;
+						d.y[i] = ypos;
+					}
+					{
+						vfloat xp = d.x;
+						vfloat yp = d.y;
+						d.x = dir_.x + ((right_.x * xp) + (up_.x * yp)) * pixel_;
+						d.y = dir_.y + ((right_.y * xp) + (up_.y * yp)) * pixel_;
+						d.z = dir_.z + ((right_.z * xp) + (up_.z * yp)) * pixel_;
+					}
+					normalize_(d);
+
+					// 反射は３段まで（反射率が 0 になったレーンは加算しない）
+					vfloat w = zero + 1.0f;
+					for(uint32_t b = 0; b < 3; ++b) {
+						for(uint32_t i = 0; i < act; ++i) {
+							if(w[i] > 0.0f) segs += 2;
+						}
+						lanes_t col;
+						vfloat refl;
+						sample_(o, d, col, refl, rng, w);
+						vint on = w > 0.0f;
+						acc.x += on ? col.x * w : zero;
+						acc.y += on ? col.y * w : zero;
+						acc.z += on ? col.z * w : zero;
+						w = (refl > 0.0f) ? w * refl : zero;
+						bool any = false;
+						for(uint32_t i = 0; i < N; ++i) any |= w[i] > 0.0f;
+						if(!any) break;
+					}
+				}
+
+				const float scale = 255.0f / static_cast<float>(rpp_);
+				for(uint32_t i = 0; i < act; ++i) {
+					int r = acc.x[i] * scale;  if(r > 255) { r = 255; }
+					int g = acc.y[i] * scale;  if(g > 255) { g = 255; }
+					int b = acc.z[i] * scale;  if(b > 255) { b = 255; }
+					int bw = step;
+					int bh = step;
+					if((lx[i] + bw) > dw_) bw = dw_ - lx[i];
+					if((ly[i] + bh) > dh_) bh = dh_ - ly[i];
+					draw(lx[i], ly[i], bw, bh, r, g, b);
+				}
+			}
+			return segs;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全体の描画（全パス、全タイルを順番に）
+			@param[in]	draw	描画ファンクタ（x, y, w, h, r, g, b）
+			@return トレースした線分の数
+		*/
+		//-----------------------------------------------------------------//
+		template <class DRAW>
+		uint32_t render(DRAW& draw) const noexcept
+		{
+			uint32_t segs = 0;
+			for(uint32_t pass = 0; pass < get_passes(); ++pass) {
+				for(uint32_t t = 0; t < get_tiles(); ++t) {
+					segs += render_tile(t, pass, draw);
+				}
+			}
+			return segs;
+		}
+	};
+}
@@ -175,11 +175,7 @@ int main(int argc, char** argv)
 
 		auto f = core_.nmea_.service();
 		if(f) {
-			utils::format("%s: ") % core_.nmea_.get_satellite();
-			utils::format("D/T: %s %s, ") % core_.nmea_.get_date() % core_.nmea_.get_time();
-			utils::format("Lat: %s, ") % core_.nmea_.get_lat();
-			utils::format("Lon: %s, ") % core_.nmea_.get_lon();
-			utils::format("Alt: %s [%s]\n") % core_.nmea_.get_altitude() % core_.nmea_.get_altitude_unit();
+			core_.nmea_.list_all();
 		};
 
 		core_.sdc_.service();
@@ -265,6 +265,16 @@ namespace device {
         const value_type* fb() const noexcept { return fb_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フレームバッファへの参照（ＣＰＵで直接描画する場合）@n
+					※D/AVE 2D の描画と混在させる場合、先に「flush()」する
+			@return フレームバッファ・アドレス
+		*/
+		//-----------------------------------------------------------------//
+		value_type* at_fb() noexcept { return fb_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	前面カラーの設定
@@ -0,0 +1,175 @@
+//=====================================================================//
+/*!	@file
+	@brief	i8080 ベンチマーク（ホスト用） @n
+			InvadersMachine（I8080T、ページ・マップ）を指定フレーム数動かし、@n
+			エミュレーション速度（MHz）と、ビデオ、サウンド出力のチェックサムを表示する。@n
+			ROM は添付していないので、指定が無い場合は、ビデオ RAM への書き込み、@n
+			サブルーチン、ポート、割り込みを使う小さなプログラムを動かす。@n
+			i8080_bench [invaders.rom（8K バイト）、「-」なら内蔵] [フレーム数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include "side/arcade.h"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t ROM_SIZE = 0x2000;
+	static const uint32_t FRAMES = 3000;	///< 既定のフレーム数（60 FPS で 50 秒）
+	static const uint32_t RUNS = 3;			///< 計測を繰り返して最小を取る
+
+	char	rom_[ROM_SIZE];
+
+
+	void put_(uint32_t org, std::initializer_list<uint8_t> code)
+	{
+		for(auto c : code) rom_[org++] = c;
+	}
+
+
+	void make_rom_()
+	{
+		memset(rom_, 0, sizeof(rom_));
+		put_(0x0000, {
+			0x31, 0x00, 0x24,	// LXI  SP,2400h
+			0xFB,				// EI
+			0xC3, 0x60, 0x00,	// JMP  0060h
+		});
+		put_(0x0008, { 0xC3, 0x40, 0x00 });	// RST 1: JMP 0040h
+		put_(0x0010, { 0xC3, 0x50, 0x00 });	// RST 2: JMP 0050h
+		// 割り込み：ワーク RAM の 2000h、2002h を数える
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t a = i * 2;
+			put_(0x0040 + i * 0x10, {
+				0xF5,				// PUSH PSW
+				0xE5,				// PUSH H
+				0x2A, a, 0x20,		// LHLD 20xxh
+				0x23,				// INX  H
+				0x22, a, 0x20,		// SHLD 20xxh
+				0xE1,				// POP  H
+				0xF1,				// POP  PSW
+				0xFB,				// EI
+				0xC9,				// RET
+			});
+		}
+		// メイン：ビデオ RAM を 1K バイト埋めて、ワーク RAM をサブルーチンで更新
+		put_(0x0060, {
+			0x21, 0x00, 0x24,	// LXI  H,2400h
+			0x01, 0x00, 0x04,	// LXI  B,0400h
+			0x3A, 0x00, 0x20,	// LDA  2000h
+			0x5F,				// MOV  E,A
+			0x7B,				// 006A: MOV  A,E
+			0x07,				// RLC
+			0xAD,				// XRA  L
+			0x77,				// MOV  M,A
+			0x23,				// INX  H
+			0x1C,				// INR  E
+			0x0B,				// DCX  B
+			0x78,				// MOV  A,B
+			0xB1,				// ORA  C
+			0xC2, 0x6A, 0x00,	// JNZ  006Ah
+			0x21, 0x10, 0x20,	// LXI  H,2010h
+			0x06, 0xF0,			// MVI  B,F0h
+			0xCD, 0xA0, 0x00,	// 007B: CALL 00A0h
+			0x05,				// DCR  B
+			0xC2, 0x7B, 0x00,	// JNZ  007Bh
+			0xC3, 0x60, 0x00,	// JMP  0060h
+		});
+		put_(0x00A0, {
+			0x7E,				// MOV  A,M
+			0x81,				// ADD  C
+			0x4F,				// MOV  C,A
+			0xD3, 0x04,			// OUT  4（シフト・レジスター）
+			0xDB, 0x03,			// IN   3
+			0x1F,				// RAR
+			0x77,				// MOV  M,A
+			0x23,				// INX  H
+			0xD5,				// PUSH D
+			0xEB,				// XCHG
+			0x29,				// DAD  H
+			0xEB,				// XCHG
+			0xD1,				// POP  D
+			0xC9,				// RET
+		});
+	}
+
+
+	bool load_rom_(const char* file)
+	{
+		auto fp = fopen(file, "rb");
+		if(fp == nullptr) {
+			printf("Can't open: '%s'\n", file);
+			return false;
+		}
+		memset(rom_, 0, sizeof(rom_));
+		auto n = fread(rom_, 1, sizeof(rom_), fp);
+		fclose(fp);
+		if(n != sizeof(rom_)) {
+			printf("ROM size error: %u bytes (8192 bytes required)\n", static_cast<uint32_t>(n));
+			return false;
+		}
+		return true;
+	}
+
+
+	InvadersMachine	im_;
+
+	double run_(uint32_t frames, uint32_t& sum)
+	{
+		im_.setROM(rom_);
+		im_.reset();
+		sum = 0;
+		auto st = bench_usec();
+		for(uint32_t i = 0; i < frames; ++i) {
+			im_.step();
+			sum = sum * 31 + im_.getSounds();
+		}
+		auto us = bench_usec() - st;
+		const auto* v = im_.getVideo();
+		for(uint32_t i = 0; i < InvadersMachine::ScreenWidth * InvadersMachine::ScreenHeight; ++i) {
+			sum = sum * 31 + (v[i] != 0);
+		}
+		return us;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool file = argc > 1 && strcmp(argv[1], "-") != 0;
+	if(file) {
+		if(!load_rom_(argv[1])) return 1;
+	} else {
+		make_rom_();
+	}
+	uint32_t frames = FRAMES;
+	if(argc > 2) frames = strtoul(argv[2], nullptr, 10);
+	if(frames == 0) frames = 1;
+
+	// 2MHz、１フレームに２回の割り込み（InvadersMachine::setFrameRate と同じ）
+	double cycles = static_cast<double>(frames) * 2 * (2000000 / (2 * 60));
+	printf("ROM: %s, %u frames (%.0f M cycles)\n", file ? argv[1] : "built-in loop",
+		frames, cycles / 1e6);
+
+	// 計時の揺らぎを避けるため、繰り返して最小を取る
+	double best = 1e30;
+	uint32_t sum = 0;
+	for(uint32_t i = 0; i < RUNS; ++i) {
+		uint32_t s;
+		auto t = run_(frames, s);
+		if(t < best) best = t;
+		// ワーク RAM は次の実行に残るので、最初の実行の出力を表示する
+		if(i == 0) sum = s;
+	}
+	printf("I8080T<InvadersMachine>: %8.2f emulated MHz\n", cycles / best);
+	printf("video/sound checksum: %08X\n", sum);
+	return 0;
+}
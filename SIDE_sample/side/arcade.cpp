@@ -21,7 +21,13 @@
 
 InvadersMachine::InvadersMachine()
 {
-    cpu_ = new I8080( *this );
+    // 0000-1FFF ROM, 2000-23FF work RAM, 2400-3FFF video RAM (writes go to writeIo),
+    // the rest of the address space is not connected
+    mapRom( 0x0000, 0x2000, ram_ );
+    mapRam( 0x2000, 0x0400, ram_ + 0x2000 );
+    mapIo( 0x2400, 0x1C00, ram_ + 0x2400 );
+
+    cpu_ = new I8080T<InvadersMachine>( *this );
     reset();
     memset( ram_, 0, 0x2000 );  // Clear the ROM area
     setFrameRate( 60 );
@@ -32,11 +38,6 @@ InvadersMachine::~InvadersMachine()
     delete cpu_;
 }
 
-unsigned char InvadersMachine::readByte( unsigned addr ) 
-{
-    return addr < sizeof(ram_) ? ram_[addr] : 0xFF;
-}
-
 unsigned char InvadersMachine::readPort( unsigned port ) 
 {
     unsigned char   b = 0;
@@ -88,26 +89,21 @@ void InvadersMachine::writePort( unsigned addr, unsigned char b )
     }
 }
 
-void InvadersMachine::writeByte( unsigned addr, unsigned char b )
+void InvadersMachine::writeIo( unsigned addr, unsigned char b )
 {
-    if( addr < 0x2000 || addr >= 0x4000 )
-        return;
-
     ram_[addr] = b;
 
-    if( addr >= 0x2400 ) {
-        // This is a write to video memory. Since the video screen is rotated, 
-        // consecutive bits correspond to vertically consecutive pixels.
-        // This is accounted for in the following code, and an extra buffer
-        // is used to store the video memory in a more useable form.
-		unsigned k, y;
-
-		addr -= 0x2400;
-		y = ((255 - ((addr & 0x1F) * 8) )*224) + (addr / 32);
-        for( k=1; k<=128; k<<=1 ) {
-            video_[y] = b & k;
-			y -= ScreenWidth;
-        }
+    // This is a write to video memory. Since the video screen is rotated, 
+    // consecutive bits correspond to vertically consecutive pixels.
+    // This is accounted for in the following code, and an extra buffer
+    // is used to store the video memory in a more useable form.
+	unsigned k, y;
+
+	addr -= 0x2400;
+	y = ((255 - ((addr & 0x1F) * 8) )*224) + (addr / 32);
+    for( k=1; k<=128; k<<=1 ) {
+        video_[y] = b & k;
+		y -= ScreenWidth;
     }
 }
 
@@ -144,8 +140,7 @@ void InvadersMachine::step()
     // Before a frame is fully rendered, two interrupts have to occur
     for( int i=0; i<2; i++ ) {
         // Go on until an interrupt occurs
-        while( cpu_->getCycles() < cycles_per_interrupt_ )
-            cpu_->step();
+        cpu_->run( cycles_per_interrupt_ );
 
         // Adjust the cycles count
         cpu_->setCycles( cpu_->getCycles() - cycles_per_interrupt_ );
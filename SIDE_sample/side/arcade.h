@@ -28,8 +28,9 @@
     Space Invaders arcade machine emulator.
 
     This class emulates in software the original Space Invaders arcade machine. It uses
-    the I8080 emulator to emulate the CPU and extends the I8080Environment to provide
-    the required functions to the CPU emulation.
+    the I8080 emulator to emulate the CPU and extends I8080PageMap to provide
+    the required functions to the CPU emulation: ROM, RAM and video RAM are mapped
+    as pages, so that the CPU core accesses them directly without virtual calls.
 
     For portability, this class does not make direct use of functions that may depend
     on a specific system, such as sound and video. However, it does provide access to
@@ -41,11 +42,14 @@
 
     @author Alessandro Scotti
 
-    @see I8080
-    @see I8080Environment
+    @see I8080T
+    @see I8080PageMap
 */
-class InvadersMachine : public I8080Environment
+class InvadersMachine : public I8080PageMap<InvadersMachine>
 {
+    friend class I8080PageMap<InvadersMachine>;
+    friend class I8080T<InvadersMachine>;
+
 public:
     /** Machine-related definitions. */
     enum Constants {
@@ -218,10 +222,8 @@ public:
     }
 
 protected:
-    // Implementation of the CpuEnvironment interface
-    unsigned char readByte( unsigned addr );
-
-    void writeByte( unsigned, unsigned char );
+    // Implementation of the CpuEnvironment interface (memory is handled by I8080PageMap)
+    void writeIo( unsigned, unsigned char );
 
     unsigned char readPort( unsigned port );
 
@@ -240,7 +242,7 @@ private:
     unsigned        sounds_;
     unsigned        fps_;
     unsigned        cycles_per_interrupt_;
-    I8080 *         cpu_;
+    I8080T<InvadersMachine> *   cpu_;
 };
 
 #endif // ARCADE_H_
@@ -147,12 +147,128 @@ public:
     }
 };
 
+/**
+    Page-mapped memory for I8080 environments.
+
+    The 64k address space is split into 256 pages of 256 bytes, and each page
+    holds a direct pointer for reads and one for writes, so that a memory access
+    is a table lookup instead of a chain of range checks:
+    - RAM pages have both pointers;
+    - ROM pages have no write pointer, writes are silently ignored;
+    - I/O pages are read directly but writes are passed to <i>writeIo()</i>,
+      which the derived class <b>must</b> provide when it maps I/O pages;
+    - unmapped pages read as 0xFF and ignore writes.
+
+    The class uses the "curiously recurring template" idiom (T is the derived
+    class) so that all accesses are resolved at compile time and can be inlined
+    in the CPU core: it is meant to be used as the environment of <i>I8080T</i>.
+
+    Addresses are always truncated to 16 bits, as on the real CPU.
+
+    @see I8080T
+*/
+template <class T>
+class I8080PageMap
+{
+public:
+    /** Constructor. All pages are initially unmapped. */
+    I8080PageMap() {
+        for( unsigned i=0; i<256; i++ ) {
+            open_[i] = 0xFF;
+        }
+        unmap( 0x0000, 0x10000 );
+    }
+
+    /** Maps SIZE bytes of read/write memory MEM at address ADDR (both multiple of 256). */
+    void mapRam( unsigned addr, unsigned size, unsigned char * mem ) {
+        for( unsigned i=0; i<size; i+=0x100 ) {
+            read_[ ((addr + i) >> 8) & 0xFF ] = mem + i;
+            write_[ ((addr + i) >> 8) & 0xFF ] = mem + i;
+            io_[ ((addr + i) >> 8) & 0xFF ] = 0;
+        }
+    }
+
+    /** Maps SIZE bytes of read only memory MEM at address ADDR (both multiple of 256). */
+    void mapRom( unsigned addr, unsigned size, const unsigned char * mem ) {
+        for( unsigned i=0; i<size; i+=0x100 ) {
+            read_[ ((addr + i) >> 8) & 0xFF ] = mem + i;
+            write_[ ((addr + i) >> 8) & 0xFF ] = 0;
+            io_[ ((addr + i) >> 8) & 0xFF ] = 0;
+        }
+    }
+
+    /**
+        Maps SIZE bytes at address ADDR (both multiple of 256) as I/O pages:
+        reads come directly from MEM, writes are passed to <i>T::writeIo()</i>.
+    */
+    void mapIo( unsigned addr, unsigned size, const unsigned char * mem ) {
+        for( unsigned i=0; i<size; i+=0x100 ) {
+            read_[ ((addr + i) >> 8) & 0xFF ] = mem + i;
+            write_[ ((addr + i) >> 8) & 0xFF ] = 0;
+            io_[ ((addr + i) >> 8) & 0xFF ] = 1;
+        }
+    }
+
+    /** Unmaps SIZE bytes at address ADDR (both multiple of 256). */
+    void unmap( unsigned addr, unsigned size ) {
+        for( unsigned i=0; i<size; i+=0x100 ) {
+            read_[ ((addr + i) >> 8) & 0xFF ] = open_;
+            write_[ ((addr + i) >> 8) & 0xFF ] = 0;
+            io_[ ((addr + i) >> 8) & 0xFF ] = 0;
+        }
+    }
+
+    /** Reads one byte from memory at the specified address. */
+    unsigned char readByte( unsigned addr ) const {
+        return read_[ (addr >> 8) & 0xFF ][ addr & 0xFF ];
+    }
+
+    /** Reads a 16 bit word from memory at the specified address. */
+    unsigned readWord( unsigned addr ) const {
+        return readByte( addr ) | ((unsigned)readByte( addr + 1 ) << 8);
+    }
+
+    /** Writes one byte to memory at the specified address. */
+    void writeByte( unsigned addr, unsigned char value ) {
+        unsigned char * p = write_[ (addr >> 8) & 0xFF ];
+        if( p != 0 ) {
+            p[ addr & 0xFF ] = value;
+        }
+        else if( io_[ (addr >> 8) & 0xFF ] ) {
+            static_cast<T *>(this)->writeIo( addr & 0xFFFF, value );
+        }
+    }
+
+    /** Writes a 16 bit word to memory at the specified address (low order byte first). */
+    void writeWord( unsigned addr, unsigned value ) {
+        writeByte( addr, value & 0xFF );
+        writeByte( addr + 1, (value >> 8) & 0xFF );
+    }
+
+private:
+    const unsigned char *   read_[256];     // Read pointer of each page
+    unsigned char *         write_[256];    // Write pointer of each page (0 if not writable)
+    unsigned char           io_[256];       // Non zero for pages handled by writeIo()
+    unsigned char           open_[256];     // Contents of unmapped pages
+};
+
 /**
     I8080 CPU emulator.
 
+    The CPU is a template on its environment, so that memory and port accesses
+    are resolved at compile time: with an environment such as <i>I8080PageMap</i>,
+    that provides non virtual inline functions, the compiler can inline all of them
+    in the opcode handlers, and the opcodes themselves in the <i>step()</i> switch.
+    The environment must provide <i>readByte()</i>, <i>readWord()</i>, <i>writeByte()</i>,
+    <i>writeWord()</i>, <i>readPort()</i> and <i>writePort()</i> with the same signatures
+    of <i>I8080Environment</i>.
+
+    The <i>I8080</i> type uses the generic (virtual) <i>I8080Environment</i>.
+
     @author Alessandro Scotti
 */
-class I8080
+template <class ENV>
+class I8080T
 {
 public:
     /** CPU flags. */
@@ -198,27 +314,30 @@ public:
 
         @see I8080Environment
     */
-    I8080( I8080Environment & env );
+    I8080T( ENV & env );
 
     /** Copy constructor. */
-    I8080( const I8080 & cpu );
-
-    /** Destructor. */
-    virtual ~I8080() {
-    }
+    I8080T( const I8080T & cpu );
 
     /** Resets the CPU to its initial state. */
-    virtual void reset();
+    void reset();
 
     /** Executes one CPU instruction. */
-    virtual void step();
+    void step();
+
+    /** Executes instructions until the cycle counter reaches the specified value. */
+    void run( unsigned cycles ) {
+        while( cycles_ < cycles ) {
+            step();
+        }
+    }
 
     /** 
         Informs the CPU that an interrupt has occurred.
 
         @param  address 16-bit address of the interrupt handler
     */
-    virtual void interrupt( unsigned address );
+    void interrupt( unsigned address );
 
     /** Returns the 16-bit pseudo-register AF. */
     unsigned AF() const {
@@ -251,7 +370,7 @@ public:
     }
 
     /** Assignment operator. Note that the environment is <b>not</b> copied. */
-    I8080 & operator = ( const I8080 & );
+    I8080T & operator = ( const I8080T & );
 
 protected:
     /* 
@@ -544,21 +663,24 @@ protected:
     /** Subtracts byte OP from accumulator, with borrow CF. Flags are updated. */
     unsigned char subByte( unsigned char OP, unsigned char CF );
 
-private:
-    typedef void (I8080::* OpcodeHandler)();
-
-    typedef struct {
-        OpcodeHandler   handler;
-        unsigned        cycles;
-    } OpcodeInfo;
+    /** Dispatches the specified opcode to its handler. */
+    void execute( unsigned op );
 
-    static OpcodeInfo   Opcode_[256];   // Opcode table
+private:
+    static const unsigned char  Cycles_[256];   // Cycles of each opcode
 
-    static unsigned char    PSZ_[256];  // Parity, sign, zero table
+    static const unsigned char  PSZ_[256];      // Parity, sign, zero table
 
     unsigned            halted_;
     unsigned            cycles_;
-    I8080Environment &  env_;
+    ENV &               env_;
 };
 
+#include "i8080cpu.h"
+#include "i8080opc.h"
+#include "i8080sub.h"
+
+/** I8080 CPU emulator with the generic (virtual) environment. */
+typedef I8080T<I8080Environment> I8080;
+
 #endif // I8080_H_
@@ -17,21 +17,22 @@
     along with this program; if not, write to the Free Software
     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
-#include "i8080.h"
-
-I8080::I8080( I8080Environment & env )
+template <class ENV>
+I8080T<ENV>::I8080T( ENV & env )
     : env_( env )
 {
     reset();
 }
 
-I8080::I8080( const I8080 & cpu )
+template <class ENV>
+I8080T<ENV>::I8080T( const I8080T & cpu )
     : env_( cpu.env_ )
 {
     operator = ( cpu );
 }
 
-I8080 & I8080::operator = ( const I8080 & cpu )
+template <class ENV>
+I8080T<ENV> & I8080T<ENV>::operator = ( const I8080T & cpu )
 {
     B = cpu.B;
     C = cpu.C;
@@ -50,7 +51,8 @@ I8080 & I8080::operator = ( const I8080 & cpu )
     return *this;
 }
 
-void I8080::reset()
+template <class ENV>
+void I8080T<ENV>::reset()
 {
     B = 0; 
     C = 0;
@@ -67,19 +69,20 @@ void I8080::reset()
     cycles_ = 0;
 }
 
-void I8080::step()
+template <class ENV>
+inline void I8080T<ENV>::step()
 {
     unsigned op = env_.readByte( PC++ );
 
     // Execute
-    cycles_ += Opcode_[ op ].cycles;
-    if( Opcode_[ op ].handler )
-        (this->*(Opcode_[ op ].handler))();
+    cycles_ += Cycles_[ op ];
+    execute( op );
 
     PC &= 0xFFFF;
 }
 
-void I8080::interrupt( unsigned address )
+template <class ENV>
+void I8080T<ENV>::interrupt( unsigned address )
 {
     if( F & Interrupt ) {
         if( halted_ ) {
@@ -17,9 +17,8 @@
     along with this program; if not, write to the Free Software
     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
-#include "i8080.h"
-
-unsigned char I8080::PSZ_[256] = {
+template <class ENV>
+const unsigned char I8080T<ENV>::PSZ_[256] = {
     Zero|Parity, 0, 0, Parity, 0, Parity, Parity, 0, 0, Parity, Parity, 0, Parity, 0, 0, Parity, 
     0, Parity, Parity, 0, Parity, 0, 0, Parity, Parity, 0, 0, Parity, 0, Parity, Parity, 0, 
     0, Parity, Parity, 0, Parity, 0, 0, Parity, Parity, 0, 0, Parity, 0, Parity, Parity, 0, 
@@ -39,7 +38,8 @@ unsigned char I8080::PSZ_[256] = {
 };
 
 
-void I8080::addByte( unsigned char op, unsigned char cf )
+template <class ENV>
+void I8080T<ENV>::addByte( unsigned char op, unsigned char cf )
 {
     unsigned    x = A + op;
 
@@ -116,19 +116,22 @@ void I8080::addByte( unsigned char op, unsigned char cf )
     A = x;
 }
 
-void I8080::callSub( unsigned addr )
+template <class ENV>
+void I8080T<ENV>::callSub( unsigned addr )
 {
     SP -= 2;
     env_.writeWord( SP, PC );
     PC = addr & 0xFFFF;
 }
 
-void I8080::clearAndSetFlagsPSZ()
+template <class ENV>
+void I8080T<ENV>::clearAndSetFlagsPSZ()
 {
     F = (F & (Flag3 | Flag5)) | PSZ_[A];
 }
 
-unsigned char I8080::decByte( unsigned char b )
+template <class ENV>
+unsigned char I8080T<ENV>::decByte( unsigned char b )
 {
     F = (F & ~(Zero | Sign | HalfCarry | Overflow)) | AddSub;
     if( (b & 0x0F) == 0 ) F |= HalfCarry;
@@ -140,7 +143,8 @@ unsigned char I8080::decByte( unsigned char b )
     return b;
 }
 
-unsigned char I8080::incByte( unsigned char b )
+template <class ENV>
+unsigned char I8080T<ENV>::incByte( unsigned char b )
 {
     ++b;
     F &= ~(AddSub | Zero | Sign | HalfCarry | Overflow);
@@ -152,25 +156,29 @@ unsigned char I8080::incByte( unsigned char b )
     return b;
 }
 
-unsigned I8080::nextWord()
+template <class ENV>
+unsigned I8080T<ENV>::nextWord()
 {
     unsigned x = env_.readWord( PC );
     PC += 2;
     return x;
 }
 
-void I8080::retFromSub()
+template <class ENV>
+void I8080T<ENV>::retFromSub()
 {
     PC = env_.readWord( SP );
     SP += 2;
 }
 
-void I8080::setFlagsPSZ()
+template <class ENV>
+void I8080T<ENV>::setFlagsPSZ()
 {
     F = (F & ~(Parity | Sign | Zero)) | PSZ_[A];
 }
 
-unsigned char I8080::subByte( unsigned char op, unsigned char cf )
+template <class ENV>
+unsigned char I8080T<ENV>::subByte( unsigned char op, unsigned char cf )
 {
     unsigned char   x = A - op;
 
@@ -0,0 +1,125 @@
+//=====================================================================//
+/*!	@file
+	@brief	DX7 synth offline renderer (SMF -> WAV) @n
+			ホスト用、ボイス単位でスレッドプールに分散してレンダリングする
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "sound/synth/offline_render.h"
+
+namespace {
+
+	void help_(const char* cmd)
+	{
+		printf("DX7 synth offline renderer\n");
+		printf("Usage: %s [options] input.mid output.wav\n", cmd);
+		printf("    -t N        render threads (default: all cores)\n");
+		printf("    -r RATE     sample rate (default: 48000)\n");
+		printf("    -b FILE     DX7 32 voice bank (.syx, 4104 bytes)\n");
+		printf("    -p N        program number (0..31)\n");
+		printf("    --tail SEC  release time after the last event (default: 2)\n");
+	}
+
+
+	bool load_file_(const char* file, std::vector<uint8_t>& dst)
+	{
+		FILE* fp = fopen(file, "rb");
+		if(fp == nullptr) return false;
+		uint8_t tmp[4096];
+		size_t n;
+		while((n = fread(tmp, 1, sizeof(tmp), fp)) > 0) {
+			dst.insert(dst.end(), tmp, tmp + n);
+		}
+		fclose(fp);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	int threads = 0;
+	int rate = 48000;
+	int program = -1;
+	double tail = 2.0;
+	const char* bank = nullptr;
+	const char* inp = nullptr;
+	const char* out = nullptr;
+	for(int i = 1; i < argc; ++i) {
+		const char* p = argv[i];
+		if(strcmp(p, "-t") == 0 && (i + 1) < argc) {
+			threads = atoi(argv[++i]);
+		} else if(strcmp(p, "-r") == 0 && (i + 1) < argc) {
+			rate = atoi(argv[++i]);
+		} else if(strcmp(p, "-b") == 0 && (i + 1) < argc) {
+			bank = argv[++i];
+		} else if(strcmp(p, "-p") == 0 && (i + 1) < argc) {
+			program = atoi(argv[++i]);
+		} else if(strcmp(p, "--tail") == 0 && (i + 1) < argc) {
+			tail = atof(argv[++i]);
+		} else if(inp == nullptr) {
+			inp = p;
+		} else if(out == nullptr) {
+			out = p;
+		} else {
+			help_(argv[0]);
+			return 1;
+		}
+	}
+	if(inp == nullptr || out == nullptr || rate <= 0) {
+		help_(argv[0]);
+		return 1;
+	}
+
+	SynthUnit::Init(rate);
+
+	MidiFile mf;
+	if(!mf.Load(inp, rate)) {
+		printf("Can't load SMF: '%s'\n", inp);
+		return 1;
+	}
+
+	// バンク、プログラムチェンジは先頭に挿入
+	std::vector<MidiEvent> events;
+	if(bank != nullptr) {
+		MidiEvent ev;
+		ev.sample = 0;
+		if(!load_file_(bank, ev.data) || ev.data.size() < 4104) {
+			printf("Can't load bank: '%s'\n", bank);
+			return 1;
+		}
+		events.push_back(ev);
+	}
+	if(program >= 0) {
+		MidiEvent ev;
+		ev.sample = 0;
+		ev.data.push_back(0xc0);
+		ev.data.push_back(program & 31);
+		events.push_back(ev);
+	}
+	events.insert(events.end(), mf.events().begin(), mf.events().end());
+
+	OfflineRender render(threads);
+	std::vector<int16_t> pcm;
+	auto st = std::chrono::steady_clock::now();
+	render.Render(events, static_cast<size_t>(tail * rate), pcm);
+	auto ed = std::chrono::steady_clock::now();
+	double sec = std::chrono::duration<double>(ed - st).count();
+
+	if(!write_wav(out, pcm.data(), pcm.size(), rate)) {
+		printf("Can't write WAV: '%s'\n", out);
+		return 1;
+	}
+	double len = static_cast<double>(pcm.size()) / rate;
+	printf("%s: %.2f [s] audio, %d threads, %.3f [s] render (x%.1f realtime)\n",
+		out, len, render.threads(), sec, sec > 0.0 ? len / sec : 0.0);
+	return 0;
+}
@@ -3,7 +3,9 @@
 /*!	@file
 	@brief	Arithmetic テンプレート @n
 			※テキストの数式を展開して、計算結果を得る。@n
-			NVAL には、Boost Multiprecision Library を利用する事を前提にしている。
+			NVAL には、Boost Multiprecision Library を利用する事を前提にしている。@n
+			同じ数式を何度も評価する場合は、compile() で後置記法のバイトコードに@n
+			変換（定数は畳み込む）し、run() で評価する。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2015, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -11,6 +13,7 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include <utility>
 #include "common/bitset.hpp"
 
 namespace utils {
@@ -47,6 +50,66 @@ namespace utils {
 
 		typedef bitset<uint16_t, error> error_t;
 
+
+		static const uint32_t CODE_NUM  = 64;	///< バイトコードの最大数
+		static const uint32_t CONST_NUM = 16;	///< 定数の最大数
+		static const uint32_t STACK_NUM = 8;	///< 評価スタックの最大段数
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	バイトコードの命令
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class OP : uint8_t {
+			PUSH_NUM,	///< 定数を積む（arg: 定数番号）
+			PUSH_SYM,	///< シンボルを積む（arg: SYMBOL::NAME）
+			CALL,		///< 先頭に関数を適用（arg: FUNC::NAME）
+			NEG,		///< 先頭の符号反転
+			ADD,		///< +
+			SUB,		///< -
+			MUL,		///< *
+			DIV,		///< /
+			IDIV,		///< //（右辺の０検査のみ）
+			POW,		///< ^
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	バイトコード
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct code_t {
+			OP			op;
+			uint8_t		arg;
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	コンパイル済みの数式 @n
+					評価スタックも持つので、評価中に数値を確保しない。
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct program {
+			code_t		code_[CODE_NUM];
+			NVAL		const_[CONST_NUM];
+			NVAL		stack_[STACK_NUM + 1];	///< +1 は関数の出力用
+			uint8_t		code_num_;
+			uint8_t		const_num_;
+
+			program() noexcept : code_num_(0), const_num_(0) { }
+
+			//---------------------------------------------------------//
+			/*!
+				@brief	バイトコード数を取得
+				@return バイトコード数（０ならコンパイルされていない）
+			*/
+			//---------------------------------------------------------//
+			uint32_t size() const noexcept { return code_num_; }
+		};
+
 	private:
 
 		SYMBOL&		symbol_;
@@ -276,6 +339,235 @@ namespace utils {
 			return v;
 		}
 
+		bool emit_(program& prog, OP op, uint8_t arg = 0) noexcept
+		{
+			if(prog.code_num_ >= CODE_NUM) {
+				error_.set(error::fatal);
+				return false;
+			}
+			prog.code_[prog.code_num_] = code_t { op, arg };
+			++prog.code_num_;
+			return true;
+		}
+
+
+		// 符号反転（定数なら畳み込む）
+		void emit_neg_(program& prog) noexcept
+		{
+			auto n = prog.code_num_;
+			if(n > 0 && prog.code_[n - 1].op == OP::PUSH_NUM) {
+				auto& a = prog.const_[prog.code_[n - 1].arg];
+				a = -a;
+			} else {
+				emit_(prog, OP::NEG);
+			}
+		}
+
+
+		// ２項演算（両辺が定数なら畳み込む、０除算は評価時のエラーとして残す）
+		void emit_op_(program& prog, OP op) noexcept
+		{
+			auto n = prog.code_num_;
+			if(n >= 2 && prog.code_[n - 2].op == OP::PUSH_NUM && prog.code_[n - 1].op == OP::PUSH_NUM) {
+				auto& a = prog.const_[prog.code_[n - 2].arg];
+				const auto& b = prog.const_[prog.code_[n - 1].arg];
+				bool fold = true;
+				switch(op) {
+				case OP::ADD: a += b; break;
+				case OP::SUB: a -= b; break;
+				case OP::MUL: a *= b; break;
+				case OP::DIV:
+					if(b == 0) fold = false;
+					else a /= b;
+					break;
+				case OP::IDIV:
+					if(b == 0) fold = false;
+					break;
+				case OP::POW: a.pow(b); break;
+				default:
+					fold = false;
+					break;
+				}
+				if(fold) {  // 右辺は、最後に追加した定数
+					--prog.code_num_;
+					--prog.const_num_;
+					return;
+				}
+			}
+			emit_(prog, op);
+		}
+
+
+		void compile_number_(program& prog) noexcept
+		{
+			bool minus = false;
+			char tmp[NUMBER_NUM];
+
+			// 符号、反転の判定
+			if(ch_ == '-') {
+				minus = true;
+				ch_ = *tx_++;
+			} else if(ch_ == '+') {
+				ch_ = *tx_++;
+			}
+
+			if(static_cast<uint8_t>(ch_) >= 0x80) {  // symbol?, func?
+				if(static_cast<uint8_t>(ch_) >= 0xC0) {  // func ?
+					auto fc = static_cast<uint8_t>(ch_);
+					ch_ = *tx_++;
+					if(ch_ == '(') {
+						ch_ = *tx_++;
+						compile_expression_(prog);
+						if(ch_ == ')') {
+							ch_ = *tx_++;
+							emit_(prog, OP::CALL, fc);
+						} else {
+							error_.set(error::fatal);
+						}
+					} else {
+						error_.set(error::func_fatal);
+					}
+				} else {  // to symbol
+					emit_(prog, OP::PUSH_SYM, static_cast<uint8_t>(ch_));
+					ch_ = *tx_++;
+				}
+				if(minus) emit_neg_(prog);
+				return;
+			}
+
+			if(ch_ == '(') {
+				compile_factor_(prog);
+			} else {
+				uint32_t idx = 0;
+				while(ch_ != 0) {
+					if(ch_ == '+') break;
+					else if(ch_ == '-') break;
+					else if(ch_ == '*') break;
+					else if(ch_ == '/') break;
+					else if(ch_ == ')') break;
+					else if(ch_ == '^') break;
+					else if((ch_ >= '0' && ch_ <= '9') || ch_=='.' || ch_=='e' || ch_=='E') {
+						if(idx >= (NUMBER_NUM - 1)) {
+							error_.set(error::number_fatal);
+							break;
+						}
+						tmp[idx] = ch_;
+						idx++;
+					} else {
+						error_.set(error::fatal);
+						break;
+					}
+					ch_ = *tx_++;
+				}
+				tmp[idx] = 0;
+				if(error_() != 0) return;
+				if(prog.const_num_ >= CONST_NUM) {
+					error_.set(error::fatal);
+					return;
+				}
+				prog.const_[prog.const_num_].assign(tmp);
+				if(!emit_(prog, OP::PUSH_NUM, prog.const_num_)) return;
+				++prog.const_num_;
+			}
+
+			if(minus) emit_neg_(prog);
+		}
+
+
+		void compile_factor_(program& prog) noexcept
+		{
+			if(ch_ == '(') {
+				ch_ = *tx_++;
+				compile_expression_(prog);
+				if(ch_ == ')') {
+					ch_ = *tx_++;
+				} else {
+					error_.set(error::fatal);
+				}
+			} else {
+				compile_number_(prog);
+			}
+		}
+
+
+		void compile_term_(program& prog) noexcept
+		{
+			compile_factor_(prog);
+			while(error_() == 0) {
+				switch(ch_) {
+				case '*':
+					ch_ = *tx_++;
+					compile_factor_(prog);
+					emit_op_(prog, OP::MUL);
+					break;
+				case '/':
+					ch_ = *tx_++;
+					if(ch_ == '/') {
+						ch_ = *tx_++;
+						compile_factor_(prog);
+						emit_op_(prog, OP::IDIV);
+					} else {
+						compile_factor_(prog);
+						emit_op_(prog, OP::DIV);
+					}
+					break;
+				case '^':
+					ch_ = *tx_++;
+					compile_factor_(prog);
+					emit_op_(prog, OP::POW);
+					break;
+				default:
+					return;
+				}
+			}
+		}
+
+
+		void compile_expression_(program& prog) noexcept
+		{
+			compile_term_(prog);
+			while(error_() == 0) {
+				switch(ch_) {
+				case '+':
+					ch_ = *tx_++;
+					compile_term_(prog);
+					emit_op_(prog, OP::ADD);
+					break;
+				case '-':
+					ch_ = *tx_++;
+					compile_term_(prog);
+					emit_op_(prog, OP::SUB);
+					break;
+				default:
+					return;
+				}
+			}
+		}
+
+
+		// 評価スタックの最大段数
+		static uint32_t depth_(const program& prog) noexcept
+		{
+			uint32_t d = 0;
+			uint32_t max = 0;
+			for(uint32_t i = 0; i < prog.code_num_; ++i) {
+				switch(prog.code_[i].op) {
+				case OP::PUSH_NUM:
+				case OP::PUSH_SYM:
+					++d;
+					if(d > max) max = d;
+					break;
+				case OP::CALL:
+				case OP::NEG:
+					break;
+				default:
+					--d;
+					break;
+				}
+			}
+			return max;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -322,6 +614,126 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	数式をバイトコードに変換 @n
+					文法のエラーは、analize と同じ。
+			@param[in]	text	解析テキスト
+			@param[out]	prog	コンパイル済みの数式
+			@return	文法にエラーがあった場合、「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool compile(const char* text, program& prog) noexcept
+		{
+			prog.code_num_ = 0;
+			prog.const_num_ = 0;
+			if(text == nullptr) {
+				error_.set(error::fatal);
+				return false;
+			}
+			tx_ = text;
+
+			error_.clear();
+
+			ch_ = *tx_++;
+			if(ch_ != 0) {
+				compile_expression_(prog);
+			} else {
+				error_.set(error::fatal);
+			}
+
+			if(error_() == 0) {
+				if(ch_ != 0 || depth_(prog) > STACK_NUM) {
+					error_.set(error::fatal);
+				}
+			}
+			if(error_() != 0) {
+				prog.code_num_ = 0;
+				return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンパイル済みの数式を評価 @n
+					結果は「()」で取得する。
+			@param[in]	prog	コンパイル済みの数式
+			@return	エラー（zero_divide、symbol_fatal、func_fatal）があった場合、「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool run(program& prog) noexcept
+		{
+			error_.clear();
+			if(prog.code_num_ == 0) {
+				error_.set(error::fatal);
+				return false;
+			}
+
+			NVAL* sp = prog.stack_;
+			for(uint32_t pc = 0; pc < prog.code_num_; ++pc) {
+				const auto& c = prog.code_[pc];
+				switch(c.op) {
+				case OP::PUSH_NUM:
+					*sp = prog.const_[c.arg];
+					++sp;
+					break;
+				case OP::PUSH_SYM:
+					if(!symbol_(static_cast<typename SYMBOL::NAME>(c.arg), *sp)) {
+						error_.set(error::symbol_fatal);
+						return false;
+					}
+					++sp;
+					break;
+				case OP::CALL:
+					if(!func_(static_cast<typename FUNC::NAME>(c.arg), sp[-1], sp[0])) {
+						error_.set(error::func_fatal);
+						return false;
+					}
+					std::swap(sp[-1], sp[0]);
+					break;
+				case OP::NEG:
+					sp[-1] = -std::move(sp[-1]);
+					break;
+				case OP::ADD:
+					--sp;
+					sp[-1] += *sp;
+					break;
+				case OP::SUB:
+					--sp;
+					sp[-1] -= *sp;
+					break;
+				case OP::MUL:
+					--sp;
+					sp[-1] *= *sp;
+					break;
+				case OP::DIV:
+					--sp;
+					if(*sp == 0) {
+						error_.set(error::zero_divide);
+						return false;
+					}
+					sp[-1] /= *sp;
+					break;
+				case OP::IDIV:
+					--sp;
+					if(*sp == 0) {
+						error_.set(error::zero_divide);
+						return false;
+					}
+					break;
+				case OP::POW:
+					--sp;
+					sp[-1].pow(*sp);
+					break;
+				}
+			}
+			std::swap(value_, prog.stack_[0]);
+			return true;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	エラーを受け取る
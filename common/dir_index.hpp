@@ -0,0 +1,319 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ディレクトリー・インデックス・クラス @n
+			ディレクトリーを一度だけ走査して、名前（文字列アリーナ）、属性、@n
+			サイズ、日付をメモリー上に保持し、名前、日付、サイズでソートする。@n
+			記憶割り当ては使わず、エントリー数とアリーナのサイズはテンプレートで指定。@n
+			収まらないディレクトリーは、先頭を読み飛ばして、一部（ウィンドウ）を保持する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "ff14/source/ff.h"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ディレクトリー・インデックス・クラス
+		@param[in]	ENTRY	最大エントリー数（65535 以下）
+		@param[in]	ARENA	ファイル名アリーナのサイズ（16M 未満）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t ENTRY, uint32_t ARENA>
+	class dir_index {
+
+		static_assert(ENTRY <= 65535, "ENTRY must be 65535 or less");
+		static_assert(ARENA < 0x1000000, "ARENA must be less than 16M");
+
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  ソート型
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class sort_type : uint8_t {
+			NONE,	///< ディレクトリーの順番
+			NAME,	///< 名前順（大文字、小文字を区別しない）
+			DATE,	///< 日付順（新しい順）
+			SIZE,	///< サイズ順（大きい順）
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  エントリー（12 バイト）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct entry_t {
+			uint32_t	name_;	///< アリーナ・オフセット（0～23）、属性（24～31）
+			uint32_t	size_;	///< ファイル・サイズ
+			uint16_t	date_;	///< FatFs 日付
+			uint16_t	time_;	///< FatFs 時間
+
+			const char* name(const char* arena) const noexcept { return arena + (name_ & 0xffffff); }
+			uint8_t attr() const noexcept { return name_ >> 24; }
+			bool is_dir() const noexcept { return (attr() & AM_DIR) != 0; }
+			uint32_t size() const noexcept { return size_; }
+			uint16_t date() const noexcept { return date_; }
+			uint16_t time() const noexcept { return time_; }
+		};
+
+	private:
+		entry_t		entry_[ENTRY];
+		uint16_t	order_[ENTRY];
+		char		arena_[ARENA];
+
+		DIR			dir_;
+		uint32_t	num_;
+		uint32_t	arena_pos_;
+		uint32_t	skip_;
+		uint32_t	total_;
+		bool		init_;
+		bool		overflow_;
+		sort_type	sort_;
+
+		static int icmp_(const char* a, const char* b) noexcept
+		{
+			while(*a != 0 || *b != 0) {
+				int ca = static_cast<uint8_t>(*a++);
+				int cb = static_cast<uint8_t>(*b++);
+				if(ca >= 'A' && ca <= 'Z') ca += 'a' - 'A';
+				if(cb >= 'A' && cb <= 'Z') cb += 'a' - 'A';
+				if(ca != cb) return ca - cb;
+			}
+			return 0;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		dir_index() noexcept : entry_(), order_{ 0 }, arena_{ 0 }, dir_(),
+			num_(0), arena_pos_(0), skip_(0), total_(0), init_(false), overflow_(false), sort_(sort_type::NAME)
+		{ }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プローブ（状態）
+			@return 走査中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe() const noexcept { return init_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリー数を取得
+			@return エントリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリー、アリーナが溢れたか？ @n
+					※溢れた場合、それ以降のエントリーは登録されない
+			@return 溢れた場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_overflow() const noexcept { return overflow_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの一部だけを保持しているか？ @n
+					※一部の場合、ソート型に関係なく、ディレクトリーの順番で並ぶ
+			@return 一部の場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_part() const noexcept { return overflow_ || skip_ > 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み飛ばしたエントリー数を取得 @n
+					※インデックス「0」の、ディレクトリー内の位置
+			@return 読み飛ばしたエントリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_skip() const noexcept { return skip_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー内の全エントリー数を取得（走査後に有効）
+			@return 全エントリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_total() const noexcept { return total_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査開始 @n
+					※「probe()」関数が「false」になるまで「service()」を呼ぶ
+			@param[in]	root	ルート・パス
+			@param[in]	skip	読み飛ばすエントリー数
+			@return エラー無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool start(const char* root, uint32_t skip = 0) noexcept
+		{
+			stop();
+			num_ = 0;
+			arena_pos_ = 0;
+			skip_ = skip;
+			total_ = 0;
+			overflow_ = false;
+
+			if(f_opendir(&dir_, root) != FR_OK) {
+				return false;
+			}
+			init_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査を停止する
+		 */
+		//-----------------------------------------------------------------//
+		void stop() noexcept
+		{
+			if(!init_) return;
+
+			init_ = false;
+			f_closedir(&dir_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査サービス @n
+					走査が終わると、現在のソート型で並べる
+			@param[in]	num		１回で処理するエントリー数
+			@return エラー無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service(uint32_t num) noexcept
+		{
+			if(!init_) return false;
+
+			for(uint32_t i = 0; i < num; ++i) {
+				FILINFO fi;
+				if(f_readdir(&dir_, &fi) != FR_OK) {
+					stop();
+					return false;
+				}
+				if(!fi.fname[0]) {
+					stop();
+					sort(sort_);
+					break;
+				}
+				++total_;
+				if(total_ <= skip_ || overflow_) continue;
+
+				uint32_t len = std::strlen(fi.fname) + 1;
+				if(num_ >= ENTRY || (arena_pos_ + len) > ARENA) {
+					overflow_ = true;
+					continue;
+				}
+				std::memcpy(&arena_[arena_pos_], fi.fname, len);
+				auto& e = entry_[num_];
+				e.name_ = arena_pos_ | (static_cast<uint32_t>(fi.fattrib) << 24);
+				e.size_ = fi.fsize;
+				e.date_ = fi.fdate;
+				e.time_ = fi.ftime;
+				order_[num_] = num_;
+				arena_pos_ += len;
+				++num_;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ソート（ディレクトリーが先） @n
+					※一部だけを保持している場合、前後の一部と順番が繋がらないので並べない
+			@param[in]	type	ソート型
+		 */
+		//-----------------------------------------------------------------//
+		void sort(sort_type type) noexcept
+		{
+			sort_ = type;
+			if(num_ == 0) return;
+			if(is_part()) {
+				for(uint32_t i = 0; i < num_; ++i) order_[i] = i;
+				return;
+			}
+
+			const char* arena = arena_;
+			const entry_t* ent = entry_;
+			std::sort(&order_[0], &order_[num_], [=](uint16_t a, uint16_t b) {
+				const auto& ea = ent[a];
+				const auto& eb = ent[b];
+				if(ea.is_dir() != eb.is_dir()) return ea.is_dir();
+				switch(type) {
+				case sort_type::NAME:
+					{
+						auto n = icmp_(ea.name(arena), eb.name(arena));
+						if(n != 0) return n < 0;
+					}
+					break;
+				case sort_type::DATE:
+					if(ea.date_ != eb.date_) return ea.date_ > eb.date_;
+					if(ea.time_ != eb.time_) return ea.time_ > eb.time_;
+					break;
+				case sort_type::SIZE:
+					if(ea.size_ != eb.size_) return ea.size_ > eb.size_;
+					break;
+				default:
+					break;
+				}
+				return a < b;
+			});
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ソート型を取得
+			@return ソート型
+		 */
+		//-----------------------------------------------------------------//
+		sort_type get_sort() const noexcept { return sort_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリーを取得（ソート順）
+			@param[in]	idx		インデックス
+			@return エントリー
+		 */
+		//-----------------------------------------------------------------//
+		const entry_t& get(uint32_t idx) const noexcept { return entry_[order_[idx]]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル名を取得（ソート順）
+			@param[in]	idx		インデックス
+			@return ファイル名
+		 */
+		//-----------------------------------------------------------------//
+		const char* get_name(uint32_t idx) const noexcept { return get(idx).name(arena_); }
+	};
+}
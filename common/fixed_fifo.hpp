@@ -104,6 +104,30 @@ namespace utils {
 		}
 
 
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  まとめて格納（格納位置の更新は最後に一度だけ行う）
+			@param[in]	src	値の配列
+			@param[in]	num	数（空きを超えない事）
+        */
+        //-----------------------------------------------------------------//
+		void put(const UNIT* src, uint32_t num) noexcept {
+			uint32_t put = put_;
+			while(num > 0) {
+				uint32_t n = SIZE - put;
+				if(n > num) n = num;
+				for(uint32_t i = 0; i < n; ++i) {
+					buff_[put + i] = src[i];
+				}
+				src += n;
+				num -= n;
+				put += n;
+				if(put >= SIZE) put = 0;
+			}
+			put_ = put;
+		}
+
+
         //-----------------------------------------------------------------//
         /*!
             @brief  値の取得参照を得る
@@ -186,7 +186,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		fixed_string& operator = (const char* src) noexcept {
-			std::strncpy(str_, src, SIZE);
+			utils::str::strncpy_(str_, src, SIZE + 1);
 			pos_ = std::strlen(str_);
 			return *this;
 		}
@@ -32,7 +32,12 @@
 			+ 2020/04/25 07:45- stdout_buffered_chaout に、操作位置を返すメソッド pos() を追加。
 			! 2020/11/20 07:44- sformat 時の nega_ フラグの初期化漏れ
 			! 2020/11/20 07:44- nega_ 符号表示の順番、不具合
-			! 2020/11/20 16:59- uint 型を削除
+			! 2020/11/20 16:59- uint 型を削除 @n
+			+ 2020/12/01 10:20- 出力ファンクタに一括出力 write(const char*, n) を追加 @n
+			+ 2020/12/01 10:20- コンパイル時に解析する書式 format_form（make_form）を追加 @n
+			+ 2020/12/03 09:40- 数値変換を num_conv へ（整数は２桁づつ、%f、%e は正確に偶数丸め） @n
+			! 2020/12/03 09:40- %e の仮数部が 1.0 ～ 10.0 に正規化されない不具合、%f の 2^32 以上の不具合修正 @n
+			+ 2020/12/03 09:40- %g（精度の指定無し）は、元の値に戻る最短の表記
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2013, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -44,6 +49,7 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include "common/num_conv.hpp"
 
 // 最終的な出力として putchar を使う場合有効にする（通常は write [stdout] 関数）
 // #define USE_PUTCHAR
@@ -102,6 +108,8 @@ namespace utils {
 
 		void operator() (char ch) noexcept { }
 
+		void write(const char* s, uint32_t n) noexcept { }
+
 		void clear() noexcept { };
 
 		uint size() const noexcept { return 0; }
@@ -133,6 +141,8 @@ namespace utils {
 			++size_;
 		}
 
+		void write(const char* s, uint32_t n) noexcept { size_ += n; }
+
 		void clear() noexcept { size_ = 0; };
 
 		uint size() const noexcept { return size_; }
@@ -165,11 +175,23 @@ namespace utils {
 			putchar(ch);
 #else
 			char tmp = ch;
-			write(STDOUT_FILENO, &tmp, 1);
+			::write(STDOUT_FILENO, &tmp, 1);
 #endif
 			++size_;
 		}
 
+		void write(const char* s, uint32_t n) noexcept
+		{
+#ifdef USE_PUTCHAR
+			for(uint32_t i = 0; i < n; ++i) {
+				putchar(s[i]);
+			}
+#else
+			::write(STDOUT_FILENO, s, n);
+#endif
+			size_ += n;
+		}
+
 		void clear() noexcept { size_ = 0; };
 
 		uint size() const noexcept { return size_; }
@@ -209,6 +231,28 @@ namespace utils {
 			++size_;
 		}
 
+		void write(const char* s, uint32_t n) noexcept {
+			size_ += n;
+			while(n > 0) {
+				// 改行、又はバッファが一杯になる所までを、まとめて複写
+				uint32_t l = BFN - pos_;
+				if(l > n) l = n;
+				auto p = static_cast<const char*>(std::memchr(s, '\n', l));
+				bool fl = pos_ + l >= BFN;
+				if(p != nullptr) {
+					l = p - s + 1;
+					fl = true;
+				}
+				std::memcpy(&buff_[pos_], s, l);
+				pos_ += l;
+				s += l;
+				n -= l;
+				if(fl) {
+					flush();
+				}
+			}
+		}
+
 		void clear() noexcept { size_ = 0; };
 
 		auto size() const noexcept { return size_; }
@@ -224,7 +268,7 @@ namespace utils {
 				putchar(buff_[i]);
 			}
 #else
-			write(STDOUT_FILENO, buff_, pos_);
+			::write(STDOUT_FILENO, buff_, pos_);
 #endif
 			pos_ = 0;
 		}
@@ -359,6 +403,19 @@ namespace utils {
 		}
 
 
+		void write(const char* s, uint32_t n) noexcept {
+			if(pos_ < limit_) {
+				if(n > (limit_ - pos_)) n = limit_ - pos_;
+				char* d = &dst_[pos_];
+				for(uint32_t i = 0; i < n; ++i) {
+					d[i] = s[i];
+				}
+				pos_ += n;
+				dst_[pos_] = 0;
+			}
+		}
+
+
 		void clear() noexcept { pos_ = 0; }
 
 
@@ -373,7 +430,7 @@ namespace utils {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class base_format {
 	public:
-		static const uint16_t VERSION = 93;		///< バージョン番号（整数）
+		static const uint16_t VERSION = 95;		///< バージョン番号（整数）
 
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
@@ -389,18 +446,13 @@ namespace utils {
 			out_null,		///< 文字出力先が無効
 			out_overflow,	///< 文字出力先がオーバーフローした場合
 		};
-	};
 
 
-	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	/*!
-		@brief  簡易 format クラス
-		@param[in]	CHAOUT	文字出力ファンクタ
-	*/
-	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class CHAOUT>
-	class basic_format : public base_format {
-
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  変換の型
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		enum class mode : uint8_t {
 			CHA,			///< 文字
 			STR,			///< 文字列
@@ -420,10 +472,204 @@ namespace utils {
 			NONE			///< 不明
 		};
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  変換文字から型を得る
+			@param[in]	ch	変換文字
+			@return 型（不明な場合「mode::NONE」）
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr mode get_mode(char ch) noexcept
+		{
+			switch(ch) {
+			case 's': return mode::STR;
+			case 'c': return mode::CHA;
+#ifndef NO_BIN_FORM
+			case 'b': return mode::BINARY;
+#endif
+#ifndef NO_OCTAL_FORM
+			case 'o': return mode::OCTAL;
+#endif
+			case 'd':
+			case 'i': return mode::DECIMAL;
+			case 'u': return mode::U_DECIMAL;
+			case 'x': return mode::HEX;
+			case 'X': return mode::HEX_CAPS;
+			case 'y': return mode::FIXED_REAL;
+			case 'f':
+			case 'F': return mode::REAL;
+			case 'e': return mode::EXPONENT;
+			case 'E': return mode::EXPONENT_CAPS;
+			case 'g': return mode::REAL_AUTO;
+			case 'G': return mode::REAL_AUTO_CAPS;
+			case 'p': return mode::POINTER;
+			default: return mode::NONE;
+			}
+		}
+
+	protected:
+		// 一括出力（write を持たない出力ファンクタは、一文字づつ）
+		template <class OUT>
+		static auto write_(OUT& out, const char* s, uint32_t n, int) noexcept
+			-> decltype(out.write(s, n), void())
+		{
+			out.write(s, n);
+		}
+
+		template <class OUT>
+		static void write_(OUT& out, const char* s, uint32_t n, long) noexcept
+		{
+			for(uint32_t i = 0; i < n; ++i) {
+				out(s[i]);
+			}
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  書式の変換指定 @n
+				直前の文字列（位置、長さ）と、変換の型、桁数など
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct format_spec {
+		uint16_t	ofs = 0;		///< 直前の文字列の位置
+		uint16_t	len = 0;		///< 直前の文字列の長さ
+		uint16_t	num = 0;		///< 全桁数
+		uint8_t		point = 0;		///< 小数部桁数
+		uint8_t		bitlen = 0;		///< 固定小数点、小数部のビット数
+		base_format::mode	mode = base_format::mode::NONE;
+		bool		zerosupp = false;
+		bool		sign = false;
+		bool		nega = false;
+	};
+
+
+	// constexpr の評価中に呼ばれると、コンパイル・エラーになる
+	inline void format_form_error(const char* msg) noexcept { }
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時に解析する書式 @n
+				書式を、文字列の並びと、型付きの変換指定に分けておく。@n
+				constexpr で作ると、不明な変換、不完全な「%」はコンパイル・エラー。@n
+				Ex: static constexpr auto form = utils::make_form("%d: %5.2f\n"); @n
+				    utils::format(form) % i % a;
+		@param[in]	N	書式の大きさ（終端を含む）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N>
+	struct format_form {
+		char		text[N];			///< 文字列（「%%」は「%」にした物）
+		format_spec	spec[N / 2 + 1];	///< 変換指定（最後は、末尾の文字列だけ）
+		uint16_t	num;				///< 変換指定の数（末尾を含む）
+		bool		valid;
+
+		constexpr format_form(const char (&form)[N]) noexcept :
+			text(), spec(), num(0), valid(true)
+		{
+			enum class apmd : uint8_t {
+				num,	// 数字
+				point,	// 小数点
+				bitlen	// 固定小数点、ビット長さ
+			};
+
+			uint16_t t = 0;
+			format_spec cur;
+			uint32_t i = 0;
+			while(i < N && form[i] != 0) {
+				char ch = form[i++];
+				if(ch != '%') {
+					text[t++] = ch;
+					++cur.len;
+					continue;
+				}
+				apmd md = apmd::num;
+				uint16_t n = 0;
+				while(1) {
+					ch = i < N ? form[i++] : 0;
+					if(ch == 0) {
+						format_form_error("format: incomplete '%'");
+						valid = false;
+						return;
+					} else if(ch == '+') {
+						cur.sign = true;
+					} else if(ch == '-') {
+						cur.nega = true;
+					} else if(ch >= '0' && ch <= '9') {
+						ch -= '0';
+						if(md == apmd::num) {
+							if(n == 0 && ch == 0) {
+								cur.zerosupp = true;
+							}
+							n = n * 10 + ch;
+						} else if(md == apmd::point) {
+							cur.point = cur.point * 10 + ch;
+						} else {
+							cur.bitlen = cur.bitlen * 10 + ch;
+						}
+					} else if(ch == '.') {
+						md = apmd::point;
+					} else if(ch == ':') {
+						md = apmd::bitlen;
+					} else if(ch == '%') {  // 「%%」
+						text[t++] = ch;
+						++cur.len;
+						break;
+					} else {
+						cur.mode = base_format::get_mode(ch);
+						if(cur.mode == base_format::mode::NONE) {
+							format_form_error("format: unknown conversion");
+							valid = false;
+							return;
+						}
+						cur.num = n;
+						spec[num++] = cur;
+						cur = format_spec();
+						cur.ofs = t;
+						break;
+					}
+				}
+			}
+			spec[num++] = cur;
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  コンパイル時に解析する書式を作る
+		@param[in]	form	書式（文字列リテラル）
+		@return 書式
+	*/
+	//-----------------------------------------------------------------//
+	template <uint32_t N>
+	constexpr format_form<N> make_form(const char (&form)[N]) noexcept
+	{
+		return format_form<N>(form);
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  簡易 format クラス
+		@param[in]	CHAOUT	文字出力ファンクタ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class CHAOUT>
+	class basic_format : public base_format {
+
 		static CHAOUT	chaout_;
 
 		const char*	form_;
 
+		const format_spec*	spec_;	///< コンパイル時に解析した書式
+		const char*	text_;
+		uint16_t	spec_num_;
+		uint16_t	spec_pos_;
+
 		char		buff_[34];
 
 		uint16_t	num_;
@@ -437,8 +683,7 @@ namespace utils {
 		bool		nega_;
 
 		void str_(const char* str) {
-			char ch;
-			while((ch = *str++) != 0) chaout_(ch);
+			write_(chaout_, str, std::strlen(str), 0);
 		}
 
 		void reset_() {
@@ -459,10 +704,23 @@ namespace utils {
 				bitlen	// 固定小数点、ビット長さ
 			};
 
+			if(spec_ != nullptr) {
+				next_spec_();
+				return;
+			}
 			if(form_ == nullptr) {
 				error_ = error::null;
 				return;
 			}
+			// 変換指定までの文字列は、まとめて出力
+			{
+				auto p = form_;
+				while(*p != 0 && *p != '%') ++p;
+				if(p != form_) {
+					write_(chaout_, form_, p - form_, 0);
+					form_ = p;
+				}
+			}
 			char ch;
 			apmd md = apmd::none;
 			while((ch = *form_++) != 0) {
@@ -555,11 +813,28 @@ namespace utils {
 		}
 
 
+		void next_spec_() {
+			if(spec_pos_ >= spec_num_) return;
+			const auto& s = spec_[spec_pos_];
+			++spec_pos_;
+			if(s.len > 0) {
+				write_(chaout_, text_ + s.ofs, s.len, 0);
+			}
+			num_ = s.num;
+			point_ = s.point;
+			bitlen_ = s.bitlen;
+			mode_ = s.mode;
+			zerosupp_ = s.zerosupp;
+			sign_ = s.sign;
+			nega_ = s.nega;
+		}
+
+
 		void out_str_(const char* str, char sign, uint16_t n)
 		{
 			if(nega_) {
 				if(sign != 0) { chaout_(sign); }
-				str_(str);
+				write_(chaout_, str, n, 0);
 			}
 
 			auto num = num_;
@@ -584,7 +859,7 @@ namespace utils {
 				if(!nega_ && sign != 0) { chaout_(sign); }
 			}
 
-			if(!nega_) { str_(str); }
+			if(!nega_) { write_(chaout_, str, n, 0); }
 		}
 
 #ifndef NO_BIN_FORM
@@ -618,16 +893,10 @@ namespace utils {
 #endif
 
 		void out_udec_(uint32_t v, char sign) {
-			char* p = &buff_[sizeof(buff_) - 1];
-			*p = 0;
-			uint8_t n = 0;
-			do {
-				--p;
-				*p = (v % 10) + '0';
-				v /= 10;
-				++n;
-			} while(v != 0) ;
-			out_str_(p, sign, n);
+			char* end = &buff_[sizeof(buff_) - 1];
+			*end = 0;
+			const char* p = num_conv::utoa(v, end);
+			out_str_(p, sign, end - p);
 		}
 
 
@@ -767,59 +1036,74 @@ namespace utils {
 
 
 #ifndef NO_FLOAT_FORM
-		void out_real_(float v, char e)
+		// 整数部、小数部の数字列から、固定小数点表記
+		static uint32_t fixed_str_(char* out, const char* dig, int32_t n, int32_t point) noexcept
 		{
-			void* p = &v;
-			uint32_t fpv = *(uint32_t*)p;
-			bool sign = fpv >> 31;
-			int16_t exp = (fpv >> 23) & 0xff;
-			if(exp == 0xff) {
-				if(sign) chaout_('-');
-				str_("inf");
-				return;
+			uint32_t l = 0;
+			if(n <= point) {
+				out[l++] = '0';
+			} else {
+				std::memcpy(out, dig, n - point);
+				l = n - point;
 			}
-
-			exp -= 127;	// bias (-127)
-			int32_t val = fpv & 0x7fffff;	// 23 bits
-			int16_t shift = 23;
-			if(val == 0 && exp == -127) ; // [0.0]
-			else {
-				val |= 0x800000; // add offset 1.0
+			if(point > 0) {
+				out[l++] = '.';
+				for(int32_t i = n; i < point; ++i) out[l++] = '0';
+				int32_t i = n > point ? n - point : 0;
+				while(i < n) out[l++] = dig[i++];
 			}
-			shift -= exp;
+			return l;
+		}
 
-			// 64 ビットに拡張
-			uint64_t v64 = static_cast<uint64_t>(val);
-			if(shift < 28) {
-				shift += 32;
-				v64 <<= 32;
-			}
 
-			// エキスポーネント表記の場合
-			int8_t dexp = 0;
-			if(e != 0) {
-				if(v64 > (static_cast<uint64_t>(2) << shift)) {  // 2.0 以上の場合
-					while(v64 > (static_cast<uint64_t>(2) << shift)) {
-						v64 /= 10;
-						++dexp;
-					}
-				} else if(v64 < (static_cast<uint64_t>(1) << shift)) {  // 1.0 以下
-					while(v64 < (static_cast<uint64_t>(1) << shift)) {
-						v64 *= 10;
-						--dexp;
-					}
-				}
+		void out_real_(float v, char e)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &v, 4);
+			char sch = 0;
+			if(bits >> 31) sch = '-';
+			else if(sign_) sch = '+';
+			if(((bits >> 23) & 0xff) == 0xff) {
+				zerosupp_ = false;
+				out_str_((bits & 0x7fffff) != 0 ? "nan" : "inf", sch, 3);
+				return;
 			}
 
-			out_fixed_point_<uint64_t>(v64, shift, sign);
-
-			if(e) {
-				chaout_(e);
-				zerosupp_ = true;
-				sign_ = true;
-				num_ = 3;
-				out_dec_(dexp);
+			char dig[num_conv::REAL_BUFF_SIZE];
+			char tmp[num_conv::REAL_BUFF_SIZE + 8];
+			uint32_t l;
+			bool aut = mode_ == mode::REAL_AUTO || mode_ == mode::REAL_AUTO_CAPS;
+			if(aut && point_ == 0) {  // 精度の指定が無い場合、元の値に戻る最短の表記
+				int32_t dexp;
+				int32_t n = num_conv::shortest(v, dig, dexp);
+				if(dexp >= 0) {
+					for(int32_t i = 0; i < dexp; ++i) dig[n++] = '0';
+					l = fixed_str_(tmp, dig, n, 0);
+				} else {
+					l = fixed_str_(tmp, dig, n, -dexp);
+				}
+			} else if(e != 0) {
+				int32_t dexp;
+				uint32_t n = num_conv::exponent(v, point_, dig, dexp);
+				l = fixed_str_(tmp, dig, n, n - 1);
+				tmp[l++] = e;
+				tmp[l++] = dexp < 0 ? '-' : '+';
+				if(dexp < 0) dexp = -dexp;
+				if(dexp < 10) tmp[l++] = '0';
+				char* end = &tmp[sizeof(tmp)];
+				const char* p = num_conv::utoa(static_cast<uint32_t>(dexp), end);
+				while(p < end) tmp[l++] = *p++;
+			} else {
+				uint32_t point = point_;
+				if(point > num_conv::REAL_DIGITS_MAX) point = num_conv::REAL_DIGITS_MAX;
+				uint32_t n = num_conv::fixed(v, point, dig);
+				l = fixed_str_(tmp, dig, n, point);
+				if(aut && point > 0) {  // 末尾の '0' を除去
+					while(tmp[l - 1] == '0') --l;
+					if(tmp[l - 1] == '.') --l;
+				}
 			}
+			out_str_(tmp, sch, l);
 		}
 #endif
 
@@ -861,7 +1145,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		basic_format(const char* form) noexcept :
-			form_(form),
+			form_(form), spec_(nullptr), text_(nullptr), spec_num_(0), spec_pos_(0),
 			num_(0),
 			point_(0),
 			bitlen_(0),
@@ -882,7 +1166,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		basic_format(const char* form, char* buff, uint32_t size, bool append = false) noexcept :
-			form_(form),
+			form_(form), spec_(nullptr), text_(nullptr), spec_num_(0), spec_pos_(0),
 			num_(0), point_(0),
 			bitlen_(0),
 			error_(error::none),
@@ -899,6 +1183,53 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（コンパイル時に解析した書式）
+			@param[in]	form	書式（make_form で作った物）
+		*/
+		//-----------------------------------------------------------------//
+		template <uint32_t N>
+		basic_format(const format_form<N>& form) noexcept :
+			form_(nullptr), spec_(form.spec), text_(form.text), spec_num_(form.num), spec_pos_(0),
+			num_(0),
+			point_(0),
+			bitlen_(0),
+			error_(form.valid ? error::none : error::unknown),
+			mode_(mode::NONE), zerosupp_(false), sign_(false), nega_(false)
+		{
+			next_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（コンパイル時に解析した書式）
+			@param[in]	form	書式（make_form で作った物）
+			@param[in]	buff	文字バッファ
+			@param[in]	size	文字バッファサイズ
+			@param[in]	append	文字バッファに追加する場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		template <uint32_t N>
+		basic_format(const format_form<N>& form, char* buff, uint32_t size, bool append = false) noexcept :
+			form_(nullptr), spec_(form.spec), text_(form.text), spec_num_(form.num), spec_pos_(0),
+			num_(0), point_(0),
+			bitlen_(0),
+			error_(form.valid ? error::none : error::unknown),
+			mode_(mode::NONE), zerosupp_(false), sign_(false), nega_(false)
+		{
+			if(!chaout_.set(buff, size)) {
+				error_ = error::out_null;
+			}
+			if(!append) {
+				chaout_.clear();
+
+			}
+			next_();
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  出力ファンクタの参照
@@ -1098,7 +1429,8 @@ namespace utils {
 				}
 #ifndef NO_FLOAT_FORM
 			} else if(std::is_floating_point<T>::value) {
-				if(num_ == 0 && !zerosupp_ && point_ == 0) {
+				if(num_ == 0 && !zerosupp_ && point_ == 0
+					&& mode_ != mode::REAL_AUTO && mode_ != mode::REAL_AUTO_CAPS) {
 					num_ = 6;
 					point_ = 6;
 				}
@@ -0,0 +1,214 @@
+//=====================================================================//
+/*!	@file
+	@brief	format ベンチマーク（ホスト用） @n
+			ログ、UI 表示で使う書式で、１回の整形時間を比べる。@n
+			・以前の方式（実行時に書式を解析、一文字づつ出力） @n
+			・実行時に書式を解析、一括出力（write） @n
+			・コンパイル時に解析した書式（make_form）、一括出力 @n
+			・snprintf @n
+			整形結果は、全ての方式で一致する事を確認する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include "common/format.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	// 一文字づつ出力するメモリー出力（write を持たない、以前の方式）
+	class char_chaout {
+		utils::memory_chaout	out_;
+	public:
+		bool set(char* dst, uint32_t limit) noexcept { return out_.set(dst, limit); }
+		void operator () (char ch) noexcept { out_(ch); }
+		void clear() noexcept { out_.clear(); }
+		uint32_t size() const noexcept { return out_.size(); }
+	};
+	typedef utils::basic_format<char_chaout> cformat;
+
+	static const uint32_t LOOP = 200000;
+
+	char		buff_[256];
+	char		ref_[256];
+	volatile uint32_t	sink_;
+
+	int32_t		hh_ = 12;
+	int32_t		mm_ = 34;
+	int32_t		ss_ = 5;
+	const char*	title_ = "Wish You Were Here";
+	const char*	artist_ = "Pink Floyd";
+	float		volt_ = 3.2987f;
+	uint32_t	words_[4] = { 0xDEADBEEF, 0x00C0FFEE, 0x12345678, 0x0000ABCD };
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	書式毎の整形（実行時、コンパイル時、snprintf）
+	*/
+	//-----------------------------------------------------------------//
+	struct case_t {
+		const char*	name;
+		void (*legacy)(uint32_t);
+		void (*runtime)(uint32_t);
+		void (*form)(uint32_t);
+		void (*printf)(uint32_t);
+	};
+
+
+	// 時刻表示
+	void time_legacy_(uint32_t i) {
+		cformat("Time: %02d:%02d:%02d\n", buff_, sizeof(buff_)) % hh_ % mm_ % (ss_ + static_cast<int32_t>(i & 31));
+	}
+	void time_runtime_(uint32_t i) {
+		utils::sformat("Time: %02d:%02d:%02d\n", buff_, sizeof(buff_)) % hh_ % mm_ % (ss_ + static_cast<int32_t>(i & 31));
+	}
+	void time_form_(uint32_t i) {
+		static constexpr auto form = utils::make_form("Time: %02d:%02d:%02d\n");
+		utils::sformat(form, buff_, sizeof(buff_)) % hh_ % mm_ % (ss_ + static_cast<int32_t>(i & 31));
+	}
+	void time_printf_(uint32_t i) {
+		snprintf(buff_, sizeof(buff_), "Time: %02d:%02d:%02d\n", hh_, mm_, ss_ + static_cast<int32_t>(i & 31));
+	}
+
+
+	// 曲の表示
+	void song_legacy_(uint32_t i) {
+		cformat("%s - %s (%d/%d)\n", buff_, sizeof(buff_)) % title_ % artist_ % (i & 15) % 16;
+	}
+	void song_runtime_(uint32_t i) {
+		utils::sformat("%s - %s (%d/%d)\n", buff_, sizeof(buff_)) % title_ % artist_ % (i & 15) % 16;
+	}
+	void song_form_(uint32_t i) {
+		static constexpr auto form = utils::make_form("%s - %s (%d/%d)\n");
+		utils::sformat(form, buff_, sizeof(buff_)) % title_ % artist_ % (i & 15) % 16;
+	}
+	void song_printf_(uint32_t i) {
+		snprintf(buff_, sizeof(buff_), "%s - %s (%d/%d)\n", title_, artist_, i & 15, 16);
+	}
+
+
+	// 長い文字列と値（ログ）
+	void log_legacy_(uint32_t i) {
+		cformat("SD card: mount state changed, free clusters: %u, retry: %d\n", buff_, sizeof(buff_)) % i % 3;
+	}
+	void log_runtime_(uint32_t i) {
+		utils::sformat("SD card: mount state changed, free clusters: %u, retry: %d\n", buff_, sizeof(buff_)) % i % 3;
+	}
+	void log_form_(uint32_t i) {
+		static constexpr auto form = utils::make_form("SD card: mount state changed, free clusters: %u, retry: %d\n");
+		utils::sformat(form, buff_, sizeof(buff_)) % i % 3;
+	}
+	void log_printf_(uint32_t i) {
+		snprintf(buff_, sizeof(buff_), "SD card: mount state changed, free clusters: %u, retry: %d\n", i, 3);
+	}
+
+
+	// １６進ダンプ
+	void hex_legacy_(uint32_t i) {
+		cformat("%08X %08X %08X %08X\n", buff_, sizeof(buff_)) % words_[0] % words_[1] % words_[2] % (words_[3] + i);
+	}
+	void hex_runtime_(uint32_t i) {
+		utils::sformat("%08X %08X %08X %08X\n", buff_, sizeof(buff_)) % words_[0] % words_[1] % words_[2] % (words_[3] + i);
+	}
+	void hex_form_(uint32_t i) {
+		static constexpr auto form = utils::make_form("%08X %08X %08X %08X\n");
+		utils::sformat(form, buff_, sizeof(buff_)) % words_[0] % words_[1] % words_[2] % (words_[3] + i);
+	}
+	void hex_printf_(uint32_t i) {
+		snprintf(buff_, sizeof(buff_), "%08X %08X %08X %08X\n", words_[0], words_[1], words_[2], words_[3] + i);
+	}
+
+
+	// 浮動小数点と 100% 表記
+	void real_legacy_(uint32_t i) {
+		cformat("ADC: %5.2f V, %d%%\n", buff_, sizeof(buff_)) % volt_ % (i % 101);
+	}
+	void real_runtime_(uint32_t i) {
+		utils::sformat("ADC: %5.2f V, %d%%\n", buff_, sizeof(buff_)) % volt_ % (i % 101);
+	}
+	void real_form_(uint32_t i) {
+		static constexpr auto form = utils::make_form("ADC: %5.2f V, %d%%\n");
+		utils::sformat(form, buff_, sizeof(buff_)) % volt_ % (i % 101);
+	}
+	void real_printf_(uint32_t i) {
+		snprintf(buff_, sizeof(buff_), "ADC: %5.2f V, %d%%\n", volt_, i % 101);
+	}
+
+
+	static const case_t cases_[] = {
+		{ "time  '%02d:%02d:%02d'",      time_legacy_, time_runtime_, time_form_, time_printf_ },
+		{ "song  '%s - %s (%d/%d)'",     song_legacy_, song_runtime_, song_form_, song_printf_ },
+		{ "log   '<50 chars> %u, %d'",   log_legacy_,  log_runtime_,  log_form_,  log_printf_ },
+		{ "hex   '%08X x 4'",            hex_legacy_,  hex_runtime_,  hex_form_,  hex_printf_ },
+		{ "real  '%5.2f V, %d%%'",       real_legacy_, real_runtime_, real_form_, real_printf_ },
+	};
+
+
+	// 3 回計測して、最も速い物
+	double run_(void (*func)(uint32_t))
+	{
+		double t = 0.0;
+		for(uint32_t n = 0; n < 3; ++n) {
+			auto st = bench_usec();
+			for(uint32_t i = 0; i < LOOP; ++i) {
+				func(i);
+				sink_ += buff_[0];
+			}
+			auto d = bench_usec() - st;
+			if(n == 0 || d < t) t = d;
+		}
+		return t * 1e3 / LOOP;
+	}
+
+
+	// 全ての方式で、同じ文字列になる事
+	bool check_(const case_t& c)
+	{
+		bool ok = true;
+		for(uint32_t i = 0; i < 1000; i += 7) {
+			c.printf(i);
+			strcpy(ref_, buff_);
+			void (*funcs[3])(uint32_t) = { c.legacy, c.runtime, c.form };
+			for(auto f : funcs) {
+				memset(buff_, 0, sizeof(buff_));
+				f(i);
+				if(strcmp(ref_, buff_) != 0) {
+					printf("  mismatch: '%s' / '%s'\n", ref_, buff_);
+					ok = false;
+					break;
+				}
+			}
+			if(!ok) break;
+		}
+		return ok;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	// コンパイル時の検査（不明な変換、不完全な「%」はコンパイル・エラーになる）
+	static constexpr auto form = utils::make_form("%-8s|%+5d|%08.3:8y|%%|%b\n");
+	static_assert(form.num == 5, "format_form: spec count");
+	static_assert(form.spec[2].mode == utils::base_format::mode::FIXED_REAL, "format_form: mode");
+	static_assert(form.spec[2].zerosupp && form.spec[2].num == 8 && form.spec[2].point == 3
+		&& form.spec[2].bitlen == 8, "format_form: fixed point");
+//	static constexpr auto bad = utils::make_form("%5.2k\n");	// コンパイル・エラー
+
+	printf("format bench (host, %u loops, ns per call)\n\n", LOOP);
+	printf("  %-28s %9s %9s %9s %9s  %s\n", "case", "legacy", "runtime", "form", "snprintf", "result");
+	for(const auto& c : cases_) {
+		bool ok = check_(c);
+		double tl = run_(c.legacy);
+		double tr = run_(c.runtime);
+		double tf = run_(c.form);
+		double tp = run_(c.printf);
+		printf("  %-28s %9.1f %9.1f %9.1f %9.1f  %s\n", c.name, tl, tr, tf, tp, ok ? "match" : "MISMATCH");
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+# -*- tab-width : 4 -*-
+#=======================================================================
+#   @file
+#   @brief  ホスト（PC）用ベンチマーク、ツールの共通 Makefile @n
+#			各ディレクトリの Makefile で、TARGET、VPATH、CSOURCES、PSOURCES、@n
+#			STDLIBS、OPTLIBS、PINC_APP、CINC_APP、PFLAGS、CFLAGS を設定して @n
+#			include する（POPT、COPT、LFLAGS、CPWARN は、違う場合だけ設定）@n
+#			計時は common/host_bench/timer.c（bench_usec）を CSOURCES に加える。
+#   @author 平松邦仁 (hira@rvf-rc45.net)
+#	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+#				Released under the MIT license @n
+#				https://github.com/hirakuni45/RX/blob/master/LICENSE
+#=======================================================================
+HOST_MK	:=	$(lastword $(MAKEFILE_LIST))
+
+# 'debug' or 'release'
+BUILD	?=	release
+
+INC_P	=	$(addprefix -I, $(PINC_APP))
+INC_C	=	$(addprefix -I, $(CINC_APP))
+CINCS	=	$(INC_C)
+PINCS	=	$(INC_P) $(addprefix -idirafter, $(PINC_AFTER))
+LIBS	=	$(addprefix -L, $(LIBDIR))
+LIBN	=	$(addprefix -l, $(STDLIBS))
+LIBN	+=	$(addprefix -l, $(OPTLIBS))
+
+CP	=	g++
+CC	=	gcc
+LK	=	g++
+
+POPT	?=	-O2 -std=gnu++17
+COPT	?=	-O2
+LFLAGS	?=
+
+ifeq ($(BUILD),debug)
+	POPT += -g
+	COPT += -g
+	PFLAGS += -DDEBUG
+	CFLAGS += -DDEBUG
+endif
+
+ifeq ($(BUILD),release)
+	PFLAGS += -DNDEBUG
+	CFLAGS += -DNDEBUG
+endif
+
+CCWARN	?=	-Wimplicit -Wreturn-type -Wswitch \
+			-Wformat
+CPWARN	?=	-Wall
+
+OBJECTS	=	$(addprefix $(BUILD)/,$(patsubst %.cpp,%.o,$(PSOURCES))) \
+			$(addprefix $(BUILD)/,$(patsubst %.c,%.o,$(CSOURCES)))
+DEPENDS =   $(patsubst %.o,%.d, $(OBJECTS))
+
+.PHONY: all clean
+.SUFFIXES :
+.SUFFIXES : .hpp .h .c .cpp .o
+
+all: $(BUILD) $(TARGET)
+
+$(TARGET): $(OBJECTS) Makefile $(HOST_MK)
+	$(LK) $(LFLAGS) $(LIBS) $(OBJECTS) $(LIBN) -o $(TARGET)
+
+$(BUILD)/%.o : %.c
+	mkdir -p $(dir $@); \
+	$(CC) -c $(COPT) $(CFLAGS) $(CINCS) $(CCWARN) -o $@ $<
+
+$(BUILD)/%.o : %.cpp
+	mkdir -p $(dir $@); \
+	$(CP) -c $(POPT) $(PFLAGS) $(PINCS) $(CPWARN) -o $@ $<
+
+$(BUILD)/%.d : %.c
+	mkdir -p $(dir $@); \
+	$(CC) -MM -DDEPEND_ESCAPE $(COPT) $(CFLAGS) $(CINCS) $< \
+	| sed 's/$(notdir $*)\.o:/$(subst /,\/,$(patsubst %.d,%.o,$@) $@):/' > $@ ; \
+	[ -s $@ ] || rm -f $@
+
+$(BUILD)/%.d : %.cpp
+	mkdir -p $(dir $@); \
+	$(CP) -MM -DDEPEND_ESCAPE $(POPT) $(PFLAGS) $(PINCS) $< \
+	| sed 's/$(notdir $*)\.o:/$(subst /,\/,$(patsubst %.d,%.o,$@) $@):/' > $@ ; \
+	[ -s $@ ] || rm -f $@
+
+clean:
+	rm -rf $(BUILD) $(TARGET)
+
+clean_depend:
+	rm -f $(DEPENDS)
+
+-include $(DEPENDS)
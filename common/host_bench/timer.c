@@ -0,0 +1,20 @@
+//=====================================================================//
+/*!	@file
+	@brief	ホスト用ベンチマークの計時 @n
+			C++ 側は common/time.h を使うので、ホストの time.h はここだけで使う
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "timer.h"
+
+double bench_usec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
@@ -0,0 +1,28 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ホスト用ベンチマークの計時（ヘッダー） @n
+			common/time.h がライブラリーの time.h と置き換わる（struct tm を定義）@n
+			ので、ホストの time.h は timer.c だけで使う
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------//
+/*!
+	@brief	単調増加する時間を取得（CLOCK_MONOTONIC）
+	@return	時間 [us]
+*/
+//-----------------------------------------------------------------//
+double bench_usec(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,7 +27,9 @@
 			+ 2020/01/24 15:15- 浮動小数点オーバーフローした場合のリミッター追加 @n
 			+ 2020/01/24 15:50- 整数変換でオーバーフローが発生したらエラーとする @n
 			+ 2020/01/25 17:33- 特殊制御文字を除外する「\」（バックスラッシュ）機能 @n
-			+ 2020/02/02 19:47- enum error など共有定義を継承
+			+ 2020/02/02 19:47- enum error など共有定義を継承 @n
+			! 2020/12/03 09:40- 浮動小数点の変換を num_conv へ（有効桁を保持して、正確に偶数丸め） @n
+			! 2020/12/03 09:40- 整数のオーバーフロー検査が、4294967290 以上を誤検出する不具合修正
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -37,7 +39,9 @@
 #include <type_traits>
 #include <unistd.h>
 #include <cmath>
+#include <limits>
 #include <string>
+#include "common/num_conv.hpp"
 #if (__cplusplus >= 201703L)
 #include <string_view>
 #endif
@@ -109,7 +113,7 @@ namespace utils {
 	class base_input {
 	public:
 
-		static const uint16_t VERSION = 101;
+		static const uint16_t VERSION = 102;
 
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
@@ -217,11 +221,8 @@ namespace utils {
 			char ch;
 			while((ch = inp_()) != 0) {
 				if(ch >= '0' && ch <= '9') {
-					if(a >= (0xffffffff / 10)) {
+					if(!num_conv::add_digit(a, ch)) {
 						ovf_ = true;
-					} else {
-						a *= 10;
-						a += ch - '0';
 					}
 				} else if(nbc_ != 0 && ch == ' ') {
 					// 文字数指定がある場合「スペース」は '0' と同等に扱う
@@ -319,87 +320,31 @@ namespace utils {
 
 		template<typename T>
 		T real_() {
-
-			struct real_t {
-				uint32_t	a;
-				uint32_t	b;
-				uint32_t	c;
-				bool		sign;
-				bool		p;
-				bool		ovf;
-
-				real_t() : a(0), b(0), c(1), sign(false), p(false), ovf(false) { }
-
-				void set_sign(bool sig = true) {
-					sign = sig;
-				}
-
-				void add(char ch)
-				{
-					if(c >= (0xffffffff / 10)) {
-						if(!p) ovf = true;
-					} else {
-						a *= 10;
-						a += static_cast<uint32_t>(ch - '0');
-						c *= 10;
-					}
-				}
-
-				void point() {
-					b = a;
-					a = 0;
-					c = 1;
-					p = true;
-				}
-
-				T get() const {
-					if(p) {
-						T tmp = static_cast<T>(b) + static_cast<T>(a) / static_cast<T>(c);
-						if(sign) return -tmp;
-						return tmp;
-					} else {
-						T tmp = static_cast<T>(a);
-						if(sign) return -tmp;
-						else return tmp;
-					}				
-				}
-			};
-
-			real_t	base;
-			real_t	exp;
+			num_conv::real_in<T> base;
+			bool sign = false;
 			bool expf = false;
+			bool esign = false;
+			bool edig = false;
+			int32_t exp = 0;
 			char ch;
 			while((ch = inp_()) != 0) {
-				if(ch == '+') {
+				if(ch == '+' || ch == '-') {
 					if(expf) {
-						if(exp.a != 0) break; 
-						exp.set_sign(false);
+						if(edig) break;
+						esign = ch == '-';
 					} else {
-						if(base.a != 0) break;
-						base.set_sign(false);
-					}
-				} else if(ch == '-') {
-					if(expf) {
-						if(exp.a != 0) break; 
-						exp.set_sign();
-					} else {
-						if(base.a != 0) break;
-						base.set_sign();
+						if(base.any()) break;
+						sign = ch == '-';
 					}
 				} else if(ch >= '0' && ch <= '9') {
 					if(expf) {
-						exp.add(ch);
-					} else { 
+						if(exp < 100000) exp = exp * 10 + (ch - '0');
+						edig = true;
+					} else {
 						base.add(ch);
 					}
 				} else if(ch == '.') {
-					if(expf) {
-						if(exp.p) break;
-						exp.point();
-					} else {
-						if(base.p) break;
-						base.point();
-					}
+					if(expf || !base.point()) break;
 				} else if(ch == 'e' || ch == 'E') {
 					if(expf) break;
 					expf = true;
@@ -408,15 +353,14 @@ namespace utils {
 				}
 			}
 
-			if(base.ovf || exp.ovf) {
+			bool ovf = false;
+			T v = base.get(esign ? -exp : exp, ovf);
+			if(ovf) {  // オーバーフローした場合は、最大値に制限
 				ovf_ = true;
+				v = std::numeric_limits<T>::max();
 			}
-
-			if(expf) {
-				return base.get() * pow(static_cast<T>(10), exp.get());
-			} else {
-				return base.get();
-			}
+			if(sign) return -v;
+			else return v;
 		}
 
 
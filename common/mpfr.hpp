@@ -2,7 +2,10 @@
 //=============================================================================//
 /*! @file
     @brief  mpfr ラッパークラス @n
-			GNU gmp, mpfr の C++ ラッパー
+			GNU gmp, mpfr の C++ ラッパー @n
+			・仮数部（limb）は、固定サイズのプールから確保し、malloc を避ける。@n
+			・ムーブに対応し、一時オブジェクトの仮数部は、コピーせずに受け渡す。@n
+			・「a * b + c」等は、式テンプレートで、mpfr_fma 等の１回の丸めで評価する。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -10,24 +13,229 @@
 */
 //=============================================================================//
 #include <cmath>
+#include <utility>
 #include <mpfr.h>
 
 namespace mpfr {
 
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  limb プール（有効桁数毎の、仮数部の固定領域）
+		@param[in]	num		有効桁数（ビット）
+		@param[in]	POOL	プール数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t num, uint32_t POOL>
+	class limb_pool {
+	public:
+		static const uint32_t LIMBS = (num + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+
+	private:
+		static mp_limb_t	limb_[POOL][LIMBS];
+		static uint16_t		free_[POOL];	///< 返却されたスロットのスタック
+		static uint16_t		free_num_;
+		static uint16_t		used_;			///< 一度でも使ったスロット数
+		static uint32_t		miss_;			///< プールが足りなかった回数
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  仮数部を確保
+			@return 確保した領域（プールが空なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		static mp_limb_t* alloc() noexcept
+		{
+			if(free_num_ > 0) {
+				--free_num_;
+				return limb_[free_[free_num_]];
+			} else if(used_ < POOL) {
+				auto p = limb_[used_];
+				++used_;
+				return p;
+			}
+			++miss_;
+			return nullptr;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  仮数部を返却
+			@param[in]	p	領域
+			@return プールの領域でなければ「false」
+		*/
+		//-----------------------------------------------------------------//
+		static bool free(const void* p) noexcept
+		{
+			auto l = static_cast<const mp_limb_t*>(p);
+			if(l < limb_[0] || l >= limb_[POOL]) return false;
+			free_[free_num_] = (l - limb_[0]) / LIMBS;
+			++free_num_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空きスロット数を取得
+			@return 空きスロット数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t get_free() noexcept { return free_num_ + (POOL - used_); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  プールが足りなかった回数を取得
+			@return 回数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t get_miss() noexcept { return miss_; }
+	};
+
+
+	// プール無し（全て mpfr_init2 で確保）
+	template <uint32_t num>
+	class limb_pool<num, 0> {
+	public:
+		static mp_limb_t* alloc() noexcept { return nullptr; }
+		static bool free(const void* p) noexcept { return false; }
+		static uint32_t get_free() noexcept { return 0; }
+		static uint32_t get_miss() noexcept { return 0; }
+	};
+
+	template <uint32_t num, uint32_t POOL> mp_limb_t limb_pool<num, POOL>::limb_[POOL][LIMBS];
+	template <uint32_t num, uint32_t POOL> uint16_t limb_pool<num, POOL>::free_[POOL];
+	template <uint32_t num, uint32_t POOL> uint16_t limb_pool<num, POOL>::free_num_;
+	template <uint32_t num, uint32_t POOL> uint16_t limb_pool<num, POOL>::used_;
+	template <uint32_t num, uint32_t POOL> uint32_t limb_pool<num, POOL>::miss_;
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  乗算の式（a * b）@n
+				評価を代入先まで遅らせ、加減算と組み合わせて mpfr_fma 等にする。@n
+				オペランドを参照で保持するので、「auto」で受けてはならない。
+		@param[in]	VAL		mpfr::value 型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class VAL>
+	struct mul_expr {
+		const VAL&	l_;
+		const VAL&	r_;
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  積和の式（a * b + c、a * b - c、c - a * b）@n
+				代入先に、mpfr_fma、mpfr_fms で直接評価する。
+		@param[in]	VAL		mpfr::value 型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class VAL>
+	struct fma_expr {
+		typedef void expr_tag;
+		mul_expr<VAL>	m_;
+		const VAL&		c_;
+		bool			sub_;	///< a * b - c
+		bool			neg_;	///< 結果の符号を反転（c - a * b）
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  積の和の式（a * b + c * d、a * b - c * d）@n
+				代入先に、mpfr_fmma、mpfr_fmms で直接評価する。
+		@param[in]	VAL		mpfr::value 型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class VAL>
+	struct fmma_expr {
+		typedef void expr_tag;
+		mul_expr<VAL>	a_;
+		mul_expr<VAL>	b_;
+		bool			sub_;
+	};
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  mpfr オブジェクト
 		@param[in]	num		有効桁数
+		@param[in]	POOL	limb プール数（０ならプールを使わない）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <uint32_t num>
+	template <uint32_t num, uint32_t POOL = 32>
 	class value {
 
+		typedef limb_pool<num, POOL> LIMB_POOL;
+		typedef mul_expr<value> MUL;
+		typedef fma_expr<value> FMA;
+		typedef fmma_expr<value> FMMA;
+
 		mpfr_t		t_;
 		mpfr_rnd_t	rnd_;
 
 		static uint32_t ref_count_;
 
+		void init_() noexcept
+		{
+			auto p = LIMB_POOL::alloc();
+			if(p != nullptr) {
+				mpfr_custom_init(p, num);
+				mpfr_custom_init_set(t_, MPFR_NAN_KIND, 0, num, p);
+			} else {
+				mpfr_init2(t_, num);
+			}
+		}
+
+		// ムーブ元は仮数部を持たない（代入すると再確保する）
+		bool empty_() const noexcept { return mpfr_custom_get_significand(t_) == nullptr; }
+
+		void release_() noexcept
+		{
+			if(empty_()) return;
+			if(!LIMB_POOL::free(mpfr_custom_get_significand(t_))) {
+				mpfr_clear(t_);
+			}
+		}
+
+		void steal_(value& th) noexcept
+		{
+			t_[0] = th.t_[0];
+			mpfr_custom_init_set(th.t_, MPFR_NAN_KIND, 0, num, nullptr);
+		}
+
+		void eval_(const MUL& e) noexcept
+		{
+			if(&e.l_ == &e.r_) {
+				mpfr_sqr(t_, e.l_.t_, rnd_);
+			} else {
+				mpfr_mul(t_, e.l_.t_, e.r_.t_, rnd_);
+			}
+		}
+
+		void eval_(const FMA& e) noexcept
+		{
+			if(e.sub_) {
+				mpfr_fms(t_, e.m_.l_.t_, e.m_.r_.t_, e.c_.t_, rnd_);
+			} else {
+				mpfr_fma(t_, e.m_.l_.t_, e.m_.r_.t_, e.c_.t_, rnd_);
+			}
+			if(e.neg_) mpfr_neg(t_, t_, rnd_);
+		}
+
+		void eval_(const FMMA& e) noexcept
+		{
+			if(e.sub_) {
+				mpfr_fmms(t_, e.a_.l_.t_, e.a_.r_.t_, e.b_.l_.t_, e.b_.r_.t_, rnd_);
+			} else {
+				mpfr_fmma(t_, e.a_.l_.t_, e.a_.r_.t_, e.b_.l_.t_, e.b_.r_.t_, rnd_);
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -36,7 +244,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		value(mpfr_rnd_t rnd = MPFR_RNDN) noexcept : t_(), rnd_(rnd) {
-			mpfr_init2(t_, num);
+			init_();
 			++ref_count_;
 		}
 
@@ -49,12 +257,51 @@ namespace mpfr {
 		//-----------------------------------------------------------------//
 		value(const value& t, mpfr_rnd_t rnd = MPFR_RNDN) noexcept : rnd_(rnd)
 		{
-			mpfr_init2(t_, num);
+			init_();
 			mpfr_set(t_, t.t_, rnd_);
 			++ref_count_;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ムーブ・コンストラクター（仮数部を引き継ぐ）
+			@param[in]	t	ムーブ元
+		*/
+		//-----------------------------------------------------------------//
+		value(value&& t) noexcept : rnd_(t.rnd_)
+		{
+			steal_(t);
+			++ref_count_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（式を評価）
+			@param[in]	e	式（MUL、FMA、FMMA）
+		*/
+		//-----------------------------------------------------------------//
+		value(const MUL& e) noexcept : rnd_(e.l_.rnd_)
+		{
+			init_();
+			eval_(e);
+			++ref_count_;
+		}
+		value(const FMA& e) noexcept : rnd_(e.c_.rnd_)
+		{
+			init_();
+			eval_(e);
+			++ref_count_;
+		}
+		value(const FMMA& e) noexcept : rnd_(e.a_.l_.rnd_)
+		{
+			init_();
+			eval_(e);
+			++ref_count_;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  コンストラクター(int)
@@ -63,7 +310,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		explicit value(int iv, mpfr_rnd_t rnd = MPFR_RNDN) noexcept : rnd_(rnd) {
-			mpfr_init2(t_, num);
+			init_();
 			mpfr_set_si(t_, iv, rnd);
 			++ref_count_;
 		}
@@ -77,7 +324,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		explicit value(float iv, mpfr_rnd_t rnd = MPFR_RNDN) noexcept : rnd_(rnd) {
-			mpfr_init2(t_, num);
+			init_();
 			mpfr_set_flt(t_, iv, rnd);
 			++ref_count_;
 		}
@@ -91,7 +338,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		explicit value(double iv, mpfr_rnd_t rnd = MPFR_RNDN) noexcept : rnd_(rnd) {
-			mpfr_init2(t_, num);
+			init_();
 			mpfr_set_d(t_, iv, rnd);
 			++ref_count_;
 		}
@@ -105,7 +352,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		explicit value(const char* iv, mpfr_rnd_t rnd = MPFR_RNDN) noexcept : rnd_(rnd) {
-			mpfr_init2(t_, num);
+			init_();
 			mpfr_set_str(t_, iv, 10, rnd);
 			++ref_count_;
 		}
@@ -117,7 +364,7 @@ namespace mpfr {
 		*/
 		//-----------------------------------------------------------------//
 		~value() {
-			mpfr_clear(t_);
+			release_();
 			--ref_count_;
 			if(ref_count_ == 0) {
 				mpfr_free_cache();
@@ -149,7 +396,7 @@ namespace mpfr {
 			@return 円周率
 		*/
 		//-----------------------------------------------------------------//
-		static const auto get_pi() {
+		static value get_pi() {
 			value tmp;
 			mpfr_const_pi(tmp.t_, tmp.get_rnd());
 			return tmp;
@@ -162,7 +409,7 @@ namespace mpfr {
 			@return ２の自然対数
 		*/
 		//-----------------------------------------------------------------//
-		static const auto get_log2() {
+		static value get_log2() {
 			value tmp;
 			mpfr_const_log2(tmp.t_, tmp.get_rnd());
 			return tmp;
@@ -175,7 +422,7 @@ namespace mpfr {
 			@return Euler数
 		*/
 		//-----------------------------------------------------------------//
-		static const auto get_euler() {
+		static value get_euler() {
 			value tmp;
 			mpfr_const_euler(tmp.t_, tmp.get_rnd());
 			return tmp;
@@ -224,6 +471,7 @@ namespace mpfr {
 
 		void assign(const char* str) noexcept
 		{
+			if(empty_()) init_();
 			mpfr_set_str(t_, str, 10, rnd_);
 		}
 
@@ -244,26 +492,55 @@ namespace mpfr {
 
 
 		value& operator = (const value& th) noexcept {
+			if(empty_()) init_();
 			mpfr_set(t_, th.t_, rnd_);
 			return *this;
 		}
+		value& operator = (value&& th) noexcept {
+			mpfr_swap(t_, th.t_);
+			return *this;
+		}
+		// 式は、代入先に直接評価する（オペランドと同じでも良い）
+		value& operator = (const MUL& e) noexcept {
+			if(empty_()) init_();
+			eval_(e);
+			return *this;
+		}
+		value& operator = (const FMA& e) noexcept {
+			if(empty_()) init_();
+			eval_(e);
+			return *this;
+		}
+		value& operator = (const FMMA& e) noexcept {
+			if(empty_()) init_();
+			eval_(e);
+			return *this;
+		}
 		value& operator = (long v) noexcept {
+			if(empty_()) init_();
 			mpfr_set_si(t_, v, rnd_);
 			return *this;
 		}	
 		value& operator = (double v) noexcept {
+			if(empty_()) init_();
 			mpfr_set_d(t_, v, rnd_);
 			return *this;
 		}
 
 
-		const value operator - () noexcept
+		value operator - () const & noexcept
 		{
-			value tmp(*this);
-			mpfr_neg(tmp.t_, tmp.t_, rnd_);
+			value tmp;
+			mpfr_neg(tmp.t_, t_, rnd_);
 			return tmp;
 		}
 
+		value operator - () && noexcept
+		{
+			mpfr_neg(t_, t_, rnd_);
+			return std::move(*this);
+		}
+
 		value& operator += (const value& th) noexcept
 		{
 			mpfr_add(t_, t_, th.t_, rnd_);
@@ -288,10 +565,73 @@ namespace mpfr {
 			return *this;
 		}
 
-		value operator + (const value& th) const noexcept { return value(*this) += th; }
-		value operator - (const value& th) const noexcept { return value(*this) -= th; }
-		value operator * (const value& th) const noexcept { return value(*this) *= th; }
-		value operator / (const value& th) const noexcept { return value(*this) /= th; }
+		value& operator += (const MUL& e) noexcept
+		{
+			mpfr_fma(t_, e.l_.t_, e.r_.t_, t_, rnd_);
+			return *this;
+		}
+
+		value& operator -= (const MUL& e) noexcept
+		{
+			mpfr_fms(t_, e.l_.t_, e.r_.t_, t_, rnd_);
+			mpfr_neg(t_, t_, rnd_);
+			return *this;
+		}
+
+		// 左辺が一時オブジェクトなら、その仮数部に結果を入れる
+		value operator + (const value& th) const & noexcept {
+			value tmp;
+			mpfr_add(tmp.t_, t_, th.t_, rnd_);
+			return tmp;
+		}
+		value operator - (const value& th) const & noexcept {
+			value tmp;
+			mpfr_sub(tmp.t_, t_, th.t_, rnd_);
+			return tmp;
+		}
+		MUL operator * (const value& th) const & noexcept { return MUL { *this, th }; }
+		value operator / (const value& th) const & noexcept {
+			value tmp;
+			mpfr_div(tmp.t_, t_, th.t_, rnd_);
+			return tmp;
+		}
+		value operator + (const value& th) && noexcept { return std::move(*this += th); }
+		value operator - (const value& th) && noexcept { return std::move(*this -= th); }
+		value operator * (const value& th) && noexcept { return std::move(*this *= th); }
+		value operator / (const value& th) && noexcept { return std::move(*this /= th); }
+
+
+		// 乗算の式と組み合わせた演算（一回の丸め）
+		friend FMA operator + (const MUL& e, const value& c) noexcept { return FMA { e, c, false, false }; }
+		friend FMA operator + (const value& c, const MUL& e) noexcept { return FMA { e, c, false, false }; }
+		friend FMA operator - (const MUL& e, const value& c) noexcept { return FMA { e, c, true, false }; }
+		friend FMA operator - (const value& c, const MUL& e) noexcept { return FMA { e, c, true, true }; }
+		friend FMMA operator + (const MUL& a, const MUL& b) noexcept { return FMMA { a, b, false }; }
+		friend FMMA operator - (const MUL& a, const MUL& b) noexcept { return FMMA { a, b, true }; }
+
+		friend value operator * (const MUL& e, const value& c) noexcept {
+			value tmp(e);
+			tmp *= c;
+			return tmp;
+		}
+		friend value operator / (const MUL& e, const value& c) noexcept {
+			value tmp(e);
+			tmp /= c;
+			return tmp;
+		}
+		friend value operator - (const MUL& e) noexcept { return -value(e); }
+
+		// FMA、FMMA を左辺とする演算は、評価してから行う
+		template <class E, typename = typename E::expr_tag>
+		friend value operator + (const E& e, const value& c) noexcept { return value(e) + c; }
+		template <class E, typename = typename E::expr_tag>
+		friend value operator - (const E& e, const value& c) noexcept { return value(e) - c; }
+		template <class E, typename = typename E::expr_tag>
+		friend value operator * (const E& e, const value& c) noexcept { return value(e) * c; }
+		template <class E, typename = typename E::expr_tag>
+		friend value operator / (const E& e, const value& c) noexcept { return value(e) / c; }
+		template <class E, typename = typename E::expr_tag>
+		friend value operator - (const E& e) noexcept { return -value(e); }
 
 
 		//-----------------------------------------------------------------//
@@ -435,5 +775,5 @@ namespace mpfr {
 	};
 
 	// テンプレート関数、実態の定義
-	template<uint32_t num> uint32_t value<num>::ref_count_;
+	template<uint32_t num, uint32_t POOL> uint32_t value<num, POOL>::ref_count_;
 }
@@ -0,0 +1,551 @@
+//=====================================================================//
+/*!	@file
+	@brief	NMEA パース・テスト、ベンチマーク（ホスト用） @n
+			記録した NMEA ログ（track.nmea、10Hz、20 秒、年越し、経度０度を @n
+			跨ぐ周回、破損したセンテンスを含む）を、一文字づつ解析する。@n
+			・行単位、strtod で解析する参照デコーダーと、公開された測位情報が @n
+			全て一致する事、破損したセンテンスを捨てる事を確認する。@n
+			・以前の方式（行バッファ、文字列で保持、取得時に再解析）と、@n
+			一秒あたりのセンテンス数を比べる。@n
+			使い方： nmea_bench [track.nmea]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "common/nmea_dec.hpp"
+#include "common/input.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	typedef utils::nmea_parse::fix_t fix_t;
+
+	std::vector<char>	log_;
+	uint32_t	error_ = 0;
+	volatile uint32_t	sink_;
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	参照デコーダー（行単位、strtod、mktime_gmt） @n
+				「$」から、CR/LF、又は、次の「$」までを一つのセンテンスとする。
+	*/
+	//-----------------------------------------------------------------//
+	class ref_dec {
+		fix_t		work_;
+		double		work_tod_ = 0.0;
+		bool		dirty_ = false;
+		char		date_[8] = { 0 };
+
+		static bool check_(const std::string& s)
+		{
+			auto p = s.rfind('*');
+			if(p == std::string::npos || (p + 3) != s.size()) return false;
+			uint8_t sum = 0;
+			for(size_t i = 1; i < p; ++i) {
+				if(s[i] < ' ' || s[i] > '~') return false;
+				sum ^= static_cast<uint8_t>(s[i]);
+			}
+			return strtoul(s.substr(p + 1).c_str(), nullptr, 16) == sum
+				&& isxdigit(s[p + 1]) && isxdigit(s[p + 2]);
+		}
+
+		static int32_t latlon_(const std::string& f, const std::string& h)
+		{
+			double v = strtod(f.c_str(), nullptr);
+			double d = floor(v / 100.0);
+			int32_t a = llround((d + (v - d * 100.0) / 60.0) * 1e7);
+			return (h == "S" || h == "W") ? -a : a;
+		}
+
+		static uint32_t x100_(const std::string& f) { return llround(strtod(f.c_str(), nullptr) * 100.0); }
+
+		time_t time_(double tod) const
+		{
+			if(date_[0] == 0) return 0;
+			tm t;
+			memset(&t, 0, sizeof(t));
+			t.tm_mday = (date_[0] - '0') * 10 + (date_[1] - '0');
+			t.tm_mon  = (date_[2] - '0') * 10 + (date_[3] - '0') - 1;
+			t.tm_year = (date_[4] - '0') * 10 + (date_[5] - '0') + 100;
+			return mktime_gmt(&t) + static_cast<time_t>(floor(tod));
+		}
+
+		bool tod_(const std::string& f, double& tod, uint16_t& msec)
+		{
+			if(f.empty()) return false;
+			int h = 0, m = 0;
+			double s = 0.0;
+			sscanf(f.c_str(), "%2d%2d%lf", &h, &m, &s);
+			tod = h * 3600 + m * 60 + floor(s);
+			msec = llround((s - floor(s)) * 1000.0);
+			tod += msec / 1000.0;
+			return true;
+		}
+
+		void publish_(std::vector<fix_t>& out)
+		{
+			out.push_back(work_);
+			dirty_ = false;
+		}
+
+		void sentence_(const std::string& s, std::vector<fix_t>& out)
+		{
+			std::vector<std::string> f;
+			std::string body = s.substr(1, s.rfind('*') - 1);
+			size_t st = 0;
+			while(1) {
+				auto p = body.find(',', st);
+				f.push_back(body.substr(st, p == std::string::npos ? std::string::npos : p - st));
+				if(p == std::string::npos) break;
+				st = p + 1;
+			}
+			f.resize(24);
+			auto tp = f[0].size() >= 3 ? f[0].substr(f[0].size() - 3) : "";
+			auto t = work_;
+			double tod = work_tod_;
+			if(tp == "GGA" || tp == "RMC") {
+				bool rmc = tp == "RMC";
+				tod_(f[1], tod, t.msec);
+				if(!rmc) {
+					if(!f[2].empty()) t.lat = latlon_(f[2], f[3]);
+					if(!f[4].empty()) t.lon = latlon_(f[4], f[5]);
+					t.quality = atoi(f[6].c_str());
+					t.satellites = atoi(f[7].c_str());
+					t.hdop = x100_(f[8]);
+					t.alt = llround(strtod(f[9].c_str(), nullptr) * 100.0);
+				} else {
+					t.valid = f[2] == "A";
+					if(!f[3].empty()) t.lat = latlon_(f[3], f[4]);
+					if(!f[5].empty()) t.lon = latlon_(f[5], f[6]);
+					if(!f[7].empty()) t.speed = llround(strtod(f[7].c_str(), nullptr) * 185.2);
+					if(!f[8].empty()) t.course = x100_(f[8]);
+					if(f[9].size() == 6) strcpy(date_, f[9].c_str());
+				}
+				double day = 0.0;
+				if(!rmc && (tod + 43200.0) < work_tod_) day = 86400.0;  // 日付が変わった GGA
+				t.time = time_(tod);
+				if(t.time != 0) t.time += day;
+				if(dirty_ && tod != work_tod_) publish_(out);
+				work_ = t;
+				work_tod_ = tod;
+				dirty_ = true;
+			} else if(tp == "VTG") {
+				if(!f[1].empty()) t.course = x100_(f[1]);
+				if(!f[7].empty()) t.speed = x100_(f[7]);
+				work_ = t;
+				publish_(out);
+			} else if(tp == "GSA") {
+				t.mode = atoi(f[2].c_str());
+				t.pdop = x100_(f[15]);
+				t.hdop = x100_(f[16]);
+				t.vdop = x100_(f[17]);
+				work_ = t;
+			}
+		}
+
+	public:
+		uint32_t	count_ = 0;
+		uint32_t	error_ = 0;
+
+		void decode(const std::vector<char>& src, std::vector<fix_t>& out)
+		{
+			std::string s;
+			bool in = false;
+			for(auto ch : src) {
+				if(ch == '$' || ch == '\r' || ch == '\n') {
+					if(in) {
+						if(check_(s)) {
+							++count_;
+							sentence_(s, out);
+						} else {
+							++error_;
+						}
+					}
+					in = ch == '$';
+					s = "$";
+				} else if(in) {
+					s += ch;
+				}
+			}
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	以前の方式（行バッファ、GPGGA/GPRMC/GPGSV を文字列で保持し、@n
+				取得時に utils::input で再解析する）
+	*/
+	//-----------------------------------------------------------------//
+	class legacy_dec {
+		uint16_t	pos_ = 0;
+		char		line_[256];
+		char		time_[12] = { 0 };
+		char		lat_[12] = { 0 };
+		char		lon_[12] = { 0 };
+		char		q_[2] = { 0 };
+		char		satellite_[4] = { 0 };
+		char		hq_[4] = { 0 };
+		char		alt_[6] = { 0 };
+		char		date_[8] = { 0 };
+		char		sinfo_[14][4][4];
+
+		static uint16_t word_(const char* src)
+		{
+			const char* top = src;
+			char ch;
+			while((ch = *src++) != 0) {
+				if(ch == ',' || ch == '*') return src - top;
+			}
+			return 0;
+		}
+
+		static void copy_word_(char* dst, const char* src, uint16_t len, uint16_t max)
+		{
+			if(len >= max) len = max - 1;
+			memcpy(dst, src, len);
+			dst[len] = 0;
+		}
+
+		static int32_t get_dec_(const char* t, uint16_t n = 0)
+		{
+			int32_t val = 0;
+			char ch;
+			while((ch = *t++) != 0) {
+				if('0' <= ch && ch <= '9') {
+					val *= 10;
+					val += ch - '0';
+				} else {
+					break;
+				}
+				if(n > 0) {
+					--n;
+					if(n == 0) break;
+				}
+			}
+			return val;
+		}
+
+		bool parse_()
+		{
+			if(line_[0] != '$') return false;
+			if(std::strncmp(&line_[1], "GPGGA,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					if(n == 0) copy_word_(time_, p, l - 1, sizeof(time_));
+					else if(n == 1) copy_word_(lat_, p, l - 1, sizeof(lat_));
+					else if(n == 3) copy_word_(lon_, p, l - 1, sizeof(lon_));
+					else if(n == 5) copy_word_(q_, p, l - 1, sizeof(q_));
+					else if(n == 6) copy_word_(satellite_, p, l - 1, sizeof(satellite_));
+					else if(n == 7) copy_word_(hq_, p, l - 1, sizeof(hq_));
+					else if(n == 8) copy_word_(alt_, p, l - 1, sizeof(alt_));
+					else if(n > 9) break;
+					p += l;
+					++n;
+				}
+			} else if(std::strncmp(&line_[1], "GPRMC,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					if(n == 8) copy_word_(date_, p, l - 1, sizeof(date_));
+					p += l;
+					++n;
+				}
+			} else if(std::strncmp(&line_[1], "GPGSV,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t sidx = 0;
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					if(n == 1) {
+						sidx = get_dec_(p) * 4;
+					} else if(n >= 3) {
+						if(*(p - 1) == '*') break;
+						copy_word_(sinfo_[sidx % 14][(n - 3) % 4], p, l - 1, 4);
+						if((n - 3) % 4 == 3) ++sidx;
+					}
+					p += l;
+					++n;
+				}
+			} else if(std::strncmp(&line_[1], "GPVTG,", 6) == 0) {
+				return true;
+			}
+			return false;
+		}
+
+	public:
+		bool put(char ch)
+		{
+			bool ret = false;
+			if(ch == 0x0d) {
+				line_[pos_] = 0;
+				ret = parse_();
+				pos_ = 0;
+			} else if(ch >= ' ' && ch <= 0x7f) {
+				if(pos_ < (sizeof(line_) - 1)) {
+					line_[pos_] = ch;
+					++pos_;
+				} else {
+					pos_ = 0;
+				}
+			}
+			return ret;
+		}
+
+		time_t get_gmtime() const
+		{
+			if(time_[0] == 0) return 0;
+			tm ts;
+			ts.tm_sec  = get_dec_(&time_[4], 2);
+			ts.tm_min  = get_dec_(&time_[2], 2);
+			ts.tm_hour = get_dec_(&time_[0], 2);
+			ts.tm_mday = get_dec_(&date_[0], 2);
+			ts.tm_mon  = get_dec_(&date_[2], 2) - 1;
+			ts.tm_year = get_dec_(&date_[4], 2) + 100;
+			return mktime_gmt(&ts);
+		}
+
+		static bool conv_latlon(const char* src, int32_t& up, int32_t& dn)
+		{
+			const char* p = strchr(src, '.');
+			if(p == nullptr) return false;
+			if((p - src) < 3) return false;
+			p -= 2;
+			char tmp[8];
+			strncpy(tmp, src, p - src);
+			tmp[p - src] = 0;
+			if(!(utils::input("%d", tmp) % up).status()) return false;
+			tmp[0] = p[0];
+			tmp[1] = p[1];
+			tmp[2] = p[3];
+			tmp[3] = p[4];
+			tmp[4] = p[5];
+			tmp[5] = p[6];
+			tmp[6] = 0;
+			if(!(utils::input("%d", tmp) % dn).status()) return false;
+			dn /= 60;
+			return true;
+		}
+
+		int get_satellite_num() const
+		{
+			int n = 0;
+			utils::input("%d", satellite_) % n;
+			return n;
+		}
+
+		const char* get_lat() const { return lat_; }
+		const char* get_lon() const { return lon_; }
+	};
+
+
+	bool load_(const char* file)
+	{
+		auto fp = fopen(file, "rb");
+		if(fp == nullptr) return false;
+		char tmp[4096];
+		size_t l;
+		while((l = fread(tmp, 1, sizeof(tmp), fp)) > 0) {
+			log_.insert(log_.end(), tmp, tmp + l);
+		}
+		fclose(fp);
+		return true;
+	}
+
+
+	void error_fix_(uint32_t i, const char* name, int64_t ref, int64_t val)
+	{
+		if(error_ < 20) {
+			printf("  fix[%u] %s: %lld / %lld\n", i, name, static_cast<long long>(ref), static_cast<long long>(val));
+		}
+		++error_;
+	}
+
+
+	// 参照デコーダーと比べる
+	void check_(const std::vector<fix_t>& ref, const std::vector<fix_t>& out)
+	{
+		if(ref.size() != out.size()) {
+			printf("  publish count: %u / %u\n", static_cast<uint32_t>(ref.size()), static_cast<uint32_t>(out.size()));
+			++error_;
+		}
+		for(uint32_t i = 0; i < ref.size() && i < out.size(); ++i) {
+			const auto& a = ref[i];
+			const auto& b = out[i];
+			if(a.time != b.time) error_fix_(i, "time", a.time, b.time);
+			if(a.msec != b.msec) error_fix_(i, "msec", a.msec, b.msec);
+			if(a.lat != b.lat) error_fix_(i, "lat", a.lat, b.lat);
+			if(a.lon != b.lon) error_fix_(i, "lon", a.lon, b.lon);
+			if(a.alt != b.alt) error_fix_(i, "alt", a.alt, b.alt);
+			if(a.speed != b.speed) error_fix_(i, "speed", a.speed, b.speed);
+			if(a.course != b.course) error_fix_(i, "course", a.course, b.course);
+			if(a.pdop != b.pdop) error_fix_(i, "pdop", a.pdop, b.pdop);
+			if(a.hdop != b.hdop) error_fix_(i, "hdop", a.hdop, b.hdop);
+			if(a.vdop != b.vdop) error_fix_(i, "vdop", a.vdop, b.vdop);
+			if(a.quality != b.quality) error_fix_(i, "quality", a.quality, b.quality);
+			if(a.mode != b.mode) error_fix_(i, "mode", a.mode, b.mode);
+			if(a.satellites != b.satellites) error_fix_(i, "satellites", a.satellites, b.satellites);
+			if(a.valid != b.valid) error_fix_(i, "valid", a.valid, b.valid);
+		}
+	}
+
+
+	// 一回の計測（１センテンスの時間 [ns]）、速い方を残す
+	template <class FUNC>
+	void run_(uint32_t loop, uint32_t sentence, FUNC func, double& t)
+	{
+		auto st = bench_usec();
+		for(uint32_t i = 0; i < loop; ++i) {
+			func();
+		}
+		auto d = (bench_usec() - st) * 1e3 / (static_cast<double>(loop) * sentence);
+		if(t == 0.0 || d < t) t = d;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* file = argc >= 2 ? argv[1] : "track.nmea";
+	if(!load_(file)) {
+		printf("Can't open: '%s'\n", file);
+		return 1;
+	}
+
+	// 参照デコーダー
+	ref_dec ref;
+	std::vector<fix_t> ref_fix;
+	ref.decode(log_, ref_fix);
+
+	// 一文字づつ解析
+	utils::nmea_parse nmea;
+	std::vector<fix_t> fix;
+	for(auto ch : log_) {
+		if(nmea.put(ch)) {
+			fix_t t;
+			nmea.get_fix(t);
+			fix.push_back(t);
+		}
+	}
+	printf("nmea bench (host, '%s', %u bytes)\n\n", file, static_cast<uint32_t>(log_.size()));
+	printf("  sentence: %u (ref: %u), reject: %u (ref: %u), publish: %u (ref: %u)\n",
+		nmea.get_count(), ref.count_, nmea.get_error(), ref.error_,
+		static_cast<uint32_t>(fix.size()), static_cast<uint32_t>(ref_fix.size()));
+	if(nmea.get_count() != ref.count_ || nmea.get_error() != ref.error_) ++error_;
+	check_(ref_fix, fix);
+
+	// 記録の内容（10Hz、2020/12/31 23:59:50 から 200 エポック、破損したセンテンス５）
+	if(fix.size() != 200 || ref.error_ < 5) ++error_;
+	for(uint32_t i = 0; i < fix.size(); ++i) {
+		time_t t = 1609459190 + i / 10;
+		if(fix[i].time != t || fix[i].msec != (i % 10) * 100) {
+			error_fix_(i, "epoch", t * 1000 + (i % 10) * 100, fix[i].time * 1000 + fix[i].msec);
+		}
+	}
+	{
+		const auto& s = nmea.get_satellite_info(0);
+		const auto& e = nmea.get_satellite_info(9);
+		if(s.no_ != 3 || s.elv_ != 72 || s.azi_ != 352 || s.cn_ != 38
+			|| e.no_ != 31 || e.elv_ != 12 || e.azi_ != 95 || e.cn_ != 0 || nmea.get_iid() != 60) {
+			printf("  satellite info\n");
+			++error_;
+		}
+	}
+	if(!fix.empty()) {
+		const auto& t = fix.back();
+		printf("  last: %u.%03u, %d, %d, %d cm, %u (0.01 km/h), %u (0.01 deg)\n",
+			static_cast<uint32_t>(t.time), t.msec, t.lat, t.lon, t.alt, t.speed, t.course);
+	}
+	printf("  check: %u error(s)\n\n", error_);
+
+	// センテンス数／秒
+	uint32_t sentence = ref.count_ + ref.error_;
+	static const uint32_t LOOP = 20;
+	auto legacy = [] {
+		legacy_dec dec;
+		uint32_t n = 0;
+		for(auto ch : log_) {
+			n += dec.put(ch);
+		}
+		sink_ += n;
+	};
+	auto legacy_get = [] {
+		legacy_dec dec;
+		for(auto ch : log_) {
+			if(dec.put(ch)) {  // 測位毎に、表示で使う情報を取得
+				int32_t up, dn;
+				legacy_dec::conv_latlon(dec.get_lat(), up, dn);
+				sink_ += up + dn;
+				legacy_dec::conv_latlon(dec.get_lon(), up, dn);
+				sink_ += up + dn;
+				sink_ += dec.get_satellite_num() + dec.get_gmtime();
+			}
+		}
+	};
+	auto parse = [] {
+		utils::nmea_parse dec;
+		uint32_t n = 0;
+		for(auto ch : log_) {
+			n += dec.put(ch);
+		}
+		sink_ += n;
+	};
+	auto parse_get = [] {
+		utils::nmea_parse dec;
+		for(auto ch : log_) {
+			if(dec.put(ch)) {
+				fix_t t;
+				dec.get_fix(t);
+				sink_ += t.lat + t.lon + t.satellites + t.time;
+			}
+		}
+	};
+	// 表示（ラップタイマー等）で、毎フレーム読む時間
+	legacy_dec leg;
+	for(auto ch : log_) leg.put(ch);
+	auto read_legacy = [&leg] {
+		int32_t up, dn;
+		legacy_dec::conv_latlon(leg.get_lat(), up, dn);
+		sink_ += up + dn;
+		legacy_dec::conv_latlon(leg.get_lon(), up, dn);
+		sink_ += up + dn;
+		sink_ += leg.get_satellite_num() + leg.get_gmtime();
+	};
+	auto read_fix = [&nmea] {
+		fix_t t;
+		nmea.get_fix(t);
+		sink_ += t.lat + t.lon + t.satellites + t.time;
+	};
+
+	// 交互に 15 回計測して、最も速い物
+	double tl = 0.0, tg = 0.0, tn = 0.0, tf = 0.0, rl = 0.0, rn = 0.0;
+	for(uint32_t n = 0; n < 15; ++n) {
+		run_(LOOP, sentence, legacy, tl);
+		run_(LOOP, sentence, legacy_get, tg);
+		run_(LOOP, sentence, parse, tn);
+		run_(LOOP, sentence, parse_get, tf);
+		run_(LOOP * 1000, 1, read_legacy, rl);
+		run_(LOOP * 1000, 1, read_fix, rn);
+	}
+
+	printf("  %-32s %10s %14s\n", "method", "ns/sent.", "sentences/sec");
+	printf("  %-32s %10.1f %14.0f\n", "legacy (parse)", tl, 1e9 / tl);
+	printf("  %-32s %10.1f %14.0f\n", "legacy (parse + getters/fix)", tg, 1e9 / tg);
+	printf("  %-32s %10.1f %14.0f\n", "nmea_parse (put)", tn, 1e9 / tn);
+	printf("  %-32s %10.1f %14.0f\n", "nmea_parse (put + get_fix/fix)", tf, 1e9 / tf);
+	printf("\n  read lat/lon/satellites/time (ns/call): legacy %.1f, get_fix %.1f\n", rl, rn);
+
+	return error_ == 0 ? 0 : 1;
+}
@@ -3,33 +3,36 @@
 /*!	@file
 	@brief	NMEA デコード・クラス（GPS 測位コードパース）@n
 			for GTPA013 @n
-			初期ボーレートは９６００で行う。
+			初期ボーレートは９６００で行う。@n
+			SCI の受信 FIFO から一文字づつ解析し（行バッファを持たない）、@n
+			チェックサムが正しいセンテンスだけを、型付きの測位情報（fix_t）@n
+			に反映する。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2016, 2019 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2016, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
 #include <cstdint>
-#include <cstring>
+#include <atomic>
 #include "common/time.h"
 #include "common/format.hpp"
-#include "common/input.hpp"
 
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  NMEA デコード・クラス
-		@param[in]	SCI_IO	シリアルＩ／Ｏ
+		@brief  NMEA パース・クラス（SCI を持たない、一文字づつ解析）@n
+				GGA/RMC/VTG/GSA/GSV を解析し、測位情報を更新する。@n
+				トーカー（GP/GN/GL...）は問わない。@n
+				・チェックサム（「*hh」）が無い、又は、一致しないセンテンスは捨てる。@n
+				・同じ測位時刻のセンテンスをまとめ、VTG、又は、測位時刻が @n
+				変わった時に、測位情報を公開する。@n
+				・公開は二重バッファで行い、get_fix は、常に一つの測位時刻の @n
+				揃った情報を返す（割り込み等から読んでも良い）。
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SCI_IO>
-	class nmea_dec {
-
-		static const uint32_t FAST_BAUDRATE = 57600;
-		static const uint32_t UPDATE_FAST_RATE = 10;	///< 10Hz
-
+	class nmea_parse {
 	public:
 		static const uint32_t SINFO_MAX = 14;		///< 衛星情報の最大数
 
@@ -39,392 +42,554 @@ namespace utils {
 		*/
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		struct sat_info {
-			char	no_[4] ;  		///< 衛星番号
-			char	elv_[4];	///< 衛星仰角(Elevation)、０～９０度
-			char	azi_[4];	///< 衛星方位角(Azimuth)、０～３５９度
-			char	cn_[4];		///< キャリア／ノイズ比、０～９９dB
-
-			sat_info() {
-				no_[0] = 0;
-				elv_[0] = 0;
-				azi_[0] = 0;
-				cn_[0] = 0;
-			}
+			uint8_t		no_;	///< 衛星番号
+			uint8_t		elv_;	///< 衛星仰角(Elevation)、０～９０度
+			uint16_t	azi_;	///< 衛星方位角(Azimuth)、０～３５９度
+			uint8_t		cn_;	///< キャリア／ノイズ比、０～９９dB
+
+			sat_info() noexcept : no_(0), elv_(0), azi_(0), cn_(0) { }
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  測位情報 @n
+					緯度、経度は、1e-7 度単位の固定小数点（南緯、西経は負）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct fix_t {
+			time_t		time;		///< 測位時刻（GMT、1970 年からの秒、日付が不明なら０）
+			uint16_t	msec;		///< 測位時刻のミリ秒
+			uint8_t		quality;	///< 品質（GGA、0:無効、1:GPS、2:DGPS ...）
+			uint8_t		mode;		///< 測位モード（GSA、1:無し、2:2D、3:3D）
+			int32_t		lat;		///< 緯度（1e-7 度）
+			int32_t		lon;		///< 経度（1e-7 度）
+			int32_t		alt;		///< 海抜高度（cm）
+			uint32_t	speed;		///< 対地速度（0.01 km/h）
+			uint16_t	course;		///< 進行方向（0.01 度、真北）
+			uint16_t	pdop;		///< 位置精度低下率（x100）
+			uint16_t	hdop;		///< 水平精度低下率（x100）
+			uint16_t	vdop;		///< 垂直精度低下率（x100）
+			uint8_t		satellites;	///< 測位に使っている衛星数
+			bool		valid;		///< RMC のステータスが有効（'A'）
+
+			fix_t() noexcept : time(0), msec(0), quality(0), mode(0), lat(0), lon(0), alt(0),
+				speed(0), course(0), pdop(0), hdop(0), vdop(0), satellites(0), valid(false) { }
 		};
 
 	private:
-		SCI_IO&		sci_;
+		enum class state : uint8_t {
+			IDLE,	///< 「$」待ち
+			ADDR,	///< アドレス（トーカー＋センテンス）
+			BODY,	///< フィールド
+			SUM_H,	///< チェックサム上位
+			SUM_L,	///< チェックサム下位
+		};
 
-		uint16_t	sci_errc_;
+		enum class type : uint8_t {
+			NONE,
+			GGA,
+			RMC,
+			VTG,
+			GSA,
+			GSV,
+		};
 
-		uint16_t	pos_;
-		char		line_[256];
+		static const uint32_t DAY_MSEC = 24 * 60 * 60 * 1000;
 
-		char		time_[12];  // 時間
-		char		lat_[12];   // 緯度(latitude)
-		char		ns_[2];     // 北緯、南緯
-		char		lon_[12];   // 経度(longitude)
-		char		ew_[2];     // 東経、西経
-		char		q_[2];      // 品質
-		char		satellite_[4];  // 衛星数
-		char		hq_[4];		// 水平精度低下率
-		char		alt_[6];	// 海抜高度(Altitude above sea level)
-		char		alt_unit_[2];	// 海抜高度単位
+		// フィールドの処理（センテンス毎、フィールド位置毎）
+		enum class act : uint8_t {
+			NONE, TIME, VALID, LAT, NS, LON, EW, QUALITY, SATS, HDOP, ALT,
+			KNOT, KMH, COURSE, DATE, MODE, PDOP, VDOP, GSV_NO, GSV_SAT,
+		};
 
-		char		date_[8];   // 日付
+		static const uint32_t FIELD_MAX = 19;
+
+		state		state_;
+		type		type_;
+		const act*	acts_;		// センテンスのフィールド処理表
+		uint8_t		xsum_;
+		uint8_t		rsum_;
+		uint8_t		fidx_;
+		uint32_t	addr_;
+
+		// フィールドの数値（整数部、小数部、小数桁数）
+		uint32_t	ival_;
+		uint32_t	frac_;
+		uint8_t		fdig_;
+		uint8_t		flen_;
+		bool		point_;
+		char		ch0_;
+
+		// 解析中のセンテンス（チェックサムが一致したら反映する）
+		fix_t		stage_;
+		uint32_t	stage_tod_;
+		uint32_t	stage_day_;
+		uint8_t		gsv_base_;
+		sat_info	gsv_[4];
+
+		// 反映済み、未公開の測位情報
+		fix_t		work_;
+		uint32_t	work_tod_;		///< 測位時刻（一日のミリ秒）
+		uint32_t	work_day_;		///< 日付（1970 年からの日数、不明なら０）
+		bool		dirty_;
+
+		fix_t		fix_[2];
+		volatile uint32_t	pub_;
 
-		uint16_t	sidx_;
 		sat_info	sinfo_[SINFO_MAX];	// 衛星情報
 
-		uint32_t	id_;
 		uint32_t	iid_;
+		uint32_t	count_;
+		uint32_t	error_;
+
+		static constexpr uint32_t tag_(char a, char b, char c) noexcept
+		{
+			return (static_cast<uint32_t>(a) << 16) | (static_cast<uint32_t>(b) << 8) | static_cast<uint32_t>(c);
+		}
 
-		uint16_t	intr_;
-		uint16_t	update_real_rate_;
-		uint16_t	update_fast_rate_;
-		uint16_t	no_recv_cnt_;
-		uint32_t	baud_real_rate_;
-		uint32_t	baud_fast_rate_;
 
-		static uint16_t word_(const char* src)
+		static uint32_t pow10_(uint32_t n) noexcept
 		{
-			const char* top = src;
-			char ch;
-			while((ch = *src++) != 0) {
-				if(ch == ',' || ch == '*') return src - top;
-			}
-			return 0;
+			static const uint32_t tbl[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+			return tbl[n];
 		}
 
-		static void copy_word_(char* dst, const char* src, uint16_t len)
+
+		// 数値フィールドを、10^n 倍した整数にする（四捨五入）
+		uint32_t scale_(uint32_t n) const noexcept
 		{
-			std::strncpy(dst, src, len);
-			dst[len] = 0;
+			if(fdig_ <= n) return ival_ * pow10_(n) + frac_ * pow10_(n - fdig_);
+			auto d = pow10_(fdig_ - n);
+			return ival_ * pow10_(n) + (frac_ + d / 2) / d;
 		}
 
 
-		static int32_t get_dec_(const char* t, uint16_t n = 0)
+		// dddmm.mmmm を、1e-7 度にする（小数部は７桁まで）
+		uint32_t degree_() const noexcept
 		{
-			int32_t val = 0;
-			char ch;
-			while((ch = *t++) != 0) {
-				if('0' <= ch && ch <= '9') {
-					val *= 10;
-					val += ch - '0';
-				} else {
-					break;
-				}
-				if(n > 0) {
-					--n;
-					if(n == 0) break;
-				}
-			}
-			return val;
+			uint32_t m = (ival_ % 100) * pow10_(fdig_) + frac_;
+			return (ival_ / 100) * 10000000 + (m * pow10_(7 - fdig_) + 30) / 60;
 		}
 
 
-		bool parse_()
+		// hhmmss.sss を、一日のミリ秒にする
+		uint32_t tod_() const noexcept
 		{
-			if(line_[0] != '$') return false;
-
-			if(std::strncmp(&line_[1], "GPGGA,", 6) == 0) {
-				const char* p = &line_[7];
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 0) copy_word_(time_, p, l - 1);
-					else if(n == 1) copy_word_(lat_, p, l - 1);
-					else if(n == 2) copy_word_(ns_, p, l - 1);
-					else if(n == 3) copy_word_(lon_, p, l - 1);
-					else if(n == 4) copy_word_(ew_, p, l - 1);
-					else if(n == 5) copy_word_(q_, p, l - 1);
-					else if(n == 6) copy_word_(satellite_, p, l - 1);
-					else if(n == 7) copy_word_(hq_, p, l - 1);
-					else if(n == 8) copy_word_(alt_, p, l - 1);
-					else if(n == 9) copy_word_(alt_unit_, p, l - 1);
-					else {
-						break;
-					}
-					p += l;
-					++n;
-				}
-			} else if(std::strncmp(&line_[1], "GPRMC,", 6) == 0) {
-				const char* p = &line_[7];
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 8) copy_word_(date_, p, l - 1);
-					p += l;
-					++n;
-				}
-			} else if(std::strncmp(&line_[1], "GPGSV,", 6) == 0) {  // 衛星情報
-				const char* p = &line_[7];
-				uint16_t sidx = 0;
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 1) {
-						char tmp[4];
-						copy_word_(tmp, p, l - 1);
-						sidx = get_dec_(tmp);
-						sidx *= 4;
-					} else if(n >= 3) {
-						if(*(p - 1) == '*') break;
-						auto& t = sinfo_[sidx % SINFO_MAX];
-						auto mod = (n - 3) % 4;
-						if(mod == 0) {
-							copy_word_(t.no_, p, l - 1);
-						} else if(mod == 1) copy_word_(t.elv_, p, l - 1);
-						else if(mod == 2) copy_word_(t.azi_, p, l - 1);
-						else if(mod == 3) {
-							copy_word_(t.cn_, p, l - 1);
-							++sidx;
-						}
-					}
-					p += l;
-					++n;
-				}
-				++iid_;
-			} else if(std::strncmp(&line_[1], "GPVTG,", 6) == 0) {
-				++id_;
-				return true;
-			} else {
-//				utils::format("ND: '%s'\n") % line_;
-			}
-			return false;
+			auto s = (ival_ / 10000) * 3600 + (ival_ / 100 % 100) * 60 + ival_ % 100;
+			auto ms = scale_(3) - ival_ * 1000;
+			return s * 1000 + (ms > 999 ? 999 : ms);
 		}
 
 
-		static uint8_t sum_(const char* str)
+		// ddmmyy を、1970 年からの日数にする（グレゴリオ暦、2000 年代）
+		uint32_t day_() const noexcept
 		{
-			if(*str == '$') ++str;
-			char ch;
-			uint8_t sum = 0;
-			while((ch = *str) != 0) {
-				if(ch == '*') break;
-				sum ^= static_cast<uint8_t>(ch);
-				++str;
-			}
-			return sum;
+			uint32_t d = ival_ / 10000;
+			uint32_t m = ival_ / 100 % 100;
+			uint32_t y = 2000 + ival_ % 100;
+			if(d < 1 || d > 31 || m < 1 || m > 12) return 0;
+			if(m <= 2) --y;
+			uint32_t era = y / 400;
+			uint32_t yoe = y - era * 400;
+			uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+			uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + doe - 719468;
 		}
 
 
-		void init_()
+		static const act* actions_(type t) noexcept
 		{
-			no_recv_cnt_ = 0;
-			sci_.auto_crlf(false);
-			line_[0] = 0;
-			pos_ = 0;
+			typedef act A;
+			static const act tbl[6][FIELD_MAX] = {
+				// NONE
+				{ },
+				// GGA
+				{ A::TIME, A::LAT, A::NS, A::LON, A::EW, A::QUALITY, A::SATS, A::HDOP, A::ALT },
+				// RMC
+				{ A::TIME, A::VALID, A::LAT, A::NS, A::LON, A::EW, A::KNOT, A::COURSE, A::DATE },
+				// VTG
+				{ A::COURSE, A::NONE, A::NONE, A::NONE, A::NONE, A::NONE, A::KMH },
+				// GSA
+				{ A::NONE, A::MODE, A::NONE, A::NONE, A::NONE, A::NONE, A::NONE, A::NONE, A::NONE,
+				  A::NONE, A::NONE, A::NONE, A::NONE, A::NONE, A::PDOP, A::HDOP, A::VDOP },
+				// GSV
+				{ A::NONE, A::GSV_NO, A::NONE,
+				  A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT,
+				  A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT, A::GSV_SAT },
+			};
+			return tbl[static_cast<uint32_t>(t)];
 		}
 
-	public:
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  コンストラクター
-        */
-        //-----------------------------------------------------------------//
-		nmea_dec(SCI_IO& sci) noexcept : sci_(sci), sci_errc_(0), pos_(0), line_{ 0 },
-			time_{ 0 }, lat_{ 0 }, ns_{ 0 }, lon_{ 0 },
-			ew_{ 0 }, q_{ 0 }, satellite_{ 0 }, hq_{ 0 },
-			alt_{ 0 }, alt_unit_{ 0 }, date_{ 0 },
-			sidx_(0), id_(0), iid_(0), intr_(0),
-			update_real_rate_(0), update_fast_rate_(0),
-			no_recv_cnt_(0),
-			baud_real_rate_(0), baud_fast_rate_(0)
-		{ }
 
+		// 処理の有るフィールドだけ（センテンス毎に数個）
+		void field_act_(act a) noexcept __attribute__((noinline))
+		{
+			auto& t = stage_;
+			bool e = flen_ == 0;
+			switch(a) {
+			case act::NONE: break;
+			case act::TIME: if(!e) { stage_tod_ = tod_(); t.msec = stage_tod_ % 1000; } break;
+			case act::VALID: t.valid = ch0_ == 'A'; break;
+			case act::LAT: if(!e) t.lat = degree_(); break;
+			case act::NS: if(ch0_ == 'S') t.lat = -t.lat; break;
+			case act::LON: if(!e) t.lon = degree_(); break;
+			case act::EW: if(ch0_ == 'W') t.lon = -t.lon; break;
+			case act::QUALITY: t.quality = ival_; break;
+			case act::SATS: t.satellites = ival_; break;
+			case act::HDOP: t.hdop = scale_(2); break;
+			case act::ALT: { int32_t a = scale_(2); t.alt = ch0_ == '-' ? -a : a; } break;
+			case act::KNOT: if(!e) t.speed = (scale_(3) * 1852 + 5000) / 10000; break;  // knot -> 0.01 km/h
+			case act::KMH: if(!e) t.speed = scale_(2); break;
+			case act::COURSE: if(!e) t.course = scale_(2); break;
+			case act::DATE: if(!e) { auto d = day_(); if(d != 0) stage_day_ = d; } break;
+			case act::MODE: t.mode = ival_; break;
+			case act::PDOP: t.pdop = scale_(2); break;
+			case act::VDOP: t.vdop = scale_(2); break;
+			case act::GSV_NO: gsv_base_ = ival_ > 0 ? (ival_ - 1) * 4 : 0; break;
+			case act::GSV_SAT:
+				{
+					auto& s = gsv_[(fidx_ - 3) / 4];
+					switch((fidx_ - 3) % 4) {
+					case 0: s.no_ = ival_; break;
+					case 1: s.elv_ = ival_; break;
+					case 2: s.azi_ = ival_; break;
+					case 3: s.cn_ = ival_; break;
+					}
+				}
+				break;
+			}
+		}
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  処理ＩＤを取得
-			@return 処理ＩＤ
-        */
-        //-----------------------------------------------------------------//
-		uint32_t get_id() const noexcept { return id_; }
 
+		void field_() noexcept
+		{
+			if(fidx_ < FIELD_MAX) {
+				auto a = acts_[fidx_];
+				if(a != act::NONE) field_act_(a);
+			}
+			ival_ = 0;
+			frac_ = 0;
+			fdig_ = 0;
+			flen_ = 0;
+			point_ = false;
+			ch0_ = 0;
+		}
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  情報処理ＩＤを取得
-			@return 情報処理ＩＤ
-        */
-        //-----------------------------------------------------------------//
-		uint32_t get_iid() const noexcept { return iid_; }
+
+		void publish_() noexcept
+		{
+			auto n = pub_ + 1;
+			fix_[n & 1] = work_;
+			std::atomic_signal_fence(std::memory_order_release);
+			pub_ = n;
+			dirty_ = false;
+		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  時間を取得 (hhmmss.ss) 000000.00 to 235959.99
-			@return 時間
-        */
-        //-----------------------------------------------------------------//
-		const char* get_time() const noexcept { return time_; }
+		// 測位時刻（日付）を確定し、センテンスを反映する
+		bool commit_() noexcept
+		{
+			++count_;
+			bool ret = false;
+			switch(type_) {
+			case type::GGA:
+			case type::RMC:
+				// RMC の前に日付が変わった GGA は、翌日とする
+				if(type_ == type::GGA && stage_day_ != 0 && (stage_tod_ + DAY_MSEC / 2) < work_tod_) {
+					++stage_day_;
+				}
+				stage_.time = stage_day_ != 0 ? static_cast<time_t>(stage_day_) * 86400 + stage_tod_ / 1000 : 0;
+				if(dirty_ && stage_tod_ != work_tod_) {
+					publish_();
+					ret = true;
+				}
+				work_ = stage_;
+				work_tod_ = stage_tod_;
+				work_day_ = stage_day_;
+				dirty_ = true;
+				break;
+			case type::VTG:
+				work_ = stage_;
+				publish_();
+				ret = true;
+				break;
+			case type::GSA:  // 測位時刻を持たないので、同じエポックに含める
+				work_ = stage_;
+				break;
+			case type::GSV:
+				for(uint32_t i = 0; i < 4; ++i) {
+					sinfo_[(gsv_base_ + i) % SINFO_MAX] = gsv_[i];
+				}
+				++iid_;
+				break;
+			default:
+				break;
+			}
+			return ret;
+		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  日付を取得 (ddmmyy)
-			@return 日付
-        */
-        //-----------------------------------------------------------------//
-		const char* get_date() const noexcept { return date_; }
+		void begin_() noexcept
+		{
+			state_ = state::ADDR;
+			type_ = type::NONE;
+			acts_ = actions_(type::NONE);
+			xsum_ = 0;
+			fidx_ = 0;
+			addr_ = 0;
+			ival_ = 0;
+			frac_ = 0;
+			fdig_ = 0;
+			flen_ = 0;
+			point_ = false;
+			ch0_ = 0;
+		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  GMT 時間「time_t」を取得（グリニッチ標準時間）
-			@return 時間「time_t」
-        */
-        //-----------------------------------------------------------------//
-		time_t get_gmtime() const noexcept {
-			if(time_[0] == 0) {
-				return 0;
+		void type_begin_() noexcept
+		{
+			switch(addr_ & 0xffffff) {
+			case tag_('G', 'G', 'A'): type_ = type::GGA; break;
+			case tag_('R', 'M', 'C'): type_ = type::RMC; break;
+			case tag_('V', 'T', 'G'): type_ = type::VTG; break;
+			case tag_('G', 'S', 'A'): type_ = type::GSA; break;
+			case tag_('G', 'S', 'V'): type_ = type::GSV; break;
+			default: return;
+			}
+			acts_ = actions_(type_);
+			if(type_ == type::GSV) {
+				gsv_base_ = 0;
+				for(auto& s : gsv_) { s = sat_info(); }
+			} else {
+				stage_ = work_;
+				stage_tod_ = work_tod_;
+				stage_day_ = work_day_;
 			}
-			tm ts;
-			ts.tm_sec  = get_dec_(&time_[4], 2);
-			ts.tm_min  = get_dec_(&time_[2], 2);
-			ts.tm_hour = get_dec_(&time_[0], 2);
-			ts.tm_mday = get_dec_(&date_[0], 2);
-			ts.tm_mon  = get_dec_(&date_[2], 2) - 1;
-			ts.tm_year = get_dec_(&date_[4], 2);
-			ts.tm_year += 100;  // 起点１９００年
-			return mktime_gmt(&ts);
 		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  緯度を取得 (dddmm.mmmm)
-			@return 緯度
-        */
-        //-----------------------------------------------------------------//
-		const char* get_lat() const noexcept { return lat_; }
+		static int hex_(char ch) noexcept
+		{
+			if(ch >= '0' && ch <= '9') return ch - '0';
+			else if(ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+			else if(ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+			return -1;
+		}
 
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		nmea_parse() noexcept : state_(state::IDLE), type_(type::NONE), acts_(actions_(type::NONE)), xsum_(0), rsum_(0),
+			fidx_(0), addr_(0), ival_(0), frac_(0), fdig_(0), flen_(0), point_(false), ch0_(0),
+			stage_(), stage_tod_(0), stage_day_(0), gsv_base_(0), gsv_{ },
+			work_(), work_tod_(0), work_day_(0), dirty_(false),
+			fix_{ }, pub_(0), sinfo_{ }, iid_(0), count_(0), error_(0)
+		{ }
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  経度を取得 (dddmm.mmmm)
-			@return 経度
-        */
-        //-----------------------------------------------------------------//
-		const char* get_lon() const noexcept { return lon_; }
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  解析途中のセンテンスを捨てる（次の「$」から解析）
+		*/
+		//-----------------------------------------------------------------//
+		void reset() noexcept { state_ = state::IDLE; }
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  軽度、緯度情報を、google などで使える形式に変換
-			@param[in]	src	ddmm.mmmm 度形式
-			@param[out]	up	ddd 度表記
-			@param[out]	dn	.dddd 度表記
-			@return 成功なら「true」
-        */
-        //-----------------------------------------------------------------//
-		static bool conv_latlon(const char* src, int32_t& up, int32_t& dn) noexcept
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  一文字解析
+			@param[in]	ch	受信文字
+			@return 測位情報を公開したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool put(char ch) noexcept
 		{
-			const char* p = strchr(src, '.');
-			if(p == nullptr) return false;
-			if((p - src) < 3) return false;
-			p -= 2;
-			char tmp[8];
-			strncpy(tmp, src, p - src);
-			tmp[p - src] = 0;
-			if(!(utils::input("%d", tmp) % up).status()) {
+			// フィールドの文字（数字、「,」、「.」、英字等、「*」より後）はインライン展開する
+			auto c = static_cast<uint8_t>(ch);
+			if(state_ == state::BODY && c > '*' && c <= '~') {
+				xsum_ ^= c;
+				uint32_t d = c - '0';
+				if(d < 10) {
+					if(point_) {
+						if(fdig_ < 7) {
+							frac_ = frac_ * 10 + d;
+							++fdig_;
+						}
+					} else if(ival_ < 100000000) {
+						ival_ = ival_ * 10 + d;
+					}
+				} else if(c == ',') {
+					field_();
+					++fidx_;
+					return false;
+				} else {
+					if(c == '.') point_ = true;
+					if(flen_ == 0) ch0_ = ch;
+				}
+				++flen_;
 				return false;
 			}
+			return put_(ch);
+		}
 
-			tmp[0] = p[0];
-			tmp[1] = p[1];
-			tmp[2] = p[3];
-			tmp[3] = p[4];
-			tmp[4] = p[5];
-			tmp[5] = p[6];
-			tmp[6] = 0;
-			if(!(utils::input("%d", tmp) % dn).status()) {
+	private:
+		bool put_(char ch) noexcept __attribute__((noinline))
+		{
+			if(ch == '$') {
+				if(state_ != state::IDLE) ++error_;
+				begin_();
 				return false;
 			}
-			dn /= 60;
-			return true;
+			switch(state_) {
+			case state::IDLE:
+				break;
+			case state::ADDR:
+			case state::BODY:
+				if(ch < ' ' || ch > '~') {  // チェックサムが無い、又は、CTRL コード
+					++error_;
+					state_ = state::IDLE;
+				} else if(ch == '*') {
+					if(state_ == state::BODY) field_();
+					state_ = state::SUM_H;
+				} else {
+					xsum_ ^= static_cast<uint8_t>(ch);
+					if(state_ == state::ADDR) {
+						if(ch == ',') {
+							type_begin_();
+							state_ = state::BODY;
+						} else {
+							addr_ = (addr_ << 8) | static_cast<uint8_t>(ch);
+						}
+					} else {  // 「*」より前の記号（空白等）
+						if(flen_ == 0) ch0_ = ch;
+						++flen_;
+					}
+				}
+				break;
+			case state::SUM_H:
+				{
+					auto h = hex_(ch);
+					if(h < 0) {
+						++error_;
+						state_ = state::IDLE;
+					} else {
+						rsum_ = h << 4;
+						state_ = state::SUM_L;
+					}
+				}
+				break;
+			case state::SUM_L:
+				{
+					state_ = state::IDLE;
+					auto h = hex_(ch);
+					if(h < 0 || (rsum_ | h) != xsum_) {
+						++error_;
+					} else {
+						return commit_();
+					}
+				}
+				break;
+			}
+			return false;
 		}
 
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  軽度、緯度情報を、google などで使える形式に変換
-			@param[in]	src	ddmm.mmmm 度形式
-			@param[out]	dst	ddd.dddd 度表記
-			@param[in]	len	dst のサイズ
-			@return 成功なら「true」
-        */
-        //-----------------------------------------------------------------//
-		static bool conv_latlon(const char* src, char* dst, uint32_t len) noexcept
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  最新の測位情報を取得 @n
+					公開中に呼ばれても、一つの測位時刻の情報を返す。
+			@param[out]	fix	測位情報
+			@return 公開番号（get_id と同じ）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_fix(fix_t& fix) const noexcept
 		{
-			if(src == nullptr || dst == nullptr || len < 8) return false;
-
-			int32_t up = 0;
-			int32_t dn = 0;
-			auto ret = conv_latlon(src, up, dn);
-			utils::sformat("%d.%d", dst, len) % up % dn;
-			return ret;
+			uint32_t n;
+			do {
+				n = pub_;
+				std::atomic_signal_fence(std::memory_order_acquire);
+				fix = fix_[n & 1];
+				std::atomic_signal_fence(std::memory_order_acquire);
+			} while(n != pub_);
+			return n;
 		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  品質を取得
-			@return 品質
-        */
-        //-----------------------------------------------------------------//
-		const char* get_quality() const noexcept { return q_; }
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  処理ＩＤ（測位情報の公開数）を取得
+			@return 処理ＩＤ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_id() const noexcept { return pub_; }
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  衛星数を取得
-			@return 衛星数
-        */
-        //-----------------------------------------------------------------//
-		int get_satellite_num() const noexcept
-		{
-			int n = 0;
-			utils::input("%d", satellite_) % n;
-			return n;
-		}
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  情報処理ＩＤ（GSV の数）を取得
+			@return 情報処理ＩＤ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_iid() const noexcept { return iid_; }
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  水平品質を取得
-			@return 水平品質
-        */
-        //-----------------------------------------------------------------//
-		const char* get_holizontal_quality() const noexcept { return hq_; }
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  受理したセンテンス数を取得
+			@return センテンス数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_count() const noexcept { return count_; }
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  海抜高度を取得
-			@return 海抜高度
-        */
-        //-----------------------------------------------------------------//
-		const char* get_altitude() const noexcept { return alt_; }
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  捨てたセンテンス数（チェックサム・エラー等）を取得
+			@return エラー数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_error() const noexcept { return error_; }
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  海抜高度単位を取得
-			@return 海抜高度単位
-        */
-        //-----------------------------------------------------------------//
-		const char* get_altitude_unit() const noexcept { return alt_unit_; }
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  GMT 時間「time_t」を取得（グリニッチ標準時間）
+			@return 時間「time_t」（日付が不明なら０）
+		*/
+		//-----------------------------------------------------------------//
+		time_t get_gmtime() const noexcept
+		{
+			fix_t t;
+			get_fix(t);
+			return t.time;
+		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  衛星情報の取得
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  衛星数を取得
+			@return 衛星数
+		*/
+		//-----------------------------------------------------------------//
+		int get_satellite_num() const noexcept
+		{
+			fix_t t;
+			get_fix(t);
+			return t.satellites;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  衛星情報の取得
 			@param[in]	idx	衛星インデックス
 			@return 衛星情報
-        */
-        //-----------------------------------------------------------------//
+		*/
+		//-----------------------------------------------------------------//
 		const sat_info& get_satellite_info(uint16_t idx) const noexcept
 		{
 			if(idx < SINFO_MAX) {
@@ -436,28 +601,85 @@ namespace utils {
 		}
 
 
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  GPS 情報の表示
-        */
-        //-----------------------------------------------------------------//
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  GPS 情報の表示
+		*/
+		//-----------------------------------------------------------------//
 		void list_all() const noexcept
 		{
-			utils::format("ID: %d, IID: %d %s %s\n")
-				% get_id() % get_iid() % get_date() % get_time();
-			char lat[10];
-			if(!conv_latlon(get_lat(), lat, sizeof(lat))) {
-				return;
-			}
-			char lon[10];
-			if(!conv_latlon(get_lon(), lon, sizeof(lon))) {
-				return;
+			fix_t t;
+			auto id = get_fix(t);
+			utils::format("ID: %u, IID: %u, T: %u.%03u\n")
+				% id % get_iid() % static_cast<uint32_t>(t.time) % t.msec;
+			auto lat = t.lat < 0 ? -t.lat : t.lat;
+			auto lon = t.lon < 0 ? -t.lon : t.lon;
+			utils::format("(%u)LatLon: %s%u.%07u,%s%u.%07u (%d cm)\n")
+				% static_cast<uint32_t>(t.satellites)
+				% (t.lat < 0 ? "-" : "") % static_cast<uint32_t>(lat / 10000000) % static_cast<uint32_t>(lat % 10000000)
+				% (t.lon < 0 ? "-" : "") % static_cast<uint32_t>(lon / 10000000) % static_cast<uint32_t>(lon % 10000000)
+				% t.alt;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  NMEA デコード・クラス
+		@param[in]	SCI_IO	シリアルＩ／Ｏ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class SCI_IO>
+	class nmea_dec : public nmea_parse {
+
+		static const uint32_t FAST_BAUDRATE = 57600;
+		static const uint32_t UPDATE_FAST_RATE = 10;	///< 10Hz
+
+		SCI_IO&		sci_;
+
+		uint16_t	sci_errc_;
+
+		uint16_t	intr_;
+		uint16_t	update_real_rate_;
+		uint16_t	update_fast_rate_;
+		uint16_t	no_recv_cnt_;
+		uint32_t	baud_real_rate_;
+		uint32_t	baud_fast_rate_;
+
+		static uint8_t sum_(const char* str)
+		{
+			if(*str == '$') ++str;
+			char ch;
+			uint8_t sum = 0;
+			while((ch = *str) != 0) {
+				if(ch == '*') break;
+				sum ^= static_cast<uint8_t>(ch);
+				++str;
 			}
-			utils::format("(%d)LatLon: %s,%s (%s m)\n")
-				% get_satellite_num() % lat % lon % get_altitude();
+			return sum;
 		}
 
 
+		void init_()
+		{
+			no_recv_cnt_ = 0;
+			sci_.auto_crlf(false);
+			reset();
+		}
+
+	public:
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  コンストラクター
+        */
+        //-----------------------------------------------------------------//
+		nmea_dec(SCI_IO& sci) noexcept : nmea_parse(), sci_(sci), sci_errc_(0),
+			intr_(0), update_real_rate_(0), update_fast_rate_(0),
+			no_recv_cnt_(0),
+			baud_real_rate_(0), baud_fast_rate_(0)
+		{ }
+
+
         //-----------------------------------------------------------------//
         /*!
             @brief  スタート @n
@@ -484,8 +706,9 @@ namespace utils {
         //-----------------------------------------------------------------//
         /*!
             @brief  サービス @n
-					情報量に応じて呼ぶ（通常毎フレーム呼ぶ）
-			@return 更新されたら「true」
+					情報量に応じて呼ぶ（通常毎フレーム呼ぶ）@n
+					受信 FIFO の文字を、そのまま解析する。
+			@return 測位情報を公開したら「true」
         */
         //-----------------------------------------------------------------//
 		bool service() noexcept
@@ -494,6 +717,7 @@ namespace utils {
 			if(errc != sci_errc_) {
 				sci_errc_ = errc;
 				sci_.flush_recv();
+				reset();
 				++no_recv_cnt_;
 				if(no_recv_cnt_ >= (60 * 5)) {  // ５秒間受信が無い場合、ボーレートを変更
 					if(baud_real_rate_ == 9600) {  // 9600 で通信出来てないので、高速になってるかも
@@ -515,21 +739,7 @@ namespace utils {
 			}
 			no_recv_cnt_ = 0;
 			while(len > 0) {
-				auto ch = sci_.getch();
-				if(ch == 0x0d) {
-					line_[pos_] = 0;
-					ret = parse_();
-					pos_ = 0;
-				} else {
-					if(ch >= ' ' && ch <= 0x7f) {  // CTRL コードは無視する。
-						if(pos_ < (sizeof(line_) - 1)) {
-							line_[pos_] = ch;
-							++pos_;
-						} else {
-							pos_ = 0;
-						}
-					}
-				}
+				if(put(sci_.getch())) ret = true;
 				--len;
 			}
 			if(ret && baud_real_rate_ == baud_fast_rate_) {  // fast rate なら、10Hz にする。
@@ -663,6 +873,8 @@ namespace utils {
 #define PGCMD_ANTENNA "$PGCMD,33,1*6C" 
 #define PGCMD_NOANTENNA "$PGCMD,33,0*6D" 
 
+#endif
+/*
 // センテンス例：
 $GPGSV,3,1,12,26,72,352,28,05,65,066,37,15,50,268,35,27,33,189,37*7F
  単語例 	説明 	意味
@@ -686,6 +898,6 @@ $GPGSV,3,1,12,26,72,352,28,05,65,066,37,15,50,268,35,27,33,189,37*7F
 189 	衛星方位角。000～359度 	衛星方位角：189度
 37 	C/No（キャリア／ノイズ比）。00～99dB 	C/No：37dB
 *7F 	チェックサム 	チェックサム値：7F
-#endif
+*/
 	};
 }
@@ -0,0 +1,1005 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	数値変換（整数、浮動小数点 <-> 十進文字列） @n
+			format、input で共有する変換エンジン @n
+			・整数：２桁づつテーブルを引いて十進変換 @n
+			・float：最短で元の値に戻る十進表記（Ryu 方式） @n
+			・float：桁数指定の十進表記（%f、%e 用、正確に偶数丸め） @n
+			・十進文字列から float、double への変換（正確に偶数丸め） @n
+			浮動小数点は、整数演算だけで変換する（double の演算を使わない）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace utils {
+
+	namespace num_detail {
+
+		//=================================================================//
+		/*!
+			@brief	Ryu（float）の 5^i テーブル（コンパイル時に生成）
+		*/
+		//=================================================================//
+		struct pow5_tbl {
+			static constexpr int32_t INV_BITCOUNT = 59;
+			static constexpr int32_t BITCOUNT = 61;
+
+			uint64_t	inv[31];	///< floor(2^(pow5bits(i) - 1 + 59) / 5^i) + 1
+			uint64_t	pos[47];	///< 5^i の上位 61 ビット
+
+			static constexpr uint32_t bitlen_(uint64_t hi, uint64_t lo) noexcept {
+				uint32_t n = 0;
+				while(hi != 0) { hi >>= 1; ++n; }
+				if(n > 0) return n + 64;
+				while(lo != 0) { lo >>= 1; ++n; }
+				return n;
+			}
+
+			constexpr pow5_tbl() noexcept : inv(), pos() {
+				uint64_t hi = 0;
+				uint64_t lo = 1;
+				for(uint32_t i = 0; i < 47; ++i) {
+					auto bl = bitlen_(hi, lo);
+					// 上位 61 ビット
+					uint64_t h = hi;
+					uint64_t l = lo;
+					if(bl > 61) {
+						for(uint32_t j = 0; j < (bl - 61); ++j) {
+							l = (l >> 1) | (h << 63);
+							h >>= 1;
+						}
+					} else {
+						l <<= (61 - bl);
+					}
+					pos[i] = l;
+					if(i < 31) {  // 2^(bl - 1 + 59) / 5^i（１ビットづつの割り算）
+						uint64_t rh = 0;
+						uint64_t rl = 0;
+						uint64_t q = 0;
+						for(int32_t b = bl - 1 + INV_BITCOUNT; b >= 0; --b) {
+							rh = (rh << 1) | (rl >> 63);
+							rl = (rl << 1) | (b == static_cast<int32_t>(bl - 1 + INV_BITCOUNT) ? 1 : 0);
+							q <<= 1;
+							if(rh > hi || (rh == hi && rl >= lo)) {
+								uint64_t t = rl - lo;
+								rh = rh - hi - (rl < lo ? 1 : 0);
+								rl = t;
+								q |= 1;
+							}
+						}
+						inv[i] = q + 1;
+					}
+					// × 5
+					uint64_t l4 = lo << 2;
+					uint64_t h4 = (hi << 2) | (lo >> 62);
+					uint64_t nl = l4 + lo;
+					hi = h4 + hi + (nl < l4 ? 1 : 0);
+					lo = nl;
+				}
+			}
+		};
+
+		//=================================================================//
+		/*!
+			@brief	浮動小数点の形式（大きさで選ぶ、RX の 32 ビット double は float）
+		*/
+		//=================================================================//
+		template <uint32_t S> struct real_fmt;
+
+		template <uint32_t S, uint32_t MB, int32_t EMIN, uint32_t DIG, int32_t MAX10, int32_t ZERO10,
+			uint32_t FAST>
+		struct real_base {
+			static constexpr uint32_t MANT = MB;		///< 仮数部ビット数（隠れビットを含む）
+			static constexpr int32_t LSB_MIN = EMIN - static_cast<int32_t>(MB) + 1;	///< 非正規化数の LSB
+			static constexpr uint32_t DIGITS = DIG;		///< 正確に扱う有効桁数（以降は有無だけ）
+			static constexpr int32_t OVER10 = MAX10;	///< 十進の桁位置がこれ以上なら無限大
+			static constexpr int32_t UNDER10 = ZERO10;	///< 十進の桁位置がこれ以下なら０
+			static constexpr uint32_t FAST_EXP = FAST;	///< 演算が１回で済む 10 の指数
+			static constexpr uint32_t WORDS = ((DIG * 3322 / 1000) + (-ZERO10 * 2322 / 1000) + MB + 96) / 32;
+		};
+
+		template <> struct real_fmt<4> : public real_base<4, 24, -126, 120, 40, -46, 10> {
+			typedef uint32_t bits_t;
+			static constexpr bits_t INF = 0x7f800000;
+		};
+
+		template <> struct real_fmt<8> : public real_base<8, 53, -1022, 800, 310, -324, 22> {
+			typedef uint64_t bits_t;
+			static constexpr bits_t INF = 0x7ff0000000000000ULL;
+		};
+
+	}
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  数値変換クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct num_conv {
+
+		static constexpr uint32_t REAL_DIGITS_MAX = 40;	///< %f、%e で正確に変換する小数部の最大桁数
+		static constexpr uint32_t REAL_BUFF_SIZE = 88;	///< fixed、exponent の出力に必要な大きさ
+
+	private:
+		// "00" ～ "99"
+		static constexpr char pair_[201] = {
+			"0001020304050607080910111213141516171819"
+			"2021222324252627282930313233343536373839"
+			"4041424344454647484950515253545556575859"
+			"6061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899"
+		};
+
+		static constexpr uint64_t pow10_[20] = {
+			1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+			100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+			1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+			1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+			1000000000000000000ULL, 10000000000000000000ULL
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief	多倍長整数（符号無し、固定長）
+			@param[in]	W	32 ビットのワード数
+		*/
+		//=================================================================//
+		template <uint32_t W>
+		struct big_t {
+			uint32_t	w[W];
+			uint32_t	n;		///< 使用ワード数
+
+			void set(uint64_t v) noexcept {
+				w[0] = static_cast<uint32_t>(v);
+				w[1] = static_cast<uint32_t>(v >> 32);
+				n = w[1] != 0 ? 2 : (w[0] != 0 ? 1 : 0);
+			}
+
+			bool zero() const noexcept { return n == 0; }
+
+			// this = this * m + a
+			void mul(uint32_t m, uint32_t a = 0) noexcept {
+				uint64_t c = a;
+				for(uint32_t i = 0; i < n; ++i) {
+					c += static_cast<uint64_t>(w[i]) * m;
+					w[i] = static_cast<uint32_t>(c);
+					c >>= 32;
+				}
+				if(c != 0 && n < W) w[n++] = static_cast<uint32_t>(c);
+			}
+
+			void mul_pow5(uint32_t e) noexcept {
+				while(e >= 13) {
+					mul(1220703125);  // 5^13
+					e -= 13;
+				}
+				if(e > 0) mul(static_cast<uint32_t>(pow10_[e] >> e));
+			}
+
+			void shl(uint32_t s) noexcept {
+				if(n == 0) return;
+				uint32_t ws = s / 32;
+				uint32_t bs = s % 32;
+				if((n + ws + 1) > W) return;
+				w[n + ws] = 0;
+				for(int32_t i = n - 1; i >= 0; --i) {
+					uint32_t v = w[i];
+					if(bs != 0) {
+						w[i + ws + 1] |= v >> (32 - bs);
+						v <<= bs;
+					}
+					w[i + ws] = v;
+				}
+				for(uint32_t i = 0; i < ws; ++i) w[i] = 0;
+				n += ws + 1;
+				while(n > 0 && w[n - 1] == 0) --n;
+			}
+
+			void shr(uint32_t s) noexcept {
+				uint32_t ws = s / 32;
+				uint32_t bs = s % 32;
+				if(ws >= n) { n = 0; return; }
+				for(uint32_t i = 0; i < (n - ws); ++i) {
+					uint32_t v = w[i + ws] >> bs;
+					if(bs != 0 && (i + ws + 1) < n) v |= w[i + ws + 1] << (32 - bs);
+					w[i] = v;
+				}
+				n -= ws;
+				while(n > 0 && w[n - 1] == 0) --n;
+			}
+
+			uint32_t bits() const noexcept {
+				if(n == 0) return 0;
+				return (n - 1) * 32 + (32 - __builtin_clz(w[n - 1]));
+			}
+
+			bool bit(uint32_t pos) const noexcept {
+				if((pos / 32) >= n) return false;
+				return (w[pos / 32] >> (pos % 32)) & 1;
+			}
+
+			// 下位 s ビットに１がある
+			bool any(uint32_t s) const noexcept {
+				uint32_t ws = s / 32;
+				for(uint32_t i = 0; i < ws && i < n; ++i) {
+					if(w[i] != 0) return true;
+				}
+				if(ws < n && (s % 32) != 0) {
+					return (w[ws] & ((1u << (s % 32)) - 1)) != 0;
+				}
+				return false;
+			}
+
+			// 上位 64 ビット（pos から下）
+			uint64_t top64(uint32_t pos) const noexcept {
+				uint64_t v = 0;
+				for(uint32_t i = 0; i < 64; ++i) {
+					v <<= 1;
+					if(pos > i && bit(pos - 1 - i)) v |= 1;
+				}
+				return v;
+			}
+
+			static int32_t cmp(const big_t& a, const big_t& b) noexcept {
+				if(a.n != b.n) return a.n > b.n ? 1 : -1;
+				for(int32_t i = a.n - 1; i >= 0; --i) {
+					if(a.w[i] != b.w[i]) return a.w[i] > b.w[i] ? 1 : -1;
+				}
+				return 0;
+			}
+
+			// this -= b（this >= b）
+			void sub(const big_t& b) noexcept {
+				uint32_t brw = 0;
+				for(uint32_t i = 0; i < n; ++i) {
+					uint64_t t = static_cast<uint64_t>(w[i]) - (i < b.n ? b.w[i] : 0) - brw;
+					w[i] = static_cast<uint32_t>(t);
+					brw = (t >> 32) & 1;
+				}
+				while(n > 0 && w[n - 1] == 0) --n;
+			}
+
+			// this /= d、余りを返す
+			uint32_t div(uint32_t d) noexcept {
+				uint64_t r = 0;
+				for(int32_t i = n - 1; i >= 0; --i) {
+					r = (r << 32) | w[i];
+					w[i] = static_cast<uint32_t>(r / d);
+					r %= d;
+				}
+				while(n > 0 && w[n - 1] == 0) --n;
+				return static_cast<uint32_t>(r);
+			}
+		};
+
+
+		static constexpr num_detail::pow5_tbl pow5_ = num_detail::pow5_tbl();
+
+		static constexpr int32_t pow5bits_(int32_t e) noexcept {
+			return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+		}
+
+		static constexpr uint32_t log10pow2_(int32_t e) noexcept {
+			return (static_cast<uint32_t>(e) * 78913) >> 18;
+		}
+
+		static constexpr uint32_t log10pow5_(int32_t e) noexcept {
+			return (static_cast<uint32_t>(e) * 732923) >> 20;
+		}
+
+		static uint32_t pow5factor_(uint32_t v) noexcept {
+			uint32_t n = 0;
+			while((v % 5) == 0) {
+				v /= 5;
+				++n;
+			}
+			return n;
+		}
+
+		static uint32_t mul_shift_(uint32_t m, uint64_t f, int32_t shift) noexcept {
+			uint64_t b0 = static_cast<uint64_t>(m) * static_cast<uint32_t>(f);
+			uint64_t b1 = static_cast<uint64_t>(m) * static_cast<uint32_t>(f >> 32);
+			uint64_t sum = (b0 >> 32) + b1;
+			return static_cast<uint32_t>(sum >> (shift - 32));
+		}
+
+
+		static uint32_t bitlen64_(uint64_t v) noexcept {
+			if(v == 0) return 0;
+			return 64 - __builtin_clzll(v);
+		}
+
+
+		// q × 2^e（sticky：端数あり）を偶数丸めしたビット列
+		template <class FMT>
+		static typename FMT::bits_t round_(uint64_t q, int32_t e, bool sticky, bool& ovf) noexcept
+		{
+			typedef typename FMT::bits_t bits_t;
+			if(q == 0) return 0;
+			int32_t lead = e + static_cast<int32_t>(bitlen64_(q)) - 1;
+			int32_t lsb = lead - static_cast<int32_t>(FMT::MANT) + 1;
+			if(lsb < FMT::LSB_MIN) lsb = FMT::LSB_MIN;
+			int32_t sh = lsb - e;
+			uint64_t r;
+			if(sh > 64) {
+				r = 0;
+			} else if(sh > 0) {
+				r = sh == 64 ? 0 : (q >> sh);
+				uint64_t rem = sh == 64 ? q : (q & ((static_cast<uint64_t>(1) << sh) - 1));
+				uint64_t half = static_cast<uint64_t>(1) << (sh - 1);
+				if(rem > half || (rem == half && (sticky || (r & 1) != 0))) ++r;
+			} else {
+				r = q << -sh;
+			}
+			uint64_t bits = r + (static_cast<uint64_t>(lsb - FMT::LSB_MIN) << (FMT::MANT - 1));
+			if(bits >= FMT::INF) {
+				ovf = true;
+				return FMT::INF;
+			}
+			return static_cast<bits_t>(bits);
+		}
+
+
+		// 十進の有効数字 × 10^e（sticky：以降に０以外の桁あり）を浮動小数点へ
+		template <typename T>
+		static T make_real_(const char* dig, uint32_t n, int32_t e, bool sticky, bool& ovf) noexcept
+		{
+			typedef num_detail::real_fmt<sizeof(T)> FMT;
+			typedef typename FMT::bits_t bits_t;
+
+			while(n > 0 && dig[n - 1] == '0') {
+				--n;
+				++e;
+			}
+			T v = 0;
+			if(n == 0) return v;
+			int32_t dexp = static_cast<int32_t>(n) + e;
+			if(dexp >= FMT::OVER10) {
+				ovf = true;
+				bits_t b = FMT::INF;
+				std::memcpy(&v, &b, sizeof(T));
+				return v;
+			}
+			if(dexp <= FMT::UNDER10) return v;
+
+			// 演算が１回で正確に丸められる場合
+			if(n <= 19 && !sticky) {
+				uint64_t w = 0;
+				for(uint32_t i = 0; i < n; ++i) w = w * 10 + (dig[i] - '0');
+				if(w <= (static_cast<uint64_t>(1) << FMT::MANT)) {
+					if(e == 0) {
+						return static_cast<T>(w);
+					} else if(e > 0 && e <= static_cast<int32_t>(FMT::FAST_EXP)) {
+						return static_cast<T>(w) * static_cast<T>(pow10_real_[e]);
+					} else if(e < 0 && -e <= static_cast<int32_t>(FMT::FAST_EXP)) {
+						return static_cast<T>(w) / static_cast<T>(pow10_real_[-e]);
+					}
+				}
+			}
+
+			typedef big_t<FMT::WORDS> big;
+			big a;
+			a.set(0);
+			uint32_t i = 0;
+			while(i < n) {
+				uint32_t c = 0;
+				uint32_t k = 0;
+				while(k < 9 && i < n) {
+					c = c * 10 + (dig[i] - '0');
+					++k;
+					++i;
+				}
+				a.mul(static_cast<uint32_t>(pow10_[k]), c);
+			}
+
+			uint64_t q;
+			int32_t e2;
+			if(e >= 0) {  // a × 5^e × 2^e
+				a.mul_pow5(e);
+				uint32_t bl = a.bits();
+				if(bl <= 64) {
+					q = a.top64(64);
+					e2 = e;
+				} else {
+					q = a.top64(bl);
+					sticky |= a.any(bl - 64);
+					e2 = e + static_cast<int32_t>(bl) - 64;
+				}
+			} else {  // a / 5^-e × 2^e
+				big d;
+				d.set(1);
+				d.mul_pow5(-e);
+				int32_t s = static_cast<int32_t>(d.bits()) - static_cast<int32_t>(a.bits())
+					+ static_cast<int32_t>(FMT::MANT) + 2;
+				if(s > 0) a.shl(s);
+				else if(s < 0) d.shl(-s);
+				int32_t qb = static_cast<int32_t>(a.bits()) - static_cast<int32_t>(d.bits());
+				q = 0;
+				if(qb >= 0) {
+					d.shl(qb);
+					for(int32_t b = qb; b >= 0; --b) {
+						q <<= 1;
+						if(big::cmp(a, d) >= 0) {
+							a.sub(d);
+							q |= 1;
+						}
+						d.shr(1);
+					}
+				}
+				sticky |= !a.zero();
+				e2 = e - s;
+			}
+			bits_t b = round_<FMT>(q, e2, sticky, ovf);
+			std::memcpy(&v, &b, sizeof(T));
+			return v;
+		}
+
+		static constexpr double pow10_real_[23] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+
+		// float を仮数と指数へ（m × 2^e2）
+		static void split_(float v, uint32_t& m, int32_t& e2) noexcept
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &v, 4);
+			uint32_t exp = (bits >> 23) & 0xff;
+			m = bits & 0x7fffff;
+			if(exp == 0) {
+				e2 = 1 - 127 - 23;
+			} else {
+				m |= 0x800000;
+				e2 = static_cast<int32_t>(exp) - 127 - 23;
+			}
+		}
+
+
+		// 端数の分類
+		enum class frac : uint8_t {
+			ZERO,	///< ０
+			LOW,	///< 0.5 未満
+			HALF,	///< 丁度 0.5
+			HIGH,	///< 0.5 より大きい
+		};
+
+
+		template <class BIG>
+		static uint32_t big_dec_(BIG& a, char* out) noexcept
+		{
+			uint32_t part[12];
+			uint32_t np = 0;
+			while(!a.zero() && np < 12) {
+				part[np++] = a.div(1000000000);
+			}
+			if(np == 0) {
+				out[0] = '0';
+				return 1;
+			}
+			char tmp[10];
+			char* p = utoa(part[np - 1], &tmp[10]);
+			uint32_t n = &tmp[10] - p;
+			std::memcpy(out, p, n);
+			for(int32_t i = np - 2; i >= 0; --i) {
+				char* t = out + n;
+				p = utoa(part[i], t + 9);
+				while(p > t) *--p = '0';
+				n += 9;
+			}
+			return n;
+		}
+
+
+		// m × 2^e2 × 10^s（s >= 0）の整数部の十進表記と端数
+		static uint32_t scaled_(uint32_t m, int32_t e2, uint32_t s, char* out, frac& fr) noexcept
+		{
+			fr = frac::ZERO;
+			if(m == 0) {
+				out[0] = '0';
+				return 1;
+			}
+			if(e2 >= 0) {
+				uint32_t n;
+				if(e2 <= 39) {
+					char* end = out + 24;
+					char* p = utoa(static_cast<uint64_t>(m) << e2, end);
+					n = end - p;
+					std::memmove(out, p, n);
+				} else {
+					big_t<9> a;
+					a.set(m);
+					a.shl(e2);
+					n = big_dec_(a, out);
+				}
+				for(uint32_t i = 0; i < s; ++i) out[n++] = '0';
+				return n;
+			}
+
+			uint32_t sh = -e2;
+			if(s <= 12) {
+				uint64_t a = static_cast<uint64_t>(m) * pow10_[s];
+				uint64_t ip;
+				if(sh < 64) {
+					ip = a >> sh;
+					uint64_t rem = a & ((static_cast<uint64_t>(1) << sh) - 1);
+					uint64_t half = static_cast<uint64_t>(1) << (sh - 1);
+					if(rem == 0) fr = frac::ZERO;
+					else if(rem < half) fr = frac::LOW;
+					else if(rem == half) fr = frac::HALF;
+					else fr = frac::HIGH;
+				} else {
+					ip = 0;
+					uint64_t half = static_cast<uint64_t>(1) << 63;
+					if(sh > 64 || a < half) fr = frac::LOW;
+					else if(a == half) fr = frac::HALF;
+					else fr = frac::HIGH;
+				}
+				char* end = out + 24;
+				char* p = utoa(ip, end);
+				uint32_t n = end - p;
+				std::memmove(out, p, n);
+				return n;
+			}
+
+			big_t<9> a;
+			a.set(m);
+			a.mul_pow5(s);
+			int32_t net = static_cast<int32_t>(s) - static_cast<int32_t>(sh);
+			if(net >= 0) {
+				a.shl(net);
+			} else {
+				uint32_t r = -net;
+				bool top = a.bit(r - 1);
+				bool low = a.any(r - 1);
+				if(!top) fr = low ? frac::LOW : frac::ZERO;
+				else fr = low ? frac::HIGH : frac::HALF;
+				a.shr(r);
+			}
+			return big_dec_(a, out);
+		}
+
+
+		// 先頭 keep 桁に偶数丸め（桁上がりで１桁増える）
+		static uint32_t round_at_(char* d, uint32_t len, uint32_t keep, frac fr) noexcept
+		{
+			if(keep < len) {
+				bool sticky = fr != frac::ZERO;
+				for(uint32_t i = keep + 1; i < len; ++i) {
+					if(d[i] != '0') { sticky = true; break; }
+				}
+				char c = d[keep];
+				if(c > '5') fr = frac::HIGH;
+				else if(c == '5') fr = sticky ? frac::HIGH : frac::HALF;
+				else fr = (c > '0' || sticky) ? frac::LOW : frac::ZERO;
+				len = keep;
+			}
+			bool up = fr == frac::HIGH;
+			if(fr == frac::HALF) {
+				up = len > 0 && ((d[len - 1] - '0') & 1) != 0;
+			}
+			if(!up) return len;
+			int32_t i = len - 1;
+			while(i >= 0) {
+				if(d[i] != '9') {
+					++d[i];
+					return len;
+				}
+				d[i] = '0';
+				--i;
+			}
+			std::memmove(d + 1, d, len);
+			d[0] = '1';
+			return len + 1;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  符号無し整数を十進文字列へ（２桁づつ） @n
+					終端の手前から、先頭に向かって書き込む（終端文字は書かない）
+			@param[in]	v	値
+			@param[in]	end	書き込む領域の終端
+			@return 先頭
+		*/
+		//-----------------------------------------------------------------//
+		static char* utoa(uint32_t v, char* end) noexcept
+		{
+			char* p = end;
+			while(v >= 100) {
+				uint32_t i = (v % 100) * 2;
+				v /= 100;
+				*--p = pair_[i + 1];
+				*--p = pair_[i];
+			}
+			if(v >= 10) {
+				*--p = pair_[v * 2 + 1];
+				*--p = pair_[v * 2];
+			} else {
+				*--p = static_cast<char>('0' + v);
+			}
+			return p;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  符号無し整数（64 ビット）を十進文字列へ @n
+					32 ビットに収まる単位（８桁）に分けて変換する
+			@param[in]	v	値
+			@param[in]	end	書き込む領域の終端
+			@return 先頭
+		*/
+		//-----------------------------------------------------------------//
+		static char* utoa(uint64_t v, char* end) noexcept
+		{
+			char* p = end;
+			while(v > 0xffffffff) {
+				uint32_t lo = static_cast<uint32_t>(v % 100000000);
+				v /= 100000000;
+				char* t = p - 8;
+				p = utoa(lo, p);
+				while(p > t) *--p = '0';
+			}
+			return utoa(static_cast<uint32_t>(v), p);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  十進の数字を１桁追加（a = a * 10 + ch）
+			@param[in]	a	値
+			@param[in]	ch	数字（'0' ～ '9'）
+			@return オーバーフローする場合「false」（値は変えない）
+		*/
+		//-----------------------------------------------------------------//
+		static bool add_digit(uint32_t& a, char ch) noexcept
+		{
+			uint32_t d = ch - '0';
+			if(a > 429496729 || (a == 429496729 && d > 5)) return false;
+			a = a * 10 + d;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  元の値に戻る最短の十進表記（Ryu） @n
+					値は、out × 10^exp（符号は無視、０は "0"）
+			@param[in]	v	値（有限）
+			@param[out]	out	数字（９文字以上）
+			@param[out]	exp	十進の指数
+			@return 桁数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t shortest(float v, char* out, int32_t& exp) noexcept
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &v, 4);
+			uint32_t ieee_m = bits & 0x7fffff;
+			uint32_t ieee_e = (bits >> 23) & 0xff;
+			if(ieee_m == 0 && ieee_e == 0) {
+				out[0] = '0';
+				exp = 0;
+				return 1;
+			}
+
+			int32_t e2;
+			uint32_t m2;
+			if(ieee_e == 0) {
+				e2 = 1 - 127 - 23 - 2;
+				m2 = ieee_m;
+			} else {
+				e2 = static_cast<int32_t>(ieee_e) - 127 - 23 - 2;
+				m2 = (1u << 23) | ieee_m;
+			}
+			const bool accept = (m2 & 1) == 0;
+			const uint32_t mv = 4 * m2;
+			const uint32_t mp = 4 * m2 + 2;
+			const uint32_t mmshift = (ieee_m != 0 || ieee_e <= 1) ? 1 : 0;
+			const uint32_t mm = 4 * m2 - 1 - mmshift;
+
+			uint32_t vr, vp, vm;
+			int32_t e10;
+			bool vm_tz = false;
+			bool vr_tz = false;
+			uint32_t last = 0;
+			if(e2 >= 0) {
+				const uint32_t q = log10pow2_(e2);
+				e10 = q;
+				const int32_t k = num_detail::pow5_tbl::INV_BITCOUNT + pow5bits_(q) - 1;
+				const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+				vr = mul_shift_(mv, pow5_.inv[q], i);
+				vp = mul_shift_(mp, pow5_.inv[q], i);
+				vm = mul_shift_(mm, pow5_.inv[q], i);
+				if(q != 0 && (vp - 1) / 10 <= vm / 10) {
+					const int32_t l = num_detail::pow5_tbl::INV_BITCOUNT + pow5bits_(q - 1) - 1;
+					last = mul_shift_(mv, pow5_.inv[q - 1], -e2 + static_cast<int32_t>(q) - 1 + l) % 10;
+				}
+				if(q <= 9) {
+					if((mv % 5) == 0) vr_tz = pow5factor_(mv) >= q;
+					else if(accept) vm_tz = pow5factor_(mm) >= q;
+					else vp -= pow5factor_(mp) >= q ? 1 : 0;
+				}
+			} else {
+				const uint32_t q = log10pow5_(-e2);
+				e10 = static_cast<int32_t>(q) + e2;
+				const int32_t i = -e2 - static_cast<int32_t>(q);
+				const int32_t k = pow5bits_(i) - num_detail::pow5_tbl::BITCOUNT;
+				int32_t j = static_cast<int32_t>(q) - k;
+				vr = mul_shift_(mv, pow5_.pos[i], j);
+				vp = mul_shift_(mp, pow5_.pos[i], j);
+				vm = mul_shift_(mm, pow5_.pos[i], j);
+				if(q != 0 && (vp - 1) / 10 <= vm / 10) {
+					j = static_cast<int32_t>(q) - 1 - (pow5bits_(i + 1) - num_detail::pow5_tbl::BITCOUNT);
+					last = mul_shift_(mv, pow5_.pos[i + 1], j) % 10;
+				}
+				if(q <= 1) {
+					vr_tz = true;
+					if(accept) vm_tz = mmshift == 1;
+					else --vp;
+				} else if(q < 31) {
+					vr_tz = (mv & ((1u << (q - 1)) - 1)) == 0;
+				}
+			}
+
+			// 区間に収まる、最も短い桁数まで削る
+			int32_t removed = 0;
+			uint32_t output;
+			if(vm_tz || vr_tz) {
+				while(vp / 10 > vm / 10) {
+					vm_tz &= (vm % 10) == 0;
+					vr_tz &= last == 0;
+					last = vr % 10;
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+					++removed;
+				}
+				if(vm_tz) {
+					while((vm % 10) == 0) {
+						vr_tz &= last == 0;
+						last = vr % 10;
+						vr /= 10;
+						vp /= 10;
+						vm /= 10;
+						++removed;
+					}
+				}
+				if(vr_tz && last == 5 && (vr % 2) == 0) {
+					last = 4;  // 偶数丸め
+				}
+				output = vr + (((vr == vm && (!accept || !vm_tz)) || last >= 5) ? 1 : 0);
+			} else {
+				while(vp / 10 > vm / 10) {
+					last = vr % 10;
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+					++removed;
+				}
+				output = vr + ((vr == vm || last >= 5) ? 1 : 0);
+			}
+			exp = e10 + removed;
+
+			char tmp[10];
+			char* p = utoa(output, &tmp[10]);
+			uint32_t n = &tmp[10] - p;
+			std::memcpy(out, p, n);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  小数部の桁数を指定した十進表記（%f） @n
+					|v| × 10^prec を偶数丸めした整数の数字列
+			@param[in]	v		値（有限）
+			@param[in]	prec	小数部の桁数（REAL_DIGITS_MAX まで）
+			@param[out]	out		数字（REAL_BUFF_SIZE）
+			@return 桁数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t fixed(float v, uint32_t prec, char* out) noexcept
+		{
+			if(prec > REAL_DIGITS_MAX) prec = REAL_DIGITS_MAX;
+			uint32_t m;
+			int32_t e2;
+			split_(v, m, e2);
+			frac fr;
+			auto n = scaled_(m, e2, prec, out, fr);
+			return round_at_(out, n, n, fr);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  有効桁数を指定した十進表記（%e） @n
+					値は、d.ddd × 10^exp（数字は prec + 1 桁）
+			@param[in]	v		値（有限）
+			@param[in]	prec	小数部の桁数（REAL_DIGITS_MAX まで）
+			@param[out]	out		数字（REAL_BUFF_SIZE）
+			@param[out]	exp		十進の指数
+			@return 桁数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t exponent(float v, uint32_t prec, char* out, int32_t& exp) noexcept
+		{
+			if(prec > REAL_DIGITS_MAX) prec = REAL_DIGITS_MAX;
+			uint32_t m;
+			int32_t e2;
+			split_(v, m, e2);
+			exp = 0;
+			if(m == 0) {
+				for(uint32_t i = 0; i <= prec; ++i) out[i] = '0';
+				return prec + 1;
+			}
+			// floor(log10(v)) を下回る見積もり
+			int32_t lead = e2 + static_cast<int32_t>(32 - __builtin_clz(m)) - 1;
+			int32_t k;
+			if(lead >= 0) k = log10pow2_(lead);
+			else k = -static_cast<int32_t>(log10pow2_(-lead)) - 1;
+			uint32_t keep = prec + 1;
+			while(1) {
+				int32_t s = static_cast<int32_t>(prec) - k;
+				if(s < 0) s = 0;
+				frac fr;
+				auto n = scaled_(m, e2, s, out, fr);
+				if(n < keep) {  // 見積もりが大きい
+					--k;
+					continue;
+				}
+				exp = static_cast<int32_t>(n) - 1 - s;
+				n = round_at_(out, n, keep, fr);
+				if(n > keep) ++exp;  // 999.. -> 1000..
+				return keep;
+			}
+		}
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  十進から浮動小数点への変換（一文字づつ入力） @n
+					有効桁を保持して、最後に一回だけ丸める。
+			@param[in]	T	float、double
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		template <typename T>
+		class real_in {
+			typedef num_detail::real_fmt<sizeof(T)> FMT;
+
+			char		dig_[FMT::DIGITS];
+			uint32_t	n_;
+			int32_t		exp_;
+			bool		point_;
+			bool		sticky_;
+			bool		any_;
+
+		public:
+			//-------------------------------------------------------------//
+			/*!
+				@brief  コンストラクター
+			*/
+			//-------------------------------------------------------------//
+			real_in() noexcept : n_(0), exp_(0), point_(false), sticky_(false), any_(false) { }
+
+
+			//-------------------------------------------------------------//
+			/*!
+				@brief  小数点
+				@return 既に小数点があれば「false」
+			*/
+			//-------------------------------------------------------------//
+			bool point() noexcept
+			{
+				if(point_) return false;
+				point_ = true;
+				return true;
+			}
+
+
+			//-------------------------------------------------------------//
+			/*!
+				@brief  数字を追加
+				@param[in]	ch	数字（'0' ～ '9'）
+			*/
+			//-------------------------------------------------------------//
+			void add(char ch) noexcept
+			{
+				any_ = true;
+				if(n_ == 0 && ch == '0') {  // 先頭の０
+					if(point_) --exp_;
+					return;
+				}
+				if(n_ < FMT::DIGITS) {
+					dig_[n_++] = ch;
+					if(point_) --exp_;
+				} else {
+					if(ch != '0') sticky_ = true;
+					if(!point_) ++exp_;
+				}
+			}
+
+
+			//-------------------------------------------------------------//
+			/*!
+				@brief  数字が入力されたか
+				@return 数字があれば「true」
+			*/
+			//-------------------------------------------------------------//
+			bool any() const noexcept { return any_; }
+
+
+			//-------------------------------------------------------------//
+			/*!
+				@brief  値を取得
+				@param[in]	exp	十進の指数（e 以降）
+				@param[out]	ovf	無限大になった場合「true」
+				@return 値（正）
+			*/
+			//-------------------------------------------------------------//
+			T get(int32_t exp, bool& ovf) const noexcept
+			{
+				return make_real_<T>(dig_, n_, exp_ + exp, sticky_, ovf);
+			}
+		};
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  十進文字列から浮動小数点へ（strtof、strtod 相当） @n
+					[+-]ddd[.ddd][(e|E)[+-]ddd]
+			@param[in]	src	文字列
+			@param[out]	v	値（範囲外は無限大）
+			@return 変換した次の位置（数字が無い場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		static const char* to_real(const char* src, T& v) noexcept
+		{
+			const char* p = src;
+			bool neg = false;
+			if(*p == '+' || *p == '-') {
+				neg = *p == '-';
+				++p;
+			}
+			real_in<T> in;
+			while(1) {
+				char ch = *p;
+				if(ch >= '0' && ch <= '9') in.add(ch);
+				else if(ch != '.' || !in.point()) break;
+				++p;
+			}
+			if(!in.any()) return nullptr;
+
+			int32_t exp = 0;
+			if(*p == 'e' || *p == 'E') {
+				const char* t = p + 1;
+				bool eneg = false;
+				if(*t == '+' || *t == '-') {
+					eneg = *t == '-';
+					++t;
+				}
+				if(*t >= '0' && *t <= '9') {
+					while(*t >= '0' && *t <= '9') {
+						if(exp < 100000) exp = exp * 10 + (*t - '0');
+						++t;
+					}
+					if(eneg) exp = -exp;
+					p = t;
+				}
+			}
+			bool ovf = false;
+			v = in.get(exp, ovf);
+			if(neg) v = -v;
+			return p;
+		}
+	};
+}
@@ -0,0 +1,402 @@
+//=====================================================================//
+/*!	@file
+	@brief	num_conv 検査、ベンチマーク（ホスト用） @n
+			C ライブラリ（snprintf、strtof、strtod）と、結果を比べる。@n
+			・整数：全ての 32 ビット値 @n
+			・float 最短表記：全ての有限値（std::to_chars と一致、strtof で元に戻る） @n
+			・%f、%e：間引いた全域（snprintf と一致） @n
+			・十進から float、double：丸めの境界、長い桁、ランダム（strtof、strtod と一致） @n
+			引数無しは間引いて検査、「all」で全数検査（数十分かかる）。@n
+			最後に、変換１回の時間を比べる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include <random>
+#include "common/num_conv.hpp"
+#include "common/format.hpp"
+#include "common/input.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	typedef utils::num_conv nc;
+
+	bool		all_ = false;
+	uint32_t	error_ = 0;
+	volatile uint32_t	sink_;
+
+	void fail_(const char* what, const char* a, const char* b)
+	{
+		if(error_ < 10) {
+			printf("  NG %s: '%s' / '%s'\n", what, a, b);
+		}
+		++error_;
+	}
+
+
+	float bits_float_(uint32_t b)
+	{
+		float v;
+		std::memcpy(&v, &b, 4);
+		return v;
+	}
+
+
+	// 十進の文字列カウンターと比べる（全ての 32 ビット値）
+	void check_utoa_()
+	{
+		uint32_t step = all_ ? 1 : 997;
+		uint32_t err = error_;
+		uint64_t num = 0;
+		for(uint64_t v = 0; v <= 0xffffffffULL; v += step) {
+			char tmp[12];
+			char* end = &tmp[11];
+			*end = 0;
+			char* p = nc::utoa(static_cast<uint32_t>(v), end);
+			if(all_) {
+				static char ref[12] = { "0" };
+				static uint32_t len = 1;
+				if(static_cast<uint32_t>(end - p) != len || std::memcmp(p, ref, len) != 0) {
+					fail_("utoa", p, ref);
+				}
+				// ref++
+				int32_t i = len - 1;
+				while(i >= 0 && ref[i] == '9') { ref[i] = '0'; --i; }
+				if(i >= 0) ++ref[i];
+				else { std::memmove(ref + 1, ref, len); ref[0] = '1'; ++len; ref[len] = 0; }
+			} else {
+				char ref[12];
+				snprintf(ref, sizeof(ref), "%u", static_cast<uint32_t>(v));
+				if(strcmp(p, ref) != 0) fail_("utoa", p, ref);
+			}
+			++num;
+		}
+		for(uint32_t i = 0; i < 64; ++i) {
+			uint64_t v = (i < 20) ? (1ULL << (i * 3)) - 1 : (0xffffffffffffffffULL >> (i - 20));
+			char tmp[24];
+			char ref[24];
+			char* end = &tmp[23];
+			*end = 0;
+			char* p = nc::utoa(v, end);
+			snprintf(ref, sizeof(ref), "%llu", static_cast<unsigned long long>(v));
+			if(strcmp(p, ref) != 0) fail_("utoa(64)", p, ref);
+		}
+		printf("  utoa              %12llu values  %s\n", static_cast<unsigned long long>(num),
+			err == error_ ? "OK" : "NG");
+	}
+
+
+	// 最短表記（std::to_chars は最短を返す）、strtof と num_conv で元に戻る事
+	void check_shortest_()
+	{
+		uint32_t step = all_ ? 1 : 4099;
+		uint32_t err = error_;
+		uint64_t num = 0;
+		for(uint64_t b = 0; b < 0x7f800000; b += step) {
+			float v = bits_float_(b);
+			char dig[16];
+			int32_t exp;
+			auto n = nc::shortest(v, dig, exp);
+			char ref[32];
+			auto r = std::to_chars(ref, ref + sizeof(ref), v, std::chars_format::scientific);
+			*r.ptr = 0;
+			char s[32];
+			uint32_t l = 0;
+			s[l++] = dig[0];
+			if(n > 1) {
+				s[l++] = '.';
+				for(uint32_t i = 1; i < n; ++i) s[l++] = dig[i];
+			}
+			int32_t x = exp + n - 1;
+			snprintf(&s[l], sizeof(s) - l, "e%c%02d", x < 0 ? '-' : '+', x < 0 ? -x : x);
+			if(strcmp(s, ref) != 0) fail_("shortest", s, ref);
+
+			float a = strtof(s, nullptr);
+			float c;
+			nc::to_real(s, c);
+			if(std::memcmp(&a, &v, 4) != 0 || std::memcmp(&c, &v, 4) != 0) {
+				fail_("round trip", s, ref);
+			}
+			++num;
+		}
+		printf("  shortest          %12llu values  %s\n", static_cast<unsigned long long>(num),
+			err == error_ ? "OK" : "NG");
+	}
+
+
+	// %.Nf、%.Ne を snprintf と比べる
+	void check_fixed_()
+	{
+		uint32_t step = all_ ? 61 : 65521;
+		uint32_t err = error_;
+		uint64_t num = 0;
+		uint32_t prec = 0;
+		for(uint64_t b = 0; b < 0x7f800000; b += step) {
+			float v = bits_float_(b);
+			prec = (prec + 1) % 13;
+			char dig[nc::REAL_BUFF_SIZE];
+			char ref[128];
+			char s[128];
+			auto n = nc::fixed(v, prec, dig);
+			snprintf(ref, sizeof(ref), "%.*f", prec, v);
+			uint32_t l = 0;
+			if(n <= prec) {
+				s[l++] = '0';
+			} else {
+				std::memcpy(s, dig, n - prec);
+				l = n - prec;
+			}
+			if(prec > 0) {
+				s[l++] = '.';
+				for(uint32_t i = n; i < prec; ++i) s[l++] = '0';
+				for(uint32_t i = n > prec ? n - prec : 0; i < n; ++i) s[l++] = dig[i];
+			}
+			s[l] = 0;
+			if(strcmp(s, ref) != 0) fail_("fixed", s, ref);
+
+			int32_t exp;
+			n = nc::exponent(v, prec, dig, exp);
+			snprintf(ref, sizeof(ref), "%.*e", prec, v);
+			l = 0;
+			s[l++] = dig[0];
+			if(prec > 0) {
+				s[l++] = '.';
+				for(uint32_t i = 1; i < n; ++i) s[l++] = dig[i];
+			}
+			snprintf(&s[l], sizeof(s) - l, "e%c%02d", exp < 0 ? '-' : '+', exp < 0 ? -exp : exp);
+			if(strcmp(s, ref) != 0) fail_("exponent", s, ref);
+			num += 2;
+		}
+		printf("  fixed, exponent   %12llu values  %s\n", static_cast<unsigned long long>(num),
+			err == error_ ? "OK" : "NG");
+	}
+
+
+	template <typename T>
+	bool parse_(const char* s, const char* what)
+	{
+		T a;
+		T b;
+		nc::to_real(s, a);
+		if(sizeof(T) == 4) b = strtof(s, nullptr);
+		else b = strtod(s, nullptr);
+		if(std::memcmp(&a, &b, sizeof(T)) != 0) {
+			char ta[40];
+			snprintf(ta, sizeof(ta), "%.17g", static_cast<double>(a));
+			fail_(what, s, ta);
+			return false;
+		}
+		return true;
+	}
+
+
+	// 丸めの境界（隣り合う float の中点）、長い桁、ランダム
+	void check_parse_()
+	{
+		uint32_t err = error_;
+		uint64_t num = 0;
+
+		// 中点は double で正確に表せるので、%.150e で全桁を出して、その後ろに０以外の桁を足す
+		uint32_t step = all_ ? 251 : 65521;
+		for(uint64_t b = 0; b < 0x7f7fffff; b += step) {
+			double lo = bits_float_(b);
+			double hi = bits_float_(b + 1);
+			double mid = (lo + hi) * 0.5;
+			char s[200];
+			snprintf(s, sizeof(s), "%.150e", mid);
+			parse_<float>(s, "halfway");
+			// 最後の桁の後ろに、０以外の桁を追加
+			char* e = strchr(s, 'e');
+			char t[220];
+			std::memcpy(t, s, e - s);
+			snprintf(&t[e - s], sizeof(t) - (e - s), "0001%s", e);
+			parse_<float>(t, "above halfway");
+			num += 2;
+		}
+
+		std::mt19937 rng(20201203);
+		uint32_t loop = all_ ? 20000000 : 200000;
+		for(uint32_t i = 0; i < loop; ++i) {
+			char s[1024];
+			uint32_t l = 0;
+			if(rng() & 1) s[l++] = '-';
+			uint32_t nd = 1 + rng() % ((i & 3) == 0 ? 900 : 20);
+			uint32_t pt = rng() % (nd + 1);
+			for(uint32_t j = 0; j < nd; ++j) {
+				if(j == pt) s[l++] = '.';
+				s[l++] = '0' + rng() % 10;
+			}
+			int32_t ex = static_cast<int32_t>(rng() % 700) - 350;
+			snprintf(&s[l], sizeof(s) - l, "e%d", ex);
+			parse_<float>(s, "random(float)");
+			parse_<double>(s, "random(double)");
+			num += 2;
+		}
+
+		static const char* edge[] = {
+			"0", "-0", "0.0e10", ".5", "5.", "1e", "1e+", "3.4028235e38", "3.4028236e38", "3.40282357e38",
+			"1.4e-45", "7.0064923e-46", "7.006492321624086e-46", "7.0064923216240862e-46",
+			"1.1754942e-38", "1.17549435e-38", "4.9406564584124654e-324", "2.4703282292062327e-324",
+			"2.4703282292062328e-324", "1.7976931348623157e308", "1.7976931348623159e308",
+			"9007199254740993", "16777217", "16777219", "0.000000000000000000000000000000000000001",
+			"123456789012345678901234567890", "1e400", "1e-400",
+		};
+		for(auto s : edge) {
+			parse_<float>(s, "edge(float)");
+			parse_<double>(s, "edge(double)");
+			num += 2;
+		}
+		printf("  parse             %12llu values  %s\n", static_cast<unsigned long long>(num),
+			err == error_ ? "OK" : "NG");
+	}
+
+
+	// format、input を通した変換
+	void check_format_()
+	{
+		uint32_t err = error_;
+		uint64_t num = 0;
+		std::mt19937 rng(1);
+		for(uint32_t i = 0; i < 100000; ++i) {
+			float v = bits_float_(rng() & 0xff7fffff);
+			if(!(v == v)) continue;
+			char s[256];
+			char ref[256];
+			uint32_t u = rng();
+			int32_t d = static_cast<int32_t>(rng());
+			utils::sformat("%e|%8.3f|%-12.5E|%+.1f|%u|%d", s, sizeof(s)) % v % v % v % v % u % d;
+			snprintf(ref, sizeof(ref), "%e|%8.3f|%-12.5E|%+.1f|%u|%d", v, v, v, v, u, d);
+			if(strcmp(s, ref) != 0) fail_("format", s, ref);
+			++num;
+
+			utils::sformat("%g", s, sizeof(s)) % v;
+			float g = 0.0f;
+			if(!(utils::input("%f", s) % g).status() || std::memcmp(&g, &v, 4) != 0) {
+				fail_("format %g -> input %f", s, "");
+			}
+			++num;
+		}
+		printf("  format, input     %12llu values  %s\n", static_cast<unsigned long long>(num),
+			err == error_ ? "OK" : "NG");
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	変換１回の時間
+	*/
+	//-----------------------------------------------------------------//
+	static const uint32_t LOOP = 1000000;
+
+	uint32_t	uval_[256];
+	float		fval_[256];
+	char		ftext_[256][32];
+	char		buff_[128];
+
+	template <class FUNC>
+	double run_(FUNC func)
+	{
+		double t = 0.0;
+		for(uint32_t n = 0; n < 3; ++n) {
+			auto st = bench_usec();
+			for(uint32_t i = 0; i < LOOP; ++i) {
+				sink_ += func(i & 255);
+			}
+			auto d = bench_usec() - st;
+			if(n == 0 || d < t) t = d;
+		}
+		return t * 1e3 / LOOP;
+	}
+
+
+	void bench_()
+	{
+		std::mt19937 rng(2);
+		for(uint32_t i = 0; i < 256; ++i) {
+			uval_[i] = rng() >> (rng() % 32);
+			float v;
+			do {
+				v = bits_float_(rng() & 0x7f7fffff);
+			} while(v < 1e-6f || v > 1e9f);
+			if(i & 1) v = static_cast<float>(rng() % 100000) / 100.0f;  // 計測値のような数
+			fval_[i] = v;
+			snprintf(ftext_[i], sizeof(ftext_[i]), "%.7g", v);
+		}
+
+		printf("\n  %-24s %10s %10s\n", "case (ns per call)", "num_conv", "C library");
+
+		auto a = run_([](uint32_t i) {
+			char* end = &buff_[16];
+			return static_cast<uint32_t>(*nc::utoa(uval_[i], end)); });
+		auto b = run_([](uint32_t i) {
+			snprintf(buff_, sizeof(buff_), "%u", uval_[i]);
+			return static_cast<uint32_t>(buff_[0]); });
+		printf("  %-24s %10.1f %10.1f\n", "uint32 -> dec", a, b);
+
+		a = run_([](uint32_t i) {
+			int32_t e;
+			return nc::shortest(fval_[i], buff_, e); });
+		b = run_([](uint32_t i) {
+			return static_cast<uint32_t>(snprintf(buff_, sizeof(buff_), "%.9g", fval_[i])); });
+		printf("  %-24s %10.1f %10.1f  (snprintf %%.9g)\n", "float -> shortest", a, b);
+
+		a = run_([](uint32_t i) {
+			return nc::fixed(fval_[i], 6, buff_); });
+		b = run_([](uint32_t i) {
+			return static_cast<uint32_t>(snprintf(buff_, sizeof(buff_), "%.6f", fval_[i])); });
+		printf("  %-24s %10.1f %10.1f\n", "float -> %.6f", a, b);
+
+		a = run_([](uint32_t i) {
+			int32_t e;
+			return nc::exponent(fval_[i], 6, buff_, e); });
+		b = run_([](uint32_t i) {
+			return static_cast<uint32_t>(snprintf(buff_, sizeof(buff_), "%.6e", fval_[i])); });
+		printf("  %-24s %10.1f %10.1f\n", "float -> %.6e", a, b);
+
+		a = run_([](uint32_t i) {
+			float v;
+			nc::to_real(ftext_[i], v);
+			uint32_t r;
+			std::memcpy(&r, &v, 4);
+			return r; });
+		b = run_([](uint32_t i) {
+			float v = strtof(ftext_[i], nullptr);
+			uint32_t r;
+			std::memcpy(&r, &v, 4);
+			return r; });
+		printf("  %-24s %10.1f %10.1f\n", "dec -> float", a, b);
+
+		a = run_([](uint32_t i) {
+			double v;
+			nc::to_real(ftext_[i], v);
+			return static_cast<uint32_t>(v); });
+		b = run_([](uint32_t i) {
+			return static_cast<uint32_t>(strtod(ftext_[i], nullptr)); });
+		printf("  %-24s %10.1f %10.1f\n", "dec -> double", a, b);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "all") == 0) all_ = true;
+
+	printf("num_conv test (%s)\n\n", all_ ? "all" : "sampled, 'all' for exhaustive");
+	auto st = bench_usec();
+	check_utoa_();
+	check_shortest_();
+	check_fixed_();
+	check_parse_();
+	check_format_();
+	printf("  %u error(s), %.1f s\n", error_, (bench_usec() - st) * 1e-6);
+
+	bench_();
+	return error_ == 0 ? 0 : 1;
+}
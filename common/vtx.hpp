@@ -31,7 +31,7 @@ namespace vtx {
 		return x;
 	}
 #else
-	inline float fsqrt(float x) { return std::sqrtf(x); }
+	inline float fsqrt(float x) { return std::sqrt(x); }
 #endif
 
 	template <typename T>
@@ -12,6 +12,7 @@
 //=====================================================================//
 #include "common/file_io.hpp"
 #include "common/fixed_stack.hpp"
+#include "common/dir_index.hpp"
 
 namespace gui {
 
@@ -69,21 +70,31 @@ namespace gui {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	ファイラー・クラス
-		@param[in]	RDR	描画クラス型
+		@brief	ファイラー・クラス @n
+				ディレクトリーは、開いた時に一度だけ走査してインデックス化（ソート）し、@n
+				スクロールは、画面の移動（ブリット）と、新たに見える行だけを描画する。@n
+				インデックスに収まらないディレクトリーは、表示位置を含む一部を読み直す（ディレクトリーの順番）。
+		@param[in]	RDR		描画クラス型
+		@param[in]	ENTRY	ディレクトリー内の最大エントリー数
+		@param[in]	ARENA	ファイル名格納領域のサイズ
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class RDR>
+	template <class RDR, uint32_t ENTRY = 1024, uint32_t ARENA = 24 * 1024>
 	class filer : public filer_base {
+	public:
+		typedef utils::dir_index<ENTRY, ARENA> DIDX;
+		typedef typename DIDX::sort_type sort_type;
 
+	private:
 		using GLC = typename RDR::glc_type;
 
-		static const int32_t FRAME_PER_FILES = 10;  ///< ディレクトリー取得で処理するフレーム辺りのファイル数
+		static const int32_t FRAME_PER_FILES = 64;  ///< ディレクトリー取得で処理するフレーム辺りのファイル数
 		static const int16_t MODAL_RADIUS = 10;  ///< modal round radius
 
 		static const int16_t SPC = 2;									///< 文字間隙間
 		static const int16_t FLN = RDR::font_type::height + SPC;		///< 行幅
 		static const int16_t SCN = (RDR::glc_type::height - SPC) / FLN;	///< 行数
+		static const int16_t VRN = (RDR::glc_type::height - SPC + FLN - 1) / FLN;	///< 描画行数（一部が見える行を含む）
 
 		static const uint16_t REPEAT_DELAY = 40;	///< リピートまでの時間（フレーム数）
 		static const uint16_t REPEAT_CYCLE = 8;		///< リピート間隔（フレーム数）
@@ -92,33 +103,30 @@ namespace gui {
 
 		RDR&		rdr_;
 
-		typedef utils::dir_list DLIST;
-		DLIST		dlist_;
+		DIDX		didx_;
 
 		uint32_t	ctrl_;
 
 		struct rdr_st {
-			int16_t		vofs_;
-			int16_t		vpos_;
+			uint16_t	top_;
 			int16_t		hmax_;
 			int16_t		sel_pos_;
-			uint16_t	num_;
-			int16_t		match_;
 
-			rdr_st() noexcept : vofs_(0), vpos_(0), hmax_(0),
-				sel_pos_(0), num_(0), match_(-1)
-			{ }
+			rdr_st() noexcept : top_(0), hmax_(0), sel_pos_(0) { }
 		};
 		rdr_st		rdr_st_;
+		uint32_t	base_;	///< インデックスの先頭の、ディレクトリー内の位置
+		uint32_t	gtop_;	///< 走査後の表示位置（ディレクトリー内の位置）
 
 		bool		open_;
 		bool		info_;
+		bool		draw_;
 
 		struct pos_t {
-			int16_t		vofs_;
+			uint32_t	top_;
 			int16_t		sel_pos_;
-			pos_t(int16_t vofs = 0, int16_t sel_pos = 0) noexcept :
-				vofs_(vofs), sel_pos_(sel_pos) { }
+			pos_t(uint32_t top = 0, int16_t sel_pos = 0) noexcept :
+				top_(top), sel_pos_(sel_pos) { }
 		};
 		typedef utils::fixed_stack<pos_t, 16> POS_STACK;
 		POS_STACK	pos_stack_;
@@ -142,42 +150,66 @@ namespace gui {
 		}
 
 
-		void dir_draw_func_(const char* name, const FILINFO* fi, bool dir, void* opt) noexcept
+		int16_t get_scn_() const noexcept
 		{
-			rdr_st& t = *static_cast<rdr_st*>(opt);
-			bool draw = false;
-			if(t.match_ < 0) {
-				draw = true;
-			} else if(t.num_ == static_cast<uint16_t>(t.match_)) {
-				draw = true;
-			}
-			if(draw && t.vpos_ >= 0 && t.vpos_ < RDR::glc_type::height) {
-				rdr_.set_fore_color(DEF_COLOR::Black);
-				rdr_.fill_box(vtx::srect(SPC, t.vpos_,
-					RDR::glc_type::width - SPC * 2, RDR::font_type::height));
+			int16_t scn = SCN;
+			if(static_cast<int16_t>(didx_.size()) < scn) scn = didx_.size();
+			return scn;
+		}
+
+
+		void draw_line_(int16_t row) noexcept
+		{
+			int16_t y = SPC + row * FLN;
+			if(row < 0 || y >= RDR::glc_type::height) return;
+
+			rdr_.set_fore_color(DEF_COLOR::Black);
+			rdr_.fill_box(vtx::srect(SPC, y,
+				RDR::glc_type::width - SPC * 2, RDR::font_type::height));
+
+			uint32_t idx = rdr_st_.top_ + row;
+			if(idx >= didx_.size()) return;
+
+			const auto& e = didx_.get(idx);
+			bool dir = e.is_dir();
+			rdr_.set_fore_color(DEF_COLOR::White);
+			if(dir) rdr_.draw_font(vtx::spos(SPC, y), '/');
+			if(dir) {
+				rdr_.set_fore_color(DEF_COLOR::Blue);
+			} else {
 				rdr_.set_fore_color(DEF_COLOR::White);
-				if(dir) rdr_.draw_font(vtx::spos(SPC, t.vpos_), '/');
-				if(dir) {
-					rdr_.set_fore_color(DEF_COLOR::Blue);
-				} else {
-					rdr_.set_fore_color(DEF_COLOR::White);
-				}
-				auto w = rdr_.draw_text(vtx::spos(SPC + 8, t.vpos_), name);
-				if(t.hmax_ < w) t.hmax_ = w;
 			}
-			t.vpos_ += FLN;
-			++t.num_;
+			auto w = rdr_.draw_text(vtx::spos(SPC + 8, y), didx_.get_name(idx));
+			if(rdr_st_.hmax_ < w) rdr_st_.hmax_ = w;
 		}
 
 
-		void start_dir_draw_(int16_t match = -1) noexcept
+		void draw_page_() noexcept
 		{
-			rdr_st_.vpos_ = rdr_st_.vofs_ + 2;
-			rdr_st_.num_ = 0;
-			rdr_st_.match_ = match;
-			char tmp[FF_MAX_LFN + 1];
-			if(utils::file_io::pwd(tmp, sizeof(tmp))) {
-				dlist_.start(tmp);
+			for(int16_t row = 0; row < VRN; ++row) {
+				draw_line_(row);
+			}
+		}
+
+
+		void scroll_(bool down) noexcept
+		{
+			// 既存の行は移動して、新たに見える行だけを描画
+			if(down) {
+				++rdr_st_.top_;
+				rdr_.scroll(FLN);
+				rdr_.set_fore_color(DEF_COLOR::Black);
+				rdr_.fill_box(vtx::srect(0, RDR::glc_type::height - FLN,
+					RDR::glc_type::width, FLN));
+				for(int16_t row = (RDR::glc_type::height - FLN - SPC) / FLN; row < VRN; ++row) {
+					draw_line_(row);
+				}
+			} else {
+				--rdr_st_.top_;
+				rdr_.scroll(-FLN);
+				rdr_.set_fore_color(DEF_COLOR::Black);
+				rdr_.fill_box(vtx::srect(0, 0, RDR::glc_type::width, FLN));
+				draw_line_(0);
 			}
 		}
 
@@ -190,22 +222,71 @@ namespace gui {
 		}
 
 
+		void scan_(uint32_t base) noexcept
+		{
+			base_ = base;
+			char tmp[FF_MAX_LFN + 1];
+			if(utils::file_io::pwd(tmp, sizeof(tmp))) {
+				didx_.start(tmp, base);
+			}
+			draw_ = true;
+		}
+
+
+		bool rescan_(uint32_t gtop) noexcept
+		{
+			// 表示位置が、新しいインデックスの中央に来るように読み直す
+			uint32_t half = didx_.size() / 2;
+			uint32_t base = gtop > half ? gtop - half : 0;
+			if(base == base_) return false;
+			gtop_ = gtop;
+			scan_(base);
+			return true;
+		}
+
+
 		void scan_dir_(bool back)
 		{
 			if(back) {
 				if(pos_stack_.empty()) {
-					rdr_st_.vofs_ = 0;
+					gtop_ = 0;
 					rdr_st_.sel_pos_ = 0;
 				} else {
 					const auto& t = pos_stack_.pop();
-					rdr_st_.vofs_ = t.vofs_;
+					gtop_ = t.top_;
 					rdr_st_.sel_pos_ = t.sel_pos_;
 				}
 			} else {
-				rdr_st_.vofs_ = 0;
+				gtop_ = 0;
 				rdr_st_.sel_pos_ = 0;
 			}
-			start_dir_draw_();
+			rdr_st_.hmax_ = 0;
+			scan_(0);
+		}
+
+
+		void scan_end_() noexcept
+		{
+			int16_t num = didx_.size();
+			int16_t scn = get_scn_();
+			if(didx_.is_part()) {
+				// 表示位置がインデックスに無ければ、その位置を含む一部を読み直す
+				bool last = (base_ + num) >= didx_.get_total();
+				if(gtop_ < base_ || (!last && (gtop_ + scn) > (base_ + num))) {
+					if(rescan_(gtop_)) return;
+				}
+			}
+			// 走査前の位置が範囲外になる場合に備える
+			uint32_t top = gtop_ >= base_ ? gtop_ - base_ : 0;
+			if((top + scn) > static_cast<uint32_t>(num)) {
+				top = num - scn;
+			}
+			rdr_st_.top_ = top;
+			if(rdr_st_.sel_pos_ >= scn) {
+				rdr_st_.sel_pos_ = scn > 0 ? scn - 1 : 0;
+			}
+			draw_page_();
+			draw_ = false;
 		}
 
 	public:
@@ -216,8 +297,8 @@ namespace gui {
 			@param[in]	tto		３本指タッチオープンを無効にする場合「false」
 		*/
 		//-----------------------------------------------------------------//
-		filer(RDR& rdr, bool tto = true) noexcept : rdr_(rdr), dlist_(),
-			ctrl_(0), rdr_st_(), open_(false), info_(false), 
+		filer(RDR& rdr, bool tto = true) noexcept : rdr_(rdr), didx_(),
+			ctrl_(0), rdr_st_(), base_(0), gtop_(0), open_(false), info_(false), draw_(false),
 			touch_lvl_(false), touch_pos_(false), touch_neg_(false), touch_num_(0),
 			touch_(0), touch_org_(0), touch_end_(0),
 			back_num_(0), tto_(tto), repeat_(0)
@@ -258,6 +339,41 @@ namespace gui {
 		bool get_state() const noexcept { return open_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ソート型の設定 @n
+					※走査済みのディレクトリーは、再走査しないで並べ替える
+			@param[in]	type	ソート型
+		*/
+		//-----------------------------------------------------------------//
+		void set_sort(sort_type type) noexcept
+		{
+			didx_.sort(type);  // 走査中なら、走査後にも適用される
+			if(!didx_.probe() && !draw_ && open_ && !info_) {
+				rdr_.clear(DEF_COLOR::Black);
+				draw_page_();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ソート型の取得
+			@return ソート型
+		*/
+		//-----------------------------------------------------------------//
+		sort_type get_sort() const noexcept { return didx_.get_sort(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー・インデックスの参照
+			@return ディレクトリー・インデックス
+		*/
+		//-----------------------------------------------------------------//
+		const DIDX& get_index() const noexcept { return didx_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	スクリーン・タッチ位置設定 @n
@@ -298,12 +414,12 @@ namespace gui {
 			uint32_t ntrg =  ctrl_ & ~ctrl;
 			ctrl_ = ctrl;
 
-			dlist_.service(FRAME_PER_FILES,
-				[&](const char* name, const FILINFO* fi, bool dir, void* opt) {
-				dir_draw_func_(name, fi, dir, opt); }, true, &rdr_st_);
+			didx_.service(FRAME_PER_FILES);
 
 			if((ntrg & ctrl_mask_(ctrl::MOUNT))) {  // SD カードのマウント状態
 				open_ = false;
+				didx_.stop();
+				draw_ = false;
 				pos_stack_.clear();
 				rdr_.clear(DEF_COLOR::Black);
 			}
@@ -377,37 +493,26 @@ namespace gui {
 				}
 			}
 
-			{
-				if(dlist_.probe()) return status::NONE;
-				if(rdr_st_.num_ < static_cast<int16_t>(dlist_.get_total())) {
-					return status::NONE;
-				}
+			if(didx_.probe()) return status::NONE;
+			if(draw_) {
+				scan_end_();
 			}
 
 			if(ptrg & ctrl_mask_(ctrl::INFO)) {
 				if(info_) {
-					pos_stack_.push(pos_t(rdr_st_.vofs_, rdr_st_.sel_pos_));
 					info_ = false;
 					rdr_.clear(DEF_COLOR::Black);
-					scan_dir_(true);
+					draw_page_();
 					return status::NONE;
 				} else {
-					info_ = true;
-					uint32_t idx = rdr_st_.sel_pos_ - rdr_st_.vofs_ / FLN;
-					char tmp[FF_MAX_LFN + 1];
-					if(!utils::file_io::pwd(tmp, sizeof(tmp))) {
-						return status::NONE;
-					}
-					if(!utils::file_io::get_dir_path(tmp, idx, dst, dstlen)) {
+					uint32_t idx = rdr_st_.top_ + rdr_st_.sel_pos_;
+					if(idx >= didx_.size()) {
 						return status::NONE;
 					}
-					bool dir = false;
-					uint32_t l = strlen(dst);
-					if(dst[l - 1] == '/') {
-						dir = true;
-						dst[l - 1] = 0;
-					}
-					auto t = utils::file_io::get_time(dst);
+					info_ = true;
+					const auto& e = didx_.get(idx);
+					char tmp[FF_MAX_LFN + 1];
+					auto t = utils::str::fatfs_time_to(e.date(), e.time());
 					struct tm *m = localtime(&t);
 					utils::sformat("%s %2d %4d %02d:%02d\n", tmp, sizeof(tmp))
 						% get_mon(m->tm_mon)
@@ -415,10 +520,9 @@ namespace gui {
 						% static_cast<int>(m->tm_year + 1900)
 						% static_cast<int>(m->tm_hour)
 						% static_cast<int>(m->tm_min);
-					if(!dir) {
-						auto n = utils::file_io::get_file_size(dst);
-						l = strlen(tmp);
-						utils::sformat("%u bytes", &tmp[l], sizeof(tmp) - l) % n;
+					if(!e.is_dir()) {
+						uint32_t l = strlen(tmp);
+						utils::sformat("%u bytes", &tmp[l], sizeof(tmp) - l) % e.size();
 					}
 					modal(vtx::spos(300, 80), tmp);
 				}
@@ -437,40 +541,32 @@ namespace gui {
 			if(ptrg & ctrl_mask_(ctrl::DOWN)) {
 				++pos;
 			}
-			int16_t vofs = rdr_st_.vofs_;
-			int16_t scn = SCN;
-			if(rdr_st_.num_ < scn) scn = rdr_st_.num_; 
+			int16_t scn = get_scn_();
+			int16_t top = rdr_st_.top_;
 			if(pos < 0) {
 				pos = 0;
-				vofs += FLN;
+				--top;
 			} else if(pos >= scn) {
 				pos = scn - 1;
-				vofs -= FLN;
-			}
-			int16_t lim = 0;
-			if(rdr_st_.num_ > scn) {
-				lim = -(rdr_st_.num_ - scn) * FLN;
+				++top;
 			}
-			if(vofs > 0) {
-				vofs = 0;
-			} else if(vofs < lim) {
-				vofs = lim;
+			int16_t lim = static_cast<int16_t>(didx_.size()) - scn;
+			if((top < 0 && base_ > 0) || (top > lim && (base_ + didx_.size()) < didx_.get_total())) {
+				// インデックスの外へスクロールする場合、前後を読み直す
+				if(rescan_(base_ + rdr_st_.top_ + (top < 0 ? -1 : 1))) {
+					rdr_st_.sel_pos_ = pos;
+					rdr_.clear(DEF_COLOR::Black);
+					return status::NONE;
+				}
 			}
-			if(vofs != rdr_st_.vofs_) {
+			if(top > lim) top = lim;
+			if(top < 0) top = 0;
+			if(top != static_cast<int16_t>(rdr_st_.top_)) {
 				rdr_.set_fore_color(DEF_COLOR::Black);
 				draw_sel_frame_(rdr_st_.sel_pos_);  // delete frame
-				int16_t match = -1;
-				if(vofs < rdr_st_.vofs_) {  // down
-					rdr_.scroll(FLN);
-					match = -vofs / FLN + (RDR::glc_type::height / FLN) - 1;
-				} else if(vofs > rdr_st_.vofs_) {  // up
-					rdr_.scroll(-FLN);
-					match = -vofs / FLN;
-				}
-				rdr_st_.vofs_ = vofs;
-				start_dir_draw_(match);
+				scroll_(top > static_cast<int16_t>(rdr_st_.top_));
 			}
-			
+
 			if(pos != rdr_st_.sel_pos_) {
 				rdr_.set_fore_color(DEF_COLOR::Black);
 				draw_sel_frame_(rdr_st_.sel_pos_);
@@ -478,18 +574,15 @@ namespace gui {
 			}
 
 			if(ptrg & ctrl_mask_(ctrl::SELECT)) {
-				uint32_t idx = rdr_st_.sel_pos_ - rdr_st_.vofs_ / FLN;
-				char root[FF_MAX_LFN + 1];
-				if(!utils::file_io::pwd(root, sizeof(root))) {
+				uint32_t idx = rdr_st_.top_ + rdr_st_.sel_pos_;
+				if(idx >= didx_.size()) {
 					return status::NONE;
 				}
-				if(!utils::file_io::get_dir_path(root, idx, dst, dstlen)) {
+				if(!utils::file_io::make_full_path(didx_.get_name(idx), dst, dstlen)) {
 					return status::NONE;
 				}
-				uint32_t l = strlen(dst);
-				if(dst[l - 1] == '/') {  // directory ?
-					pos_stack_.push(pos_t(rdr_st_.vofs_, rdr_st_.sel_pos_));
-					dst[l - 1] = 0;
+				if(didx_.get(idx).is_dir()) {
+					pos_stack_.push(pos_t(base_ + rdr_st_.top_, rdr_st_.sel_pos_));
 					utils::file_io::cd(dst);
 					rdr_.clear(DEF_COLOR::Black);
 					scan_dir_(false);
@@ -0,0 +1,415 @@
+//=====================================================================//
+/*!	@file
+	@brief	ファイラー・ベンチマーク（ホスト用） @n
+			RAM ディスク上に FAT16 イメージを作成して、5000 エントリーの @n
+			ディレクトリーを置き、旧方式（スクロール毎に dir_list で再走査）と、@n
+			dir_index（一度だけ走査、ソート、仮想化描画）を比較する。@n
+			インデックスに収まらない場合（既定のファイラー）も、全エントリーを辿れるか確かめる。@n
+			セクター読み出し数と、SD カード（SPI）相当の転送時間を見積もる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ff14/source/ff.h"
+#include "ff14/source/diskio.h"
+#include "common/vtx.hpp"
+#include "graphics/color.hpp"
+#include "graphics/filer.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t SECTOR_SIZE = 512;
+	static const uint32_t SECTORS = 131072;			///< 64M バイト
+	static const uint32_t CLUSTER = 4;				///< 2K バイト
+	static const uint32_t FAT_SIZE = 128;			///< FAT16 の１面のセクター数
+	static const uint32_t ROOT_ENTS = 512;
+
+	static const uint32_t SECTOR_US = 250;			///< SD カード（SPI 20MHz）の１セクター読み出し時間（想定）
+
+	std::vector<uint8_t> disk_;
+	uint32_t	read_sectors_ = 0;
+	uint32_t	fat_time_ = 0;
+
+
+	void put16_(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+	void put32_(uint8_t* p, uint32_t v) { put16_(p, v); put16_(p + 2, v >> 16); }
+
+
+	// FatFs の f_mkfs は無効（FF_USE_MKFS = 0）なので、SFD の FAT16 を直接作る
+	void format_()
+	{
+		disk_.assign(SECTORS * SECTOR_SIZE, 0);
+		uint8_t* bs = &disk_[0];
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(&bs[3], "MSDOS5.0", 8);
+		put16_(&bs[11], SECTOR_SIZE);
+		bs[13] = CLUSTER;
+		put16_(&bs[14], 1);				// reserved
+		bs[16] = 2;						// FATs
+		put16_(&bs[17], ROOT_ENTS);
+		put16_(&bs[19], 0);				// TotSec16
+		bs[21] = 0xF8;
+		put16_(&bs[22], FAT_SIZE);
+		put16_(&bs[24], 63);
+		put16_(&bs[26], 255);
+		put32_(&bs[28], 0);
+		put32_(&bs[32], SECTORS);
+		bs[36] = 0x80;
+		bs[38] = 0x29;
+		put32_(&bs[39], 0x12345678);
+		memcpy(&bs[43], "NO NAME    ", 11);
+		memcpy(&bs[54], "FAT16   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t* fat = &disk_[(1 + i * FAT_SIZE) * SECTOR_SIZE];
+			put16_(&fat[0], 0xFFF8);
+			put16_(&fat[2], 0xFFFF);
+		}
+	}
+
+
+	const char* words_[] = {
+		"Blue", "river", "Morning", "light", "Echo", "dance", "Silent", "road",
+		"Night", "train", "summer", "Rain", "Glass", "heart", "ocean", "Star",
+	};
+
+
+	bool make_files_(const char* dir, uint32_t num)
+	{
+		if(f_mkdir(dir) != FR_OK) return false;
+		char path[256];
+		for(uint32_t i = 0; i < 8; ++i) {
+			snprintf(path, sizeof(path), "%s/Album %02u", dir, i);
+			if(f_mkdir(path) != FR_OK) return false;
+		}
+		srand(1);
+		for(uint32_t i = 0; i < num; ++i) {
+			fat_time_ = rand();
+			snprintf(path, sizeof(path), "%s/%s %s %04u - %s.wav", dir,
+				words_[rand() % 16], words_[rand() % 16], (i * 7919) % 10000, words_[rand() % 16]);
+			FIL fp;
+			if(f_open(&fp, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+				printf("Can't create: '%s'\n", path);
+				return false;
+			}
+			uint8_t tmp[1024];
+			memset(tmp, i & 0xff, sizeof(tmp));
+			UINT bw;
+			f_write(&fp, tmp, rand() % sizeof(tmp), &bw);
+			f_close(&fp);
+		}
+		return true;
+	}
+
+
+	void report_(const char* title, double us, uint32_t sectors)
+	{
+		printf("%-32s %9.0f us (host), %6u sectors, %8.1f ms (SD)\n", title, us, sectors,
+			static_cast<double>(sectors) * SECTOR_US / 1000.0);
+	}
+
+
+	// gui::filer の描画をカウントするだけのレンダラー
+	struct glc_t {
+		static const int16_t width  = 480;
+		static const int16_t height = 272;
+	};
+
+	struct font_t {
+		static const int16_t height = 16;
+	};
+
+	struct kfont_t {
+		void flush_cash() { }
+	};
+
+	struct afont_t {
+		kfont_t	kfont_;
+		kfont_t& at_kfont() { return kfont_; }
+		vtx::spos get_text_size(const char* text) const { return vtx::spos(strlen(text) * 8, font_t::height); }
+	};
+
+	struct mock_render {
+		typedef glc_t glc_type;
+		typedef font_t font_type;
+
+		afont_t		font_;
+		uint32_t	text_;
+		uint32_t	fill_;
+		uint32_t	scroll_;
+		uint32_t	clear_;
+
+		mock_render() : font_(), text_(0), fill_(0), scroll_(0), clear_(0) { }
+
+		void set_fore_color(const graphics::share_color& c) { }
+		void set_back_color(const graphics::share_color& c) { }
+		void swap_color() { }
+		void clear(const graphics::share_color& c) { ++clear_; }
+		void fill_box(const vtx::srect& r) { ++fill_; }
+		void frame(const vtx::srect& r) { }
+		void round_box(const vtx::srect& r, int16_t rad) { }
+		void scroll(int16_t h) { ++scroll_; }
+		void draw_font(const vtx::spos& pos, char ch) { }
+		int16_t draw_text(const vtx::spos& pos, const char* text) { ++text_; return strlen(text) * 8; }
+		afont_t& at_font() { return font_; }
+	};
+
+	typedef gui::filer<mock_render, 8192, 256 * 1024> FILER;
+	typedef utils::dir_index<8192, 256 * 1024> DIDX;
+	typedef gui::filer<mock_render> DEF_FILER;
+
+	uint32_t ctrl_(FILER::ctrl c, bool mount = true)
+	{
+		uint32_t ctrl = 0;
+		if(mount) FILER::set(FILER::ctrl::MOUNT, ctrl);
+		FILER::set(c, ctrl);
+		return ctrl;
+	}
+}
+
+
+extern "C" {
+
+	DSTATUS disk_initialize(BYTE pdrv) { return 0; }
+	DSTATUS disk_status(BYTE pdrv) { return 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(buff, &disk_[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		read_sectors_ += count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(&disk_[sector * SECTOR_SIZE], buff, count * SECTOR_SIZE);
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<LBA_t*>(buff) = SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = SECTOR_SIZE;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		}
+		return RES_PARERR;
+	}
+
+	DWORD get_fattime(void)
+	{
+		// 2000/01/01 から適当に散らす
+		uint32_t d = fat_time_ % (20 * 365);
+		uint32_t year = 20 + d / 365;
+		uint32_t mon = (d % 365) / 31 + 1;
+		uint32_t day = (d % 31) + 1;
+		uint32_t t = fat_time_ >> 8;
+		return (year << 25) | (mon << 21) | (day << 16)
+			| (((t / 3600) % 24) << 11) | (((t / 60) % 60) << 5) | ((t % 60) / 2);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t num = 5000;
+	if(argc > 1) num = strtoul(argv[1], nullptr, 10);
+
+	format_();
+	FATFS fs;
+	if(f_mount(&fs, "", 1) != FR_OK) {
+		printf("Mount error\n");
+		return 1;
+	}
+	if(!make_files_("/music", num)) {
+		return 1;
+	}
+	const char* root = "/music";
+	printf("FAT16 %u MB RAM disk, '%s' %u entries, SD read %u us/sector\n",
+		SECTORS * SECTOR_SIZE / (1024 * 1024), root, num + 8, SECTOR_US);
+
+	// 旧方式：スクロール、選択毎にディレクトリー全体を走査
+	uint32_t total = 0;
+	char first[256] = { 0 };
+	char last[256] = { 0 };
+	{
+		fs.winsect = ~0;  // キャッシュを無効化
+		read_sectors_ = 0;
+		auto st = bench_usec();
+		utils::dir_list dl;
+		dl.start(root);
+		do {
+			dl.service(10, [&](const char* name, const FILINFO* fi, bool dir, void* opt) {
+				if(first[0] == 0) strcpy(first, name);
+				strcpy(last, name);
+			}, true, nullptr);
+		} while(dl.probe()) ;
+		total = dl.get_total();
+		report_("dir_list: full scan (per scroll)", bench_usec() - st, read_sectors_);
+	}
+
+	// 新方式：一度だけ走査してインデックス化
+	static DIDX didx;
+	{
+		fs.winsect = ~0;
+		read_sectors_ = 0;
+		auto st = bench_usec();
+		didx.start(root);
+		do {
+			didx.service(64);
+		} while(didx.probe()) ;
+		report_("dir_index: scan + name sort", bench_usec() - st, read_sectors_);
+		if(didx.size() != total || didx.is_overflow()) {
+			printf("Index error: %u / %u entries\n", didx.size(), total);
+			return 1;
+		}
+	}
+	{
+		static const struct { DIDX::sort_type type; const char* title; } sorts[] = {
+			{ DIDX::sort_type::NAME, "dir_index: re-sort by name" },
+			{ DIDX::sort_type::DATE, "dir_index: re-sort by date" },
+			{ DIDX::sort_type::SIZE, "dir_index: re-sort by size" },
+		};
+		for(const auto& t : sorts) {
+			read_sectors_ = 0;
+			auto st = bench_usec();
+			didx.sort(t.type);
+			report_(t.title, bench_usec() - st, read_sectors_);
+			for(uint32_t i = 1; i < didx.size(); ++i) {
+				const auto& a = didx.get(i - 1);
+				const auto& b = didx.get(i);
+				bool ok = a.is_dir() >= b.is_dir();
+				if(a.is_dir() == b.is_dir()) {
+					if(t.type == DIDX::sort_type::NAME) ok = strcasecmp(didx.get_name(i - 1), didx.get_name(i)) <= 0;
+					else if(t.type == DIDX::sort_type::DATE) ok = ((a.date() << 16) | a.time()) >= ((b.date() << 16) | b.time());
+					else ok = a.size() >= b.size();
+				}
+				if(!ok) {
+					printf("Sort error: %u\n", i);
+					return 1;
+				}
+			}
+		}
+		didx.sort(DIDX::sort_type::NAME);
+	}
+
+	// ファイラー：開いて全エントリーをスクロール
+	{
+		static mock_render rdr;
+		static FILER filer(rdr);
+		f_chdir(root);
+		char path[256];
+		filer.update(ctrl_(FILER::ctrl::MOUNT), path, sizeof(path));
+		fs.winsect = ~0;
+		read_sectors_ = 0;
+		uint32_t frames = 0;
+		filer.update(ctrl_(FILER::ctrl::OPEN), path, sizeof(path));
+		do {
+			filer.update(ctrl_(FILER::ctrl::MOUNT), path, sizeof(path));
+			++frames;
+		} while(filer.get_index().probe()) ;
+		filer.update(ctrl_(FILER::ctrl::MOUNT), path, sizeof(path));
+		printf("filer: open %u frames, %u sectors, %u rows drawn\n", frames, read_sectors_, rdr.text_);
+
+		read_sectors_ = 0;
+		rdr.text_ = 0;
+		auto st = bench_usec();
+		for(uint32_t i = 0; i < total; ++i) {
+			filer.update(ctrl_(FILER::ctrl::DOWN), path, sizeof(path));
+			filer.update(ctrl_(FILER::ctrl::MOUNT), path, sizeof(path));
+		}
+		auto us = bench_usec() - st;
+		printf("filer: %u steps, %u blits, %u rows drawn, %u sectors, %.2f us/step (host)\n",
+			total, rdr.scroll_, rdr.text_, read_sectors_, us / total);
+
+		filer.update(ctrl_(FILER::ctrl::SELECT), path, sizeof(path));
+		const auto& idx = filer.get_index();
+		printf("filer: select '%s' (%s)\n", path, idx.get_name(idx.size() - 1));
+		if(strstr(path, idx.get_name(idx.size() - 1)) == nullptr) {
+			printf("Select error\n");
+			return 1;
+		}
+	}
+
+	// 既定のファイラー：インデックスに収まらないので、一部を読み直しながら辿る
+	{
+		static mock_render rdr;
+		static DEF_FILER filer(rdr);
+		f_chdir(root);
+		char path[256];
+		auto wait = [&]() {
+			do {
+				filer.update(ctrl_(DEF_FILER::ctrl::MOUNT), path, sizeof(path));
+			} while(filer.get_index().probe()) ;
+			filer.update(ctrl_(DEF_FILER::ctrl::MOUNT), path, sizeof(path));
+		};
+		filer.update(ctrl_(DEF_FILER::ctrl::MOUNT), path, sizeof(path));
+		filer.update(ctrl_(DEF_FILER::ctrl::OPEN), path, sizeof(path));
+		wait();
+		const auto& idx = filer.get_index();
+		if(!idx.is_part() || idx.get_total() != total) {
+			printf("Default filer: not part (%u / %u entries)\n", idx.size(), idx.get_total());
+			return 1;
+		}
+
+		// 最後まで下り、先頭まで戻ってディレクトリーを選択、戻って最後のファイルを選択
+		read_sectors_ = 0;
+		uint32_t scans = 0;
+		auto st = bench_usec();
+		for(uint32_t i = 0; i < total; ++i) {
+			filer.update(ctrl_(DEF_FILER::ctrl::DOWN), path, sizeof(path));
+			if(idx.probe()) ++scans;
+			wait();
+		}
+		for(uint32_t i = 0; i < total; ++i) {
+			filer.update(ctrl_(DEF_FILER::ctrl::UP), path, sizeof(path));
+			if(idx.probe()) ++scans;
+			wait();
+		}
+		auto us = bench_usec() - st;
+		printf("default filer: %u steps, %u re-scans, %u sectors, %.2f us/step (host)\n",
+			total * 2, scans, read_sectors_, us / (total * 2));
+
+		filer.update(ctrl_(DEF_FILER::ctrl::SELECT), path, sizeof(path));
+		wait();
+		const char* p = strrchr(path, '/');
+		bool ok = p != nullptr && strcmp(p + 1, first) == 0;
+		printf("default filer: top '%s'\n", p != nullptr ? p + 1 : "");
+		filer.update(ctrl_(DEF_FILER::ctrl::BACK), path, sizeof(path));
+		wait();
+		for(uint32_t i = 0; i < total; ++i) {
+			filer.update(ctrl_(DEF_FILER::ctrl::DOWN), path, sizeof(path));
+			wait();
+		}
+		filer.update(ctrl_(DEF_FILER::ctrl::SELECT), path, sizeof(path));
+		p = strrchr(path, '/');
+		ok = ok && p != nullptr && strcmp(p + 1, last) == 0;
+		printf("default filer: last '%s'\n", p != nullptr ? p + 1 : "");
+		if(!ok) {
+			printf("Default filer error: expect '%s' ... '%s'\n", first, last);
+			return 1;
+		}
+	}
+
+	printf("Index RAM: %u bytes (ENTRY 8192, ARENA 256K), default filer: %u bytes\n",
+		static_cast<uint32_t>(sizeof(DIDX)),
+		static_cast<uint32_t>(sizeof(utils::dir_index<1024, 24 * 1024>)));
+	return 0;
+}
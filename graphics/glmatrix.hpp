@@ -63,7 +63,9 @@ namespace gl {
 		matrix() : mode_(mode::modelview),
 				   near_(0.0f), far_(1.0f),
 				   vp_x_(0), vp_y_(0), vp_w_(0), vp_h_(0)
-		{ }
+		{
+			for(auto& m : acc_) m.identity();
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -340,7 +342,7 @@ namespace gl {
 		 */
 		//-----------------------------------------------------------------//
 		const matrix_type& get_projection_matrix() const {
-			return acc_[mode::projection];
+			return acc_[static_cast<int>(mode::projection)];
 		};
 
 
@@ -351,7 +353,7 @@ namespace gl {
 		 */
 		//-----------------------------------------------------------------//
 		const matrix_type& get_modelview_matrix() const {
-			return acc_[mode::modelview];
+			return acc_[static_cast<int>(mode::modelview)];
 		};
 
 
@@ -362,7 +364,8 @@ namespace gl {
 		 */
 		//-----------------------------------------------------------------//
 		void world_matrix(matrix_type& mat) const {
-			mtx::matmul4(mat.m, acc_[mode::projection].m, acc_[mode::modelview].m);
+			mtx::matmul4(&mat[0], acc_[static_cast<int>(mode::projection)](),
+				acc_[static_cast<int>(mode::modelview)]());
 		}
 
 
@@ -15,7 +15,9 @@
 #include "common/circle.hpp"
 #include "common/vtx.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace graphics {
 
@@ -207,6 +209,32 @@ namespace graphics {
 		void swap_color() noexcept { std::swap(fore_color_, back_color_); }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	描画先フレームバッファの参照
+			@return 描画先フレームバッファ
+		*/
+		//-----------------------------------------------------------------//
+		T* at_fb() noexcept { return fb_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	描画先フレームバッファの設定 @n
+					※同じ大きさ（GLC::line_width x GLC::height）のバッファである事
+			@param[in]	fb	描画先（nullptr なら GLC のフレームバッファ）
+		*/
+		//-----------------------------------------------------------------//
+		void set_fb(T* fb = nullptr) noexcept
+		{
+			if(fb == nullptr) {
+				fb_ = static_cast<T*>(glc_.get_fbp());
+			} else {
+				fb_ = fb;
+			}
+		}
+
+
         //-----------------------------------------------------------------//
         /*!
             @brief  クリッピング領域の設定
@@ -257,8 +285,8 @@ namespace graphics {
 			if((stipple_ & m) == 0) {
 				return false;
 			}
-			if(static_cast<uint16_t>(pos.x) >= static_cast<uint16_t>(clip_.size.x)) return false;
-			if(static_cast<uint16_t>(pos.y) >= static_cast<uint16_t>(clip_.size.y)) return false;
+			if(static_cast<uint16_t>(pos.x - clip_.org.x) >= static_cast<uint16_t>(clip_.size.x)) return false;
+			if(static_cast<uint16_t>(pos.y - clip_.org.y) >= static_cast<uint16_t>(clip_.size.y)) return false;
 			fb_[pos.y * GLC::line_width + pos.x] = c;
 			return true;
 		}
@@ -274,8 +302,8 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		bool fast_plot(const vtx::spos& pos, T c) noexcept
 		{
-			if(static_cast<uint16_t>(pos.x) >= static_cast<uint16_t>(clip_.size.x)) return false;
-			if(static_cast<uint16_t>(pos.y) >= static_cast<uint16_t>(clip_.size.y)) return false;
+			if(static_cast<uint16_t>(pos.x - clip_.org.x) >= static_cast<uint16_t>(clip_.size.x)) return false;
+			if(static_cast<uint16_t>(pos.y - clip_.org.y) >= static_cast<uint16_t>(clip_.size.y)) return false;
 			fb_[pos.y * GLC::line_width + pos.x] = c;
 			return true;
 		}
@@ -306,9 +334,10 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void line_h(int16_t y, int16_t x, int16_t w) noexcept
 		{
-			if(w == 0) return;
+			if(w <= 0) return;
 
 			if(static_cast<uint16_t>(y) >= static_cast<uint16_t>(GLC::height << 4)) return;
+			if(static_cast<uint16_t>((y >> 4) - clip_.org.y) >= static_cast<uint16_t>(clip_.size.y)) return;
 			if(x < 0) {  // クリッピング
 				w += x;
 				x = 0;
@@ -318,33 +347,46 @@ namespace graphics {
 			if(static_cast<uint16_t>(x + w) >= static_cast<uint16_t>(GLC::width << 4)) {
 				w = (GLC::width << 4) - x;
 			}
-			uint16_t* out = &fb_[(y >> 4) * GLC::line_width + (x >> 4)];
+			if(w <= 0) return;
+
+			// クリップ領域は、ピクセル単位で切り取る（領域外と同じ描画結果にする為）
+			int16_t cx0 = clip_.org.x;
+			int16_t cx1 = clip_.end_x();
+			int16_t px = x >> 4;
+			uint16_t* out = &fb_[(y >> 4) * GLC::line_width];
 			auto end = x + w;
 			if(w < 16) {
+				if(px < cx0 || px >= cx1) return;
 				auto alpha = w | (w << 4);
 				auto c = share_color::blend(fore_color_.rgba8.unit, alpha, back_color_.rgba8.unit);
-				*out++ = share_color::to_565(c.r, c.g, c.b);				
+				out[px] = share_color::to_565(c.r, c.g, c.b);
 				return;
 			}
 			if((x & 15) != 0) {
-				uint8_t alpha = 16 - (x & 15);
-				alpha |= alpha << 4;  // 0 to 255
-				auto c = share_color::blend(fore_color_.rgba8.unit, alpha, back_color_.rgba8.unit);
-				*out++ = share_color::to_565(c.r, c.g, c.b);
+				if(px >= cx0 && px < cx1) {
+					uint8_t alpha = 16 - (x & 15);
+					alpha |= alpha << 4;  // 0 to 255
+					auto c = share_color::blend(fore_color_.rgba8.unit, alpha, back_color_.rgba8.unit);
+					out[px] = share_color::to_565(c.r, c.g, c.b);
+				}
+				++px;
 				x += 16;
 			}
-			int16_t i;
-			for(i = x; i < (end - 16); i += 16) {
-				*out++ = fore_color_.rgb565;
+			int16_t n = 0;
+			if(x < (end - 16)) n = ((end - 16) - x + 15) >> 4;
+			for(int16_t i = std::max(px, cx0); i < std::min(static_cast<int16_t>(px + n), cx1); ++i) {
+				out[i] = fore_color_.rgb565;
 			}
+			px += n;
+			if(px < cx0 || px >= cx1) return;
 			{
-				uint8_t alpha = (i & 15);
+				uint8_t alpha = (x & 15);
 				if(alpha != 0) {
 					alpha |= alpha << 4;  // 0 to 255
 					auto c = share_color::blend(fore_color_.rgba8.unit, alpha, back_color_.rgba8.unit);
-					*out = share_color::to_565(c.r, c.g, c.b);
+					out[px] = share_color::to_565(c.r, c.g, c.b);
 				} else {
-					*out = fore_color_.rgb565;
+					out[px] = fore_color_.rgb565;
 				}
 			}
 		}
@@ -361,15 +403,15 @@ namespace graphics {
 		void line_v(int16_t x, int16_t y, int16_t h) noexcept
 		{
 			if(h <= 0) return;
-			if(static_cast<uint16_t>(x) >= static_cast<uint16_t>(GLC::width)) return;
-			if(y < 0) {
-				h += y;
-				y = 0;
-			} else if(static_cast<uint16_t>(y) >= static_cast<uint16_t>(GLC::height)) {
-				return;
+			if(static_cast<uint16_t>(x - clip_.org.x) >= static_cast<uint16_t>(clip_.size.x)) return;
+			// クリッピング
+			if(y < clip_.org.y) {
+				h -= clip_.org.y - y;
+				y = clip_.org.y;
 			}
-			if(static_cast<uint16_t>(y + h) >= static_cast<uint16_t>(GLC::height)) {
-				h = GLC::height - y;
+			if(y >= clip_.end_y() || h <= 0) return;
+			if((y + h) > clip_.end_y()) {
+				h = clip_.end_y() - y;
 			}
 			uint16_t* out = &fb_[y * GLC::line_width + x];
 			for(int16_t i = 0; i < h; ++i) {
@@ -389,7 +431,10 @@ namespace graphics {
 		{
 			if(rect.size.x <= 0 || rect.size.y <= 0) return;
 
-			for(int16_t yy = rect.org.y; yy < (rect.org.y + rect.size.y); ++yy) {
+			// クリップ領域外のラインは走査しない
+			auto ys = std::max(rect.org.y, clip_.org.y);
+			auto ye = std::min(static_cast<int16_t>(rect.org.y + rect.size.y), clip_.end_y());
+			for(int16_t yy = ys; yy < ye; ++yy) {
 				line_h(yy << 4, rect.org.x << 4, rect.size.x << 4);
 			}
 		}
@@ -708,16 +753,17 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void scroll(int16_t h) noexcept
 		{
+			if(h >= GLC::height || h <= -GLC::height) return;
+
+			// 重なりのあるブロック転送（露出した領域は元の内容のまま）
 			if(h > 0) {
-				for(int32_t i = 0; i < (GLC::line_width * (GLC::height - h)); ++i) {
-					fb_[i] = fb_[i + (GLC::line_width * h)];
-				}
+				std::memmove(&fb_[0], &fb_[GLC::line_width * h],
+					sizeof(T) * GLC::line_width * (GLC::height - h));
 			} else if(h < 0) {
 				h = -h;
-				for(int32_t i = (GLC::line_width * (GLC::height - h)) - 1; i >= 0; --i) {
-					fb_[i + (GLC::line_width * h)] = fb_[i];
-				}
-			}			
+				std::memmove(&fb_[GLC::line_width * h], &fb_[0],
+					sizeof(T) * GLC::line_width * (GLC::height - h));
+			}
 		}
 
 
@@ -752,6 +798,9 @@ namespace graphics {
 		void draw_bitmap(const vtx::spos& pos, const void* img, const vtx::spos& ssz, bool back = false)
 		noexcept {
 			if(img == nullptr) return;
+			// クリップ領域外
+			if(pos.x >= clip_.end_x() || (pos.x + ssz.x) <= clip_.org.x) return;
+			if(pos.y >= clip_.end_y() || (pos.y + ssz.y) <= clip_.org.y) return;
 
 			const uint8_t* p = static_cast<const uint8_t*>(img);
 			uint8_t k = 1;
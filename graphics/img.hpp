@@ -33,4 +33,66 @@ namespace img {
 			grayscale(false), i_depth(0), r_depth(0), g_depth(0), b_depth(0), a_depth(0),
 			clut_num(0) { }
 	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	走査線スケーラー（最近傍） @n
+				デコードした画素の座標を、目標の枠に縦横比を保って収まる @n
+				大きさに写す。倍率は 16.16 の固定小数点で、除算は設定時だけ。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct scan_scaler {
+		uint32_t	k;		///< 倍率（０なら座標をそのまま使う）
+
+		scan_scaler() noexcept : k(0) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	倍率を設定
+			@param[in]	sw	デコードする画像の幅
+			@param[in]	sh	デコードする画像の高さ
+			@param[in]	tw	目標の幅（０なら等倍）
+			@param[in]	th	目標の高さ（０なら等倍）
+		*/
+		//-------------------------------------------------------------//
+		void set(uint16_t sw, uint16_t sh, uint16_t tw, uint16_t th) noexcept
+		{
+			if(sw == 0 || sh == 0 || tw == 0 || th == 0) {
+				k = 0;
+				return;
+			}
+			// 切り上げで、写した大きさが目標の幅、又は高さと一致する
+			auto kx = ((static_cast<uint32_t>(tw) << 16) + sw - 1) / sw;
+			auto ky = ((static_cast<uint32_t>(th) << 16) + sh - 1) / sh;
+			k = kx < ky ? kx : ky;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	座標を写す @n
+					画素 s は、map(s) から map(s + 1) の手前までを占める。@n
+					縮小では、その幅が０の画素は描画しない。
+			@param[in]	s	デコードした画像の座標
+			@return 目標の座標
+		*/
+		//-------------------------------------------------------------//
+		int16_t map(int16_t s) const noexcept {
+			return (static_cast<uint32_t>(s) * k) >> 16;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	写した後の大きさ
+			@param[in]	s	デコードした画像の幅、又は高さ
+			@return 目標での幅、又は高さ
+		*/
+		//-------------------------------------------------------------//
+		uint16_t size(uint16_t s) const noexcept {
+			return k == 0 ? s : map(s);
+		}
+	};
 }
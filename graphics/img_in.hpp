@@ -46,6 +46,9 @@ namespace img {
 		};
 		TYPE		type_;
 
+		uint16_t	target_w_;
+		uint16_t	target_h_;
+
 		bool img_switch_(const char* fname)
 		{
 			type_ = TYPE::NONE;
@@ -81,7 +84,7 @@ namespace img {
 #ifdef ENABLE_PNG
 			png_(plot),
 #endif
-			type_(TYPE::NONE) { }
+			type_(TYPE::NONE), target_w_(0), target_h_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -129,6 +132,25 @@ namespace img {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	目標の大きさを設定 @n
+					JPEG は、EXIF のサムネイル、又は、縮小デコードを使い、@n
+					縦横比を保ってこの枠に収まる大きさで描画する。@n
+					その場合、描画ファンクタは等倍で使う。
+			@param[in]	w	幅（０なら原寸）
+			@param[in]	h	高さ（０なら原寸）
+			@return 選択されているデコーダーが目標の大きさを扱えるなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool set_target(uint16_t w = 0, uint16_t h = 0) noexcept
+		{
+			target_w_ = w;
+			target_h_ = h;
+			return type_ == TYPE::JPEG;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	画像ファイルか確認する
@@ -243,6 +265,7 @@ namespace img {
 			case TYPE::BMP:
 				return bmp_.load(fin, opt);
 			case TYPE::JPEG:
+				jpeg_.set_target(target_w_, target_h_);
 				return jpeg_.load(fin, opt);
 #ifdef ENABLE_PNG
 			case TYPE::PNG:
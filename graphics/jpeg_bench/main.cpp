@@ -0,0 +1,512 @@
+//=====================================================================//
+/*!	@file
+	@brief	JPEG 縮小デコード・ベンチマーク（ホスト用） @n
+			RAM ディスク上に FAT16 イメージを作成して、ホストの libjpeg で作った @n
+			写真相当の JPEG（12M、3M、0.8M 画素、EXIF サムネイルの有無）を置き、@n
+			480x272（LCD 全体）と 160x120（ファイラーの縮小表示）の枠へ表示する @n
+			場合のデコード時間を比べる。@n
+			・picojpeg_in：原寸、目標の大きさ（サムネイル、１ブロック１画素、原寸）@n
+			・jpeg_in（libjpeg）：原寸、目標の大きさ（サムネイル、1/2, 1/4, 1/8）@n
+			時間は、ホストでのデコード時間と、SD カードの読み込み時間の見積もり。@n
+			画質は、原寸デコードを平均で縮小した画像との PSNR で確認する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "ff14/source/ff.h"
+#include "ff14/source/diskio.h"
+
+extern "C" {
+	uint16_t sci_length();
+	char sci_getch();
+	void sci_putch(char ch);
+	void sci_puts(const char* str);
+};
+
+#include "graphics/picojpeg_in.hpp"
+#include "graphics/jpeg_in.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t SECTOR_SIZE = 512;
+	static const uint32_t SECTORS = 65536;			///< 32M バイト
+	static const uint32_t CLUSTER = 8;				///< 4K バイト
+	static const uint32_t FAT_SIZE = 32;			///< FAT16 の１面のセクター数
+	static const uint32_t ROOT_ENTS = 512;
+
+	static const uint32_t SECTOR_US = 250;			///< SD カード（SPI 20MHz）の１セクター読み込み時間（想定）
+	static const uint32_t SEEK_US = 1000;			///< 連続しない読み込みの追加時間（想定）
+
+	static const int16_t LCD_W = 480;
+	static const int16_t LCD_H = 272;
+
+	std::vector<uint8_t> disk_;
+	uint32_t	last_sector_ = 0;
+	uint32_t	rd_sectors_ = 0;
+	uint32_t	seeks_ = 0;
+
+	void put16_(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+	void put32_(uint8_t* p, uint32_t v) { put16_(p, v); put16_(p + 2, v >> 16); }
+
+
+	// FatFs の f_mkfs は無効（FF_USE_MKFS = 0）なので、SFD の FAT16 を直接作る
+	void format_()
+	{
+		disk_.assign(SECTORS * SECTOR_SIZE, 0);
+		uint8_t* bs = &disk_[0];
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(&bs[3], "MSDOS5.0", 8);
+		put16_(&bs[11], SECTOR_SIZE);
+		bs[13] = CLUSTER;
+		put16_(&bs[14], 1);				// reserved
+		bs[16] = 2;						// FATs
+		put16_(&bs[17], ROOT_ENTS);
+		put16_(&bs[19], 0);				// TotSec16
+		bs[21] = 0xF8;
+		put16_(&bs[22], FAT_SIZE);
+		put16_(&bs[24], 63);
+		put16_(&bs[26], 255);
+		put32_(&bs[28], 0);
+		put32_(&bs[32], SECTORS);
+		bs[36] = 0x80;
+		bs[38] = 0x29;
+		put32_(&bs[39], 0x12345678);
+		memcpy(&bs[43], "NO NAME    ", 11);
+		memcpy(&bs[54], "FAT16   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+		for(uint32_t i = 0; i < 2; ++i) {
+			uint8_t* fat = &disk_[(1 + i * FAT_SIZE) * SECTOR_SIZE];
+			put16_(&fat[0], 0xFFF8);
+			put16_(&fat[2], 0xFFFF);
+		}
+	}
+
+
+	bool write_file_(const char* name, const std::vector<uint8_t>& src)
+	{
+		FIL fp;
+		if(f_open(&fp, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+			printf("Can't create: '%s'\n", name);
+			return false;
+		}
+		UINT bw;
+		f_write(&fp, src.data(), src.size(), &bw);
+		f_close(&fp);
+		return bw == src.size();
+	}
+
+
+	//-----------------------------------------------------------------//
+	// 写真の代わりの画像（なだらかな階調、縁、細かい模様）
+	//-----------------------------------------------------------------//
+	struct image_t {
+		uint32_t	w;
+		uint32_t	h;
+		std::vector<uint8_t>	rgb;
+	};
+
+
+	void make_photo_(uint32_t w, uint32_t h, image_t& img)
+	{
+		img.w = w;
+		img.h = h;
+		img.rgb.resize(w * h * 3);
+		uint32_t seed = 12345;
+		uint8_t* p = img.rgb.data();
+		for(uint32_t y = 0; y < h; ++y) {
+			float fy = static_cast<float>(y) / h;
+			for(uint32_t x = 0; x < w; ++x) {
+				float fx = static_cast<float>(x) / w;
+				float r = 128.0f + 100.0f * std::sin(fx * 5.0f) * std::cos(fy * 3.0f);
+				float g = 40.0f + 170.0f * fy;
+				float b = 200.0f - 150.0f * fx * fy;
+				// 空と地面、建物の縁
+				if(fy > 0.6f + 0.1f * std::sin(fx * 9.0f)) { r *= 0.5f; g = 120.0f; b *= 0.4f; }
+				if(((x / (w / 16)) & 1) && fy > 0.3f && fy < 0.55f) { r = 220.0f; g = 210.0f; b = 190.0f; }
+				// 細かい模様（葉や砂利の代わり）
+				seed = seed * 1103515245 + 12345;
+				float n = static_cast<float>((seed >> 16) & 31) - 16.0f;
+				p[0] = std::min(255.0f, std::max(0.0f, r + n));
+				p[1] = std::min(255.0f, std::max(0.0f, g + n));
+				p[2] = std::min(255.0f, std::max(0.0f, b + n));
+				p += 3;
+			}
+		}
+	}
+
+
+	// 平均で縮小（参照画像、サムネイル）
+	void box_(const image_t& src, uint32_t w, uint32_t h, image_t& dst)
+	{
+		dst.w = w;
+		dst.h = h;
+		dst.rgb.assign(w * h * 3, 0);
+		for(uint32_t y = 0; y < h; ++y) {
+			uint32_t sy0 = y * src.h / h;
+			uint32_t sy1 = std::max(sy0 + 1, (y + 1) * src.h / h);
+			for(uint32_t x = 0; x < w; ++x) {
+				uint32_t sx0 = x * src.w / w;
+				uint32_t sx1 = std::max(sx0 + 1, (x + 1) * src.w / w);
+				uint32_t sum[3] = { 0 };
+				for(uint32_t sy = sy0; sy < sy1; ++sy) {
+					const uint8_t* s = &src.rgb[(sy * src.w + sx0) * 3];
+					for(uint32_t sx = sx0; sx < sx1; ++sx) {
+						sum[0] += s[0]; sum[1] += s[1]; sum[2] += s[2];
+						s += 3;
+					}
+				}
+				uint32_t n = (sy1 - sy0) * (sx1 - sx0);
+				for(uint32_t i = 0; i < 3; ++i) {
+					dst.rgb[(y * w + x) * 3 + i] = (sum[i] + n / 2) / n;
+				}
+			}
+		}
+	}
+
+
+	std::vector<uint8_t> encode_(const image_t& img, const std::vector<uint8_t>* app1 = nullptr)
+	{
+		jpeg_compress_struct cinfo;
+		jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&jerr);
+		jpeg_create_compress(&cinfo);
+		unsigned char* out = nullptr;
+		unsigned long len = 0;
+		jpeg_mem_dest(&cinfo, &out, &len);
+		cinfo.image_width = img.w;
+		cinfo.image_height = img.h;
+		cinfo.input_components = 3;
+		cinfo.in_color_space = JCS_RGB;
+		jpeg_set_defaults(&cinfo);		// YCbCr 4:2:0（カメラと同じ）
+		jpeg_set_quality(&cinfo, 85, TRUE);
+		cinfo.write_JFIF_header = app1 == nullptr;
+		jpeg_start_compress(&cinfo, TRUE);
+		if(app1 != nullptr) {
+			jpeg_write_marker(&cinfo, JPEG_APP0 + 1, app1->data(), app1->size());
+		}
+		while(cinfo.next_scanline < cinfo.image_height) {
+			JSAMPROW row = const_cast<uint8_t*>(&img.rgb[cinfo.next_scanline * img.w * 3]);
+			jpeg_write_scanlines(&cinfo, &row, 1);
+		}
+		jpeg_finish_compress(&cinfo);
+		std::vector<uint8_t> t(out, out + len);
+		jpeg_destroy_compress(&cinfo);
+		free(out);
+		return t;
+	}
+
+
+	// EXIF（APP1）: IFD0（Orientation）と IFD1（サムネイル）
+	std::vector<uint8_t> exif_(const std::vector<uint8_t>& thumb)
+	{
+		std::vector<uint8_t> t;
+		auto add = [&t](const void* src, uint32_t len) {
+			auto p = static_cast<const uint8_t*>(src);
+			t.insert(t.end(), p, p + len);
+		};
+		auto a16 = [&t](uint32_t v) { t.push_back(v); t.push_back(v >> 8); };
+		auto a32 = [&t](uint32_t v) {
+			t.push_back(v); t.push_back(v >> 8); t.push_back(v >> 16); t.push_back(v >> 24);
+		};
+		auto ent = [&](uint16_t tag, uint16_t type, uint32_t val) {
+			a16(tag); a16(type); a32(1);
+			if(type == 3) { a16(val); a16(0); } else a32(val);
+		};
+		add("Exif\0\0", 6);
+		add("II", 2); a16(0x2A); a32(8);
+		// IFD0
+		a16(1);
+		ent(0x0112, 3, 1);
+		const uint32_t ifd1 = 8 + 2 + 12 + 4;
+		a32(ifd1);
+		// IFD1
+		a16(3);
+		const uint32_t data = ifd1 + 2 + 3 * 12 + 4;
+		ent(0x0103, 3, 6);
+		ent(0x0201, 4, data);
+		ent(0x0202, 4, thumb.size());
+		a32(0);
+		add(thumb.data(), thumb.size());
+		return t;
+	}
+
+
+	struct file_t {
+		const char*	name;
+		uint32_t	w;
+		uint32_t	h;
+		bool		exif;
+	};
+
+	static const file_t files_[] = {
+		{ "/DSC_0001.JPG", 4000, 3000, true },
+		{ "/DSC_0002.JPG", 4000, 3000, false },
+		{ "/IMG_0003.JPG", 2048, 1536, false },
+		{ "/IMG_0004.JPG", 1024,  768, false },
+	};
+	static const uint32_t FILE_NUM = sizeof(files_) / sizeof(files_[0]);
+
+	image_t		ref_[FILE_NUM];		///< 原寸（libjpeg でデコードした画像）
+
+
+	void decode_ref_(const std::vector<uint8_t>& src, image_t& img)
+	{
+		jpeg_decompress_struct cinfo;
+		jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&jerr);
+		jpeg_create_decompress(&cinfo);
+		jpeg_mem_src(&cinfo, const_cast<uint8_t*>(src.data()), src.size());
+		jpeg_read_header(&cinfo, TRUE);
+		cinfo.out_color_space = JCS_RGB;
+		jpeg_start_decompress(&cinfo);
+		img.w = cinfo.output_width;
+		img.h = cinfo.output_height;
+		img.rgb.resize(img.w * img.h * 3);
+		while(cinfo.output_scanline < cinfo.output_height) {
+			JSAMPROW row = &img.rgb[cinfo.output_scanline * img.w * 3];
+			jpeg_read_scanlines(&cinfo, &row, 1);
+		}
+		jpeg_finish_decompress(&cinfo);
+		jpeg_destroy_decompress(&cinfo);
+	}
+
+
+	bool make_image_()
+	{
+		format_();
+		static FATFS fs;
+		if(f_mount(&fs, "", 1) != FR_OK) {
+			printf("Mount error\n");
+			return false;
+		}
+		bool ok = true;
+		for(uint32_t i = 0; i < FILE_NUM; ++i) {
+			const auto& f = files_[i];
+			image_t img;
+			make_photo_(f.w, f.h, img);
+			std::vector<uint8_t> jpg;
+			if(f.exif) {
+				image_t th;
+				box_(img, 160, 120, th);
+				auto app1 = exif_(encode_(th));
+				jpg = encode_(img, &app1);
+			} else {
+				jpg = encode_(img);
+			}
+			decode_ref_(jpg, ref_[i]);
+			ok &= write_file_(f.name, jpg);
+			printf("  %-14s %4ux%-4u %s %7u bytes\n", f.name, f.w, f.h,
+				f.exif ? "EXIF thumb 160x120" : "no thumbnail      ",
+				static_cast<uint32_t>(jpg.size()));
+		}
+		return ok;
+	}
+
+
+	//-----------------------------------------------------------------//
+	// 描画先（LCD の大きさ、はみ出した画素は数えるだけ）
+	//-----------------------------------------------------------------//
+	uint8_t		fb_[LCD_W * LCD_H * 3];
+	uint32_t	plots_;
+	int16_t		max_x_;
+	int16_t		max_y_;
+
+	void fb_clear_()
+	{
+		memset(fb_, 0, sizeof(fb_));
+		plots_ = 0;
+		max_x_ = -1;
+		max_y_ = -1;
+	}
+
+
+	void fb_plot_(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b)
+	{
+		++plots_;
+		if(x < 0 || y < 0 || x >= LCD_W || y >= LCD_H) return;
+		auto p = &fb_[(y * LCD_W + x) * 3];
+		p[0] = r; p[1] = g; p[2] = b;
+		if(x > max_x_) max_x_ = x;
+		if(y > max_y_) max_y_ = y;
+	}
+
+
+	struct plot_t {
+		void operator() (int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+			fb_plot_(x, y, r, g, b);
+		}
+	};
+	plot_t		plot_;
+
+	typedef img::picojpeg_in<plot_t> PJPEG;
+	PJPEG		pjpeg_(plot_);
+
+	img::jpeg_in	jpeg_;
+
+
+	// 描画した範囲と、原寸を平均で縮小した画像の PSNR
+	double psnr_(const image_t& ref)
+	{
+		uint32_t w = max_x_ + 1;
+		uint32_t h = max_y_ + 1;
+		if(w == 0 || h == 0) return 0.0;
+		image_t tmp;
+		box_(ref, w, h, tmp);
+		double se = 0.0;
+		for(uint32_t y = 0; y < h; ++y) {
+			for(uint32_t x = 0; x < w; ++x) {
+				for(uint32_t i = 0; i < 3; ++i) {
+					double d = static_cast<double>(fb_[(y * LCD_W + x) * 3 + i])
+						- tmp.rgb[(y * w + x) * 3 + i];
+					se += d * d;
+				}
+			}
+		}
+		double mse = se / (w * h * 3);
+		if(mse == 0.0) return 99.0;
+		return 10.0 * std::log10(255.0 * 255.0 / mse);
+	}
+
+
+	const char* mode_str_(img::jpeg_scan::MODE mode, bool target)
+	{
+		switch(mode) {
+		case img::jpeg_scan::MODE::THUMB: return "EXIF thumb";
+		case img::jpeg_scan::MODE::SCALE: return "DCT scale";
+		default: return target ? "full+scaler" : "full";
+		}
+	}
+
+
+	template <class DEC>
+	void run_(const char* dec_name, DEC& dec, uint32_t idx, uint16_t tw = 0, uint16_t th = 0)
+	{
+		const auto& f = files_[idx];
+		const bool target = tw > 0 && th > 0;
+		dec.set_target(tw, th);
+
+		// １回の計測が短い場合は繰り返して平均
+		double t = 0.0;
+		uint32_t loop = 0;
+		uint32_t sectors = 0;
+		uint32_t seeks = 0;
+		bool ok = true;
+		do {
+			fb_clear_();
+			utils::file_io fin;
+			if(!fin.open(f.name, "rb")) {
+				printf("Can't open: '%s'\n", f.name);
+				return;
+			}
+			rd_sectors_ = 0;
+			seeks_ = 0;
+			last_sector_ = 0;
+			auto st = bench_usec();
+			ok &= dec.load(fin);
+			t += bench_usec() - st;
+			fin.close();
+			sectors = rd_sectors_;
+			seeks = seeks_;
+			++loop;
+		} while(t < 200e3 && loop < 50) ;
+		t /= loop;
+
+		double sd = (static_cast<double>(sectors) * SECTOR_US + static_cast<double>(seeks) * SEEK_US) / 1e3;
+		char tmp[16];
+		if(target) snprintf(tmp, sizeof(tmp), "%dx%d", tw, th);
+		else strcpy(tmp, "-");
+		printf("  %-7s %-14s %-7s %-11s %9.2f ms %6u sect %8.1f ms %9u plot",
+			dec_name, f.name, tmp, mode_str_(dec.get_mode(), target), t / 1e3, sectors, sd, plots_);
+		if(target) {
+			printf(" %3dx%-3d %5.1f dB", max_x_ + 1, max_y_ + 1, psnr_(ref_[idx]));
+		}
+		printf("%s\n", ok ? "" : " (error)");
+	}
+}
+
+
+extern "C" {
+
+	uint16_t sci_length() { return 0; }
+	char sci_getch() { return 0; }
+	void sci_putch(char ch) { putchar(ch); }
+	void sci_puts(const char* str) { fputs(str, stdout); }
+
+	void gr_plot(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b)
+	{
+		fb_plot_(x, y, r, g, b);
+	}
+
+	DSTATUS disk_initialize(BYTE pdrv) { return 0; }
+	DSTATUS disk_status(BYTE pdrv) { return 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(buff, &disk_[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		rd_sectors_ += count;
+		if(sector != last_sector_) ++seeks_;
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+	{
+		if((sector + count) > SECTORS) return RES_PARERR;
+		memcpy(&disk_[sector * SECTOR_SIZE], buff, count * SECTOR_SIZE);
+		last_sector_ = sector + count;
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<LBA_t*>(buff) = SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = SECTOR_SIZE;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		}
+		return RES_PARERR;
+	}
+
+	DWORD get_fattime(void)
+	{
+		return (40 << 25) | (1 << 21) | (1 << 16);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	printf("JPEG downscaled decode bench (target %dx%d)\n", LCD_W, LCD_H);
+	if(!make_image_()) {
+		printf("Image error\n");
+		return 1;
+	}
+
+	printf("\n  decoder file           target  path          host time   read   SD (model)      plots  output    PSNR\n");
+	for(uint32_t i = 0; i < FILE_NUM; ++i) {
+		run_("pico", pjpeg_, i);
+		run_("pico", pjpeg_, i, LCD_W, LCD_H);
+		run_("pico", pjpeg_, i, 160, 120);
+		run_("libjpeg", jpeg_, i);
+		run_("libjpeg", jpeg_, i, LCD_W, LCD_H);
+		run_("libjpeg", jpeg_, i, 160, 120);
+	}
+	return 0;
+}
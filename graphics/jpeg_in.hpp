@@ -1,7 +1,10 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	JPEG 画像クラス
+	@brief	JPEG 画像クラス @n
+			目標の大きさを設定すると、EXIF のサムネイル、又は、libjpeg の @n
+			scale_num/scale_denom（1/2, 1/4, 1/8）で縮小してデコードし、@n
+			走査線スケーラーで目標の大きさに写す。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -16,6 +19,8 @@ extern "C" {
 };
 #include "common/file_io.hpp"
 #include "common/format.hpp"
+#include "graphics/img.hpp"
+#include "graphics/jpeg_scan.hpp"
 
 extern "C" { void gr_plot(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b); };
 
@@ -30,6 +35,11 @@ namespace img {
 
 		int		error_code_;
 
+		uint16_t	target_w_;
+		uint16_t	target_h_;
+		jpeg_scan::MODE	mode_;
+		scan_scaler	scaler_;
+
 		static const uint32_t INPUT_BUF_SIZE = 4096;
 
 		struct fio_src_mgr {
@@ -145,13 +155,58 @@ namespace img {
 ///			error_code_ = 1;
 		}
 
+
+		void plot_pixel_(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) noexcept
+		{
+			if(scaler_.k == 0) {
+				gr_plot(x, y, r, g, b);
+				return;
+			}
+			auto y0 = scaler_.map(y);
+			auto y1 = scaler_.map(y + 1);
+			if(y0 == y1) return;
+			auto x0 = scaler_.map(x);
+			auto x1 = scaler_.map(x + 1);
+			for(auto yy = y0; yy < y1; ++yy) {
+				for(auto xx = x0; xx < x1; ++xx) {
+					gr_plot(xx, yy, r, g, b);
+				}
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		jpeg_in() { }
+		jpeg_in() : error_code_(0), target_w_(0), target_h_(0), mode_(jpeg_scan::MODE::FULL),
+			scaler_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	目標の大きさを設定 @n
+					設定すると、ロードした画像は、縦横比を保ってこの枠に収まる @n
+					大きさで描画される。
+			@param[in]	w	幅（０なら原寸）
+			@param[in]	h	高さ（０なら原寸）
+		*/
+		//-----------------------------------------------------------------//
+		void set_target(uint16_t w = 0, uint16_t h = 0)
+		{
+			target_w_ = w;
+			target_h_ = h;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のロードで選んだデコード方法を取得
+			@return デコード方法
+		*/
+		//-----------------------------------------------------------------//
+		jpeg_scan::MODE get_mode() const { return mode_; }
 
 
 		//-----------------------------------------------------------------//
@@ -191,6 +246,20 @@ namespace img {
 				return false;
 			}
 
+			// 目標の大きさを下回らない、最も小さいデコード方法を選ぶ
+			mode_ = jpeg_scan::MODE::FULL;
+			uint8_t shift = 0;
+			if(target_w_ > 0 && target_h_ > 0) {
+				jpeg_scan::info_t hdr;
+				if(jpeg_scan::scan(fin, hdr)) {
+					mode_ = jpeg_scan::select(hdr, target_w_, target_h_,
+						(1 << 1) | (1 << 2) | (1 << 3), false, shift);
+					if(mode_ == jpeg_scan::MODE::THUMB) {  // サムネイルは EOI で終わる
+						fin.seek(utils::file_io::SEEK::SET, hdr.thumb_ofs);
+					}
+				}
+			}
+
 			struct jpeg_decompress_struct cinfo;
 			struct jpeg_error_mgr errmgr;
 			memset(&cinfo, 0, sizeof(cinfo));
@@ -224,12 +293,16 @@ namespace img {
 			cinfo.dct_method = JDCT_FASTEST;
 			cinfo.do_fancy_upsampling = FALSE;
 #endif
-			utils::format("%d, %d\n") % cinfo.image_width % cinfo.image_height;
+//			utils::format("%d, %d\n") % cinfo.image_width % cinfo.image_height;
+			if(shift > 0) {
+				cinfo.scale_num = 1;
+				cinfo.scale_denom = 1 << shift;
+			}
 
 			// 解凍の開始
 			error_code_ = 0;
 
-			utils::format("Input Scan: %d\n") % cinfo.input_scan_number;
+//			utils::format("Input Scan: %d\n") % cinfo.input_scan_number;
 
 //			cinfo.image_height = 8;
 
@@ -260,25 +333,31 @@ namespace img {
 				return false;
 			}
 
-			uint8_t line[cinfo.output_components * cinfo.image_width];
+			// 縮小後の大きさ（output_width, output_height）で走査線を受け取る
+			scaler_.set(cinfo.output_width, cinfo.output_height, target_w_, target_h_);
+			uint8_t line[cinfo.output_components * cinfo.output_width];
 			uint8_t* lines[1];
 			lines[0] = &line[0];
-			for(int y = 0; y < cinfo.output_scan_number; ++y) {
+			while(cinfo.output_scanline < cinfo.output_height) {
+				int y = cinfo.output_scanline;
 				jpeg_read_scanlines(&cinfo, (JSAMPLE**)lines, 1);
+				if(scaler_.k != 0 && scaler_.map(y) == scaler_.map(y + 1)) {
+					continue;  // 縮小で使わない走査線
+				}
 				uint8_t* p = &line[0];
 				if(cinfo.output_components == 4) {
-					for(uint32_t x = 0; x < cinfo.image_width; ++x) {
-						gr_plot(x, y, p[0], p[1], p[2]);
+					for(uint32_t x = 0; x < cinfo.output_width; ++x) {
+						plot_pixel_(x, y, p[0], p[1], p[2]);
 						p += 4;
 					}
 				} else if(cinfo.output_components == 3) {
-					for(uint32_t x = 0; x < cinfo.image_width; ++x) {
-						gr_plot(x, y, p[0], p[1], p[2]);
+					for(uint32_t x = 0; x < cinfo.output_width; ++x) {
+						plot_pixel_(x, y, p[0], p[1], p[2]);
 						p += 3;
 					}
 				} else if(cinfo.output_components == 1) {
-					for(uint32_t x = 0; x < cinfo.image_width; ++x) {
-						gr_plot(x, y, p[0], p[0], p[0]);
+					for(uint32_t x = 0; x < cinfo.output_width; ++x) {
+						plot_pixel_(x, y, p[0], p[0], p[0]);
 						++p;
 					}
 				}
@@ -0,0 +1,262 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	JPEG ヘッダー走査クラス @n
+			マーカーを読み飛ばして（データは読まない）、画像の大きさと、@n
+			EXIF（APP1）に埋め込まれたサムネイルの位置を取得する。@n
+			目標の大きさから、縮小デコードの方法を選ぶ。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "common/file_io.hpp"
+
+namespace img {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	JPEG ヘッダー走査クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class jpeg_scan {
+	public:
+
+		//=============================================================//
+		/*!
+			@brief	縮小デコードの方法
+		*/
+		//=============================================================//
+		enum class MODE : uint8_t {
+			FULL,	///< 原寸でデコード
+			SCALE,	///< DCT の段階で縮小（1/2, 1/4, 1/8）
+			THUMB,	///< EXIF のサムネイルをデコード
+		};
+
+
+		//=============================================================//
+		/*!
+			@brief	ヘッダー情報
+		*/
+		//=============================================================//
+		struct info_t {
+			uint16_t	width;
+			uint16_t	height;
+			bool		baseline;		///< ベースライン（SOF0, SOF1）
+			uint16_t	thumb_width;	///< サムネイルの幅（無ければ０）
+			uint16_t	thumb_height;
+			bool		thumb_baseline;
+			uint32_t	thumb_ofs;		///< サムネイルの位置（ファイルの先頭から）
+			uint32_t	thumb_len;
+			info_t() noexcept : width(0), height(0), baseline(false),
+				thumb_width(0), thumb_height(0), thumb_baseline(false),
+				thumb_ofs(0), thumb_len(0) { }
+		};
+
+	private:
+		static bool read8_(utils::file_io& fin, uint8_t& v) noexcept
+		{
+			return fin.read(&v, 1) == 1;
+		}
+
+
+		static bool read16_(utils::file_io& fin, uint16_t& v, bool be = true) noexcept
+		{
+			uint8_t tmp[2];
+			if(fin.read(tmp, 2) != 2) return false;
+			if(be) v = (static_cast<uint16_t>(tmp[0]) << 8) | tmp[1];
+			else v = (static_cast<uint16_t>(tmp[1]) << 8) | tmp[0];
+			return true;
+		}
+
+
+		static bool read32_(utils::file_io& fin, uint32_t& v, bool be) noexcept
+		{
+			uint16_t a;
+			uint16_t b;
+			if(!read16_(fin, a, be) || !read16_(fin, b, be)) return false;
+			if(be) v = (static_cast<uint32_t>(a) << 16) | b;
+			else v = (static_cast<uint32_t>(b) << 16) | a;
+			return true;
+		}
+
+
+		// APP1 の TIFF 構造から、IFD1 の JPEGInterchangeFormat(Length) を探す
+		static void exif_(utils::file_io& fin, uint32_t top, uint32_t len, info_t& t) noexcept
+		{
+			char sig[6];
+			if(len < (6 + 8) || fin.read(sig, 6) != 6) return;
+			if(std::memcmp(sig, "Exif\0\0", 6) != 0) return;
+			const uint32_t base = top + 6;
+			const uint32_t size = len - 6;
+
+			uint8_t bo[2];
+			if(fin.read(bo, 2) != 2) return;
+			bool be;
+			if(bo[0] == 'M' && bo[1] == 'M') be = true;
+			else if(bo[0] == 'I' && bo[1] == 'I') be = false;
+			else return;
+			uint16_t magic;
+			uint32_t ifd;
+			if(!read16_(fin, magic, be) || magic != 0x2A) return;
+			if(!read32_(fin, ifd, be)) return;
+
+			// IFD0 は読み飛ばして、次の IFD（IFD1）へ
+			uint16_t num;
+			if(ifd < 8 || (ifd + 2) > size) return;
+			fin.seek(utils::file_io::SEEK::SET, base + ifd);
+			if(!read16_(fin, num, be)) return;
+			ifd += 2 + static_cast<uint32_t>(num) * 12;
+			if((ifd + 4) > size) return;
+			fin.seek(utils::file_io::SEEK::SET, base + ifd);
+			if(!read32_(fin, ifd, be) || ifd == 0 || (ifd + 2) > size) return;
+
+			fin.seek(utils::file_io::SEEK::SET, base + ifd);
+			if(!read16_(fin, num, be)) return;
+			uint32_t ofs = 0;
+			uint32_t thl = 0;
+			for(uint16_t i = 0; i < num; ++i) {
+				uint16_t tag;
+				uint16_t type;
+				uint32_t cnt;
+				uint32_t val;
+				if(!read16_(fin, tag, be) || !read16_(fin, type, be)) return;
+				if(!read32_(fin, cnt, be) || !read32_(fin, val, be)) return;
+				if(type == 3) {  // SHORT は、値の先頭に詰められている
+					val = be ? (val >> 16) : (val & 0xffff);
+				}
+				if(tag == 0x0201) ofs = val;
+				else if(tag == 0x0202) thl = val;
+			}
+			if(ofs == 0 || thl == 0 || (ofs + thl) > size) return;
+			t.thumb_ofs = base + ofs;
+			t.thumb_len = thl;
+		}
+
+
+		// SOF までのマーカーを走査する（fin は SOI の直後）
+		static bool marker_(utils::file_io& fin, info_t& t, bool exif) noexcept
+		{
+			while(1) {
+				uint8_t m;
+				if(!read8_(fin, m)) return false;
+				if(m != 0xff) return false;
+				do {  // フィルバイト
+					if(!read8_(fin, m)) return false;
+				} while(m == 0xff) ;
+				if(m == 0xd9 || m == 0xda) {  // EOI, SOS より前に SOF が無い
+					return false;
+				}
+				if(m == 0x01 || (m >= 0xd0 && m <= 0xd7)) {  // 長さの無いマーカー
+					continue;
+				}
+				uint16_t len;
+				if(!read16_(fin, len) || len < 2) return false;
+				auto top = fin.tell();
+				if(m >= 0xc0 && m <= 0xcf && m != 0xc4 && m != 0xc8 && m != 0xcc) {
+					uint8_t prec;
+					if(!read8_(fin, prec)) return false;
+					if(!read16_(fin, t.height) || !read16_(fin, t.width)) return false;
+					t.baseline = (m == 0xc0 || m == 0xc1);
+					return true;
+				}
+				if(m == 0xe1 && exif && t.thumb_ofs == 0) {
+					exif_(fin, top, len - 2, t);
+				}
+				fin.seek(utils::file_io::SEEK::SET, top + len - 2);
+			}
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ヘッダーを走査する @n
+					ファイルの位置は、呼び出し前に戻す。
+			@param[in]	fin	file_io クラス（JPEG の先頭）
+			@param[out]	t	ヘッダー情報
+			@return 画像の大きさが取得できれば「true」
+		*/
+		//-------------------------------------------------------------//
+		static bool scan(utils::file_io& fin, info_t& t) noexcept
+		{
+			auto pos = fin.tell();
+			t = info_t();
+			uint16_t soi;
+			bool ret = false;
+			if(read16_(fin, soi) && soi == 0xffd8) {
+				ret = marker_(fin, t, true);
+			}
+			if(ret && t.thumb_ofs != 0) {
+				info_t th;
+				fin.seek(utils::file_io::SEEK::SET, t.thumb_ofs);
+				if(read16_(fin, soi) && soi == 0xffd8 && marker_(fin, th, false)) {
+					t.thumb_width  = th.width;
+					t.thumb_height = th.height;
+					t.thumb_baseline = th.baseline;
+				}
+			}
+			fin.seek(utils::file_io::SEEK::SET, pos);
+			return ret;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	縮小デコードの方法を選ぶ @n
+					目標の枠に収まる大きさ（縦横比は保つ）を、下回らない範囲で、@n
+					最も小さくデコードできる方法を選ぶ。@n
+					サムネイルは、縦横比が本体と 1/16 以内で一致する場合に使う。
+			@param[in]	t		ヘッダー情報
+			@param[in]	tw		目標の幅
+			@param[in]	th		目標の高さ
+			@param[in]	shifts	デコーダーが扱える縮小（bit n で 1/(2^n)）
+			@param[in]	baseline	サムネイルがベースラインである必要があれば「true」
+			@param[out]	shift	縮小のシフト数（SCALE の場合）
+			@return 方法
+		*/
+		//-------------------------------------------------------------//
+		static MODE select(const info_t& t, uint16_t tw, uint16_t th, uint8_t shifts,
+			bool baseline, uint8_t& shift) noexcept
+		{
+			shift = 0;
+			if(tw == 0 || th == 0 || t.width == 0 || t.height == 0) return MODE::FULL;
+
+			const uint32_t w = t.width;
+			const uint32_t h = t.height;
+			uint32_t ow;
+			uint32_t oh;
+			if((static_cast<uint32_t>(tw) * h) <= (static_cast<uint32_t>(th) * w)) {
+				ow = tw;
+				oh = h * tw / w;
+			} else {
+				oh = th;
+				ow = w * th / h;
+			}
+
+			if(t.thumb_width > 0 && t.thumb_height > 0 && (!baseline || t.thumb_baseline)) {
+				const uint32_t sw = t.thumb_width;
+				const uint32_t sh = t.thumb_height;
+				uint32_t a = sw * h;
+				uint32_t b = sh * w;
+				uint32_t d = a > b ? a - b : b - a;
+				if(sw >= ow && sh >= oh && (d * 16) <= a) {
+					return MODE::THUMB;
+				}
+			}
+
+			for(uint8_t s = 3; s > 0; --s) {
+				if((shifts & (1 << s)) == 0) continue;
+				uint32_t sw = (w + (1 << s) - 1) >> s;
+				uint32_t sh = (h + (1 << s) - 1) >> s;
+				if(sw >= ow && sh >= oh) {
+					shift = s;
+					return MODE::SCALE;
+				}
+			}
+			return MODE::FULL;
+		}
+	};
+}
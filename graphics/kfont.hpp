@@ -11,10 +11,17 @@
 #include <cstdint>
 #include "ff14/source/ff.h"
 #include "common/vtx.hpp"
+#include "graphics/kfont_ukf.hpp"
 
 // 漢字フォントデータをＳＤカード上に置いて、キャッシュアクセスする場合有効にする
 // #define CASH_KFONT
 
+// 漢字フォントデータを Unicode コンテナ（UKF）で扱う場合有効にする @n
+// ※ff_uni2oem（CP932 変換）を使わずに、Unicode で直接グリフを引く @n
+// ※CASH_KFONT の場合「/kfont16.ukf」、そうでない場合「kfont16u.cpp」をリンク @n
+// ※コンテナは「graphics/kfont_gen」で作成する
+// #define UKF_KFONT
+
 #ifdef CASH_KFONT
 extern "C" {
 	int fatfs_get_mount();
@@ -73,6 +80,53 @@ namespace graphics {
 		};
 		kanji_cash cash_[CASHN];
 		uint8_t cash_idx_;
+#ifdef UKF_KFONT
+		// ページ・テーブルと、最後に使ったページのマップを保持
+		uint16_t	ukf_page_[256];
+		uint16_t	ukf_map_[256];
+		uint16_t	ukf_map_no_;
+		uint32_t	ukf_glyph_org_;
+		bool		ukf_ready_;
+
+		bool load_ukf_(FIL& fp, uint16_t code) noexcept
+		{
+			UINT rs;
+			if(!ukf_ready_) {
+				kfont_ukf::header_t h;
+				if(f_read(&fp, &h, sizeof(h), &rs) != FR_OK || rs != sizeof(h)) {
+					return false;
+				}
+				if(!kfont_ukf::check(h, WIDTH, HEIGHT)) {
+					return false;
+				}
+				if(f_read(&fp, ukf_page_, sizeof(ukf_page_), &rs) != FR_OK || rs != sizeof(ukf_page_)) {
+					return false;
+				}
+				ukf_glyph_org_ = kfont_ukf::glyph_offset(h);
+				ukf_map_no_ = kfont_ukf::NONE;
+				ukf_ready_ = true;
+			}
+
+			auto m = ukf_page_[code >> 8];
+			if(m == kfont_ukf::NONE) return false;
+			if(m != ukf_map_no_) {
+				if(f_lseek(&fp, kfont_ukf::MAP_OFS + static_cast<uint32_t>(m) * sizeof(ukf_map_)) != FR_OK) {
+					return false;
+				}
+				if(f_read(&fp, ukf_map_, sizeof(ukf_map_), &rs) != FR_OK || rs != sizeof(ukf_map_)) {
+					return false;
+				}
+				ukf_map_no_ = m;
+			}
+			auto n = ukf_map_[code & 0xff];
+			if(n == kfont_ukf::NONE) return false;
+
+			if(f_lseek(&fp, ukf_glyph_org_ + static_cast<uint32_t>(n) * FONTS) != FR_OK) {
+				return false;
+			}
+			return f_read(&fp, &cash_[cash_idx_].bitmap[0], FONTS, &rs) == FR_OK && rs == FONTS;
+		}
+#endif
 #endif
 
 		static uint16_t sjis_to_liner_(uint16_t sjis)
@@ -110,6 +164,10 @@ namespace graphics {
 		kfont() noexcept : code_(0), cnt_(0) 
 #ifdef CASH_KFONT
 			, cash_(), cash_idx_(0)
+#ifdef UKF_KFONT
+			, ukf_page_{ 0 }, ukf_map_{ 0 }, ukf_map_no_(kfont_ukf::NONE), ukf_glyph_org_(0)
+			, ukf_ready_(false)
+#endif
 #endif
 			{ }
 
@@ -142,6 +200,9 @@ namespace graphics {
 				cash_[i].code = 0;
 			}
 			cash_idx_ = 0;
+#ifdef UKF_KFONT
+			ukf_ready_ = false;
+#endif
 #endif
 		}
 
@@ -180,6 +241,24 @@ namespace graphics {
 
 			if(fatfs_get_mount() == 0) return nullptr;
 #endif
+#ifdef UKF_KFONT
+#ifdef CASH_KFONT
+			FIL fp;
+			if(f_open(&fp, "/kfont16.ukf", FA_READ) != FR_OK) {
+				return nullptr;
+			}
+			bool ok = load_ukf_(fp, code);
+			f_close(&fp);
+			if(!ok) {
+				cash_[cash_idx_].code = 0;
+				return nullptr;
+			}
+			cash_[cash_idx_].code = code;
+			return &cash_[cash_idx_].bitmap[0];
+#else
+			return kfont_ukf::find(kfont_bitmap::kfont_start, code);
+#endif
+#else
 			uint32_t lin = sjis_to_liner_(ff_uni2oem(code, FF_CODE_PAGE));
 
 			if(lin == 0xffff) {
@@ -208,6 +287,7 @@ namespace graphics {
 			return &cash_[cash_idx_].bitmap[0];
 #else
 			return &kfont_bitmap::kfont_start[lin * FONTS];
+#endif
 #endif
 		}
 
@@ -0,0 +1,328 @@
+//=====================================================================//
+/*!	@file
+	@brief	Unicode 漢字フォント・コンテナ（UKF）ジェネレーター（ホスト用） @n
+			kfont16.bin（SJIS 順のリニア配置）、又は BDF ファイルから、@n
+			graphics/kfont_ukf.hpp 形式のコンテナ（.ukf）、又は、@n
+			kfont_bitmap::kfont_start[] のソースコード（.cpp）を作成する。@n
+			SJIS から Unicode への変換は、ターゲットと同じ ff14/source/ffunicode.c
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "ff14/source/ff.h"
+#include "graphics/kfont_ukf.hpp"
+
+namespace {
+
+	typedef graphics::kfont_ukf UKF;
+
+	typedef std::vector<uint8_t> GLYPH;
+	typedef std::map<uint16_t, GLYPH> GLYPHS;
+
+	uint32_t	width_  = 16;
+	uint32_t	height_ = 16;
+	bool		verbose_ = false;
+
+
+	void help_(const char* cmd)
+	{
+		printf("Unicode kanji font container (UKF) generator\n");
+		printf("Usage: %s [options] input output\n", cmd);
+		printf("    input       kfont16.bin (SJIS linear) or BDF file (*.bdf)\n");
+		printf("    output      UKF container (*.ukf) or C++ source (*.cpp)\n");
+		printf("    -s W H      glyph size for SJIS linear input (default: 16 16)\n");
+		printf("    -v          verbose\n");
+	}
+
+
+	uint32_t glyph_size_() { return (width_ * height_ + 7) / 8; }
+
+
+	bool ext_(const std::string& file, const char* ext)
+	{
+		auto n = strlen(ext);
+		return file.size() > n && strcasecmp(file.c_str() + file.size() - n, ext) == 0;
+	}
+
+
+	// kfont.hpp の sjis_to_liner_ の逆変換
+	uint16_t liner_to_sjis_(uint32_t lin)
+	{
+		static const uint32_t loa = (0x7e + 1 - 0x40) + (0xfc + 1 - 0x80);
+		uint32_t up = lin / loa;
+		uint32_t lo = lin % loa;
+		if(up <= (0x9f - 0x81)) up += 0x81;
+		else up += 0xe0 - (0x9f + 1 - 0x81);
+		if(up > 0xef) return 0;
+		if(lo <= (0x7e - 0x40)) lo += 0x40;
+		else lo += 0x80 - (0x7e + 1 - 0x40);
+		return (up << 8) | lo;
+	}
+
+
+	uint16_t jis_to_sjis_(uint16_t jis)
+	{
+		uint32_t j1 = jis >> 8;
+		uint32_t j2 = jis & 0xff;
+		if(j1 < 0x21 || j1 > 0x7e || j2 < 0x21 || j2 > 0x7e) return 0;
+		uint32_t s1 = ((j1 + 1) >> 1) + (j1 <= 0x5e ? 0x70 : 0xb0);
+		uint32_t s2;
+		if(j1 & 1) s2 = j2 + (j2 >= 0x60 ? 0x20 : 0x1f);
+		else s2 = j2 + 0x7e;
+		return (s1 << 8) | s2;
+	}
+
+
+	bool blank_(const GLYPH& g)
+	{
+		for(auto c : g) {
+			if(c != 0) return false;
+		}
+		return true;
+	}
+
+
+	bool load_liner_(const char* file, GLYPHS& glyphs)
+	{
+		FILE* fp = fopen(file, "rb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't open input: '%s'\n", file);
+			return false;
+		}
+		GLYPH g(glyph_size_());
+		uint32_t lin = 0;
+		while(fread(&g[0], g.size(), 1, fp) == 1) {
+			auto sjis = liner_to_sjis_(lin);
+			++lin;
+			if(sjis == 0) break;
+			auto code = ff_oem2uni(sjis, 932);
+			if(code == 0) continue;
+			// 空きエリアは飛ばす（全角スペースは残す）
+			if(blank_(g) && code != 0x3000) continue;
+			glyphs[code] = g;
+		}
+		fclose(fp);
+		if(verbose_) {
+			printf("SJIS linear: %u slots, %u glyphs\n", lin, static_cast<uint32_t>(glyphs.size()));
+		}
+		return true;
+	}
+
+
+	bool load_bdf_(const char* file, GLYPHS& glyphs)
+	{
+		FILE* fp = fopen(file, "rb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't open input: '%s'\n", file);
+			return false;
+		}
+
+		int fw = 0, fh = 0, fx = 0, fy = 0;
+		bool jis = false;
+		int enc = -1;
+		int bw = 0, bh = 0, bx = 0, by = 0;
+		int row = -1;
+		GLYPH g;
+		uint32_t skip = 0;
+		char line[1024];
+		while(fgets(line, sizeof(line), fp) != nullptr) {
+			if(row >= 0) {
+				if(strncmp(line, "ENDCHAR", 7) == 0) {
+					row = -1;
+					uint16_t code = 0;
+					if(enc > 0 && enc <= 0xffff) {
+						code = jis ? ff_oem2uni(jis_to_sjis_(enc), 932) : enc;
+					}
+					if(code != 0) {
+						glyphs[code] = g;
+					} else {
+						++skip;
+					}
+					continue;
+				}
+				// セルの左上を原点に配置（はみ出しはクリップ）
+				int y = (fh + fy) - (bh + by) + row;
+				unsigned long long bits = strtoull(line, nullptr, 16);
+				int nbits = static_cast<int>(strspn(line, "0123456789abcdefABCDEF")) * 4;
+				for(int i = 0; i < bw && i < nbits; ++i) {
+					if(nbits > 64 || ((bits >> (nbits - 1 - i)) & 1) == 0) continue;
+					int x = bx - fx + i;
+					if(x < 0 || x >= static_cast<int>(width_) || y < 0 || y >= static_cast<int>(height_)) continue;
+					uint32_t pos = y * width_ + x;
+					g[pos >> 3] |= 1 << (pos & 7);
+				}
+				++row;
+			} else if(sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &fw, &fh, &fx, &fy) == 4) {
+				width_  = fw;
+				height_ = fh;
+			} else if(strncmp(line, "CHARSET_REGISTRY", 16) == 0) {
+				jis = strstr(line, "JISX0208") != nullptr || strstr(line, "jisx0208") != nullptr;
+			} else if(sscanf(line, "ENCODING %d", &enc) == 1) {
+			} else if(sscanf(line, "BBX %d %d %d %d", &bw, &bh, &bx, &by) == 4) {
+			} else if(strncmp(line, "BITMAP", 6) == 0) {
+				g.assign(glyph_size_(), 0);
+				row = 0;
+			}
+		}
+		fclose(fp);
+		if(fw <= 0 || fh <= 0) {
+			fprintf(stderr, "No FONTBOUNDINGBOX: '%s'\n", file);
+			return false;
+		}
+		if(verbose_) {
+			printf("BDF: %dx%d (%s), %u glyphs, %u skipped\n", fw, fh, jis ? "JIS X 0208" : "ISO 10646",
+				static_cast<uint32_t>(glyphs.size()), skip);
+		}
+		return true;
+	}
+
+
+	void build_(const GLYPHS& glyphs, std::vector<uint8_t>& out)
+	{
+		std::vector<uint16_t> page(256, UKF::NONE);
+		std::vector<uint16_t> map;
+		uint16_t n = 0;
+		for(const auto& t : glyphs) {
+			auto hi = t.first >> 8;
+			if(page[hi] == UKF::NONE) {
+				page[hi] = map.size() / 256;
+				map.resize(map.size() + 256, UKF::NONE);
+			}
+			map[page[hi] * 256 + (t.first & 0xff)] = n;
+			++n;
+		}
+
+		UKF::header_t h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, "UKF1", 4);
+		h.width = width_;
+		h.height = height_;
+		h.glyph_size = glyph_size_();
+		h.pages = map.size() / 256;
+		h.glyphs = glyphs.size();
+
+		out.clear();
+		auto put = [&out](const void* src, size_t len) {
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			out.insert(out.end(), p, p + len);
+		};
+		put(&h, sizeof(h));
+		put(&page[0], page.size() * sizeof(uint16_t));
+		put(&map[0], map.size() * sizeof(uint16_t));
+		for(const auto& t : glyphs) {
+			put(&t.second[0], t.second.size());
+		}
+	}
+
+
+	bool verify_(const GLYPHS& glyphs, const std::vector<uint8_t>& ukf)
+	{
+		for(const auto& t : glyphs) {
+			auto p = UKF::find(&ukf[0], t.first);
+			if(p == nullptr || memcmp(p, &t.second[0], t.second.size()) != 0) {
+				fprintf(stderr, "Verify error: U+%04X\n", t.first);
+				return false;
+			}
+		}
+		for(uint32_t code = 0; code < 0x10000; ++code) {
+			if(glyphs.find(code) == glyphs.end() && UKF::find(&ukf[0], code) != nullptr) {
+				fprintf(stderr, "Verify error: U+%04X (not in font)\n", code);
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	bool write_cpp_(const char* file, const char* input, const std::vector<uint8_t>& ukf)
+	{
+		FILE* fp = fopen(file, "wb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't create output: '%s'\n", file);
+			return false;
+		}
+		fprintf(fp, "#include \"graphics/kfont.hpp\"\n\n");
+		fprintf(fp, "// Unicode 漢字フォント・コンテナ（UKF、UKF_KFONT 用）\n");
+		fprintf(fp, "// kfont_gen により「%s」から作成\n\n", input);
+		fprintf(fp, "namespace graphics {\n\n");
+		fprintf(fp, "alignas(4) const uint8_t kfont_bitmap::kfont_start[] = {\n");
+		for(size_t i = 0; i < ukf.size(); ++i) {
+			fprintf(fp, "0x%02X,", ukf[i]);
+			if((i & 15) == 15 || (i + 1) == ukf.size()) fputc('\n', fp);
+		}
+		fprintf(fp, "};\n\n}\n");
+		fclose(fp);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* input = nullptr;
+	const char* output = nullptr;
+	for(int i = 1; i < argc; ++i) {
+		const char* p = argv[i];
+		if(strcmp(p, "-s") == 0 && (i + 2) < argc) {
+			width_  = strtoul(argv[++i], nullptr, 10);
+			height_ = strtoul(argv[++i], nullptr, 10);
+		} else if(strcmp(p, "-v") == 0) {
+			verbose_ = true;
+		} else if(p[0] == '-') {
+			help_(argv[0]);
+			return 1;
+		} else if(input == nullptr) {
+			input = p;
+		} else {
+			output = p;
+		}
+	}
+	if(input == nullptr || output == nullptr || width_ == 0 || height_ == 0
+		|| width_ > 255 || height_ > 255) {
+		help_(argv[0]);
+		return 1;
+	}
+
+	GLYPHS glyphs;
+	if(ext_(input, ".bdf")) {
+		if(!load_bdf_(input, glyphs)) return 1;
+	} else {
+		if(!load_liner_(input, glyphs)) return 1;
+	}
+	if(glyphs.empty()) {
+		fprintf(stderr, "No glyphs: '%s'\n", input);
+		return 1;
+	}
+
+	std::vector<uint8_t> ukf;
+	build_(glyphs, ukf);
+	if(!verify_(glyphs, ukf)) {
+		return 1;
+	}
+
+	const UKF::header_t& h = *reinterpret_cast<const UKF::header_t*>(&ukf[0]);
+	printf("%ux%u, %u glyphs, %u pages, %u bytes (index %u bytes)\n",
+		h.width, h.height, h.glyphs, h.pages, static_cast<uint32_t>(ukf.size()),
+		UKF::glyph_offset(h));
+
+	if(ext_(output, ".cpp")) {
+		if(!write_cpp_(output, input, ukf)) return 1;
+	} else {
+		FILE* fp = fopen(output, "wb");
+		if(fp == nullptr) {
+			fprintf(stderr, "Can't create output: '%s'\n", output);
+			return 1;
+		}
+		fwrite(&ukf[0], ukf.size(), 1, fp);
+		fclose(fp);
+	}
+	return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	Unicode 漢字フォント・コンテナ（UKF）定義 @n
+			Unicode（BMP）の上位８ビットで引くページ・テーブル（２５６エントリー）@n
+			と、ページ毎のグリフ番号テーブル（２５６エントリー）の２段で、@n
+			グリフを引く。グリフはコード順に詰めて格納する。@n
+			  header_t          16 bytes @n
+			  page[256]         uint16_t, マップ番号（0xFFFF: グリフ無し）@n
+			  map[pages][256]   uint16_t, グリフ番号（0xFFFF: グリフ無し）@n
+			  glyph[glyphs]     glyph_size bytes @n
+			※リトル・エンディアン、ビットマップは LSB ファーストで連続
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace graphics {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	Unicode 漢字フォント・コンテナ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct kfont_ukf {
+
+		static constexpr uint16_t NONE = 0xffff;	///< グリフ無し
+
+		//=================================================================//
+		/*!
+			@brief	ヘッダー
+		*/
+		//=================================================================//
+		struct header_t {
+			char		magic[4];		///< "UKF1"
+			uint8_t		width;			///< フォントの横幅
+			uint8_t		height;			///< フォントの高さ
+			uint16_t	glyph_size;		///< グリフのバイト数
+			uint16_t	pages;			///< マップの数
+			uint16_t	reserved;
+			uint32_t	glyphs;			///< グリフの数
+		};
+
+		static constexpr uint32_t PAGE_OFS = sizeof(header_t);
+		static constexpr uint32_t MAP_OFS  = PAGE_OFS + 256 * sizeof(uint16_t);
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ヘッダーの検査
+			@param[in]	h		ヘッダー
+			@param[in]	width	フォントの横幅
+			@param[in]	height	フォントの高さ
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool check(const header_t& h, uint8_t width, uint8_t height) noexcept
+		{
+			return h.magic[0] == 'U' && h.magic[1] == 'K' && h.magic[2] == 'F' && h.magic[3] == '1'
+				&& h.width == width && h.height == height
+				&& h.glyph_size == ((width * height) + 7) / 8;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	グリフ領域のオフセット
+			@param[in]	h		ヘッダー
+			@return グリフ領域のオフセット
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t glyph_offset(const header_t& h) noexcept
+		{
+			return MAP_OFS + static_cast<uint32_t>(h.pages) * 256 * sizeof(uint16_t);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	メモリー上のコンテナからグリフを引く
+			@param[in]	top		コンテナの先頭（２バイト境界）
+			@param[in]	code	文字コード（unicode）
+			@return グリフ（無い場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		static const uint8_t* find(const uint8_t* top, uint16_t code) noexcept
+		{
+			const header_t& h = *reinterpret_cast<const header_t*>(top);
+			const uint16_t* page = reinterpret_cast<const uint16_t*>(top + PAGE_OFS);
+			auto m = page[code >> 8];
+			if(m == NONE) return nullptr;
+			const uint16_t* map = reinterpret_cast<const uint16_t*>(top + MAP_OFS);
+			auto n = map[(static_cast<uint32_t>(m) << 8) | (code & 0xff)];
+			if(n == NONE) return nullptr;
+			return top + glyph_offset(h) + static_cast<uint32_t>(n) * h.glyph_size;
+		}
+	};
+}
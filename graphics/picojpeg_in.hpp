@@ -3,7 +3,10 @@
 /*!	@file
 	@brief	PicoJPEG クラス @n
 			picojpeg.[hc] の C++ ラッパー @n
-			https://github.com/richgel999/picojpeg を参照
+			https://github.com/richgel999/picojpeg を参照 @n
+			目標の大きさを設定すると、EXIF のサムネイル、又は、@n
+			１ブロック１画素（DC 成分のみ）の縮小モードでデコードして、@n
+			走査線スケーラーで目標の大きさに写す。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -14,6 +17,7 @@
 #include <cstdlib>
 #include "graphics/img.hpp"
 #include "graphics/picojpeg.h"
+#include "graphics/jpeg_scan.hpp"
 #include "common/file_io.hpp"
 #include "common/format.hpp"
 
@@ -37,6 +41,13 @@ namespace img {
 		int16_t		width_;
 		int16_t		height_;
 
+		uint16_t	target_w_;
+		uint16_t	target_h_;
+		jpeg_scan::MODE	mode_;
+		scan_scaler	scaler_;
+		uint16_t	dec_w_;
+		uint16_t	dec_h_;
+
 		struct data_t {
 			utils::file_io&	fin_;
 			uint32_t		file_ofs_;
@@ -57,35 +68,54 @@ namespace img {
 		}
 
 
-		bool pixel_(utils::file_io& fin) noexcept
+		void plot_pixel_(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) noexcept
+		{
+			if(scaler_.k == 0) {
+				plot_(x, y, r, g, b);
+				return;
+			}
+			auto y0 = scaler_.map(y);
+			auto y1 = scaler_.map(y + 1);
+			if(y0 == y1) return;
+			auto x0 = scaler_.map(x);
+			auto x1 = scaler_.map(x + 1);
+			for(auto yy = y0; yy < y1; ++yy) {
+				for(auto xx = x0; xx < x1; ++xx) {
+					plot_(xx, yy, r, g, b);
+				}
+			}
+		}
+
+
+		bool pixel_(bool reduce) noexcept
 		{
 			int16_t xt = 0;
 			int16_t yt = 0;
 			while((status_ = pjpeg_decode_mcu()) == 0) {
-
-#if 0
-				if(reduce_) {
+				if(reduce) {
+					// １ブロック（8x8）が１画素
 					auto row_blocks = image_info_.m_MCUWidth  >> 3;
 					auto col_blocks = image_info_.m_MCUHeight >> 3;
 					int16_t xx = xt * row_blocks;
 					int16_t yy = yt * col_blocks;
 					if(image_info_.m_scanType == PJPG_GRAYSCALE) {
 						auto gs = image_info_.m_pMCUBufR[0];
-						plot_(xx, yy, gs, gs, gs);
+						plot_pixel_(xx, yy, gs, gs, gs);
 					} else {
 						for(int16_t y = 0; y < col_blocks; ++y) {
+							if((yy + y) >= dec_h_) break;
 							auto ofs = y * 128;
 							for(int16_t x = 0; x < row_blocks; ++x) {
+								if((xx + x) >= dec_w_) break;
 								auto r = image_info_.m_pMCUBufR[ofs];
 								auto g = image_info_.m_pMCUBufG[ofs];
 								auto b = image_info_.m_pMCUBufB[ofs];
 								ofs += 64;
-								plot_(xx + x, yy + y, r, g, b);
+								plot_pixel_(xx + x, yy + y, r, g, b);
 							}
 						}
 					}
 				} else {
-#endif
 					auto xx = xt * image_info_.m_MCUWidth;
 					auto yy = yt * image_info_.m_MCUHeight;
 					for(int16_t y = 0; y < image_info_.m_MCUHeight; y += 8) {
@@ -100,7 +130,7 @@ namespace img {
 								for(int16_t by = 0; by < by_limit; ++by) {
 									for(int16_t bx = 0; bx < bx_limit; ++bx) {
 										auto gs = *pGS++;
-										plot_(x + xx + bx, y + yy + by, gs, gs, gs);
+										plot_pixel_(x + xx + bx, y + yy + by, gs, gs, gs);
 									}
 									pGS += (8 - bx_limit);
 								}
@@ -113,7 +143,7 @@ namespace img {
 										auto r = *pR++; 
 										auto g = *pG++; 
 										auto b = *pB++;
-										plot_(x + xx + bx, y + yy + by, r, g, b);
+										plot_pixel_(x + xx + bx, y + yy + by, r, g, b);
 									}
 									pR += (8 - bx_limit);
 									pG += (8 - bx_limit);
@@ -122,7 +152,7 @@ namespace img {
 							}
 						}
 					}
-//				}  // reduce_
+				}
 				++xt;
 				if(xt >= image_info_.m_MCUSPerRow) {
 					xt = 0;
@@ -149,7 +179,9 @@ namespace img {
 		picojpeg_in(PLOT& plot) noexcept : plot_(plot),
 			image_info_(),
 			status_(0),
-			width_(0), height_(0)
+			width_(0), height_(0),
+			target_w_(0), target_h_(0), mode_(jpeg_scan::MODE::FULL), scaler_(),
+			dec_w_(0), dec_h_(0)
 		{ }
 
 
@@ -162,6 +194,49 @@ namespace img {
 		uint8_t get_status() const noexcept { return status_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	目標の大きさを設定 @n
+					設定すると、ロードした画像は、縦横比を保ってこの枠に収まる @n
+					大きさで描画される（描画ファンクタは等倍で使う）。
+			@param[in]	w	幅（０なら原寸）
+			@param[in]	h	高さ（０なら原寸）
+		*/
+		//-----------------------------------------------------------------//
+		void set_target(uint16_t w = 0, uint16_t h = 0) noexcept
+		{
+			target_w_ = w;
+			target_h_ = h;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のロードで選んだデコード方法を取得
+			@return デコード方法
+		*/
+		//-----------------------------------------------------------------//
+		jpeg_scan::MODE get_mode() const noexcept { return mode_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のロードで描画した幅を取得
+			@return 幅
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_width() const noexcept { return width_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のロードで描画した高さを取得
+			@return 高さ
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_height() const noexcept { return height_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ファイル拡張子を返す
@@ -280,7 +355,24 @@ namespace img {
 			data_t t(fin);
 			t.file_ofs_  = 0;
 			t.file_size_ = fin.get_file_size();
+
+			// 目標の大きさを下回らない、最も小さいデコード方法を選ぶ
+			mode_ = jpeg_scan::MODE::FULL;
 			uint8_t reduce = 0;
+			if(target_w_ > 0 && target_h_ > 0) {
+				jpeg_scan::info_t hdr;
+				if(jpeg_scan::scan(fin, hdr)) {
+					uint8_t shift;
+					mode_ = jpeg_scan::select(hdr, target_w_, target_h_, (1 << 3), true, shift);
+					if(mode_ == jpeg_scan::MODE::THUMB) {
+						fin.seek(utils::file_io::SEEK::SET, hdr.thumb_ofs);
+						t.file_size_ = hdr.thumb_len;
+					} else if(mode_ == jpeg_scan::MODE::SCALE) {
+						reduce = 1;
+					}
+				}
+			}
+
 			status_ = pjpeg_decode_init(&image_info_, pjpeg_callback_, &t, reduce);
 			if(status_) {
 				if(status_ == PJPG_UNSUPPORTED_MODE) {
@@ -291,14 +383,14 @@ namespace img {
 				return false;
 			}
 
-#if 0
 			// In reduce mode output 1 pixel per 8x8 block.
-			width_  = reduce_ ?
-				(image_info_.m_MCUSPerRow * image_info_.m_MCUWidth)  / 8 : image_info_.m_width;
-			height_ = reduce_ ?
-				(image_info_.m_MCUSPerCol * image_info_.m_MCUHeight) / 8 : image_info_.m_height;
-#endif
-			return pixel_(fin);
+			dec_w_ = reduce ? (image_info_.m_width  + 7) / 8 : image_info_.m_width;
+			dec_h_ = reduce ? (image_info_.m_height + 7) / 8 : image_info_.m_height;
+			scaler_.set(dec_w_, dec_h_, target_w_, target_h_);
+			width_  = scaler_.size(dec_w_);
+			height_ = scaler_.size(dec_h_);
+
+			return pixel_(reduce != 0);
 		}
 
 
@@ -177,6 +177,7 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		void set_ratio(float ratio) noexcept {
 			if(ratio >= 0.0f && ratio <= 1.0f) {
+				if(ratio_ != ratio) invalidate();
 				ratio_ = ratio;
 			}
 		}
@@ -1,13 +1,21 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	Tiny 3D Glaphics Library (Tiny OpenGL)
+	@brief	Tiny 3D Glaphics Library (Tiny OpenGL) @n
+			頂点は「renderring()」でまとめて変換し、三角形は、固定小数点の @n
+			エッジ関数（ハーフスペース）で、8x8 のタイル毎にラスタライズする。@n
+			・スクリーン座標は小数４ビット、Z は１６ビット（Z バッファは外部で用意）@n
+			・グーロー・シェーディング（頂点カラーの補間）@n
+			・背面カリング、視錐台カリング（手前の面を横切る三角形は描画しない）@n
+			・ガードバンド（±1024 ピクセル）を超える三角形は描画しない
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2018, 2019 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2018, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cmath>
+#include <algorithm>
 #include "common/vtx.hpp"
 #include "graphics/color.hpp"
 #include "graphics/glmatrix.hpp"
@@ -32,15 +40,83 @@ namespace graphics {
 			LINES,
 			LINE_STRIP,
 			LINE_LOOP,
+			TRIANGLES,
+			TRIANGLE_STRIP,
+			TRIANGLE_FAN,
+		};
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	カリング（表面は、正規化座標で反時計回り）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class CULL {
+			NONE,	///< カリングしない
+			BACK,	///< 裏面を描画しない
+			FRONT,	///< 表面を描画しない
 		};
 
 		typedef gl::matrixf	MATRIX;
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	統計（最後の「renderring()」）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stat_t {
+			uint32_t	tri_;		///< 三角形の数
+			uint32_t	cull_;		///< カリングした三角形の数
+			uint32_t	pixels_;	///< 描画したピクセル数（Z テストで捨てた物を含まない）
+			stat_t() noexcept : tri_(0), cull_(0), pixels_(0) { }
+		};
+
+		static const int16_t GUARD = 1024;	///< ガードバンド（ピクセル）
+		static const int16_t TILE  = 8;		///< タイルの大きさ
+
 	private:
+		typedef typename RDR::glc_type GLC;
+		typedef typename RDR::value_type VALUE;
+
+		struct rgb_t {
+			uint8_t	r, g, b;
+		};
+
+		// 変換済み頂点
+		struct scr_t {
+			int32_t		x;		///< スクリーン座標（小数４ビット）
+			int32_t		y;		///< スクリーン座標（小数４ビット）
+			float		z;		///< 深度（0 ～ 65535）
+			uint8_t		code;	///< 視錐台の外側コード
+		};
+
+		static const uint8_t OUT_NX = 0x01;
+		static const uint8_t OUT_PX = 0x02;
+		static const uint8_t OUT_NY = 0x04;
+		static const uint8_t OUT_PY = 0x08;
+		static const uint8_t OUT_NZ = 0x10;
+		static const uint8_t OUT_PZ = 0x20;
+		static const uint8_t OUT_GUARD = 0x40;
+
+		// エッジ関数 E(px, py) = a * px + b * py + c（ピクセル中心）
+		struct edge_t {
+			int32_t		a;
+			int32_t		b;
+			int32_t		c;
+		};
+
+		// 属性の平面 v(px, py) = v0 + dx * (px - x0) + dy * (py - y0)
+		struct plane_t {
+			float		v0;
+			float		dx;
+			float		dy;
+		};
+
 		RDR&		rdr_;
 
 		uint32_t	vtx_idx_;
-		vtx::ivtx4	vtxs_[VNUM];
+		vtx::fvtx4	vtxs_[VNUM];
+		rgb_t		cols_[VNUM];
+		scr_t		scrs_[VNUM];
 
 		struct dt_t {
 			PTYPE		pt_;
@@ -56,6 +132,325 @@ namespace graphics {
 
 		MATRIX		matrix_;
 
+		CULL		cull_;
+		uint16_t*	zbuf_;
+		bool		depth_;
+
+		stat_t		stat_;
+
+		static int32_t fix_(float v, float scale) noexcept
+		{
+			static const float lim = static_cast<float>(1 << 27);
+			v *= scale;
+			if(v > lim) v = lim;
+			else if(v < -lim) v = -lim;
+			return static_cast<int32_t>(v);
+		}
+
+
+		static void edge_(const scr_t& i, const scr_t& j, edge_t& e) noexcept
+		{
+			int32_t dx = j.x - i.x;
+			int32_t dy = j.y - i.y;
+			e.a = dy * 16;
+			e.b = -dx * 16;
+			e.c = (8 - i.x) * dy - (8 - i.y) * dx;
+			// トップ・レフト規則（左、上の辺以外は、辺上のピクセルを含めない）
+			if(!(dy > 0 || (dy == 0 && dx < 0))) e.c -= 1;
+		}
+
+
+		// 平面の式（三角形の重心座標から）
+		static void plane_(const edge_t* e, float inva,
+			float a0, float a1, float a2, plane_t& p) noexcept
+		{
+			p.v0 = a0;
+			p.dx = (static_cast<float>(e[0].a) * a0 + static_cast<float>(e[1].a) * a1
+				+ static_cast<float>(e[2].a) * a2) * inva;
+			p.dy = (static_cast<float>(e[0].b) * a0 + static_cast<float>(e[1].b) * a1
+				+ static_cast<float>(e[2].b) * a2) * inva;
+		}
+
+
+		// バッチ変換（全頂点）
+		void transform_() noexcept
+		{
+			typename MATRIX::matrix_type wm;
+			matrix_.world_matrix(wm);
+			const float* m = wm();
+			const float m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3];
+			const float m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7];
+			const float m8 = m[8], m9 = m[9], m10 = m[10], m11 = m[11];
+			const float m12 = m[12], m13 = m[13], m14 = m[14], m15 = m[15];
+
+			int vx, vy, vw, vh;
+			matrix_.get_viewport(vx, vy, vw, vh);
+			if(vw <= 0 || vh <= 0) {
+				vx = 0;
+				vy = 0;
+				vw = GLC::width;
+				vh = GLC::height;
+			}
+			// 小数４ビット
+			const float hw = static_cast<float>(vw) * 8.0f;
+			const float hh = static_cast<float>(vh) * 8.0f;
+			const float ox = static_cast<float>(vx) * 16.0f + hw + 0.5f;
+			const float oy = static_cast<float>(vy) * 16.0f + hh + 0.5f;
+			const float lim = static_cast<float>(GUARD * 16);
+
+			for(uint32_t i = 0; i < vtx_idx_; ++i) {
+				const auto& v = vtxs_[i];
+				float x = m0 * v.x + m4 * v.y + m8  * v.z + m12 * v.w;
+				float y = m1 * v.x + m5 * v.y + m9  * v.z + m13 * v.w;
+				float z = m2 * v.x + m6 * v.y + m10 * v.z + m14 * v.w;
+				float w = m3 * v.x + m7 * v.y + m11 * v.z + m15 * v.w;
+				auto& s = scrs_[i];
+				uint8_t code = 0;
+				if(x < -w) code |= OUT_NX;
+				if(x >  w) code |= OUT_PX;
+				if(y < -w) code |= OUT_NY;
+				if(y >  w) code |= OUT_PY;
+				if(z < -w || w <= 0.0f) code |= OUT_NZ;
+				if(z >  w) code |= OUT_PZ;
+				if((code & OUT_NZ) == 0) {
+					float iw = 1.0f / w;
+					float sx = ox + x * iw * hw;
+					float sy = oy - y * iw * hh;
+					if(sx <= -lim || sx >= lim || sy <= -lim || sy >= lim) {
+						code |= OUT_GUARD;
+					} else {
+						s.x = static_cast<int32_t>(std::floor(sx));
+						s.y = static_cast<int32_t>(std::floor(sy));
+						s.z = (z * iw + 1.0f) * 32767.5f;
+					}
+				}
+				s.code = code;
+			}
+		}
+
+
+		template <bool GOURAUD, bool DEPTH>
+		void raster_(const scr_t& v0, const scr_t& v1, const scr_t& v2,
+			const rgb_t& c0, const rgb_t& c1, const rgb_t& c2, float area) noexcept
+		{
+			edge_t e[3];
+			edge_(v1, v2, e[0]);
+			edge_(v2, v0, e[1]);
+			edge_(v0, v1, e[2]);
+
+			const auto& clip = rdr_.get_clip();
+			int32_t xmin = std::max((std::min(std::min(v0.x, v1.x), v2.x) + 7) >> 4,
+				static_cast<int32_t>(clip.org.x));
+			int32_t xmax = std::min((std::max(std::max(v0.x, v1.x), v2.x) - 8) >> 4,
+				static_cast<int32_t>(clip.end_x() - 1));
+			int32_t ymin = std::max((std::min(std::min(v0.y, v1.y), v2.y) + 7) >> 4,
+				static_cast<int32_t>(clip.org.y));
+			int32_t ymax = std::min((std::max(std::max(v0.y, v1.y), v2.y) - 8) >> 4,
+				static_cast<int32_t>(clip.end_y() - 1));
+			if(xmin > xmax || ymin > ymax) return;
+
+			// 属性（Z: 小数８ビット、カラー: 小数１２ビット）
+			float inva = 1.0f / area;
+			float px0 = static_cast<float>(v0.x - 8) / 16.0f;
+			float py0 = static_cast<float>(v0.y - 8) / 16.0f;
+			plane_t pz, pr, pg, pb;
+			int32_t zx = 0, zy = 0, rx = 0, ry = 0, gx = 0, gy = 0, bx = 0, by = 0;
+			if(DEPTH) {
+				plane_(e, inva, v0.z, v1.z, v2.z, pz);
+				zx = fix_(pz.dx, 256.0f);
+				zy = fix_(pz.dy, 256.0f);
+			}
+			if(GOURAUD) {
+				plane_(e, inva, c0.r, c1.r, c2.r, pr);
+				plane_(e, inva, c0.g, c1.g, c2.g, pg);
+				plane_(e, inva, c0.b, c1.b, c2.b, pb);
+				rx = fix_(pr.dx, 4096.0f);
+				ry = fix_(pr.dy, 4096.0f);
+				gx = fix_(pg.dx, 4096.0f);
+				gy = fix_(pg.dy, 4096.0f);
+				bx = fix_(pb.dx, 4096.0f);
+				by = fix_(pb.dy, 4096.0f);
+			}
+			const VALUE flat = share_color::to_565(c0.r, c0.g, c0.b);
+
+			VALUE* fb = rdr_.at_fb();
+			uint32_t pixels = 0;
+
+			for(int32_t ty = ymin & ~(TILE - 1); ty <= ymax; ty += TILE) {
+				int32_t ys = std::max(ty, ymin);
+				int32_t ye = std::min(ty + TILE - 1, ymax);
+				for(int32_t tx = xmin & ~(TILE - 1); tx <= xmax; tx += TILE) {
+					int32_t xs = std::max(tx, xmin);
+					int32_t xe = std::min(tx + TILE - 1, xmax);
+
+					// タイルの角で、外側（捨てる）、内側（エッジ判定無し）を判定
+					int32_t es[3];
+					bool skip = false;
+					bool full = true;
+					for(uint32_t i = 0; i < 3; ++i) {
+						const auto& t = e[i];
+						// 項の途中は 32 ビットを超える事があるが、結果は収まる
+						int32_t v = static_cast<int32_t>(static_cast<uint32_t>(t.a) * static_cast<uint32_t>(xs)
+							+ static_cast<uint32_t>(t.b) * static_cast<uint32_t>(ys) + static_cast<uint32_t>(t.c));
+						int32_t da = t.a * (xe - xs);
+						int32_t db = t.b * (ye - ys);
+						int32_t hi = v + std::max(da, 0) + std::max(db, 0);
+						int32_t lo = v + std::min(da, 0) + std::min(db, 0);
+						if(hi < 0) { skip = true; break; }
+						if(lo < 0) full = false;
+						es[i] = v;
+					}
+					if(skip) continue;
+
+					int32_t z = 0, r = 0, g = 0, b = 0;
+					if(DEPTH) {
+						z = fix_(pz.v0 + pz.dx * (xs - px0) + pz.dy * (ys - py0), 256.0f);
+					}
+					if(GOURAUD) {
+						float dx = xs - px0;
+						float dy = ys - py0;
+						r = fix_(pr.v0 + pr.dx * dx + pr.dy * dy, 4096.0f);
+						g = fix_(pg.v0 + pg.dx * dx + pg.dy * dy, 4096.0f);
+						b = fix_(pb.v0 + pb.dx * dx + pb.dy * dy, 4096.0f);
+					}
+
+					for(int32_t y = ys; y <= ye; ++y) {
+						VALUE* out = &fb[y * GLC::line_width];
+						uint16_t* zb = nullptr;
+						if(DEPTH) zb = &zbuf_[y * GLC::width];
+						int32_t e0 = es[0];
+						int32_t e1 = es[1];
+						int32_t e2 = es[2];
+						int32_t zz = z, rr = r, gg = g, bb = b;
+						for(int32_t x = xs; x <= xe; ++x) {
+							if(full || (e0 | e1 | e2) >= 0) {
+								bool draw = true;
+								if(DEPTH) {
+									uint16_t d = static_cast<uint16_t>(std::min(std::max(zz >> 8, 0), 65535));
+									if(d < zb[x]) zb[x] = d;
+									else draw = false;
+								}
+								if(draw) {
+									if(GOURAUD) {
+										out[x] = share_color::to_565(
+											std::min(std::max(rr >> 12, 0), 255),
+											std::min(std::max(gg >> 12, 0), 255),
+											std::min(std::max(bb >> 12, 0), 255));
+									} else {
+										out[x] = flat;
+									}
+									++pixels;
+								}
+							}
+							e0 += e[0].a;
+							e1 += e[1].a;
+							e2 += e[2].a;
+							if(DEPTH) zz += zx;
+							if(GOURAUD) {
+								rr += rx;
+								gg += gx;
+								bb += bx;
+							}
+						}
+						es[0] += e[0].b;
+						es[1] += e[1].b;
+						es[2] += e[2].b;
+						if(DEPTH) z += zy;
+						if(GOURAUD) {
+							r += ry;
+							g += gy;
+							b += by;
+						}
+					}
+				}
+			}
+			stat_.pixels_ += pixels;
+		}
+
+
+		void triangle_(uint32_t i0, uint32_t i1, uint32_t i2) noexcept
+		{
+			++stat_.tri_;
+			const auto& v0 = scrs_[i0];
+			const auto& v1 = scrs_[i1];
+			const auto& v2 = scrs_[i2];
+			// 視錐台カリング（全頂点が同じ面の外側）、手前の面、ガードバンド
+			if((v0.code & v1.code & v2.code) != 0
+				|| ((v0.code | v1.code | v2.code) & (OUT_NZ | OUT_GUARD)) != 0) {
+				++stat_.cull_;
+				return;
+			}
+			// ガードバンド内でも 32 ビットを超える場合がある
+			int64_t area = static_cast<int64_t>(v2.x - v0.x) * (v1.y - v0.y)
+				- static_cast<int64_t>(v2.y - v0.y) * (v1.x - v0.x);
+			// 正規化座標の反時計回り（表）は、スクリーン座標で負
+			if(area == 0 || (cull_ == CULL::BACK && area > 0) || (cull_ == CULL::FRONT && area < 0)) {
+				++stat_.cull_;
+				return;
+			}
+			if(area < 0) {
+				std::swap(i1, i2);
+				area = -area;
+			}
+			float fa = static_cast<float>(area);
+			const auto& c0 = cols_[i0];
+			const auto& c1 = cols_[i1];
+			const auto& c2 = cols_[i2];
+			bool gouraud = c0.r != c1.r || c0.g != c1.g || c0.b != c1.b
+				|| c0.r != c2.r || c0.g != c2.g || c0.b != c2.b;
+			bool depth = depth_ && zbuf_ != nullptr;
+			const auto& s0 = scrs_[i0];
+			const auto& s1 = scrs_[i1];
+			const auto& s2 = scrs_[i2];
+			if(gouraud) {
+				if(depth) raster_<true, true>(s0, s1, s2, c0, c1, c2, fa);
+				else raster_<true, false>(s0, s1, s2, c0, c1, c2, fa);
+			} else {
+				if(depth) raster_<false, true>(s0, s1, s2, c0, c1, c2, fa);
+				else raster_<false, false>(s0, s1, s2, c0, c1, c2, fa);
+			}
+		}
+
+
+		vtx::spos spos_(const scr_t& s) const noexcept
+		{
+			return vtx::spos(s.x >> 4, s.y >> 4);
+		}
+
+
+		void line_(uint32_t i0, uint32_t i1) noexcept
+		{
+			const auto& v0 = scrs_[i0];
+			const auto& v1 = scrs_[i1];
+			if((v0.code & v1.code) != 0 || ((v0.code | v1.code) & (OUT_NZ | OUT_GUARD)) != 0) return;
+			const auto& c = cols_[i0];
+			rdr_.set_fore_color(share_color(c.r, c.g, c.b));
+			rdr_.line(spos_(v0), spos_(v1));
+		}
+
+
+		void point_(uint32_t i) noexcept
+		{
+			const auto& v = scrs_[i];
+			if(v.code != 0) return;
+			const auto& c = cols_[i];
+			rdr_.plot(spos_(v), share_color::to_565(c.r, c.g, c.b));
+		}
+
+
+		void set_vertex_(float x, float y, float z) noexcept
+		{
+			if(vtx_idx_ >= VNUM) return;
+			vtxs_[vtx_idx_].x = x;
+			vtxs_[vtx_idx_].y = y;
+			vtxs_[vtx_idx_].z = z;
+			vtxs_[vtx_idx_].w = 1.0f;
+			cols_[vtx_idx_].r = color_.rgba8.unit.r;
+			cols_[vtx_idx_].g = color_.rgba8.unit.g;
+			cols_[vtx_idx_].b = color_.rgba8.unit.b;
+			++vtx_idx_;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -63,10 +458,12 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		tgl(RDR& rdr) : rdr_(rdr),
-			vtx_idx_(0), vtxs_{},
+			vtx_idx_(0), vtxs_{}, cols_{}, scrs_{},
 			dt_idx_(0), dts_{},
 			color_(0, 0, 0),
-			matrix_()
+			matrix_(),
+			cull_(CULL::NONE), zbuf_(nullptr), depth_(false),
+			stat_()
 		{ }
 
 
@@ -93,16 +490,18 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void end()
 		{
+			if(dt_idx_ >= PNUM) return;
 			if(dts_[dt_idx_].org_ == vtx_idx_) {
 				return;
 			}
 			dts_[dt_idx_].len_ = vtx_idx_ - dts_[dt_idx_].org_;
+			++dt_idx_;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	色設定
+			@brief	色設定（以降の頂点の色）
 			@param[in]	c	カラー
 		*/
 		//-----------------------------------------------------------------//
@@ -120,12 +519,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::spos& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = static_cast<float>(v.x);
-			vtxs_[vtx_idx_].y = static_cast<float>(v.y);
-			vtxs_[vtx_idx_].z = 0.0f;
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(static_cast<float>(v.x), static_cast<float>(v.y), 0.0f);
 		}
 
 
@@ -137,12 +531,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::ipos& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = static_cast<float>(v.x);
-			vtxs_[vtx_idx_].y = static_cast<float>(v.y);
-			vtxs_[vtx_idx_].z = 0.0f;
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(static_cast<float>(v.x), static_cast<float>(v.y), 0.0f);
 		}
 
 
@@ -154,12 +543,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::fpos& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = v.x;
-			vtxs_[vtx_idx_].y = v.y;
-			vtxs_[vtx_idx_].z = 0.0f;
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(v.x, v.y, 0.0f);
 		}
 
 
@@ -171,12 +555,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::svtx& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = static_cast<float>(v.x);
-			vtxs_[vtx_idx_].y = static_cast<float>(v.y);
-			vtxs_[vtx_idx_].z = static_cast<float>(v.z);
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(static_cast<float>(v.x), static_cast<float>(v.y), static_cast<float>(v.z));
 		}
 
 
@@ -188,12 +567,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::ivtx& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = static_cast<float>(v.x);
-			vtxs_[vtx_idx_].y = static_cast<float>(v.y);
-			vtxs_[vtx_idx_].z = static_cast<float>(v.z);
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(static_cast<float>(v.x), static_cast<float>(v.y), static_cast<float>(v.z));
 		}
 
 
@@ -205,12 +579,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void vertex(const vtx::fvtx& v)
 		{
-			if(vtx_idx_ >= VNUM) return;
-			vtxs_[vtx_idx_].x = v.x;
-			vtxs_[vtx_idx_].y = v.y;
-			vtxs_[vtx_idx_].z = v.z;
-			vtxs_[vtx_idx_].w = 1.0f;
-			++vtx_idx_;
+			set_vertex_(v.x, v.y, v.z);
 		}
 
 
@@ -220,7 +589,59 @@ namespace graphics {
 			@return マトリックス
 		*/
 		//-----------------------------------------------------------------//
-		MATRIX& at_matrix() noexcept { return matrix_; }		
+		MATRIX& at_matrix() noexcept { return matrix_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カリングの設定
+			@param[in]	cull	カリング
+		*/
+		//-----------------------------------------------------------------//
+		void set_cull(CULL cull) noexcept { cull_ = cull; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	Z バッファの設定 @n
+					※GLC::width x GLC::height の uint16_t 配列
+			@param[in]	zbuf	Z バッファ（nullptr なら Z テストをしない）
+		*/
+		//-----------------------------------------------------------------//
+		void set_zbuffer(uint16_t* zbuf) noexcept { zbuf_ = zbuf; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	Z テストの許可（Z が小さい場合に描画）
+			@param[in]	ena		不許可なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		void enable_depth(bool ena = true) noexcept { depth_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	Z バッファのクリア（クリップ領域）
+		*/
+		//-----------------------------------------------------------------//
+		void clear_depth() noexcept
+		{
+			if(zbuf_ == nullptr) return;
+			const auto& clip = rdr_.get_clip();
+			for(int16_t y = clip.org.y; y < clip.end_y(); ++y) {
+				std::fill_n(&zbuf_[y * GLC::width + clip.org.x], clip.size.x, 0xffff);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計の取得（最後の「renderring()」）
+			@return 統計
+		*/
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const noexcept { return stat_; }
 
 
 		//-----------------------------------------------------------------//
@@ -230,18 +651,51 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void renderring() noexcept
 		{
+			stat_ = stat_t();
+			transform_();
+
 			for(uint32_t i = 0; i < dt_idx_; ++i) {
 				const auto& t = dts_[i];
 				auto org = t.org_;
 				auto len = t.len_;
 				switch(t.pt_) {
 				case PTYPE::POINTS:
+					for(uint32_t j = 0; j < len; ++j) {
+						point_(org + j);
+					}
 					break;
 				case PTYPE::LINES:
+					for(uint32_t j = 1; j < len; j += 2) {
+						line_(org + j - 1, org + j);
+					}
 					break;
 				case PTYPE::LINE_STRIP:
+					for(uint32_t j = 1; j < len; ++j) {
+						line_(org + j - 1, org + j);
+					}
 					break;
 				case PTYPE::LINE_LOOP:
+					for(uint32_t j = 1; j < len; ++j) {
+						line_(org + j - 1, org + j);
+					}
+					if(len > 2) line_(org + len - 1, org);
+					break;
+				case PTYPE::TRIANGLES:
+					for(uint32_t j = 2; j < len; j += 3) {
+						triangle_(org + j - 2, org + j - 1, org + j);
+					}
+					break;
+				case PTYPE::TRIANGLE_STRIP:
+					// 奇数番目は、向きを揃える為に入れ替える
+					for(uint32_t j = 2; j < len; ++j) {
+						if(j & 1) triangle_(org + j - 1, org + j - 2, org + j);
+						else triangle_(org + j - 2, org + j - 1, org + j);
+					}
+					break;
+				case PTYPE::TRIANGLE_FAN:
+					for(uint32_t j = 2; j < len; ++j) {
+						triangle_(org, org + j - 1, org + j);
+					}
 					break;
 				default:
 					break;
@@ -0,0 +1,416 @@
+//=====================================================================//
+/*!	@file
+	@brief	Tiny GL ベンチマーク（ホスト用） @n
+			480 x 272 の画面に、回転する立方体（グーロー、Z バッファ）、@n
+			ゲージのリング（720 三角形）、小さい三角形（2000 個）を描画して、@n
+			三角形／秒とフィル・レートを計測する。@n
+			また、ランダムな三角形と、隙間無く並べた三角形（扇）を、@n
+			ピクセル毎に総当たりで判定する基準と比較し、一致するか検査する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "common/format.hpp"
+#include "graphics/font8x16.hpp"
+#include "graphics/kfont.hpp"
+#include "graphics/font.hpp"
+#include "graphics/graphics.hpp"
+#include "graphics/tgl.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t FRAMES = 200;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	グラフィックス・コントローラー（ホスト）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct glc_host {
+		static const int16_t width  = 480;
+		static const int16_t height = 272;
+		static const int16_t line_width = 480;
+
+		uint16_t	fb_[line_width * height];
+
+		void* get_fbp() noexcept { return fb_; }
+	};
+
+	typedef graphics::font8x16 AFONT;
+	typedef graphics::kfont<16, 16> KFONT;
+	typedef graphics::font<AFONT, KFONT> FONT;
+	typedef graphics::render<glc_host, FONT> RENDER;
+	typedef graphics::tgl<RENDER, 8192, 64> TGL;
+
+	glc_host	glc_;
+	AFONT		afont_;
+	KFONT		kfont_;
+	FONT		font_(afont_, kfont_);
+	RENDER		render_(glc_, font_);
+	TGL			tgl_(render_);
+	uint16_t	zbuf_[glc_host::width * glc_host::height];
+
+	uint32_t	rand_ = 12345;
+
+	uint32_t rand_next_() noexcept
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+	float frand_(float min, float max) noexcept
+	{
+		return min + (max - min) * static_cast<float>(rand_next_() & 0xffff) / 65535.0f;
+	}
+
+
+	void clear_screen_() noexcept
+	{
+		render_.set_back_color(graphics::def_color::Black);
+		render_.clear(graphics::def_color::Black);
+	}
+
+
+	void reset_matrix_() noexcept
+	{
+		auto& m = tgl_.at_matrix();
+		m.set_mode(TGL::MATRIX::mode::projection);
+		m.identity();
+		m.set_mode(TGL::MATRIX::mode::modelview);
+		m.identity();
+		m.set_viewport(0, 0, glc_host::width, glc_host::height);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	基準（ピクセル毎に、全てのエッジを 64 ビットで判定）@n
+				正規化座標をそのまま置く（単位行列）場合と同じ変換で @n
+				スクリーン座標（小数４ビット）を求める
+	*/
+	//-----------------------------------------------------------------//
+	struct ref_vtx {
+		int64_t	x;
+		int64_t	y;
+	};
+
+	ref_vtx ref_conv_(float x, float y) noexcept
+	{
+		const float hw = static_cast<float>(glc_host::width) * 8.0f;
+		const float hh = static_cast<float>(glc_host::height) * 8.0f;
+		ref_vtx v;
+		v.x = static_cast<int64_t>(std::floor(hw + 0.5f + x * hw));
+		v.y = static_cast<int64_t>(std::floor(hh + 0.5f - y * hh));
+		return v;
+	}
+
+	bool ref_inside_(const ref_vtx& i, const ref_vtx& j, int64_t px, int64_t py) noexcept
+	{
+		int64_t dx = j.x - i.x;
+		int64_t dy = j.y - i.y;
+		int64_t e = (px * 16 + 8 - i.x) * dy - (py * 16 + 8 - i.y) * dx;
+		if(e > 0) return true;
+		if(e < 0) return false;
+		return dy > 0 || (dy == 0 && dx < 0);  // トップ・レフト規則
+	}
+
+	// 描画したピクセルを cov に加算、色を fb に書く
+	void ref_triangle_(ref_vtx v0, ref_vtx v1, ref_vtx v2, uint16_t c,
+		uint16_t* fb, uint8_t* cov) noexcept
+	{
+		int64_t area = (v2.x - v0.x) * (v1.y - v0.y) - (v2.y - v0.y) * (v1.x - v0.x);
+		if(area == 0) return;
+		if(area < 0) std::swap(v1, v2);
+		for(int64_t y = 0; y < glc_host::height; ++y) {
+			for(int64_t x = 0; x < glc_host::width; ++x) {
+				if(ref_inside_(v1, v2, x, y) && ref_inside_(v2, v0, x, y)
+					&& ref_inside_(v0, v1, x, y)) {
+					fb[y * glc_host::line_width + x] = c;
+					if(cov != nullptr) ++cov[y * glc_host::width + x];
+				}
+			}
+		}
+	}
+
+
+	struct tri_t {
+		float		x[3];
+		float		y[3];
+		uint16_t	c;
+		uint8_t		r, g, b;
+	};
+
+
+	void draw_tris_(const std::vector<tri_t>& tris, TGL::PTYPE pt = TGL::PTYPE::TRIANGLES)
+	{
+		tgl_.begin(pt);
+		for(const auto& t : tris) {
+			tgl_.color(graphics::share_color(t.r, t.g, t.b));
+			for(uint32_t i = 0; i < 3; ++i) {
+				tgl_.vertex(vtx::fvtx(t.x[i], t.y[i], 0.0f));
+			}
+		}
+		tgl_.end();
+		tgl_.renderring();
+	}
+
+
+	// ランダムな三角形（画面の外、細い物、小さい物を含む）
+	bool check_random_()
+	{
+		static std::vector<uint16_t> ref(glc_host::line_width * glc_host::height);
+		uint32_t bad = 0;
+		uint32_t total = 0;
+		for(uint32_t loop = 0; loop < 40; ++loop) {
+			std::vector<tri_t> tris;
+			for(uint32_t i = 0; i < 50; ++i) {
+				tri_t t;
+				float s = (i & 1) ? 1.2f : 0.05f;
+				float cx = frand_(-1.1f, 1.1f);
+				float cy = frand_(-1.1f, 1.1f);
+				for(uint32_t j = 0; j < 3; ++j) {
+					t.x[j] = cx + frand_(-s, s);
+					t.y[j] = cy + frand_(-s, s);
+				}
+				t.r = rand_next_();
+				t.g = rand_next_();
+				t.b = rand_next_();
+				t.c = graphics::share_color::to_565(t.r, t.g, t.b);
+				tris.push_back(t);
+			}
+			clear_screen_();
+			reset_matrix_();
+			tgl_.set_cull(TGL::CULL::NONE);
+			tgl_.enable_depth(false);
+			draw_tris_(tris);
+			std::fill(ref.begin(), ref.end(), 0);
+			for(const auto& t : tris) {
+				ref_triangle_(ref_conv_(t.x[0], t.y[0]), ref_conv_(t.x[1], t.y[1]),
+					ref_conv_(t.x[2], t.y[2]), t.c, &ref[0], nullptr);
+			}
+			for(uint32_t i = 0; i < ref.size(); ++i) {
+				if(ref[i] != glc_.fb_[i]) ++bad;
+			}
+			total += ref.size();
+		}
+		printf("Random triangles : %u / %u pixels differ from reference\n", bad, total);
+		return bad == 0;
+	}
+
+
+	// 中心を共有する扇（隙間、重なりがあってはならない）
+	bool check_fan_()
+	{
+		static std::vector<uint16_t> ref(glc_host::line_width * glc_host::height);
+		static std::vector<uint8_t> cov(glc_host::width * glc_host::height);
+		std::fill(ref.begin(), ref.end(), 0);
+		std::fill(cov.begin(), cov.end(), 0);
+
+		static const uint32_t SEG = 97;
+		const float cx = 0.013f;
+		const float cy = -0.021f;
+		std::vector<tri_t> tris;
+		for(uint32_t i = 0; i < SEG; ++i) {
+			float a0 = static_cast<float>(i) * 6.2831853f / SEG;
+			float a1 = static_cast<float>(i + 1) * 6.2831853f / SEG;
+			if(i == (SEG - 1)) a1 = 0.0f;
+			tri_t t;
+			t.x[0] = cx;
+			t.y[0] = cy;
+			t.x[1] = cx + std::cos(a0) * 0.9f;
+			t.y[1] = cy + std::sin(a0) * 0.9f;
+			t.x[2] = cx + std::cos(a1) * 0.9f;
+			t.y[2] = cy + std::sin(a1) * 0.9f;
+			t.r = 64 + (i & 1) * 128;
+			t.g = i;
+			t.b = 255 - i;
+			t.c = graphics::share_color::to_565(t.r, t.g, t.b);
+			tris.push_back(t);
+			ref_triangle_(ref_conv_(t.x[0], t.y[0]), ref_conv_(t.x[1], t.y[1]),
+				ref_conv_(t.x[2], t.y[2]), t.c, &ref[0], &cov[0]);
+		}
+		clear_screen_();
+		reset_matrix_();
+		draw_tris_(tris);
+
+		uint32_t over = 0;
+		for(auto c : cov) if(c > 1) ++over;
+		uint32_t bad = 0;
+		for(uint32_t i = 0; i < ref.size(); ++i) {
+			if(ref[i] != glc_.fb_[i]) ++bad;
+		}
+		printf("Triangle fan     : %u pixels differ, %u pixels overlapped\n", bad, over);
+		return bad == 0 && over == 0;
+	}
+
+
+	struct result_t {
+		double		usec_;
+		uint64_t	tri_;
+		uint64_t	cull_;
+		uint64_t	pixels_;
+	};
+
+
+	void print_(const char* name, const result_t& r)
+	{
+		printf("%-16s %8.1f us/frame, %6.0f tri/frame (cull %5.0f), %8.0f pixels/frame,"
+			" %6.2f Mtri/s, %7.1f Mpixel/s\n",
+			name, r.usec_ / FRAMES, static_cast<double>(r.tri_) / FRAMES,
+			static_cast<double>(r.cull_) / FRAMES, static_cast<double>(r.pixels_) / FRAMES,
+			static_cast<double>(r.tri_) / r.usec_, static_cast<double>(r.pixels_) / r.usec_);
+	}
+
+
+	template <class FUNC>
+	result_t run_(FUNC func)
+	{
+		result_t res = { 0 };
+		for(uint32_t f = 0; f < FRAMES; ++f) {
+			clear_screen_();
+			reset_matrix_();
+			auto t = bench_usec();
+			func(f);
+			res.usec_ += bench_usec() - t;
+			const auto& st = tgl_.get_stat();
+			res.tri_ += st.tri_;
+			res.cull_ += st.cull_;
+			res.pixels_ += st.pixels_;
+		}
+		return res;
+	}
+
+
+	// 立方体（各面を２三角形、頂点カラー）を、3 x 2 個回転させる
+	void cube_(uint32_t frame)
+	{
+		static const float p[8][3] = {
+			{ -1, -1, -1 }, {  1, -1, -1 }, {  1,  1, -1 }, { -1,  1, -1 },
+			{ -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 },
+		};
+		// 外側から見て反時計回り
+		static const uint8_t face[6][4] = {
+			{ 4, 5, 6, 7 }, { 1, 0, 3, 2 }, { 5, 1, 2, 6 },
+			{ 0, 4, 7, 3 }, { 7, 6, 2, 3 }, { 0, 1, 5, 4 },
+		};
+		static const uint8_t col[8][3] = {
+			{ 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 255, 255, 0 },
+			{ 0, 255, 255 }, { 255, 0, 255 }, { 255, 255, 255 }, { 64, 64, 64 },
+		};
+
+		tgl_.set_zbuffer(zbuf_);
+		tgl_.enable_depth();
+		tgl_.clear_depth();
+		tgl_.set_cull(TGL::CULL::BACK);
+
+		auto& m = tgl_.at_matrix();
+		m.set_mode(TGL::MATRIX::mode::projection);
+		m.perspective(60.0f, static_cast<float>(glc_host::width) / glc_host::height, 1.0f, 50.0f);
+		m.set_mode(TGL::MATRIX::mode::modelview);
+		m.translate(0.0f, 0.0f, -9.0f);
+		m.rotate(static_cast<float>(frame) * 1.7f, 1.0f, 1.0f, 0.3f);
+
+		for(int32_t n = 0; n < 6; ++n) {
+			float ox = static_cast<float>(n % 3 - 1) * 3.2f;
+			float oy = static_cast<float>(n / 3) * 3.2f - 1.6f;
+			tgl_.begin(TGL::PTYPE::TRIANGLES);
+			for(const auto& f : face) {
+				static const uint8_t idx[6] = { 0, 1, 2, 0, 2, 3 };
+				for(auto i : idx) {
+					auto v = f[i];
+					tgl_.color(graphics::share_color(col[v][0], col[v][1], col[v][2]));
+					tgl_.vertex(vtx::fvtx(p[v][0] + ox, p[v][1] + oy, p[v][2]));
+				}
+			}
+			tgl_.end();
+		}
+		tgl_.renderring();
+		tgl_.enable_depth(false);
+		tgl_.set_cull(TGL::CULL::NONE);
+	}
+
+
+	// ゲージのリング（360 区間の帯、値に応じた色のグラデーション）
+	void gauge_(uint32_t frame)
+	{
+		static const uint32_t SEG = 360;
+		float val = static_cast<float>(frame % 100) / 100.0f;
+		tgl_.begin(TGL::PTYPE::TRIANGLE_STRIP);
+		for(uint32_t i = 0; i <= SEG; ++i) {
+			float a = static_cast<float>(i) * 6.2831853f / SEG;
+			float si = std::sin(a);
+			float co = std::cos(a);
+			float t = static_cast<float>(i) / SEG;
+			if(t <= val) {
+				tgl_.color(graphics::share_color(t * 255, (1.0f - t) * 255, 64));
+			} else {
+				tgl_.color(graphics::share_color(32, 32, 32));
+			}
+			tgl_.vertex(vtx::fvtx(co * 0.9f * 272 / 480, si * 0.9f, 0.0f));
+			tgl_.vertex(vtx::fvtx(co * 0.6f * 272 / 480, si * 0.6f, 0.0f));
+		}
+		tgl_.end();
+		tgl_.renderring();
+	}
+
+
+	// 小さい三角形（一辺 8 ピクセル程度）
+	std::vector<tri_t> small_;
+
+	void small_tris_(uint32_t frame)
+	{
+		const float sx = 8.0f / glc_host::width;
+		const float sy = 8.0f / glc_host::height;
+		tgl_.begin(TGL::PTYPE::TRIANGLES);
+		for(const auto& t : small_) {
+			tgl_.color(graphics::share_color(t.r, t.g, t.b));
+			float ox = static_cast<float>(frame & 7) * 0.01f;
+			for(uint32_t i = 0; i < 3; ++i) {
+				tgl_.vertex(vtx::fvtx(t.x[0] + ox + t.x[i] * sx, t.y[0] + t.y[i] * sy, 0.0f));
+			}
+		}
+		tgl_.end();
+		tgl_.renderring();
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool ok = true;
+	ok &= check_random_();
+	ok &= check_fan_();
+
+	for(uint32_t i = 0; i < 2000; ++i) {
+		tri_t t;
+		t.x[0] = frand_(-0.95f, 0.95f);
+		t.y[0] = frand_(-0.95f, 0.95f);
+		t.x[1] = 1.0f;
+		t.y[1] = 0.2f;
+		t.x[2] = 0.4f;
+		t.y[2] = 1.0f;
+		t.r = rand_next_();
+		t.g = rand_next_();
+		t.b = rand_next_();
+		small_.push_back(t);
+	}
+
+	auto r = run_(cube_);
+	print_("Cube x 6 (Z)", r);
+	r = run_(gauge_);
+	print_("Gauge ring", r);
+	r = run_(small_tris_);
+	print_("Small x 2000", r);
+
+	printf("%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
@@ -90,7 +90,16 @@ namespace gui {
 
 		touch_state	touch_state_;
 
-		bool		update_;
+		widget*		dirty_next_;	///< 再描画リストのリンク
+		vtx::srect	damage_;		///< 再描画領域（widget 内の座標）
+		bool		dirty_;			///< 再描画リストに登録済み
+
+		// 再描画リスト（widget_director が回収する）
+		static widget*& dirty_top_() noexcept
+		{
+			static widget* top = nullptr;
+			return top;
+		}
 
 	public:
 		//-----------------------------------------------------------------//
@@ -107,7 +116,7 @@ namespace gui {
 			location_(loc), title_(title), mobj_(nullptr),
 			base_color_(graphics::def_color::White), font_color_(graphics::def_color::White),
 			state_(STATE::DISABLE), focus_(false), touch_(false),
-			touch_state_(fexp), update_(false)
+			touch_state_(fexp), dirty_next_(nullptr), damage_(0), dirty_(false)
 		{ } 
 
 
@@ -218,7 +227,7 @@ namespace gui {
 			@return ロケーション
 		*/
 		//-----------------------------------------------------------------//
-		vtx::srect& at_location() noexcept { return location_; }
+		vtx::srect& at_location() noexcept { invalidate(); return location_; }
 
 
 		//-----------------------------------------------------------------//
@@ -227,7 +236,11 @@ namespace gui {
 			@param[in]	title	タイトル
 		*/
 		//-----------------------------------------------------------------//
-		void set_title(const char* title) noexcept { title_ = title; }
+		void set_title(const char* title) noexcept
+		{
+			if(title_ != title) invalidate();
+			title_ = title;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -245,7 +258,11 @@ namespace gui {
 			@param[in]	mobj	モーションオブジェクト
 		*/
 		//-----------------------------------------------------------------//
-		void set_mobj(const void* mobj) noexcept { mobj_ = mobj; }
+		void set_mobj(const void* mobj) noexcept
+		{
+			if(mobj_ != mobj) invalidate();
+			mobj_ = mobj;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -263,7 +280,11 @@ namespace gui {
 			@param[in]	color	カラー
 		*/
 		//-----------------------------------------------------------------//
-		void set_base_color(const graphics::share_color& color) noexcept { base_color_ = color; }
+		void set_base_color(const graphics::share_color& color) noexcept
+		{
+			if(base_color_ != color) invalidate();
+			base_color_ = color;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -281,7 +302,11 @@ namespace gui {
 			@param[in]	color	カラー
 		*/
 		//-----------------------------------------------------------------//
-		void set_font_color(const graphics::share_color& color) noexcept { font_color_ = color; }
+		void set_font_color(const graphics::share_color& color) noexcept
+		{
+			if(font_color_ != color) invalidate();
+			font_color_ = color;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -293,13 +318,97 @@ namespace gui {
 		const auto& get_font_color() const noexcept { return font_color_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再描画領域を登録（widget 内の座標） @n
+					登録済みの場合は、領域を合成する。
+			@param[in]	rect	再描画領域
+		*/
+		//-----------------------------------------------------------------//
+		void invalidate(const vtx::srect& rect) noexcept
+		{
+			if(rect.size.x <= 0 || rect.size.y <= 0) return;
+
+			if(!dirty_) {
+				damage_ = rect;
+				dirty_ = true;
+				dirty_next_ = dirty_top_();
+				dirty_top_() = this;
+			} else if(damage_.size.x <= 0 || damage_.size.y <= 0) {
+				damage_ = rect;
+			} else {
+				auto org = damage_.org;
+				auto end = damage_.end();
+				if(rect.org.x < org.x) org.x = rect.org.x;
+				if(rect.org.y < org.y) org.y = rect.org.y;
+				if(rect.end_x() > end.x) end.x = rect.end_x();
+				if(rect.end_y() > end.y) end.y = rect.end_y();
+				damage_.set(org, end - org);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全体を再描画領域に登録
+		*/
+		//-----------------------------------------------------------------//
+		void invalidate() noexcept { invalidate(vtx::srect(vtx::spos(0), location_.size)); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再描画リストから取り出す（widget_director 用）
+			@param[out]	damage	再描画領域（widget 内の座標）
+			@return 再描画する widget（無ければ「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		static widget* fetch_dirty(vtx::srect& damage) noexcept
+		{
+			auto w = dirty_top_();
+			if(w == nullptr) return nullptr;
+
+			dirty_top_() = w->dirty_next_;
+			w->dirty_next_ = nullptr;
+			w->dirty_ = false;
+			damage = w->damage_;
+			return w;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再描画リストから外す
+		*/
+		//-----------------------------------------------------------------//
+		void cancel_dirty() noexcept
+		{
+			if(!dirty_) return;
+
+			widget** pp = &dirty_top_();
+			while(*pp != nullptr) {
+				if(*pp == this) {
+					*pp = dirty_next_;
+					break;
+				}
+				pp = &(*pp)->dirty_next_;
+			}
+			dirty_next_ = nullptr;
+			dirty_ = false;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	「更新」の設定
 			@param[in]	update	更新をしない場合「false」
 		*/
 		//-----------------------------------------------------------------//
-		void set_update(bool update = true) noexcept { update_ = update; }
+		void set_update(bool update = true) noexcept
+		{
+			if(update) invalidate();
+			else cancel_dirty();
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -308,7 +417,7 @@ namespace gui {
 			@return	「更新」
 		*/
 		//-----------------------------------------------------------------//
-		auto get_update() const noexcept { return update_; }
+		auto get_update() const noexcept { return dirty_; }
 
 
 		//-----------------------------------------------------------------//
@@ -317,7 +426,11 @@ namespace gui {
 			@param[in]	state	ステート
 		*/
 		//-----------------------------------------------------------------//
-		void set_state(STATE state) noexcept { state_ = state; }
+		void set_state(STATE state) noexcept
+		{
+			if(state_ != state) invalidate();
+			state_ = state;
+		}
 
 
 		//-----------------------------------------------------------------//
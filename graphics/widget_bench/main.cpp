@@ -0,0 +1,472 @@
+//=====================================================================//
+/*!	@file
+	@brief	Widget ディレクター・ベンチマーク（ホスト用） @n
+			480 x 272 の画面に 111 個の widget を置き、同じタッチ操作を、@n
+			旧方式（全 widget を走査して、変化した widget を全体描画）と、@n
+			再描画領域方式（グリッドでタッチ判定、重なる widget をクリップ描画）、@n
+			さらに裏バッファを使う場合で比較する。@n
+			フレーム毎に画面のハッシュを取り、毎フレーム全 widget を描画した @n
+			画面（基準）と同じか検査する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "common/format.hpp"
+#include "graphics/font8x16.hpp"
+#include "graphics/kfont.hpp"
+#include "graphics/font.hpp"
+#include "graphics/graphics.hpp"
+#include "graphics/widget_director.hpp"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t FRAMES = 2000;
+
+	bool	meter_ = false;		// メーター更新と移動を行う
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	グラフィックス・コントローラー（ホスト）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct glc_host {
+		static const int16_t width  = 480;
+		static const int16_t height = 272;
+		static const int16_t line_width = 480;
+
+		uint16_t	fb_[line_width * height];
+
+		void* get_fbp() noexcept { return fb_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	タッチ（スクリプト）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct touch_host {
+		struct touch_t {
+			vtx::spos	pos;
+		};
+		uint32_t	num_;
+		touch_t		t_;
+
+		touch_host() noexcept : num_(0), t_() { }
+		uint32_t get_touch_num() const noexcept { return num_; }
+		const touch_t& get_touch_pos(uint32_t idx) const noexcept { return t_; }
+	};
+
+	typedef graphics::font8x16 AFONT;
+	typedef graphics::kfont<16, 16> KFONT;
+	typedef graphics::font<AFONT, KFONT> FONT;
+	typedef graphics::render<glc_host, FONT> RENDER;
+
+	static const uint32_t WNUM = 128;
+
+	glc_host	glc_;
+	AFONT		afont_;
+	KFONT		kfont_;
+	FONT		font_(afont_, kfont_);
+	RENDER		render_(glc_, font_);
+	touch_host	touch_;
+
+	uint16_t	back_[glc_host::line_width * glc_host::height];
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	旧 widget_director の更新（比較用） @n
+				全 widget を走査し、変化した widget を、クリップ無しで全体描画
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class RDR, class TOUCH, uint32_t NUM>
+	struct legacy_director {
+
+		struct widget_t {
+			gui::widget*		w_;
+			gui::widget::STATE	state_;
+			bool				init_;
+			bool				focus_;
+			bool				draw_;
+		};
+
+		RDR&		rdr_;
+		TOUCH&		touch_;
+		widget_t	widgets_[NUM];
+		bool		all_;		// 毎フレーム全 widget を描画（基準）
+		uint32_t	num_;
+		uint32_t	draw_num_;
+		uint32_t	pixels_;
+
+		legacy_director(RDR& rdr, TOUCH& touch, bool all) noexcept : rdr_(rdr), touch_(touch),
+			widgets_(), all_(all), num_(0), draw_num_(0), pixels_(0) { }
+
+		bool insert(gui::widget* w) noexcept
+		{
+			for(auto& t : widgets_) {
+				if(t.w_ == nullptr) {
+					t.w_ = w;
+					t.state_ = w->get_state();
+					t.init_ = false;
+					t.focus_ = false;
+					t.draw_ = false;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void remove(gui::widget* w) noexcept
+		{
+			w->cancel_dirty();
+			for(auto& t : widgets_) {
+				if(t.w_ == w) t.w_ = nullptr;
+			}
+		}
+
+		template <class W>
+		void draw_(gui::widget* w) noexcept
+		{
+			auto* p = dynamic_cast<W*>(w);
+			if(p != nullptr) p->draw(rdr_);
+		}
+
+		void update() noexcept
+		{
+			num_ = 0;
+			draw_num_ = 0;
+			pixels_ = 0;
+
+			// 変更要求（旧方式の title、mobj、color の比較と「set_update()」に相当）
+			vtx::srect dmg;
+			gui::widget* dw;
+			while((dw = gui::widget::fetch_dirty(dmg)) != nullptr) {
+				for(auto& t : widgets_) {
+					if(t.w_ == dw) t.draw_ = true;
+				}
+			}
+
+			auto num = touch_.get_touch_num();
+			const auto& tp = touch_.get_touch_pos(0);
+			for(auto& t : widgets_) {
+				if(t.w_ == nullptr) continue;
+				++num_;
+				if(!t.init_) {
+					t.w_->init();
+					t.init_ = true;
+					t.draw_ = true;
+				}
+				if(t.state_ != t.w_->get_state()) {
+					t.state_ = t.w_->get_state();
+					t.draw_ = true;
+				}
+				if(t.w_->get_state() == gui::widget::STATE::ENABLE) {
+					t.w_->update_touch(tp.pos, num);
+				}
+				if(t.focus_ != t.w_->get_focus()) {
+					t.focus_ = t.w_->get_focus();
+					t.draw_ = true;
+				}
+			}
+
+			for(auto& t : widgets_) {
+				if(t.w_ == nullptr) continue;
+				if(t.w_->get_state() != gui::widget::STATE::ENABLE) continue;
+				const auto& ts = t.w_->get_touch_state();
+				if(ts.negative_) {
+					bool ena = true;
+					if(t.w_->get_id() == gui::widget::ID::CHECK) {
+						auto* w = dynamic_cast<gui::check*>(t.w_);
+						if(w != nullptr) ena = !w->get_enable();
+					}
+					t.w_->exec_select(ena);
+					t.draw_ = true;
+				}
+				if(ts.positive_) t.draw_ = true;
+				if(ts.level_ && t.w_->get_id() == gui::widget::ID::SLIDER) t.draw_ = true;
+			}
+
+			// exec_select 等で登録された要求は、旧方式では次のフレームで無視される
+			while(gui::widget::fetch_dirty(dmg) != nullptr) { }
+
+			for(auto& t : widgets_) {
+				if(t.w_ == nullptr) continue;
+				if(t.w_->get_state() == gui::widget::STATE::DISABLE) continue;
+				if(!t.draw_ && !all_) continue;
+				t.draw_ = false;
+				switch(t.w_->get_id()) {
+				case gui::widget::ID::FRAME:  draw_<gui::frame>(t.w_); break;
+				case gui::widget::ID::BUTTON: draw_<gui::button>(t.w_); break;
+				case gui::widget::ID::CHECK:  draw_<gui::check>(t.w_); break;
+				case gui::widget::ID::SLIDER: draw_<gui::slider>(t.w_); break;
+				default: break;
+				}
+				++draw_num_;
+				const auto& sz = t.w_->get_location().size;
+				pixels_ += static_cast<uint32_t>(sz.x) * static_cast<uint32_t>(sz.y);
+			}
+		}
+	};
+
+	typedef legacy_director<RENDER, touch_host, WNUM> LEGACY;
+	typedef gui::widget_director<RENDER, touch_host, WNUM> WIDD;
+	typedef gui::widget_director<RENDER, touch_host, WNUM, true> WIDD_BACK;
+
+	LEGACY*		legacy_ = nullptr;
+	WIDD*		widd_ = nullptr;
+	WIDD_BACK*	widd_back_ = nullptr;
+
+
+	uint32_t hash_fb_()
+	{
+		uint32_t h = 2166136261u;
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(glc_.fb_);
+		for(uint32_t i = 0; i < sizeof(glc_.fb_); ++i) {
+			h ^= p[i];
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	画面（frame + 10 x 11 のボタン、チェック、スライダー）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct scene {
+		static const int16_t COLS = 10;
+		static const int16_t ROWS = 11;
+		static const int16_t CELL_W = 48;
+		static const int16_t CELL_H = 24;
+
+		gui::frame		frame_;
+		gui::widget*	items_[COLS * ROWS];
+		gui::button*	buttons_[COLS * ROWS];
+		gui::check*		checks_[COLS * ROWS];
+		gui::slider*	sliders_[COLS * ROWS];
+		uint32_t		button_num_;
+		uint32_t		check_num_;
+		uint32_t		slider_num_;
+
+		scene() noexcept : frame_(vtx::srect(0, 0, glc_host::width, glc_host::height), "Frame"),
+			items_(), buttons_(), checks_(), sliders_(), button_num_(0), check_num_(0), slider_num_(0)
+		{
+			for(int16_t r = 0; r < ROWS; ++r) {
+				for(int16_t c = 0; c < COLS; ++c) {
+					vtx::srect loc(c * CELL_W + 2, r * CELL_H + 4, CELL_W - 4, CELL_H - 4);
+					gui::widget* w = nullptr;
+					switch(r % 3) {
+					case 0:
+						{
+							auto* b = new gui::button(loc, "B");
+							buttons_[button_num_++] = b;
+							w = b;
+						}
+						break;
+					case 1:
+						{
+							auto* c = new gui::check(loc, "C");
+							checks_[check_num_++] = c;
+							w = c;
+						}
+						break;
+					default:
+						{
+							auto* s = new gui::slider(loc, 0.5f);
+							sliders_[slider_num_++] = s;
+							w = s;
+						}
+						break;
+					}
+					items_[r * COLS + c] = w;
+				}
+			}
+			frame_.enable();
+			for(auto* w : items_) w->enable();
+		}
+
+		~scene()
+		{
+			for(uint32_t i = 0; i < button_num_; ++i) delete buttons_[i];
+			for(uint32_t i = 0; i < check_num_; ++i) delete checks_[i];
+			for(uint32_t i = 0; i < slider_num_; ++i) delete sliders_[i];
+		}
+
+		// 操作スクリプト（８フレーム周期で、押して、ドラッグして、離す） @n
+		// アプリケーションからのタイトル変更、meter_ が有効なら、メーター更新と移動も行う
+		void step(uint32_t frame) noexcept
+		{
+			uint32_t cyc = frame / 8;
+			uint32_t ph  = frame % 8;
+			auto idx = (cyc * 37) % (COLS * ROWS);
+			const auto& loc = items_[idx]->get_location();
+			if(ph < 5) {
+				touch_.num_ = 1;
+				touch_.t_.pos = loc.org + loc.size / 2;
+				touch_.t_.pos.x += (static_cast<int16_t>(ph) - 2) * 4;
+			} else {
+				touch_.num_ = 0;
+			}
+			// アプリケーションからのタイトル変更
+			if((frame % 16) == 0) {
+				auto* b = buttons_[(frame / 16) % button_num_];
+				b->set_title((frame & 16) ? "A" : "B");
+			}
+			if(!meter_) return;
+
+			// メーター（アプリケーションからの slider 更新）
+			for(uint32_t i = 0; i < 8; ++i) {
+				auto* s = sliders_[(frame + i * 7) % slider_num_];
+				s->set_ratio(static_cast<float>((frame * 13 + i * 29) % 100) / 100.0f);
+			}
+			// ボタンの移動（元の位置は消す必要がある）
+			if((frame % 32) == 0) {
+				auto& org = buttons_[(frame / 64) % button_num_]->at_location().org;
+				if(frame & 32) org.x -= 2; else org.x += 2;
+			}
+		}
+	};
+
+
+	struct result_t {
+		double		usec_;
+		uint64_t	visit_;
+		uint64_t	draw_;
+		uint64_t	pixels_;
+		uint32_t	match_;
+	};
+
+
+	void init_screen_()
+	{
+		render_.set_back_color(graphics::def_color::Black);
+		render_.clear(graphics::def_color::Black);
+		touch_ = touch_host();
+	}
+
+
+	result_t run_legacy_(bool all, std::vector<uint32_t>& hash)
+	{
+		result_t res = { 0 };
+		init_screen_();
+		LEGACY dir(render_, touch_, all);
+		legacy_ = &dir;
+		{
+			scene sc;
+			dir.update();  // 初期描画
+			for(uint32_t f = 0; f < FRAMES; ++f) {
+				sc.step(f);
+				auto t = bench_usec();
+				dir.update();
+				res.usec_ += bench_usec() - t;
+				res.visit_ += dir.num_;
+				res.draw_ += dir.draw_num_;
+				res.pixels_ += dir.pixels_;
+				auto h = hash_fb_();
+				if(all) hash.push_back(h);
+				else if(hash[f] == h) ++res.match_;
+			}
+		}
+		legacy_ = nullptr;
+		return res;
+	}
+
+
+	template <class DIR>
+	result_t run_(DIR& dir, const std::vector<uint32_t>& hash)
+	{
+		result_t res = { 0 };
+		init_screen_();
+		{
+			scene sc;
+			dir.update();  // 初期描画
+			for(uint32_t f = 0; f < FRAMES; ++f) {
+				sc.step(f);
+				auto t = bench_usec();
+				dir.update();
+				res.usec_ += bench_usec() - t;
+				const auto& st = dir.get_stat();
+				res.visit_ += st.visit_;
+				res.draw_ += st.draw_;
+				res.pixels_ += st.pixels_;
+				if(hash[f] == hash_fb_()) ++res.match_;
+			}
+		}
+		return res;
+	}
+
+
+	void print_(const char* name, const result_t& r, bool match = true)
+	{
+		printf("%-18s %8.2f us/frame, visit %6.1f, draw %6.1f, pixels %8.0f / frame",
+			name, r.usec_ / FRAMES, static_cast<double>(r.visit_) / FRAMES,
+			static_cast<double>(r.draw_) / FRAMES, static_cast<double>(r.pixels_) / FRAMES);
+		if(match) {
+			printf(", same as full %u / %u", r.match_, FRAMES);
+		}
+		printf("\n");
+	}
+}
+
+
+
+bool insert_widget(gui::widget* w)
+{
+	if(legacy_ != nullptr) return legacy_->insert(w);
+	if(widd_ != nullptr) return widd_->insert(w);
+	if(widd_back_ != nullptr) return widd_back_->insert(w);
+	return false;
+}
+
+
+void remove_widget(gui::widget* w)
+{
+	if(legacy_ != nullptr) legacy_->remove(w);
+	if(widd_ != nullptr) widd_->remove(w);
+	if(widd_back_ != nullptr) widd_back_->remove(w);
+}
+
+
+int main(int argc, char* argv[])
+{
+	printf("widget_director bench: %dx%d, %u widgets, %u frames\n",
+		glc_host::width, glc_host::height, scene::COLS * scene::ROWS + 1, FRAMES);
+
+	static WIDD widd(render_, touch_);
+	static WIDD_BACK widd_back(render_, touch_);
+	widd_back.set_back_buffer(back_);
+
+	for(uint32_t n = 0; n < 2; ++n) {
+		meter_ = n != 0;
+		printf("%s\n", meter_ ? "touch, title, 8 meters / frame, move:" : "touch, title:");
+
+		std::vector<uint32_t> hash;
+		auto ful = run_legacy_(true, hash);
+		print_("full (reference)", ful, false);
+
+		auto leg = run_legacy_(false, hash);
+		print_("legacy (walk all)", leg);
+
+		widd_ = &widd;
+		auto dmg = run_(widd, hash);
+		widd_ = nullptr;
+		print_("damage rect", dmg);
+
+		widd_back_ = &widd_back;
+		auto dbk = run_(widd_back, hash);
+		widd_back_ = nullptr;
+		print_("damage rect + back", dbk);
+	}
+
+	printf("visit: widgets hit-tested, draw: widget draw calls, pixels: legacy = widget rects, "
+		"damage = merged damage rects\n");
+	return 0;
+}
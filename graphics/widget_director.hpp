@@ -9,6 +9,9 @@
 */
 //=====================================================================//
 #include <array>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
 #include "graphics/widget.hpp"
 #include "graphics/group.hpp"
 #include "graphics/frame.hpp"
@@ -26,41 +29,370 @@ namespace gui {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	Widget ディレクター
+		@brief	Widget ディレクター @n
+				・widget は、変化した領域を「invalidate()」で登録する。@n
+				・登録された領域は、重なりを合成して、重なる widget だけを、@n
+				  領域でクリップして描画する。@n
+				・タッチ判定と、描画対象の検索は、画面を分割したグリッドで行う。@n
+				・BACK を有効にすると、再描画領域だけを裏バッファで描画して転送する。
 		@param[in]	RDR		レンダークラス
 		@param[in]	TOUCH	タッチクラス
 		@param[in]	WNUM	widget の最大管理数
+		@param[in]	BACK	裏バッファを使う場合「true」（RDR::set_fb が必要）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class RDR, class TOUCH, uint32_t WNUM>
+	template <class RDR, class TOUCH, uint32_t WNUM, bool BACK = false>
 	struct widget_director {
 
 		struct widget_t {
 			widget*			w_;
-			const char*		title_;	// タイトルの変化を監視するパッド
-			const void*		mobj_;	// モーションオブジェクト
-			graphics::share_color	base_color_;  // ベースカラーの変化を監視するパッド
-			graphics::share_color	font_color_;  // フォントカラーの変化を監視するパッド
+			vtx::srect		rect_;	// 描画領域（スクリーン座標）
+			vtx::srect		area_;	// グリッドに登録した領域（タッチ拡張領域を含む）
 			widget::STATE	state_;
 			bool			init_;
 			bool			focus_;
-			bool			draw_;
-			widget_t() : w_(nullptr), title_(nullptr), mobj_(nullptr),
-				base_color_(graphics::def_color::White), font_color_(graphics::def_color::White),
+			widget_t() : w_(nullptr), rect_(0), area_(0),
 				state_(widget::STATE::DISABLE),
-				init_(false), focus_(false), draw_(false) { }
+				init_(false), focus_(false) { }
 		};
 
 		typedef std::array<widget_t, WNUM> WIDGETS; 
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	統計（最後のアップデート）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stat_t {
+			uint32_t	visit_;		///< タッチ判定した widget 数
+			uint32_t	draw_;		///< 描画した widget 数（延べ）
+			uint32_t	damage_;	///< 再描画領域の数
+			uint32_t	pixels_;	///< 再描画領域の総ピクセル数
+			stat_t() noexcept : visit_(0), draw_(0), damage_(0), pixels_(0) { }
+		};
+
+		static const uint32_t DAMAGE_NUM = 16;	///< 再描画領域の最大数
+
 	private:
 		using GLC = typename RDR::glc_type;
+		typedef typename RDR::value_type VALUE;
+
+		static const int16_t GRID_SHIFT = 5;	///< グリッドのセル（32 x 32）
+		static const int16_t GRID_W = (GLC::width  + (1 << GRID_SHIFT) - 1) >> GRID_SHIFT;
+		static const int16_t GRID_H = (GLC::height + (1 << GRID_SHIFT) - 1) >> GRID_SHIFT;
+
+		struct mask_t {
+			uint32_t	bits_[(WNUM + 31) / 32];
+
+			void clear() noexcept { for(auto& b : bits_) b = 0; }
+			void set(uint32_t i) noexcept { bits_[i >> 5] |= 1 << (i & 31); }
+			void reset(uint32_t i) noexcept { bits_[i >> 5] &= ~(1 << (i & 31)); }
+			void merge(const mask_t& m) noexcept {
+				for(uint32_t i = 0; i < ((WNUM + 31) / 32); ++i) bits_[i] |= m.bits_[i];
+			}
+			// 登録順（小さい番号から）に列挙
+			template <class FUNC>
+			void loop(FUNC func) const noexcept {
+				for(uint32_t i = 0; i < ((WNUM + 31) / 32); ++i) {
+					auto b = bits_[i];
+					while(b != 0) {
+						uint32_t n = __builtin_ctz(b);
+						b &= b - 1;
+						func((i << 5) + n);
+					}
+				}
+			}
+		};
 
 		RDR&		rdr_;
 		TOUCH&		touch_;
 
 		WIDGETS		widgets_;
 
+		mask_t		grid_[GRID_W * GRID_H];
+		mask_t		active_;	// タッチ判定を続ける widget
+
+		vtx::srect	damage_[DAMAGE_NUM];
+		uint32_t	damage_num_;
+
+		VALUE*		back_;
+		VALUE*		front_;
+
+		stat_t		stat_;
+
+		static bool overlap_(const vtx::srect& a, const vtx::srect& b) noexcept
+		{
+			return a.org.x < b.end_x() && b.org.x < a.end_x()
+				&& a.org.y < b.end_y() && b.org.y < a.end_y();
+		}
+
+
+		static vtx::srect merge_(const vtx::srect& a, const vtx::srect& b) noexcept
+		{
+			vtx::spos org(std::min(a.org.x, b.org.x), std::min(a.org.y, b.org.y));
+			vtx::spos end(std::max(a.end_x(), b.end_x()), std::max(a.end_y(), b.end_y()));
+			return vtx::srect(org, end - org);
+		}
+
+
+		// 共通部分（無い場合「false」）
+		static bool clip_(const vtx::srect& a, vtx::srect& b) noexcept
+		{
+			vtx::spos org(std::max(a.org.x, b.org.x), std::max(a.org.y, b.org.y));
+			vtx::spos end(std::min(a.end_x(), b.end_x()), std::min(a.end_y(), b.end_y()));
+			if(org.x >= end.x || org.y >= end.y) return false;
+			b.set(org, end - org);
+			return true;
+		}
+
+
+		static int32_t area_(const vtx::srect& r) noexcept
+		{
+			return static_cast<int32_t>(r.size.x) * static_cast<int32_t>(r.size.y);
+		}
+
+
+		void add_damage_(vtx::srect r) noexcept
+		{
+			if(!clip_(vtx::srect(0, 0, GLC::width, GLC::height), r)) return;
+
+			uint32_t i = 0;
+			while(i < damage_num_) {
+				if(overlap_(damage_[i], r)) {  // 重なる領域は合成して、やり直す
+					r = merge_(damage_[i], r);
+					damage_[i] = damage_[--damage_num_];
+					i = 0;
+				} else {
+					++i;
+				}
+			}
+			if(damage_num_ < DAMAGE_NUM) {
+				damage_[damage_num_] = r;
+				++damage_num_;
+				return;
+			}
+			// 溢れた場合、合成で増える面積が最小の領域と合成
+			uint32_t idx = 0;
+			int32_t inc = 0x7fffffff;
+			for(uint32_t j = 0; j < damage_num_; ++j) {
+				auto n = area_(merge_(damage_[j], r)) - area_(damage_[j]);
+				if(n < inc) {
+					inc = n;
+					idx = j;
+				}
+			}
+			r = merge_(damage_[idx], r);
+			damage_[idx] = damage_[--damage_num_];
+			add_damage_(r);
+		}
+
+
+		uint32_t find_(widget* w) const noexcept
+		{
+			for(uint32_t i = 0; i < WNUM; ++i) {
+				if(widgets_[i].w_ == w) return i;
+			}
+			return WNUM;
+		}
+
+
+		void unlink_grid_(uint32_t idx) noexcept
+		{
+			auto& a = widgets_[idx].area_;
+			if(a.size.x <= 0 || a.size.y <= 0) return;
+
+			for(int16_t y = a.org.y >> GRID_SHIFT; y <= ((a.end_y() - 1) >> GRID_SHIFT); ++y) {
+				for(int16_t x = a.org.x >> GRID_SHIFT; x <= ((a.end_x() - 1) >> GRID_SHIFT); ++x) {
+					grid_[y * GRID_W + x].reset(idx);
+				}
+			}
+			a.size.set(0);
+		}
+
+
+		// 位置の更新とグリッドへの登録（位置が変わった場合「true」）
+		bool link_grid_(uint32_t idx) noexcept
+		{
+			auto& t = widgets_[idx];
+			vtx::srect r(t.w_->get_final_position(), t.w_->get_location().size);
+			bool move = r.org != t.rect_.org || r.size != t.rect_.size;
+			t.rect_ = r;
+
+			unlink_grid_(idx);
+			const auto& e = t.w_->get_touch_state().expand_;
+			vtx::srect a(r.org - e, r.size + e * 2);
+			if(!clip_(vtx::srect(0, 0, GLC::width, GLC::height), a)) return move;
+
+			t.area_ = a;
+			for(int16_t y = a.org.y >> GRID_SHIFT; y <= ((a.end_y() - 1) >> GRID_SHIFT); ++y) {
+				for(int16_t x = a.org.x >> GRID_SHIFT; x <= ((a.end_x() - 1) >> GRID_SHIFT); ++x) {
+					grid_[y * GRID_W + x].set(idx);
+				}
+			}
+			return move;
+		}
+
+
+		// 親が移動した場合、子の位置も更新
+		void link_childs_(widget* w) noexcept
+		{
+			for(uint32_t i = 0; i < WNUM; ++i) {
+				auto& t = widgets_[i];
+				if(t.w_ == nullptr || !t.init_) continue;
+				for(auto* p = t.w_->get_parents(); p != nullptr; p = p->get_parents()) {
+					if(p == w) {
+						auto old = t.rect_;
+						if(link_grid_(i) && t.state_ != widget::STATE::DISABLE) {
+							add_damage_(old);
+							add_damage_(t.rect_);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+
+		// 再描画リストの回収
+		void fetch_damage_() noexcept
+		{
+			vtx::srect dmg;
+			widget* w;
+			while((w = widget::fetch_dirty(dmg)) != nullptr) {
+				auto idx = find_(w);
+				if(idx >= WNUM) continue;  // 登録されていない
+
+				auto& t = widgets_[idx];
+				if(!t.init_) {  // 初期化プロセス
+					w->init();
+					w->cancel_dirty();  // 全体を描画する
+					t.init_ = true;
+					dmg.set(vtx::spos(0), w->get_location().size);
+				}
+				auto old = t.rect_;
+				bool move = link_grid_(idx);
+				t.state_ = w->get_state();
+				if(move) {  // 移動した場合、元の領域と全体を再描画
+					link_childs_(w);
+					if(t.state_ != widget::STATE::DISABLE) add_damage_(old);
+					dmg.set(vtx::spos(0), t.rect_.size);
+				}
+				if(t.state_ == widget::STATE::DISABLE) continue;
+
+				vtx::srect r(t.rect_.org + dmg.org, dmg.size);
+				if(!clip_(t.rect_, r)) continue;
+				add_damage_(r);
+			}
+		}
+
+
+		void copy_rect_(VALUE* dst, const VALUE* src, const vtx::srect& r) noexcept
+		{
+			for(int16_t y = r.org.y; y < r.end_y(); ++y) {
+				auto ofs = y * GLC::line_width + r.org.x;
+				std::memcpy(&dst[ofs], &src[ofs], r.size.x * sizeof(VALUE));
+			}
+		}
+
+
+		void begin_back_(const vtx::srect& r, std::true_type) noexcept
+		{
+			if(back_ == nullptr) return;
+			front_ = rdr_.at_fb();
+			copy_rect_(back_, front_, r);
+			rdr_.set_fb(back_);
+		}
+		void begin_back_(const vtx::srect& r, std::false_type) noexcept { }
+
+
+		void end_back_(const vtx::srect& r, std::true_type) noexcept
+		{
+			if(back_ == nullptr) return;
+			rdr_.set_fb(front_);
+			copy_rect_(front_, back_, r);
+		}
+		void end_back_(const vtx::srect& r, std::false_type) noexcept { }
+
+
+		void draw_widget_(widget* w) noexcept
+		{
+			switch(w->get_id()) {
+			case widget::ID::GROUP:
+				break;
+			case widget::ID::FRAME:
+				{
+					auto* p = dynamic_cast<frame*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::DIALOG:
+				{
+					auto* p = dynamic_cast<dialog*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::BUTTON:
+				{
+					auto* p = dynamic_cast<button*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::CHECK:
+				{
+					auto* p = dynamic_cast<check*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::RADIO:
+				{
+					auto* p = dynamic_cast<radio*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::SLIDER:
+				{
+					auto* p = dynamic_cast<slider*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::MENU:
+				{
+					auto* p = dynamic_cast<menu*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::TERM:
+				{
+//						auto* p = dynamic_cast<term*>(w);
+//						if(p == nullptr) break;
+//						p->draw(rdr_);
+				}
+				break;
+			case widget::ID::SPINBOX:
+				{
+					auto* p = dynamic_cast<spinbox*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			case widget::ID::CLOSEBOX:
+				{
+					auto* p = dynamic_cast<closebox*>(w);
+					if(p == nullptr) break;
+					p->draw(rdr_);
+				}
+				break;
+			}
+		}
+
+
 		// ipass 自分を含めない場合「false」
 		uint32_t create_childs_(widget* w, widget_t** list, uint32_t max, bool ipass)
 		{
@@ -90,8 +422,12 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_director(RDR& rdr, TOUCH& touch) noexcept :
-			rdr_(rdr), touch_(touch), widgets_()
-		{ }
+			rdr_(rdr), touch_(touch), widgets_(), damage_num_(0),
+			back_(nullptr), front_(nullptr), stat_()
+		{
+			for(auto& g : grid_) g.clear();
+			active_.clear();
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -106,12 +442,12 @@ namespace gui {
 			for(auto& t : widgets_) {
 				if(t.w_ == nullptr) {
 					t.w_ = w;
-					t.title_ = w->get_title();
-					t.mobj_  = w->get_mobj();
-					t.base_color_ = w->get_base_color();
-					t.font_color_ = w->get_font_color();
+					t.rect_.set(0, 0, 0, 0);
+					t.area_.set(0, 0, 0, 0);
+					t.state_ = w->get_state();
 					t.init_ = false;
-					t.draw_ = true;
+					t.focus_ = false;
+					w->invalidate();
 					return true;
 				}
 			}
@@ -128,16 +464,36 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		bool remove(widget* w) noexcept
 		{
-			for(auto& t : widgets_) {
-				if(t.w_ == w) {
-					t.w_ = nullptr;
-					return true;
-				}
-			}
-			return false;
+			auto idx = find_(w);
+			if(idx >= WNUM) return false;
+
+			unlink_grid_(idx);
+			active_.reset(idx);
+			w->cancel_dirty();
+			widgets_[idx].w_ = nullptr;
+			return true;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	裏バッファの設定（BACK が有効な場合） @n
+					※フレームバッファと同じ大きさ（GLC::line_width x GLC::height）
+			@param[in]	back	裏バッファ（nullptr なら直接描画）
+		*/
+		//-----------------------------------------------------------------//
+		void set_back_buffer(VALUE* back) noexcept { back_ = back; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計の取得（最後のアップデート）
+			@return 統計
+		*/
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const noexcept { return stat_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	四角を描画
@@ -170,15 +526,18 @@ namespace gui {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	再描画設定
+			@brief	再描画設定 @n
+					※位置の変更も反映される
 		*/
 		//-----------------------------------------------------------------//
 		void redraw_all() noexcept
 		{
-			for(auto& t : widgets_) {
+			for(uint32_t i = 0; i < WNUM; ++i) {
+				auto& t = widgets_[i];
 				if(t.w_ == nullptr) continue;
+				if(t.init_) link_grid_(i);
 				if(t.w_->get_state() == widget::STATE::ENABLE) {
-					t.draw_ = true;
+					t.w_->invalidate();
 				}
 			}
 		}
@@ -191,168 +550,110 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		void update() noexcept
 		{
-			// 状態の生成とGUIへ反映
+			stat_ = stat_t();
+
+			// 前回から登録された widget を初期化して、グリッドに登録
+			fetch_damage_();
+
+			// タッチ判定（タッチ位置のセルと、タッチ中の widget だけ）
+			mask_t visit = active_;
 			{
 				auto num = touch_.get_touch_num();
 				const auto& tp = touch_.get_touch_pos(0);
-				for(auto& t : widgets_) {
-					if(t.w_ == nullptr) continue;
-					if(!t.init_) {  // 初期化プロセス
-						t.w_->init();
-						t.init_ = true;
-						t.draw_ = true;
-					}
-					if(t.state_ != t.w_->get_state()) {
-						t.state_ = t.w_->get_state();
-						t.draw_ = true;
-					}
-					if(t.w_->get_state() == widget::STATE::ENABLE) {
-						t.w_->update_touch(tp.pos, num);
-					}
-					if(t.focus_ != t.w_->get_focus()) {
-						t.focus_ = t.w_->get_focus();
-						t.draw_ = true;
-					}
-					if(t.w_->get_title() != t.title_) {  // タイトル変更で再描画
-						t.title_ = t.w_->get_title();
-						t.draw_ = true;
-					}
-					if(t.w_->get_mobj() != t.mobj_) {  // mobj 変更で再描画
-						t.mobj_ = t.w_->get_mobj();
-						t.draw_ = true;
-					}
-					if(t.w_->get_base_color() != t.base_color_) {  // ベースカラー変更で再描画
-						t.base_color_ = t.w_->get_base_color();
-						t.draw_ = true;
+				if(static_cast<uint16_t>(tp.pos.x) < static_cast<uint16_t>(GLC::width)
+					&& static_cast<uint16_t>(tp.pos.y) < static_cast<uint16_t>(GLC::height)) {
+					visit.merge(grid_[(tp.pos.y >> GRID_SHIFT) * GRID_W + (tp.pos.x >> GRID_SHIFT)]);
+				}
+				visit.loop([&](uint32_t idx) {
+					auto& t = widgets_[idx];
+					auto* w = t.w_;
+					++stat_.visit_;
+					if(w->get_state() != widget::STATE::ENABLE) {
+						active_.reset(idx);
+						return;
 					}
-					if(t.w_->get_font_color() != t.font_color_) {  // フォントカラー変更で再描画
-						t.font_color_ = t.w_->get_font_color();
-						t.draw_ = true;
+					w->update_touch(tp.pos, num);
+					if(t.focus_ != w->get_focus()) {
+						t.focus_ = w->get_focus();
+						w->invalidate();
 					}
-					if(t.w_->get_update()) {  // 更新リクエス？
-						t.w_->set_update(false);
-						t.draw_ = true;
+					const auto& ts = w->get_touch_state();
+					if(t.focus_ || ts.level_ || ts.positive_ || ts.negative_) {
+						active_.set(idx);
+					} else {
+						active_.reset(idx);
 					}
-				}
+				});
 			}
 
-			for(auto& t : widgets_) {
-				if(t.w_ == nullptr) continue;
-				if(t.w_->get_state() == widget::STATE::ENABLE) {
-					const auto& ts = t.w_->get_touch_state();
-					if(ts.negative_) {
-						bool ena = true;
-						if(t.w_->get_id() == widget::ID::CHECK) {
-							auto* w = dynamic_cast<check*>(t.w_);
-							if(w != nullptr) {
-								ena = !w->get_enable();
-							}
-						}
-						t.w_->exec_select(ena);
-						t.draw_ = true;
-						if(t.w_->get_id() == widget::ID::RADIO) {
-							widget_t* list[8];
-							auto n = create_childs_(t.w_, list, 8, true);
-							for(uint16_t i = 0; i < n; ++i) {
-								list[i]->w_->exec_select(false);
-								list[i]->draw_ = true;
-							}							
+			visit.loop([&](uint32_t idx) {
+				auto& t = widgets_[idx];
+				if(t.w_ == nullptr) return;
+				if(t.w_->get_state() != widget::STATE::ENABLE) return;
+
+				const auto& ts = t.w_->get_touch_state();
+				if(ts.negative_) {
+					bool ena = true;
+					if(t.w_->get_id() == widget::ID::CHECK) {
+						auto* w = dynamic_cast<check*>(t.w_);
+						if(w != nullptr) {
+							ena = !w->get_enable();
 						}
 					}
-					if(ts.positive_) {
-						t.draw_ = true;
+					t.w_->exec_select(ena);
+					t.w_->invalidate();
+					if(t.w_->get_id() == widget::ID::RADIO) {
+						widget_t* list[8];
+						auto n = create_childs_(t.w_, list, 8, true);
+						for(uint16_t i = 0; i < n; ++i) {
+							list[i]->w_->exec_select(false);
+							list[i]->w_->invalidate();
+						}							
 					}
-					if(ts.level_) {
-						if(t.w_->get_id() == widget::ID::SLIDER) {
-							t.draw_ = true;
-						} else if(t.w_->get_id() == widget::ID::MENU) {
-							t.draw_ = true;
-						}
+				}
+				if(ts.positive_) {
+					t.w_->invalidate();
+				}
+				if(ts.level_) {
+					if(t.w_->get_id() == widget::ID::SLIDER) {
+						t.w_->invalidate();
+					} else if(t.w_->get_id() == widget::ID::MENU) {
+						t.w_->invalidate();
 					}
 				}
-			}
+			});
 
-			for(auto& t : widgets_) {
-				if(t.w_ == nullptr) continue;
-				if(t.w_->get_state() == widget::STATE::DISABLE) continue;
-				if(!t.draw_) continue; 
-				t.draw_ = false;
-
-				switch(t.w_->get_id()) {
-				case widget::ID::GROUP:
-					break;
-				case widget::ID::FRAME:
-					{
-						auto* w = dynamic_cast<frame*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::DIALOG:
-					{
-						auto* w = dynamic_cast<dialog*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::BUTTON:
-					{
-						auto* w = dynamic_cast<button*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::CHECK:
-					{
-						auto* w = dynamic_cast<check*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::RADIO:
-					{
-						auto* w = dynamic_cast<radio*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::SLIDER:
-					{
-						auto* w = dynamic_cast<slider*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::MENU:
-					{
-						auto* w = dynamic_cast<menu*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::TERM:
-					{
-//						auto* w = dynamic_cast<term*>(t.w_);
-//						if(w == nullptr) break;
-//						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::SPINBOX:
-					{
-						auto* w = dynamic_cast<spinbox*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
-					}
-					break;
-				case widget::ID::CLOSEBOX:
-					{
-						auto* w = dynamic_cast<closebox*>(t.w_);
-						if(w == nullptr) break;
-						w->draw(rdr_);
+			// タッチで変化した widget を回収
+			fetch_damage_();
+
+			// 再描画領域毎に、重なる widget をクリップして描画
+			auto clip = rdr_.get_clip();
+			for(uint32_t i = 0; i < damage_num_; ++i) {
+				const auto& d = damage_[i];
+				stat_.pixels_ += area_(d);
+
+				mask_t cand;
+				cand.clear();
+				for(int16_t y = d.org.y >> GRID_SHIFT; y <= ((d.end_y() - 1) >> GRID_SHIFT); ++y) {
+					for(int16_t x = d.org.x >> GRID_SHIFT; x <= ((d.end_x() - 1) >> GRID_SHIFT); ++x) {
+						cand.merge(grid_[y * GRID_W + x]);
 					}
-					break;
 				}
+
+				begin_back_(d, std::integral_constant<bool, BACK>());
+				rdr_.set_clip(d);
+				cand.loop([&](uint32_t idx) {
+					const auto& t = widgets_[idx];
+					if(t.state_ == widget::STATE::DISABLE) return;
+					if(!overlap_(t.rect_, d)) return;
+					draw_widget_(t.w_);
+					++stat_.draw_;
+				});
+				rdr_.set_clip(clip);
+				end_back_(d, std::integral_constant<bool, BACK>());
 			}
+			stat_.damage_ = damage_num_;
+			damage_num_ = 0;
 		}
 
 
@@ -12,6 +12,10 @@
 #include <functional>
 #include "common/file_io.hpp"
 
+extern "C" {
+	void set_sample_rate(uint32_t freq);
+};
+
 namespace sound {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -81,13 +85,16 @@ namespace sound {
 
 			uint32_t	all_time_;
 
+			uint32_t	sample_rate_;
+			bool		rate_defer_;
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
 		af_play() noexcept : ctrl_task_(), tag_task_(), update_task_(),
-			state_(STATE::IDLE), all_time_(0)
+			state_(STATE::IDLE), all_time_(0), sample_rate_(0), rate_defer_(false)
 		{ }
 
 
@@ -170,5 +177,40 @@ namespace sound {
 		*/
 		//-----------------------------------------------------------------//
 		auto get_all_time() const noexcept { return all_time_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サンプリング周波数の設定を、呼び出し側に任せる @n
+					※曲間を詰めて再生する場合、前の曲の残りを出し切ってから @n
+					切り替える為（codec_mgr）
+			@param[in]	ena	「false」なら info で設定する
+		*/
+		//-----------------------------------------------------------------//
+		void set_rate_defer(bool ena = true) noexcept { rate_defer_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サンプリング周波数を設定（info から呼ぶ）
+			@param[in]	freq	サンプリング周波数
+		*/
+		//-----------------------------------------------------------------//
+		void set_sample_rate_(uint32_t freq) noexcept
+		{
+			sample_rate_ = freq;
+			if(!rate_defer_) {
+				set_sample_rate(freq);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	出力するサンプリング周波数を取得
+			@return サンプリング周波数
+		*/
+		//-----------------------------------------------------------------//
+		auto get_sample_rate() const noexcept { return sample_rate_; }
 	};
 }
@@ -27,6 +27,8 @@ namespace sound {
 		PCM24_STEREO,	///< PCM 24 ビット、ステレオ
 		PCM32_MONO,		///< PCM 32 ビット、モノラル
 		PCM32_STEREO,	///< PCM 32 ビット、モノラル
+		FLOAT32_MONO,	///< 浮動小数点 32 ビット、モノラル
+		FLOAT32_STEREO,	///< 浮動小数点 32 ビット、ステレオ
 	};
 
 
@@ -0,0 +1,933 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	オーディオ・ライブラリー（曲の索引）クラス @n
+			SD カードを走査して、曲（wav, mp3, flac）のパス、演奏時間、サンプリング周波数、@n
+			アーティスト、アルバム、タイトル、アルバム・アートの位置を、索引ファイルに保存する。@n
+			アーティスト、アルバム、タイトル順の整列表も保存するので、読み込んだ後は、@n
+			並べ替え無しで、一覧と、前方一致の検索（二分探索）ができる。@n
+			更新はディレクトリー単位で、ディレクトリーの日付と、中の曲の（名前、サイズ、日付）@n
+			から作る署名が、前の索引と同じなら、前のレコードをそのまま使う。@n
+			（FAT では、ファイルを追加、削除しても、ディレクトリーの日付は変わらないので、@n
+			ディレクトリー・エントリーの読み出しだけで求まる署名を併用する）@n
+			変わったディレクトリーでも、名前、サイズ、日付が同じ曲は、タグを読み直さない。@n
+			走査は service(num) で少しずつ行うので、他の処理の合間に更新できる。@n
+			記憶割り当ては使わず、各領域のサイズはテンプレートで指定。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "common/file_io.hpp"
+#include "sound/tag.hpp"
+#include "sound/id3_mgr.hpp"
+#include "sound/wav_in.hpp"
+#include "sound/flac_dec.hpp"
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  オーディオ・ライブラリー・クラス
+		@param[in]	TRACK	最大曲数（65535 以下）
+		@param[in]	ARENA	曲レコード領域のサイズ
+		@param[in]	DIRS	最大ディレクトリー数（65535 以下）
+		@param[in]	PATHS	ディレクトリー・パス領域のサイズ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t TRACK, uint32_t ARENA, uint32_t DIRS, uint32_t PATHS>
+	class audio_lib {
+
+		static_assert(TRACK <= 65535, "TRACK must be 65535 or less");
+		static_assert(DIRS <= 65535, "DIRS must be 65535 or less");
+		static_assert((ARENA & 3) == 0 && (PATHS & 3) == 0, "ARENA, PATHS must be a multiple of 4");
+
+	public:
+		static const uint16_t VERSION = 1;	///< 索引ファイルの版
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  整列キー
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class KEY : uint8_t {
+			ARTIST,	///< アーティスト、アルバム、トラック番号順
+			ALBUM,	///< アルバム、トラック番号順
+			TITLE,	///< タイトル、アーティスト順
+		};
+		static const uint32_t KEY_NUM = 3;
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  コーデック
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class CODEC : uint8_t {
+			NONE,
+			WAV,
+			MP3,
+			FLAC,
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  曲レコード（32 バイト＋文字列） @n
+					ファイル名、タイトル、アーティスト、アルバムの文字列（０終端）が、@n
+					この後に続き、全体を４バイト境界に揃える。
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct track_t {
+			uint16_t	len_;		///< レコードのバイト数
+			uint16_t	dir_;		///< ディレクトリー番号
+			uint32_t	size_;		///< ファイル・サイズ
+			uint16_t	fdate_;		///< FatFs 日付
+			uint16_t	ftime_;		///< FatFs 時間
+			uint32_t	rate_;		///< サンプリング周波数
+			uint16_t	second_;	///< 演奏時間（秒）
+			CODEC		codec_;		///< コーデック
+			uint8_t		track_;		///< トラック番号（無ければ０）
+			uint32_t	art_ofs_;	///< アルバム・アートのファイル位置（無ければ０）
+			uint32_t	art_len_;	///< アルバム・アートのバイト数
+			char		art_ext_[4];	///< アルバム・アートの形式（jpg, png, bmp）
+
+			const char* get_name() const noexcept { return reinterpret_cast<const char*>(this + 1); }
+			const char* get_title() const noexcept { return next_(get_name()); }
+			const char* get_artist() const noexcept { return next_(get_title()); }
+			const char* get_album() const noexcept { return next_(get_artist()); }
+
+		private:
+			static const char* next_(const char* s) noexcept { return s + std::strlen(s) + 1; }
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  走査の統計
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stat_t {
+			uint32_t	dirs;		///< 走査したディレクトリー数
+			uint32_t	keep_dirs;	///< 前の索引を使ったディレクトリー数
+			uint32_t	parse;		///< タグを読んだ曲数
+			uint32_t	keep;		///< 前の索引を使った曲数
+			stat_t() noexcept : dirs(0), keep_dirs(0), parse(0), keep(0) { }
+		};
+
+	private:
+		// 索引ファイル：head_t、dir_t[dirs_]、パス（paths_）、曲レコード（arena_）、
+		// 整列表 uint16_t[KEY_NUM][tracks_]
+		struct head_t {
+			char		id_[4];		///< "RXAL"
+			uint16_t	version_;
+			uint16_t	dirs_;
+			uint32_t	tracks_;
+			uint32_t	arena_;
+			uint32_t	paths_;
+		};
+
+		struct dir_t {
+			uint32_t	path_;		///< パスの位置（パス領域）
+			uint32_t	hash_;		///< パスのハッシュ
+			uint32_t	sign_;		///< 署名
+			uint32_t	ofs_;		///< 曲レコードの位置
+			uint32_t	len_;		///< 曲レコードのバイト数
+			uint16_t	top_;		///< 最初の曲番号
+			uint16_t	num_;		///< 曲数
+		};
+
+		enum class TASK : uint8_t {
+			IDLE,
+			LIST,	///< ディレクトリーの署名
+			FILES,	///< 変わったディレクトリーの曲
+		};
+
+		dir_t		dir_[DIRS];
+		char		path_[PATHS];
+		uint8_t		arena_[ARENA] __attribute__ ((aligned(4)));
+		uint32_t	track_[TRACK];
+		uint16_t	key_[KEY_NUM][TRACK];
+
+		uint32_t	dir_num_;
+		uint32_t	path_pos_;
+		uint32_t	arena_pos_;
+		uint32_t	track_num_;
+
+		// 更新時の前の索引
+		dir_t		old_[DIRS];
+		uint32_t	old_num_;
+		uint32_t	old_base_;	///< 曲レコードのファイル位置
+		utils::file_io	old_fio_;
+
+		utils::file_io	fin_;
+		DIR			dh_;
+		char		idx_[32];
+		TASK		task_;
+		uint32_t	scan_;
+		uint32_t	stage_len_;	///< 変わったディレクトリーの、前のレコードのバイト数
+		bool		overflow_;
+		bool		dirty_;
+		stat_t		stat_;
+
+		wav_in		wav_;
+		flac_meta	flac_;
+		tag_t		tag_;
+
+		static uint32_t hash_(uint32_t h, const void* src, uint32_t len) noexcept
+		{
+			auto p = static_cast<const uint8_t*>(src);
+			for(uint32_t i = 0; i < len; ++i) {
+				h ^= p[i];
+				h *= 16777619;  // FNV-1a
+			}
+			return h;
+		}
+
+
+		static int upper_(int ch) noexcept
+		{
+			if(ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+			return ch;
+		}
+
+
+		static int icmp_(const char* a, const char* b) noexcept
+		{
+			while(*a != 0 || *b != 0) {
+				int ca = upper_(static_cast<uint8_t>(*a++));
+				int cb = upper_(static_cast<uint8_t>(*b++));
+				if(ca != cb) return ca - cb;
+			}
+			return 0;
+		}
+
+
+		// 前方一致（s が t で始まれば０、それ以外は icmp_ と同じ順序）
+		static int pcmp_(const char* s, const char* t) noexcept
+		{
+			while(*t != 0) {
+				int cs = upper_(static_cast<uint8_t>(*s++));
+				int ct = upper_(static_cast<uint8_t>(*t++));
+				if(cs != ct) return cs - ct;
+			}
+			return 0;
+		}
+
+
+		static CODEC codec_(const char* name) noexcept
+		{
+			const char* ext = std::strrchr(name, '.');
+			if(ext == nullptr) return CODEC::NONE;
+			if(utils::str::strcmp_no_caps(ext, ".wav") == 0) return CODEC::WAV;
+			if(utils::str::strcmp_no_caps(ext, ".mp3") == 0) return CODEC::MP3;
+			if(utils::str::strcmp_no_caps(ext, ".flac") == 0) return CODEC::FLAC;
+			return CODEC::NONE;
+		}
+
+
+		static bool skip_(const FILINFO& fi) noexcept
+		{
+			return fi.fname[0] == '.' || (fi.fattrib & (AM_HID | AM_SYS)) != 0;
+		}
+
+
+		static const char* key_str_(const track_t& t, KEY key) noexcept
+		{
+			switch(key) {
+			case KEY::ARTIST: return t.get_artist();
+			case KEY::ALBUM:  return t.get_album();
+			default:          return t.get_title();
+			}
+		}
+
+
+		const track_t& at_(uint32_t idx) const noexcept
+		{
+			return *reinterpret_cast<const track_t*>(&arena_[track_[idx]]);
+		}
+
+
+		bool make_path_(const char* dir, const char* name, char* dst, uint32_t len) const noexcept
+		{
+			utils::sformat("%s/%s", dst, len) % (std::strcmp(dir, "/") == 0 ? "" : dir) % name;
+			return (std::strlen(dir) + std::strlen(name) + 2) <= len;
+		}
+
+
+		// 署名の初期値は、ディレクトリーの日付（親ディレクトリーのエントリー）
+		bool add_dir_(const char* path, uint16_t fdate, uint16_t ftime) noexcept
+		{
+			uint32_t len = std::strlen(path) + 1;
+			if(dir_num_ >= DIRS || (path_pos_ + len) > PATHS) {
+				overflow_ = true;
+				return false;
+			}
+			auto& d = dir_[dir_num_];
+			d.path_ = path_pos_;
+			d.hash_ = hash_(2166136261, path, len);
+			d.sign_ = hash_(hash_(2166136261, &fdate, sizeof(fdate)), &ftime, sizeof(ftime));
+			d.ofs_ = 0;
+			d.len_ = 0;
+			d.top_ = 0;
+			d.num_ = 0;
+			std::memcpy(&path_[path_pos_], path, len);
+			path_pos_ += len;
+			++dir_num_;
+			return true;
+		}
+
+
+		// 曲レコードを登録する（arena_pos_ の位置に作ってから呼ぶ）
+		void add_track_(uint32_t len) noexcept
+		{
+			auto& t = *reinterpret_cast<track_t*>(&arena_[arena_pos_]);
+			t.len_ = len;
+			t.dir_ = scan_;
+			track_[track_num_] = arena_pos_;
+			++track_num_;
+			arena_pos_ += len;
+		}
+
+
+		bool space_(uint32_t len) noexcept
+		{
+			if(track_num_ >= TRACK || (arena_pos_ + len) > ARENA) {
+				overflow_ = true;
+				return false;
+			}
+			return true;
+		}
+
+
+		const dir_t* find_old_(uint32_t hash) const noexcept
+		{
+			for(uint32_t i = 0; i < old_num_; ++i) {
+				if(old_[i].hash_ == hash) return &old_[i];
+			}
+			return nullptr;
+		}
+
+
+		// 前の索引から、ディレクトリーの曲レコードを arena_pos_ の位置に読む
+		bool read_old_(const dir_t& o) noexcept
+		{
+			if(!old_fio_.is_open() || (arena_pos_ + o.len_) > ARENA) return false;
+			if(!old_fio_.seek(utils::file_io::SEEK::SET, old_base_ + o.ofs_)) return false;
+			if(old_fio_.read(&arena_[arena_pos_], o.len_) != o.len_) return false;
+			// レコード長の検査
+			uint32_t pos = 0;
+			while(pos < o.len_) {
+				const auto& t = *reinterpret_cast<const track_t*>(&arena_[arena_pos_ + pos]);
+				if(t.len_ < sizeof(track_t) || (t.len_ & 3) != 0 || (pos + t.len_) > o.len_) {
+					return false;
+				}
+				pos += t.len_;
+			}
+			return true;
+		}
+
+
+		// MPEG オーディオ（Layer III）の先頭フレームから、周波数と、演奏時間を求める @n
+		// Xing/Info ヘッダーが有ればフレーム数から、無ければ固定ビットレートとして求める
+		static bool mpeg_info_(utils::file_io& fin, uint32_t& rate, uint32_t& second) noexcept
+		{
+			static const uint16_t br1[15] = {
+				0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+			static const uint16_t br2[15] = {
+				0,  8, 16, 24, 32, 40, 48, 56,  64,  80,  96, 112, 128, 144, 160 };
+			static const uint16_t sr[3] = { 44100, 48000, 32000 };
+
+			uint32_t top = fin.tell();
+			uint8_t tmp[512];
+			uint32_t len = fin.read(tmp, sizeof(tmp));
+			for(uint32_t i = 0; (i + 4) <= len; ++i) {
+				if(tmp[i] != 0xff || (tmp[i + 1] & 0xe0) != 0xe0) continue;
+				uint32_t ver = (tmp[i + 1] >> 3) & 3;  // 0: MPEG2.5, 2: MPEG2, 3: MPEG1
+				uint32_t layer = (tmp[i + 1] >> 1) & 3;  // 1: Layer III
+				uint32_t bri = tmp[i + 2] >> 4;
+				uint32_t sri = (tmp[i + 2] >> 2) & 3;
+				if(ver == 1 || layer != 1 || bri == 0 || bri == 15 || sri == 3) continue;
+
+				rate = sr[sri] >> (ver == 3 ? 0 : (ver == 2 ? 1 : 2));
+				uint32_t kbps = ver == 3 ? br1[bri] : br2[bri];
+				bool mono = (tmp[i + 3] >> 6) == 3;
+				uint32_t side = ver == 3 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+				uint32_t spf = ver == 3 ? 1152 : 576;
+				uint32_t x = i + 4 + side;
+				if((x + 12) <= len && (std::strncmp(reinterpret_cast<const char*>(&tmp[x]), "Xing", 4) == 0
+				  || std::strncmp(reinterpret_cast<const char*>(&tmp[x]), "Info", 4) == 0)
+				  && (tmp[x + 7] & 1) != 0) {
+					uint32_t frames = (tmp[x + 8] << 24) | (tmp[x + 9] << 16) | (tmp[x + 10] << 8) | tmp[x + 11];
+					second = static_cast<uint64_t>(frames) * spf / rate;
+				} else {
+					second = (fin.get_file_size() - top - i) * 8 / (kbps * 1000);
+				}
+				return true;
+			}
+			return false;
+		}
+
+
+		// 曲のタグと、情報を読んで、arena_pos_ の位置に曲レコードを作る
+		bool parse_(const char* path, const FILINFO& fi, CODEC codec) noexcept
+		{
+			char tmp[FF_MAX_LFN + 1];
+			if(!make_path_(path, fi.fname, tmp, sizeof(tmp))) return false;
+			if(!fin_.open(tmp, "rb")) return false;
+
+			uint32_t rate = 0;
+			uint32_t second = 0;
+			bool ok = false;
+			tag_.clear();
+			if(codec == CODEC::WAV) {
+				audio_info info;
+				ok = wav_.info(fin_, info);  // タグは tag_task で受け取る
+				rate = info.frequency;
+				second = info.total_second;
+			} else if(codec == CODEC::MP3) {
+				id3_mgr id3;
+				if(id3.parse(fin_)) {
+					tag_ = id3.get_tag();
+				}
+				ok = mpeg_info_(fin_, rate, second);
+			} else if(codec == CODEC::FLAC) {
+				auto& fin = fin_;
+				flac_.start([&fin](void* dst, uint32_t len) {
+					if(dst == nullptr) {  // 読み飛ばし
+						uint32_t rem = fin.get_file_size() - fin.tell();
+						if(len > rem) len = rem;
+						fin.seek(utils::file_io::SEEK::CUR, len);
+						return len;
+					}
+					return fin.read(dst, len);
+				}, 0);
+				ok = flac_.read_meta(tag_);
+				if(ok) {
+					const auto& i = flac_.get_info();
+					rate = i.rate;
+					second = i.samples / i.rate;
+				}
+			}
+			fin_.close();
+			++stat_.parse;
+			if(!ok) return false;
+
+			// タイトルが無い場合は、拡張子を除いたファイル名
+			const char* title = tag_.get_title().c_str();
+			char name[FF_MAX_LFN + 1];
+			if(title[0] == 0) {
+				std::strcpy(name, fi.fname);
+				char* p = std::strrchr(name, '.');
+				if(p != nullptr) *p = 0;
+				title = name;
+			}
+			const char* str[4] = { fi.fname, title,
+				tag_.get_artist().c_str(), tag_.get_album().c_str() };
+			uint32_t slen[4];
+			uint32_t len = sizeof(track_t);
+			for(uint32_t i = 0; i < 4; ++i) {
+				slen[i] = std::strlen(str[i]) + 1;
+				len += slen[i];
+			}
+			len = (len + 3) & ~3;
+			if(!space_(len)) return false;
+
+			auto& t = *reinterpret_cast<track_t*>(&arena_[arena_pos_]);
+			t.size_ = fi.fsize;
+			t.fdate_ = fi.fdate;
+			t.ftime_ = fi.ftime;
+			t.rate_ = rate;
+			t.second_ = second > 65535 ? 65535 : second;
+			t.codec_ = codec;
+			t.track_ = std::atoi(tag_.get_track().c_str());
+			const auto& apic = tag_.get_apic();
+			t.art_ofs_ = apic.len_ > 0 ? apic.ofs_ : 0;
+			t.art_len_ = apic.len_;
+			std::memset(t.art_ext_, 0, sizeof(t.art_ext_));
+			utils::str::strncpy_(t.art_ext_, apic.ext_, sizeof(t.art_ext_));
+			char* dst = reinterpret_cast<char*>(&t + 1);
+			for(uint32_t i = 0; i < 4; ++i) {
+				std::memcpy(dst, str[i], slen[i]);
+				dst += slen[i];
+			}
+			while(dst < reinterpret_cast<char*>(&t) + len) *dst++ = 0;
+			add_track_(len);
+			return true;
+		}
+
+
+		// 変わったディレクトリーで、前のレコード（名前、サイズ、日付が同じ）を探す
+		bool keep_(const FILINFO& fi) noexcept
+		{
+			uint32_t top = dir_[scan_].ofs_;
+			uint32_t pos = 0;
+			while(pos < stage_len_) {
+				const auto& t = *reinterpret_cast<const track_t*>(&arena_[top + pos]);
+				if(t.size_ == fi.fsize && t.fdate_ == fi.fdate && t.ftime_ == fi.ftime
+				  && std::strcmp(t.get_name(), fi.fname) == 0) {
+					if(!space_(t.len_)) return true;
+					std::memcpy(&arena_[arena_pos_], &t, t.len_);
+					add_track_(t.len_);
+					++stat_.keep;
+					return true;
+				}
+				pos += t.len_;
+			}
+			return false;
+		}
+
+
+		void end_dir_() noexcept
+		{
+			auto& d = dir_[scan_];
+			d.len_ = arena_pos_ - d.ofs_;
+			d.num_ = track_num_ - d.top_;
+			f_closedir(&dh_);
+			++scan_;
+			task_ = TASK::LIST;
+		}
+
+
+		// ディレクトリーを読み、サブ・ディレクトリーの登録と、署名を作る
+		void list_() noexcept
+		{
+			auto& d = dir_[scan_];
+			const char* path = &path_[d.path_];
+			++stat_.dirs;
+			d.ofs_ = arena_pos_;
+			d.top_ = track_num_;
+			if(f_opendir(&dh_, path) != FR_OK) {
+				dirty_ = true;
+				++scan_;
+				return;
+			}
+			uint32_t sign = d.sign_;
+			while(1) {
+				FILINFO fi;
+				if(f_readdir(&dh_, &fi) != FR_OK || fi.fname[0] == 0) break;
+				if(skip_(fi)) continue;
+				if(fi.fattrib & AM_DIR) {
+					char tmp[FF_MAX_LFN + 1];
+					if(make_path_(path, fi.fname, tmp, sizeof(tmp))) {
+						add_dir_(tmp, fi.fdate, fi.ftime);
+					}
+				} else if(codec_(fi.fname) != CODEC::NONE) {
+					sign = hash_(sign, fi.fname, std::strlen(fi.fname));
+					sign = hash_(sign, &fi.fsize, sizeof(fi.fsize));
+					sign = hash_(sign, &fi.fdate, sizeof(fi.fdate));
+					sign = hash_(sign, &fi.ftime, sizeof(fi.ftime));
+				}
+			}
+			d.sign_ = sign;
+
+			const dir_t* o = find_old_(d.hash_);
+			if(o != nullptr && o->sign_ == sign && space_(o->len_) && read_old_(*o)) {
+				// 変わらないディレクトリー
+				uint32_t end = arena_pos_ + o->len_;
+				while(arena_pos_ < end && track_num_ < TRACK) {
+					add_track_(reinterpret_cast<const track_t*>(&arena_[arena_pos_])->len_);
+				}
+				if(arena_pos_ < end) {
+					overflow_ = true;
+					arena_pos_ = end;
+				}
+				++stat_.keep_dirs;
+				stat_.keep += track_num_ - d.top_;
+				end_dir_();
+				return;
+			}
+
+			// 変わったディレクトリー（前のレコードは、この後ろの曲で使う）
+			dirty_ = true;
+			stage_len_ = 0;
+			if(o != nullptr && read_old_(*o)) {
+				stage_len_ = o->len_;
+				arena_pos_ += stage_len_;
+			}
+			f_readdir(&dh_, nullptr);
+			task_ = TASK::FILES;
+		}
+
+
+		// 変わったディレクトリーの曲を、１つ登録する
+		void file_() noexcept
+		{
+			FILINFO fi;
+			if(f_readdir(&dh_, &fi) != FR_OK || fi.fname[0] == 0) {
+				// 前のレコードを詰める
+				auto& d = dir_[scan_];
+				if(stage_len_ > 0) {
+					uint32_t top = d.ofs_ + stage_len_;
+					std::memmove(&arena_[d.ofs_], &arena_[top], arena_pos_ - top);
+					arena_pos_ -= stage_len_;
+					for(uint32_t i = d.top_; i < track_num_; ++i) {
+						track_[i] -= stage_len_;
+					}
+					stage_len_ = 0;
+				}
+				end_dir_();
+				return;
+			}
+			if(skip_(fi) || (fi.fattrib & AM_DIR) != 0) return;
+			auto codec = codec_(fi.fname);
+			if(codec == CODEC::NONE) return;
+			if(keep_(fi)) return;
+			parse_(&path_[dir_[scan_].path_], fi, codec);
+		}
+
+
+		void sort_() noexcept
+		{
+			for(uint32_t k = 0; k < KEY_NUM; ++k) {
+				auto* order = key_[k];
+				for(uint32_t i = 0; i < track_num_; ++i) order[i] = i;
+				auto key = static_cast<KEY>(k);
+				std::sort(order, order + track_num_, [this, key](uint16_t a, uint16_t b) {
+					const auto& ta = at_(a);
+					const auto& tb = at_(b);
+					int n = icmp_(key_str_(ta, key), key_str_(tb, key));
+					if(n != 0) return n < 0;
+					if(key == KEY::ARTIST) {
+						n = icmp_(ta.get_album(), tb.get_album());
+						if(n != 0) return n < 0;
+					}
+					if(key == KEY::TITLE) {
+						n = icmp_(ta.get_artist(), tb.get_artist());
+					} else if(ta.track_ != tb.track_) {
+						return ta.track_ < tb.track_;
+					} else {
+						n = icmp_(ta.get_title(), tb.get_title());
+					}
+					if(n != 0) return n < 0;
+					return a < b;
+				});
+			}
+		}
+
+
+		bool save_() noexcept
+		{
+			char tmp[sizeof(idx_) + 4];
+			utils::sformat("%s.tmp", tmp, sizeof(tmp)) % idx_;
+			utils::file_io fo;
+			if(!fo.open(tmp, "wb")) return false;
+
+			head_t h;
+			std::memcpy(h.id_, "RXAL", 4);
+			h.version_ = VERSION;
+			h.dirs_ = dir_num_;
+			h.tracks_ = track_num_;
+			h.arena_ = arena_pos_;
+			h.paths_ = (path_pos_ + 3) & ~3;
+			bool ok = fo.write(&h, sizeof(h)) == sizeof(h);
+			ok = ok && fo.write(dir_, sizeof(dir_t) * dir_num_) == (sizeof(dir_t) * dir_num_);
+			std::memset(&path_[path_pos_], 0, h.paths_ - path_pos_);
+			ok = ok && fo.write(path_, h.paths_) == h.paths_;
+			ok = ok && fo.write(arena_, arena_pos_) == arena_pos_;
+			for(uint32_t k = 0; k < KEY_NUM; ++k) {
+				ok = ok && fo.write(key_[k], track_num_ * 2) == (track_num_ * 2);
+			}
+			fo.close();
+			if(ok) {
+				utils::file_io::remove(idx_);
+				ok = utils::file_io::rename(tmp, idx_);
+			}
+			return ok;
+		}
+
+
+		// 索引ファイルのヘッダーと、ディレクトリー表を読む
+		bool read_head_(utils::file_io& fio, head_t& h, dir_t* dir) noexcept
+		{
+			if(!fio.open(idx_, "rb")) return false;
+			if(fio.read(&h, sizeof(h)) != sizeof(h) || std::strncmp(h.id_, "RXAL", 4) != 0
+			  || h.version_ != VERSION || h.dirs_ > DIRS || h.tracks_ > TRACK
+			  || h.arena_ > ARENA || h.paths_ > PATHS) {
+				fio.close();
+				return false;
+			}
+			if(fio.read(dir, sizeof(dir_t) * h.dirs_) != (sizeof(dir_t) * h.dirs_)) {
+				fio.close();
+				return false;
+			}
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		audio_lib() noexcept : dir_num_(0), path_pos_(0), arena_pos_(0), track_num_(0),
+			old_num_(0), old_base_(0), old_fio_(), fin_(), dh_(), idx_{ 0 },
+			task_(TASK::IDLE), scan_(0), stage_len_(0), overflow_(false), dirty_(false),
+			stat_(), wav_(), flac_(), tag_()
+		{
+			wav_.set_rate_defer(true);  // 出力の周波数は変えない
+			wav_.set_tag_task([this](utils::file_io& fin, const tag_t& tag) { tag_ = tag; });
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プローブ（状態） @n
+					※走査中は、曲の取得、検索はできない
+			@return 走査中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe() const noexcept { return task_ != TASK::IDLE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	曲数を取得
+			@return 曲数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return probe() ? 0 : track_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー数を取得
+			@return ディレクトリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_dir_num() const noexcept { return probe() ? 0 : dir_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	曲、ディレクトリー、領域が溢れたか？ @n
+					※溢れた場合、それ以降の曲、ディレクトリーは登録されない
+			@return 溢れた場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_overflow() const noexcept { return overflow_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査の統計を取得
+			@return 統計
+		 */
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const noexcept { return stat_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	索引ファイルを読み込む（走査はしない）
+			@param[in]	idx		索引ファイルのパス
+			@return 正常なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool load(const char* idx) noexcept
+		{
+			stop();
+			utils::str::strncpy_(idx_, idx, sizeof(idx_));
+			dir_num_ = 0;
+			path_pos_ = 0;
+			arena_pos_ = 0;
+			track_num_ = 0;
+			overflow_ = false;
+
+			head_t h;
+			utils::file_io fio;
+			if(!read_head_(fio, h, dir_)) return false;
+			bool ok = fio.read(path_, h.paths_) == h.paths_;
+			ok = ok && fio.read(arena_, h.arena_) == h.arena_;
+			for(uint32_t k = 0; k < KEY_NUM; ++k) {
+				ok = ok && fio.read(key_[k], h.tracks_ * 2) == (h.tracks_ * 2);
+			}
+			fio.close();
+			if(!ok) return false;
+
+			// 曲レコードの位置を作る
+			uint32_t pos = 0;
+			uint32_t n = 0;
+			while(pos < h.arena_ && n < h.tracks_) {
+				const auto& t = *reinterpret_cast<const track_t*>(&arena_[pos]);
+				if(t.len_ < sizeof(track_t) || (t.len_ & 3) != 0) return false;
+				track_[n] = pos;
+				pos += t.len_;
+				++n;
+			}
+			if(pos != h.arena_ || n != h.tracks_) return false;
+			dir_num_ = h.dirs_;
+			path_pos_ = h.paths_;
+			arena_pos_ = h.arena_;
+			track_num_ = h.tracks_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査（索引の作成、更新）開始 @n
+					索引ファイルが有れば、変わらないディレクトリーは、そのレコードを使う。@n
+					※「probe()」関数が「false」になるまで「service()」を呼ぶ
+			@param[in]	root	ルート・パス
+			@param[in]	idx		索引ファイルのパス
+			@return エラー無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool start(const char* root, const char* idx) noexcept
+		{
+			stop();
+			utils::str::strncpy_(idx_, idx, sizeof(idx_));
+			dir_num_ = 0;
+			path_pos_ = 0;
+			arena_pos_ = 0;
+			track_num_ = 0;
+			overflow_ = false;
+			dirty_ = false;
+			stat_ = stat_t();
+
+			old_num_ = 0;
+			head_t h;
+			if(read_head_(old_fio_, h, old_)) {
+				old_num_ = h.dirs_;
+				old_base_ = sizeof(head_t) + sizeof(dir_t) * h.dirs_ + h.paths_;
+				dirty_ = h.tracks_ == 0;
+			} else {
+				dirty_ = true;
+			}
+
+			if(!add_dir_(root, 0, 0)) {
+				old_fio_.close();
+				return false;
+			}
+			scan_ = 0;
+			task_ = TASK::LIST;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査を停止する（索引は保存しない）
+		 */
+		//-----------------------------------------------------------------//
+		void stop() noexcept
+		{
+			if(task_ == TASK::IDLE) return;
+
+			if(task_ == TASK::FILES) {
+				f_closedir(&dh_);
+			}
+			task_ = TASK::IDLE;
+			old_fio_.close();
+			dir_num_ = 0;
+			track_num_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査サービス @n
+					１単位は、ディレクトリーの署名、又は、変わったディレクトリーの１エントリー。@n
+					走査が終わると、整列表を作り、索引が変わっていれば保存する。
+			@param[in]	num		１回で処理する単位の数
+			@return エラー無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service(uint32_t num) noexcept
+		{
+			if(task_ == TASK::IDLE) return false;
+
+			for(uint32_t i = 0; i < num; ++i) {
+				if(task_ == TASK::LIST) {
+					if(scan_ >= dir_num_) break;
+					list_();
+				} else {
+					file_();
+				}
+			}
+			if(task_ == TASK::LIST && scan_ >= dir_num_) {
+				task_ = TASK::IDLE;
+				dirty_ = dirty_ || dir_num_ != old_num_;
+				old_fio_.close();
+				sort_();
+				if(dirty_) {
+					return save_();
+				}
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	曲を取得
+			@param[in]	idx		曲番号
+			@return 曲レコード
+		 */
+		//-----------------------------------------------------------------//
+		const track_t& get(uint32_t idx) const noexcept { return at_(idx); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	整列順の曲番号を取得
+			@param[in]	key		整列キー
+			@param[in]	pos		整列順の位置
+			@return 曲番号
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_order(KEY key, uint32_t pos) const noexcept
+		{
+			return key_[static_cast<uint32_t>(key)][pos];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	曲のフル・パスを取得
+			@param[in]	idx		曲番号
+			@param[out]	dst		パスの格納先
+			@param[in]	len		格納先のサイズ
+			@return 格納できたら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get_path(uint32_t idx, char* dst, uint32_t len) const noexcept
+		{
+			if(idx >= track_num_) return false;
+			const auto& t = at_(idx);
+			return make_path_(&path_[dir_[t.dir_].path_], t.get_name(), dst, len);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	前方一致の検索（大文字、小文字を区別しない、二分探索） @n
+					一致した曲は、get_order(key, pos) ～ get_order(key, pos + 戻り値 - 1)
+			@param[in]	key		整列キー
+			@param[in]	text	検索する文字列
+			@param[out]	pos		最初に一致した整列順の位置
+			@return 一致した曲数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t find(KEY key, const char* text, uint32_t& pos) const noexcept
+		{
+			if(probe()) return 0;
+			const auto* order = key_[static_cast<uint32_t>(key)];
+			auto first = std::lower_bound(order, order + track_num_, text,
+				[this, key](uint16_t idx, const char* t) {
+					return pcmp_(key_str_(at_(idx), key), t) < 0;
+				});
+			auto last = std::upper_bound(first, order + track_num_, text,
+				[this, key](const char* t, uint16_t idx) {
+					return pcmp_(key_str_(at_(idx), key), t) > 0;
+				});
+			pos = first - order;
+			return last - first;
+		}
+	};
+}
@@ -4,7 +4,10 @@
 	@brief	オーディオ・コーデック・マネージャー @n
 			複数のオーディオ・コーデックを扱う。@n
 			・wav（wav_in.hpp）@n
-			・mp3（mp3_in.hpp）
+			・mp3（mp3_in.hpp）@n
+			・flac（flac_in.hpp）@n
+			曲が終わると、次の曲を、前の曲の残り（FIFO）が鳴っている間に開いて、@n
+			続けて再生する（enable_gapless）。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -13,6 +16,7 @@
 //=====================================================================//
 #include "sound/wav_in.hpp"
 #include "sound/mp3_in.hpp"
+#include "sound/flac_in.hpp"
 #include "sound/sound_out.hpp"
 #include "common/dir_list.hpp"
 #include "common/format.hpp"
@@ -110,11 +114,13 @@ namespace sound {
 
 		wav_in		wav_in_;
 		mp3_in		mp3_in_;
+		flac_in		flac_in_;
 
 		enum class CODEC : uint8_t {
 			NONE,
 			WAV,
 			MP3,
+			FLAC,
 		};
 
 		typedef utils::dir_list DLIST;
@@ -131,64 +137,87 @@ namespace sound {
 
 		CODEC		codec_;
 
-		bool play_mp3_(const char* fname) noexcept
+		// 曲の切り替え（先読み）
+		bool		gapless_;
+		bool		ahead_;		///< 曲が終わったので、次のファイルをすぐに探す
+		uint32_t	rate_;		///< 現在の出力サンプリング周波数
+		bool		tag_pend_;	///< タグの表示を、FIFO が満たされるまで遅らせる
+		tag_t		tag_;
+
+		// 遅らせたタグ表示、開始通知を行う（ファイル位置は戻す）
+		void flush_tag_(utils::file_io& fin, const char* fname, bool force) noexcept
 		{
-			utils::file_io fin;
-			if(!fin.open(fname, "rb")) {
-				return false;
-			}
-			codec_ = CODEC::MP3;
-			mp3_in_.set_ctrl_task([=]() {
-					auto c = list_ctrl_.ctrl();
-					if(c == sound::af_play::CTRL::STOP) {
-						dlist_.stop();
-						stop_ = true;
-					}
-					return c;
-				} );
-			mp3_in_.set_tag_task([=](utils::file_io& fin, const sound::tag_t& tag) {
-				list_ctrl_.tag(fin, tag); }
-			);
+			if(!tag_pend_) return;
+			auto& fifo = sound_out_.at_fifo();
+			if(!force && fifo.length() < (fifo.size() - fifo.size() / 8)) return;
+
+			tag_pend_ = false;
+			auto pos = fin.tell();
+			list_ctrl_.tag(fin, tag_);
+			fin.seek(utils::file_io::SEEK::SET, pos);
+			list_ctrl_.start(fname);
+		}
 
-			// 情報取得
-			bool ret = false;
-			if(mp3_in_.info(fin, info_)) {
-				mp3_in_.set_update_task([=](uint32_t t) { list_ctrl_.update(t); });
-				list_ctrl_.start(fname);
-				stop_ = false;
-				ret = mp3_in_.decode(fin, sound_out_);
+
+		// サンプリング周波数が変わる場合、前の曲の残りを出し切ってから切り替える
+		template <class DEC>
+		void switch_rate_(DEC& dec, uint32_t rate) noexcept
+		{
+			if(rate == 0 || rate == rate_) return;
+			while(sound_out_.at_fifo().length() > 0) {
+				dec.system_delay(1);
 			}
-			list_ctrl_.close();
-			fin.close();
-			return ret;
+			set_sample_rate(rate);
+			rate_ = rate;
 		}
 
 
-		bool play_wav_(const char* fname) noexcept
+		template <class DEC>
+		bool play_(DEC& dec, CODEC codec, const char* fname) noexcept
 		{
 			utils::file_io fin;
 			if(!fin.open(fname, "rb")) {
 				return false;
 			}
-			codec_ = CODEC::WAV;
-			wav_in_.set_ctrl_task([=]() {
+			codec_ = codec;
+			tag_pend_ = false;
+			dec.set_ctrl_task([=, &fin]() {
+					flush_tag_(fin, fname, false);
 					auto c = list_ctrl_.ctrl();
+					if(c != sound::af_play::CTRL::NONE) {
+						flush_tag_(fin, fname, true);
+					}
 					if(c == sound::af_play::CTRL::STOP) {
 						dlist_.stop();
 						stop_ = true;
 					}
 					return c;
 				} );
-			wav_in_.set_tag_task([=](utils::file_io& fin, const sound::tag_t& tag) {
-				list_ctrl_.tag(fin, tag); }
-			);
+			dec.set_tag_task([=](utils::file_io& fin, const sound::tag_t& tag) {
+				if(gapless_) {  // 前の曲の残りが鳴っている間は、表示しない
+					tag_ = tag;
+					tag_pend_ = true;
+				} else {
+					list_ctrl_.tag(fin, tag);
+				}
+			} );
+			dec.set_rate_defer(gapless_);
+
 			// 情報取得
 			bool ret = false;
-			if(wav_in_.info(fin, info_)) {
-				wav_in_.set_update_task([=](uint32_t t) { list_ctrl_.update(t); });
-				list_ctrl_.start(fname);
+			if(dec.info(fin, info_)) {
+				dec.set_update_task([=, &fin](uint32_t t) {
+					flush_tag_(fin, fname, true);
+					list_ctrl_.update(t); } );
+				if(gapless_) {
+					switch_rate_(dec, dec.get_sample_rate());
+				} else {
+					rate_ = dec.get_sample_rate();
+					list_ctrl_.start(fname);
+				}
 				stop_ = false;
-				ret = wav_in_.decode(fin, sound_out_);
+				ret = dec.decode(fin, sound_out_);
+				flush_tag_(fin, fname, true);
 			}
 			list_ctrl_.close();
 			fin.close();
@@ -224,14 +253,22 @@ namespace sound {
 				const char* ext = strrchr(name, '.');
 				if(ext != nullptr) {
 					bool ret = true;  // 拡張子が無い場合スルー
+					bool play = true;
 					if(utils::str::strcmp_no_caps(ext, ".mp3") == 0) {
-						ret = play_mp3_(name);
+						ret = play_(mp3_in_, CODEC::MP3, name);
 					} else if(utils::str::strcmp_no_caps(ext, ".wav") == 0) {
-						ret = play_wav_(name);
+						ret = play_(wav_in_, CODEC::WAV, name);
+					} else if(utils::str::strcmp_no_caps(ext, ".flac") == 0) {
+						ret = play_(flac_in_, CODEC::FLAC, name);
+					} else {
+						play = false;
 					}
 					if(!ret && !stop_) {
 						utils::format("Can't open audio file: '%s'\n") % name;
 					}
+					if(play) {
+						ahead_ = gapless_ && !stop_;
+					}
 				}
 			}
 		}
@@ -247,8 +284,9 @@ namespace sound {
 		//-----------------------------------------------------------------//
 		codec_mgr(LIST_CTRL& list_ctrl, SOUND_OUT& sound_out) noexcept :
 			list_ctrl_(list_ctrl), sound_out_(sound_out),
-			info_(), wav_in_(), mp3_in_(),
-			dlist_(), loop_t_(), stop_(false), codec_(CODEC::NONE)
+			info_(), wav_in_(), mp3_in_(), flac_in_(),
+			dlist_(), loop_t_(), stop_(false), codec_(CODEC::NONE),
+			gapless_(true), ahead_(false), rate_(0), tag_pend_(false), tag_()
 		{ }
 
 
@@ -271,11 +309,28 @@ namespace sound {
 		//-----------------------------------------------------------------//
 		void service() noexcept
 		{
-			dlist_.service(1, [=](const char* name, const FILINFO* fi, bool dir, void* option) {
-				play_loop_func_(name, fi, dir, option); }, true, &loop_t_);
+			// 曲が終わった場合は、次の曲まで続けて探す（FIFO の残りが鳴っている間に始める）
+			do {
+				dlist_.service(1, [=](const char* name, const FILINFO* fi, bool dir, void* option) {
+					play_loop_func_(name, fi, dir, option); }, true, &loop_t_);
+			} while(ahead_ && dlist_.probe());
+			ahead_ = false;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	曲間を詰めた再生（先読み）の許可 @n
+					次の曲は、前の曲の残り（FIFO）が鳴っている間に開いて、@n
+					タグのパース、デコードを始め、FIFO の後ろに続けて格納する。@n
+					タグの表示は、FIFO が満たされてから行う。@n
+					サンプリング周波数が変わる場合は、前の曲を出し切ってから切り替える。
+			@param[in]	ena	「false」なら、従来の再生
+		*/
+		//-----------------------------------------------------------------//
+		void enable_gapless(bool ena = true) noexcept { gapless_ = ena; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ステートを取得
@@ -289,6 +344,8 @@ namespace sound {
 				return mp3_in_.get_state();
 			case CODEC::WAV:
 				return wav_in_.get_state();
+			case CODEC::FLAC:
+				return flac_in_.get_state();
 			default:
 				return af_play::STATE::IDLE;
 			}
@@ -0,0 +1,786 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	FLAC デコード・クラス（整数演算のみ） @n
+			ストリームから、FLAC のメタデータ（STREAMINFO, VORBIS_COMMENT, PICTURE）@n
+			を読み、フレーム単位でデコードする。@n
+			入力は READ_FUNC で、BUFF_SIZE 単位で読み込むので、ファイル以外も扱える。@n
+			モノラル、ステレオ、4 ～ 24 ビット、ブロック・サイズは BLOCK_MAX まで。@n
+			（FLAC の subset では、48KHz 以下は 4608、それ以上は 16384 だが、@n
+			flac エンコーダーの標準は 4096 なので、96KHz まで BLOCK_MAX で扱える）@n
+			フレーム・ヘッダーは CRC-8 で検査し、フレームの CRC-16 は検査しない。@n
+			メタデータだけを読む場合（ライブラリーの索引など）は、サンプル・バッファを@n
+			持たない flac_meta を使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include "sound/tag.hpp"
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	FLAC メタデータ・クラス（ビット入力と、メタデータの読み込み）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flac_meta {
+	public:
+		static const uint32_t BUFF_SIZE = 1024;		///< 入力バッファのサイズ
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	読み込み関数型 @n
+					dst が nullptr の場合は、len バイトを読み飛ばす
+			@return 読み込んだ（読み飛ばした）バイト数
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		typedef std::function<uint32_t (void* dst, uint32_t len)> READ_FUNC;
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ストリーム情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct info_t {
+			uint32_t	rate;		///< サンプリング周波数
+			uint32_t	samples;	///< 全体のサンプル数（不明なら０）
+			uint16_t	min_block;	///< 最小ブロック・サイズ
+			uint16_t	max_block;	///< 最大ブロック・サイズ
+			uint8_t		channel;	///< チャネル数
+			uint8_t		bits;		///< ビット数
+
+			info_t() noexcept : rate(0), samples(0), min_block(0), max_block(0),
+				channel(0), bits(0) { }
+		};
+
+	protected:
+
+		READ_FUNC	read_func_;
+
+		uint8_t		buff_[BUFF_SIZE];
+		const uint8_t*	ptr_;
+		const uint8_t*	end_;
+		uint32_t	fpos_;		///< buff_ の終端のストリーム位置
+		uint32_t	cache_;		///< ビット・キャッシュ（上位詰め）
+		uint32_t	cbits_;		///< キャッシュの有効ビット数
+		uint32_t	pad_;		///< 終端の後に補った「0」のバイト数
+		bool		eof_;
+
+		info_t		info_;
+
+		uint8_t byte_() noexcept
+		{
+			if(ptr_ >= end_) {
+				uint32_t n = read_func_ ? read_func_(buff_, BUFF_SIZE) : 0;
+				fpos_ += n;
+				ptr_ = buff_;
+				end_ = buff_ + n;
+				if(n == 0) {
+					eof_ = true;
+					++pad_;
+					return 0;
+				}
+			}
+			return *ptr_++;
+		}
+
+
+		// 終端を超えて読んだ（補った「0」を使った）場合「true」
+		bool over_() const noexcept { return (pad_ * 8) > cbits_; }
+
+
+		void refill_() noexcept
+		{
+			while(cbits_ <= 24) {
+				cache_ |= static_cast<uint32_t>(byte_()) << (24 - cbits_);
+				cbits_ += 8;
+			}
+		}
+
+
+		// n: 0 ～ 24
+		uint32_t bits24_(uint32_t n) noexcept
+		{
+			if(n == 0) return 0;
+			if(cbits_ < n) refill_();
+			uint32_t v = cache_ >> (32 - n);
+			cache_ <<= n;
+			cbits_ -= n;
+			return v;
+		}
+
+
+		// n: 0 ～ 32
+		uint32_t bits_(uint32_t n) noexcept
+		{
+			if(n <= 24) return bits24_(n);
+			uint32_t h = bits24_(n - 16);
+			return (h << 16) | bits24_(16);
+		}
+
+
+		int32_t sbits_(uint32_t n) noexcept
+		{
+			if(n == 0) return 0;
+			uint32_t v = bits_(n);
+			return static_cast<int32_t>(v << (32 - n)) >> (32 - n);
+		}
+
+
+		// 「0」の数を数えて、終端の「1」を捨てる
+		uint32_t unary_() noexcept
+		{
+			uint32_t q = 0;
+			while(1) {
+				if(cbits_ == 0) {
+					refill_();
+					if(over_() && cache_ == 0) return q;
+				}
+				if(cache_ == 0) {  // 有効ビットより下位は常に「0」
+					q += cbits_;
+					cbits_ = 0;
+					continue;
+				}
+				uint32_t z = __builtin_clz(cache_);
+				q += z;
+				cache_ <<= z;
+				cache_ <<= 1;
+				cbits_ -= z + 1;
+				return q;
+			}
+		}
+
+
+		void align_() noexcept
+		{
+			bits24_(cbits_ & 7);
+		}
+
+
+		// 読み込み位置（バイト境界の時）
+		uint32_t tell_() const noexcept
+		{
+			return fpos_ - static_cast<uint32_t>(end_ - ptr_) - cbits_ / 8;
+		}
+
+
+		bool skip_(uint32_t len) noexcept
+		{
+			align_();
+			while(len > 0 && cbits_ >= 8) {
+				bits24_(8);
+				--len;
+			}
+			uint32_t n = static_cast<uint32_t>(end_ - ptr_);
+			if(n > len) n = len;
+			ptr_ += n;
+			len -= n;
+			if(len > 0) {
+				uint32_t s = read_func_ ? read_func_(nullptr, len) : 0;
+				fpos_ += s;
+				if(s < len) {
+					eof_ = true;
+					pad_ = 1;  // 終端（over_() を有効にする）
+					cbits_ = 0;
+					cache_ = 0;
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		uint32_t le32_() noexcept
+		{
+			uint32_t v = bits24_(8);
+			v |= bits24_(8) << 8;
+			v |= bits24_(8) << 16;
+			v |= bits24_(8) << 24;
+			return v;
+		}
+
+
+		static char upper_(char ch) noexcept
+		{
+			if(ch >= 'a' && ch <= 'z') ch -= 0x20;
+			return ch;
+		}
+
+
+		template <class STR>
+		void read_str_(STR& str, uint32_t len) noexcept
+		{
+			str.clear();
+			for(uint32_t i = 0; i < len; ++i) {
+				str += static_cast<char>(bits24_(8));
+			}
+		}
+
+
+		// VORBIS_COMMENT（長さはリトル・エンディアン）
+		bool vorbis_comment_(uint32_t len, tag_t& tag) noexcept
+		{
+			uint32_t n = le32_();
+			if((n + 8) > len) return false;
+			skip_(n);
+			len -= n + 4;
+			uint32_t num = le32_();
+			len -= 4;
+			bool artist = false;
+			for(uint32_t i = 0; i < num; ++i) {
+				if(len < 4) return false;
+				n = le32_();
+				len -= 4;
+				if(n > len) return false;
+				len -= n;
+				char key[16];
+				uint32_t k = 0;
+				while(n > 0) {
+					char ch = bits24_(8);
+					--n;
+					if(ch == '=') break;
+					if(k < (sizeof(key) - 1)) key[k++] = upper_(ch);
+				}
+				key[k] = 0;
+				if(std::strcmp(key, "TITLE") == 0) {
+					read_str_(tag.at_title(), n);
+				} else if(std::strcmp(key, "ALBUM") == 0) {
+					read_str_(tag.at_album(), n);
+				} else if(std::strcmp(key, "ARTIST") == 0) {
+					if(!artist) read_str_(tag.at_artist(), n);
+					else read_str_(tag.at_artist2(), n);
+					artist = true;
+				} else if(std::strcmp(key, "ALBUMARTIST") == 0) {
+					read_str_(tag.at_artist2(), n);
+				} else if(std::strcmp(key, "DATE") == 0) {
+					read_str_(tag.at_year(), n);
+				} else if(std::strcmp(key, "TRACKNUMBER") == 0) {
+					read_str_(tag.at_track(), n);
+				} else if(std::strcmp(key, "DISCNUMBER") == 0) {
+					read_str_(tag.at_disc(), n);
+				} else {
+					skip_(n);
+				}
+			}
+			return skip_(len);
+		}
+
+
+		// PICTURE（画像はファイル位置と長さだけ）
+		bool picture_(uint32_t len, tag_t& tag) noexcept
+		{
+			auto& apic = tag.at_apic();
+			if(len < 32) return false;
+			apic.typ_ = bits_(32);
+			uint32_t n = bits_(32);
+			len -= 8;
+			if((n + 24) > len) return false;
+			char mime[16];
+			uint32_t k = 0;
+			for(uint32_t i = 0; i < n; ++i) {
+				char ch = bits24_(8);
+				if(k < (sizeof(mime) - 1)) mime[k++] = ch;
+			}
+			mime[k] = 0;
+			len -= n;
+			apic.ext_[0] = 0;
+			if(std::strcmp(mime, "image/jpeg") == 0) {
+				std::strcpy(apic.ext_, "jpg");
+			} else if(std::strcmp(mime, "image/png") == 0) {
+				std::strcpy(apic.ext_, "png");
+			} else if(std::strcmp(mime, "image/bmp") == 0) {
+				std::strcpy(apic.ext_, "bmp");
+			}
+			n = bits_(32);  // 説明
+			len -= 4;
+			if((n + 20) > len) return false;
+			skip_(n);
+			len -= n;
+			skip_(16);  // 幅、高さ、深さ、色数
+			len -= 16;
+			n = bits_(32);
+			len -= 4;
+			if(n > len) return false;
+			apic.ofs_ = tell_();
+			apic.len_ = n;
+			return skip_(len);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		flac_meta() noexcept : read_func_(), ptr_(buff_), end_(buff_), fpos_(0),
+			cache_(0), cbits_(0), pad_(0), eof_(false), info_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（入力を設定して、バッファをリセット）
+			@param[in]	func	読み込み関数
+			@param[in]	pos		ストリームの現在位置
+		*/
+		//-----------------------------------------------------------------//
+		void start(READ_FUNC func, uint32_t pos = 0) noexcept
+		{
+			read_func_ = func;
+			ptr_ = end_ = buff_;
+			fpos_ = pos;
+			cache_ = 0;
+			cbits_ = 0;
+			pad_ = 0;
+			eof_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	メタデータを読む（「fLaC」から、最初のフレームの手前まで）
+			@param[out]	tag		タグ
+			@return STREAMINFO が有れば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read_meta(tag_t& tag) noexcept
+		{
+			tag.clear();
+			if(bits_(32) != 0x664c6143) return false;  // "fLaC"
+
+			bool stream_info = false;
+			bool last = false;
+			while(!last) {
+				last = bits24_(1) != 0;
+				uint32_t type = bits24_(7);
+				uint32_t len = bits24_(24);
+				if(over_()) return false;
+				if(type == 0) {  // STREAMINFO
+					if(len < 34) return false;
+					info_.min_block = bits24_(16);
+					info_.max_block = bits24_(16);
+					bits24_(24);  // min frame size
+					bits24_(24);  // max frame size
+					info_.rate = bits24_(20);
+					info_.channel = bits24_(3) + 1;
+					info_.bits = bits24_(5) + 1;
+					uint32_t h = bits24_(4);
+					uint32_t l = bits_(32);
+					info_.samples = h != 0 ? 0xffffffff : l;
+					skip_(len - 18);  // MD5 など
+					stream_info = true;
+				} else if(type == 4) {
+					if(!vorbis_comment_(len, tag)) return false;
+				} else if(type == 6) {
+					if(!picture_(len, tag)) return false;
+				} else {
+					if(!skip_(len)) return false;
+				}
+			}
+			if(!stream_info) return false;
+			if(info_.rate == 0) return false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム情報を取得
+			@return ストリーム情報
+		*/
+		//-----------------------------------------------------------------//
+		const info_t& get_info() const noexcept { return info_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリームの読み込み位置（メタデータの後は、最初のフレームの位置）
+			@return 位置
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t tell() const noexcept { return tell_(); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	FLAC デコード・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flac_dec : public flac_meta {
+	public:
+		static const uint32_t BLOCK_MAX   = 4608;	///< ブロック・サイズの最大
+		static const uint32_t CHANNEL_MAX = 2;		///< チャネル数の最大
+
+	private:
+
+		uint32_t	block_;
+		uint32_t	frame_rate_;
+		uint8_t		frame_channel_;
+		uint8_t		frame_bits_;
+
+		int32_t		sample_[CHANNEL_MAX][BLOCK_MAX];
+
+		static uint8_t crc8_(const uint8_t* src, uint32_t len) noexcept
+		{
+			uint8_t crc = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				crc ^= src[i];
+				for(uint32_t j = 0; j < 8; ++j) {
+					crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+				}
+			}
+			return crc;
+		}
+
+
+		// フレーム・ヘッダー（同期コードを探す）
+		bool frame_header_(uint8_t& assign) noexcept
+		{
+			static const uint32_t rate_tbl[12] = {
+				0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000
+			};
+			static const uint8_t bits_tbl[8] = { 0, 8, 12, 0, 16, 20, 24, 0 };
+
+			align_();
+			uint8_t hd[16];
+			{
+				uint8_t prev = 0;
+				while(1) {
+					uint8_t b = bits24_(8);
+					if(over_()) return false;
+					if(prev == 0xff && (b & 0xfe) == 0xf8) {
+						hd[0] = prev;
+						hd[1] = b;
+						break;
+					}
+					prev = b;
+				}
+			}
+			uint32_t n = 2;
+			hd[n++] = bits24_(8);
+			hd[n++] = bits24_(8);
+			// UTF-8 形式のフレーム（サンプル）番号
+			{
+				uint8_t c = bits24_(8);
+				hd[n++] = c;
+				uint32_t ext = 0;
+				if((c & 0x80) == 0) ext = 0;
+				else if((c & 0xe0) == 0xc0) ext = 1;
+				else if((c & 0xf0) == 0xe0) ext = 2;
+				else if((c & 0xf8) == 0xf0) ext = 3;
+				else if((c & 0xfc) == 0xf8) ext = 4;
+				else if((c & 0xfe) == 0xfc) ext = 5;
+				else if(c == 0xfe) ext = 6;
+				else return false;
+				for(uint32_t i = 0; i < ext; ++i) {
+					c = bits24_(8);
+					if((c & 0xc0) != 0x80) return false;
+					hd[n++] = c;
+				}
+			}
+			uint32_t bs = hd[2] >> 4;
+			uint32_t sr = hd[2] & 15;
+			uint32_t ch = hd[3] >> 4;
+			uint32_t ss = (hd[3] >> 1) & 7;
+			if(hd[3] & 1) return false;
+
+			if(bs == 0) return false;
+			else if(bs == 1) block_ = 192;
+			else if(bs <= 5) block_ = 576 << (bs - 2);
+			else if(bs == 6) { hd[n] = bits24_(8); block_ = hd[n++] + 1; }
+			else if(bs == 7) {
+				hd[n] = bits24_(8);
+				hd[n + 1] = bits24_(8);
+				block_ = ((hd[n] << 8) | hd[n + 1]) + 1;
+				n += 2;
+			} else block_ = 256 << (bs - 8);
+
+			if(sr == 0) frame_rate_ = info_.rate;
+			else if(sr < 12) frame_rate_ = rate_tbl[sr];
+			else if(sr == 12) { hd[n] = bits24_(8); frame_rate_ = hd[n++] * 1000; }
+			else if(sr <= 14) {
+				hd[n] = bits24_(8);
+				hd[n + 1] = bits24_(8);
+				frame_rate_ = (hd[n] << 8) | hd[n + 1];
+				if(sr == 14) frame_rate_ *= 10;
+				n += 2;
+			} else return false;
+
+			if(ch < 8) frame_channel_ = ch + 1;
+			else if(ch <= 10) frame_channel_ = 2;
+			else return false;
+			assign = ch;
+
+			frame_bits_ = ss == 0 ? info_.bits : bits_tbl[ss];
+			if(frame_bits_ < 4 || frame_bits_ > 24) return false;
+
+			uint8_t crc = bits24_(8);
+			if(crc != crc8_(hd, n)) return false;
+
+			if(block_ > BLOCK_MAX || frame_channel_ > CHANNEL_MAX) return false;
+			return true;
+		}
+
+
+		// Rice 符号（hot loop）
+		void rice_(int32_t* dst, uint32_t num, uint32_t k) noexcept
+		{
+			for(uint32_t i = 0; i < num; ++i) {
+				uint32_t q;
+				if(cache_ != 0) {  // 商が短い場合は、キャッシュ内で完結
+					uint32_t z = __builtin_clz(cache_);
+					q = z;
+					cache_ <<= z;
+					cache_ <<= 1;
+					cbits_ -= z + 1;
+				} else {
+					q = unary_();
+				}
+				uint32_t v = (q << k) | bits_(k);
+				dst[i] = static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+			}
+		}
+
+
+		bool residual_(int32_t* dst, uint32_t num, uint32_t order) noexcept
+		{
+			uint32_t method = bits24_(2);
+			if(method > 1) return false;
+			const uint32_t pbits = method ? 5 : 4;
+			const uint32_t esc = method ? 31 : 15;
+			uint32_t porder = bits24_(4);
+			uint32_t psize = num >> porder;
+			if((psize << porder) != num || psize < order) return false;
+
+			uint32_t i = order;
+			for(uint32_t p = 0; p < (1u << porder); ++p) {
+				uint32_t cnt = p == 0 ? psize - order : psize;
+				uint32_t k = bits24_(pbits);
+				if(k == esc) {
+					uint32_t rb = bits24_(5);
+					for(uint32_t j = 0; j < cnt; ++j) {
+						dst[i + j] = sbits_(rb);
+					}
+				} else {
+					rice_(&dst[i], cnt, k);
+				}
+				i += cnt;
+			}
+			return !over_();
+		}
+
+
+		static void fixed_(int32_t* s, uint32_t num, uint32_t order) noexcept
+		{
+			switch(order) {
+			case 1:
+				for(uint32_t i = 1; i < num; ++i) s[i] += s[i - 1];
+				break;
+			case 2:
+				for(uint32_t i = 2; i < num; ++i) s[i] += 2 * s[i - 1] - s[i - 2];
+				break;
+			case 3:
+				for(uint32_t i = 3; i < num; ++i) s[i] += 3 * (s[i - 1] - s[i - 2]) + s[i - 3];
+				break;
+			case 4:
+				for(uint32_t i = 4; i < num; ++i) {
+					s[i] += 4 * (s[i - 1] + s[i - 3]) - 6 * s[i - 2] - s[i - 4];
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+
+		// 積和が 32 ビットに収まる場合（16 ビット以下の殆ど）
+		static void lpc32_(int32_t* s, uint32_t num, const int32_t* coef, uint32_t order, int32_t shift) noexcept
+		{
+			for(uint32_t i = order; i < num; ++i) {
+				int32_t sum = 0;
+				const int32_t* h = &s[i];
+				for(uint32_t j = 0; j < order; ++j) {
+					sum += coef[j] * h[-1 - static_cast<int32_t>(j)];
+				}
+				s[i] += sum >> shift;
+			}
+		}
+
+
+		static void lpc64_(int32_t* s, uint32_t num, const int32_t* coef, uint32_t order, int32_t shift) noexcept
+		{
+			for(uint32_t i = order; i < num; ++i) {
+				int64_t sum = 0;
+				const int32_t* h = &s[i];
+				for(uint32_t j = 0; j < order; ++j) {
+					sum += static_cast<int64_t>(coef[j]) * h[-1 - static_cast<int32_t>(j)];
+				}
+				s[i] += static_cast<int32_t>(sum >> shift);
+			}
+		}
+
+
+		bool subframe_(int32_t* dst, uint32_t bps) noexcept
+		{
+			if(bits24_(1) != 0) return false;
+			uint32_t type = bits24_(6);
+			uint32_t wasted = 0;
+			if(bits24_(1) != 0) {
+				wasted = unary_() + 1;
+				if(wasted >= bps) return false;
+				bps -= wasted;
+			}
+			const uint32_t num = block_;
+			if(type == 0) {  // CONSTANT
+				int32_t v = sbits_(bps);
+				for(uint32_t i = 0; i < num; ++i) dst[i] = v;
+			} else if(type == 1) {  // VERBATIM
+				for(uint32_t i = 0; i < num; ++i) dst[i] = sbits_(bps);
+			} else if(type >= 8 && type <= 12) {  // FIXED
+				uint32_t order = type - 8;
+				if(order > num) return false;
+				for(uint32_t i = 0; i < order; ++i) dst[i] = sbits_(bps);
+				if(!residual_(dst, num, order)) return false;
+				fixed_(dst, num, order);
+			} else if(type >= 32) {  // LPC
+				uint32_t order = (type & 31) + 1;
+				if(order > num) return false;
+				for(uint32_t i = 0; i < order; ++i) dst[i] = sbits_(bps);
+				uint32_t prec = bits24_(4) + 1;
+				if(prec == 16) return false;
+				int32_t shift = sbits_(5);
+				if(shift < 0) return false;
+				int32_t coef[32];
+				for(uint32_t i = 0; i < order; ++i) coef[i] = sbits_(prec);
+				if(!residual_(dst, num, order)) return false;
+				uint32_t lg = 31 - __builtin_clz(order);
+				if((bps + prec + lg) <= 32) {
+					lpc32_(dst, num, coef, order, shift);
+				} else {
+					lpc64_(dst, num, coef, order, shift);
+				}
+			} else {
+				return false;
+			}
+			if(wasted > 0) {
+				for(uint32_t i = 0; i < num; ++i) dst[i] <<= wasted;
+			}
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		flac_dec() noexcept : flac_meta(),
+			block_(0), frame_rate_(0), frame_channel_(0), frame_bits_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	メタデータを読む（「fLaC」から、最初のフレームの手前まで）
+			@param[out]	tag		タグ
+			@return 対応する形式なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read_meta(tag_t& tag) noexcept
+		{
+			if(!flac_meta::read_meta(tag)) return false;
+			if(info_.channel > CHANNEL_MAX || info_.bits < 4 || info_.bits > 24) return false;
+			if(info_.max_block > BLOCK_MAX) return false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１フレームのデコード @n
+					エラーの場合、次の呼び出しで、次の同期コードから再開する
+			@return デコードしたサンプル数（終端なら０、エラーなら -1）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t decode_frame() noexcept
+		{
+			uint8_t assign;
+			if(!frame_header_(assign)) {
+				return over_() ? 0 : -1;
+			}
+			for(uint32_t ch = 0; ch < frame_channel_; ++ch) {
+				uint32_t bps = frame_bits_;
+				// サイド・チャネルは１ビット多い
+				if((assign == 8 && ch == 1) || (assign == 9 && ch == 0) || (assign == 10 && ch == 1)) {
+					++bps;
+				}
+				if(!subframe_(sample_[ch], bps)) {
+					return over_() ? 0 : -1;
+				}
+			}
+			align_();
+			bits24_(16);  // CRC-16
+
+			int32_t* l = sample_[0];
+			int32_t* r = sample_[1];
+			const uint32_t num = block_;
+			if(assign == 8) {  // left/side
+				for(uint32_t i = 0; i < num; ++i) r[i] = l[i] - r[i];
+			} else if(assign == 9) {  // side/right
+				for(uint32_t i = 0; i < num; ++i) l[i] += r[i];
+			} else if(assign == 10) {  // mid/side
+				for(uint32_t i = 0; i < num; ++i) {
+					int32_t side = r[i];
+					int32_t mid = static_cast<int32_t>((static_cast<uint32_t>(l[i]) << 1) | (side & 1));
+					l[i] = (mid + side) >> 1;
+					r[i] = (mid - side) >> 1;
+				}
+			}
+			return num;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デコードしたサンプルを取得
+			@param[in]	ch	チャネル
+			@return サンプル（get_frame_bits() ビット、符号付き）
+		*/
+		//-----------------------------------------------------------------//
+		const int32_t* get_sample(uint32_t ch) const noexcept { return sample_[ch]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フレームのチャネル数を取得
+			@return チャネル数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_frame_channel() const noexcept { return frame_channel_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フレームのビット数を取得
+			@return ビット数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_frame_bits() const noexcept { return frame_bits_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フレームのサンプリング周波数を取得
+			@return サンプリング周波数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_frame_rate() const noexcept { return frame_rate_; }
+	};
+}
@@ -0,0 +1,245 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	FLAC 音声ファイルを扱うクラス @n
+			デコードは flac_dec（整数演算のみ）で行い、16 ビット、ステレオに変換する。@n
+			48KHz を超えるファイルは、隣接サンプルの平均で 1/2、1/4 に間引く。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "common/file_io.hpp"
+#include "sound/tag.hpp"
+#include "sound/af_play.hpp"
+#include "sound/sound_out.hpp"
+#include "sound/audio_info.hpp"
+#include "sound/flac_dec.hpp"
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	FLAC 形式デコード・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flac_in : public af_play {
+
+		static const uint32_t CHUNK_FRAMES = 256;	///< 変換、転送の単位
+		static const uint32_t RATE_MAX = 48'000;	///< これを超える場合は間引く
+
+		flac_dec	dec_;
+
+		uint32_t	data_top_;
+		uint32_t	time_;
+		uint32_t	decim_;		///< 間引きのシフト数（0, 1, 2）
+
+		void start_(utils::file_io& fin, uint32_t pos) noexcept
+		{
+			dec_.start([&fin](void* dst, uint32_t len) {
+				if(dst == nullptr) {  // 読み飛ばし
+					uint32_t rem = fin.get_file_size() - fin.tell();
+					if(len > rem) len = rem;
+					fin.seek(utils::file_io::SEEK::CUR, len);
+					return len;
+				}
+				return fin.read(dst, len);
+			}, pos);
+		}
+
+
+		// デコードしたフレームを、間引いて、16 ビットに変換して FIFO へ
+		template <class SOUND_OUT>
+		void output_(SOUND_OUT& out, uint32_t num) noexcept
+		{
+			const int32_t* l = dec_.get_sample(0);
+			const int32_t* r = dec_.get_sample(dec_.get_frame_channel() > 1 ? 1 : 0);
+			const uint32_t bits = dec_.get_frame_bits();
+			// 間引きの平均と、16 ビットへの変換を、一度のシフトで行う
+			int32_t lsh = 0;
+			int32_t rsh = decim_;
+			if(bits > 16) rsh += bits - 16;
+			else lsh = 16 - bits;
+			const int32_t round = rsh > 0 ? (1 << (rsh - 1)) : 0;
+			const uint32_t step = 1 << decim_;
+
+			num >>= decim_;
+			while(num > 0) {
+				uint32_t n = num < CHUNK_FRAMES ? num : CHUNK_FRAMES;
+				typename SOUND_OUT::WAVE wav[CHUNK_FRAMES];
+				for(uint32_t i = 0; i < n; ++i) {
+					int32_t sl = 0;
+					int32_t sr = 0;
+					for(uint32_t j = 0; j < step; ++j) {
+						sl += l[j];
+						sr += r[j];
+					}
+					l += step;
+					r += step;
+					sl = ((sl << lsh) + round) >> rsh;
+					sr = ((sr << lsh) + round) >> rsh;
+					if(sl > 32767) sl = 32767; else if(sl < -32768) sl = -32768;
+					if(sr > 32767) sr = 32767; else if(sr < -32768) sr = -32768;
+					wav[i].l_ch = sl;
+					wav[i].r_ch = sr;
+				}
+				// 流量制御は、チャンク毎に一度
+				while((out.at_fifo().size() - out.at_fifo().length()) < (n + 64)) {
+					system_delay(1);
+				}
+				out.at_fifo().put(wav, n);
+				num -= n;
+			}
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-------------------------------------------------------------//
+		flac_in() noexcept : dec_(), data_top_(0), time_(0), decim_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	情報を取得
+			@param[in]	fin		file_io コンテキスト（参照）
+			@param[out]	info	情報
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool info(utils::file_io& fin, audio_info& info) noexcept
+		{
+			set_state(STATE::TAG);
+			tag_t tag;
+			start_(fin, fin.tell());
+			if(!dec_.read_meta(tag)) {
+				set_state(STATE::IDLE);
+				return false;
+			}
+			data_top_ = dec_.tell();
+
+			if(tag_task_) {
+				tag_task_(fin, tag);
+			}
+
+			const auto& fi = dec_.get_info();
+			decim_ = 0;
+			while((fi.rate >> decim_) > RATE_MAX && decim_ < 2) {
+				++decim_;
+			}
+
+			info.type = audio_format::NONE;
+			if(fi.bits <= 8) {
+				info.type = fi.channel == 1 ? audio_format::PCM8_MONO : audio_format::PCM8_STEREO;
+			} else if(fi.bits <= 16) {
+				info.type = fi.channel == 1 ? audio_format::PCM16_MONO : audio_format::PCM16_STEREO;
+			} else {
+				info.type = fi.channel == 1 ? audio_format::PCM24_MONO : audio_format::PCM24_STEREO;
+			}
+			info.samples = fi.samples;
+			info.chanels = fi.channel;
+			info.bits = fi.bits;
+			info.frequency = fi.rate;
+			info.block_align = 0;
+			info.header_size = data_top_;
+			info.total_second = fi.samples / fi.rate;
+
+			set_state(STATE::IDLE);
+
+			set_sample_rate_(fi.rate >> decim_);
+
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デコード @n
+					デコードの準備として、info で情報を取得する必要がある。
+			@param[in]	fin		file_io コンテキスト（参照）
+			@param[in]	out		オーディオ出力（参照）
+			@return 正常終了なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		template <class SOUND_OUT>
+		bool decode(utils::file_io& fin, SOUND_OUT& out) noexcept
+		{
+			fin.seek(utils::file_io::SEEK::SET, data_top_);
+			start_(fin, data_top_);
+
+			const uint32_t rate = dec_.get_info().rate;
+			bool status = true;
+			bool pause = false;
+			uint32_t pos = 0;
+			time_ = 0;
+			set_state(STATE::PLAY);
+			while(1) {
+				CTRL ctrl = CTRL::NONE;
+				if(ctrl_task_) {
+					ctrl = ctrl_task_();
+				}
+				if(ctrl == CTRL::NEXT) {
+					out.mute();
+					status = true;
+					break;
+				} else if(ctrl == CTRL::STOP) {
+					out.mute();
+					status = false;
+					break;
+				} else if(ctrl == CTRL::REPLAY) {
+					out.mute();
+					fin.seek(utils::file_io::SEEK::SET, data_top_);
+					start_(fin, data_top_);
+					pos = 0;
+					time_ = 0;
+					status = true;
+					pause = false;
+					continue;
+				} else if(ctrl == CTRL::PAUSE) {
+					out.mute();
+					pause = !pause;
+				}
+				if(pause) {
+					set_state(STATE::PAUSE);
+					system_delay(2);
+					continue;
+				} else {
+					set_state(STATE::PLAY);
+				}
+
+				auto n = dec_.decode_frame();
+				if(n == 0) {
+					break;
+				} else if(n < 0) {  // 次の同期コードから再開
+					continue;
+				}
+				output_(out, n);
+				pos += n;
+
+				{
+					uint32_t s = pos / rate;
+					if(s != time_) {
+						if(update_task_) {
+							update_task_(s);
+						}
+						time_ = s;
+					}
+				}
+			}
+			set_state(STATE::IDLE);
+			return status;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デコーダーの参照
+			@return デコーダー
+		*/
+		//-----------------------------------------------------------------//
+		const flac_dec& get_dec() const noexcept { return dec_; }
+	};
+}
@@ -132,7 +132,7 @@ namespace sound {
 					return false;
 				}
 				len--;
-				utils::format("V2.3: '%s'\n") % tmp;
+//				utils::format("V2.3: '%s'\n") % tmp;
 			} else {
 				if(fin.read(tag_.at_apic().ext_, 3) != 3) {
 					return false;
@@ -142,7 +142,7 @@ namespace sound {
 					return false;
 				}
 				len--;
-				utils::format("V2.2: '%s'\n") % tag_.get_apic().ext_;
+//				utils::format("V2.2: '%s'\n") % tag_.get_apic().ext_;
 			}
 			auto ret = skip_text_(code, fin, len);
 			if(!ret) {
@@ -390,8 +390,8 @@ namespace sound {
 
 ///			utils::format("FS: %d\n") % fin.get_file_size();
 
-			utils::format("ID3v2: Ver: %04X, Flag: %02X (%d)\n")
-				% ver_ % static_cast<uint16_t>(flag_) % size_;
+//			utils::format("ID3v2: Ver: %04X, Flag: %02X (%d)\n")
+//				% ver_ % static_cast<uint16_t>(flag_) % size_;
 
 			if(flag_ & 0b01000000) {  // EXT header
 				if(fin.read(tmp, 4) != 4) {
@@ -16,10 +16,6 @@
 #include "sound/sound_out.hpp"
 #include "sound/audio_info.hpp"
 
-extern "C" {
-	void set_sample_rate(uint32_t freq);
-};
-
 namespace sound {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -144,6 +140,27 @@ namespace sound {
 		}
 
 
+		// Xing/Info ヘッダーのフレーム数（無ければ０）
+		static uint32_t xing_frames_(const unsigned char* p, const unsigned char* end, const mad_header& h) noexcept
+		{
+			// サイド情報の大きさ
+			uint32_t ofs;
+			if(h.flags & MAD_FLAG_LSF_EXT) {
+				ofs = h.mode == MAD_MODE_SINGLE_CHANNEL ? 9 : 17;
+			} else {
+				ofs = h.mode == MAD_MODE_SINGLE_CHANNEL ? 17 : 32;
+			}
+			if(h.flags & MAD_FLAG_PROTECTION) ofs += 2;
+			if(p == nullptr) return 0;
+			p += 4 + ofs;
+			if((p + 12) > end) return 0;
+			if(memcmp(p, "Xing", 4) != 0 && memcmp(p, "Info", 4) != 0) return 0;
+			uint32_t flags = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+			if((flags & 1) == 0) return 0;
+			return (p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11];
+		}
+
+
 		static const short SHRT_MAX_ = 32767;
 
 		/****************************************************************************
@@ -196,7 +213,7 @@ namespace sound {
 		/*!
 			@brief	情報を取得 @n
 					可変ビットレートの場合は、情報は正確では無い。@n
-					※全体時間は正確
+					※全体時間は、Xing/Info ヘッダーのフレーム数（無ければ全フレームを数える）
 			@param[in]	fin		file_io コンテキスト（参照）
 			@param[out]	info	情報
 			@return 正常なら「true」
@@ -241,6 +258,15 @@ namespace sound {
 						}
 					}
 				}
+				// 先頭フレームに Xing/Info ヘッダーがあれば、フレーム数を使い、全体の走査を省く
+				if(frames == 0) {
+					auto n = xing_frames_(mad_stream_.this_frame, mad_stream_.bufend, mad_frame_.header);
+					if(n > 0) {
+						frames = n;
+						freq = mad_frame_.header.samplerate;
+						break;
+					}
+				}
 				++frames;
 				if(freq < mad_frame_.header.samplerate) {
 					freq = mad_frame_.header.samplerate;
@@ -248,7 +274,7 @@ namespace sound {
 			}
 			fin.seek(utils::file_io::SEEK::SET, forg);
 
-			info.samples = frames * 1152;
+			info.samples = frames * 32 * MAD_NSBSAMPLES(&mad_frame_.header);
 			if(mad_frame_.header.mode != MAD_MODE_SINGLE_CHANNEL) {
 				info.type = audio_format::PCM16_STEREO;
 				info.chanels = 2;
@@ -266,7 +292,7 @@ namespace sound {
 			set_state(STATE::IDLE);
 
 			if(info.frequency > 0) {
-				set_sample_rate(info.frequency);
+				set_sample_rate_(info.frequency);
 			}
 
 			return true;
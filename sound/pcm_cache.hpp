@@ -0,0 +1,163 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	PCM キャッシュ・クラス @n
+			効果音など、短い音を、変換済みの波形（sound_out の WAVE 形式）で保持する。@n
+			領域は固定で、登録は追加のみ（clear() で全て破棄）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "sound/sound_out.hpp"
+#include "sound/pcm_conv.hpp"
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	PCM キャッシュ・クラス
+		@param[in]	T		波形単位型
+		@param[in]	SIZE	波形領域のサイズ（フレーム数）
+		@param[in]	NUM		登録数の最大
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T, uint32_t SIZE, uint32_t NUM>
+	class pcm_cache {
+	public:
+		typedef wave_t<T> WAVE;
+
+	private:
+
+		struct entry_t {
+			uint32_t	org_;
+			uint32_t	len_;
+			uint32_t	rate_;
+		};
+
+		WAVE		wave_[SIZE];
+		entry_t		entry_[NUM];
+		uint32_t	num_;
+		uint32_t	pos_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		pcm_cache() noexcept : num_(0), pos_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全て破棄（再生中のボイスが無い事）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			num_ = 0;
+			pos_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	登録数を返す
+			@return 登録数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	波形領域の空きを返す
+			@return 空き（フレーム数）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_free() const noexcept { return SIZE - pos_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変換済みの波形を登録
+			@param[in]	src		波形
+			@param[in]	len		フレーム数
+			@param[in]	rate	サンプリング・レート
+			@return 登録番号（失敗なら -1）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t add(const WAVE* src, uint32_t len, uint32_t rate) noexcept
+		{
+			if(num_ >= NUM || len == 0 || len > get_free() || rate == 0) return -1;
+
+			for(uint32_t i = 0; i < len; ++i) {
+				wave_[pos_ + i] = src[i];
+			}
+			entry_[num_].org_  = pos_;
+			entry_[num_].len_  = len;
+			entry_[num_].rate_ = rate;
+			pos_ += len;
+			return num_++;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	PCM データを変換して登録
+			@param[in]	conv	PCM 変換
+			@param[in]	fmt		PCM 形式
+			@param[in]	src		PCM データ
+			@param[in]	ch		チャネル数
+			@param[in]	frames	フレーム数
+			@param[in]	rate	サンプリング・レート
+			@return 登録番号（失敗なら -1）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t add(pcm_conv& conv, pcm_conv::FORMAT fmt, const void* src, uint32_t ch,
+			uint32_t frames, uint32_t rate) noexcept
+		{
+			if(num_ >= NUM || frames == 0 || frames > get_free() || rate == 0) return -1;
+
+			if(!conv.convert(fmt, src, ch, frames, &wave_[pos_])) return -1;
+
+			entry_[num_].org_  = pos_;
+			entry_[num_].len_  = frames;
+			entry_[num_].rate_ = rate;
+			pos_ += frames;
+			return num_++;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	波形を取得
+			@param[in]	no	登録番号
+			@return 波形
+		*/
+		//-----------------------------------------------------------------//
+		const WAVE* get_wave(uint32_t no) const noexcept { return &wave_[entry_[no].org_]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	長さを取得
+			@param[in]	no	登録番号
+			@return 長さ（フレーム数）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_length(uint32_t no) const noexcept { return entry_[no].len_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サンプリング・レートを取得
+			@param[in]	no	登録番号
+			@return サンプリング・レート
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_rate(uint32_t no) const noexcept { return entry_[no].rate_; }
+	};
+}
@@ -0,0 +1,239 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	PCM 変換クラス @n
+			WAV 等の PCM データ（u8, s16, s24, s32, float32）を、ブロック単位で、@n
+			sound_out の波形（16 ビット、ステレオ）に変換する。@n
+			モノラルは左右に複製し、３チャネル以上は、先頭の２チャネルを使う。@n
+			24 ビット以上は、丸め、又は TPDF ディザーで 16 ビットにする。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	PCM 変換クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class pcm_conv {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	PCM 形式
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class FORMAT : uint8_t {
+			NONE,	///< 未対応
+			U8,		///< 符号無し 8 ビット
+			S16,	///< 符号付き 16 ビット
+			S24,	///< 符号付き 24 ビット（３バイト詰め）
+			S32,	///< 符号付き 32 ビット
+			F32,	///< 浮動小数点 32 ビット（-1.0 ～ +1.0）
+		};
+
+	private:
+
+		uint32_t	seed_;
+		bool		dither_;
+
+		// xorshift32
+		uint32_t rand_() noexcept
+		{
+			auto x = seed_;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			seed_ = x;
+			return x;
+		}
+
+		// 24 ビットを 16 ビットに（丸め、又は TPDF ディザー）
+		int16_t s24_(int32_t v) noexcept
+		{
+			if(dither_) {
+				auto r = rand_();
+				v += static_cast<int32_t>((r & 0xff) + ((r >> 16) & 0xff)) - 0xff;
+			}
+			v = (v + 0x80) >> 8;
+			if(v > 32767) v = 32767;
+			else if(v < -32768) v = -32768;
+			return v;
+		}
+
+		int16_t f32_(float f) noexcept
+		{
+			f *= 32768.0f;
+			if(dither_) {
+				auto r = rand_();
+				f += static_cast<float>(static_cast<int32_t>((r & 0xffff) + (r >> 16)) - 0xffff)
+					* (1.0f / 65536.0f);
+			}
+			if(f > 32767.0f) f = 32767.0f;
+			else if(f < -32768.0f) f = -32768.0f;
+			// 「f + 0.5」は、仮数の下位が失われるので、小数部で丸める（小数部の計算は誤差が無い）
+			int32_t i = static_cast<int32_t>(f);
+			float r = f - static_cast<float>(i);
+			i += static_cast<int32_t>(r >= 0.5f) - static_cast<int32_t>(r < -0.5f);
+			return i;
+		}
+
+		static int32_t load24_(const uint8_t* p) noexcept
+		{
+			return static_cast<int32_t>(p[0] | (p[1] << 8) | (static_cast<int8_t>(p[2]) << 16));
+		}
+
+		static int32_t load32_(const uint8_t* p) noexcept
+		{
+			return static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16)
+				| (static_cast<uint32_t>(p[3]) << 24));
+		}
+
+		static float loadf_(const uint8_t* p) noexcept
+		{
+			union {
+				uint32_t	u;
+				float		f;
+			} t;
+			t.u = static_cast<uint32_t>(load32_(p));
+			return t.f;
+		}
+
+		static int16_t u8_(uint8_t v) noexcept
+		{
+			return static_cast<int16_t>((static_cast<uint16_t>(v ^ 0x80) << 8) | ((v & 0x7f) << 1));
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-------------------------------------------------------------//
+		pcm_conv() noexcept : seed_(2463534242), dither_(false) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ディザーの設定（24 ビット以上の入力に有効）
+			@param[in]	ena	無効にする場合「false」
+		*/
+		//-------------------------------------------------------------//
+		void enable_dither(bool ena = true) noexcept { dither_ = ena; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ビット数、形式タグから PCM 形式を得る
+			@param[in]	bits	サンプルのビット数
+			@param[in]	fp		浮動小数点形式の場合「true」
+			@return PCM 形式
+		*/
+		//-------------------------------------------------------------//
+		static FORMAT get_format(uint32_t bits, bool fp) noexcept
+		{
+			if(fp) {
+				return bits == 32 ? FORMAT::F32 : FORMAT::NONE;
+			}
+			switch(bits) {
+			case 8:  return FORMAT::U8;
+			case 16: return FORMAT::S16;
+			case 24: return FORMAT::S24;
+			case 32: return FORMAT::S32;
+			default:
+				break;
+			}
+			return FORMAT::NONE;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	１サンプルのバイト数
+			@param[in]	fmt		PCM 形式
+			@return バイト数
+		*/
+		//-------------------------------------------------------------//
+		static uint32_t get_bytes(FORMAT fmt) noexcept
+		{
+			switch(fmt) {
+			case FORMAT::U8:  return 1;
+			case FORMAT::S16: return 2;
+			case FORMAT::S24: return 3;
+			case FORMAT::S32:
+			case FORMAT::F32: return 4;
+			default:
+				break;
+			}
+			return 0;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ブロック変換
+			@param[in]	fmt		PCM 形式
+			@param[in]	src		PCM データ（リトル・エンディアン）
+			@param[in]	ch		チャネル数
+			@param[in]	frames	フレーム数
+			@param[out]	dst		波形（frames 個）
+			@return 未対応の形式なら「false」
+		*/
+		//-------------------------------------------------------------//
+		template <class WAVE>
+		bool convert(FORMAT fmt, const void* src, uint32_t ch, uint32_t frames, WAVE* dst) noexcept
+		{
+			if(ch == 0) return false;
+
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			const uint32_t ofs = ch > 1 ? get_bytes(fmt) : 0;  // 右チャネルの位置
+			const uint32_t step = get_bytes(fmt) * ch;
+			switch(fmt) {
+			case FORMAT::U8:
+				for(uint32_t i = 0; i < frames; ++i) {
+					dst[i].l_ch = u8_(p[0]);
+					dst[i].r_ch = u8_(p[ofs]);
+					p += step;
+				}
+				break;
+			case FORMAT::S16:
+				for(uint32_t i = 0; i < frames; ++i) {
+					dst[i].l_ch = static_cast<int16_t>(p[0] | (p[1] << 8));
+					dst[i].r_ch = static_cast<int16_t>(p[ofs] | (p[ofs + 1] << 8));
+					p += step;
+				}
+				break;
+			case FORMAT::S24:
+				for(uint32_t i = 0; i < frames; ++i) {
+					dst[i].l_ch = s24_(load24_(p));
+					dst[i].r_ch = ch > 1 ? s24_(load24_(p + ofs)) : dst[i].l_ch;
+					p += step;
+				}
+				break;
+			case FORMAT::S32:  // 下位 8 ビットは、ディザーより小さいので捨てる
+				for(uint32_t i = 0; i < frames; ++i) {
+					dst[i].l_ch = s24_(load32_(p) >> 8);
+					dst[i].r_ch = ch > 1 ? s24_(load32_(p + ofs) >> 8) : dst[i].l_ch;
+					p += step;
+				}
+				break;
+			case FORMAT::F32:
+				for(uint32_t i = 0; i < frames; ++i) {
+					dst[i].l_ch = f32_(loadf_(p));
+					dst[i].r_ch = ch > 1 ? f32_(loadf_(p + ofs)) : dst[i].l_ch;
+					p += step;
+				}
+				break;
+			default:
+				return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,425 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	サウンド・ミキサー・クラス @n
+			複数のボイスを、固定小数点でブロック単位に合成する。@n
+			ボイスの音源は、ボイス毎の FIFO（ストリーム）、又は PCM キャッシュの波形。@n
+			ボイス毎に、サンプリング・レート、ゲイン、パンを持ち、出力レートと異なる@n
+			場合は、線形補間でリサンプリングする。@n
+			sound_out::set_mixer() で登録すると、sound_out::service() の中で、@n
+			sound_out の FIFO（主ストリーム）に合成される（結果は飽和処理）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <limits>
+#include "common/fixed_fifo.hpp"
+#include "sound/sound_out.hpp"
+#include "sound/pcm_cache.hpp"
+
+namespace sound {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	サウンド・ミキサー・クラス
+		@param[in]	T		波形単位型（符号付き）
+		@param[in]	VOICE	ボイス数
+		@param[in]	VBFS	ボイス毎の FIFO のサイズ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T, uint32_t VOICE, uint32_t VBFS>
+	class sound_mixer {
+	public:
+		typedef wave_t<T> WAVE;
+		typedef utils::fixed_fifo<WAVE, VBFS> FIFO;
+
+		static const uint32_t BLOCK     = 64;	///< 合成の単位（フレーム数）
+		static const int32_t  GAIN_SHIFT = 8;
+		static const int32_t  GAIN_ONE  = 1 << GAIN_SHIFT;	///< ゲイン 1.0
+		static const int32_t  PAN_RANGE = 256;	///< パンの範囲（-256: 左、0: 中央、+256: 右）
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	音源
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class SOURCE : uint8_t {
+			NONE,	///< 停止
+			FIFO,	///< ボイスの FIFO
+			PCM,	///< 波形（PCM キャッシュ）
+		};
+
+	private:
+
+		static const uint32_t PHASE_ONE = 0x10000;
+
+		struct voice_t {
+			FIFO		fifo_;
+			const WAVE*	pcm_;
+			uint32_t	len_;
+			uint32_t	pos_;
+			bool		loop_;
+			volatile SOURCE	source_;
+			uint32_t	rate_;
+			uint32_t	step_;	///< 入力レート／出力レート（16.16 固定小数点）
+			uint32_t	phase_;
+			int32_t		gain_;
+			int32_t		pan_;
+			int32_t		gl_;
+			int32_t		gr_;
+			WAVE		w0_;
+			WAVE		w1_;
+
+			voice_t() noexcept : fifo_(), pcm_(nullptr), len_(0), pos_(0), loop_(false),
+				source_(SOURCE::NONE), rate_(48'000), step_(PHASE_ONE), phase_(0),
+				gain_(GAIN_ONE), pan_(0), gl_(GAIN_ONE), gr_(GAIN_ONE), w0_(0), w1_(0) { }
+		};
+
+		voice_t		voice_[VOICE];
+		uint32_t	out_rate_;
+
+
+		void update_step_(voice_t& v) noexcept
+		{
+			v.step_ = (static_cast<uint64_t>(v.rate_) << 16) / out_rate_;
+		}
+
+
+		void update_gain_(voice_t& v) noexcept
+		{
+			v.gl_ = v.pan_ > 0 ? (v.gain_ * (PAN_RANGE - v.pan_)) / PAN_RANGE : v.gain_;
+			v.gr_ = v.pan_ < 0 ? (v.gain_ * (PAN_RANGE + v.pan_)) / PAN_RANGE : v.gain_;
+		}
+
+
+		// 音源から１フレーム取り出す（無ければ「false」）
+		static bool fetch_(voice_t& v, uint32_t& avail, WAVE& w) noexcept
+		{
+			if(avail == 0) {
+				if(v.source_ != SOURCE::PCM || !v.loop_) return false;
+				v.pos_ = 0;
+				avail = v.len_;
+			}
+			--avail;
+			if(v.source_ == SOURCE::FIFO) {
+				w = v.fifo_.get();
+			} else {
+				w = v.pcm_[v.pos_];
+				++v.pos_;
+			}
+			return true;
+		}
+
+
+		static void mix_voice_(voice_t& v, int32_t* acc, uint32_t num) noexcept
+		{
+			// FIFO の長さは、ブロック毎に一度だけ読む
+			uint32_t avail = v.source_ == SOURCE::FIFO ? v.fifo_.length() : (v.len_ - v.pos_);
+			const int32_t gl = v.gl_;
+			const int32_t gr = v.gr_;
+			bool end = false;
+			if(v.step_ == PHASE_ONE && v.source_ == SOURCE::PCM) {  // 波形は連続した区間毎に
+				uint32_t i = 0;
+				while(i < num) {
+					if(v.pos_ >= v.len_) {
+						if(!v.loop_) break;
+						v.pos_ = 0;
+					}
+					uint32_t n = num - i;
+					if(n > (v.len_ - v.pos_)) n = v.len_ - v.pos_;
+					const WAVE* src = &v.pcm_[v.pos_];
+					for(uint32_t j = 0; j < n; ++j) {
+						acc[0] += static_cast<int32_t>(src[j].l_ch) * gl;
+						acc[1] += static_cast<int32_t>(src[j].r_ch) * gr;
+						acc += 2;
+					}
+					v.pos_ += n;
+					i += n;
+				}
+				if(v.pos_ >= v.len_ && !v.loop_) end = true;
+			} else if(v.step_ == PHASE_ONE) {
+				for(uint32_t i = 0; i < num; ++i) {
+					WAVE w;
+					if(!fetch_(v, avail, w)) {
+						end = true;
+						break;
+					}
+					acc[0] += static_cast<int32_t>(w.l_ch) * gl;
+					acc[1] += static_cast<int32_t>(w.r_ch) * gr;
+					acc += 2;
+				}
+			} else {
+				for(uint32_t i = 0; i < num; ++i) {
+					while(v.phase_ >= PHASE_ONE) {
+						v.phase_ -= PHASE_ONE;
+						v.w0_ = v.w1_;
+						if(!fetch_(v, avail, v.w1_)) {
+							v.w1_.set(0);
+							end = true;
+						}
+					}
+					// 差分（17 ビット）と係数（15 ビット）の積が 32 ビットに収まるように
+					int32_t f = v.phase_ >> 1;
+					int32_t l = v.w0_.l_ch + (((static_cast<int32_t>(v.w1_.l_ch) - v.w0_.l_ch) * f) >> 15);
+					int32_t r = v.w0_.r_ch + (((static_cast<int32_t>(v.w1_.r_ch) - v.w0_.r_ch) * f) >> 15);
+					acc[0] += l * gl;
+					acc[1] += r * gr;
+					acc += 2;
+					v.phase_ += v.step_;
+				}
+			}
+			// FIFO の不足はそのまま（次のブロックで再開）、波形は終端で停止
+			if(end && v.source_ == SOURCE::PCM) {
+				v.source_ = SOURCE::NONE;
+			}
+		}
+
+
+		void start_(voice_t& v, SOURCE src) noexcept
+		{
+			v.source_ = SOURCE::NONE;
+			v.pos_ = 0;
+			v.phase_ = PHASE_ONE * 2;  // 最初の合成で w0_, w1_ を読み込む
+			v.w0_.set(0);
+			v.w1_.set(0);
+			update_step_(v);
+			v.source_ = src;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	out_rate	出力レート（Hz）
+		*/
+		//-----------------------------------------------------------------//
+		sound_mixer(uint32_t out_rate = 48'000) noexcept : voice_(), out_rate_(out_rate) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイス数を返す
+			@return ボイス数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t size() noexcept { return VOICE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	出力レート設定（sound_out の出力レートと同じにする）
+			@param[in]	rate	出力レート（Hz）
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool set_output_rate(uint32_t rate) noexcept
+		{
+			if(rate == 0) return false;
+			out_rate_ = rate;
+			for(uint32_t i = 0; i < VOICE; ++i) {
+				update_step_(voice_[i]);
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスの FIFO の参照（SOURCE::FIFO で再生する場合）
+			@param[in]	idx	ボイス番号
+			@return FIFO
+		*/
+		//-----------------------------------------------------------------//
+		FIFO& at_fifo(uint32_t idx) noexcept { return voice_[idx].fifo_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスのサンプリング・レート設定（FIFO の場合）
+			@param[in]	idx		ボイス番号
+			@param[in]	rate	入力レート（Hz）
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool set_rate(uint32_t idx, uint32_t rate) noexcept
+		{
+			if(idx >= VOICE || rate == 0) return false;
+			voice_[idx].rate_ = rate;
+			update_step_(voice_[idx]);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスのゲイン設定
+			@param[in]	idx		ボイス番号
+			@param[in]	gain	ゲイン（GAIN_ONE で 1.0）
+		*/
+		//-----------------------------------------------------------------//
+		void set_gain(uint32_t idx, int32_t gain) noexcept
+		{
+			if(idx >= VOICE) return;
+			voice_[idx].gain_ = gain;
+			update_gain_(voice_[idx]);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスのパン設定
+			@param[in]	idx		ボイス番号
+			@param[in]	pan		パン（-PAN_RANGE: 左 ～ +PAN_RANGE: 右）
+		*/
+		//-----------------------------------------------------------------//
+		void set_pan(uint32_t idx, int32_t pan) noexcept
+		{
+			if(idx >= VOICE) return;
+			if(pan < -PAN_RANGE) pan = -PAN_RANGE;
+			else if(pan > PAN_RANGE) pan = PAN_RANGE;
+			voice_[idx].pan_ = pan;
+			update_gain_(voice_[idx]);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスの FIFO を音源として再生を開始
+			@param[in]	idx	ボイス番号
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool play(uint32_t idx) noexcept
+		{
+			if(idx >= VOICE) return false;
+			start_(voice_[idx], SOURCE::FIFO);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	波形を音源として再生を開始
+			@param[in]	idx		ボイス番号
+			@param[in]	src		波形（再生中は保持する事）
+			@param[in]	len		フレーム数
+			@param[in]	rate	サンプリング・レート
+			@param[in]	loop	繰り返す場合「true」
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool play(uint32_t idx, const WAVE* src, uint32_t len, uint32_t rate, bool loop = false) noexcept
+		{
+			if(idx >= VOICE || src == nullptr || len == 0 || rate == 0) return false;
+			auto& v = voice_[idx];
+			v.source_ = SOURCE::NONE;
+			v.pcm_ = src;
+			v.len_ = len;
+			v.loop_ = loop;
+			v.rate_ = rate;
+			start_(v, SOURCE::PCM);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	PCM キャッシュの波形を再生
+			@param[in]	idx		ボイス番号
+			@param[in]	cache	PCM キャッシュ
+			@param[in]	no		キャッシュの登録番号
+			@param[in]	loop	繰り返す場合「true」
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		template <uint32_t SIZE, uint32_t NUM>
+		bool play(uint32_t idx, const pcm_cache<T, SIZE, NUM>& cache, uint32_t no, bool loop = false) noexcept
+		{
+			if(no >= cache.size()) return false;
+			return play(idx, cache.get_wave(no), cache.get_length(no), cache.get_rate(no), loop);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスの停止
+			@param[in]	idx	ボイス番号
+		*/
+		//-----------------------------------------------------------------//
+		void stop(uint32_t idx) noexcept
+		{
+			if(idx >= VOICE) return;
+			voice_[idx].source_ = SOURCE::NONE;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボイスの音源を取得
+			@param[in]	idx	ボイス番号
+			@return 音源（停止中なら SOURCE::NONE）
+		*/
+		//-----------------------------------------------------------------//
+		SOURCE get_source(uint32_t idx) const noexcept
+		{
+			if(idx >= VOICE) return SOURCE::NONE;
+			return voice_[idx].source_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	停止中のボイスを探す（効果音の割り当て用）
+			@param[in]	org	探索を始めるボイス番号
+			@return ボイス番号（無ければ -1）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t find_idle(uint32_t org = 0) const noexcept
+		{
+			for(uint32_t i = org; i < VOICE; ++i) {
+				if(voice_[i].source_ == SOURCE::NONE) return i;
+			}
+			return -1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	合成 @n
+					dst の波形に、再生中のボイスを加算し、飽和処理する
+			@param[in,out]	dst	波形
+			@param[in]		num	フレーム数
+		*/
+		//-----------------------------------------------------------------//
+		void mix(WAVE* dst, uint32_t num) noexcept
+		{
+			static const int32_t vmax = std::numeric_limits<T>::max();
+			static const int32_t vmin = std::numeric_limits<T>::min();
+			while(num > 0) {
+				uint32_t n = num < BLOCK ? num : BLOCK;
+				int32_t acc[BLOCK * 2];
+				for(uint32_t i = 0; i < n; ++i) {
+					acc[i * 2 + 0] = static_cast<int32_t>(dst[i].l_ch) * GAIN_ONE;
+					acc[i * 2 + 1] = static_cast<int32_t>(dst[i].r_ch) * GAIN_ONE;
+				}
+				for(uint32_t j = 0; j < VOICE; ++j) {
+					if(voice_[j].source_ != SOURCE::NONE) {
+						mix_voice_(voice_[j], acc, n);
+					}
+				}
+				for(uint32_t i = 0; i < n; ++i) {
+					int32_t l = acc[i * 2 + 0] >> GAIN_SHIFT;
+					int32_t r = acc[i * 2 + 1] >> GAIN_SHIFT;
+					if(l > vmax) l = vmax; else if(l < vmin) l = vmin;
+					if(r > vmax) r = vmax; else if(r < vmin) r = vmin;
+					dst[i].l_ch = l;
+					dst[i].r_ch = r;
+				}
+				dst += n;
+				num -= n;
+			}
+		}
+	};
+}
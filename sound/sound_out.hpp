@@ -53,8 +53,13 @@ namespace sound {
 		typedef wave_t<T> WAVE;
 		typedef utils::fixed_fifo<WAVE, BFS> FIFO;		
 
+		/// 合成関数型（sound_mixer など）
+		typedef void (*MIX_FUNC)(void* ctx, WAVE* dst, uint32_t num);
+
 	private:
 
+		static const uint32_t MIX_BLOCK = 64;
+
 		WAVE		wave_[OUTS];
 		uint32_t	w_put_;
 
@@ -69,6 +74,47 @@ namespace sound {
 
 		volatile uint32_t	sample_count_;
 
+		volatile MIX_FUNC	mix_func_;
+		void*		mix_ctx_;
+
+
+		// FIFO（主ストリーム）から、出力レートで num 個取り出す
+		void fetch_(WAVE* dst, uint32_t num) noexcept
+		{
+			volatile auto len = fifo_.length();
+			if(inp_rate_ == out_rate_) {
+				for(uint32_t i = 0; i < num; ++i) {
+					if(len > 0) {
+						dst[i] = fifo_.get();
+						--len;
+					} else {
+						dst[i].set(0);
+					}
+				}
+				sample_count_ += num;
+			} else {
+				uint32_t i = 0;
+				WAVE next(0);
+				while(i < num) {
+					if(timebase_ >= out_rate_) {
+						timebase_ -= out_rate_;
+						if(len > 0) {
+							wbase_ = fifo_.get();
+							next = fifo_.get_at();
+							--len;
+						} else {
+							wbase_.set(0);
+							next.set(0);
+						}
+					}
+//					dst[i] = WAVE::linear(out_rate_, timebase_, wbase_, next);
+					dst[i] = wbase_;
+					timebase_ += inp_rate_;
+					++i;
+				}
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -78,7 +124,7 @@ namespace sound {
 		//-----------------------------------------------------------------//
 		sound_out(T zero_ofs) noexcept : w_put_(0), fifo_(),
 			out_rate_(48'000), inp_rate_(48'000), timebase_(0), wbase_(), zero_ofs_(zero_ofs),
-			sample_count_(0)
+			sample_count_(0), mix_func_(nullptr), mix_ctx_(nullptr)
 		{ }
 
 
@@ -180,6 +226,36 @@ namespace sound {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ミキサーの登録 @n
+					service() の中で、FIFO（主ストリーム）の波形に合成される
+			@param[in]	mixer	ミキサー（sound_mixer）
+		*/
+		//-----------------------------------------------------------------//
+		template <class MIXER>
+		void set_mixer(MIXER& mixer) noexcept
+		{
+			mix_func_ = nullptr;
+			mix_ctx_ = &mixer;
+			mix_func_ = [](void* ctx, WAVE* dst, uint32_t num) {
+				static_cast<MIXER*>(ctx)->mix(dst, num);
+			};
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ミキサーの登録解除
+		*/
+		//-----------------------------------------------------------------//
+		void reset_mixer() noexcept
+		{
+			mix_func_ = nullptr;
+			mix_ctx_ = nullptr;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	サービス
@@ -188,45 +264,21 @@ namespace sound {
 		//-----------------------------------------------------------------//
 		void service(uint32_t num) noexcept
 		{
-			volatile auto len = fifo_.length();
-			if(inp_rate_ == out_rate_) {
-				for(uint32_t i = 0; i < num; ++i) {
-					WAVE t;
-					if(len > 0) {
-						t = fifo_.get();
-						--len;
-					} else {
-						t.set(0);
-					}
-					wave_[w_put_] = t;
-					wave_[w_put_].offset(zero_ofs_);
-					++w_put_;
-					w_put_ &= (OUTS - 1);
+			while(num > 0) {
+				uint32_t n = num < MIX_BLOCK ? num : MIX_BLOCK;
+				WAVE tmp[MIX_BLOCK];
+				fetch_(tmp, n);
+				auto func = mix_func_;
+				if(func != nullptr) {
+					func(mix_ctx_, tmp, n);
 				}
-				sample_count_ += num;
-			} else {
-				uint32_t i = 0;
-				WAVE next(0);
-				while(i < num) {
-					if(timebase_ >= out_rate_) {
-						timebase_ -= out_rate_;
-						if(len > 0) {
-							wbase_ = fifo_.get();
-							next = fifo_.get_at();
-							--len;
-						} else {
-							wbase_.set(0);
-							next.set(0);
-						}
-					}
-//					wave_[w_put_] = WAVE::linear(out_rate_, timebase_, wbase_, next);
-					wave_[w_put_] = wbase_;
+				for(uint32_t i = 0; i < n; ++i) {
+					wave_[w_put_] = tmp[i];
 					wave_[w_put_].offset(zero_ofs_);
 					++w_put_;
 					w_put_ &= (OUTS - 1);
-					timebase_ += inp_rate_;
-					++i;
 				}
+				num -= n;
 			}
 		}
 
@@ -29,6 +29,11 @@
 
 class Dx7Note {
  public:
+  Dx7Note() {
+    fb_buf_[0] = 0;
+    fb_buf_[1] = 0;
+  }
+
   void init(const char patch[128], int midinote, int velocity);
 
   // Note: this _adds_ to the buffer. Interesting question whether it's
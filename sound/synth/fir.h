@@ -91,3 +91,33 @@ class SseFirFilter : public FirFilter<float, float> {
 };
 
 #endif  // __SSE2__
+
+#ifdef HAVE_X86_SIMD
+
+// Direct form with the same contract and summation order as SimpleFirFilter
+// (no alignment requirement), so the output is bit-exact with it.
+class SseDirectFirFilter : public FirFilter<float, float> {
+ public:
+  SseDirectFirFilter(const float *kernel, size_t nk);
+  ~SseDirectFirFilter();
+  void process(const float *in, float *out, size_t n);
+ private:
+  size_t nk;
+  float *k;
+};
+
+class AvxDirectFirFilter : public FirFilter<float, float> {
+ public:
+  AvxDirectFirFilter(const float *kernel, size_t nk);
+  ~AvxDirectFirFilter();
+  void process(const float *in, float *out, size_t n);
+ private:
+  size_t nk;
+  float *k;
+};
+
+#endif  // HAVE_X86_SIMD
+
+// Returns the fastest filter for the running CPU that is bit-exact with
+// SimpleFirFilter.
+FirFilter<float, float> *new_fir_filter(const float *kernel, size_t nk);
@@ -151,6 +151,153 @@ const int32_t __attribute__ ((aligned(16))) zeros[N] = {0};
 
 #endif
 
+#if defined(HAVE_X86_SIMD) && defined(SIN_DELTA)
+#include <immintrin.h>
+
+// The x86 kernels are bit-exact with the scalar loops: Sin::lookup() is
+// evaluated with integer lanes against the same sintab, and the Q24 gain
+// multiply keeps bits 24..55 of the full 64-bit product.
+// (dy * lowbits) always fits in 32 bits (|dy| < 2^17, lowbits < 2^14).
+
+// signed 32x32 -> 64, returns the low 32 bits of (a * b) >> 24 (SSE2 only
+// has the unsigned multiply, so the high word is corrected for the signs)
+__attribute__((target("sse2")))
+static inline __m128i sse2_mul_q24(__m128i a, __m128i b) {
+  __m128i corr = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(a, 31), b),
+                               _mm_and_si128(_mm_srai_epi32(b, 31), a));
+  __m128i pe = _mm_mul_epu32(a, b);
+  pe = _mm_sub_epi64(pe, _mm_slli_epi64(corr, 32));
+  __m128i po = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  po = _mm_sub_epi64(po, _mm_slli_epi64(_mm_srli_epi64(corr, 32), 32));
+  const __m128i lo = _mm_set_epi32(0, -1, 0, -1);
+  return _mm_or_si128(_mm_and_si128(_mm_srli_epi64(pe, 24), lo),
+                      _mm_andnot_si128(lo, _mm_slli_epi64(po, 8)));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i sse2_mullo(__m128i a, __m128i b) {
+  __m128i pe = _mm_mul_epu32(a, b);
+  __m128i po = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  const __m128i lo = _mm_set_epi32(0, -1, 0, -1);
+  return _mm_or_si128(_mm_and_si128(pe, lo),
+                      _mm_andnot_si128(lo, _mm_slli_epi64(po, 32)));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i sse2_sin_lookup(__m128i phase) {
+  const int SHIFT = 24 - SIN_LG_N_SAMPLES;
+  __m128i lowbits = _mm_and_si128(phase, _mm_set1_epi32((1 << SHIFT) - 1));
+  __m128i idx = _mm_and_si128(_mm_srai_epi32(phase, SHIFT - 1),
+                              _mm_set1_epi32((SIN_N_SAMPLES - 1) << 1));
+  // no gather before AVX2: dy and y0 are adjacent, so one 64-bit load a lane
+  __m128i d0 = _mm_loadl_epi64((const __m128i *)&sintab[_mm_cvtsi128_si32(idx)]);
+  __m128i d1 = _mm_loadl_epi64((const __m128i *)
+    &sintab[_mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 1))]);
+  __m128i d2 = _mm_loadl_epi64((const __m128i *)
+    &sintab[_mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 2))]);
+  __m128i d3 = _mm_loadl_epi64((const __m128i *)
+    &sintab[_mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 3))]);
+  d0 = _mm_unpacklo_epi32(d0, d1);
+  d2 = _mm_unpacklo_epi32(d2, d3);
+  __m128i dy = _mm_unpacklo_epi64(d0, d2);
+  __m128i y0 = _mm_unpackhi_epi64(d0, d2);
+  return _mm_add_epi32(y0, _mm_srai_epi32(sse2_mullo(dy, lowbits), SHIFT));
+}
+
+// in == 0 is the pure sine generator
+__attribute__((target("sse2")))
+static void sse2_fm_kernel(const int32_t *in, int32_t *out, int count,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  uint32_t f = freq;
+  uint32_t g = dgain;
+  __m128i phase = _mm_set_epi32(phase0 + 3 * f, phase0 + 2 * f,
+                                phase0 + f, phase0);
+  __m128i gain = _mm_set_epi32(gain1 + 4 * g, gain1 + 3 * g,
+                               gain1 + 2 * g, gain1 + g);
+  __m128i freq4 = _mm_set1_epi32(f << 2);
+  __m128i dgain4 = _mm_set1_epi32(g << 2);
+  for (int i = 0; i < count; i += 4) {
+    __m128i p = phase;
+    if (in) p = _mm_add_epi32(p, _mm_loadu_si128((const __m128i *)&in[i]));
+    __m128i y = sse2_mul_q24(sse2_sin_lookup(p), gain);
+    if (add) y = _mm_add_epi32(y, _mm_loadu_si128((const __m128i *)&out[i]));
+    _mm_storeu_si128((__m128i *)&out[i], y);
+    phase = _mm_add_epi32(phase, freq4);
+    gain = _mm_add_epi32(gain, dgain4);
+  }
+}
+
+__attribute__((target("avx2")))
+static inline __m256i avx2_mul_q24(__m256i a, __m256i b) {
+  __m256i pe = _mm256_mul_epi32(a, b);
+  __m256i po = _mm256_mul_epi32(_mm256_srli_epi64(a, 32),
+                                _mm256_srli_epi64(b, 32));
+  return _mm256_blend_epi32(_mm256_srli_epi64(pe, 24),
+                            _mm256_slli_epi64(po, 8), 0xaa);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i avx2_sin_lookup(__m256i phase) {
+  const int SHIFT = 24 - SIN_LG_N_SAMPLES;
+  __m256i lowbits = _mm256_and_si256(phase,
+                                     _mm256_set1_epi32((1 << SHIFT) - 1));
+  __m256i idx = _mm256_and_si256(_mm256_srai_epi32(phase, SHIFT - 1),
+                                 _mm256_set1_epi32((SIN_N_SAMPLES - 1) << 1));
+  __m256i dy = _mm256_i32gather_epi32((const int *)sintab, idx, 4);
+  __m256i y0 = _mm256_i32gather_epi32((const int *)sintab + 1, idx, 4);
+  return _mm256_add_epi32(y0,
+    _mm256_srai_epi32(_mm256_mullo_epi32(dy, lowbits), SHIFT));
+}
+
+__attribute__((target("avx2")))
+static void avx2_fm_kernel(const int32_t *in, int32_t *out, int count,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  uint32_t f = freq;
+  uint32_t g = dgain;
+  __m256i step = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256i phase = _mm256_add_epi32(_mm256_set1_epi32(phase0),
+                    _mm256_mullo_epi32(step, _mm256_set1_epi32(f)));
+  __m256i gain = _mm256_add_epi32(_mm256_set1_epi32(gain1 + g),
+                   _mm256_mullo_epi32(step, _mm256_set1_epi32(g)));
+  __m256i freq8 = _mm256_set1_epi32(f << 3);
+  __m256i dgain8 = _mm256_set1_epi32(g << 3);
+  for (int i = 0; i < count; i += 8) {
+    __m256i p = phase;
+    if (in) {
+      p = _mm256_add_epi32(p, _mm256_loadu_si256((const __m256i *)&in[i]));
+    }
+    __m256i y = avx2_mul_q24(avx2_sin_lookup(p), gain);
+    if (add) {
+      y = _mm256_add_epi32(y, _mm256_loadu_si256((const __m256i *)&out[i]));
+    }
+    _mm256_storeu_si256((__m256i *)&out[i], y);
+    phase = _mm256_add_epi32(phase, freq8);
+    gain = _mm256_add_epi32(gain, dgain8);
+  }
+}
+
+// returns false when the host has neither, the caller then runs the scalar loop
+static bool x86_fm_kernel(const int32_t *in, int32_t *out,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  if (hasAvx2()) {
+    avx2_fm_kernel(in, out, SYNTH_N, phase0, freq, gain1, dgain, add);
+    return true;
+  } else if (hasSse2()) {
+    sse2_fm_kernel(in, out, SYNTH_N, phase0, freq, gain1, dgain, add);
+    return true;
+  }
+  return false;
+}
+
+#else
+
+static bool x86_fm_kernel(const int32_t *in, int32_t *out,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  return false;
+}
+
+#endif
+
 void FmOpKernel::compute(int32_t *output, const int32_t *input,
                          int32_t phase0, int32_t freq,
                          int32_t gain1, int32_t gain2, bool add) {
@@ -162,7 +309,7 @@ void FmOpKernel::compute(int32_t *output, const int32_t *input,
     neon_fm_kernel(input, add ? output : zeros, output, N,
       phase0, freq, gain, dgain);
 #endif
-  } else {
+  } else if (!x86_fm_kernel(input, output, phase0, freq, gain, dgain, add)) {
     if (add) {
       for (int i = 0; i < SYNTH_N; i++) {
         gain += dgain;
@@ -192,7 +339,7 @@ void FmOpKernel::compute_pure(int32_t *output, int32_t phase0, int32_t freq,
     neon_fm_kernel(zeros, add ? output : zeros, output, N,
       phase0, freq, gain, dgain);
 #endif
-  } else {
+  } else if (!x86_fm_kernel(0, output, phase0, freq, gain, dgain, add)) {
     if (add) {
       for (int i = 0; i < SYNTH_N; i++) {
         gain += dgain;
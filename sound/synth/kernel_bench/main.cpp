@@ -0,0 +1,252 @@
+//=====================================================================//
+/*!	@file
+	@brief	シンセサイザー・カーネル・ベンチマーク（ホスト用） @n
+			FmOpKernel（compute、compute_pure）と FIR フィルターの SSE2/AVX2 版を、@n
+			スカラー版と比較して、出力がビット単位で一致するか確かめ、@n
+			１秒辺りのサンプル数を測る。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "synth.h"
+#include "sin.h"
+#include "fm_op_kernel.h"
+#include "fir.h"
+#include "common/host_bench/timer.h"
+
+namespace {
+
+	static const uint32_t FM_BLOCKS = 200000;	///< FM の計測ブロック数（SYNTH_N サンプル）
+	static const uint32_t FM_TESTS = 20000;		///< FM の比較ブロック数
+	static const uint32_t FIR_NK = 64;			///< FIR のタップ数
+	static const uint32_t FIR_N = 4096;			///< FIR の１回の出力サンプル数
+	static const uint32_t FIR_LOOP = 200;		///< FIR の計測回数
+	static const uint32_t RUNS = 5;				///< 計測を繰り返して最小を取る
+
+	uint32_t	rand_ = 1;
+
+	int32_t rand32_()
+	{
+		rand_ = rand_ * 1664525 + 1013904223;
+		return static_cast<int32_t>(rand_);
+	}
+
+
+	// fm_op_kernel.cpp のスカラー・ループ（NEON/x86 カーネルが無い場合の処理）と同じ
+	void scalar_compute_(int32_t* output, const int32_t* input,
+		int32_t phase0, int32_t freq, int32_t gain1, int32_t gain2, bool add)
+	{
+		int32_t dgain = (gain2 - gain1 + (SYNTH_N >> 1)) >> SYNTH_LG_N;
+		int32_t gain = gain1;
+		int32_t phase = phase0;
+		for(int i = 0; i < SYNTH_N; i++) {
+			gain += dgain;
+			int32_t y = Sin::lookup(phase + (input != nullptr ? input[i] : 0));
+			int32_t v = (static_cast<int64_t>(y) * static_cast<int64_t>(gain)) >> 24;
+			if(add) output[i] += v;
+			else output[i] = v;
+			phase += freq;
+		}
+	}
+
+
+	struct fm_arg_t {
+		int32_t	phase0;
+		int32_t	freq;
+		int32_t	gain1;
+		int32_t	gain2;
+		bool	add;
+	};
+
+	fm_arg_t make_fm_arg_()
+	{
+		fm_arg_t a;
+		a.phase0 = rand32_();
+		a.freq = rand32_() >> (rand32_() & 15);
+		// エンベロープのゲインは Q24 で 0 ～ 2^24 程度、端の値も混ぜる
+		a.gain1 = (rand32_() & 0x1ffffff) - (rand32_() & 0xffffff);
+		a.gain2 = (rand32_() & 0x1ffffff) - (rand32_() & 0xffffff);
+		a.add = (rand32_() & 1) != 0;
+		return a;
+	}
+
+
+	bool fm_check_(bool pure)
+	{
+		int32_t in[SYNTH_N];
+		int32_t ref[SYNTH_N];
+		int32_t out[SYNTH_N];
+		for(uint32_t n = 0; n < FM_TESTS; ++n) {
+			auto a = make_fm_arg_();
+			for(int i = 0; i < SYNTH_N; ++i) {
+				in[i] = rand32_() >> (rand32_() & 7);
+				ref[i] = out[i] = rand32_() >> 4;
+			}
+			if(pure) {
+				FmOpKernel::compute_pure(out, a.phase0, a.freq, a.gain1, a.gain2, a.add);
+				scalar_compute_(ref, nullptr, a.phase0, a.freq, a.gain1, a.gain2, a.add);
+			} else {
+				FmOpKernel::compute(out, in, a.phase0, a.freq, a.gain1, a.gain2, a.add);
+				scalar_compute_(ref, in, a.phase0, a.freq, a.gain1, a.gain2, a.add);
+			}
+			if(memcmp(ref, out, sizeof(out)) != 0) {
+				for(int i = 0; i < SYNTH_N; ++i) {
+					if(ref[i] != out[i]) {
+						printf("FM %s mismatch: block %u, sample %d: %d / %d (scalar)\n",
+							pure ? "compute_pure" : "compute", n, i, out[i], ref[i]);
+						break;
+					}
+				}
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	void report_(const char* title, double us, double samples)
+	{
+		printf("%-28s %8.2f M samples/s\n", title, samples / us);
+	}
+
+
+	void fm_bench_()
+	{
+		std::vector<int32_t> in(SYNTH_N);
+		std::vector<int32_t> out(SYNTH_N);
+		for(auto& v : in) v = rand32_() >> 6;
+		auto a = make_fm_arg_();
+
+		static const char* titles[] = {
+			"FM compute (scalar)", "FM compute (SIMD)",
+			"FM compute_pure (scalar)", "FM compute_pure (SIMD)",
+		};
+		double best[4] = { 1e30, 1e30, 1e30, 1e30 };
+		// 計時の揺らぎを避けるため、交互に測って最小を取る
+		for(uint32_t r = 0; r < RUNS; ++r) {
+			for(uint32_t m = 0; m < 4; ++m) {
+				auto st = bench_usec();
+				for(uint32_t n = 0; n < FM_BLOCKS; ++n) {
+					switch(m) {
+					case 0:
+						scalar_compute_(&out[0], &in[0], a.phase0 + n, a.freq, a.gain1, a.gain2, true);
+						break;
+					case 1:
+						FmOpKernel::compute(&out[0], &in[0], a.phase0 + n, a.freq, a.gain1, a.gain2, true);
+						break;
+					case 2:
+						scalar_compute_(&out[0], nullptr, a.phase0 + n, a.freq, a.gain1, a.gain2, true);
+						break;
+					default:
+						FmOpKernel::compute_pure(&out[0], a.phase0 + n, a.freq, a.gain1, a.gain2, true);
+						break;
+					}
+				}
+				auto t = bench_usec() - st;
+				if(t < best[m]) best[m] = t;
+			}
+		}
+		for(uint32_t m = 0; m < 4; ++m) {
+			report_(titles[m], best[m], static_cast<double>(FM_BLOCKS) * SYNTH_N);
+		}
+		printf("FM compute speed up: %.2f, compute_pure: %.2f (check %d)\n",
+			best[0] / best[1], best[2] / best[3], out[0]);
+	}
+
+
+	struct fir_t {
+		const char*					title;
+		FirFilter<float, float>*	filter;
+	};
+
+
+	bool fir_bench_()
+	{
+		std::vector<float> kernel(FIR_NK);
+		for(auto& k : kernel) k = static_cast<float>(rand32_()) / 2147483648.0f / FIR_NK;
+		// 入力は「n + nk - 1」サンプル必要
+		std::vector<float> in(FIR_N + FIR_NK - 1);
+		for(auto& v : in) v = static_cast<float>(rand32_()) / 2147483648.0f;
+
+		std::vector<fir_t> firs;
+		firs.push_back({ "FIR Simple (scalar)", new SimpleFirFilter(&kernel[0], FIR_NK) });
+		if(hasSse2()) firs.push_back({ "FIR SseDirect", new SseDirectFirFilter(&kernel[0], FIR_NK) });
+		if(hasAvx2()) firs.push_back({ "FIR AvxDirect", new AvxDirectFirFilter(&kernel[0], FIR_NK) });
+		firs.push_back({ "FIR new_fir_filter()", new_fir_filter(&kernel[0], FIR_NK) });
+
+		bool ok = true;
+		std::vector<float> ref(FIR_N);
+		std::vector<float> out(FIR_N);
+		// 端数の処理も確かめるため、半端な長さも試す
+		static const uint32_t lens[] = { FIR_N, FIR_N - 1, 27, 8, 5, 1 };
+		for(auto n : lens) {
+			firs[0].filter->process(&in[0], &ref[0], n);
+			for(uint32_t i = 1; i < firs.size(); ++i) {
+				memset(&out[0], 0, sizeof(float) * FIR_N);
+				firs[i].filter->process(&in[0], &out[0], n);
+				if(memcmp(&ref[0], &out[0], sizeof(float) * n) != 0) {
+					printf("%s mismatch: n = %u\n", firs[i].title, n);
+					ok = false;
+				}
+			}
+		}
+
+		std::vector<double> best(firs.size(), 1e30);
+		for(uint32_t r = 0; r < RUNS; ++r) {
+			for(uint32_t i = 0; i < firs.size(); ++i) {
+				auto st = bench_usec();
+				for(uint32_t n = 0; n < FIR_LOOP; ++n) {
+					firs[i].filter->process(&in[0], &out[0], FIR_N);
+				}
+				auto t = bench_usec() - st;
+				if(t < best[i]) best[i] = t;
+			}
+		}
+		for(uint32_t i = 0; i < firs.size(); ++i) {
+			report_(firs[i].title, best[i], static_cast<double>(FIR_LOOP) * FIR_N);
+		}
+		printf("FIR %u taps, new_fir_filter() speed up: %.2f\n", FIR_NK, best[0] / best.back());
+
+		for(auto& f : firs) delete f.filter;
+		return ok;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	Sin::init();
+
+	printf("Host SIMD: SSE2 %s, AVX2 %s\n", hasSse2() ? "yes" : "no", hasAvx2() ? "yes" : "no");
+
+	bool ok = true;
+	if(fm_check_(false)) {
+		printf("FM compute: %u blocks, bit-exact with scalar\n", FM_TESTS);
+	} else {
+		ok = false;
+	}
+	if(fm_check_(true)) {
+		printf("FM compute_pure: %u blocks, bit-exact with scalar\n", FM_TESTS);
+	} else {
+		ok = false;
+	}
+	fm_bench_();
+
+	if(fir_bench_()) {
+		printf("FIR: all filters bit-exact with SimpleFirFilter\n");
+	} else {
+		ok = false;
+	}
+
+	if(!ok) {
+		printf("Error\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,175 @@
+//=====================================================================//
+/*!	@file
+	@brief	Standard MIDI File reader (host only)
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <algorithm>
+
+#include "synth.h"
+#include "midi_file.h"
+
+namespace {
+
+struct TrackEvent {
+  uint64_t tick;
+  int track;
+  size_t order;
+  uint32_t tempo;  // non-zero for a tempo change (meta 0x51)
+  std::vector<uint8_t> data;
+};
+
+uint32_t read_be(const uint8_t *p, int n) {
+  uint32_t v = 0;
+  for (int i = 0; i < n; i++) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+bool read_varlen(const uint8_t *&p, const uint8_t *end, uint32_t *val) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    if (p >= end) return false;
+    uint8_t c = *p++;
+    v = (v << 7) | (c & 0x7f);
+    if ((c & 0x80) == 0) {
+      *val = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_track(const uint8_t *p, const uint8_t *end, int track,
+                 std::vector<TrackEvent> &out) {
+  uint64_t tick = 0;
+  uint8_t status = 0;
+  while (p < end) {
+    uint32_t delta;
+    if (!read_varlen(p, end, &delta)) return false;
+    tick += delta;
+    if (p >= end) return false;
+    TrackEvent ev;
+    ev.tick = tick;
+    ev.track = track;
+    ev.order = out.size();
+    ev.tempo = 0;
+    uint8_t c = *p;
+    if (c == 0xff) {
+      if (end - p < 2) return false;
+      uint8_t type = p[1];
+      p += 2;
+      uint32_t len;
+      if (!read_varlen(p, end, &len) || (uint32_t)(end - p) < len) return false;
+      if (type == 0x51 && len == 3) {
+        ev.tempo = read_be(p, 3);
+        out.push_back(ev);
+      } else if (type == 0x2f) {
+        return true;
+      }
+      p += len;
+    } else if (c == 0xf0 || c == 0xf7) {
+      p++;
+      uint32_t len;
+      if (!read_varlen(p, end, &len) || (uint32_t)(end - p) < len) return false;
+      // 0xf7 escapes carry raw bytes; only complete 0xf0 messages reach the synth
+      if (c == 0xf0) {
+        ev.data.push_back(0xf0);
+        ev.data.insert(ev.data.end(), p, p + len);
+        out.push_back(ev);
+      }
+      p += len;
+      status = 0;
+    } else {
+      if (c & 0x80) {
+        status = c;
+        p++;
+      } else if (status == 0) {
+        return false;  // running status without a status byte
+      }
+      int type = status & 0xf0;
+      int n = (type == 0xc0 || type == 0xd0) ? 1 : 2;
+      if (end - p < n) return false;
+      ev.data.push_back(status);
+      ev.data.insert(ev.data.end(), p, p + n);
+      p += n;
+      out.push_back(ev);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool MidiFile::Load(const char *filename, double sample_rate) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == 0) return false;
+  std::vector<uint8_t> buf;
+  uint8_t tmp[4096];
+  size_t n;
+  while ((n = fread(tmp, 1, sizeof(tmp), fp)) > 0) {
+    buf.insert(buf.end(), tmp, tmp + n);
+  }
+  fclose(fp);
+  return Parse(buf.data(), buf.size(), sample_rate);
+}
+
+bool MidiFile::Parse(const uint8_t *buf, size_t size, double sample_rate) {
+  events_.clear();
+  if (size < 14 || read_be(buf, 4) != 0x4d546864 /* MThd */) return false;
+  uint32_t hlen = read_be(buf + 4, 4);
+  if (hlen < 6 || size < 8 + hlen) return false;
+  int ntrks = read_be(buf + 10, 2);
+  uint16_t division = read_be(buf + 12, 2);
+
+  std::vector<TrackEvent> evs;
+  const uint8_t *p = buf + 8 + hlen;
+  const uint8_t *end = buf + size;
+  for (int track = 0; track < ntrks && end - p >= 8; track++) {
+    uint32_t len = read_be(p + 4, 4);
+    const uint8_t *body = p + 8;
+    if ((uint32_t)(end - body) < len) return false;
+    if (read_be(p, 4) == 0x4d54726b /* MTrk */) {
+      if (!parse_track(body, body + len, track, evs)) return false;
+    }
+    p = body + len;
+  }
+
+  // stable merge: by tick, then track, then position in the track
+  std::sort(evs.begin(), evs.end(),
+      [](const TrackEvent &a, const TrackEvent &b) {
+        if (a.tick != b.tick) return a.tick < b.tick;
+        if (a.track != b.track) return a.track < b.track;
+        return a.order < b.order;
+      });
+
+  double sec_per_tick;
+  bool smpte = (division & 0x8000) != 0;
+  if (smpte) {
+    int fps = -(int8_t)(division >> 8);
+    sec_per_tick = 1.0 / (fps * (division & 0xff));
+  } else {
+    sec_per_tick = 0.5 / division;  // 120 bpm until the first tempo event
+  }
+  uint64_t last_tick = 0;
+  double sec = 0;
+  for (size_t i = 0; i < evs.size(); i++) {
+    TrackEvent &ev = evs[i];
+    sec += (ev.tick - last_tick) * sec_per_tick;
+    last_tick = ev.tick;
+    if (ev.tempo) {
+      if (!smpte) sec_per_tick = ev.tempo * 1e-6 / division;
+      continue;
+    }
+    MidiEvent me;
+    me.sample = (uint64_t)(sec * sample_rate);
+    me.data.swap(ev.data);
+    events_.push_back(me);
+  }
+  return true;
+}
@@ -0,0 +1,36 @@
+//=====================================================================//
+/*!	@file
+	@brief	Standard MIDI File reader (host only)
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#ifndef SYNTH_MIDI_FILE_H_
+#define SYNTH_MIDI_FILE_H_
+
+// All tracks are merged into one list of messages timestamped in output
+// samples, with the tempo map applied. Meta events are dropped; sysex
+// messages are returned with their leading 0xf0.
+
+#include <cstdint>
+#include <vector>
+
+struct MidiEvent {
+  uint64_t sample;
+  std::vector<uint8_t> data;
+};
+
+class MidiFile {
+ public:
+  // Format 0 and 1, PPQN and SMPTE time division.
+  bool Load(const char *filename, double sample_rate);
+  bool Parse(const uint8_t *buf, size_t size, double sample_rate);
+
+  const std::vector<MidiEvent> &events() const { return events_; }
+ private:
+  std::vector<MidiEvent> events_;
+};
+
+#endif  // SYNTH_MIDI_FILE_H_
@@ -0,0 +1,167 @@
+//=====================================================================//
+/*!	@file
+	@brief	Multi-threaded offline renderer (host only)
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+#include "synth.h"
+#include "offline_render.h"
+
+OfflineRender::OfflineRender(int threads) : threads_(threads), cur_block_(0) {
+  if (threads_ <= 0) {
+    threads_ = std::thread::hardware_concurrency();
+    if (threads_ <= 0) threads_ = 1;
+  }
+  ring_buffer_ = new RingBuffer;
+  unit_ = new SynthUnit(*ring_buffer_);
+  unit_->SetVoiceLog(this);
+  voices_.resize(SynthUnit::MaxActiveNotes());
+  for (size_t i = 0; i < voices_.size(); i++) {
+    voices_[i].live = false;
+    voices_[i].buf.resize(kChunkBlocks * SYNTH_N);
+  }
+  control_.resize(kChunkBlocks);
+}
+
+OfflineRender::~OfflineRender() {
+  delete unit_;
+  delete ring_buffer_;
+}
+
+void OfflineRender::NoteOn(int voice, const char *patch, int midinote,
+                           int velocity) {
+  VoiceOp op;
+  op.block = cur_block_;
+  op.on = true;
+  op.midinote = midinote;
+  op.velocity = velocity;
+  memcpy(op.patch, patch, sizeof(op.patch));
+  voices_[voice].ops.push_back(op);
+}
+
+void OfflineRender::NoteOff(int voice) {
+  VoiceOp op;
+  op.block = cur_block_;
+  op.on = false;
+  voices_[voice].ops.push_back(op);
+}
+
+void OfflineRender::RenderVoice(Voice &voice, int nblocks) {
+  size_t op = 0;
+  for (int b = 0; b < nblocks; b++) {
+    for (; op < voice.ops.size() && voice.ops[op].block == b; op++) {
+      const VoiceOp &o = voice.ops[op];
+      if (o.on) {
+        voice.note.init(o.patch, o.midinote, o.velocity);
+        voice.live = true;
+      } else {
+        voice.note.keyup();
+      }
+    }
+    int32_t *buf = &voice.buf[b * SYNTH_N];
+    memset(buf, 0, SYNTH_N * sizeof(buf[0]));
+    if (voice.live) {
+      const BlockControl &ctl = control_[b];
+      voice.note.compute(buf, ctl.lfo_value, ctl.lfo_delay, &ctl.controllers);
+    }
+  }
+}
+
+void OfflineRender::Render(const std::vector<MidiEvent> &events, size_t tail,
+                           std::vector<int16_t> &out) {
+  size_t total = tail;
+  if (!events.empty()) total += events.back().sample;
+  size_t nblocks = (total + SYNTH_N - 1) >> SYNTH_LG_N;
+  out.resize(nblocks << SYNTH_LG_N);
+
+  size_t ev = 0;
+  for (size_t chunk = 0; chunk < nblocks; chunk += kChunkBlocks) {
+    int nb = min(nblocks - chunk, (size_t)kChunkBlocks);
+
+    // control path, serial
+    for (size_t v = 0; v < voices_.size(); v++) {
+      voices_[v].ops.clear();
+    }
+    for (int b = 0; b < nb; b++) {
+      cur_block_ = b;
+      uint64_t limit = (uint64_t)(chunk + b + 1) << SYNTH_LG_N;
+      for (; ev < events.size() && events[ev].sample < limit; ev++) {
+        unit_->ProcessMidi(events[ev].data.data(), events[ev].data.size());
+      }
+      unit_->NextBlockControl(&control_[b]);
+    }
+
+    // voices, one at a time per worker
+    std::atomic<int> next(0);
+    auto worker = [this, &next, nb]() {
+      int v;
+      while ((v = next++) < (int)voices_.size()) {
+        RenderVoice(voices_[v], nb);
+      }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads_; t++) {
+      pool.emplace_back(worker);
+    }
+    worker();
+    for (size_t t = 0; t < pool.size(); t++) {
+      pool[t].join();
+    }
+
+    // mix and filter, serial
+    for (int b = 0; b < nb; b++) {
+      AlignedBuf<int32_t, SYNTH_N> mix;
+      int32_t *m = mix.get();
+      memset(m, 0, SYNTH_N * sizeof(m[0]));
+      for (size_t v = 0; v < voices_.size(); v++) {
+        if (!voices_[v].live) continue;
+        const int32_t *src = &voices_[v].buf[b * SYNTH_N];
+        for (int j = 0; j < SYNTH_N; j++) {
+          m[j] += src[j];
+        }
+      }
+      unit_->FilterBlock(m, control_[b].filter_control,
+                         &out[(chunk + b) << SYNTH_LG_N]);
+    }
+  }
+  out.resize(total);
+}
+
+static void put_le(FILE *fp, uint32_t v, int n) {
+  for (int i = 0; i < n; i++) {
+    fputc((v >> (i * 8)) & 0xff, fp);
+  }
+}
+
+bool write_wav(const char *filename, const int16_t *samples, size_t n,
+               int sample_rate) {
+  FILE *fp = fopen(filename, "wb");
+  if (fp == 0) return false;
+  uint32_t data_len = n * 2;
+  fwrite("RIFF", 1, 4, fp);
+  put_le(fp, 36 + data_len, 4);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  put_le(fp, 16, 4);
+  put_le(fp, 1, 2);  // PCM
+  put_le(fp, 1, 2);  // mono
+  put_le(fp, sample_rate, 4);
+  put_le(fp, sample_rate * 2, 4);
+  put_le(fp, 2, 2);
+  put_le(fp, 16, 2);
+  fwrite("data", 1, 4, fp);
+  put_le(fp, data_len, 4);
+  for (size_t i = 0; i < n; i++) {
+    put_le(fp, (uint16_t)samples[i], 2);
+  }
+  bool ok = ferror(fp) == 0;
+  fclose(fp);
+  return ok;
+}
@@ -0,0 +1,75 @@
+//=====================================================================//
+/*!	@file
+	@brief	Multi-threaded offline renderer (host only)
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#ifndef SYNTH_OFFLINE_RENDER_H_
+#define SYNTH_OFFLINE_RENDER_H_
+
+// Renders a MIDI event list with the voices spread over a thread pool.
+//
+// Audio is produced in chunks. For each chunk the SynthUnit control path
+// (MIDI, voice allocation, LFO) runs serially and logs what every voice has
+// to do per block, then the voices are computed in parallel into their own
+// buffers, and finally the blocks are mixed and filtered serially. Voice
+// outputs are int32 and summed in voice order, so the result is bit-identical
+// for any thread count, and to GetSamples() fed one block at a time.
+
+#include <vector>
+
+#include "synth_unit.h"
+#include "midi_file.h"
+
+class OfflineRender : public VoiceLog {
+ public:
+  // threads <= 0 uses every hardware thread
+  explicit OfflineRender(int threads);
+  ~OfflineRender();
+
+  // Renders the events (sorted by sample) plus tail samples of release.
+  // SynthUnit::Init() must have been called with the events' sample rate.
+  void Render(const std::vector<MidiEvent> &events, size_t tail,
+              std::vector<int16_t> &out);
+
+  int threads() const { return threads_; }
+
+  // VoiceLog
+  void NoteOn(int voice, const char *patch, int midinote, int velocity);
+  void NoteOff(int voice);
+ private:
+  static const int kChunkBlocks = 1024;
+
+  struct VoiceOp {
+    int block;
+    bool on;
+    int midinote;
+    int velocity;
+    char patch[156];
+  };
+
+  struct Voice {
+    Dx7Note note;
+    bool live;
+    std::vector<VoiceOp> ops;
+    std::vector<int32_t> buf;
+  };
+
+  void RenderVoice(Voice &voice, int nblocks);
+
+  int threads_;
+  RingBuffer *ring_buffer_;
+  SynthUnit *unit_;
+  std::vector<Voice> voices_;
+  std::vector<BlockControl> control_;
+  int cur_block_;
+};
+
+// 16-bit mono PCM
+bool write_wav(const char *filename, const int16_t *samples, size_t n,
+               int sample_rate);
+
+#endif  // SYNTH_OFFLINE_RENDER_H_
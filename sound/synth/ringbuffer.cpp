@@ -13,8 +13,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-// for glfw3_app
-#ifdef WIN32
+// for glfw3_app, host tools
+#if defined(WIN32) || !defined(__RX__)
 #include <time.h>
 #else
 // for RX C++ framework
@@ -59,7 +59,7 @@ void RingBuffer::Write(const uint8_t *bytes, int size) {
     int wr_ix = wr_ix_;
     unsigned int space_available = (rd_ix - wr_ix - 1) & (kBufSize - 1);
     if (space_available == 0) {
-#ifdef WIN32
+#if defined(WIN32) || !defined(__RX__)
       struct timespec sleepTime;
       sleepTime.tv_sec = 0;
       sleepTime.tv_nsec = 1000'000;
@@ -20,7 +20,9 @@
 #include "sawtooth.h"
 #include "exp2.h"
 
+#ifndef M_PI
 static const double M_PI = 3.1415926535897932384626433832795;
+#endif
 
 // There's a fair amount of lookup table and so on that needs to be set before
 // generating any signal. In Java, this would be done by a separate factory class.
@@ -27,7 +27,9 @@ int32_t sintab[SIN_N_SAMPLES << 1];
 int32_t sintab[SIN_N_SAMPLES + 1];
 #endif
 
+#ifndef M_PI
 static const double M_PI = 3.1415926535897932384626433832795;
+#endif
 
 void Sin::init() {
   double dphase = 2 * M_PI / SIN_N_SAMPLES;
@@ -81,4 +81,23 @@ static inline bool hasNeon() {
 }
 #endif
 
+// x86 host builds: SSE2/AVX2 kernels are compiled with per-function target
+// attributes and picked at runtime, so no -mavx2 is needed on the command line.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD
+static inline bool hasSse2() {
+  return __builtin_cpu_supports("sse2");
+}
+static inline bool hasAvx2() {
+  return __builtin_cpu_supports("avx2");
+}
+#else
+static inline bool hasSse2() {
+  return false;
+}
+static inline bool hasAvx2() {
+  return false;
+}
+#endif
+
 #endif  // __SYNTH_H
@@ -64,6 +64,7 @@ void SynthUnit::init_()
   controllers_.values_[kControllerPitch] = 0x2000;
   sustain_ = false;
   extra_buf_size_ = 0;
+  voice_log_ = 0;
 }
 
 void SynthUnit::Init(double sample_rate) {
@@ -120,6 +121,22 @@ void SynthUnit::SetController(int controller, int value) {
   controllers_.values_[controller] = value;
 }
 
+void SynthUnit::NoteOn(int note, int midinote, int velocity) {
+  if (voice_log_) {
+    voice_log_->NoteOn(note, unpacked_patch_, midinote, velocity);
+  } else {
+    active_note_[note].dx7_note->init(unpacked_patch_, midinote, velocity);
+  }
+}
+
+void SynthUnit::NoteOff(int note) {
+  if (voice_log_) {
+    voice_log_->NoteOff(note);
+  } else {
+    active_note_[note].dx7_note->keyup();
+  }
+}
+
 int SynthUnit::ProcessMidiMessage(const uint8_t *buf, int buf_size) {
   uint8_t cmd = buf[0];
   uint8_t cmd_type = cmd & 0xf0;
@@ -133,7 +150,7 @@ int SynthUnit::ProcessMidiMessage(const uint8_t *buf, int buf_size) {
           if (sustain_) {
             active_note_[note].sustained = true;
           } else {
-            active_note_[note].dx7_note->keyup();
+            NoteOff(note);
           }
           active_note_[note].keydown = false;
         }
@@ -151,7 +168,7 @@ int SynthUnit::ProcessMidiMessage(const uint8_t *buf, int buf_size) {
         active_note_[note_ix].keydown = true;
         active_note_[note_ix].sustained = sustain_;
         active_note_[note_ix].live = true;
-        active_note_[note_ix].dx7_note->init(unpacked_patch_, buf[1], buf[2]);
+        NoteOn(note_ix, buf[1], buf[2]);
       }
       return 3;
     }
@@ -173,7 +190,7 @@ int SynthUnit::ProcessMidiMessage(const uint8_t *buf, int buf_size) {
         if (!sustain_) {
           for (int note = 0; note < max_active_notes; note++) {
             if (active_note_[note].sustained && !active_note_[note].keydown) {
-              active_note_[note].dx7_note->keyup();
+              NoteOff(note);
               active_note_[note].sustained = false;
             }
           }
@@ -259,7 +276,6 @@ void SynthUnit::GetSamples(int n_samples, int16_t *buffer) {
 
   for (; i < n_samples; i += SYNTH_N) {
     AlignedBuf<int32_t, SYNTH_N> audiobuf;
-    AlignedBuf<int32_t, SYNTH_N> audiobuf2;
     for (int j = 0; j < SYNTH_N; ++j) {
       audiobuf.get()[j] = 0;
     }
@@ -271,21 +287,55 @@ void SynthUnit::GetSamples(int n_samples, int16_t *buffer) {
           &controllers_);
       }
     }
-    const int32_t *bufs[] = { audiobuf.get() };
-    int32_t *bufs2[] = { audiobuf2.get() };
-    filter_.process(bufs, filter_control_, filter_control_, bufs2);
     int jmax = n_samples - i;
-    for (int j = 0; j < SYNTH_N; ++j) {
-      int32_t val = audiobuf2.get()[j] >> 4;
-      int clip_val = val < -(1 << 24) ? 0x8000 : val >= (1 << 24) ? 0x7fff :
-        val >> 9;
-      // TODO: maybe some dithering?
-      if (j < jmax) {
-        buffer[i + j] = clip_val;
-      } else {
-        extra_buf_[j - jmax] = clip_val;
+    if (jmax >= SYNTH_N) {
+      FilterBlock(audiobuf.get(), filter_control_, buffer + i);
+    } else {
+      int16_t outbuf[SYNTH_N];
+      FilterBlock(audiobuf.get(), filter_control_, outbuf);
+      for (int j = 0; j < SYNTH_N; ++j) {
+        if (j < jmax) {
+          buffer[i + j] = outbuf[j];
+        } else {
+          extra_buf_[j - jmax] = outbuf[j];
+        }
       }
     }
   }
   extra_buf_size_ = i - n_samples;
 }
+
+void SynthUnit::FilterBlock(const int32_t *mix, const int32_t *filter_control,
+                            int16_t *out) {
+  AlignedBuf<int32_t, SYNTH_N> audiobuf2;
+  const int32_t *bufs[] = { mix };
+  int32_t *bufs2[] = { audiobuf2.get() };
+  filter_.process(bufs, filter_control, filter_control, bufs2);
+  for (int j = 0; j < SYNTH_N; ++j) {
+    int32_t val = audiobuf2.get()[j] >> 4;
+    int clip_val = val < -(1 << 24) ? 0x8000 : val >= (1 << 24) ? 0x7fff :
+      val >> 9;
+    // TODO: maybe some dithering?
+    out[j] = clip_val;
+  }
+}
+
+void SynthUnit::ProcessMidi(const uint8_t *buf, int buf_size) {
+  int offset = 0;
+  while (offset < buf_size) {
+    int bytes_consumed = ProcessMidiMessage(buf + offset, buf_size - offset);
+    if (bytes_consumed == 0) {
+      break;
+    }
+    offset += bytes_consumed;
+  }
+}
+
+void SynthUnit::NextBlockControl(BlockControl *ctl) {
+  ctl->lfo_value = lfo_.getsample();
+  ctl->lfo_delay = lfo_.getdelay();
+  for (int i = 0; i < 3; ++i) {
+    ctl->filter_control[i] = filter_control_[i];
+  }
+  ctl->controllers = controllers_;
+}
@@ -21,6 +21,24 @@
 #include "ringbuffer.h"
 #include "resofilter.h"
 
+// Receives the voice updates instead of the notes when the voices are
+// rendered outside of GetSamples() (see offline_render.h).
+class VoiceLog {
+ public:
+  virtual void NoteOn(int voice, const char *patch, int midinote,
+                      int velocity) = 0;
+  virtual void NoteOff(int voice) = 0;
+  virtual ~VoiceLog() { }
+};
+
+// Everything a voice and the output filter need for one block.
+struct BlockControl {
+  int32_t lfo_value;
+  int32_t lfo_delay;
+  int32_t filter_control[3];
+  Controllers controllers;
+};
+
 struct ActiveNote {
   int midi_note;
   bool keydown;
@@ -43,6 +61,16 @@ class SynthUnit {
 
   void GetSamples(int n_samples, int16_t *buffer);
 
+  // Offline rendering: MIDI is applied directly (no ring buffer), note-on/off
+  // go to the voice log, and the caller computes the voices itself.
+  void SetVoiceLog(VoiceLog *voice_log) { voice_log_ = voice_log; }
+  void ProcessMidi(const uint8_t *buf, int buf_size);
+  void NextBlockControl(BlockControl *ctl);
+  // Filter and clip one block of mixed voices to 16 bits.
+  void FilterBlock(const int32_t *mix, const int32_t *filter_control,
+                   int16_t *out);
+  static int MaxActiveNotes() { return max_active_notes; }
+
 	bool get_patch_name(uint32_t pno, char* dst, uint32_t len) const {
 		if(dst == nullptr || len == 0) return false;
 		dst[0] = 0;
@@ -67,7 +95,11 @@ class SynthUnit {
 
   int ProcessMidiMessage(const uint8_t *buf, int buf_size);
 
-#ifdef WIN32
+  void NoteOn(int note, int midinote, int velocity);
+
+  void NoteOff(int note);
+
+#if defined(WIN32) || !defined(__RX__)
   static const int max_active_notes = 16;
 #else
 #if defined(SIG_RX65N)
@@ -99,4 +131,6 @@ class SynthUnit {
   // Extra buffering for when GetSamples wants a buffer not a multiple of N
   int16_t extra_buf_[SYNTH_N];
   int extra_buf_size_;
+
+  VoiceLog *voice_log_;
 };
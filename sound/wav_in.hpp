@@ -1,7 +1,8 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	WAV 音声ファイルを扱うクラス
+	@brief	WAV 音声ファイルを扱うクラス @n
+			8, 16, 24, 32 ビット整数、32 ビット浮動小数点の PCM に対応
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -9,16 +10,14 @@
 */
 //=====================================================================//
 #include <cstring>
+#include <algorithm>
 #include "common/file_io.hpp"
 #include "common/format.hpp"
 #include "sound/tag.hpp"
 #include "sound/af_play.hpp"
 #include "sound/sound_out.hpp"
 #include "sound/audio_info.hpp"
-
-extern "C" {
-	void set_sample_rate(uint32_t freq);
-};
+#include "sound/pcm_conv.hpp"
 
 namespace sound {
 
@@ -29,6 +28,11 @@ namespace sound {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class wav_in : public af_play {
 
+		static const uint32_t CHUNK_FRAMES = 256;	///< 変換、転送の単位
+		static const uint16_t FORMAT_PCM        = 0x0001;
+		static const uint16_t FORMAT_FLOAT      = 0x0003;
+		static const uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
 		struct WAVEFILEHEADER {
 			char	   	szRIFF[4];
 			uint32_t	ulRIFFSize;
@@ -60,9 +64,15 @@ namespace sound {
 		uint32_t	rate_;
 		uint8_t		channel_;
 		uint8_t		bits_;
+		bool		float_;
 
 		uint32_t	time_;
 
+		pcm_conv	conv_;
+
+		// ステレオ、32 ビットで 256 フレーム
+		uint8_t		buff_[CHUNK_FRAMES * 8] __attribute__ ((aligned(4)));
+
 
 		bool list_tag_(utils::file_io& fi, uint16_t size, char* dst, uint32_t dstlen) noexcept
 		{
@@ -90,7 +100,16 @@ namespace sound {
 		*/
 		//-------------------------------------------------------------//
 		wav_in() noexcept : data_top_(0), data_size_(0), data_pos_(0),
-			rate_(0), channel_(0), bits_(0), time_(0) { }
+			rate_(0), channel_(0), bits_(0), float_(false), time_(0), conv_() { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	PCM 変換の参照（ディザーの設定など）
+			@return PCM 変換
+		*/
+		//-------------------------------------------------------------//
+		pcm_conv& at_conv() noexcept { return conv_; }
 
 
 		//-------------------------------------------------------------//
@@ -129,6 +148,11 @@ namespace sound {
 					rate_ = wf.ulSamplesPerSec;
 					channel_ = wf.usChannels;
 					bits_ = wf.usBitsPerSample;
+					auto tag = wf.usFormatTag;
+					if(tag == FORMAT_EXTENSIBLE) {  // サブフォーマット GUID の先頭が形式タグ
+						tag = wf.guidSubFormat & 0xffff;
+					}
+					float_ = tag == FORMAT_FLOAT;
 				} else if(std::strncmp(rc.szChunkName, "data", 4) == 0) {
 					data_size_ = rc.ulChunkSize;
 					break;
@@ -227,8 +251,13 @@ namespace sound {
 				if(channel_ == 1) info.type = audio_format::PCM24_MONO;
 				else if(channel_ == 2) info.type = audio_format::PCM24_STEREO;
 			} else if(bits_ == 32) {
-				if(channel_ == 1) info.type = audio_format::PCM32_MONO;
-				else if(channel_ == 2) info.type = audio_format::PCM32_STEREO;
+				if(float_) {
+					if(channel_ == 1) info.type = audio_format::FLOAT32_MONO;
+					else if(channel_ == 2) info.type = audio_format::FLOAT32_STEREO;
+				} else {
+					if(channel_ == 1) info.type = audio_format::PCM32_MONO;
+					else if(channel_ == 2) info.type = audio_format::PCM32_STEREO;
+				}
 			}
 			uint32_t unit = (bits_ / 8) * channel_;
 			info.samples = data_size_ / unit;
@@ -241,7 +270,7 @@ namespace sound {
 			set_state(STATE::IDLE);
 
 			if(rate_ > 0) {
-				set_sample_rate(rate_);
+				set_sample_rate_(rate_);
 				return true;
 			} else {
 				return false;
@@ -260,6 +289,12 @@ namespace sound {
 		template <class SOUND_OUT>
 		bool decode(utils::file_io& fin, SOUND_OUT& out) noexcept
 		{
+			auto fmt = pcm_conv::get_format(bits_, float_);
+			const uint32_t unit = pcm_conv::get_bytes(fmt) * channel_;
+			if(unit == 0) return false;
+			// チャネル数が多い場合は、バッファに入るフレーム数にする
+			const uint32_t chunk = std::min(CHUNK_FRAMES, static_cast<uint32_t>(sizeof(buff_)) / unit);
+
 			bool status = true;
 			bool pause = false;
 			uint32_t pos = 0;
@@ -281,6 +316,7 @@ namespace sound {
 				} else if(ctrl == CTRL::REPLAY) {
 					out.mute();
 					fin.seek(utils::file_io::SEEK::SET, data_top_);
+					data_pos_ = 0;
 					pos = 0;
 					time_ = 0;
 					status = true;
@@ -298,56 +334,25 @@ namespace sound {
 					set_state(STATE::PLAY);
 				}
 
-				uint32_t unit = (bits_ / 8) * channel_;
-				uint8_t tmp[1024];
-				if(fin.read(tmp, unit * 256) != (unit * 256)) {
+				uint32_t frames = std::min(chunk, (data_size_ - data_pos_) / unit);
+				if(frames == 0) break;
+				frames = fin.read(buff_, unit * frames) / unit;
+				if(frames == 0) {
 //					utils::format("Read fail abort...\n");
 					out.mute();
 //					status = false;
 					break;
 				}
-				if(bits_ == 16) {
-					const uint16_t* src = reinterpret_cast<const uint16_t*>(tmp);
-					for(uint32_t i = 0; i < 256; ++i) {
-						while((out.at_fifo().size() - out.at_fifo().length()) < 64) {
-							system_delay(1);
-						}
-						typename SOUND_OUT::WAVE t;
-						if(get_channel() == 2) {
-							t.l_ch = src[0];
-							t.r_ch = src[1];
-							src += 2;
-						} else {
-							t.l_ch = src[0];
-							t.r_ch = t.l_ch;
-							++src;
-						}
-						out.at_fifo().put(t);
-						++pos;
-					}
-				} else {  // 8 bits
-					const uint8_t* src = reinterpret_cast<const uint8_t*>(tmp);
-					for(uint32_t i = 0; i < 256; ++i) {
-						while((out.at_fifo().size() - out.at_fifo().length()) < 64) {
-							system_delay(1);
-						}
-						typename SOUND_OUT::WAVE t;
-						if(get_channel() == 2) {
-							t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
-							t.l_ch |= (src[0] & 0x7f) << 1;
-							t.r_ch = static_cast<uint16_t>(src[1] ^ 0x80) << 8;
-							t.r_ch |= (src[1] & 0x7f) << 1;
-							src += 2;
-						} else {
-							t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
-							t.l_ch |= (src[0] & 0x7f) << 1;
-							t.r_ch = t.l_ch;
-							++src;
-						}
-						out.at_fifo().put(t);
-						++pos;
-					}
+
+				typename SOUND_OUT::WAVE wav[CHUNK_FRAMES];
+				conv_.convert(fmt, buff_, channel_, frames, wav);
+
+				// 流量制御は、チャンク毎に一度
+				while((out.at_fifo().size() - out.at_fifo().length()) < (frames + 64)) {
+					system_delay(1);
 				}
+				out.at_fifo().put(wav, frames);
+				pos += frames;
 
 				{
 					uint32_t s = pos / rate_;
@@ -358,7 +363,7 @@ namespace sound {
 						time_ = s;
 					}
 				}
-				data_pos_ += unit;
+				data_pos_ += unit * frames;
 			}
 			set_state(STATE::IDLE);
 			return status;